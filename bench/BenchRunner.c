@@ -0,0 +1,244 @@
+//
+// BenchRunner.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "BenchRunner.h"
+
+#include "logging/EventLogger.h"
+#include "time/TaskTimer.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Fraction of the measuring time spent warming up caches, branch predictors
+// and so on before the benchmark is timed
+#define BENCH_WARM_UP_RATIO 0.1
+#define BENCH_BASELINE_NAME_KEY "\"name\": \""
+#define BENCH_BASELINE_TIME_KEY "\"nsPerFrame\": "
+
+BenchCase newBenchCase(BenchSetupFunc setup, BenchRunFunc run,
+                       BenchTeardownFunc teardown,
+                       const unsigned long args[BENCH_MAX_ARGS],
+                       const char *nameFormat, ...) {
+  BenchCase benchCase = (BenchCase)malloc(sizeof(BenchCaseMembers));
+  va_list arguments;
+
+  benchCase->name = newCharString();
+  va_start(arguments, nameFormat);
+  vsnprintf(benchCase->name->data, benchCase->name->capacity, nameFormat,
+            arguments);
+  va_end(arguments);
+
+  memcpy(benchCase->args, args, sizeof(benchCase->args));
+  benchCase->setup = setup;
+  benchCase->run = run;
+  benchCase->teardown = teardown;
+  return benchCase;
+}
+
+static int _compareDoubles(const void *a, const void *b) {
+  const double first = *(const double *)a;
+  const double second = *(const double *)b;
+  return (first > second) - (first < second);
+}
+
+// Run the benchmark repeatedly for at least the given time, and return the
+// average time per frame in nanoseconds
+static double _benchCaseRunFor(BenchCase self, void *data, TaskTimer timer,
+                               const double timeInMs,
+                               unsigned long *outIterations) {
+  double elapsedTimeInMs = 0.0;
+  double numFrames = 0.0;
+
+  do {
+    taskTimerStart(timer);
+    numFrames += (double)self->run(data);
+    elapsedTimeInMs += taskTimerStop(timer);
+    (*outIterations)++;
+  } while (elapsedTimeInMs < timeInMs);
+
+  if (numFrames <= 0.0) {
+    return 0.0;
+  }
+
+  return elapsedTimeInMs * 1000000.0 / numFrames;
+}
+
+BenchResult benchCaseRun(BenchCase self, const double timeInMs) {
+  BenchResult result;
+  TaskTimer timer;
+  double rounds[BENCH_NUM_ROUNDS];
+  double mean = 0.0;
+  double variance = 0.0;
+  unsigned long warmUpIterations = 0;
+  void *data = self->setup(self->args);
+  int i;
+
+  if (data == NULL) {
+    logError("Could not set up benchmark '%s'", self->name->data);
+    return NULL;
+  }
+
+  result = (BenchResult)malloc(sizeof(BenchResultMembers));
+  result->name = newCharString();
+  charStringCopy(result->name, self->name);
+  result->iterations = 0;
+
+  timer = newTaskTimer(NULL, NULL);
+  _benchCaseRunFor(self, data, timer, timeInMs * BENCH_WARM_UP_RATIO,
+                   &warmUpIterations);
+
+  for (i = 0; i < BENCH_NUM_ROUNDS; i++) {
+    rounds[i] = _benchCaseRunFor(self, data, timer, timeInMs / BENCH_NUM_ROUNDS,
+                                 &result->iterations);
+    mean += rounds[i] / BENCH_NUM_ROUNDS;
+  }
+
+  for (i = 0; i < BENCH_NUM_ROUNDS; i++) {
+    variance += (rounds[i] - mean) * (rounds[i] - mean) / BENCH_NUM_ROUNDS;
+  }
+
+  qsort(rounds, BENCH_NUM_ROUNDS, sizeof(double), _compareDoubles);
+  result->nsPerFrame = rounds[BENCH_NUM_ROUNDS / 2];
+  result->minNsPerFrame = rounds[0];
+  result->deviation = mean > 0.0 ? sqrt(variance) / mean : 0.0;
+  result->framesPerSecond =
+      result->nsPerFrame > 0.0 ? 1000000000.0 / result->nsPerFrame : 0.0;
+
+  self->teardown(data);
+  freeTaskTimer(timer);
+  return result;
+}
+
+void benchResultsWriteJson(LinkedList results, FILE *out) {
+  LinkedListIterator iterator;
+  BenchResult result;
+
+  fprintf(out, "{\n  \"benchmarks\": [\n");
+
+  for (iterator = results; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    result = (BenchResult)iterator->item;
+    fprintf(out,
+            "    {" BENCH_BASELINE_NAME_KEY "%s\", \"iterations\": %lu, "
+            BENCH_BASELINE_TIME_KEY "%.4f, \"minNsPerFrame\": %.4f, "
+            "\"deviation\": %.4f, \"framesPerSecond\": %.0f}%s\n",
+            result->name->data, result->iterations, result->nsPerFrame,
+            result->minNsPerFrame, result->deviation, result->framesPerSecond,
+            iterator->nextItem != NULL &&
+                    ((LinkedListIterator)iterator->nextItem)->item != NULL
+                ? ","
+                : "");
+  }
+
+  fprintf(out, "  ]\n}\n");
+}
+
+// Find the time for a benchmark in the baseline file, or return a negative
+// value if it is not in the baseline
+static double _findBaselineTime(FILE *baseline, const CharString name) {
+  CharString line = newCharStringWithCapacity(kCharStringLengthLong);
+  double result = -1.0;
+  char *nameStart;
+  char *nameEnd;
+  char *time;
+
+  rewind(baseline);
+
+  while (fgets(line->data, (int)line->capacity, baseline) != NULL) {
+    nameStart = strstr(line->data, BENCH_BASELINE_NAME_KEY);
+    time = strstr(line->data, BENCH_BASELINE_TIME_KEY);
+
+    if (nameStart == NULL || time == NULL) {
+      continue;
+    }
+
+    nameStart += strlen(BENCH_BASELINE_NAME_KEY);
+    nameEnd = strchr(nameStart, '"');
+
+    if (nameEnd != NULL &&
+        (size_t)(nameEnd - nameStart) == strlen(name->data) &&
+        strncmp(nameStart, name->data, strlen(name->data)) == 0) {
+      result = strtod(time + strlen(BENCH_BASELINE_TIME_KEY), NULL);
+      break;
+    }
+  }
+
+  freeCharString(line);
+  return result;
+}
+
+int benchResultsCompareToBaseline(LinkedList results,
+                                  const CharString baselinePath,
+                                  const double tolerance) {
+  FILE *baseline = fopen(baselinePath->data, "r");
+  LinkedListIterator iterator;
+  BenchResult result;
+  double baselineTime;
+  int numRegressions = 0;
+
+  if (baseline == NULL) {
+    logError("Could not open baseline file '%s'", baselinePath->data);
+    return -1;
+  }
+
+  for (iterator = results; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    result = (BenchResult)iterator->item;
+    baselineTime = _findBaselineTime(baseline, result->name);
+
+    if (baselineTime < 0.0) {
+      logWarn("Benchmark '%s' is not in the baseline", result->name->data);
+    } else if (result->nsPerFrame > baselineTime * (1.0 + tolerance)) {
+      logError("Benchmark '%s' is slower than the baseline: %.4fns per frame, "
+               "expected at most %.4fns",
+               result->name->data, result->nsPerFrame,
+               baselineTime * (1.0 + tolerance));
+      numRegressions++;
+    } else {
+      logDebug("Benchmark '%s' is within the baseline (%.4fns vs. %.4fns)",
+               result->name->data, result->nsPerFrame, baselineTime);
+    }
+  }
+
+  fclose(baseline);
+  return numRegressions;
+}
+
+void freeBenchCase(BenchCase self) {
+  if (self != NULL) {
+    freeCharString(self->name);
+    free(self);
+  }
+}
+
+void freeBenchResult(BenchResult self) {
+  if (self != NULL) {
+    freeCharString(self->name);
+    free(self);
+  }
+}
@@ -0,0 +1,130 @@
+//
+// BenchRunner.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatsonBench_BenchRunner_h
+#define MrsWatsonBench_BenchRunner_h
+
+#include "base/CharString.h"
+#include "base/LinkedList.h"
+#include "base/Types.h"
+
+#include <stdio.h>
+
+#define BENCH_MAX_ARGS 3
+// Number of timed rounds for each benchmark, used to estimate its variance
+#define BENCH_NUM_ROUNDS 5
+#define BENCH_DEFAULT_TIME_IN_MS 500.0
+#define BENCH_DEFAULT_TOLERANCE 0.1
+
+/**
+ * Create all data needed by a benchmark, which is not included in its timing
+ * @param args Arguments given to the benchmark, such as the blocksize
+ * @return Opaque data passed to the other functions of the benchmark, or NULL
+ * if the benchmark cannot run
+ */
+typedef void *(*BenchSetupFunc)(const unsigned long *args);
+/**
+ * Run the measured operation once
+ * @param data Data returned by the setup function
+ * @return Number of sample frames (or other items) which were processed, used
+ * to normalize the time taken
+ */
+typedef SampleCount (*BenchRunFunc)(void *data);
+typedef void (*BenchTeardownFunc)(void *data);
+
+typedef struct {
+  CharString name;
+  unsigned long args[BENCH_MAX_ARGS];
+  BenchSetupFunc setup;
+  BenchRunFunc run;
+  BenchTeardownFunc teardown;
+} BenchCaseMembers;
+typedef BenchCaseMembers *BenchCase;
+
+typedef struct {
+  CharString name;
+  unsigned long iterations;
+  // Median time of all rounds
+  double nsPerFrame;
+  // Time of the fastest round
+  double minNsPerFrame;
+  // Standard deviation of all rounds, relative to their mean
+  double deviation;
+  double framesPerSecond;
+} BenchResultMembers;
+typedef BenchResultMembers *BenchResult;
+
+/**
+ * Create a new benchmark. The name is formatted like printf(), and should be
+ * unique since it is used to find the benchmark in the baseline.
+ * @param setup Setup function
+ * @param run Function to measure
+ * @param teardown Teardown function, which is given the setup function's data
+ * @param args Arguments passed to the setup function, with unused arguments
+ * set to 0
+ * @param nameFormat Format string for the name
+ * @return Initialized BenchCase instance
+ */
+BenchCase newBenchCase(BenchSetupFunc setup, BenchRunFunc run,
+                       BenchTeardownFunc teardown,
+                       const unsigned long args[BENCH_MAX_ARGS],
+                       const char *nameFormat, ...);
+
+/**
+ * Run a benchmark, first running it for a short warm-up period and then
+ * timing it for BENCH_NUM_ROUNDS rounds.
+ * @param self
+ * @param timeInMs Minimum time to spend measuring the benchmark
+ * @return Results, or NULL if the benchmark could not be set up
+ */
+BenchResult benchCaseRun(BenchCase self, const double timeInMs);
+
+/**
+ * Write benchmark results as a JSON document. Each result is written on its
+ * own line, which keeps baseline files easy to diff.
+ * @param results List of BenchResult objects
+ * @param out File to write to
+ */
+void benchResultsWriteJson(LinkedList results, FILE *out);
+
+/**
+ * Compare benchmark results to those in a baseline file, as written by
+ * benchResultsWriteJson(), and print any which are slower than the baseline.
+ * Benchmarks which are missing from the baseline are ignored.
+ * @param results List of BenchResult objects
+ * @param baselinePath Path to baseline file
+ * @param tolerance Allowed slowdown, relative to the baseline time
+ * @return Number of benchmarks which were too slow, or -1 if the baseline
+ * could not be read
+ */
+int benchResultsCompareToBaseline(LinkedList results,
+                                  const CharString baselinePath,
+                                  const double tolerance);
+
+void freeBenchCase(BenchCase self);
+void freeBenchResult(BenchResult self);
+
+#endif
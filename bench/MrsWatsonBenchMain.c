@@ -0,0 +1,247 @@
+//
+// MrsWatsonBenchMain.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "MrsWatsonBenchMain.h"
+
+#include "app/ProgramOption.h"
+#include "audio/AudioSettings.h"
+#include "logging/EventLogger.h"
+#include "time/AudioClock.h"
+
+#include "BenchRunner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern LinkedList getBenchCases(void);
+
+static ProgramOptions _newBenchProgramOptions(void) {
+  ProgramOptions programOptions = newProgramOptions(NUM_BENCH_OPTIONS);
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(
+          OPTION_BENCH_FILTER, "filter",
+          "Only run benchmarks whose name contains the given text, for example \
+'pluginChain' or 'pcm/decode'.",
+          true, kProgramOptionTypeString, kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(OPTION_BENCH_LIST, "list",
+                               "List the names of all benchmarks", true,
+                               kProgramOptionTypeEmpty,
+                               kProgramOptionArgumentTypeNone));
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(
+          OPTION_BENCH_OUTPUT, "output",
+          "Write results as JSON to the given file. By default, results are \
+written to stdout.",
+          true, kProgramOptionTypeString, kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(
+          OPTION_BENCH_BASELINE, "baseline",
+          "Compare results with a JSON file written by a previous run. If any \
+benchmark is slower than the baseline by more than the tolerance, the program \
+exits with a non-zero code.",
+          true, kProgramOptionTypeString, kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(
+          OPTION_BENCH_TOLERANCE, "tolerance",
+          "Allowed slowdown compared to the baseline, in percent.", true,
+          kProgramOptionTypeNumber, kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(programOptions, OPTION_BENCH_TOLERANCE,
+                          (float)(BENCH_DEFAULT_TOLERANCE * 100.0));
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(
+          OPTION_BENCH_TIME, "time",
+          "Time to spend measuring each benchmark, in milliseconds. Longer \
+times give more stable results.",
+          false, kProgramOptionTypeNumber, kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(programOptions, OPTION_BENCH_TIME,
+                          (float)BENCH_DEFAULT_TIME_IN_MS);
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(OPTION_BENCH_HELP, "help",
+                               "Print full program help (this screen), or "
+                               "just the help for a single argument.",
+                               true, kProgramOptionTypeString,
+                               kProgramOptionArgumentTypeOptional));
+
+  programOptionsAdd(
+      programOptions,
+      newProgramOptionWithName(OPTION_BENCH_VERBOSE, "verbose",
+                               "Show logging output from benchmarks", true,
+                               kProgramOptionTypeEmpty,
+                               kProgramOptionArgumentTypeNone));
+
+  return programOptions;
+}
+
+static LinkedList _runBenchCases(LinkedList benchCases, const CharString filter,
+                                 const double timeInMs) {
+  LinkedList results = newLinkedList();
+  LinkedListIterator iterator;
+  BenchCase benchCase;
+  BenchResult result;
+
+  for (iterator = benchCases; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    benchCase = (BenchCase)iterator->item;
+
+    if (filter != NULL && strstr(benchCase->name->data, filter->data) == NULL) {
+      continue;
+    }
+
+    fprintf(stderr, "%s: ", benchCase->name->data);
+    fflush(stderr);
+    result = benchCaseRun(benchCase, timeInMs);
+
+    if (result == NULL) {
+      fprintf(stderr, "skipped\n");
+    } else {
+      fprintf(stderr, "%.4fns per frame (%.1f%% deviation)\n",
+              result->nsPerFrame, result->deviation * 100.0);
+      linkedListAppend(results, result);
+    }
+  }
+
+  return results;
+}
+
+int main(int argc, char *argv[]) {
+  ProgramOptions programOptions = _newBenchProgramOptions();
+  LinkedList benchCases;
+  LinkedList results;
+  LinkedListIterator iterator;
+  CharString filter = NULL;
+  FILE *output = stdout;
+  int numRegressions = 0;
+
+  if (!programOptionsParseArgs(programOptions, argc, argv)) {
+    printf("Or run with --help (option) to see help for a single option\n");
+    freeProgramOptions(programOptions);
+    return -1;
+  }
+
+  if (programOptions->options[OPTION_BENCH_HELP]->enabled) {
+    printf("Run with '--help full' to see extended help for all options.\n");
+
+    if (charStringIsEmpty(
+            programOptionsGetString(programOptions, OPTION_BENCH_HELP))) {
+      printf("All options, where <argument> is required and [argument] is "
+             "optional\n");
+      programOptionsPrintHelp(programOptions, false, DEFAULT_INDENT_SIZE);
+    } else {
+      programOptionsPrintHelp(programOptions, true, DEFAULT_INDENT_SIZE);
+    }
+
+    freeProgramOptions(programOptions);
+    return -1;
+  }
+
+  initEventLogger();
+  setLogLevel(programOptions->options[OPTION_BENCH_VERBOSE]->enabled
+                  ? LOG_DEBUG
+                  : LOG_WARN);
+  initAudioSettings();
+  initAudioClock();
+  benchCases = getBenchCases();
+
+  if (programOptions->options[OPTION_BENCH_LIST]->enabled) {
+    for (iterator = benchCases; iterator != NULL && iterator->item != NULL;
+         iterator = (LinkedListIterator)iterator->nextItem) {
+      printf("%s\n", ((BenchCase)iterator->item)->name->data);
+    }
+
+    freeLinkedListAndItems(benchCases, (LinkedListFreeItemFunc)freeBenchCase);
+    freeProgramOptions(programOptions);
+    freeAudioClock(getAudioClock());
+    freeAudioSettings();
+    freeEventLogger();
+    return 0;
+  }
+
+  if (programOptions->options[OPTION_BENCH_FILTER]->enabled) {
+    filter = programOptionsGetString(programOptions, OPTION_BENCH_FILTER);
+  }
+
+  results = _runBenchCases(
+      benchCases, filter,
+      programOptionsGetNumber(programOptions, OPTION_BENCH_TIME));
+
+  if (programOptions->options[OPTION_BENCH_OUTPUT]->enabled) {
+    output = fopen(
+        programOptionsGetString(programOptions, OPTION_BENCH_OUTPUT)->data,
+        "w");
+
+    if (output == NULL) {
+      logError("Could not open '%s' for writing",
+               programOptionsGetString(programOptions, OPTION_BENCH_OUTPUT)
+                   ->data);
+      numRegressions = -1;
+    }
+  }
+
+  if (output != NULL) {
+    benchResultsWriteJson(results, output);
+
+    if (output != stdout) {
+      fclose(output);
+    }
+  }
+
+  if (numRegressions == 0 &&
+      programOptions->options[OPTION_BENCH_BASELINE]->enabled) {
+    numRegressions = benchResultsCompareToBaseline(
+        results,
+        programOptionsGetString(programOptions, OPTION_BENCH_BASELINE),
+        programOptionsGetNumber(programOptions, OPTION_BENCH_TOLERANCE) /
+            100.0);
+
+    if (numRegressions > 0) {
+      logError("%d benchmarks were slower than the baseline", numRegressions);
+    }
+  }
+
+  freeLinkedListAndItems(results, (LinkedListFreeItemFunc)freeBenchResult);
+  freeLinkedListAndItems(benchCases, (LinkedListFreeItemFunc)freeBenchCase);
+  freeProgramOptions(programOptions);
+  freeAudioClock(getAudioClock());
+  freeAudioSettings();
+  freeEventLogger();
+  return numRegressions == 0 ? 0 : (numRegressions > 0 ? 1 : -1);
+}
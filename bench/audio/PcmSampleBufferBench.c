@@ -0,0 +1,98 @@
+//
+// PcmSampleBufferBench.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/PcmSampleBuffer.h"
+
+#include "BenchRunner.h"
+
+#include <stdlib.h>
+
+#define PCM_BENCH_NUM_CHANNELS 2
+#define PCM_BENCH_BLOCKSIZE 4096
+
+static void *_pcmBenchSetup(const unsigned long *args) {
+  PcmSampleBuffer pcmSampleBuffer = newPcmSampleBuffer(
+      PCM_BENCH_NUM_CHANNELS, PCM_BENCH_BLOCKSIZE, (BitDepth)args[0]);
+  SampleBuffer sampleBuffer = pcmSampleBuffer->getSampleBuffer(pcmSampleBuffer);
+  ChannelCount channel;
+  SampleCount i;
+
+  pcmSampleBuffer->littleEndian = (boolByte)args[1];
+
+  for (channel = 0; channel < sampleBuffer->numChannels; channel++) {
+    for (i = 0; i < sampleBuffer->blocksize; i++) {
+      sampleBuffer->samples[channel][i] = (Sample)rand() / RAND_MAX - 0.5f;
+    }
+  }
+
+  pcmSampleBuffer->setSampleBuffer(pcmSampleBuffer, sampleBuffer);
+  return pcmSampleBuffer;
+}
+
+static SampleCount _pcmBenchDecode(void *data) {
+  PcmSampleBuffer pcmSampleBuffer = (PcmSampleBuffer)data;
+  pcmSampleBuffer->setSamples(pcmSampleBuffer);
+  return PCM_BENCH_BLOCKSIZE;
+}
+
+static SampleCount _pcmBenchEncode(void *data) {
+  PcmSampleBuffer pcmSampleBuffer = (PcmSampleBuffer)data;
+  pcmSampleBuffer->setSampleBuffer(
+      pcmSampleBuffer, pcmSampleBuffer->getSampleBuffer(pcmSampleBuffer));
+  return PCM_BENCH_BLOCKSIZE;
+}
+
+static void _pcmBenchTeardown(void *data) {
+  freePcmSampleBuffer((PcmSampleBuffer)data);
+}
+
+void addPcmSampleBufferBenchmarks(LinkedList benchCases);
+void addPcmSampleBufferBenchmarks(LinkedList benchCases) {
+  const BitDepth bitDepths[] = {kBitDepth8Bit, kBitDepth16Bit, kBitDepth24Bit,
+                                kBitDepth32Bit};
+  unsigned long args[BENCH_MAX_ARGS] = {0, 0, 0};
+  size_t i;
+
+  for (i = 0; i < sizeof(bitDepths) / sizeof(BitDepth); i++) {
+    args[0] = bitDepths[i];
+    args[1] = true;
+    linkedListAppend(benchCases,
+                     newBenchCase(_pcmBenchSetup, _pcmBenchDecode,
+                                  _pcmBenchTeardown, args,
+                                  "pcm/decode/%dbit/le", bitDepths[i]));
+    args[1] = false;
+    linkedListAppend(benchCases,
+                     newBenchCase(_pcmBenchSetup, _pcmBenchDecode,
+                                  _pcmBenchTeardown, args,
+                                  "pcm/decode/%dbit/be", bitDepths[i]));
+    // Encoding always writes native byte order
+    args[1] = true;
+    linkedListAppend(benchCases,
+                     newBenchCase(_pcmBenchSetup, _pcmBenchEncode,
+                                  _pcmBenchTeardown, args, "pcm/encode/%dbit",
+                                  bitDepths[i]));
+  }
+}
@@ -0,0 +1,92 @@
+//
+// SampleBufferBench.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/SampleBuffer.h"
+
+#include "BenchRunner.h"
+
+#include <stdlib.h>
+
+typedef struct {
+  SampleBuffer source;
+  SampleBuffer destination;
+} SampleBufferBenchDataMembers;
+typedef SampleBufferBenchDataMembers *SampleBufferBenchData;
+
+static void *_sampleBufferBenchSetup(const unsigned long *args) {
+  SampleBufferBenchData data =
+      (SampleBufferBenchData)malloc(sizeof(SampleBufferBenchDataMembers));
+  ChannelCount channel;
+  SampleCount i;
+
+  data->source = newSampleBuffer((ChannelCount)args[0], args[2]);
+  data->destination = newSampleBuffer((ChannelCount)args[1], args[2]);
+
+  for (channel = 0; channel < data->source->numChannels; channel++) {
+    for (i = 0; i < data->source->blocksize; i++) {
+      data->source->samples[channel][i] = (Sample)rand() / RAND_MAX - 0.5f;
+    }
+  }
+
+  return data;
+}
+
+static SampleCount _sampleBufferBenchCopyAndMapChannels(void *dataPtr) {
+  SampleBufferBenchData data = (SampleBufferBenchData)dataPtr;
+  sampleBufferCopyAndMapChannels(data->destination, data->source);
+  return data->destination->blocksize;
+}
+
+static void _sampleBufferBenchTeardown(void *dataPtr) {
+  SampleBufferBenchData data = (SampleBufferBenchData)dataPtr;
+  freeSampleBuffer(data->source);
+  freeSampleBuffer(data->destination);
+  free(data);
+}
+
+void addSampleBufferBenchmarks(LinkedList benchCases);
+void addSampleBufferBenchmarks(LinkedList benchCases) {
+  // Pairs of source and destination channel counts
+  const unsigned long channels[][2] = {{2, 2}, {1, 2}, {2, 1}, {2, 8}};
+  const unsigned long blocksizes[] = {64, 512, 4096};
+  unsigned long args[BENCH_MAX_ARGS];
+  size_t i, j;
+
+  for (i = 0; i < sizeof(channels) / sizeof(channels[0]); i++) {
+    for (j = 0; j < sizeof(blocksizes) / sizeof(unsigned long); j++) {
+      args[0] = channels[i][0];
+      args[1] = channels[i][1];
+      args[2] = blocksizes[j];
+      linkedListAppend(
+          benchCases,
+          newBenchCase(_sampleBufferBenchSetup,
+                       _sampleBufferBenchCopyAndMapChannels,
+                       _sampleBufferBenchTeardown, args,
+                       "sampleBuffer/copyAndMapChannels/%luto%lu/%lu",
+                       args[0], args[1], args[2]));
+    }
+  }
+}
@@ -0,0 +1,145 @@
+//
+// SampleSourceBench.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "io/SampleSource.h"
+
+#include "audio/AudioSettings.h"
+
+#include "BenchRunner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SAMPLE_SOURCE_BENCH_BLOCKSIZE 4096
+// Each run reads or writes about 6 seconds of audio at 44.1kHz
+#define SAMPLE_SOURCE_BENCH_NUM_BLOCKS 64
+
+typedef enum {
+  SAMPLE_SOURCE_BENCH_PCM,
+  SAMPLE_SOURCE_BENCH_WAVE
+} SampleSourceBenchFileType;
+
+typedef struct {
+  CharString filename;
+  SampleBuffer buffer;
+} SampleSourceBenchDataMembers;
+typedef SampleSourceBenchDataMembers *SampleSourceBenchData;
+
+static SampleCount _sampleSourceBenchWrite(void *dataPtr) {
+  SampleSourceBenchData data = (SampleSourceBenchData)dataPtr;
+  SampleSource sampleSource = sampleSourceFactory(data->filename);
+  int i;
+
+  sampleSource->openSampleSource(sampleSource, SAMPLE_SOURCE_OPEN_WRITE);
+
+  for (i = 0; i < SAMPLE_SOURCE_BENCH_NUM_BLOCKS; i++) {
+    sampleSource->writeSampleBlock(sampleSource, data->buffer);
+  }
+
+  sampleSource->closeSampleSource(sampleSource);
+  freeSampleSource(sampleSource);
+  return SAMPLE_SOURCE_BENCH_BLOCKSIZE * SAMPLE_SOURCE_BENCH_NUM_BLOCKS;
+}
+
+static SampleCount _sampleSourceBenchRead(void *dataPtr) {
+  SampleSourceBenchData data = (SampleSourceBenchData)dataPtr;
+  SampleSource sampleSource = sampleSourceFactory(data->filename);
+  SampleCount numFrames = 0;
+  SampleCount framesRead;
+
+  sampleSource->openSampleSource(sampleSource, SAMPLE_SOURCE_OPEN_READ);
+
+  do {
+    framesRead = sampleSourceReadFrames(sampleSource, data->buffer, 0,
+                                        data->buffer->blocksize);
+    numFrames += framesRead;
+  } while (framesRead == data->buffer->blocksize);
+
+  sampleSource->closeSampleSource(sampleSource);
+  freeSampleSource(sampleSource);
+  return numFrames;
+}
+
+static void *_sampleSourceBenchSetup(const unsigned long *args) {
+  SampleSourceBenchData data =
+      (SampleSourceBenchData)malloc(sizeof(SampleSourceBenchDataMembers));
+  ChannelCount channel;
+  SampleCount i;
+
+  // Sources allocate their conversion buffers with the global blocksize
+  setBlocksize(SAMPLE_SOURCE_BENCH_BLOCKSIZE);
+  data->filename = newCharStringWithCString(
+      args[0] == SAMPLE_SOURCE_BENCH_WAVE ? "mrswatson_bench.wav"
+                                          : "mrswatson_bench.pcm");
+  data->buffer =
+      newSampleBuffer(getNumChannels(), SAMPLE_SOURCE_BENCH_BLOCKSIZE);
+
+  for (channel = 0; channel < data->buffer->numChannels; channel++) {
+    for (i = 0; i < data->buffer->blocksize; i++) {
+      data->buffer->samples[channel][i] = (Sample)rand() / RAND_MAX - 0.5f;
+    }
+  }
+
+  // Reading benchmarks need a file to read from
+  _sampleSourceBenchWrite(data);
+  return data;
+}
+
+static void _sampleSourceBenchTeardown(void *dataPtr) {
+  SampleSourceBenchData data = (SampleSourceBenchData)dataPtr;
+  remove(data->filename->data);
+  freeCharString(data->filename);
+  freeSampleBuffer(data->buffer);
+  free(data);
+}
+
+void addSampleSourceBenchmarks(LinkedList benchCases);
+void addSampleSourceBenchmarks(LinkedList benchCases) {
+  unsigned long args[BENCH_MAX_ARGS] = {SAMPLE_SOURCE_BENCH_PCM, 0, 0};
+
+  linkedListAppend(benchCases,
+                   newBenchCase(_sampleSourceBenchSetup,
+                                _sampleSourceBenchRead,
+                                _sampleSourceBenchTeardown, args,
+                                "sampleSource/read/pcm"));
+  linkedListAppend(benchCases,
+                   newBenchCase(_sampleSourceBenchSetup,
+                                _sampleSourceBenchWrite,
+                                _sampleSourceBenchTeardown, args,
+                                "sampleSource/write/pcm"));
+
+  args[0] = SAMPLE_SOURCE_BENCH_WAVE;
+  linkedListAppend(benchCases,
+                   newBenchCase(_sampleSourceBenchSetup,
+                                _sampleSourceBenchRead,
+                                _sampleSourceBenchTeardown, args,
+                                "sampleSource/read/wave"));
+  linkedListAppend(benchCases,
+                   newBenchCase(_sampleSourceBenchSetup,
+                                _sampleSourceBenchWrite,
+                                _sampleSourceBenchTeardown, args,
+                                "sampleSource/write/wave"));
+}
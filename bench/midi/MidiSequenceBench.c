@@ -0,0 +1,108 @@
+//
+// MidiSequenceBench.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "midi/MidiSequence.h"
+
+#include "BenchRunner.h"
+
+#define MIDI_SEQUENCE_BENCH_NUM_EVENTS 8192
+
+typedef struct {
+  MidiSequence midiSequence;
+  SampleCount blocksize;
+  unsigned long numBlocks;
+} MidiSequenceBenchDataMembers;
+typedef MidiSequenceBenchDataMembers *MidiSequenceBenchData;
+
+static void *_midiSequenceBenchSetup(const unsigned long *args) {
+  MidiSequenceBenchData data =
+      (MidiSequenceBenchData)malloc(sizeof(MidiSequenceBenchDataMembers));
+  const unsigned long eventsPerBlock = args[0];
+  MidiEvent midiEvent;
+  unsigned long i;
+
+  data->midiSequence = newMidiSequence();
+  data->blocksize = args[1];
+  data->numBlocks = MIDI_SEQUENCE_BENCH_NUM_EVENTS / eventsPerBlock;
+
+  // Alternate note on and note off events, spread evenly over all blocks
+  for (i = 0; i < MIDI_SEQUENCE_BENCH_NUM_EVENTS; i++) {
+    midiEvent = newMidiEvent();
+    midiEvent->eventType = MIDI_TYPE_REGULAR;
+    midiEvent->timestamp = i * data->blocksize / eventsPerBlock;
+    midiEvent->status = (byte)(i % 2 ? 0x80 : 0x90);
+    midiEvent->data1 = (byte)(i % 128);
+    midiEvent->data2 = 0x7f;
+    appendMidiEventToSequence(data->midiSequence, midiEvent);
+  }
+
+  return data;
+}
+
+static SampleCount _midiSequenceBenchFill(void *dataPtr) {
+  MidiSequenceBenchData data = (MidiSequenceBenchData)dataPtr;
+  LinkedList midiEvents;
+  unsigned long block;
+
+  // Rewind the sequence so that each run schedules all events again
+  midiSequenceRewind(data->midiSequence);
+
+  for (block = 0; block < data->numBlocks; block++) {
+    midiEvents = newLinkedList();
+    fillMidiEventsFromRange(data->midiSequence, block * data->blocksize,
+                            data->blocksize, midiEvents);
+    freeLinkedList(midiEvents);
+  }
+
+  return data->blocksize * data->numBlocks;
+}
+
+static void _midiSequenceBenchTeardown(void *dataPtr) {
+  MidiSequenceBenchData data = (MidiSequenceBenchData)dataPtr;
+  freeMidiSequence(data->midiSequence);
+  free(data);
+}
+
+void addMidiSequenceBenchmarks(LinkedList benchCases);
+void addMidiSequenceBenchmarks(LinkedList benchCases) {
+  const unsigned long eventsPerBlock[] = {1, 16, 256};
+  const unsigned long blocksizes[] = {64, 512};
+  unsigned long args[BENCH_MAX_ARGS] = {0, 0, 0};
+  size_t i, j;
+
+  for (i = 0; i < sizeof(eventsPerBlock) / sizeof(unsigned long); i++) {
+    for (j = 0; j < sizeof(blocksizes) / sizeof(unsigned long); j++) {
+      args[0] = eventsPerBlock[i];
+      args[1] = blocksizes[j];
+      linkedListAppend(benchCases,
+                       newBenchCase(_midiSequenceBenchSetup,
+                                    _midiSequenceBenchFill,
+                                    _midiSequenceBenchTeardown, args,
+                                    "midiSequence/fill/%luevents/%lu",
+                                    args[0], args[1]));
+    }
+  }
+}
@@ -0,0 +1,169 @@
+//
+// PluginChainBench.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "plugin/PluginChain.h"
+
+#include "audio/AudioSettings.h"
+#include "plugin/PluginGain.h"
+#include "plugin/PluginMock.h"
+#include "plugin/PluginPassthru.h"
+
+#include "BenchRunner.h"
+
+#include <stdlib.h>
+
+typedef enum {
+  PLUGIN_CHAIN_BENCH_MOCK,
+  PLUGIN_CHAIN_BENCH_PASSTHRU,
+  PLUGIN_CHAIN_BENCH_GAIN,
+  NUM_PLUGIN_CHAIN_BENCH_PLUGINS
+} PluginChainBenchPluginType;
+
+static const char *kPluginChainBenchPluginNames[] = {"mock", "passthru",
+                                                      "gain"};
+
+typedef struct {
+  PluginChain pluginChain;
+  SampleBuffer inputBuffer;
+  SampleBuffer outputBuffer;
+} PluginChainBenchDataMembers;
+typedef PluginChainBenchDataMembers *PluginChainBenchData;
+
+static Plugin _newBenchPlugin(PluginChainBenchPluginType pluginType) {
+  CharString pluginName;
+  Plugin plugin = NULL;
+
+  switch (pluginType) {
+  case PLUGIN_CHAIN_BENCH_MOCK:
+    plugin = newPluginMock();
+    break;
+
+  case PLUGIN_CHAIN_BENCH_PASSTHRU:
+    pluginName = newCharStringWithCString(kInternalPluginPassthruName);
+    plugin = newPluginPassthru(pluginName);
+    freeCharString(pluginName);
+    break;
+
+  case PLUGIN_CHAIN_BENCH_GAIN:
+    pluginName = newCharStringWithCString(kInternalPluginGainName);
+    plugin = newPluginGain(pluginName);
+    freeCharString(pluginName);
+    break;
+
+  default:
+    break;
+  }
+
+  return plugin;
+}
+
+static void _pluginChainBenchTeardown(void *dataPtr) {
+  PluginChainBenchData data = (PluginChainBenchData)dataPtr;
+  pluginChainShutdown(data->pluginChain);
+  freePluginChain(data->pluginChain);
+  freeSampleBuffer(data->inputBuffer);
+  freeSampleBuffer(data->outputBuffer);
+  free(data);
+}
+
+static void *_pluginChainBenchSetup(const unsigned long *args) {
+  PluginChainBenchData data =
+      (PluginChainBenchData)malloc(sizeof(PluginChainBenchDataMembers));
+  Plugin plugin;
+  ChannelCount channel;
+  SampleCount i;
+
+  // Plugins allocate their buffers with the global blocksize when opened
+  setBlocksize(args[2]);
+  data->pluginChain = newPluginChain();
+  data->inputBuffer = newSampleBuffer(getNumChannels(), args[2]);
+  data->outputBuffer = newSampleBuffer(getNumChannels(), args[2]);
+
+  for (i = 0; i < args[1]; i++) {
+    plugin = _newBenchPlugin((PluginChainBenchPluginType)args[0]);
+
+    if (!pluginChainAppend(data->pluginChain, plugin, NULL)) {
+      freePlugin(plugin);
+      _pluginChainBenchTeardown(data);
+      return NULL;
+    }
+  }
+
+  if (pluginChainInitialize(data->pluginChain) != RETURN_CODE_SUCCESS) {
+    _pluginChainBenchTeardown(data);
+    return NULL;
+  }
+
+  pluginChainPrepareForProcessing(data->pluginChain);
+
+  for (channel = 0; channel < data->inputBuffer->numChannels; channel++) {
+    for (i = 0; i < data->inputBuffer->blocksize; i++) {
+      data->inputBuffer->samples[channel][i] =
+          (Sample)rand() / RAND_MAX - 0.5f;
+    }
+  }
+
+  return data;
+}
+
+static SampleCount _pluginChainBenchProcessAudio(void *dataPtr) {
+  PluginChainBenchData data = (PluginChainBenchData)dataPtr;
+  pluginChainProcessAudio(data->pluginChain, data->inputBuffer,
+                          data->outputBuffer);
+  return data->inputBuffer->blocksize;
+}
+
+void addPluginChainBenchmarks(LinkedList benchCases);
+void addPluginChainBenchmarks(LinkedList benchCases) {
+  const unsigned long chainLengths[] = {1, 4, MAX_PLUGINS - 1};
+  const unsigned long blocksizes[] = {64, 512, 4096};
+  unsigned long args[BENCH_MAX_ARGS];
+  size_t i, j;
+  int pluginType;
+
+  for (pluginType = 0; pluginType < NUM_PLUGIN_CHAIN_BENCH_PLUGINS;
+       pluginType++) {
+    for (i = 0; i < sizeof(chainLengths) / sizeof(unsigned long); i++) {
+      // The mock plugin is an instrument, which must be first in the chain
+      if (pluginType == PLUGIN_CHAIN_BENCH_MOCK && chainLengths[i] > 1) {
+        continue;
+      }
+
+      for (j = 0; j < sizeof(blocksizes) / sizeof(unsigned long); j++) {
+        args[0] = (unsigned long)pluginType;
+        args[1] = chainLengths[i];
+        args[2] = blocksizes[j];
+        linkedListAppend(
+            benchCases,
+            newBenchCase(_pluginChainBenchSetup, _pluginChainBenchProcessAudio,
+                         _pluginChainBenchTeardown, args,
+                         "pluginChain/processAudio/%s/%lux/%lu",
+                         kPluginChainBenchPluginNames[pluginType], args[1],
+                         args[2]));
+      }
+    }
+  }
+}
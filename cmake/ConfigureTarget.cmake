@@ -10,7 +10,7 @@ function(configure_target target wordsize)
       set_target_properties(${target} PROPERTIES COMPILE_FLAGS "-m64")
       set_target_properties(${target} PROPERTIES LINK_FLAGS "-m64")
     endif()
-    target_link_libraries(${target} dl)
+    target_link_libraries(${target} dl pthread rt)
 
     if(WITH_GUI)
       target_link_libraries(${target} x11)
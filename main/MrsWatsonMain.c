@@ -26,12 +26,15 @@
 
 #include "MrsWatson.h"
 
+#include "base/MemoryTracker.h"
 #include "logging/ErrorReporter.h"
 #include "logging/EventLogger.h"
+#include "logging/FlightRecorder.h"
 
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // This must be global so that in case of a crash or signal, we can still
 // generate
@@ -39,6 +42,25 @@
 static ErrorReporter gErrorReporter = NULL;
 
 static void handleSignal(int signum) {
+  // This must come first, since the rest of this handler is not safe to call
+  // from a signal and may crash or deadlock if the heap is corrupted
+  switch (signum) {
+#ifdef SIGABRT
+  case SIGABRT:
+#endif
+#ifdef SIGBUS
+  case SIGBUS:
+#endif
+#ifdef SIGSEGV
+  case SIGSEGV:
+#endif
+    flightRecorderHandleCrash(signum);
+    break;
+
+  default:
+    break;
+  }
+
   logCritical("Sent signal %d, exiting", signum);
 
   if (gErrorReporter != NULL && gErrorReporter->started) {
@@ -52,6 +74,16 @@ static void handleSignal(int signum) {
 }
 
 int main(int argc, char *argv[]) {
+  int i;
+
+  // Tracked blocks only carry a header when memory statistics are collected,
+  // so this must be decided before anything is allocated
+  for (i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--memory-stats", strlen("--memory-stats")) == 0) {
+      memoryTrackerEnable();
+    }
+  }
+
   gErrorReporter = newErrorReporter();
 
 // Set up signal handling only after logging is initialized. If we crash before
@@ -28,15 +28,25 @@
 #include "MrsWatsonOptions.h"
 
 #include "app/BuildInfo.h"
+#include "app/MemoryMonitor.h"
+#include "app/RenderDaemon.h"
+#include "app/RenderLoop.h"
+#include "app/RenderStatus.h"
 #include "audio/AudioSettings.h"
+#include "audio/Denormals.h"
 #include "base/PlatformInfo.h"
 #include "io/SampleSource.h"
+#include "io/SampleSourceFloat.h"
 #include "io/SampleSourcePcm.h"
 #include "logging/EventLogger.h"
+#include "logging/FlightRecorder.h"
 #include "logging/LogPrinter.h"
 #include "midi/MidiSequence.h"
 #include "midi/MidiSource.h"
+#include "plugin/PluginAutomation.h"
 #include "plugin/PluginChain.h"
+#include "plugin/PluginChainBenchmark.h"
+#include "plugin/PluginVst2xIndex.h"
 #include "time/AudioClock.h"
 
 #include <stdio.h>
@@ -192,11 +202,18 @@ static ReturnCode setupMidiSource(MidiSource midiSource,
   return RETURN_CODE_SUCCESS;
 }
 
-static ReturnCode setupOutputSource(SampleSource outputSource) {
+static ReturnCode setupOutputSource(SampleSource outputSource,
+                                    const boolByte shouldWriteFloatHeader) {
   if (outputSource == NULL) {
     return RETURN_CODE_INVALID_ARGUMENT;
   }
 
+  if (outputSource->sampleSourceType == SAMPLE_SOURCE_TYPE_FLOAT) {
+    sampleSourceFloatSetWriteHeader(outputSource, shouldWriteFloatHeader);
+  } else if (shouldWriteFloatHeader) {
+    logWarn("Output source is not a raw float type, ignoring --float-header");
+  }
+
   if (!outputSource->openSampleSource(outputSource, SAMPLE_SOURCE_OPEN_WRITE)) {
     logError("Output source '%s' could not be opened",
              outputSource->sourceName->data);
@@ -206,7 +223,45 @@ static ReturnCode setupOutputSource(SampleSource outputSource) {
   return RETURN_CODE_SUCCESS;
 }
 
-static void _processMidiMetaEvent(void *item, void *userData) {
+static ReturnCode runBenchmark(PluginChain pluginChain,
+                               SampleSource inputSource,
+                               const unsigned long numIterations,
+                               const unsigned long maxTimeInMs) {
+  PluginChainBenchmark benchmark = newPluginChainBenchmark();
+  unsigned long maxTimeInFrames =
+      (unsigned long)(maxTimeInMs * getSampleRate()) / 1000l;
+
+  if (inputSource->sampleSourceType == SAMPLE_SOURCE_TYPE_SILENCE) {
+    if (maxTimeInFrames == 0) {
+      maxTimeInFrames = (unsigned long)(
+          PLUGIN_CHAIN_BENCHMARK_DEFAULT_SYNTH_TIME_IN_MS * getSampleRate() /
+          1000.0);
+    }
+
+    logInfo("No input source given, synthesizing %lu frames of noise",
+            maxTimeInFrames);
+    pluginChainBenchmarkSynthesize(benchmark, maxTimeInFrames);
+  } else if (!pluginChainBenchmarkReadInput(benchmark, inputSource,
+                                            maxTimeInFrames)) {
+    freePluginChainBenchmark(benchmark);
+    return RETURN_CODE_IO_ERROR;
+  }
+
+  // Sleeping between blocks would only measure the wall clock
+  pluginChainSetRealtime(pluginChain, false);
+  pluginChainPrepareForProcessing(pluginChain);
+
+  if (!pluginChainBenchmarkRun(benchmark, pluginChain, numIterations)) {
+    freePluginChainBenchmark(benchmark);
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  pluginChainBenchmarkPrintResults(benchmark, pluginChain);
+  freePluginChainBenchmark(benchmark);
+  return RETURN_CODE_SUCCESS;
+}
+
+void processMidiMetaEvent(void *item, void *userData) {
   MidiEvent midiEvent = (MidiEvent)item;
   boolByte *finishedReading = (boolByte *)userData;
 
@@ -244,26 +299,17 @@ static void _processMidiMetaEvent(void *item, void *userData) {
  * @return True if there is more input to read.
  */
 boolByte readInput(SampleSource inputSource, SampleBuffer buffer) {
-  unsigned long framesRead;
   unsigned long bufferSize = buffer->blocksize;
-
-  inputSource->readSampleBlock(inputSource, buffer);
-  // buffer->blocksize tells how many frames have been read from inputSource
-  framesRead = buffer->blocksize;
+  unsigned long framesRead =
+      sampleSourceReadFrames(inputSource, buffer, 0, bufferSize);
 
   if (framesRead == bufferSize) {
     // We have filled up the buffer, so return true to ask for more input
     return true;
   } else if (framesRead < bufferSize) {
-    // Partial read, meaning that we have reached the end of file
-    unsigned long numberOfFrames = (bufferSize - framesRead);
-    SampleBuffer silenceBuffer =
-        newSampleBuffer(buffer->numChannels, numberOfFrames);
-
-    buffer->blocksize = framesRead + numberOfFrames;
-    sampleBufferCopyAndMapChannelsWithOffset(buffer, framesRead, silenceBuffer,
-                                             0, numberOfFrames);
-    freeSampleBuffer(silenceBuffer);
+    // Partial read, meaning that we have reached the end of file. Pad the
+    // rest of the buffer with silence.
+    sampleBufferClearFrames(buffer, framesRead, bufferSize - framesRead);
 
     // Finished reading
     return false;
@@ -284,18 +330,20 @@ boolByte readInput(SampleSource inputSource, SampleBuffer buffer) {
  * @param buffer The SampleBuffer with the samples to be written.
  * @param skipHeadFrames Number of frames to ignore before writing to
  * outputSource.
+ * @param startFrame Position of the audio clock when processing started.
  */
 void writeOutput(SampleSource outputSource, SampleSource silenceSource,
-                 SampleBuffer buffer, unsigned long skipHeadFrames) {
+                 SampleBuffer buffer, unsigned long skipHeadFrames,
+                 unsigned long startFrame) {
   unsigned long framesSkipped =
       silenceSource->numSamplesProcessed / buffer->numChannels;
   unsigned long framesProcessed =
       framesSkipped + outputSource->numSamplesProcessed / buffer->numChannels;
   unsigned long nextBlockStart = framesProcessed + buffer->blocksize;
 
-  if (framesProcessed != getAudioClock()->currentFrame) {
+  if (startFrame + framesProcessed != getAudioClock()->currentFrame) {
     logWarn("framesProcessed (%lu) != getAudioClock()->currentFrame (%lu)",
-            framesProcessed, getAudioClock()->currentFrame);
+            startFrame + framesProcessed, getAudioClock()->currentFrame);
   }
 
   // Cut the delay at the start
@@ -304,24 +352,13 @@ void writeOutput(SampleSource outputSource, SampleSource silenceSource,
     silenceSource->writeSampleBlock(silenceSource, buffer);
   } else if (framesProcessed < skipHeadFrames &&
              skipHeadFrames < nextBlockStart) {
-    SampleBuffer sourceBuffer =
-        newSampleBuffer(buffer->numChannels, buffer->blocksize);
     unsigned long skippedFrames = skipHeadFrames - framesProcessed;
     unsigned long soundFrames = nextBlockStart - skipHeadFrames;
 
     // Cutting away start part of the block.
-    sourceBuffer->blocksize = skippedFrames;
-    sampleBufferCopyAndMapChannelsWithOffset(sourceBuffer, 0, buffer, 0,
-                                             sourceBuffer->blocksize);
-    silenceSource->writeSampleBlock(silenceSource, sourceBuffer);
-
+    sampleSourceWriteFrames(silenceSource, buffer, 0, skippedFrames);
     // Writing remaining end part of the block.
-    sourceBuffer->blocksize = soundFrames;
-    sampleBufferCopyAndMapChannelsWithOffset(
-        sourceBuffer, 0, buffer, skippedFrames, sourceBuffer->blocksize);
-    outputSource->writeSampleBlock(outputSource, sourceBuffer);
-
-    freeSampleBuffer(sourceBuffer);
+    sampleSourceWriteFrames(outputSource, buffer, skippedFrames, soundFrames);
   } else {
     // Normal case: Nothing more to cut. The whole block shall be written.
     outputSource->writeSampleBlock(outputSource, buffer);
@@ -337,21 +374,32 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
   PluginChain pluginChain;
   CharString pluginSearchRoot = newCharString();
   boolByte shouldDisplayPluginInfo = false;
+  boolByte shouldWriteFloatHeader = false;
   MidiSequence midiSequence = NULL;
+  PluginAutomation automation = NULL;
   MidiSource midiSource = NULL;
   unsigned long maxTimeInMs = 0;
   unsigned long maxTimeInFrames = 0;
-  unsigned long processingDelayInFrames;
+  unsigned long startTimeInMs = 0;
+  unsigned long endTimeInMs = 0;
+  unsigned long preRollInMs = 0;
+  unsigned long startFrame = 0;
+  unsigned long endFrame = 0;
+  unsigned long seekFrame = 0;
+  SampleCount ioBlocksize = 0;
+  long tailTimeInMs;
+  unsigned long tailWindowInMs;
+  double tailThresholdInDb;
+  RenderStatus renderStatus = NULL;
+  MemoryMonitor memoryMonitor = NULL;
   ProgramOptions programOptions;
   ProgramOption option;
   Plugin headPlugin;
-  SampleBuffer inputSampleBuffer = NULL;
-  SampleBuffer outputSampleBuffer = NULL;
-  TaskTimer initTimer, totalTimer, inputTimer, outputTimer = NULL;
+  RenderLoop renderLoop;
+  TaskTimer initTimer, totalTimer;
   LinkedList taskTimerList = NULL;
   CharString totalTimeString = NULL;
   boolByte finishedReading = false;
-  SampleSource silentSampleOutput;
   unsigned int i;
 
   initTimer = newTaskTimerWithCString(PROGRAM_NAME, "Initialization");
@@ -604,10 +652,43 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
 
         break;
 
+      case OPTION_CPU_STATS:
+        pluginChainSetCpuStats(pluginChain, true);
+        break;
+
+      case OPTION_DENORMAL_CHECK:
+        pluginChainSetDenormalCheck(pluginChain, true);
+        break;
+
       case OPTION_DISPLAY_INFO:
         shouldDisplayPluginInfo = true;
         break;
 
+      case OPTION_FLOAT_HEADER:
+        shouldWriteFloatHeader = true;
+        break;
+
+      case OPTION_FLUSH_DENORMALS:
+        if (denormalsSetFlushToZero(true)) {
+          logDebug("Flushing denormals to zero");
+        } else {
+          logWarn("Flushing denormals is not supported on this platform");
+        }
+
+        break;
+
+      case OPTION_HUGE_PAGES:
+        if (!sampleBufferSetUseHugePages(true)) {
+          logWarn("Huge pages are not supported on this platform");
+        }
+
+        break;
+
+      case OPTION_END:
+        endTimeInMs = (const unsigned long)programOptionsGetNumber(
+            programOptions, OPTION_END);
+        break;
+
       case OPTION_INPUT_SOURCE:
         freeSampleSource(inputSource);
         inputSource = sampleSourceFactory(
@@ -639,6 +720,11 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
             programOptionsGetString(programOptions, OPTION_PLUGIN_ROOT));
         break;
 
+      case OPTION_PRE_ROLL:
+        preRollInMs = (const unsigned long)programOptionsGetNumber(
+            programOptions, OPTION_PRE_ROLL);
+        break;
+
       case OPTION_REALTIME:
         pluginChainSetRealtime(pluginChain, true);
         break;
@@ -662,6 +748,17 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
 
         break;
 
+      case OPTION_SILENCE_BYPASS:
+        pluginChainSetSilenceBypass(
+            pluginChain, true,
+            programOptionsGetNumber(programOptions, OPTION_SILENCE_BYPASS));
+        break;
+
+      case OPTION_START:
+        startTimeInMs = (const unsigned long)programOptionsGetNumber(
+            programOptions, OPTION_START);
+        break;
+
       case OPTION_TEMPO:
         if (!setTempo(programOptionsGetNumber(programOptions, OPTION_TEMPO))) {
           freeSampleSource(inputSource);
@@ -711,8 +808,27 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     }
   }
 
-  if (programOptions->options[OPTION_LIST_PLUGINS]->enabled) {
-    listAvailablePlugins(pluginSearchRoot);
+  // The plugin index is only needed until the plugin chain has been opened
+  initPluginVst2xIndex(
+      programOptionsGetString(programOptions, OPTION_PLUGIN_INDEX));
+
+  if (programOptions->options[OPTION_SCAN_PLUGINS]->enabled ||
+      programOptions->options[OPTION_LIST_PLUGINS]->enabled) {
+    result = RETURN_CODE_NOT_RUN;
+
+    if (programOptions->options[OPTION_SCAN_PLUGINS]->enabled &&
+        !scanAvailablePlugins(
+            pluginSearchRoot,
+            (unsigned int)programOptionsGetNumber(programOptions,
+                                                  OPTION_SCAN_JOBS),
+            (unsigned long)programOptionsGetNumber(programOptions,
+                                                   OPTION_SCAN_TIMEOUT))) {
+      logError("Plugin index could not be rebuilt");
+      result = RETURN_CODE_IO_ERROR;
+    } else {
+      listAvailablePlugins(pluginSearchRoot);
+    }
+
     freeSampleSource(inputSource);
     freeSampleSource(outputSource);
     freePluginChain(pluginChain);
@@ -721,10 +837,11 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeTaskTimer(totalTimer);
     freeCharString(pluginSearchRoot);
     freeMidiSource(midiSource);
+    freePluginVst2xIndex(getPluginVst2xIndex());
     freeAudioSettings();
     freeEventLogger();
     freeAudioClock(getAudioClock());
-    return RETURN_CODE_NOT_RUN;
+    return result;
   }
 
   if (programOptions->options[OPTION_LIST_FILE_TYPES]->enabled) {
@@ -737,6 +854,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeTaskTimer(totalTimer);
     freeCharString(pluginSearchRoot);
     freeMidiSource(midiSource);
+    freePluginVst2xIndex(getPluginVst2xIndex());
     freeAudioSettings();
     freeEventLogger();
     freeAudioClock(getAudioClock());
@@ -745,6 +863,41 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
 
   printWelcomeMessage(argc, argv);
 
+  if (programOptions->options[OPTION_DAEMON]->enabled) {
+    RenderDaemon renderDaemon =
+        newRenderDaemon(programOptionsGetString(programOptions, OPTION_DAEMON),
+                        pluginSearchRoot,
+                        (unsigned int)programOptionsGetNumber(
+                            programOptions, OPTION_DAEMON_CHAINS));
+    initFlightRecorder();
+
+    if (errorReporter->started) {
+      errorReporterAddFlightRecorder(errorReporter, getFlightRecorder());
+    }
+
+    result = renderDaemonRun(renderDaemon);
+    freeRenderDaemon(renderDaemon);
+    freeFlightRecorder(getFlightRecorder());
+
+    if (getPluginVst2xIndex()->isDirty) {
+      pluginVst2xIndexSave(getPluginVst2xIndex());
+    }
+
+    freeSampleSource(inputSource);
+    freeSampleSource(outputSource);
+    freePluginChain(pluginChain);
+    freeProgramOptions(programOptions);
+    freeTaskTimer(initTimer);
+    freeTaskTimer(totalTimer);
+    freeCharString(pluginSearchRoot);
+    freeMidiSource(midiSource);
+    freePluginVst2xIndex(getPluginVst2xIndex());
+    freeAudioSettings();
+    freeEventLogger();
+    freeAudioClock(getAudioClock());
+    return result;
+  }
+
   if ((result = setupInputSource(inputSource)) != RETURN_CODE_SUCCESS) {
     logError("Input source could not be opened, exiting");
     freeSampleSource(inputSource);
@@ -755,6 +908,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeTaskTimer(totalTimer);
     freeCharString(pluginSearchRoot);
     freeMidiSource(midiSource);
+    freePluginVst2xIndex(getPluginVst2xIndex());
     freeAudioSettings();
     freeEventLogger();
     freeAudioClock(getAudioClock());
@@ -773,6 +927,7 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeTaskTimer(totalTimer);
     freeCharString(pluginSearchRoot);
     freeMidiSource(midiSource);
+    freePluginVst2xIndex(getPluginVst2xIndex());
     freeAudioSettings();
     freeEventLogger();
     freeAudioClock(getAudioClock());
@@ -795,11 +950,15 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
       freeTaskTimer(totalTimer);
       freeMidiSource(midiSource);
       freeMidiSequence(midiSequence);
+      freePluginVst2xIndex(getPluginVst2xIndex());
       freeAudioSettings();
       freeEventLogger();
       freeAudioClock(getAudioClock());
       return result;
     }
+
+    // Let the clock report musical time which follows the file's tempo changes
+    audioClock->tempoMap = midiSequence->tempoMap;
   }
 
   // Copy plugins before they have been opened
@@ -824,12 +983,20 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     freeTaskTimer(totalTimer);
     freeMidiSource(midiSource);
     freeMidiSequence(midiSequence);
+    freePluginVst2xIndex(getPluginVst2xIndex());
     freeAudioSettings();
     freeEventLogger();
     freeAudioClock(getAudioClock());
     return result;
   }
 
+  // Plugins which were opened for the first time have now been indexed
+  if (getPluginVst2xIndex()->isDirty) {
+    pluginVst2xIndexSave(getPluginVst2xIndex());
+  }
+
+  freePluginVst2xIndex(getPluginVst2xIndex());
+
   // Display info for plugins in the chain before checking for valid
   // input/output sources
   if (shouldDisplayPluginInfo) {
@@ -872,10 +1039,39 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     }
   }
 
+  // Benchmarks process audio from memory, so the output source is not needed
+  if (programOptions->options[OPTION_BENCHMARK]->enabled) {
+    if (midiSource != NULL ||
+        programOptions->options[OPTION_AUTOMATION]->enabled) {
+      logWarn("MIDI and automation are ignored when benchmarking");
+    }
+
+    result = runBenchmark(
+        pluginChain, inputSource,
+        (unsigned long)programOptionsGetNumber(programOptions,
+                                               OPTION_BENCHMARK),
+        maxTimeInMs);
+    inputSource->closeSampleSource(inputSource);
+    freeSampleSource(inputSource);
+    freeSampleSource(outputSource);
+    pluginChainShutdown(pluginChain);
+    freePluginChain(pluginChain);
+    freeProgramOptions(programOptions);
+    freeTaskTimer(initTimer);
+    freeTaskTimer(totalTimer);
+    freeMidiSource(midiSource);
+    freeMidiSequence(midiSequence);
+    freeAudioSettings();
+    freeEventLogger();
+    freeAudioClock(getAudioClock());
+    return result;
+  }
+
   // Setup output source here. Having an invalid output source should not cause
   // the program
   // to exit if the user only wants to list plugins or query info about a chain.
-  if ((result = setupOutputSource(outputSource)) != RETURN_CODE_SUCCESS) {
+  if ((result = setupOutputSource(outputSource, shouldWriteFloatHeader)) !=
+      RETURN_CODE_SUCCESS) {
     logError("Output source could not be opened, exiting");
     freeSampleSource(inputSource);
     freeSampleSource(outputSource);
@@ -1009,10 +1205,133 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     }
   }
 
-  inputSampleBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
-  inputTimer = newTaskTimerWithCString(PROGRAM_NAME, "Input Source");
-  outputSampleBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
-  outputTimer = newTaskTimerWithCString(PROGRAM_NAME, "Output Source");
+  if (endTimeInMs > 0 && endTimeInMs <= startTimeInMs) {
+    logError("End time must come after the start time");
+    freeSampleSource(inputSource);
+    freeSampleSource(outputSource);
+    freePluginChain(pluginChain);
+    freeProgramOptions(programOptions);
+    freeTaskTimer(initTimer);
+    freeTaskTimer(totalTimer);
+    freeMidiSource(midiSource);
+    freeMidiSequence(midiSequence);
+    freeAudioSettings();
+    freeEventLogger();
+    freeAudioClock(getAudioClock());
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  // Jump directly to the start of the region to be rendered. The pre-roll is
+  // processed like any other audio, but is discarded along with the plugin
+  // chain's processing delay when writing the output.
+  if (startTimeInMs > 0) {
+    startFrame = (unsigned long)(startTimeInMs * getSampleRate()) / 1000l;
+    seekFrame = (unsigned long)(preRollInMs * getSampleRate()) / 1000l;
+    seekFrame = seekFrame < startFrame ? startFrame - seekFrame : 0;
+
+    if (!sampleSourceSeek(inputSource, seekFrame)) {
+      logError("Could not seek input source to start position, exiting");
+      freeSampleSource(inputSource);
+      freeSampleSource(outputSource);
+      freePluginChain(pluginChain);
+      freeProgramOptions(programOptions);
+      freeTaskTimer(initTimer);
+      freeTaskTimer(totalTimer);
+      freeMidiSource(midiSource);
+      freeMidiSequence(midiSequence);
+      freeAudioSettings();
+      freeEventLogger();
+      freeAudioClock(getAudioClock());
+      return RETURN_CODE_IO_ERROR;
+    }
+
+    if (midiSequence != NULL) {
+      // Events before the seek position are dropped, but tempo and time
+      // signature changes must still be applied
+      LinkedList skippedMetaEvents = newLinkedList();
+      finishedReading = (boolByte)!midiSequenceSeek(midiSequence, seekFrame,
+                                                    skippedMetaEvents);
+      linkedListForeach(skippedMetaEvents, processMidiMetaEvent,
+                        &finishedReading);
+      freeLinkedList(skippedMetaEvents);
+
+      if (finishedReading) {
+        logWarn("MIDI sequence ends before the start position");
+      }
+    }
+
+    audioClockSeek(audioClock, seekFrame);
+  }
+
+  if (endTimeInMs > 0) {
+    endFrame = (unsigned long)(endTimeInMs * getSampleRate()) / 1000l;
+  }
+
+  if (programOptions->options[OPTION_AUTOMATION]->enabled) {
+    automation = newPluginAutomation();
+
+    if (!pluginAutomationReadFile(
+            automation,
+            programOptionsGetString(programOptions, OPTION_AUTOMATION)) ||
+        !pluginAutomationIsValidForChain(automation, pluginChain)) {
+      freePluginAutomation(automation);
+      freeSampleSource(inputSource);
+      freeSampleSource(outputSource);
+      freePluginChain(pluginChain);
+      freeProgramOptions(programOptions);
+      freeTaskTimer(initTimer);
+      freeTaskTimer(totalTimer);
+      freeMidiSource(midiSource);
+      freeMidiSequence(midiSequence);
+      freeAudioSettings();
+      freeEventLogger();
+      freeAudioClock(getAudioClock());
+      return RETURN_CODE_INVALID_ARGUMENT;
+    }
+  }
+
+  if (programOptions->options[OPTION_TAIL_TIME]->enabled) {
+    tailTimeInMs =
+        (long)programOptionsGetNumber(programOptions, OPTION_TAIL_TIME);
+  } else {
+    tailTimeInMs = (long)pluginChainGetMaximumTailTimeInMs(pluginChain);
+  }
+
+  if (programOptions->options[OPTION_IO_BLOCKSIZE]->enabled) {
+    ioBlocksize = (SampleCount)programOptionsGetNumber(programOptions,
+                                                       OPTION_IO_BLOCKSIZE);
+  }
+
+  tailThresholdInDb =
+      (double)programOptionsGetNumber(programOptions, OPTION_TAIL_THRESHOLD);
+  tailWindowInMs = (unsigned long)programOptionsGetNumber(programOptions,
+                                                          OPTION_TAIL_WINDOW);
+
+  if (programOptions->options[OPTION_STATUS_FILE]->enabled ||
+      programOptions->options[OPTION_STATUS_SHM]->enabled) {
+    renderStatus = newRenderStatus();
+    renderStatus->intervalInMs = (unsigned long)programOptionsGetNumber(
+        programOptions, OPTION_STATUS_INTERVAL);
+
+    if (programOptions->options[OPTION_STATUS_FILE]->enabled) {
+      renderStatusSetFile(
+          renderStatus,
+          programOptionsGetString(programOptions, OPTION_STATUS_FILE));
+    }
+
+    // The render is more important than its status, so keep going anyways
+    if (programOptions->options[OPTION_STATUS_SHM]->enabled) {
+      renderStatusOpenSharedMemory(
+          renderStatus,
+          programOptionsGetString(programOptions, OPTION_STATUS_SHM));
+    }
+  }
+
+  if (programOptions->options[OPTION_MEMORY_STATS]->enabled) {
+    memoryMonitor = newMemoryMonitor();
+    memoryMonitor->intervalInMs = (unsigned long)programOptionsGetNumber(
+        programOptions, OPTION_MEMORY_STATS);
+  }
 
   // Initialization is finished, we should be able to free this memory now
   freeProgramOptions(programOptions);
@@ -1022,70 +1341,69 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
     maxTimeInFrames = (unsigned long)(maxTimeInMs * getSampleRate()) / 1000l;
   }
 
-  processingDelayInFrames = pluginChainGetProcessingDelay(pluginChain);
-  pluginChainPrepareForProcessing(pluginChain);
+  renderLoop =
+      newRenderLoop(pluginChain, inputSource, outputSource, PROGRAM_NAME);
+  renderLoop->midiSequence = midiSequence;
+  renderLoop->automation = automation;
+  renderLoop->renderStatus = renderStatus;
+  renderLoop->memoryMonitor = memoryMonitor;
+  renderLoop->ioBlocksize = ioBlocksize;
+  renderLoop->tailTimeInMs = tailTimeInMs;
+  renderLoop->tailThresholdInDb = tailThresholdInDb;
+  renderLoop->tailWindowInMs = tailWindowInMs;
+  renderLoop->startFrame = startFrame;
+  renderLoop->seekFrame = seekFrame;
+  renderLoop->endFrame = endFrame;
+  renderLoop->maxTimeInFrames = maxTimeInFrames;
+  renderLoopPrepare(renderLoop);
+  // The sources may have been wrapped for the I/O blocksize
+  inputSource = renderLoop->inputSource;
+  outputSource = renderLoop->outputSource;
 
   // Update sample rate on the event logger
   setLoggingZebraSize((const unsigned long)getSampleRate());
   logInfo("Starting processing input source");
   logDebug("Sample rate: %.0f", getSampleRate());
   logDebug("Blocksize: %d", getBlocksize());
-  logDebug("Channels: %d", getNumChannels());
-  logDebug("Tempo: %.2f", getTempo());
-  logDebug("Processing delay frames: %lu", processingDelayInFrames);
-  logDebug("Time signature: %d/%d", getTimeSignatureBeatsPerMeasure(),
-           getTimeSignatureNoteValue());
-  taskTimerStop(initTimer);
-
-  silentSampleOutput = sampleSourceFactory(NULL);
 
-  // Main processing loop
-  while (!finishedReading) {
-    taskTimerStart(inputTimer);
-    finishedReading = (boolByte)!readInput(inputSource, inputSampleBuffer);
+  if (renderLoop->ioBlocksize > 0) {
+    logDebug("I/O blocksize: %lu", renderLoop->ioBlocksize);
+  }
 
-    // TODO: For streaming MIDI, we would need to read in events from source
-    // here
-    if (midiSequence != NULL) {
-      LinkedList midiEventsForBlock = newLinkedList();
-      // MIDI source overrides the value set to finishedReading by the input
-      // source
-      finishedReading = (boolByte)!fillMidiEventsFromRange(
-          midiSequence, audioClock->currentFrame, getBlocksize(),
-          midiEventsForBlock);
-      linkedListForeach(midiEventsForBlock, _processMidiMetaEvent,
-                        &finishedReading);
-      pluginChainProcessMidi(pluginChain, midiEventsForBlock);
-      freeLinkedList(midiEventsForBlock);
-    }
+  logDebug("Channels: %d", getNumChannels());
+  logDebug("Tempo: %.2f", getTempo());
+  logDebug("Processing delay frames: %lu",
+           renderLoop->processingDelayInFrames);
 
-    taskTimerStop(inputTimer);
+  if (renderLoop->tail->isTailTimeKnown) {
+    logDebug("Maximum tail time: %ld ms", tailTimeInMs);
+  } else {
+    logDebug("Tail time is unknown, rendering until output is silent");
+  }
 
-    if (maxTimeInFrames > 0 && audioClock->currentFrame >= maxTimeInFrames) {
-      logInfo("Maximum time reached, stopping processing after this block");
-      finishedReading = true;
-    }
+  if (startFrame > 0) {
+    logDebug("Start frame: %lu (pre-roll from %lu)", startFrame, seekFrame);
+  }
 
-    pluginChainProcessAudio(pluginChain, inputSampleBuffer, outputSampleBuffer);
+  if (endFrame > 0) {
+    logDebug("End frame: %lu", endFrame);
+  }
 
-    taskTimerStart(outputTimer);
+  logDebug("Time signature: %d/%d", getTimeSignatureBeatsPerMeasure(),
+           getTimeSignatureNoteValue());
+  taskTimerStop(initTimer);
 
-    if (finishedReading) {
-      outputSampleBuffer->blocksize =
-          inputSampleBuffer
-              ->blocksize; // The input buffer size has been adjusted.
-      logDebug("Using buffer size of %d for final block",
-               outputSampleBuffer->blocksize);
-    }
+  // The flight recorder is always on, so that a crash report includes the last
+  // blocks which were rendered
+  initFlightRecorder();
 
-    writeOutput(outputSource, silentSampleOutput, outputSampleBuffer,
-                processingDelayInFrames);
-    taskTimerStop(outputTimer);
-    advanceAudioClock(audioClock, outputSampleBuffer->blocksize);
+  if (errorReporter->started) {
+    errorReporterAddFlightRecorder(errorReporter, getFlightRecorder());
   }
 
+  renderLoopProcess(renderLoop);
+
   // Close file handles for input/output sources
-  silentSampleOutput->closeSampleSource(silentSampleOutput);
   inputSource->closeSampleSource(inputSource);
   outputSource->closeSampleSource(outputSource);
 
@@ -1094,14 +1412,13 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
   // milliseconds
   // These values must be converted using the QueryPerformanceFrequency()
   // function
-  audioClockStop(audioClock);
   taskTimerStop(totalTimer);
 
   if (totalTimer->totalTaskTime > 0) {
     taskTimerList = newLinkedList();
     linkedListAppend(taskTimerList, initTimer);
-    linkedListAppend(taskTimerList, inputTimer);
-    linkedListAppend(taskTimerList, outputTimer);
+    linkedListAppend(taskTimerList, renderLoop->inputTimer);
+    linkedListAppend(taskTimerList, renderLoop->outputTimer);
 
     for (i = 0; i < pluginChain->numPlugins; i++) {
       linkedListAppend(taskTimerList, pluginChain->audioTimers[i]);
@@ -1118,9 +1435,16 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
             "computer is smokin' fast!");
   }
 
+  pluginChainReportDenormals(pluginChain);
+  pluginChainReportCpuStats(pluginChain);
+
+  if (memoryMonitor != NULL) {
+    memoryMonitorReport(memoryMonitor);
+  }
+
+  pluginChainReportSilenceBypass(pluginChain);
+
   freeTaskTimer(initTimer);
-  freeTaskTimer(inputTimer);
-  freeTaskTimer(outputTimer);
   freeTaskTimer(totalTimer);
   freeLinkedList(taskTimerList);
   freeCharString(totalTimeString);
@@ -1142,13 +1466,15 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv) {
   logInfo("Shutting down");
   freeSampleSource(inputSource);
   freeSampleSource(outputSource);
-  freeSampleSource(silentSampleOutput);
-  freeSampleBuffer(inputSampleBuffer);
-  freeSampleBuffer(outputSampleBuffer);
+  freePluginAutomation(automation);
+  freeRenderLoop(renderLoop);
+  freeRenderStatus(renderStatus);
+  freeMemoryMonitor(memoryMonitor);
   pluginChainShutdown(pluginChain);
   freePluginChain(pluginChain);
   freeMidiSource(midiSource);
   freeMidiSequence(midiSequence);
+  freeFlightRecorder(getFlightRecorder());
 
   freeAudioSettings();
   logInfo("Goodbye!");
@@ -28,9 +28,43 @@
 #define MrsWatson_MrsWatson_h
 
 #include "app/ReturnCodes.h"
+#include "audio/SampleBuffer.h"
 #include "base/CharString.h"
+#include "io/SampleSource.h"
 #include "logging/ErrorReporter.h"
 
 int mrsWatsonMain(ErrorReporter errorReporter, int argc, char **argv);
 
+/**
+ * Apply a MIDI meta event, such as a tempo change, to the global audio
+ * settings. Intended to be used with linkedListForeach().
+ * @param item MidiEvent to process. Events which are not meta events are
+ * ignored.
+ * @param userData Pointer to a boolByte, which is set to true when the end of
+ * the MIDI track has been reached.
+ */
+void processMidiMetaEvent(void *item, void *userData);
+
+/**
+ * Reads from inputSource. If the end of the source is reached, the rest of the
+ * buffer is filled with silence.
+ * @param inputSource The SampleSource to read from.
+ * @param buffer The SampleBuffer to which the samples will be written.
+ * @return True if there is more input to read.
+ */
+boolByte readInput(SampleSource inputSource, SampleBuffer buffer);
+
+/**
+ * Writes to outputSource, discarding the first skipHeadFrames frames.
+ * @param outputSource The SampleSource to write to.
+ * @param silenceSource The source from where to write skipHeadFrames frames.
+ * @param buffer The SampleBuffer with the samples to be written.
+ * @param skipHeadFrames Number of frames to ignore before writing to
+ * outputSource.
+ * @param startFrame Position of the audio clock when processing started.
+ */
+void writeOutput(SampleSource outputSource, SampleSource silenceSource,
+                 SampleBuffer buffer, unsigned long skipHeadFrames,
+                 unsigned long startFrame);
+
 #endif
@@ -26,14 +26,50 @@
 
 #include "MrsWatsonOptions.h"
 
+#include "app/MemoryMonitor.h"
+#include "app/RenderDaemon.h"
+#include "app/RenderStatus.h"
 #include "audio/AudioSettings.h"
 #include "base/File.h"
+#include "plugin/PluginChain.h"
+#include "plugin/PluginChainTail.h"
+#include "plugin/PluginVst2xScanner.h"
 
 #include <stdio.h>
 
 ProgramOptions newMrsWatsonOptions(void) {
   ProgramOptions options = newProgramOptions(NUM_OPTIONS);
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_AUTOMATION, "automation",
+          "Change plugin parameters while processing, as given in an automation \
+file. Each line of the file contains the sample frame where the change happens, \
+the plugin's position in the chain (starting from 0), and the parameter index \
+and value, all separated by commas. For example, to change parameter 2 of the \
+second plugin to 0.8 after one second of 44.1kHz audio:\n\n\
+\t44100,1,2,0.8\n\n\
+To switch a plugin to another program, use the word 'program' instead of the \
+parameter index, followed by the program number. If the plugin was loaded with \
+an FXB bank, the program is taken from the bank in memory. Blocks are split \
+at each change, so that new parameter values and programs are applied at \
+exactly the given frame without having to use a smaller blocksize.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_BENCHMARK, "benchmark",
+          "Measure the throughput of the plugin chain instead of rendering. The \
+input source is read into memory once, or if no input is given then a noise \
+signal is synthesized (limited by --max-time, otherwise 10 seconds long). After \
+a warm-up pass, the signal is processed by the chain for the given number of \
+iterations and the output is discarded. Frames per second, the realtime factor, \
+and the time spent by each plugin in nanoseconds per frame are printed, along \
+with their deviation across iterations.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -98,6 +134,60 @@ like so:\n\n\
           NO_SHORT_FORM, kProgramOptionTypeEmpty,
           kProgramOptionArgumentTypeRequired));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_CPU_STATS, "cpu-stats",
+          "Measure the CPU time which each plugin spends processing audio, as opposed \
+to the wall time which is always measured. On Linux, hardware counters for cycles, \
+instructions, cache misses and branch misses are also read if the kernel allows \
+it. After processing, each plugin is reported as compute-bound, memory-bound, or \
+stalling when it spends much of its time waiting for page faults, locks or I/O.",
+          NO_SHORT_FORM, kProgramOptionTypeEmpty,
+          kProgramOptionArgumentTypeNone));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_DAEMON, "daemon",
+          "Run as a render daemon which listens for render requests on the given \
+Unix domain socket. Plugin chains are kept open between requests, so repeated \
+renders with the same plugins and presets do not need to load them again. Audio \
+settings such as --sample-rate and --blocksize are used for all requests. Each \
+request is a list of tab-separated key/value lines, ended by an empty line:\n\n\
+\tplugin\t<plugin chain, like --plugin>\n\
+\tinput\t<input source>\n\
+\toutput\t<output source>\n\
+\tmidi\t<MIDI source>\n\
+\tparameter\t<index,value>\n\
+\tmax-time\t<milliseconds>\n\n\
+Send 'command<tab>shutdown' to stop the daemon. See also --daemon-chains.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_DAEMON_CHAINS, "daemon-chains",
+          "Maximum number of plugin chains which --daemon keeps open. When this \
+number is reached, the least recently used chain is closed.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(options, OPTION_DAEMON_CHAINS,
+                          (float)RENDER_DAEMON_DEFAULT_MAX_CHAINS);
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_DENORMAL_CHECK, "denormal-check",
+          "Measure how long each plugin takes to process quiet blocks compared to \
+normal blocks, and count the denormal samples in each plugin's output. Plugins \
+which slow down considerably on quiet input, for instance while rendering tails, \
+are likely to be processing denormal numbers and are reported after processing. \
+See also --flush-denormals.",
+          NO_SHORT_FORM, kProgramOptionTypeEmpty,
+          kProgramOptionArgumentTypeNone));
+
   programOptionsAdd(options,
                     newProgramOptionWithName(
                         OPTION_DISPLAY_INFO, "display-info",
@@ -125,6 +215,16 @@ intended for debugging plugin GUIs.",
           false, kProgramOptionTypeEmpty, kProgramOptionArgumentTypeNone));
   options->options[OPTION_EDITOR]->hideInHelp = true;
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_END, "end",
+          "Stop processing at <argument> milliseconds into the input source. When used \
+together with --start, only the region between the two positions is written to \
+the output source.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+
   programOptionsAdd(options,
                     newProgramOptionWithName(
                         OPTION_ERROR_REPORT, "error-report",
@@ -132,6 +232,27 @@ intended for debugging plugin GUIs.",
                         NO_SHORT_FORM, kProgramOptionTypeString,
                         kProgramOptionArgumentTypeNone));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_FLOAT_HEADER, "float-header",
+          "Start raw float output (.f32, .f64, .f32p, .f64p) with a small header \
+giving the sample rate, channel count and layout. When reading raw float input, \
+the header is detected automatically.",
+          NO_SHORT_FORM, kProgramOptionTypeEmpty,
+          kProgramOptionArgumentTypeNone));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_FLUSH_DENORMALS, "flush-denormals",
+          "Set the processor to flush denormal numbers to zero while processing. \
+Calculations with denormals can be many times slower than with regular numbers, \
+which often happens in plugins with filters or feedback while the signal decays \
+to silence. Denormals are too small to make an audible difference.",
+          NO_SHORT_FORM, kProgramOptionTypeEmpty,
+          kProgramOptionArgumentTypeNone));
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -150,6 +271,16 @@ Otherwise, extended help can be printed for an individual option given by \
           HAS_SHORT_FORM, kProgramOptionTypeString,
           kProgramOptionArgumentTypeOptional));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_HUGE_PAGES, "huge-pages",
+          "Back large audio buffers with huge pages, which can speed up processing \
+with very large blocksizes or many channels. Only supported on Linux, where \
+transparent huge pages are used if no huge pages have been reserved.",
+          NO_SHORT_FORM, kProgramOptionTypeEmpty,
+          kProgramOptionArgumentTypeNone));
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -160,6 +291,17 @@ the extension. Run with --list-file-types to see a list of supported types. Use
           HAS_SHORT_FORM, kProgramOptionTypeString,
           kProgramOptionArgumentTypeRequired));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_IO_BLOCKSIZE, "io-blocksize",
+          "Blocksize in frames to use when reading the input source and writing the \
+output source. The plugin chain is still processed with --blocksize, so this can \
+be used to make file or pipe I/O more efficient when plugins must run with very \
+small blocks. Must be larger than the processing blocksize.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+
   programOptionsAdd(options, newProgramOptionWithName(
                                  OPTION_LIST_PLUGINS, "list-plugins",
                                  "List available plugins. Useful for "
@@ -194,6 +336,21 @@ input source length. Mostly useful when using internal plugins as sources.",
           NO_SHORT_FORM, kProgramOptionTypeNumber,
           kProgramOptionArgumentTypeRequired));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_MEMORY_STATS, "memory-stats",
+          "Sample the resident memory of the process every [argument] milliseconds \
+while processing. Afterwards, the current and peak memory used by each part of \
+the host (audio buffers, MIDI, strings, I/O and the plugin host) is reported, \
+along with the steady-state growth rate of the resident memory. If resident \
+memory keeps growing while the host's own memory does not, a warning is printed \
+since a plugin is probably leaking memory.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeOptional));
+  programOptionsSetNumber(options, OPTION_MEMORY_STATS,
+                          (float)MEMORY_MONITOR_DEFAULT_INTERVAL_IN_MS);
+
   programOptionsAdd(options, newProgramOptionWithName(
                                  OPTION_MIDI_SOURCE, "midi-file",
                                  "MIDI file to read events from. Required if "
@@ -236,7 +393,9 @@ Instrument plugins must appear first in any chains. Plugins are searched for in
 the --plugin-root directory, the current directory, and the standard locations \
 for the OS. File extensions are added automatically to plugin names. Each plugin \
 may be followed by a comma with a program to be loaded, which should be of the \
-corresponding file format for the respective plugin. For shell plugins (like \
+corresponding file format for the respective plugin. VST plugins may also be \
+given an FXB bank, in which case MIDI program change events and --automation \
+switch between the programs in the bank. For shell plugins (like \
 Waves), use --display-info to get a list of sub-plugin ID's and then use a colon \
 to indicate which plugin to load. Examples:\n\n\
 \t--plugin LFX-1310\n\
@@ -246,6 +405,19 @@ to indicate which plugin to load. Examples:\n\n\
           HAS_SHORT_FORM, kProgramOptionTypeString,
           kProgramOptionArgumentTypeRequired));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_PLUGIN_INDEX, "plugin-index",
+          "File used to cache information about VST plugins, so that they can be \
+found without searching the filesystem. Plugins are added to the index when \
+they are first opened, or all at once with --scan-plugins. Index entries are \
+refreshed automatically when the plugin file changes. --list-plugins only uses \
+the index after it has been built with --scan-plugins. Defaults to a file in \
+the user's home directory.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
   programOptionsAdd(
       options,
       newProgramOptionWithName(
@@ -255,6 +427,17 @@ to indicate which plugin to load. Examples:\n\n\
           NO_SHORT_FORM, kProgramOptionTypeString,
           kProgramOptionArgumentTypeRequired));
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_PRE_ROLL, "pre-roll",
+          "When using --start, begin processing <argument> milliseconds before the \
+start position so that plugin state and effect tails can settle. Audio rendered \
+during the pre-roll is not written to the output source.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(options, OPTION_PRE_ROLL, 0.0f);
+
   programOptionsAdd(
       options, newProgramOptionWithName(OPTION_QUIET, "quiet",
                                         "Only log critical errors.",
@@ -284,6 +467,138 @@ using unusual sample rates will probably result in weird behavior from plugins."
   programOptionsSetNumber(options, OPTION_SAMPLE_RATE,
                           (const float)getSampleRate());
 
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_SCAN_JOBS, "scan-jobs",
+          "Number of plugins to load in parallel with --scan-plugins. Defaults to \
+the number of processors.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(options, OPTION_SCAN_JOBS, 0.0f);
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_SCAN_PLUGINS, "scan-plugins",
+          "Open all plugins in the --plugin-root directory, the current directory, \
+and the standard locations for the OS, rebuild the plugin index from them and \
+list the results. Each plugin is loaded in a separate process, so plugins which \
+crash or hang are recorded in the index rather than aborting the scan. See also \
+--scan-jobs and --scan-timeout.",
+          NO_SHORT_FORM, kProgramOptionTypeEmpty,
+          kProgramOptionArgumentTypeNone));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_SCAN_TIMEOUT, "scan-timeout",
+          "Time in milliseconds which each plugin may take to load with \
+--scan-plugins before it is considered to be hung.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(options, OPTION_SCAN_TIMEOUT,
+                          (float)PLUGIN_VST2X_SCANNER_DEFAULT_TIMEOUT_IN_MS);
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_SILENCE_BYPASS, "silence-bypass",
+          "Skip processing effects while their input is silent, meaning that its level \
+stays below [argument] dBFS. An effect is only skipped after its input has been \
+silent for longer than its reported tail time, and its output has become silent \
+as well. This can save a lot of processing time for sparse material, such as \
+dialogue or multitrack stems with long gaps.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeOptional));
+  programOptionsSetNumber(
+      options, OPTION_SILENCE_BYPASS,
+      (float)PLUGIN_CHAIN_SILENCE_BYPASS_DEFAULT_THRESHOLD_IN_DB);
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_START, "start",
+          "Start processing at <argument> milliseconds into the input source. The input \
+source (and MIDI file, if given) is seeked directly to this position rather than \
+being processed from the beginning. Reading from stdin is supported, but the \
+skipped audio must still be read. See also --pre-roll.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_STATUS_FILE, "status-file",
+          "Periodically write the progress of the render to the given file, which is \
+replaced atomically so that it can be polled at any time. The status includes the \
+frames processed, the position versus the total length of the input, the current \
+and average realtime factor, the estimated time left, and the recent cost per \
+block and number of missed realtime deadlines for each plugin. The file is written \
+as JSON, unless its name ends with '.prom', in which case the Prometheus text \
+format is used instead. See also --status-interval.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_STATUS_INTERVAL, "status-interval",
+          "Time in milliseconds between updates of --status-file and --status-shm.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(options, OPTION_STATUS_INTERVAL,
+                          (float)RENDER_STATUS_DEFAULT_INTERVAL_IN_MS);
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_STATUS_SHM, "status-shm",
+          "Publish the same counters as --status-file to a shared memory segment with \
+the given name, so that a monitoring tool can poll them without touching the \
+disk. The layout of the segment is documented in app/RenderStatus.h. On Linux, \
+the segment can be found under /dev/shm while rendering.",
+          NO_SHORT_FORM, kProgramOptionTypeString,
+          kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_TAIL_THRESHOLD, "tail-threshold",
+          "Level in dBFS below which the output is considered to be silent when \
+rendering the tail of the plugin chain. See also --tail-time.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(options, OPTION_TAIL_THRESHOLD,
+                          (float)PLUGIN_CHAIN_TAIL_DEFAULT_THRESHOLD_IN_DB);
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_TAIL_TIME, "tail-time",
+          "Maximum time in milliseconds to keep processing silence after the input \
+has ended, so that reverb and delay tails are not cut off. By default, the \
+longest tail time reported by the plugins in the chain is used. If any plugin \
+does not report its tail time, processing continues until the output is silent, \
+for at most 30 seconds. Any processing delay of the chain is always flushed before the tail is rendered. Processing \
+stops early once the output has stayed below --tail-threshold for \
+--tail-window milliseconds. Use 0 to only flush the processing delay. The tail \
+is not rendered when processing is stopped with --max-time or --end.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+
+  programOptionsAdd(
+      options,
+      newProgramOptionWithName(
+          OPTION_TAIL_WINDOW, "tail-window",
+          "Time in milliseconds which the output must stay below --tail-threshold \
+before the tail is considered to have ended. Use 0 to always render the entire \
+--tail-time.",
+          NO_SHORT_FORM, kProgramOptionTypeNumber,
+          kProgramOptionArgumentTypeRequired));
+  programOptionsSetNumber(options, OPTION_TAIL_WINDOW,
+                          (float)PLUGIN_CHAIN_TAIL_DEFAULT_WINDOW_IN_MS);
+
   programOptionsAdd(
       options, newProgramOptionWithName(OPTION_TEMPO, "tempo",
                                         "Tempo to use when processing.",
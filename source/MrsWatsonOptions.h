@@ -31,31 +31,56 @@
 
 // Runtime options
 typedef enum {
+  OPTION_AUTOMATION,
+  OPTION_BENCHMARK,
   OPTION_BIT_DEPTH,
   OPTION_BLOCKSIZE,
   OPTION_CHANNELS,
   OPTION_COLOR_LOGGING,
   OPTION_COLOR_TEST,
   OPTION_CONFIG_FILE,
+  OPTION_CPU_STATS,
+  OPTION_DAEMON,
+  OPTION_DAEMON_CHAINS,
+  OPTION_DENORMAL_CHECK,
   OPTION_DISPLAY_INFO,
   OPTION_EDITOR,
+  OPTION_END,
   OPTION_ENDIAN,
   OPTION_ERROR_REPORT,
+  OPTION_FLOAT_HEADER,
+  OPTION_FLUSH_DENORMALS,
   OPTION_HELP,
+  OPTION_HUGE_PAGES,
   OPTION_INPUT_SOURCE,
+  OPTION_IO_BLOCKSIZE,
   OPTION_LIST_FILE_TYPES,
   OPTION_LIST_PLUGINS,
   OPTION_LOG_FILE,
   OPTION_LOG_LEVEL,
   OPTION_MAX_TIME,
+  OPTION_MEMORY_STATS,
   OPTION_MIDI_SOURCE,
   OPTION_OUTPUT_SOURCE,
   OPTION_PARAMETER,
   OPTION_PLUGIN,
+  OPTION_PLUGIN_INDEX,
   OPTION_PLUGIN_ROOT,
+  OPTION_PRE_ROLL,
   OPTION_QUIET,
   OPTION_REALTIME,
   OPTION_SAMPLE_RATE,
+  OPTION_SCAN_JOBS,
+  OPTION_SCAN_PLUGINS,
+  OPTION_SCAN_TIMEOUT,
+  OPTION_SILENCE_BYPASS,
+  OPTION_START,
+  OPTION_STATUS_FILE,
+  OPTION_STATUS_INTERVAL,
+  OPTION_STATUS_SHM,
+  OPTION_TAIL_THRESHOLD,
+  OPTION_TAIL_TIME,
+  OPTION_TAIL_WINDOW,
   OPTION_TEMPO,
   OPTION_TIME_SIGNATURE,
   OPTION_VERBOSE,
@@ -0,0 +1,534 @@
+//
+// MrsWatsonSession.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "MrsWatsonSession.h"
+
+#include "audio/AudioSettings.h"
+#include "base/LinkedList.h"
+#include "logging/EventLogger.h"
+#include "midi/MidiEvent.h"
+#include "midi/MidiEventPool.h"
+#include "plugin/PluginChain.h"
+#include "plugin/PluginVst2xIndex.h"
+#include "time/AudioClock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if UNIX
+#include <pthread.h>
+#endif
+
+struct MrsWatsonSessionMembers {
+  PluginChain pluginChain;
+  SampleBuffer inputBuffer;
+  SampleBuffer outputBuffer;
+  // Views of the buffers above, which are used when the caller's buffer does
+  // not divide evenly into blocks
+  SampleBuffer inputView;
+  SampleBuffer outputView;
+  // Queued MidiEvent items, where the timestamp is the offset in frames from
+  // the start of the next buffer to be processed
+  LinkedList midiEvents;
+  // Storage for queued events, which are returned to the pool once processed
+  MidiEventPool midiEventPool;
+
+  // Settings and timeline position of this session, which are used instead of
+  // the global instances by the thread which calls into the session, and by
+  // the session's plugins when they call the host from their own threads
+  AudioSettingsMembers settings;
+  AudioClockMembers clock;
+
+  // Private fields
+#if UNIX
+  pthread_mutex_t _lock;
+#elif WINDOWS
+  CRITICAL_SECTION _lock;
+#endif
+  // Number of calls into the session which have not returned yet on the
+  // thread holding the lock, which can be more than one when a plugin calls
+  // back into the session
+  unsigned int _depth;
+  AudioSettings _previousSettings;
+  AudioClock _previousClock;
+};
+
+// Protects the global state below, and serializes opening plugins, which
+// relies on process-wide state such as the plugin index and the VST2.x
+// shell plugin ID
+#if UNIX
+static pthread_mutex_t gSessionLock = PTHREAD_MUTEX_INITIALIZER;
+#elif WINDOWS
+static SRWLOCK gSessionLock = SRWLOCK_INIT;
+#endif
+
+// Number of open sessions, and whether the first one had to set up logging
+static unsigned int gNumSessions = 0;
+static boolByte gSessionsOwnGlobalState = false;
+
+static void _lockSessions(void) {
+#if UNIX
+  pthread_mutex_lock(&gSessionLock);
+#elif WINDOWS
+  AcquireSRWLockExclusive(&gSessionLock);
+#endif
+}
+
+static void _unlockSessions(void) {
+#if UNIX
+  pthread_mutex_unlock(&gSessionLock);
+#elif WINDOWS
+  ReleaseSRWLockExclusive(&gSessionLock);
+#endif
+}
+
+// Lock the session and make the calling thread use its settings and clock.
+// Calls may be nested, for example when a plugin calls back into the session.
+static void _mrsWatsonSessionEnter(MrsWatsonSession self) {
+#if UNIX
+  pthread_mutex_lock(&self->_lock);
+#elif WINDOWS
+  EnterCriticalSection(&self->_lock);
+#endif
+
+  if (self->_depth++ == 0) {
+    self->_previousSettings = setThreadAudioSettings(&self->settings);
+    self->_previousClock = setThreadAudioClock(&self->clock);
+  }
+}
+
+static void _mrsWatsonSessionLeave(MrsWatsonSession self) {
+  if (--self->_depth == 0) {
+    setThreadAudioSettings(self->_previousSettings);
+    setThreadAudioClock(self->_previousClock);
+  }
+
+#if UNIX
+  pthread_mutex_unlock(&self->_lock);
+#elif WINDOWS
+  LeaveCriticalSection(&self->_lock);
+#endif
+}
+
+static void _freeSessionGlobalState(void) {
+  if (gNumSessions == 0 && gSessionsOwnGlobalState) {
+    freeAudioSettings();
+    freeAudioClock(audioClockInstance);
+    freeEventLogger();
+    gSessionsOwnGlobalState = false;
+  }
+}
+
+MrsWatsonSession newMrsWatsonSession(const double sampleRate,
+                                     const unsigned int numChannels,
+                                     const unsigned long blocksize) {
+  MrsWatsonSession session;
+  AudioSettings previousSettings;
+  boolByte result;
+#if UNIX
+  pthread_mutexattr_t lockAttributes;
+#endif
+
+  session = (MrsWatsonSession)malloc(sizeof(struct MrsWatsonSessionMembers));
+  audioSettingsSetDefaults(&session->settings);
+  session->clock.currentFrame = 0;
+  session->clock.transportChanged = false;
+  session->clock.isPlaying = false;
+  session->clock.tempoMap = NULL;
+
+  _lockSessions();
+
+  // A program which embeds the library has not set up the logger and audio
+  // clock, which are otherwise created by MrsWatson or its tests
+  if (gNumSessions == 0 && getAudioClock() == NULL) {
+    initEventLogger();
+    setLogLevel(LOG_ERROR);
+    initAudioClock();
+    gSessionsOwnGlobalState = true;
+  }
+
+  // The setters validate the settings, and only change the session's own
+  previousSettings = setThreadAudioSettings(&session->settings);
+  result = (boolByte)(setSampleRate((SampleRate)sampleRate) &&
+                      setNumChannels((ChannelCount)numChannels) &&
+                      setBlocksize((SampleCount)blocksize));
+  setThreadAudioSettings(previousSettings);
+
+  if (!result) {
+    _freeSessionGlobalState();
+    _unlockSessions();
+    free(session);
+    return NULL;
+  }
+
+  gNumSessions++;
+  _unlockSessions();
+
+  session->pluginChain = newPluginChain();
+  session->inputBuffer = newSampleBuffer(session->settings.numChannels,
+                                         session->settings.blocksize);
+  session->outputBuffer = newSampleBuffer(session->settings.numChannels,
+                                          session->settings.blocksize);
+  session->inputView = newSampleBufferView(session->inputBuffer, 0,
+                                           session->settings.blocksize);
+  session->outputView = newSampleBufferView(session->outputBuffer, 0,
+                                            session->settings.blocksize);
+  session->midiEvents = newLinkedList();
+  session->midiEventPool = newMidiEventPool();
+
+#if UNIX
+  pthread_mutexattr_init(&lockAttributes);
+  pthread_mutexattr_settype(&lockAttributes, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&session->_lock, &lockAttributes);
+  pthread_mutexattr_destroy(&lockAttributes);
+#elif WINDOWS
+  InitializeCriticalSection(&session->_lock);
+#endif
+  session->_depth = 0;
+  session->_previousSettings = NULL;
+  session->_previousClock = NULL;
+
+  return session;
+}
+
+ReturnCode mrsWatsonSessionLoadPluginChain(MrsWatsonSession self,
+                                           const char *pluginChain,
+                                           const char *pluginRoot) {
+  CharString chainString;
+  CharString rootString;
+  boolByte ownsPluginIndex = false;
+  ReturnCode result = RETURN_CODE_SUCCESS;
+  unsigned int i;
+
+  if (self == NULL || pluginChain == NULL) {
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  _mrsWatsonSessionEnter(self);
+
+  if (self->pluginChain->numPlugins > 0) {
+    logError("Session already has a plugin chain");
+    _mrsWatsonSessionLeave(self);
+    return RETURN_CODE_INVALID_PLUGIN_CHAIN;
+  }
+
+  chainString = newCharStringWithCString(pluginChain);
+  rootString = newCharStringWithCString(pluginRoot != NULL ? pluginRoot : "");
+  _lockSessions();
+
+  // As with a normal run, the index is only needed while opening plugins
+  if (getPluginVst2xIndex() == NULL) {
+    initPluginVst2xIndex(NULL);
+    ownsPluginIndex = true;
+  }
+
+  if (!pluginChainAddFromArgumentString(self->pluginChain, chainString,
+                                        rootString) ||
+      self->pluginChain->numPlugins == 0) {
+    logError("Plugin chain '%s' could not be opened", pluginChain);
+    result = RETURN_CODE_INVALID_PLUGIN_CHAIN;
+  } else {
+    for (i = 0; i < self->pluginChain->numPlugins; i++) {
+      self->pluginChain->plugins[i]->audioSettings = &self->settings;
+      self->pluginChain->plugins[i]->audioClock = &self->clock;
+    }
+
+    result = pluginChainInitialize(self->pluginChain);
+
+    // Saved so that mrsWatsonSessionReset() can undo parameter changes
+    if (result == RETURN_CODE_SUCCESS &&
+        !pluginChainSaveState(self->pluginChain)) {
+      result = RETURN_CODE_PLUGIN_ERROR;
+    }
+  }
+
+  if (result == RETURN_CODE_SUCCESS) {
+    pluginChainPrepareForProcessing(self->pluginChain);
+  } else {
+    // Leave the session empty, so that another chain may be loaded
+    pluginChainShutdown(self->pluginChain);
+    freePluginChain(self->pluginChain);
+    self->pluginChain = newPluginChain();
+  }
+
+  if (ownsPluginIndex) {
+    if (getPluginVst2xIndex()->isDirty) {
+      pluginVst2xIndexSave(getPluginVst2xIndex());
+    }
+
+    freePluginVst2xIndex(getPluginVst2xIndex());
+  }
+
+  _unlockSessions();
+  _mrsWatsonSessionLeave(self);
+  freeCharString(chainString);
+  freeCharString(rootString);
+  return result;
+}
+
+unsigned int mrsWatsonSessionGetNumPlugins(const MrsWatsonSession self) {
+  unsigned int numPlugins;
+
+  if (self == NULL) {
+    return 0;
+  }
+
+  _mrsWatsonSessionEnter(self);
+  numPlugins = self->pluginChain->numPlugins;
+  _mrsWatsonSessionLeave(self);
+  return numPlugins;
+}
+
+unsigned long mrsWatsonSessionGetProcessingDelay(const MrsWatsonSession self) {
+  unsigned long processingDelay;
+
+  if (self == NULL) {
+    return 0;
+  }
+
+  _mrsWatsonSessionEnter(self);
+  processingDelay = pluginChainGetProcessingDelay(self->pluginChain);
+  _mrsWatsonSessionLeave(self);
+  return processingDelay;
+}
+
+ReturnCode mrsWatsonSessionSetParameter(MrsWatsonSession self,
+                                        const unsigned int pluginIndex,
+                                        const unsigned int parameterIndex,
+                                        const float value) {
+  Plugin plugin;
+  boolByte result = false;
+
+  if (self == NULL) {
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  _mrsWatsonSessionEnter(self);
+
+  // The chain may be replaced by another thread until the session is locked
+  if (pluginIndex < self->pluginChain->numPlugins) {
+    plugin = self->pluginChain->plugins[pluginIndex];
+    result = plugin->setParameter(plugin, parameterIndex, value);
+  }
+
+  _mrsWatsonSessionLeave(self);
+  return result ? RETURN_CODE_SUCCESS : RETURN_CODE_INVALID_ARGUMENT;
+}
+
+ReturnCode mrsWatsonSessionSetTempo(MrsWatsonSession self,
+                                    const double tempo) {
+  boolByte result;
+
+  if (self == NULL) {
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  _mrsWatsonSessionEnter(self);
+  result = setTempo((Tempo)tempo);
+  _mrsWatsonSessionLeave(self);
+  return result ? RETURN_CODE_SUCCESS : RETURN_CODE_INVALID_ARGUMENT;
+}
+
+ReturnCode mrsWatsonSessionSendMidi(MrsWatsonSession self,
+                                    const unsigned long frameOffset,
+                                    const unsigned char status,
+                                    const unsigned char data1,
+                                    const unsigned char data2) {
+  MidiEvent midiEvent;
+
+  if (self == NULL || (status & 0x80) == 0) {
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  _mrsWatsonSessionEnter(self);
+  midiEvent = midiEventPoolNewEvent(self->midiEventPool);
+  midiEvent->eventType = MIDI_TYPE_REGULAR;
+  midiEvent->timestamp = frameOffset;
+  midiEvent->status = status;
+  midiEvent->data1 = data1;
+  midiEvent->data2 = data2;
+  linkedListAppend(self->midiEvents, midiEvent);
+  _mrsWatsonSessionLeave(self);
+  return RETURN_CODE_SUCCESS;
+}
+
+static void _releaseMidiEvent(void *item, void *userData) {
+  midiEventPoolReleaseEvent((MidiEventPool)userData, (MidiEvent)item);
+}
+
+// Move queued events which fall into the given block to a new list, and set
+// their delta frames relative to the start of the block
+static LinkedList _mrsWatsonSessionTakeMidiEvents(MrsWatsonSession self,
+                                                  const unsigned long offset,
+                                                  const unsigned long
+                                                      numFrames) {
+  LinkedList blockEvents = newLinkedList();
+  LinkedList remainingEvents = newLinkedList();
+  LinkedListIterator iterator;
+  MidiEvent midiEvent;
+
+  for (iterator = self->midiEvents; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    midiEvent = (MidiEvent)iterator->item;
+
+    if (midiEvent->timestamp < offset + numFrames) {
+      midiEvent->deltaFrames =
+          midiEvent->timestamp > offset ? midiEvent->timestamp - offset : 0;
+      linkedListAppend(blockEvents, midiEvent);
+    } else {
+      linkedListAppend(remainingEvents, midiEvent);
+    }
+  }
+
+  freeLinkedList(self->midiEvents);
+  self->midiEvents = remainingEvents;
+  return blockEvents;
+}
+
+ReturnCode mrsWatsonSessionProcess(MrsWatsonSession self,
+                                   const float *const *inputs,
+                                   float *const *outputs,
+                                   const unsigned long numFrames) {
+  LinkedList blockEvents;
+  LinkedListIterator iterator;
+  unsigned long offset;
+  SampleCount blockFrames;
+  SampleBuffer inputBlock;
+  SampleBuffer outputBlock;
+  ChannelCount channel;
+
+  if (self == NULL || outputs == NULL) {
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  _mrsWatsonSessionEnter(self);
+
+  if (self->pluginChain->numPlugins == 0) {
+    logError("Session has no plugin chain to process with");
+    _mrsWatsonSessionLeave(self);
+    return RETURN_CODE_INVALID_PLUGIN_CHAIN;
+  }
+
+  for (offset = 0; offset < numFrames; offset += blockFrames) {
+    blockFrames = numFrames - offset < self->settings.blocksize
+                      ? numFrames - offset
+                      : self->settings.blocksize;
+
+    // Only the last block of the buffer may be shorter than the blocksize
+    if (blockFrames < self->settings.blocksize) {
+      sampleBufferViewSetRange(self->inputView, self->inputBuffer, 0,
+                               blockFrames);
+      sampleBufferViewSetRange(self->outputView, self->outputBuffer, 0,
+                               blockFrames);
+      inputBlock = self->inputView;
+      outputBlock = self->outputView;
+    } else {
+      inputBlock = self->inputBuffer;
+      outputBlock = self->outputBuffer;
+    }
+
+    for (channel = 0; channel < self->settings.numChannels; channel++) {
+      if (inputs != NULL) {
+        memcpy(inputBlock->samples[channel], inputs[channel] + offset,
+               sizeof(Sample) * blockFrames);
+      } else {
+        memset(inputBlock->samples[channel], 0, sizeof(Sample) * blockFrames);
+      }
+    }
+
+    blockEvents = _mrsWatsonSessionTakeMidiEvents(self, offset, blockFrames);
+    pluginChainProcessMidi(self->pluginChain, blockEvents);
+    pluginChainProcessAudio(self->pluginChain, inputBlock, outputBlock);
+
+    for (channel = 0; channel < self->settings.numChannels; channel++) {
+      memcpy(outputs[channel] + offset, outputBlock->samples[channel],
+             sizeof(Sample) * blockFrames);
+    }
+
+    advanceAudioClock(&self->clock, blockFrames);
+    linkedListForeach(blockEvents, _releaseMidiEvent, self->midiEventPool);
+    freeLinkedList(blockEvents);
+  }
+
+  // Events which were queued after the end of this buffer move closer
+  for (iterator = self->midiEvents; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    ((MidiEvent)iterator->item)->timestamp -= numFrames;
+  }
+
+  _mrsWatsonSessionLeave(self);
+  return RETURN_CODE_SUCCESS;
+}
+
+ReturnCode mrsWatsonSessionReset(MrsWatsonSession self) {
+  boolByte result;
+
+  if (self == NULL) {
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  _mrsWatsonSessionEnter(self);
+  result = pluginChainReset(self->pluginChain);
+
+  if (result) {
+    pluginChainPrepareForProcessing(self->pluginChain);
+  }
+
+  linkedListForeach(self->midiEvents, _releaseMidiEvent, self->midiEventPool);
+  freeLinkedList(self->midiEvents);
+  self->midiEvents = newLinkedList();
+  audioClockSeek(&self->clock, 0);
+  audioClockStop(&self->clock);
+  _mrsWatsonSessionLeave(self);
+  return result ? RETURN_CODE_SUCCESS : RETURN_CODE_PLUGIN_ERROR;
+}
+
+void freeMrsWatsonSession(MrsWatsonSession self) {
+  if (self != NULL) {
+    _mrsWatsonSessionEnter(self);
+    pluginChainShutdown(self->pluginChain);
+    freePluginChain(self->pluginChain);
+    freeSampleBuffer(self->inputView);
+    freeSampleBuffer(self->outputView);
+    freeSampleBuffer(self->inputBuffer);
+    freeSampleBuffer(self->outputBuffer);
+    freeLinkedList(self->midiEvents);
+    freeMidiEventPool(self->midiEventPool);
+    _mrsWatsonSessionLeave(self);
+
+#if UNIX
+    pthread_mutex_destroy(&self->_lock);
+#elif WINDOWS
+    DeleteCriticalSection(&self->_lock);
+#endif
+    free(self);
+
+    _lockSessions();
+    gNumSessions--;
+    _freeSessionGlobalState();
+    _unlockSessions();
+  }
+}
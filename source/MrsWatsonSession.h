@@ -0,0 +1,172 @@
+//
+// MrsWatsonSession.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_MrsWatsonSession_h
+#define MrsWatson_MrsWatsonSession_h
+
+#include "app/ReturnCodes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Functions are only exported from the shared library on Windows when it is
+// being built, on other platforms all symbols are visible.
+#if WINDOWS && defined(MRSWATSON_BUILDING_LIBRARY)
+#define MRSWATSON_API __declspec(dllexport)
+#else
+#define MRSWATSON_API
+#endif
+
+/**
+ * A session hosts one plugin chain and processes audio and MIDI from buffers
+ * owned by the caller, without any file I/O or argument parsing. This is the
+ * API of the mrswatson shared library, which is meant for programs that embed
+ * the host directly instead of launching it for each render.
+ *
+ * Several sessions may be open at the same time, each with its own sample
+ * rate, channel count, blocksize, tempo and timeline position. These settings
+ * belong to the session and are never copied into MrsWatson's process-wide
+ * state, so different sessions may process in parallel on different threads.
+ * Each session has its own lock, so calls on one session are serialized, but
+ * a plugin may call back into its session from within a call. Loading a
+ * plugin chain is serialized across all sessions.
+ *
+ * When the first session is created in a program which has not set up logging
+ * itself, errors are logged to stderr. Everything which is allocated for this
+ * is released again when the last session is freed.
+ */
+typedef struct MrsWatsonSessionMembers *MrsWatsonSession;
+
+/**
+ * Create a new session without any plugins.
+ * @param sampleRate Sample rate, in Hz
+ * @param numChannels Number of channels of the audio buffers
+ * @param blocksize Largest number of frames which plugins process at once.
+ * Longer buffers may be given to mrsWatsonSessionProcess(), which splits them
+ * into blocks.
+ * @return Session, or NULL if any of the settings are invalid
+ */
+MRSWATSON_API MrsWatsonSession
+newMrsWatsonSession(const double sampleRate, const unsigned int numChannels,
+                    const unsigned long blocksize);
+
+/**
+ * Open and initialize the plugin chain of a session. A session has only one
+ * chain, so this may only be called once.
+ * @param self
+ * @param pluginChain Plugin chain, in the same format as the --plugin option
+ * @param pluginRoot Extra directory to search for plugins, or NULL
+ * @return RETURN_CODE_SUCCESS if the chain is ready to process audio
+ */
+MRSWATSON_API ReturnCode mrsWatsonSessionLoadPluginChain(
+    MrsWatsonSession self, const char *pluginChain, const char *pluginRoot);
+
+/**
+ * @param self
+ * @return Number of plugins in the session's chain
+ */
+MRSWATSON_API unsigned int
+mrsWatsonSessionGetNumPlugins(const MrsWatsonSession self);
+
+/**
+ * @param self
+ * @return Processing delay of the chain, in frames. The output of
+ * mrsWatsonSessionProcess() lags behind the input by this amount.
+ */
+MRSWATSON_API unsigned long
+mrsWatsonSessionGetProcessingDelay(const MrsWatsonSession self);
+
+/**
+ * Set a parameter of one of the plugins in the chain.
+ * @param self
+ * @param pluginIndex Position of the plugin in the chain, starting from 0
+ * @param parameterIndex Index of the parameter
+ * @param value New value, normally between 0.0 and 1.0
+ * @return RETURN_CODE_SUCCESS if the parameter was set
+ */
+MRSWATSON_API ReturnCode mrsWatsonSessionSetParameter(
+    MrsWatsonSession self, const unsigned int pluginIndex,
+    const unsigned int parameterIndex, const float value);
+
+/**
+ * Set the tempo which is reported to the session's plugins.
+ * @param self
+ * @param tempo Tempo, in beats per minute
+ * @return RETURN_CODE_SUCCESS if the tempo was valid
+ */
+MRSWATSON_API ReturnCode mrsWatsonSessionSetTempo(MrsWatsonSession self,
+                                                  const double tempo);
+
+/**
+ * Queue a MIDI message for the next call to mrsWatsonSessionProcess().
+ * @param self
+ * @param frameOffset Position of the message, in frames from the start of the
+ * next buffer which is processed. Messages after the end of that buffer stay
+ * queued for the following calls.
+ * @param status MIDI status byte
+ * @param data1 First data byte
+ * @param data2 Second data byte
+ * @return RETURN_CODE_SUCCESS if the message was queued
+ */
+MRSWATSON_API ReturnCode mrsWatsonSessionSendMidi(
+    MrsWatsonSession self, const unsigned long frameOffset,
+    const unsigned char status, const unsigned char data1,
+    const unsigned char data2);
+
+/**
+ * Process audio with the session's plugin chain. Buffers are not interleaved,
+ * and have one array of samples for each of the session's channels.
+ * @param self
+ * @param inputs Input samples, or NULL to process silence (for instruments)
+ * @param outputs Arrays which receive the output samples
+ * @param numFrames Number of frames in each array
+ * @return RETURN_CODE_SUCCESS if the audio was processed
+ */
+MRSWATSON_API ReturnCode mrsWatsonSessionProcess(MrsWatsonSession self,
+                                                 const float *const *inputs,
+                                                 float *const *outputs,
+                                                 const unsigned long numFrames);
+
+/**
+ * Reset the session's plugins to the state they were in after the chain was
+ * loaded, drop any queued MIDI messages and rewind the timeline.
+ * @param self
+ * @return RETURN_CODE_SUCCESS if all plugins could be reset
+ */
+MRSWATSON_API ReturnCode mrsWatsonSessionReset(MrsWatsonSession self);
+
+/**
+ * Close the session's plugins and free the session.
+ * @param self
+ */
+MRSWATSON_API void freeMrsWatsonSession(MrsWatsonSession self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
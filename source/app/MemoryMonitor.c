@@ -0,0 +1,210 @@
+//
+// MemoryMonitor.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "MemoryMonitor.h"
+
+#include "base/MemoryTracker.h"
+#include "logging/EventLogger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BYTES_PER_MEGABYTE (1024.0 * 1024.0)
+#define SECONDS_PER_HOUR 3600.0
+
+MemoryMonitor newMemoryMonitor(void) {
+  MemoryMonitor self = (MemoryMonitor)malloc(sizeof(MemoryMonitorMembers));
+
+  self->intervalInMs = MEMORY_MONITOR_DEFAULT_INTERVAL_IN_MS;
+  self->numSamples = 0;
+  self->startResidentBytes = 0;
+  self->peakResidentBytes = 0;
+  self->currentResidentBytes = 0;
+
+  self->_timer = newTaskTimerWithCString("MemoryMonitor", "Wall Clock");
+  self->_lastSampleTime = 0.0;
+  memset(&self->_residentTrend, 0, sizeof(MemoryMonitorTrendMembers));
+  memset(&self->_hostTrend, 0, sizeof(MemoryMonitorTrendMembers));
+
+  return self;
+}
+
+static double _getElapsedTime(MemoryMonitor self) {
+  // The timer only adds to its total when stopped, so restart it to read it
+  taskTimerStop(self->_timer);
+  taskTimerStart(self->_timer);
+  return self->_timer->totalTaskTime;
+}
+
+static void _sample(MemoryMonitor self, const double elapsedInMs) {
+  memoryMonitorAddSample(self, elapsedInMs / 1000.0,
+                         memoryTrackerGetResidentBytes(),
+                         memoryTrackerGetTotalBytes());
+  self->_lastSampleTime = elapsedInMs;
+}
+
+void memoryMonitorStart(MemoryMonitor self) {
+  taskTimerStart(self->_timer);
+  _sample(self, 0.0);
+}
+
+void memoryMonitorUpdate(MemoryMonitor self) {
+  const double elapsed = _getElapsedTime(self);
+
+  if (elapsed - self->_lastSampleTime >= (double)self->intervalInMs) {
+    _sample(self, elapsed);
+  }
+}
+
+static void _addTrendSample(MemoryMonitorTrend trend, const double x,
+                            const double y) {
+  trend->numSamples++;
+  trend->sumX += x;
+  trend->sumY += y;
+  trend->sumXX += x * x;
+  trend->sumXY += x * y;
+}
+
+// Slope of the least-squares line through the samples, in megabytes per hour
+static boolByte _getTrendSlope(const MemoryMonitorTrend trend,
+                               double *outMegabytesPerHour) {
+  const double n = (double)trend->numSamples;
+  double denominator;
+
+  if (trend->numSamples < MEMORY_MONITOR_MIN_TREND_SAMPLES) {
+    return false;
+  }
+
+  denominator = n * trend->sumXX - trend->sumX * trend->sumX;
+
+  if (denominator <= 0.0) {
+    return false;
+  }
+
+  *outMegabytesPerHour = (n * trend->sumXY - trend->sumX * trend->sumY) /
+                         denominator * SECONDS_PER_HOUR;
+  return true;
+}
+
+void memoryMonitorAddSample(MemoryMonitor self, const double timeInSeconds,
+                            const size_t residentBytes,
+                            const size_t hostBytes) {
+  if (self->numSamples == 0) {
+    self->startResidentBytes = residentBytes;
+  }
+
+  if (residentBytes > self->peakResidentBytes) {
+    self->peakResidentBytes = residentBytes;
+  }
+
+  self->currentResidentBytes = residentBytes;
+  self->numSamples++;
+
+  if (self->numSamples > MEMORY_MONITOR_WARMUP_SAMPLES) {
+    // Sizes are added in megabytes to keep the sums small enough for doubles
+    // to stay precise over long renders
+    _addTrendSample(&self->_residentTrend, timeInSeconds,
+                    (double)residentBytes / BYTES_PER_MEGABYTE);
+    _addTrendSample(&self->_hostTrend, timeInSeconds,
+                    (double)hostBytes / BYTES_PER_MEGABYTE);
+  }
+}
+
+boolByte memoryMonitorGetResidentGrowth(const MemoryMonitor self,
+                                        double *outMegabytesPerHour) {
+  return _getTrendSlope(&self->_residentTrend, outMegabytesPerHour);
+}
+
+boolByte memoryMonitorGetHostGrowth(const MemoryMonitor self,
+                                    double *outMegabytesPerHour) {
+  return _getTrendSlope(&self->_hostTrend, outMegabytesPerHour);
+}
+
+static double _toMegabytes(const size_t numBytes) {
+  return (double)numBytes / BYTES_PER_MEGABYTE;
+}
+
+void memoryMonitorReport(MemoryMonitor self) {
+  MemoryUsageMembers usage;
+  double residentGrowth = 0.0;
+  double hostGrowth = 0.0;
+  unsigned int i;
+
+  _sample(self, _getElapsedTime(self));
+  taskTimerStop(self->_timer);
+
+  logInfo("Memory usage results:");
+
+  if (memoryTrackerIsEnabled()) {
+    for (i = 0; i < NUM_MEMORY_TAGS; i++) {
+      memoryTrackerGetUsage((MemoryTag)i, &usage);
+      logInfo("  %s: %.2fMB current, %.2fMB peak, %lu allocations",
+              memoryTagGetName((MemoryTag)i), _toMegabytes(usage.currentBytes),
+              _toMegabytes(usage.peakBytes), usage.numAllocations);
+    }
+  } else {
+    logInfo("  Host memory is only tracked when --memory-stats is given on the "
+            "command line");
+  }
+
+  if (self->peakResidentBytes == 0) {
+    logInfo("  Resident memory is not available on this platform");
+    return;
+  }
+
+  logInfo("  Resident memory: %.2fMB at start, %.2fMB peak, %.2fMB at end",
+          _toMegabytes(self->startResidentBytes),
+          _toMegabytes(self->peakResidentBytes),
+          _toMegabytes(self->currentResidentBytes));
+
+  if (!memoryMonitorGetResidentGrowth(self, &residentGrowth) ||
+      !memoryMonitorGetHostGrowth(self, &hostGrowth)) {
+    logInfo("  Render was too short to measure the growth rate, which needs "
+            "%d samples taken every %lums",
+            MEMORY_MONITOR_WARMUP_SAMPLES + MEMORY_MONITOR_MIN_TREND_SAMPLES,
+            self->intervalInMs);
+    return;
+  }
+
+  logInfo("  Steady-state growth: %.2fMB/hour resident, %.2fMB/hour host",
+          residentGrowth, hostGrowth);
+
+  // Without tracking, the host's memory always looks flat
+  if (memoryTrackerIsEnabled() &&
+      residentGrowth > MEMORY_MONITOR_LEAK_THRESHOLD_MB_PER_HOUR &&
+      hostGrowth < MEMORY_MONITOR_LEAK_THRESHOLD_MB_PER_HOUR / 2.0) {
+    logWarn("Resident memory grows by %.2fMB/hour while the host's memory "
+            "does not, so a plugin may be leaking memory",
+            residentGrowth);
+  }
+}
+
+void freeMemoryMonitor(MemoryMonitor self) {
+  if (self != NULL) {
+    freeTaskTimer(self->_timer);
+    free(self);
+  }
+}
@@ -0,0 +1,139 @@
+//
+// MemoryMonitor.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_MemoryMonitor_h
+#define MrsWatson_MemoryMonitor_h
+
+#include "base/Types.h"
+#include "time/TaskTimer.h"
+
+#include <stddef.h>
+
+#define MEMORY_MONITOR_DEFAULT_INTERVAL_IN_MS 1000
+// Samples taken while plugins are still allocating their buffers and caches
+// are not used to calculate the growth rate
+#define MEMORY_MONITOR_WARMUP_SAMPLES 5
+// Minimum number of samples after the warmup to calculate the growth rate
+#define MEMORY_MONITOR_MIN_TREND_SAMPLES 10
+// Resident memory growing faster than this in the steady state is reported as
+// a possible leak
+#define MEMORY_MONITOR_LEAK_THRESHOLD_MB_PER_HOUR 8.0
+
+typedef struct {
+  unsigned long numSamples;
+  double sumX;
+  double sumY;
+  double sumXX;
+  double sumXY;
+} MemoryMonitorTrendMembers;
+typedef MemoryMonitorTrendMembers *MemoryMonitorTrend;
+
+/**
+ * Samples the resident set size (RSS) of the process and the memory which is
+ * tracked by the host at a fixed interval while rendering. The growth rate of
+ * both is calculated with a least-squares fit over all samples after the
+ * warmup. As plugin allocations only show up in the RSS, a growing RSS with a
+ * flat host total usually points to a plugin which leaks memory.
+ */
+typedef struct {
+  unsigned long intervalInMs;
+  unsigned long numSamples;
+
+  size_t startResidentBytes;
+  size_t peakResidentBytes;
+  size_t currentResidentBytes;
+
+  // Private fields
+  TaskTimer _timer;
+  double _lastSampleTime;
+  MemoryMonitorTrendMembers _residentTrend;
+  MemoryMonitorTrendMembers _hostTrend;
+} MemoryMonitorMembers;
+typedef MemoryMonitorMembers *MemoryMonitor;
+
+/**
+ * @return New memory monitor, which does not sample anything until started
+ */
+MemoryMonitor newMemoryMonitor(void);
+
+/**
+ * Start the wall clock and take the first sample
+ * @param self
+ */
+void memoryMonitorStart(MemoryMonitor self);
+
+/**
+ * Called after each processed block. This only checks the wall clock, unless
+ * the sampling interval has passed.
+ * @param self
+ */
+void memoryMonitorUpdate(MemoryMonitor self);
+
+/**
+ * Add a sample to the monitor. This is normally called by
+ * memoryMonitorUpdate(), but can be called directly to feed in known values.
+ * @param self
+ * @param timeInSeconds Time of the sample since the start
+ * @param residentBytes Resident set size of the process
+ * @param hostBytes Memory tracked by the host
+ */
+void memoryMonitorAddSample(MemoryMonitor self, const double timeInSeconds,
+                            const size_t residentBytes,
+                            const size_t hostBytes);
+
+/**
+ * Get the steady-state growth rate of the resident set size
+ * @param self
+ * @param outMegabytesPerHour Growth rate, which is negative if memory shrinks
+ * @return True if enough samples were taken to calculate the rate
+ */
+boolByte memoryMonitorGetResidentGrowth(const MemoryMonitor self,
+                                        double *outMegabytesPerHour);
+
+/**
+ * Get the steady-state growth rate of the memory tracked by the host
+ * @param self
+ * @param outMegabytesPerHour Growth rate, which is negative if memory shrinks
+ * @return True if enough samples were taken to calculate the rate
+ */
+boolByte memoryMonitorGetHostGrowth(const MemoryMonitor self,
+                                    double *outMegabytesPerHour);
+
+/**
+ * Take a final sample, and log the current and peak usage of each subsystem
+ * along with the growth rates. A warning is logged if the RSS grows while the
+ * host's own memory does not.
+ * @param self
+ */
+void memoryMonitorReport(MemoryMonitor self);
+
+/**
+ * Free a memory monitor
+ * @param self
+ */
+void freeMemoryMonitor(MemoryMonitor self);
+
+#endif
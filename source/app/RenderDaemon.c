@@ -0,0 +1,851 @@
+//
+// RenderDaemon.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RenderDaemon.h"
+
+#include "MrsWatson.h"
+#include "app/RenderLoop.h"
+#include "io/SampleSource.h"
+#include "io/SampleSourcePcm.h"
+#include "logging/EventLogger.h"
+#include "midi/MidiSequence.h"
+#include "midi/MidiSource.h"
+#include "plugin/PluginAutomation.h"
+#include "time/AudioClock.h"
+#include "time/TaskTimer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if UNIX
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+static const char *kRenderDaemonKeyCommand = "command";
+static const char *kRenderDaemonKeyPlugin = "plugin";
+static const char *kRenderDaemonKeyInput = "input";
+static const char *kRenderDaemonKeyOutput = "output";
+static const char *kRenderDaemonKeyMidi = "midi";
+static const char *kRenderDaemonKeyParameter = "parameter";
+static const char *kRenderDaemonKeyMaxTime = "max-time";
+static const char *kRenderDaemonKeyAutomation = "automation";
+static const char *kRenderDaemonKeyIoBlocksize = "io-blocksize";
+static const char *kRenderDaemonKeySilenceBypass = "silence-bypass";
+static const char *kRenderDaemonKeyStatusFile = "status-file";
+static const char *kRenderDaemonKeyStatus = "status";
+static const char *kRenderDaemonKeyError = "error";
+static const char *kRenderDaemonKeyWarm = "warm";
+static const char *kRenderDaemonKeyFrames = "frames";
+static const char *kRenderDaemonKeySetupTime = "setup-ms";
+static const char *kRenderDaemonKeyRenderTime = "render-ms";
+
+static const char *kRenderDaemonCommandRender = "render";
+static const char *kRenderDaemonCommandShutdown = "shutdown";
+
+// Sample sources and MIDI used by a single job
+typedef struct {
+  SampleSource inputSource;
+  SampleSource outputSource;
+  MidiSource midiSource;
+  MidiSequence midiSequence;
+  PluginAutomation automation;
+  RenderStatus renderStatus;
+} _RenderDaemonJobSourcesMembers;
+typedef _RenderDaemonJobSourcesMembers *_RenderDaemonJobSources;
+
+static void _setRenderDaemonJobValue(CharString field, const char *value) {
+  // Paths and plugin chains may be longer than the default string capacity
+  charStringClear(field);
+  charStringAppendCString(field, value);
+}
+
+RenderDaemonJob newRenderDaemonJobWithString(const CharString text) {
+  RenderDaemonJob job = (RenderDaemonJob)malloc(sizeof(RenderDaemonJobMembers));
+  LinkedList lines;
+  LinkedListIterator iterator;
+  CharString line;
+  char *value;
+
+  job->command = RENDER_DAEMON_COMMAND_RENDER;
+  job->pluginChain = newCharString();
+  job->inputSource = newCharString();
+  job->outputSource = newCharString();
+  job->midiSource = newCharString();
+  job->parameters = newLinkedList();
+  job->maxTimeInMs = 0;
+  job->automationFile = newCharString();
+  job->ioBlocksize = 0;
+  job->silenceBypass = false;
+  job->silenceBypassThresholdInDb =
+      PLUGIN_CHAIN_SILENCE_BYPASS_DEFAULT_THRESHOLD_IN_DB;
+  job->statusFile = newCharString();
+
+  job->result = RETURN_CODE_NOT_RUN;
+  job->errorMessage = newCharString();
+  job->usedWarmChain = false;
+  job->framesWritten = 0;
+  job->setupTimeInMs = 0.0;
+  job->renderTimeInMs = 0.0;
+
+  if (text == NULL || charStringIsEmpty(text)) {
+    job->command = RENDER_DAEMON_COMMAND_INVALID;
+    charStringCopyCString(job->errorMessage, "Empty request");
+    return job;
+  }
+
+  lines = charStringSplit(text, '\n');
+
+  for (iterator = lines; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    line = (CharString)iterator->item;
+
+    if (charStringIsEmpty(line)) {
+      continue;
+    }
+
+    value = strchr(line->data, '\t');
+
+    if (value == NULL) {
+      job->command = RENDER_DAEMON_COMMAND_INVALID;
+      snprintf(job->errorMessage->data, job->errorMessage->capacity,
+               "Malformed request line '%s'", line->data);
+      break;
+    }
+
+    *value++ = '\0';
+
+    if (!strcmp(line->data, kRenderDaemonKeyCommand)) {
+      if (!strcmp(value, kRenderDaemonCommandRender)) {
+        job->command = RENDER_DAEMON_COMMAND_RENDER;
+      } else if (!strcmp(value, kRenderDaemonCommandShutdown)) {
+        job->command = RENDER_DAEMON_COMMAND_SHUTDOWN;
+      } else {
+        job->command = RENDER_DAEMON_COMMAND_INVALID;
+        snprintf(job->errorMessage->data, job->errorMessage->capacity,
+                 "Unknown command '%s'", value);
+        break;
+      }
+    } else if (!strcmp(line->data, kRenderDaemonKeyPlugin)) {
+      _setRenderDaemonJobValue(job->pluginChain, value);
+    } else if (!strcmp(line->data, kRenderDaemonKeyInput)) {
+      _setRenderDaemonJobValue(job->inputSource, value);
+    } else if (!strcmp(line->data, kRenderDaemonKeyOutput)) {
+      _setRenderDaemonJobValue(job->outputSource, value);
+    } else if (!strcmp(line->data, kRenderDaemonKeyMidi)) {
+      _setRenderDaemonJobValue(job->midiSource, value);
+    } else if (!strcmp(line->data, kRenderDaemonKeyParameter)) {
+      linkedListAppend(job->parameters, newCharStringWithCString(value));
+    } else if (!strcmp(line->data, kRenderDaemonKeyMaxTime)) {
+      job->maxTimeInMs = strtoul(value, NULL, 10);
+    } else if (!strcmp(line->data, kRenderDaemonKeyAutomation)) {
+      _setRenderDaemonJobValue(job->automationFile, value);
+    } else if (!strcmp(line->data, kRenderDaemonKeyIoBlocksize)) {
+      job->ioBlocksize = (SampleCount)strtoul(value, NULL, 10);
+    } else if (!strcmp(line->data, kRenderDaemonKeySilenceBypass)) {
+      job->silenceBypass = true;
+
+      if (*value != '\0') {
+        job->silenceBypassThresholdInDb = strtod(value, NULL);
+      }
+    } else if (!strcmp(line->data, kRenderDaemonKeyStatusFile)) {
+      _setRenderDaemonJobValue(job->statusFile, value);
+    } else {
+      job->command = RENDER_DAEMON_COMMAND_INVALID;
+      snprintf(job->errorMessage->data, job->errorMessage->capacity,
+               "Unknown request key '%s'", line->data);
+      break;
+    }
+  }
+
+  freeLinkedListAndItems(lines, (LinkedListFreeItemFunc)freeCharString);
+  return job;
+}
+
+static void _renderDaemonAppendResponseLine(CharString response,
+                                            const char *key,
+                                            const char *value) {
+  charStringAppendCString(response, key);
+  charStringAppendCString(response, "\t");
+  charStringAppendCString(response, value);
+  charStringAppendCString(response, "\n");
+}
+
+CharString renderDaemonJobGetResponse(const RenderDaemonJob self) {
+  CharString response = newCharString();
+  CharString value = newCharStringWithCapacity(kCharStringLengthShort);
+  char *newline;
+
+  if (self->result == RETURN_CODE_SUCCESS) {
+    _renderDaemonAppendResponseLine(response, kRenderDaemonKeyStatus, "ok");
+  } else {
+    _renderDaemonAppendResponseLine(response, kRenderDaemonKeyStatus, "error");
+
+    // A newline in the message would end the response early
+    while ((newline = strchr(self->errorMessage->data, '\n')) != NULL) {
+      *newline = ' ';
+    }
+
+    _renderDaemonAppendResponseLine(response, kRenderDaemonKeyError,
+                                    self->errorMessage->data);
+  }
+
+  _renderDaemonAppendResponseLine(response, kRenderDaemonKeyWarm,
+                                  self->usedWarmChain ? "1" : "0");
+  snprintf(value->data, value->capacity, "%lu", self->framesWritten);
+  _renderDaemonAppendResponseLine(response, kRenderDaemonKeyFrames,
+                                  value->data);
+  snprintf(value->data, value->capacity, "%.1f", self->setupTimeInMs);
+  _renderDaemonAppendResponseLine(response, kRenderDaemonKeySetupTime,
+                                  value->data);
+  snprintf(value->data, value->capacity, "%.1f", self->renderTimeInMs);
+  _renderDaemonAppendResponseLine(response, kRenderDaemonKeyRenderTime,
+                                  value->data);
+  charStringAppendCString(response, "\n");
+
+  freeCharString(value);
+  return response;
+}
+
+void freeRenderDaemonJob(RenderDaemonJob self) {
+  if (self != NULL) {
+    freeCharString(self->pluginChain);
+    freeCharString(self->inputSource);
+    freeCharString(self->outputSource);
+    freeCharString(self->midiSource);
+    freeLinkedListAndItems(self->parameters,
+                           (LinkedListFreeItemFunc)freeCharString);
+    freeCharString(self->automationFile);
+    freeCharString(self->statusFile);
+    freeCharString(self->errorMessage);
+    free(self);
+  }
+}
+
+RenderDaemon newRenderDaemon(const CharString socketPath,
+                             const CharString pluginRoot,
+                             const unsigned int maxChains) {
+  RenderDaemon daemon = (RenderDaemon)malloc(sizeof(RenderDaemonMembers));
+  unsigned int i;
+
+  daemon->socketPath = newCharStringWithCString(socketPath->data);
+  daemon->pluginRoot = pluginRoot != NULL
+                           ? newCharStringWithCString(pluginRoot->data)
+                           : newCharString();
+
+  daemon->maxChains =
+      maxChains > 0 ? maxChains : RENDER_DAEMON_DEFAULT_MAX_CHAINS;
+  daemon->numChains = 0;
+  daemon->chains = (RenderDaemonChain *)malloc(sizeof(RenderDaemonChain) *
+                                               daemon->maxChains);
+
+  for (i = 0; i < daemon->maxChains; i++) {
+    daemon->chains[i] = NULL;
+  }
+
+  daemon->numJobs = 0;
+
+  daemon->_shouldShutdown = false;
+  daemon->_sampleRate = getSampleRate();
+  daemon->_numChannels = getNumChannels();
+  daemon->_tempo = getTempo();
+  daemon->_beatsPerMeasure = getTimeSignatureBeatsPerMeasure();
+  daemon->_noteValue = getTimeSignatureNoteValue();
+
+  return daemon;
+}
+
+static void _freeRenderDaemonChain(RenderDaemonChain self) {
+  if (self != NULL) {
+    logInfo("Closing plugin chain '%s'", self->pluginChainString->data);
+    pluginChainShutdown(self->pluginChain);
+    freePluginChain(self->pluginChain);
+    freeCharString(self->pluginChainString);
+    free(self);
+  }
+}
+
+static void _renderDaemonRemoveChain(RenderDaemon self, unsigned int index) {
+  _freeRenderDaemonChain(self->chains[index]);
+  self->numChains--;
+  self->chains[index] = self->chains[self->numChains];
+  self->chains[self->numChains] = NULL;
+}
+
+static PluginChain _newRenderDaemonPluginChain(RenderDaemon self,
+                                               const CharString chainString) {
+  PluginChain pluginChain = newPluginChain();
+
+  if (!pluginChainAddFromArgumentString(pluginChain, chainString,
+                                        self->pluginRoot) ||
+      pluginChain->numPlugins == 0 ||
+      pluginChainInitialize(pluginChain) != RETURN_CODE_SUCCESS ||
+      // Jobs may change any plugin's parameters, which must not leak into the
+      // next job which uses this chain
+      !pluginChainSaveState(pluginChain)) {
+    pluginChainShutdown(pluginChain);
+    freePluginChain(pluginChain);
+    return NULL;
+  }
+
+  return pluginChain;
+}
+
+PluginChain renderDaemonGetChain(RenderDaemon self,
+                                 const CharString pluginChainString,
+                                 boolByte *outIsWarm) {
+  RenderDaemonChain chain = NULL;
+  PluginChain pluginChain;
+  unsigned int leastRecentlyUsed = 0;
+  unsigned int i;
+
+  *outIsWarm = false;
+
+  for (i = 0; i < self->numChains; i++) {
+    if (charStringIsEqualTo(self->chains[i]->pluginChainString,
+                            pluginChainString, false)) {
+      chain = self->chains[i];
+
+      if (pluginChainReset(chain->pluginChain)) {
+        chain->lastUsed = ++self->numJobs;
+        *outIsWarm = true;
+        return chain->pluginChain;
+      }
+
+      logWarn("Plugin chain '%s' could not be reset, reopening it",
+              pluginChainString->data);
+      _renderDaemonRemoveChain(self, i);
+      break;
+    }
+  }
+
+  logInfo("Opening plugin chain '%s'", pluginChainString->data);
+  pluginChain = _newRenderDaemonPluginChain(self, pluginChainString);
+
+  if (pluginChain == NULL) {
+    return NULL;
+  }
+
+  if (self->numChains == self->maxChains) {
+    for (i = 1; i < self->numChains; i++) {
+      if (self->chains[i]->lastUsed <
+          self->chains[leastRecentlyUsed]->lastUsed) {
+        leastRecentlyUsed = i;
+      }
+    }
+
+    _renderDaemonRemoveChain(self, leastRecentlyUsed);
+  }
+
+  chain = (RenderDaemonChain)malloc(sizeof(RenderDaemonChainMembers));
+  chain->pluginChainString =
+      newCharStringWithCString(pluginChainString->data);
+  chain->pluginChain = pluginChain;
+  chain->lastUsed = ++self->numJobs;
+  self->chains[self->numChains++] = chain;
+
+  return pluginChain;
+}
+
+static void _renderDaemonRestoreSettings(RenderDaemon self) {
+  setSampleRate(self->_sampleRate);
+  setNumChannels(self->_numChannels);
+  setTempo(self->_tempo);
+  setTimeSignatureBeatsPerMeasure(self->_beatsPerMeasure);
+  setTimeSignatureNoteValue(self->_noteValue);
+  audioClockSeek(getAudioClock(), 0);
+  getAudioClock()->isPlaying = false;
+  getAudioClock()->tempoMap = NULL;
+}
+
+static boolByte _isStandardStream(const CharString sourceName) {
+  return (boolByte)(sourceName != NULL &&
+                    charStringIsEqualToCString(sourceName, "-", false));
+}
+
+static void _closeRenderDaemonSampleSource(SampleSource sampleSource) {
+  if (sampleSource != NULL) {
+    if (sampleSource->openedAs != SAMPLE_SOURCE_OPEN_NOT_OPENED) {
+      sampleSource->closeSampleSource(sampleSource);
+    }
+
+    freeSampleSource(sampleSource);
+  }
+}
+
+static void _freeRenderDaemonJobSources(_RenderDaemonJobSources self) {
+  _closeRenderDaemonSampleSource(self->inputSource);
+  _closeRenderDaemonSampleSource(self->outputSource);
+  freeMidiSource(self->midiSource);
+
+  // The clock must not be left with the tempo map of a freed sequence
+  if (self->midiSequence != NULL &&
+      getAudioClock()->tempoMap == self->midiSequence->tempoMap) {
+    getAudioClock()->tempoMap = NULL;
+  }
+
+  freeMidiSequence(self->midiSequence);
+  freePluginAutomation(self->automation);
+  freeRenderStatus(self->renderStatus);
+}
+
+static boolByte _openRenderDaemonJobSources(RenderDaemon self,
+                                            RenderDaemonJob job,
+                                            PluginChain pluginChain,
+                                            _RenderDaemonJobSources sources) {
+  CharString errorMessage = job->errorMessage;
+
+  if (_isStandardStream(job->inputSource) ||
+      _isStandardStream(job->outputSource) ||
+      _isStandardStream(job->midiSource)) {
+    charStringCopyCString(errorMessage,
+                          "Standard input and output cannot be used");
+    return false;
+  }
+
+  if (!charStringIsEmpty(job->midiSource)) {
+    sources->midiSource = newMidiSource(guessMidiSourceType(job->midiSource),
+                                        job->midiSource);
+
+    if (sources->midiSource == NULL ||
+        !sources->midiSource->openMidiSource(sources->midiSource)) {
+      snprintf(errorMessage->data, errorMessage->capacity,
+               "MIDI source '%s' could not be opened", job->midiSource->data);
+      return false;
+    }
+
+    sources->midiSequence = newMidiSequence();
+
+    if (!sources->midiSource->readMidiEvents(sources->midiSource,
+                                             sources->midiSequence)) {
+      snprintf(errorMessage->data, errorMessage->capacity,
+               "Failed reading MIDI events from '%s'", job->midiSource->data);
+      return false;
+    }
+
+    // Let the clock report musical time which follows the file's tempo
+    getAudioClock()->tempoMap = sources->midiSequence->tempoMap;
+  }
+
+  if (!charStringIsEmpty(job->automationFile)) {
+    sources->automation = newPluginAutomation();
+
+    if (!pluginAutomationReadFile(sources->automation, job->automationFile) ||
+        !pluginAutomationIsValidForChain(sources->automation, pluginChain)) {
+      snprintf(errorMessage->data, errorMessage->capacity,
+               "Automation file '%s' is not valid for the plugin chain",
+               job->automationFile->data);
+      return false;
+    }
+  }
+
+  // The render is more important than its status, so keep going anyways
+  if (!charStringIsEmpty(job->statusFile)) {
+    sources->renderStatus = newRenderStatus();
+    renderStatusSetFile(sources->renderStatus, job->statusFile);
+  }
+
+  if (charStringIsEmpty(job->inputSource)) {
+    if (pluginChain->plugins[0]->pluginType != PLUGIN_TYPE_INSTRUMENT) {
+      charStringCopyCString(errorMessage, "Plugin chain contains only "
+                                          "effects, but no input source was "
+                                          "given");
+      return false;
+    } else if (sources->midiSequence == NULL && job->maxTimeInMs == 0) {
+      charStringCopyCString(errorMessage, "No MIDI source or maximum time "
+                                          "was given, don't know when to "
+                                          "stop processing");
+      return false;
+    }
+  }
+
+  sources->inputSource = sampleSourceFactory(job->inputSource);
+
+  if (sources->inputSource == NULL) {
+    snprintf(errorMessage->data, errorMessage->capacity,
+             "Input source '%s' has an unsupported type",
+             job->inputSource->data);
+    return false;
+  }
+
+  if (sources->inputSource->sampleSourceType == SAMPLE_SOURCE_TYPE_PCM) {
+    sampleSourcePcmSetSampleRate(sources->inputSource, getSampleRate());
+    sampleSourcePcmSetNumChannels(sources->inputSource, getNumChannels());
+  }
+
+  if (!sources->inputSource->openSampleSource(sources->inputSource,
+                                              SAMPLE_SOURCE_OPEN_READ)) {
+    snprintf(errorMessage->data, errorMessage->capacity,
+             "Input source '%s' could not be opened", job->inputSource->data);
+    return false;
+  }
+
+  // The plugins in the pool were opened with the daemon's sample rate
+  if (getSampleRate() != self->_sampleRate) {
+    snprintf(errorMessage->data, errorMessage->capacity,
+             "Input source '%s' has a sample rate of %.0fHz, but the daemon "
+             "is running at %.0fHz",
+             job->inputSource->data, getSampleRate(), self->_sampleRate);
+    return false;
+  }
+
+  if (charStringIsEmpty(job->outputSource)) {
+    charStringCopyCString(errorMessage, "No output source was given");
+    return false;
+  }
+
+  sources->outputSource = sampleSourceFactory(job->outputSource);
+
+  if (sources->outputSource == NULL ||
+      !sources->outputSource->openSampleSource(sources->outputSource,
+                                               SAMPLE_SOURCE_OPEN_WRITE)) {
+    snprintf(errorMessage->data, errorMessage->capacity,
+             "Output source '%s' could not be opened",
+             job->outputSource->data);
+    return false;
+  }
+
+  return true;
+}
+
+static boolByte _setRenderDaemonJobParameters(RenderDaemonJob job,
+                                              PluginChain pluginChain) {
+  LinkedList parameters;
+  LinkedListIterator iterator;
+  boolByte result;
+
+  if (job->parameters->item == NULL) {
+    return true;
+  }
+
+  // The chain expects the same list of C strings as is given by --parameter
+  parameters = newLinkedList();
+
+  for (iterator = job->parameters; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    linkedListAppend(parameters, ((CharString)iterator->item)->data);
+  }
+
+  result = pluginChainSetParameters(pluginChain, parameters);
+  freeLinkedList(parameters);
+
+  if (!result) {
+    charStringCopyCString(job->errorMessage, "Invalid parameter");
+  }
+
+  return result;
+}
+
+static void _renderDaemonProcess(RenderDaemonJob job, PluginChain pluginChain,
+                                 _RenderDaemonJobSources sources) {
+  RenderLoop renderLoop =
+      newRenderLoop(pluginChain, sources->inputSource, sources->outputSource,
+                    "RenderDaemon");
+
+  renderLoop->midiSequence = sources->midiSequence;
+  renderLoop->automation = sources->automation;
+  renderLoop->renderStatus = sources->renderStatus;
+  renderLoop->ioBlocksize = job->ioBlocksize;
+
+  if (job->maxTimeInMs > 0) {
+    renderLoop->maxTimeInFrames =
+        (unsigned long)(job->maxTimeInMs * getSampleRate()) / 1000l;
+  }
+
+  // A pooled chain keeps the setting of its previous job otherwise
+  pluginChainSetSilenceBypass(pluginChain, job->silenceBypass,
+                              job->silenceBypassThresholdInDb);
+  renderLoopPrepare(renderLoop);
+  // The buffered sources, if any, now own the sources which were opened
+  sources->inputSource = renderLoop->inputSource;
+  sources->outputSource = renderLoop->outputSource;
+  renderLoopProcess(renderLoop);
+  freeRenderLoop(renderLoop);
+}
+
+boolByte renderDaemonRenderJob(RenderDaemon self, RenderDaemonJob job) {
+  TaskTimer setupTimer = newTaskTimerWithCString("RenderDaemon", "Setup");
+  TaskTimer renderTimer = newTaskTimerWithCString("RenderDaemon", "Render");
+  _RenderDaemonJobSourcesMembers sources;
+  PluginChain pluginChain;
+
+  sources.inputSource = NULL;
+  sources.outputSource = NULL;
+  sources.midiSource = NULL;
+  sources.midiSequence = NULL;
+  sources.automation = NULL;
+  sources.renderStatus = NULL;
+
+  taskTimerStart(setupTimer);
+  _renderDaemonRestoreSettings(self);
+
+  if (charStringIsEmpty(job->pluginChain)) {
+    job->result = RETURN_CODE_MISSING_REQUIRED_OPTION;
+    charStringCopyCString(job->errorMessage, "No plugin chain was given");
+    freeTaskTimer(setupTimer);
+    freeTaskTimer(renderTimer);
+    return false;
+  }
+
+  pluginChain =
+      renderDaemonGetChain(self, job->pluginChain, &job->usedWarmChain);
+
+  if (pluginChain == NULL) {
+    job->result = RETURN_CODE_INVALID_PLUGIN_CHAIN;
+    snprintf(job->errorMessage->data, job->errorMessage->capacity,
+             "Plugin chain '%s' could not be opened", job->pluginChain->data);
+    freeTaskTimer(setupTimer);
+    freeTaskTimer(renderTimer);
+    return false;
+  }
+
+  if (!_setRenderDaemonJobParameters(job, pluginChain)) {
+    job->result = RETURN_CODE_INVALID_ARGUMENT;
+    freeTaskTimer(setupTimer);
+    freeTaskTimer(renderTimer);
+    return false;
+  }
+
+  if (!_openRenderDaemonJobSources(self, job, pluginChain, &sources)) {
+    job->result = RETURN_CODE_IO_ERROR;
+    _freeRenderDaemonJobSources(&sources);
+    _renderDaemonRestoreSettings(self);
+    freeTaskTimer(setupTimer);
+    freeTaskTimer(renderTimer);
+    return false;
+  }
+
+  job->setupTimeInMs = taskTimerStop(setupTimer);
+  taskTimerStart(renderTimer);
+  _renderDaemonProcess(job, pluginChain, &sources);
+  job->renderTimeInMs = taskTimerStop(renderTimer);
+  job->framesWritten =
+      sources.outputSource->numSamplesProcessed / getNumChannels();
+  job->result = RETURN_CODE_SUCCESS;
+  logInfo("Rendered %lu frames to '%s' in %.1fms (%s chain)",
+          job->framesWritten, job->outputSource->data,
+          job->setupTimeInMs + job->renderTimeInMs,
+          job->usedWarmChain ? "warm" : "cold");
+
+  _freeRenderDaemonJobSources(&sources);
+  freeTaskTimer(setupTimer);
+  freeTaskTimer(renderTimer);
+  return true;
+}
+
+#if UNIX
+static boolByte _renderDaemonSendResponse(int clientSocket,
+                                          const CharString response) {
+  size_t length = strlen(response->data);
+  size_t totalBytesWritten = 0;
+  ssize_t bytesWritten;
+
+  while (totalBytesWritten < length) {
+    bytesWritten = write(clientSocket, response->data + totalBytesWritten,
+                         length - totalBytesWritten);
+
+    if (bytesWritten < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      logWarn("Could not send response to render daemon client: %s",
+              strerror(errno));
+      return false;
+    }
+
+    totalBytesWritten += (size_t)bytesWritten;
+  }
+
+  return true;
+}
+
+static boolByte _renderDaemonHandleRequest(RenderDaemon self,
+                                           int clientSocket,
+                                           const CharString request) {
+  RenderDaemonJob job = newRenderDaemonJobWithString(request);
+  CharString response;
+  boolByte result;
+
+  switch (job->command) {
+  case RENDER_DAEMON_COMMAND_RENDER:
+    renderDaemonRenderJob(self, job);
+
+    if (job->result != RETURN_CODE_SUCCESS) {
+      logError("Render failed: %s", job->errorMessage->data);
+    }
+
+    break;
+
+  case RENDER_DAEMON_COMMAND_SHUTDOWN:
+    logInfo("Render daemon received shutdown request");
+    job->result = RETURN_CODE_SUCCESS;
+    self->_shouldShutdown = true;
+    break;
+
+  default:
+    job->result = RETURN_CODE_INVALID_ARGUMENT;
+    logError("Invalid request: %s", job->errorMessage->data);
+    break;
+  }
+
+  response = renderDaemonJobGetResponse(job);
+  result = _renderDaemonSendResponse(clientSocket, response);
+  freeCharString(response);
+  freeRenderDaemonJob(job);
+  return result;
+}
+
+static void _renderDaemonServeClient(RenderDaemon self, int clientSocket) {
+  FILE *client = fdopen(dup(clientSocket), "r");
+  CharString request = newCharString();
+  CharString line = newCharStringWithCapacity(kCharStringLengthLong);
+  boolByte isEndOfLine;
+
+  if (client == NULL) {
+    logError("Could not read from render daemon client");
+    freeCharString(request);
+    freeCharString(line);
+    return;
+  }
+
+  while (!self->_shouldShutdown) {
+    if (fgets(line->data, (int)line->capacity, client) == NULL) {
+      // Handle a final request which was not followed by an empty line
+      if (!charStringIsEmpty(request)) {
+        _renderDaemonHandleRequest(self, clientSocket, request);
+      }
+
+      break;
+    }
+
+    isEndOfLine = (boolByte)(strchr(line->data, '\n') != NULL);
+    line->data[strcspn(line->data, "\r\n")] = '\0';
+
+    if (isEndOfLine && charStringIsEmpty(line)) {
+      // An empty line ends the request
+      if (!charStringIsEmpty(request) &&
+          !_renderDaemonHandleRequest(self, clientSocket, request)) {
+        break;
+      }
+
+      charStringClear(request);
+    } else {
+      charStringAppend(request, line);
+
+      if (isEndOfLine) {
+        charStringAppendCString(request, "\n");
+      }
+    }
+  }
+
+  fclose(client);
+  freeCharString(request);
+  freeCharString(line);
+}
+#endif
+
+ReturnCode renderDaemonRun(RenderDaemon self) {
+#if UNIX
+  struct sockaddr_un address;
+  int serverSocket;
+  int clientSocket;
+
+  if (strlen(self->socketPath->data) >= sizeof(address.sun_path)) {
+    logError("Socket path '%s' is too long", self->socketPath->data);
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  serverSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (serverSocket < 0) {
+    logError("Could not create socket: %s", strerror(errno));
+    return RETURN_CODE_IO_ERROR;
+  }
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, self->socketPath->data,
+          sizeof(address.sun_path) - 1);
+  // Remove the socket left behind by a daemon which did not exit cleanly
+  unlink(self->socketPath->data);
+
+  if (bind(serverSocket, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+      listen(serverSocket, SOMAXCONN) != 0) {
+    logError("Could not listen on socket '%s': %s", self->socketPath->data,
+             strerror(errno));
+    close(serverSocket);
+    return RETURN_CODE_IO_ERROR;
+  }
+
+  // Clients which disconnect early should not take down the daemon
+  signal(SIGPIPE, SIG_IGN);
+  logInfo("Render daemon listening on '%s'", self->socketPath->data);
+
+  while (!self->_shouldShutdown) {
+    clientSocket = accept(serverSocket, NULL, NULL);
+
+    if (clientSocket < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      logError("Could not accept connection: %s", strerror(errno));
+      break;
+    }
+
+    _renderDaemonServeClient(self, clientSocket);
+    close(clientSocket);
+  }
+
+  close(serverSocket);
+  unlink(self->socketPath->data);
+  logInfo("Render daemon processed %lu jobs", self->numJobs);
+  return self->_shouldShutdown ? RETURN_CODE_SUCCESS : RETURN_CODE_IO_ERROR;
+#else
+  logUnsupportedFeature("Render daemon on this platform");
+  return RETURN_CODE_UNSUPPORTED_FEATURE;
+#endif
+}
+
+void freeRenderDaemon(RenderDaemon self) {
+  unsigned int i;
+
+  if (self != NULL) {
+    for (i = 0; i < self->numChains; i++) {
+      _freeRenderDaemonChain(self->chains[i]);
+    }
+
+    free(self->chains);
+    freeCharString(self->socketPath);
+    freeCharString(self->pluginRoot);
+    free(self);
+  }
+}
@@ -0,0 +1,196 @@
+//
+// RenderDaemon.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_RenderDaemon_h
+#define MrsWatson_RenderDaemon_h
+
+#include "app/ReturnCodes.h"
+#include "audio/AudioSettings.h"
+#include "base/CharString.h"
+#include "base/LinkedList.h"
+#include "plugin/PluginChain.h"
+
+#define RENDER_DAEMON_DEFAULT_MAX_CHAINS 4
+
+/**
+ * The render daemon keeps plugin chains open between renders, so that clients
+ * which render many short files do not have to pay for loading plugins and
+ * presets each time. Clients connect to a Unix domain socket and send render
+ * requests as lines of tab-separated key/value pairs, terminated by an empty
+ * line:
+ *
+ *   plugin         Plugin chain, in the same format as --plugin (required)
+ *   input          Input source (optional for instruments)
+ *   output         Output source (required)
+ *   midi           MIDI source
+ *   parameter      Parameter for the head plugin, as "index,value" (repeatable)
+ *   max-time       Maximum time to process, in milliseconds
+ *   automation     Parameter automation file, as with --automation
+ *   io-blocksize   Frames to read and write at once, as with --io-blocksize
+ *   silence-bypass Bypass effects on silent input, with an optional threshold
+ *                  in dB, as with --silence-bypass
+ *   status-file    File to publish the render progress to, as --status-file
+ *   command        Either "render" (default) or "shutdown"
+ *
+ * The daemon answers each request with the same format, with the keys
+ * "status" (either "ok" or "error"), "error", "warm", "frames", "setup-ms"
+ * and "render-ms". Several requests may be sent over one connection.
+ *
+ * Chains are kept in a pool which is keyed by the plugin chain string, so
+ * that the same plugins with a different preset make up a different chain.
+ * Before a chain is reused, it is reset with pluginChainReset(), which also
+ * releases any notes which were still held by the previous job. Audio settings
+ * such as the sample rate and blocksize are fixed when the daemon starts. Jobs
+ * are rendered with the same loop as the command line (see RenderLoop.h).
+ */
+
+typedef enum {
+  RENDER_DAEMON_COMMAND_INVALID,
+  RENDER_DAEMON_COMMAND_RENDER,
+  RENDER_DAEMON_COMMAND_SHUTDOWN,
+  NUM_RENDER_DAEMON_COMMANDS
+} RenderDaemonCommand;
+
+typedef struct {
+  RenderDaemonCommand command;
+  CharString pluginChain;
+  CharString inputSource;
+  CharString outputSource;
+  CharString midiSource;
+  // List of CharString, each with an "index,value" pair
+  LinkedList parameters;
+  unsigned long maxTimeInMs;
+  CharString automationFile;
+  SampleCount ioBlocksize;
+  boolByte silenceBypass;
+  double silenceBypassThresholdInDb;
+  CharString statusFile;
+
+  // Results, which are filled in by renderDaemonRenderJob()
+  ReturnCode result;
+  CharString errorMessage;
+  boolByte usedWarmChain;
+  unsigned long framesWritten;
+  double setupTimeInMs;
+  double renderTimeInMs;
+} RenderDaemonJobMembers;
+typedef RenderDaemonJobMembers *RenderDaemonJob;
+
+typedef struct {
+  CharString pluginChainString;
+  PluginChain pluginChain;
+  unsigned long lastUsed;
+} RenderDaemonChainMembers;
+typedef RenderDaemonChainMembers *RenderDaemonChain;
+
+typedef struct {
+  CharString socketPath;
+  CharString pluginRoot;
+  unsigned int maxChains;
+  unsigned int numChains;
+  RenderDaemonChain *chains;
+  unsigned long numJobs;
+
+  // Private fields
+  boolByte _shouldShutdown;
+  SampleRate _sampleRate;
+  ChannelCount _numChannels;
+  Tempo _tempo;
+  unsigned short _beatsPerMeasure;
+  unsigned short _noteValue;
+} RenderDaemonMembers;
+typedef RenderDaemonMembers *RenderDaemon;
+
+/**
+ * Create a new render job from the text of a request.
+ * @param text Request lines, as described above
+ * @return Initialized job. If the request could not be parsed, the job's
+ * command is RENDER_DAEMON_COMMAND_INVALID and the error message is set.
+ */
+RenderDaemonJob newRenderDaemonJobWithString(const CharString text);
+
+/**
+ * Get the response for a job which has been processed.
+ * @param self
+ * @return Response text, which the caller must free
+ */
+CharString renderDaemonJobGetResponse(const RenderDaemonJob self);
+
+/**
+ * Free a render job and its associated resources.
+ * @param self
+ */
+void freeRenderDaemonJob(RenderDaemonJob self);
+
+/**
+ * Create a new render daemon. The current global audio settings are used for
+ * all renders.
+ * @param socketPath Path of the socket to listen on
+ * @param pluginRoot User-provided plugin search root. May be NULL or empty.
+ * @param maxChains Maximum number of chains to keep open. If 0, then
+ * RENDER_DAEMON_DEFAULT_MAX_CHAINS is used.
+ * @return Initialized render daemon
+ */
+RenderDaemon newRenderDaemon(const CharString socketPath,
+                             const CharString pluginRoot,
+                             const unsigned int maxChains);
+
+/**
+ * Get an initialized plugin chain from the pool, or open a new one. If the
+ * pool is full, then the least recently used chain is closed.
+ * @param self
+ * @param pluginChainString Plugin chain, in the same format as --plugin
+ * @param outIsWarm Set to true if the chain was already open
+ * @return Chain which is ready to process audio, or NULL if the chain could not
+ * be opened. The chain is owned by the daemon.
+ */
+PluginChain renderDaemonGetChain(RenderDaemon self,
+                                 const CharString pluginChainString,
+                                 boolByte *outIsWarm);
+
+/**
+ * Process a single render job. The results are stored in the job.
+ * @param self
+ * @param job Job to render
+ * @return True if the job was rendered successfully
+ */
+boolByte renderDaemonRenderJob(RenderDaemon self, RenderDaemonJob job);
+
+/**
+ * Listen on the daemon's socket and process requests until a client sends the
+ * shutdown command. Only supported on Unix platforms.
+ * @param self
+ * @return RETURN_CODE_SUCCESS when the daemon was shut down normally
+ */
+ReturnCode renderDaemonRun(RenderDaemon self);
+
+/**
+ * Close all pooled plugin chains and free the render daemon.
+ * @param self
+ */
+void freeRenderDaemon(RenderDaemon self);
+
+#endif
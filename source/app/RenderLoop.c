@@ -0,0 +1,287 @@
+//
+// RenderLoop.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RenderLoop.h"
+
+#include "MrsWatson.h"
+#include "audio/AudioSettings.h"
+#include "base/LinkedList.h"
+#include "io/SampleSourceBuffered.h"
+#include "logging/EventLogger.h"
+#include "logging/FlightRecorder.h"
+#include "time/AudioClock.h"
+
+#include <stdlib.h>
+
+RenderLoop newRenderLoop(PluginChain pluginChain, SampleSource inputSource,
+                         SampleSource outputSource,
+                         const char *timerComponent) {
+  RenderLoop renderLoop = (RenderLoop)malloc(sizeof(RenderLoopMembers));
+
+  renderLoop->pluginChain = pluginChain;
+  renderLoop->inputSource = inputSource;
+  renderLoop->outputSource = outputSource;
+
+  renderLoop->midiSequence = NULL;
+  renderLoop->automation = NULL;
+  renderLoop->renderStatus = NULL;
+  renderLoop->memoryMonitor = NULL;
+
+  renderLoop->ioBlocksize = 0;
+  renderLoop->tailTimeInMs =
+      (long)pluginChainGetMaximumTailTimeInMs(pluginChain);
+  renderLoop->tailThresholdInDb = PLUGIN_CHAIN_TAIL_DEFAULT_THRESHOLD_IN_DB;
+  renderLoop->tailWindowInMs = PLUGIN_CHAIN_TAIL_DEFAULT_WINDOW_IN_MS;
+
+  renderLoop->startFrame = 0;
+  renderLoop->seekFrame = 0;
+  renderLoop->endFrame = 0;
+  renderLoop->maxTimeInFrames = 0;
+
+  renderLoop->processingDelayInFrames = 0;
+  renderLoop->tail = NULL;
+
+  renderLoop->inputTimer =
+      newTaskTimerWithCString(timerComponent, "Input Source");
+  renderLoop->outputTimer =
+      newTaskTimerWithCString(timerComponent, "Output Source");
+
+  renderLoop->_inputBuffer = NULL;
+  renderLoop->_outputBuffer = NULL;
+  renderLoop->_silentOutput = NULL;
+
+  return renderLoop;
+}
+
+void renderLoopPrepare(RenderLoop self) {
+  // The loop still runs once per plugin block, so the MIDI events and audio
+  // clock are handled per plugin block. Only the sources see the larger
+  // blocks.
+  if (self->ioBlocksize > getBlocksize()) {
+    if (self->inputSource->sampleSourceType != SAMPLE_SOURCE_TYPE_SILENCE) {
+      self->inputSource =
+          newSampleSourceBuffered(self->inputSource, self->ioBlocksize);
+    }
+
+    self->outputSource =
+        newSampleSourceBuffered(self->outputSource, self->ioBlocksize);
+  } else if (self->ioBlocksize > 0) {
+    logWarn("I/O blocksize is not larger than the processing blocksize, "
+            "ignoring it");
+    self->ioBlocksize = 0;
+  }
+
+  self->processingDelayInFrames =
+      pluginChainGetProcessingDelay(self->pluginChain);
+  freePluginChainTail(self->tail);
+  self->tail =
+      newPluginChainTail(self->processingDelayInFrames, self->tailTimeInMs,
+                         self->tailThresholdInDb, self->tailWindowInMs);
+
+  if (self->_inputBuffer == NULL) {
+    self->_inputBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+    self->_outputBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+    self->_silentOutput = sampleSourceFactory(NULL);
+  }
+
+  pluginChainPrepareForProcessing(self->pluginChain);
+}
+
+// Find the frame where processing is expected to stop, which is only used to
+// report progress. Returns 0 if the length of the input is not known.
+static unsigned long _renderLoopGetExpectedEndFrame(RenderLoop self) {
+  unsigned long expectedEndFrame = 0;
+  unsigned long numEvents;
+
+  if (self->midiSequence != NULL) {
+    numEvents = midiSequenceGetNumEvents(self->midiSequence);
+
+    if (numEvents > 0) {
+      expectedEndFrame = (unsigned long)midiSequenceGetEvent(
+          self->midiSequence, numEvents - 1)->timestamp;
+    }
+  } else {
+    expectedEndFrame = sampleSourceGetLength(self->inputSource);
+  }
+
+  if (self->maxTimeInFrames > 0 &&
+      (expectedEndFrame == 0 ||
+       self->startFrame + self->maxTimeInFrames < expectedEndFrame)) {
+    expectedEndFrame = self->startFrame + self->maxTimeInFrames;
+  }
+
+  if (self->endFrame > 0 &&
+      (expectedEndFrame == 0 || self->endFrame < expectedEndFrame)) {
+    expectedEndFrame = self->endFrame;
+  }
+
+  return expectedEndFrame;
+}
+
+void renderLoopProcess(RenderLoop self) {
+  AudioClock audioClock = getAudioClock();
+  PluginChain pluginChain = self->pluginChain;
+  SampleBuffer inputSampleBuffer = self->_inputBuffer;
+  SampleBuffer outputSampleBuffer = self->_outputBuffer;
+  LinkedList midiEventsForBlock;
+  unsigned long skipHeadFrames =
+      self->processingDelayInFrames + self->startFrame - self->seekFrame;
+  boolByte finishedReading = false;
+  boolByte isRenderingTail = false;
+  boolByte reachedTimeLimit = false;
+
+  flightRecorderSetPluginChain(getFlightRecorder(), pluginChain);
+
+  if (self->renderStatus != NULL) {
+    renderStatusStart(self->renderStatus, pluginChain, self->seekFrame,
+                      _renderLoopGetExpectedEndFrame(self));
+  }
+
+  if (self->memoryMonitor != NULL) {
+    memoryMonitorStart(self->memoryMonitor);
+  }
+
+  while (!finishedReading) {
+    midiEventsForBlock = newLinkedList();
+    flightRecorderBeginBlock(getFlightRecorder(), audioClock->currentFrame);
+    taskTimerStart(self->inputTimer);
+
+    if (isRenderingTail) {
+      // The input has ended, so feed silence to the chain until the tail has
+      // been rendered
+      sampleBufferClear(inputSampleBuffer);
+    } else {
+      finishedReading =
+          (boolByte)!readInput(self->inputSource, inputSampleBuffer);
+    }
+
+    // TODO: For streaming MIDI, we would need to read in events from source
+    // here
+    if (self->midiSequence != NULL && !isRenderingTail) {
+      // MIDI source overrides the value set to finishedReading by the input
+      // source
+      finishedReading = (boolByte)!fillMidiEventsFromRange(
+          self->midiSequence, audioClock->currentFrame, getBlocksize(),
+          midiEventsForBlock);
+      linkedListForeach(midiEventsForBlock, processMidiMetaEvent,
+                        &finishedReading);
+    }
+
+    taskTimerStop(self->inputTimer);
+
+    // Pre-roll does not count towards the time limit
+    if (self->maxTimeInFrames > 0 &&
+        audioClock->currentFrame >= self->startFrame + self->maxTimeInFrames) {
+      logInfo("Maximum time reached, stopping processing after this block");
+      finishedReading = true;
+      reachedTimeLimit = true;
+    }
+
+    // Automation splits the block wherever a parameter changes, so in that
+    // case the MIDI events are also handed to the chain with each sub-block
+    if (self->automation != NULL) {
+      pluginAutomationProcessAudio(self->automation, pluginChain,
+                                   audioClock->currentFrame, midiEventsForBlock,
+                                   inputSampleBuffer, outputSampleBuffer);
+    } else {
+      pluginChainProcessMidi(pluginChain, midiEventsForBlock);
+      pluginChainProcessAudio(pluginChain, inputSampleBuffer,
+                              outputSampleBuffer);
+    }
+
+    freeLinkedList(midiEventsForBlock);
+    taskTimerStart(self->outputTimer);
+
+    if (finishedReading) {
+      // The input buffer size has been adjusted
+      outputSampleBuffer->blocksize = inputSampleBuffer->blocksize;
+      logDebug("Using buffer size of %d for final block",
+               outputSampleBuffer->blocksize);
+    }
+
+    // The output is delayed by the chain, so keep processing until the audio
+    // at the end position has made it through all plugins
+    if (self->endFrame > 0 &&
+        audioClock->currentFrame + outputSampleBuffer->blocksize >=
+            self->endFrame + self->processingDelayInFrames) {
+      logInfo("End time reached, stopping processing after this block");
+      outputSampleBuffer->blocksize = self->endFrame +
+                                      self->processingDelayInFrames -
+                                      audioClock->currentFrame;
+      finishedReading = true;
+      reachedTimeLimit = true;
+    }
+
+    writeOutput(self->outputSource, self->_silentOutput, outputSampleBuffer,
+                skipHeadFrames, self->seekFrame);
+    taskTimerStop(self->outputTimer);
+    advanceAudioClock(audioClock, outputSampleBuffer->blocksize);
+
+    if (self->renderStatus != NULL) {
+      renderStatusUpdate(self->renderStatus, pluginChain,
+                         audioClock->currentFrame);
+    }
+
+    if (self->memoryMonitor != NULL) {
+      memoryMonitorUpdate(self->memoryMonitor);
+    }
+
+    if (isRenderingTail) {
+      pluginChainTailProcess(self->tail, outputSampleBuffer);
+      finishedReading =
+          (boolByte)(reachedTimeLimit || pluginChainTailIsFinished(self->tail));
+    } else if (finishedReading && !reachedTimeLimit &&
+               pluginChainTailIsNeeded(self->tail)) {
+      logInfo("Finished reading input, rendering tail of plugin chain");
+      isRenderingTail = true;
+      finishedReading = false;
+    }
+  }
+
+  audioClockStop(audioClock);
+
+  if (self->renderStatus != NULL) {
+    renderStatusFinish(self->renderStatus, pluginChain,
+                       audioClock->currentFrame);
+  }
+}
+
+void freeRenderLoop(RenderLoop self) {
+  if (self != NULL) {
+    freePluginChainTail(self->tail);
+    freeTaskTimer(self->inputTimer);
+    freeTaskTimer(self->outputTimer);
+    freeSampleBuffer(self->_inputBuffer);
+    freeSampleBuffer(self->_outputBuffer);
+
+    if (self->_silentOutput != NULL) {
+      self->_silentOutput->closeSampleSource(self->_silentOutput);
+      freeSampleSource(self->_silentOutput);
+    }
+
+    free(self);
+  }
+}
@@ -0,0 +1,128 @@
+//
+// RenderLoop.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_RenderLoop_h
+#define MrsWatson_RenderLoop_h
+
+#include "app/MemoryMonitor.h"
+#include "app/RenderStatus.h"
+#include "io/SampleSource.h"
+#include "midi/MidiSequence.h"
+#include "plugin/PluginAutomation.h"
+#include "plugin/PluginChain.h"
+#include "plugin/PluginChainTail.h"
+#include "time/TaskTimer.h"
+
+/**
+ * Renders an input source through a plugin chain to an output source, one
+ * block at a time. This is the processing loop which is shared by the command
+ * line and the render daemon, so that both handle MIDI, automation, regions,
+ * I/O buffering and plugin tails in the same way.
+ *
+ * The caller creates the loop, sets any of the optional fields, and then calls
+ * renderLoopPrepare() followed by renderLoopProcess(). The sources, MIDI
+ * sequence, automation, render status and memory monitor are owned by the
+ * caller.
+ */
+typedef struct {
+  PluginChain pluginChain;
+  // When an I/O blocksize is set, these are replaced by buffered sources in
+  // renderLoopPrepare(), which also free the original ones
+  SampleSource inputSource;
+  SampleSource outputSource;
+
+  // Optional objects, which may be NULL
+  MidiSequence midiSequence;
+  PluginAutomation automation;
+  RenderStatus renderStatus;
+  MemoryMonitor memoryMonitor;
+
+  // Frames to read and write at once, or 0 to use the processing blocksize
+  SampleCount ioBlocksize;
+  // Defaults to the maximum tail time of the plugin chain
+  long tailTimeInMs;
+  double tailThresholdInDb;
+  unsigned long tailWindowInMs;
+
+  // Region to render, where 0 means the start or end of the input. The input
+  // is processed from seekFrame, which may be before startFrame to give the
+  // plugins some pre-roll, but output is only written from startFrame.
+  unsigned long startFrame;
+  unsigned long seekFrame;
+  unsigned long endFrame;
+  // Maximum number of frames to render after startFrame, or 0 for no limit
+  unsigned long maxTimeInFrames;
+
+  // Set by renderLoopPrepare()
+  unsigned long processingDelayInFrames;
+  PluginChainTail tail;
+
+  TaskTimer inputTimer;
+  TaskTimer outputTimer;
+
+  // Private fields
+  SampleBuffer _inputBuffer;
+  SampleBuffer _outputBuffer;
+  SampleSource _silentOutput;
+} RenderLoopMembers;
+typedef RenderLoopMembers *RenderLoop;
+
+/**
+ * Create a new render loop. The sources should already be opened.
+ * @param pluginChain Initialized plugin chain
+ * @param inputSource Input source
+ * @param outputSource Output source
+ * @param timerComponent Component name used for the input and output timers
+ * @return Render loop with the default tail settings and no region or limit
+ */
+RenderLoop newRenderLoop(PluginChain pluginChain, SampleSource inputSource,
+                         SampleSource outputSource,
+                         const char *timerComponent);
+
+/**
+ * Wrap the sources for the I/O blocksize, if one is set, and prepare the
+ * plugin chain for processing. This must be called after the optional fields
+ * have been set, and before renderLoopProcess().
+ * @param self
+ */
+void renderLoopPrepare(RenderLoop self);
+
+/**
+ * Process blocks until the input has ended and the tail of the chain has been
+ * rendered, or the end of the region or the maximum time was reached. The
+ * audio clock is stopped afterwards, but the sources are left open.
+ * @param self
+ */
+void renderLoopProcess(RenderLoop self);
+
+/**
+ * Free a render loop and the objects it has created. The sources and other
+ * objects which are set by the caller are not freed.
+ * @param self
+ */
+void freeRenderLoop(RenderLoop self);
+
+#endif
@@ -0,0 +1,548 @@
+//
+// RenderStatus.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RenderStatus.h"
+
+#include "audio/AudioSettings.h"
+#include "logging/EventLogger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define memoryBarrier() __sync_synchronize()
+#elif WINDOWS
+#include <process.h>
+#include <windows.h>
+#define memoryBarrier() MemoryBarrier()
+#define getpid _getpid
+#endif
+
+static const char *kRenderStatusStateNames[NUM_RENDER_STATUS_STATES] = {
+    "starting", "running", "finished"};
+
+RenderStatus newRenderStatus(void) {
+  RenderStatus self = (RenderStatus)malloc(sizeof(RenderStatusMembers));
+  unsigned int i;
+
+  self->statusFile = newCharString();
+  self->sharedMemoryName = newCharString();
+  self->intervalInMs = RENDER_STATUS_DEFAULT_INTERVAL_IN_MS;
+
+  self->state = RENDER_STATUS_STATE_STARTING;
+  self->startFrame = 0;
+  self->totalFrames = 0;
+  self->position = 0;
+  self->framesProcessed = 0;
+  self->updateCount = 0;
+
+  self->elapsedSeconds = 0.0;
+  self->currentRealtimeFactor = 0.0;
+  self->averageRealtimeFactor = 0.0;
+  self->etaSeconds = -1.0;
+
+  self->numPlugins = 0;
+
+  for (i = 0; i < MAX_PLUGINS; i++) {
+    self->pluginNames[i] = NULL;
+    self->blockCostInMs[i] = 0.0;
+    self->deadlineMisses[i] = 0;
+    self->_lastPluginTime[i] = 0.0;
+  }
+
+  self->_timer = newTaskTimerWithCString("RenderStatus", "Wall Clock");
+  self->_lastUpdateTime = 0.0;
+  self->_lastUpdatePosition = 0;
+  self->_blocksSinceUpdate = 0;
+  self->_hasWriteFailed = false;
+  self->_segment = NULL;
+  self->_segmentHandle = NULL;
+
+  return self;
+}
+
+void renderStatusSetFile(RenderStatus self, const CharString filename) {
+  charStringCopy(self->statusFile, filename);
+}
+
+boolByte renderStatusOpenSharedMemory(RenderStatus self,
+                                      const CharString name) {
+  const size_t segmentSize = sizeof(RenderStatusSegment);
+  void *segment = NULL;
+
+  if (self->_segment != NULL) {
+    logError("Render status shared memory is already open");
+    return false;
+  }
+
+  if (name == NULL || charStringIsEmpty(name)) {
+    logError("No name given for render status shared memory");
+    return false;
+  }
+
+#if UNIX
+  {
+    int fileDescriptor;
+
+    // POSIX shared memory objects must be named with a single leading slash
+    charStringClear(self->sharedMemoryName);
+
+    if (name->data[0] != '/') {
+      charStringAppendCString(self->sharedMemoryName, "/");
+    }
+
+    charStringAppendCString(self->sharedMemoryName, name->data);
+    fileDescriptor = shm_open(self->sharedMemoryName->data,
+                              O_CREAT | O_RDWR | O_TRUNC, 0644);
+
+    if (fileDescriptor < 0) {
+      logError("Could not create shared memory segment '%s'",
+               self->sharedMemoryName->data);
+      return false;
+    }
+
+    if (ftruncate(fileDescriptor, (off_t)segmentSize) == 0) {
+      segment = mmap(NULL, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fileDescriptor, 0);
+    }
+
+    close(fileDescriptor);
+
+    if (segment == NULL || segment == MAP_FAILED) {
+      logError("Could not map shared memory segment '%s'",
+               self->sharedMemoryName->data);
+      shm_unlink(self->sharedMemoryName->data);
+      return false;
+    }
+  }
+#elif WINDOWS
+  {
+    HANDLE mapping;
+
+    charStringCopy(self->sharedMemoryName, name);
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0,
+                                 (DWORD)segmentSize, name->data);
+
+    if (mapping == NULL) {
+      logError("Could not create shared memory segment '%s'", name->data);
+      return false;
+    }
+
+    segment = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, segmentSize);
+
+    if (segment == NULL) {
+      logError("Could not map shared memory segment '%s'", name->data);
+      CloseHandle(mapping);
+      return false;
+    }
+
+    self->_segmentHandle = mapping;
+  }
+#else
+  logUnsupportedFeature("Render status shared memory");
+  return false;
+#endif
+
+  self->_segment = (RenderStatusSegment *)segment;
+  memset(self->_segment, 0, segmentSize);
+  self->_segment->magic = RENDER_STATUS_SEGMENT_MAGIC;
+  self->_segment->version = RENDER_STATUS_SEGMENT_VERSION;
+  self->_segment->state = RENDER_STATUS_STATE_STARTING;
+  self->_segment->processId = (uint32_t)getpid();
+  self->_segment->etaSeconds = -1.0;
+  logDebug("Publishing render status to shared memory segment '%s'",
+           self->sharedMemoryName->data);
+  return true;
+}
+
+static void _writeJsonString(FILE *file, const char *string) {
+  const char *c;
+
+  fputc('"', file);
+
+  for (c = string; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      fprintf(file, "\\%c", *c);
+    } else if ((unsigned char)*c < 0x20) {
+      fprintf(file, "\\u%04x", (unsigned int)(unsigned char)*c);
+    } else {
+      fputc(*c, file);
+    }
+  }
+
+  fputc('"', file);
+}
+
+static void _writeJson(const RenderStatus self, FILE *file) {
+  unsigned int i;
+
+  fprintf(file, "{\n");
+  fprintf(file, "  \"state\": \"%s\",\n", kRenderStatusStateNames[self->state]);
+  fprintf(file, "  \"frames_processed\": %lu,\n", self->framesProcessed);
+  fprintf(file, "  \"position\": %lu,\n", self->position);
+  fprintf(file, "  \"total_frames\": %lu,\n", self->totalFrames);
+  fprintf(file, "  \"sample_rate\": %.0f,\n", getSampleRate());
+  fprintf(file, "  \"elapsed_seconds\": %.3f,\n", self->elapsedSeconds);
+  fprintf(file, "  \"realtime_factor\": %.3f,\n",
+          self->currentRealtimeFactor);
+  fprintf(file, "  \"average_realtime_factor\": %.3f,\n",
+          self->averageRealtimeFactor);
+  fprintf(file, "  \"eta_seconds\": %.1f,\n", self->etaSeconds);
+  fprintf(file, "  \"updates\": %lu,\n", self->updateCount);
+  fprintf(file, "  \"plugins\": [");
+
+  for (i = 0; i < self->numPlugins; i++) {
+    fprintf(file, "%s\n    {\"index\": %u, \"name\": ", i > 0 ? "," : "", i);
+    _writeJsonString(file, self->pluginNames[i]->data);
+    fprintf(file, ", \"block_cost_ms\": %.4f, \"deadline_misses\": %lu}",
+            self->blockCostInMs[i], self->deadlineMisses[i]);
+  }
+
+  fprintf(file, "%s]\n}\n", self->numPlugins > 0 ? "\n  " : "");
+}
+
+static void _writePrometheusLabel(FILE *file, const char *string) {
+  const char *c;
+
+  for (c = string; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      fprintf(file, "\\%c", *c);
+    } else if (*c == '\n') {
+      fprintf(file, "\\n");
+    } else {
+      fputc(*c, file);
+    }
+  }
+}
+
+static void _writePrometheusMetric(FILE *file, const char *name,
+                                   const char *type, const char *help) {
+  fprintf(file, "# HELP mrswatson_%s %s\n", name, help);
+  fprintf(file, "# TYPE mrswatson_%s %s\n", name, type);
+}
+
+static void _writePrometheus(const RenderStatus self, FILE *file) {
+  unsigned int i;
+
+  _writePrometheusMetric(file, "state", "gauge",
+                         "Render state, 1 for the current state");
+
+  for (i = 0; i < NUM_RENDER_STATUS_STATES; i++) {
+    fprintf(file, "mrswatson_state{state=\"%s\"} %d\n",
+            kRenderStatusStateNames[i],
+            (unsigned int)self->state == i ? 1 : 0);
+  }
+
+  _writePrometheusMetric(file, "frames_processed_total", "counter",
+                         "Frames rendered so far");
+  fprintf(file, "mrswatson_frames_processed_total %lu\n",
+          self->framesProcessed);
+  _writePrometheusMetric(file, "position_frames", "gauge",
+                         "Current frame in the input");
+  fprintf(file, "mrswatson_position_frames %lu\n", self->position);
+  _writePrometheusMetric(file, "total_frames", "gauge",
+                         "Frame where the render ends, or 0 if not known");
+  fprintf(file, "mrswatson_total_frames %lu\n", self->totalFrames);
+  _writePrometheusMetric(file, "elapsed_seconds", "gauge",
+                         "Wall time since the render started");
+  fprintf(file, "mrswatson_elapsed_seconds %.3f\n", self->elapsedSeconds);
+  _writePrometheusMetric(file, "realtime_factor", "gauge",
+                         "Seconds of audio rendered per second since the "
+                         "last update");
+  fprintf(file, "mrswatson_realtime_factor %.3f\n",
+          self->currentRealtimeFactor);
+  _writePrometheusMetric(file, "average_realtime_factor", "gauge",
+                         "Seconds of audio rendered per second overall");
+  fprintf(file, "mrswatson_average_realtime_factor %.3f\n",
+          self->averageRealtimeFactor);
+  _writePrometheusMetric(file, "eta_seconds", "gauge",
+                         "Estimated time left, or -1 if not known");
+  fprintf(file, "mrswatson_eta_seconds %.1f\n", self->etaSeconds);
+
+  _writePrometheusMetric(file, "plugin_block_cost_ms", "gauge",
+                         "Average processing time per block since the last "
+                         "update");
+
+  for (i = 0; i < self->numPlugins; i++) {
+    fprintf(file, "mrswatson_plugin_block_cost_ms{index=\"%u\",plugin=\"", i);
+    _writePrometheusLabel(file, self->pluginNames[i]->data);
+    fprintf(file, "\"} %.4f\n", self->blockCostInMs[i]);
+  }
+
+  _writePrometheusMetric(file, "plugin_deadline_misses_total", "counter",
+                         "Blocks which took longer than realtime");
+
+  for (i = 0; i < self->numPlugins; i++) {
+    fprintf(file,
+            "mrswatson_plugin_deadline_misses_total{index=\"%u\",plugin=\"",
+            i);
+    _writePrometheusLabel(file, self->pluginNames[i]->data);
+    fprintf(file, "\"} %lu\n", self->deadlineMisses[i]);
+  }
+}
+
+static boolByte _isPrometheusFile(const CharString filename) {
+  const size_t extensionLength = strlen(RENDER_STATUS_PROMETHEUS_EXTENSION);
+  const size_t length = strlen(filename->data);
+
+  return (boolByte)(length > extensionLength &&
+                    !strcmp(filename->data + length - extensionLength,
+                            RENDER_STATUS_PROMETHEUS_EXTENSION));
+}
+
+static boolByte _writeStatusFile(const RenderStatus self) {
+  CharString tempFilename = newCharStringWithCString(self->statusFile->data);
+  FILE *file;
+  boolByte result;
+
+  // Readers must never see a partially written file, so write everything to
+  // a temporary file and then move it over the old one
+  charStringAppendCString(tempFilename, ".tmp");
+  file = fopen(tempFilename->data, "w");
+
+  if (file == NULL) {
+    freeCharString(tempFilename);
+    return false;
+  }
+
+  if (_isPrometheusFile(self->statusFile)) {
+    _writePrometheus(self, file);
+  } else {
+    _writeJson(self, file);
+  }
+
+  result = (boolByte)(!ferror(file));
+  result = (boolByte)(fclose(file) == 0 && result);
+
+#if WINDOWS
+  result = (boolByte)(result && MoveFileExA(tempFilename->data,
+                                            self->statusFile->data,
+                                            MOVEFILE_REPLACE_EXISTING));
+#else
+  result = (boolByte)(result &&
+                      rename(tempFilename->data, self->statusFile->data) == 0);
+#endif
+
+  if (!result) {
+    remove(tempFilename->data);
+  }
+
+  freeCharString(tempFilename);
+  return result;
+}
+
+static void _writeSegment(const RenderStatus self) {
+  RenderStatusSegment *segment = self->_segment;
+  unsigned int i;
+
+  // An odd sequence tells readers that an update is in progress
+  segment->sequence++;
+  memoryBarrier();
+
+  segment->state = (uint32_t)self->state;
+  segment->numPlugins = (uint32_t)self->numPlugins;
+  segment->framesProcessed = (uint64_t)self->framesProcessed;
+  segment->position = (uint64_t)self->position;
+  segment->totalFrames = (uint64_t)self->totalFrames;
+  segment->updateCount = (uint64_t)self->updateCount;
+  segment->sampleRate = getSampleRate();
+  segment->elapsedSeconds = self->elapsedSeconds;
+  segment->currentRealtimeFactor = self->currentRealtimeFactor;
+  segment->averageRealtimeFactor = self->averageRealtimeFactor;
+  segment->etaSeconds = self->etaSeconds;
+
+  for (i = 0; i < self->numPlugins; i++) {
+    strncpy(segment->plugins[i].name, self->pluginNames[i]->data,
+            RENDER_STATUS_SEGMENT_NAME_LENGTH - 1);
+    segment->plugins[i].name[RENDER_STATUS_SEGMENT_NAME_LENGTH - 1] = '\0';
+    segment->plugins[i].blockCostInMs = self->blockCostInMs[i];
+    segment->plugins[i].deadlineMisses = (uint64_t)self->deadlineMisses[i];
+  }
+
+  memoryBarrier();
+  segment->sequence++;
+}
+
+static void _publish(RenderStatus self) {
+  if (!charStringIsEmpty(self->statusFile) && !_writeStatusFile(self) &&
+      !self->_hasWriteFailed) {
+    // Only warn once, rather than every interval for the rest of the render
+    logWarn("Could not write render status to '%s'", self->statusFile->data);
+    self->_hasWriteFailed = true;
+  }
+
+  if (self->_segment != NULL) {
+    _writeSegment(self);
+  }
+}
+
+static boolByte _isPublishing(const RenderStatus self) {
+  return (boolByte)(self->_segment != NULL ||
+                    !charStringIsEmpty(self->statusFile));
+}
+
+static double _getElapsedTime(RenderStatus self) {
+  // The timer only adds to its total when stopped, so restart it to read it
+  taskTimerStop(self->_timer);
+  taskTimerStart(self->_timer);
+  return self->_timer->totalTaskTime;
+}
+
+static void _recalculate(RenderStatus self, PluginChain pluginChain,
+                         const unsigned long position, const double elapsed) {
+  const double sampleRate = getSampleRate();
+  const double secondsSinceUpdate = (elapsed - self->_lastUpdateTime) / 1000.0;
+  const unsigned long framesSinceUpdate =
+      position > self->_lastUpdatePosition
+          ? position - self->_lastUpdatePosition
+          : 0;
+  double pluginTime;
+  unsigned int i;
+
+  self->position = position;
+  self->framesProcessed =
+      position > self->startFrame ? position - self->startFrame : 0;
+  self->elapsedSeconds = elapsed / 1000.0;
+  self->currentRealtimeFactor =
+      secondsSinceUpdate > 0.0
+          ? (double)framesSinceUpdate / sampleRate / secondsSinceUpdate
+          : 0.0;
+  self->averageRealtimeFactor =
+      self->elapsedSeconds > 0.0 ? (double)self->framesProcessed / sampleRate /
+                                       self->elapsedSeconds
+                                 : 0.0;
+
+  // The tail of the plugin chain may be rendered past the expected end
+  if (self->totalFrames > 0 && self->averageRealtimeFactor > 0.0) {
+    self->etaSeconds =
+        position < self->totalFrames
+            ? (double)(self->totalFrames - position) / sampleRate /
+                  self->averageRealtimeFactor
+            : 0.0;
+  } else {
+    self->etaSeconds = -1.0;
+  }
+
+  for (i = 0; i < self->numPlugins && i < pluginChain->numPlugins; i++) {
+    pluginTime = pluginChain->audioTimers[i]->totalTaskTime;
+    self->blockCostInMs[i] =
+        self->_blocksSinceUpdate > 0
+            ? (pluginTime - self->_lastPluginTime[i]) /
+                  (double)self->_blocksSinceUpdate
+            : 0.0;
+    self->_lastPluginTime[i] = pluginTime;
+    self->deadlineMisses[i] = pluginChain->numDeadlineMisses[i];
+  }
+
+  self->_lastUpdateTime = elapsed;
+  self->_lastUpdatePosition = position;
+  self->_blocksSinceUpdate = 0;
+  self->updateCount++;
+}
+
+void renderStatusStart(RenderStatus self, PluginChain pluginChain,
+                       const unsigned long startFrame,
+                       const unsigned long totalFrames) {
+  unsigned int i;
+
+  self->state = RENDER_STATUS_STATE_RUNNING;
+  self->startFrame = startFrame;
+  self->totalFrames = totalFrames;
+  self->position = startFrame;
+  self->_lastUpdatePosition = startFrame;
+  self->numPlugins = pluginChain->numPlugins;
+
+  for (i = 0; i < self->numPlugins; i++) {
+    freeCharString(self->pluginNames[i]);
+    self->pluginNames[i] =
+        newCharStringWithCString(pluginChain->plugins[i]->pluginName->data);
+    self->_lastPluginTime[i] = pluginChain->audioTimers[i]->totalTaskTime;
+  }
+
+  taskTimerStart(self->_timer);
+
+  if (_isPublishing(self)) {
+    _publish(self);
+  }
+}
+
+void renderStatusUpdate(RenderStatus self, PluginChain pluginChain,
+                        const unsigned long position) {
+  double elapsed;
+
+  if (!_isPublishing(self)) {
+    return;
+  }
+
+  self->_blocksSinceUpdate++;
+  elapsed = _getElapsedTime(self);
+
+  if (elapsed - self->_lastUpdateTime >= (double)self->intervalInMs) {
+    _recalculate(self, pluginChain, position, elapsed);
+    _publish(self);
+  }
+}
+
+void renderStatusFinish(RenderStatus self, PluginChain pluginChain,
+                        const unsigned long position) {
+  _recalculate(self, pluginChain, position, _getElapsedTime(self));
+  taskTimerStop(self->_timer);
+  self->state = RENDER_STATUS_STATE_FINISHED;
+  self->etaSeconds = 0.0;
+
+  if (_isPublishing(self)) {
+    _publish(self);
+  }
+}
+
+void freeRenderStatus(RenderStatus self) {
+  unsigned int i;
+
+  if (self != NULL) {
+    if (self->_segment != NULL) {
+#if UNIX
+      munmap(self->_segment, sizeof(RenderStatusSegment));
+      shm_unlink(self->sharedMemoryName->data);
+#elif WINDOWS
+      UnmapViewOfFile(self->_segment);
+      CloseHandle((HANDLE)self->_segmentHandle);
+#endif
+    }
+
+    for (i = 0; i < MAX_PLUGINS; i++) {
+      freeCharString(self->pluginNames[i]);
+    }
+
+    freeCharString(self->statusFile);
+    freeCharString(self->sharedMemoryName);
+    freeTaskTimer(self->_timer);
+    free(self);
+  }
+}
@@ -0,0 +1,204 @@
+//
+// RenderStatus.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_RenderStatus_h
+#define MrsWatson_RenderStatus_h
+
+#include "base/CharString.h"
+#include "plugin/PluginChain.h"
+#include "time/TaskTimer.h"
+
+#include <stdint.h>
+
+#define RENDER_STATUS_DEFAULT_INTERVAL_IN_MS 1000
+// Status files with this extension are written in the Prometheus text format,
+// all others are written as JSON
+#define RENDER_STATUS_PROMETHEUS_EXTENSION ".prom"
+
+// "MWST" when the segment is read as bytes on a little-endian machine
+#define RENDER_STATUS_SEGMENT_MAGIC 0x5453574d
+#define RENDER_STATUS_SEGMENT_VERSION 1
+#define RENDER_STATUS_SEGMENT_NAME_LENGTH 64
+
+typedef enum {
+  RENDER_STATUS_STATE_STARTING,
+  RENDER_STATUS_STATE_RUNNING,
+  RENDER_STATUS_STATE_FINISHED,
+  NUM_RENDER_STATUS_STATES
+} RenderStatusState;
+
+typedef struct {
+  char name[RENDER_STATUS_SEGMENT_NAME_LENGTH];
+  double blockCostInMs;
+  uint64_t deadlineMisses;
+} RenderStatusSegmentPlugin;
+
+/**
+ * Layout of the shared memory segment which is published with --status-shm.
+ * All fields use the byte order of the rendering machine. The segment is
+ * updated with a sequence lock: the writer makes the sequence odd before
+ * changing any other field, and even again afterwards. A viewer should copy
+ * the whole segment, and retry the copy if the sequence was odd or changed
+ * while copying. Viewers never block the render, they only map the segment
+ * read-only.
+ *
+ * Unknown values, such as the total length of a render from stdin, or the ETA
+ * before the first update, are set to 0 and -1 respectively.
+ */
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  volatile uint32_t sequence;
+  // One of the RenderStatusState values
+  uint32_t state;
+  uint32_t processId;
+  uint32_t numPlugins;
+  uint64_t framesProcessed;
+  uint64_t position;
+  uint64_t totalFrames;
+  uint64_t updateCount;
+  double sampleRate;
+  double elapsedSeconds;
+  double currentRealtimeFactor;
+  double averageRealtimeFactor;
+  double etaSeconds;
+  RenderStatusSegmentPlugin plugins[MAX_PLUGINS];
+} RenderStatusSegment;
+
+/**
+ * Publishes progress counters while rendering, so that long renders can be
+ * monitored without parsing the log. The counters are written at a fixed
+ * interval to a status file, which is replaced atomically so that readers
+ * never see a partial file, and to a shared memory segment.
+ *
+ * The realtime factor is the amount of audio rendered per second of wall
+ * time, so anything above 1.0 is faster than realtime. The current factor
+ * and the plugin block costs only cover the time since the last update.
+ */
+typedef struct {
+  CharString statusFile;
+  CharString sharedMemoryName;
+  unsigned long intervalInMs;
+
+  RenderStatusState state;
+  // First frame of the render, and the expected frame where it ends. The
+  // position is the current frame in the input, counted from the start of
+  // the input rather than the start of the render.
+  unsigned long startFrame;
+  unsigned long totalFrames;
+  unsigned long position;
+  unsigned long framesProcessed;
+  unsigned long updateCount;
+
+  double elapsedSeconds;
+  double currentRealtimeFactor;
+  double averageRealtimeFactor;
+  double etaSeconds;
+
+  unsigned int numPlugins;
+  CharString pluginNames[MAX_PLUGINS];
+  double blockCostInMs[MAX_PLUGINS];
+  unsigned long deadlineMisses[MAX_PLUGINS];
+
+  // Private fields
+  TaskTimer _timer;
+  double _lastUpdateTime;
+  unsigned long _lastUpdatePosition;
+  unsigned long _blocksSinceUpdate;
+  double _lastPluginTime[MAX_PLUGINS];
+  boolByte _hasWriteFailed;
+  RenderStatusSegment *_segment;
+  void *_segmentHandle;
+} RenderStatusMembers;
+typedef RenderStatusMembers *RenderStatus;
+
+/**
+ * @return New render status object, which does not publish anything until a
+ * status file or shared memory segment is set
+ */
+RenderStatus newRenderStatus(void);
+
+/**
+ * Set the file which the status is written to. The file is replaced with each
+ * update, by writing to a temporary file in the same directory and renaming
+ * it over the old one.
+ * @param self
+ * @param filename Status file name. If it ends with ".prom", the status is
+ * written in the Prometheus text format, otherwise as JSON.
+ */
+void renderStatusSetFile(RenderStatus self, const CharString filename);
+
+/**
+ * Create a shared memory segment with the layout of RenderStatusSegment. On
+ * Unix systems this is a POSIX shared memory object, which is available under
+ * /dev/shm on Linux. On Windows it is a named file mapping.
+ * @param self
+ * @param name Segment name
+ * @return True if the segment was created
+ */
+boolByte renderStatusOpenSharedMemory(RenderStatus self,
+                                      const CharString name);
+
+/**
+ * Start the wall clock and publish the initial status
+ * @param self
+ * @param pluginChain Plugin chain which is rendering
+ * @param startFrame First frame of the render
+ * @param totalFrames Frame where the render is expected to end, or 0 if this
+ * is not known
+ */
+void renderStatusStart(RenderStatus self, PluginChain pluginChain,
+                       const unsigned long startFrame,
+                       const unsigned long totalFrames);
+
+/**
+ * Called after each processed block. This only checks the wall clock, unless
+ * the update interval has passed, in which case the counters are recalculated
+ * and published.
+ * @param self
+ * @param pluginChain Plugin chain which is rendering
+ * @param position Current frame in the input
+ */
+void renderStatusUpdate(RenderStatus self, PluginChain pluginChain,
+                        const unsigned long position);
+
+/**
+ * Publish the final counters, with the state set to finished
+ * @param self
+ * @param pluginChain Plugin chain which is rendering
+ * @param position Last frame which was rendered
+ */
+void renderStatusFinish(RenderStatus self, PluginChain pluginChain,
+                        const unsigned long position);
+
+/**
+ * Free a render status object and remove its shared memory segment. The
+ * status file is left in place, so that the final state can be read.
+ * @param self
+ */
+void freeRenderStatus(RenderStatus self);
+
+#endif
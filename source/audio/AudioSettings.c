@@ -34,6 +34,8 @@
 #include <string.h>
 
 AudioSettings audioSettingsInstance = NULL;
+// Settings used instead of the global instance on this thread, if any
+static THREAD_LOCAL AudioSettings threadAudioSettings = NULL;
 
 void initAudioSettings(void) {
   if (audioSettingsInstance != NULL) {
@@ -41,18 +43,29 @@ void initAudioSettings(void) {
   }
 
   audioSettingsInstance = malloc(sizeof(AudioSettingsMembers));
-  audioSettingsInstance->sampleRate = DEFAULT_SAMPLE_RATE;
-  audioSettingsInstance->numChannels = DEFAULT_NUM_CHANNELS;
-  audioSettingsInstance->blocksize = DEFAULT_BLOCKSIZE;
-  audioSettingsInstance->tempo = DEFAULT_TEMPO;
-  audioSettingsInstance->timeSignatureBeatsPerMeasure =
-      DEFAULT_TIMESIG_BEATS_PER_MEASURE;
-  audioSettingsInstance->timeSignatureNoteValue = DEFAULT_TIMESIG_NOTE_VALUE;
-  audioSettingsInstance->bitDepth = kBitDepthDefault;
+  audioSettingsSetDefaults(audioSettingsInstance);
+}
+
+void audioSettingsSetDefaults(AudioSettings self) {
+  self->sampleRate = DEFAULT_SAMPLE_RATE;
+  self->numChannels = DEFAULT_NUM_CHANNELS;
+  self->blocksize = DEFAULT_BLOCKSIZE;
+  self->tempo = DEFAULT_TEMPO;
+  self->timeSignatureBeatsPerMeasure = DEFAULT_TIMESIG_BEATS_PER_MEASURE;
+  self->timeSignatureNoteValue = DEFAULT_TIMESIG_NOTE_VALUE;
+  self->bitDepth = kBitDepthDefault;
+}
+
+AudioSettings setThreadAudioSettings(AudioSettings settings) {
+  AudioSettings previousSettings = threadAudioSettings;
+  threadAudioSettings = settings;
+  return previousSettings;
 }
 
 static AudioSettings _getAudioSettings(void) {
-  if (audioSettingsInstance == NULL) {
+  if (threadAudioSettings != NULL) {
+    return threadAudioSettings;
+  } else if (audioSettingsInstance == NULL) {
     initAudioSettings();
   }
 
@@ -122,16 +135,27 @@ boolByte setTempo(const Tempo tempo) {
 }
 
 void setTempoFromMidiBytes(const byte *bytes) {
-  double tempo;
+  if (bytes != NULL) {
+    setTempo(getTempoFromMidiBytes(bytes));
+  }
+}
+
+Tempo getTempoFromMidiBytes(const byte *bytes) {
   unsigned long beatLengthInMicroseconds = 0;
 
-  if (bytes != NULL) {
-    beatLengthInMicroseconds = (unsigned long)(0x00000000 | (bytes[0] << 16) |
-                                               (bytes[1] << 8) | (bytes[2]));
-    // Convert beats / microseconds -> beats / minutes
-    tempo = (1000000.0 / (double)beatLengthInMicroseconds) * 60.0;
-    setTempo((float)tempo);
+  if (bytes == NULL) {
+    return 0.0;
+  }
+
+  beatLengthInMicroseconds = (unsigned long)(0x00000000 | (bytes[0] << 16) |
+                                             (bytes[1] << 8) | (bytes[2]));
+
+  if (beatLengthInMicroseconds == 0) {
+    return 0.0;
   }
+
+  // Convert beats / microseconds -> beats / minutes
+  return (1000000.0 / (double)beatLengthInMicroseconds) * 60.0;
 }
 
 boolByte setTimeSignatureBeatsPerMeasure(const unsigned short beatsPerMeasure) {
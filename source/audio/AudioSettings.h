@@ -66,6 +66,24 @@ extern AudioSettings audioSettingsInstance;
  */
 void initAudioSettings(void);
 
+/**
+ * Reset a settings instance to the default values. This is used for settings
+ * which are not the global instance, see setThreadAudioSettings().
+ * @param self
+ */
+void audioSettingsSetDefaults(AudioSettings self);
+
+/**
+ * Make all of the getters and setters in this file use another settings
+ * instance instead of the global one, but only for calls which are made from
+ * the current thread. This lets several hosts with different settings run in
+ * the same process.
+ * @param settings Settings to use on this thread, or NULL to use the global
+ * instance again
+ * @return Settings which were used on this thread before this call, or NULL
+ */
+AudioSettings setThreadAudioSettings(AudioSettings settings);
+
 /**
  * Get the current sample rate.
  * @return Sample rate in Hertz
@@ -152,6 +170,14 @@ boolByte setTempo(const Tempo tempo);
  */
 void setTempoFromMidiBytes(const byte *bytes);
 
+/**
+ * Convert the three-byte payload of a MIDI tempo meta event to a tempo in
+ * beats per minute, without changing the global tempo.
+ * @param bytes Three byte sequence as read from a MIDI file
+ * @return Tempo in beats per minute, or 0 if the payload is invalid
+ */
+Tempo getTempoFromMidiBytes(const byte *bytes);
+
 /**
  * Set the time signature's numerator. This function does very little error
  * checking, but it does require a non-zero value. However, many plugins may act
@@ -0,0 +1,96 @@
+//
+// Denormals.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Denormals.h"
+
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) ||                                     \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DENORMALS_HAVE_SSE 1
+// Flush-to-zero (FTZ) and denormals-are-zero (DAZ) bits in the MXCSR register
+#define DENORMALS_SSE_MASK 0x8040
+#elif defined(__aarch64__)
+#define DENORMALS_HAVE_AARCH64 1
+// Flush-to-zero bit in the FPCR register, which covers both inputs and outputs
+#define DENORMALS_AARCH64_MASK (1ul << 24)
+#endif
+
+#if DENORMALS_HAVE_AARCH64
+static unsigned long _getAarch64Fpcr(void) {
+  unsigned long fpcr;
+  __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+  return fpcr;
+}
+#endif
+
+boolByte denormalsSetFlushToZero(boolByte enabled) {
+#if DENORMALS_HAVE_SSE
+  unsigned int csr = _mm_getcsr();
+  _mm_setcsr(enabled ? csr | DENORMALS_SSE_MASK : csr & ~DENORMALS_SSE_MASK);
+  return true;
+#elif DENORMALS_HAVE_AARCH64
+  unsigned long fpcr = _getAarch64Fpcr();
+  fpcr = enabled ? fpcr | DENORMALS_AARCH64_MASK
+                 : fpcr & ~DENORMALS_AARCH64_MASK;
+  __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+  return true;
+#else
+  return false;
+#endif
+}
+
+boolByte denormalsIsFlushToZeroEnabled(void) {
+#if DENORMALS_HAVE_SSE
+  return (boolByte)((_mm_getcsr() & DENORMALS_SSE_MASK) == DENORMALS_SSE_MASK);
+#elif DENORMALS_HAVE_AARCH64
+  return (boolByte)((_getAarch64Fpcr() & DENORMALS_AARCH64_MASK) != 0);
+#else
+  return false;
+#endif
+}
+
+unsigned long denormalsCountInSampleBuffer(const SampleBuffer buffer) {
+  unsigned long numDenormals = 0;
+  unsigned int bits;
+  ChannelCount channel;
+  SampleCount frame;
+
+  // Check the bits directly rather than with fpclassify(), which compares
+  // floats and would therefore see denormals as zero if DAZ is enabled
+  for (channel = 0; channel < buffer->numChannels; channel++) {
+    for (frame = 0; frame < buffer->blocksize; frame++) {
+      memcpy(&bits, &buffer->samples[channel][frame], sizeof(bits));
+
+      if ((bits & 0x7f800000) == 0 && (bits & 0x007fffff) != 0) {
+        numDenormals++;
+      }
+    }
+  }
+
+  return numDenormals;
+}
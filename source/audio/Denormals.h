@@ -0,0 +1,57 @@
+//
+// Denormals.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_Denormals_h
+#define MrsWatson_Denormals_h
+
+#include "audio/SampleBuffer.h"
+#include "base/Types.h"
+
+/**
+ * Set the floating point unit of the calling thread to flush denormal results
+ * to zero, and to treat denormal inputs as zero. Denormals are so small that
+ * they make no audible difference, but calculations with them can be many
+ * times slower, which is common in plugins whose filters or feedback loops
+ * decay towards silence. This setting only applies to the calling thread, and
+ * some plugins may change it themselves.
+ * @param enabled True to flush denormals, false to restore the default
+ * @return True if supported on this platform
+ */
+boolByte denormalsSetFlushToZero(boolByte enabled);
+
+/**
+ * @return True if the calling thread flushes denormals to zero
+ */
+boolByte denormalsIsFlushToZeroEnabled(void);
+
+/**
+ * Count the number of denormal samples in a buffer.
+ * @param buffer Buffer to check
+ * @return Number of samples which are denormal, on any channel
+ */
+unsigned long denormalsCountInSampleBuffer(const SampleBuffer buffer);
+
+#endif
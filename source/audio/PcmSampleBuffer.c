@@ -27,6 +27,7 @@
 #include "PcmSampleBuffer.h"
 
 #include "base/Endian.h"
+#include "base/MemoryTracker.h"
 #include "base/PlatformInfo.h"
 #include "logging/EventLogger.h"
 
@@ -310,7 +311,8 @@ static void _setSamples32Bit(void *selfPtr) {
 PcmSampleBuffer newPcmSampleBuffer(ChannelCount numChannels,
                                    SampleCount blocksize, BitDepth bitDepth) {
   PcmSampleBuffer pcmSampleBuffer =
-      (PcmSampleBuffer)malloc(sizeof(PcmSampleBufferMembers));
+      (PcmSampleBuffer)trackedMalloc(MEMORY_TAG_AUDIO,
+                                     sizeof(PcmSampleBufferMembers));
 
   pcmSampleBuffer->littleEndian = true;
   pcmSampleBuffer->bitDepth = bitDepth;
@@ -327,7 +329,8 @@ PcmSampleBuffer newPcmSampleBuffer(ChannelCount numChannels,
     pcmSampleBufferSize = numChannels * blocksize * sizeof(int);
   }
 
-  pcmSampleBuffer->pcmSamples = malloc(pcmSampleBufferSize);
+  pcmSampleBuffer->pcmSamples =
+      trackedMalloc(MEMORY_TAG_AUDIO, pcmSampleBufferSize);
   memset(pcmSampleBuffer->pcmSamples, 0, pcmSampleBufferSize);
   pcmSampleBuffer->getSampleBuffer = _getSampleBuffer;
 
@@ -363,7 +366,7 @@ PcmSampleBuffer newPcmSampleBuffer(ChannelCount numChannels,
 void freePcmSampleBuffer(PcmSampleBuffer self) {
   if (self != NULL) {
     freeSampleBuffer(self->_super);
-    free(self->pcmSamples);
-    free(self);
+    trackedFree(self->pcmSamples);
+    trackedFree(self);
   }
 }
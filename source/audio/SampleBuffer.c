@@ -24,11 +24,19 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //
 
+#if LINUX
+// Needed for anonymous memory mappings and madvise()
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE 1
+#endif
+#endif
+
 #include "SampleBuffer.h"
 
 #include "audio/AudioSettings.h"
 #include "audio/SampleBuffer.h"
 #include "base/Endian.h"
+#include "base/MemoryTracker.h"
 #include "logging/EventLogger.h"
 
 #include <math.h>
@@ -36,23 +44,220 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if LINUX
+#include <sys/mman.h>
+#endif
+
+// Channels whose starting addresses are a multiple of this many bytes apart
+// compete for the same cache sets, so their strides are padded to avoid it
+#define SAMPLE_BUFFER_CACHE_ALIASING_SIZE 4096
+
+#if LINUX
+static boolByte _useHugePages = false;
+#endif
+
+boolByte sampleBufferSetUseHugePages(boolByte enabled) {
+#if LINUX
+  _useHugePages = enabled;
+  return true;
+#else
+  return false;
+#endif
+}
+
+static SampleCount _getChannelStride(SampleCount blocksize) {
+  const SampleCount samplesPerLine = SAMPLE_BUFFER_ALIGNMENT / sizeof(Sample);
+  SampleCount stride =
+      (blocksize + samplesPerLine - 1) / samplesPerLine * samplesPerLine;
+
+  if ((stride * sizeof(Sample)) % SAMPLE_BUFFER_CACHE_ALIASING_SIZE == 0) {
+    stride += samplesPerLine;
+  }
+
+  return stride;
+}
+
+static void *_allocateAligned(size_t size) {
+#if WINDOWS
+  return _aligned_malloc(size, SAMPLE_BUFFER_ALIGNMENT);
+#else
+  void *result = NULL;
+
+  if (posix_memalign(&result, SAMPLE_BUFFER_ALIGNMENT, size) != 0) {
+    return NULL;
+  }
+
+  return result;
+#endif
+}
+
+#if LINUX
+static void *_allocateHugePages(size_t size) {
+  void *result = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+  result = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+
+  if (result == MAP_FAILED) {
+    // No huge pages have been reserved by the system, so fall back to regular
+    // pages and ask the kernel to use transparent huge pages for them instead
+    result = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (result == MAP_FAILED) {
+      return NULL;
+    }
+
+#ifdef MADV_HUGEPAGE
+    madvise(result, size, MADV_HUGEPAGE);
+#endif
+  }
+
+  return result;
+}
+#endif
+
+static void _allocateStorage(SampleBuffer self) {
+  size_t size = sizeof(Sample) * self->_stride * self->numChannels;
+
+  if (size < SAMPLE_BUFFER_ALIGNMENT) {
+    size = SAMPLE_BUFFER_ALIGNMENT;
+  }
+
+  self->_storage = NULL;
+  self->_storageSize = size;
+  self->_isHugePageStorage = false;
+
+#if LINUX
+  if (_useHugePages && size >= SAMPLE_BUFFER_HUGE_PAGE_SIZE) {
+    self->_storageSize = (size + SAMPLE_BUFFER_HUGE_PAGE_SIZE - 1) /
+                         SAMPLE_BUFFER_HUGE_PAGE_SIZE *
+                         SAMPLE_BUFFER_HUGE_PAGE_SIZE;
+    self->_storage = _allocateHugePages(self->_storageSize);
+
+    if (self->_storage != NULL) {
+      self->_isHugePageStorage = true;
+      memoryTrackerAddBytes(MEMORY_TAG_AUDIO, self->_storageSize);
+      return;
+    }
+
+    logWarn("Could not allocate huge pages for sample buffer");
+    self->_storageSize = size;
+  }
+#endif
+
+  self->_storage = _allocateAligned(size);
+
+  if (self->_storage != NULL) {
+    memoryTrackerAddBytes(MEMORY_TAG_AUDIO, self->_storageSize);
+  }
+}
+
+static void _freeStorage(SampleBuffer self) {
+  if (self->_isView || self->_storage == NULL) {
+    return;
+  }
+
+  memoryTrackerRemoveBytes(MEMORY_TAG_AUDIO, self->_storageSize);
+
+#if LINUX
+  if (self->_isHugePageStorage) {
+    munmap(self->_storage, self->_storageSize);
+    return;
+  }
+#endif
+
+#if WINDOWS
+  _aligned_free(self->_storage);
+#else
+  free(self->_storage);
+#endif
+}
+
 SampleBuffer newSampleBuffer(ChannelCount numChannels, SampleCount blocksize) {
-  SampleBuffer sampleBuffer = (SampleBuffer)malloc(sizeof(SampleBufferMembers));
+  SampleBuffer sampleBuffer = (SampleBuffer)trackedMalloc(
+      MEMORY_TAG_AUDIO, sizeof(SampleBufferMembers));
   sampleBuffer->numChannels = numChannels;
   sampleBuffer->blocksize = blocksize;
-  sampleBuffer->samples = (Samples *)malloc(sizeof(Samples) * numChannels);
+  sampleBuffer->samples = (Samples *)trackedMalloc(
+      MEMORY_TAG_AUDIO, sizeof(Samples) * numChannels);
+  sampleBuffer->_stride = _getChannelStride(blocksize);
+  sampleBuffer->_isView = false;
+  _allocateStorage(sampleBuffer);
 
   for (ChannelCount i = 0; i < numChannels; i++) {
-    sampleBuffer->samples[i] = (Samples)malloc(sizeof(Sample) * blocksize);
+    sampleBuffer->samples[i] =
+        (Samples)sampleBuffer->_storage + i * sampleBuffer->_stride;
   }
 
   sampleBufferClear(sampleBuffer);
   return sampleBuffer;
 }
 
+SampleBuffer newSampleBufferView(const SampleBuffer buffer, SampleCount offset,
+                                 SampleCount numFrames) {
+  SampleBuffer view = (SampleBuffer)trackedMalloc(MEMORY_TAG_AUDIO,
+                                                  sizeof(SampleBufferMembers));
+  view->numChannels = 0;
+  view->blocksize = 0;
+  view->samples = NULL;
+  view->_storage = NULL;
+  view->_storageSize = 0;
+  view->_stride = 0;
+  view->_isHugePageStorage = false;
+  view->_isView = true;
+
+  if (!sampleBufferViewSetRange(view, buffer, offset, numFrames)) {
+    freeSampleBuffer(view);
+    return NULL;
+  }
+
+  return view;
+}
+
+boolByte sampleBufferViewSetRange(SampleBuffer self, const SampleBuffer buffer,
+                                  SampleCount offset, SampleCount numFrames) {
+  if (!self->_isView) {
+    logInternalError("Cannot set the range of a buffer which is not a view");
+    return false;
+  }
+
+  if (offset + numFrames > buffer->blocksize) {
+    logInternalError("View of %lu frames at offset %lu exceeds buffer size %lu",
+                     numFrames, offset, buffer->blocksize);
+    return false;
+  }
+
+  if (self->numChannels != buffer->numChannels) {
+    trackedFree(self->samples);
+    self->samples = (Samples *)trackedMalloc(
+        MEMORY_TAG_AUDIO, sizeof(Samples) * buffer->numChannels);
+    self->numChannels = buffer->numChannels;
+  }
+
+  for (ChannelCount i = 0; i < self->numChannels; i++) {
+    self->samples[i] = buffer->samples[i] + offset;
+  }
+
+  self->blocksize = numFrames;
+  self->_stride = buffer->_stride;
+  return true;
+}
+
+SampleCount sampleBufferGetChannelStride(const SampleBuffer self) {
+  return self->_stride;
+}
+
 void sampleBufferClear(SampleBuffer self) {
+  sampleBufferClearFrames(self, 0, self->blocksize);
+}
+
+void sampleBufferClearFrames(SampleBuffer self, SampleCount offset,
+                             SampleCount numFrames) {
   for (ChannelCount i = 0; i < self->numChannels; i++) {
-    memset(self->samples[i], 0, sizeof(Sample) * self->blocksize);
+    memset(self->samples[i] + offset, 0, sizeof(Sample) * numFrames);
   }
 }
 
@@ -126,11 +331,8 @@ boolByte sampleBufferCopyAndMapChannels(SampleBuffer self,
 
 void freeSampleBuffer(SampleBuffer self) {
   if (self != NULL) {
-    for (ChannelCount channel = 0; channel < self->numChannels; ++channel) {
-      free(self->samples[channel]);
-    }
-
-    free(self->samples);
-    free(self);
+    _freeStorage(self);
+    trackedFree(self->samples);
+    trackedFree(self);
   }
 }
@@ -29,10 +29,28 @@
 
 #include "base/Types.h"
 
+#include <stddef.h>
+
+// Alignment of each channel's samples, which is the size of a cache line and
+// is enough for all SIMD instruction sets in use
+#define SAMPLE_BUFFER_ALIGNMENT 64
+// Buffers at least this large may be backed by huge pages, see
+// sampleBufferSetUseHugePages()
+#define SAMPLE_BUFFER_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
 typedef struct {
   ChannelCount numChannels;
   SampleCount blocksize;
+  // Channels point into a single block of memory, each one starting on a
+  // SAMPLE_BUFFER_ALIGNMENT boundary
   Samples *samples;
+
+  // Private fields
+  void *_storage;
+  size_t _storageSize;
+  SampleCount _stride;
+  boolByte _isHugePageStorage;
+  boolByte _isView;
 } SampleBufferMembers;
 typedef SampleBufferMembers *SampleBuffer;
 
@@ -44,12 +62,66 @@ typedef SampleBufferMembers *SampleBuffer;
  */
 SampleBuffer newSampleBuffer(ChannelCount numChannels, SampleCount blocksize);
 
+/**
+ * Create a view which refers to part of another buffer's samples without
+ * copying them. The view can be passed anywhere a SampleBuffer is expected,
+ * and writing to it changes the other buffer. It must be freed with
+ * freeSampleBuffer() before the buffer it refers to.
+ * @param buffer Buffer to refer to
+ * @param offset First frame of the buffer which the view refers to
+ * @param numFrames Blocksize of the view
+ * @return An initialized SampleBuffer view, or NULL if the range is not
+ * within the buffer
+ */
+SampleBuffer newSampleBufferView(const SampleBuffer buffer, SampleCount offset,
+                                 SampleCount numFrames);
+
+/**
+ * Point an existing view to another range of samples. This does not allocate
+ * memory unless the channel count changes, so views can be reused for each
+ * block or sub-block.
+ * @param self View created with newSampleBufferView()
+ * @param buffer Buffer to refer to
+ * @param offset First frame of the buffer which the view refers to
+ * @param numFrames Blocksize of the view
+ * @return True on success, false if self is not a view or the range is not
+ * within the buffer
+ */
+boolByte sampleBufferViewSetRange(SampleBuffer self, const SampleBuffer buffer,
+                                  SampleCount offset, SampleCount numFrames);
+
+/**
+ * Back sample buffers which are at least SAMPLE_BUFFER_HUGE_PAGE_SIZE bytes
+ * with huge pages, which reduces TLB misses for very large blocksizes. This
+ * only affects buffers created after this call, and is ignored on platforms
+ * which do not support it.
+ * @param enabled True to use huge pages for large buffers
+ * @return True if huge pages are supported on this platform
+ */
+boolByte sampleBufferSetUseHugePages(boolByte enabled);
+
+/**
+ * @param self
+ * @return Distance in samples between the start of consecutive channels. This
+ * is at least the buffer's blocksize.
+ */
+SampleCount sampleBufferGetChannelStride(const SampleBuffer self);
+
 /**
  * Set all samples to zero
  * @param self
  */
 void sampleBufferClear(SampleBuffer self);
 
+/**
+ * Set a range of frames to zero in all channels
+ * @param self
+ * @param offset First frame to clear
+ * @param numFrames Number of frames to clear
+ */
+void sampleBufferClearFrames(SampleBuffer self, SampleCount offset,
+                             SampleCount numFrames);
+
 /**
  * Copy some samples from another buffer to this one
  * @param destinationBuffer
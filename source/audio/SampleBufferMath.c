@@ -0,0 +1,380 @@
+//
+// SampleBufferMath.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "SampleBufferMath.h"
+
+#include "logging/EventLogger.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) ||                                     \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SAMPLE_BUFFER_MATH_HAVE_SSE 1
+// Number of samples processed by each SSE instruction
+#define SAMPLE_BUFFER_MATH_SSE_WIDTH 4
+#endif
+
+// Each function below processes as many samples as possible with SSE, and then
+// finishes the remaining samples (or all of them, if SSE is not available)
+// with scalar code. Loads and stores do not assume any alignment.
+
+static void _applyGain(Samples samples, const SampleCount numFrames,
+                       const Sample gain) {
+  SampleCount i = 0;
+
+#if SAMPLE_BUFFER_MATH_HAVE_SSE
+  const __m128 gainVector = _mm_set1_ps(gain);
+
+  for (; i + SAMPLE_BUFFER_MATH_SSE_WIDTH <= numFrames;
+       i += SAMPLE_BUFFER_MATH_SSE_WIDTH) {
+    _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i),
+                                          gainVector));
+  }
+#endif
+
+  for (; i < numFrames; i++) {
+    samples[i] *= gain;
+  }
+}
+
+void sampleBufferApplyGain(SampleBuffer self, const Sample gain) {
+  ChannelCount channel;
+
+  for (channel = 0; channel < self->numChannels; channel++) {
+    _applyGain(self->samples[channel], self->blocksize, gain);
+  }
+}
+
+static void _applyGainRamp(Samples samples, const SampleCount numFrames,
+                           const Sample startGain, const Sample increment) {
+  SampleCount i = 0;
+
+#if SAMPLE_BUFFER_MATH_HAVE_SSE
+  __m128 gainVector =
+      _mm_add_ps(_mm_set1_ps(startGain),
+                 _mm_mul_ps(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f),
+                            _mm_set1_ps(increment)));
+  const __m128 incrementVector =
+      _mm_set1_ps(increment * SAMPLE_BUFFER_MATH_SSE_WIDTH);
+
+  for (; i + SAMPLE_BUFFER_MATH_SSE_WIDTH <= numFrames;
+       i += SAMPLE_BUFFER_MATH_SSE_WIDTH) {
+    _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i),
+                                          gainVector));
+    gainVector = _mm_add_ps(gainVector, incrementVector);
+  }
+#endif
+
+  for (; i < numFrames; i++) {
+    samples[i] *= startGain + increment * (Sample)i;
+  }
+}
+
+void sampleBufferApplyGainRamp(SampleBuffer self, const Sample startGain,
+                               const Sample endGain) {
+  ChannelCount channel;
+  Sample increment;
+
+  if (self->blocksize == 0) {
+    return;
+  }
+
+  increment = (endGain - startGain) / (Sample)self->blocksize;
+
+  for (channel = 0; channel < self->numChannels; channel++) {
+    _applyGainRamp(self->samples[channel], self->blocksize, startGain,
+                   increment);
+  }
+}
+
+static void _mix(Samples samples, const Samples otherSamples,
+                 const SampleCount numFrames, const Sample gain) {
+  SampleCount i = 0;
+
+#if SAMPLE_BUFFER_MATH_HAVE_SSE
+  const __m128 gainVector = _mm_set1_ps(gain);
+
+  for (; i + SAMPLE_BUFFER_MATH_SSE_WIDTH <= numFrames;
+       i += SAMPLE_BUFFER_MATH_SSE_WIDTH) {
+    _mm_storeu_ps(samples + i,
+                  _mm_add_ps(_mm_loadu_ps(samples + i),
+                             _mm_mul_ps(_mm_loadu_ps(otherSamples + i),
+                                        gainVector)));
+  }
+#endif
+
+  for (; i < numFrames; i++) {
+    samples[i] += otherSamples[i] * gain;
+  }
+}
+
+boolByte sampleBufferMix(SampleBuffer self, const SampleBuffer buffer,
+                         const Sample gain) {
+  ChannelCount channel;
+
+  if (self->blocksize != buffer->blocksize) {
+    logInternalError("Cannot mix buffers of different sizes");
+    return false;
+  }
+
+  if (buffer->numChannels == 0) {
+    return true;
+  }
+
+  for (channel = 0; channel < self->numChannels; channel++) {
+    _mix(self->samples[channel],
+         buffer->samples[channel % buffer->numChannels], self->blocksize,
+         gain);
+  }
+
+  return true;
+}
+
+static void _clip(Samples samples, const SampleCount numFrames,
+                  const Sample limit) {
+  SampleCount i = 0;
+
+#if SAMPLE_BUFFER_MATH_HAVE_SSE
+  const __m128 maxVector = _mm_set1_ps(limit);
+  const __m128 minVector = _mm_set1_ps(-limit);
+
+  for (; i + SAMPLE_BUFFER_MATH_SSE_WIDTH <= numFrames;
+       i += SAMPLE_BUFFER_MATH_SSE_WIDTH) {
+    _mm_storeu_ps(samples + i,
+                  _mm_max_ps(_mm_min_ps(_mm_loadu_ps(samples + i), maxVector),
+                             minVector));
+  }
+#endif
+
+  for (; i < numFrames; i++) {
+    if (samples[i] > limit) {
+      samples[i] = limit;
+    } else if (samples[i] < -limit) {
+      samples[i] = -limit;
+    }
+  }
+}
+
+void sampleBufferClip(SampleBuffer self, const Sample limit) {
+  ChannelCount channel;
+
+  for (channel = 0; channel < self->numChannels; channel++) {
+    _clip(self->samples[channel], self->blocksize, limit);
+  }
+}
+
+Sample sampleBufferGetChannelPeak(const SampleBuffer self,
+                                  const ChannelCount channel) {
+  const Samples samples = self->samples[channel];
+  Sample peak = 0.0f;
+  SampleCount i = 0;
+
+#if SAMPLE_BUFFER_MATH_HAVE_SSE
+  // Clearing the sign bit gives the absolute value
+  const __m128 signMask = _mm_set1_ps(-0.0f);
+  __m128 peakVector = _mm_setzero_ps();
+  float lanes[SAMPLE_BUFFER_MATH_SSE_WIDTH];
+  int lane;
+
+  for (; i + SAMPLE_BUFFER_MATH_SSE_WIDTH <= self->blocksize;
+       i += SAMPLE_BUFFER_MATH_SSE_WIDTH) {
+    peakVector = _mm_max_ps(
+        peakVector, _mm_andnot_ps(signMask, _mm_loadu_ps(samples + i)));
+  }
+
+  _mm_storeu_ps(lanes, peakVector);
+  for (lane = 0; lane < SAMPLE_BUFFER_MATH_SSE_WIDTH; lane++) {
+    if (lanes[lane] > peak) {
+      peak = lanes[lane];
+    }
+  }
+#endif
+
+  for (; i < self->blocksize; i++) {
+    if (fabsf(samples[i]) > peak) {
+      peak = fabsf(samples[i]);
+    }
+  }
+
+  return peak;
+}
+
+Sample sampleBufferGetPeak(const SampleBuffer self) {
+  Sample peak = 0.0f;
+  Sample channelPeak;
+  ChannelCount channel;
+
+  for (channel = 0; channel < self->numChannels; channel++) {
+    channelPeak = sampleBufferGetChannelPeak(self, channel);
+
+    if (channelPeak > peak) {
+      peak = channelPeak;
+    }
+  }
+
+  return peak;
+}
+
+static boolByte _isBelowLevel(const Samples samples,
+                              const SampleCount numFrames,
+                              const Sample level) {
+  SampleCount i = 0;
+
+#if SAMPLE_BUFFER_MATH_HAVE_SSE
+  const __m128 signMask = _mm_set1_ps(-0.0f);
+  const __m128 levelVector = _mm_set1_ps(level);
+  __m128 louderVector;
+  SampleCount j;
+
+  // Blocks with any signal usually have it right at the start, so check
+  // several vectors at a time and stop at the first loud one
+  for (; i + 4 * SAMPLE_BUFFER_MATH_SSE_WIDTH <= numFrames;
+       i += 4 * SAMPLE_BUFFER_MATH_SSE_WIDTH) {
+    louderVector = _mm_setzero_ps();
+
+    for (j = 0; j < 4 * SAMPLE_BUFFER_MATH_SSE_WIDTH;
+         j += SAMPLE_BUFFER_MATH_SSE_WIDTH) {
+      louderVector = _mm_or_ps(
+          louderVector,
+          _mm_cmpgt_ps(_mm_andnot_ps(signMask, _mm_loadu_ps(samples + i + j)),
+                       levelVector));
+    }
+
+    if (_mm_movemask_ps(louderVector) != 0) {
+      return false;
+    }
+  }
+#endif
+
+  for (; i < numFrames; i++) {
+    if (fabsf(samples[i]) > level) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+boolByte sampleBufferIsSilent(const SampleBuffer self, const Sample level) {
+  ChannelCount channel;
+
+  for (channel = 0; channel < self->numChannels; channel++) {
+    if (!_isBelowLevel(self->samples[channel], self->blocksize, level)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static double _sumOfSquares(const Samples samples,
+                            const SampleCount numFrames) {
+  double sum = 0.0;
+  SampleCount i = 0;
+
+#if SAMPLE_BUFFER_MATH_HAVE_SSE
+  __m128 sumVector = _mm_setzero_ps();
+  __m128 sampleVector;
+  float lanes[SAMPLE_BUFFER_MATH_SSE_WIDTH];
+  int lane;
+
+  for (; i + SAMPLE_BUFFER_MATH_SSE_WIDTH <= numFrames;
+       i += SAMPLE_BUFFER_MATH_SSE_WIDTH) {
+    sampleVector = _mm_loadu_ps(samples + i);
+    sumVector = _mm_add_ps(sumVector, _mm_mul_ps(sampleVector, sampleVector));
+  }
+
+  _mm_storeu_ps(lanes, sumVector);
+  for (lane = 0; lane < SAMPLE_BUFFER_MATH_SSE_WIDTH; lane++) {
+    sum += lanes[lane];
+  }
+#endif
+
+  for (; i < numFrames; i++) {
+    sum += samples[i] * samples[i];
+  }
+
+  return sum;
+}
+
+Sample sampleBufferGetRms(const SampleBuffer self) {
+  double sum = 0.0;
+  ChannelCount channel;
+
+  if (self->numChannels == 0 || self->blocksize == 0) {
+    return 0.0f;
+  }
+
+  for (channel = 0; channel < self->numChannels; channel++) {
+    sum += _sumOfSquares(self->samples[channel], self->blocksize);
+  }
+
+  return (Sample)sqrt(sum / (double)(self->numChannels * self->blocksize));
+}
+
+boolByte sampleBufferSumToMono(SampleBuffer self, const SampleBuffer buffer) {
+  ChannelCount channel;
+
+  if (self->blocksize != buffer->blocksize || self->numChannels == 0) {
+    logInternalError("Cannot sum buffers of different sizes to mono");
+    return false;
+  }
+
+  if (buffer->numChannels == 0) {
+    memset(self->samples[0], 0, sizeof(Sample) * self->blocksize);
+    return true;
+  }
+
+  if (self->samples[0] != buffer->samples[0]) {
+    memcpy(self->samples[0], buffer->samples[0],
+           sizeof(Sample) * self->blocksize);
+  }
+
+  for (channel = 1; channel < buffer->numChannels; channel++) {
+    _mix(self->samples[0], buffer->samples[channel], self->blocksize, 1.0f);
+  }
+
+  _applyGain(self->samples[0], self->blocksize,
+             1.0f / (Sample)buffer->numChannels);
+  return true;
+}
+
+boolByte sampleBufferCopyChannel(SampleBuffer self, const ChannelCount channel,
+                                 const SampleBuffer buffer,
+                                 const ChannelCount bufferChannel) {
+  if (self->blocksize != buffer->blocksize || channel >= self->numChannels ||
+      bufferChannel >= buffer->numChannels) {
+    logInternalError("Cannot copy channel %d to channel %d", bufferChannel,
+                     channel);
+    return false;
+  }
+
+  memmove(self->samples[channel], buffer->samples[bufferChannel],
+          sizeof(Sample) * self->blocksize);
+  return true;
+}
@@ -0,0 +1,123 @@
+//
+// SampleBufferMath.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_SampleBufferMath_h
+#define MrsWatson_SampleBufferMath_h
+
+#include "audio/SampleBuffer.h"
+
+// Basic DSP operations on sample buffers. These are used by the internal
+// plugins and the analysis functions, and use SIMD instructions where
+// available.
+
+/**
+ * Multiply all samples by a constant gain.
+ * @param self
+ * @param gain Linear gain factor
+ */
+void sampleBufferApplyGain(SampleBuffer self, const Sample gain);
+
+/**
+ * Multiply all samples by a gain which changes linearly over the block, which
+ * avoids the clicks caused by sudden gain changes.
+ * @param self
+ * @param startGain Gain applied to the first frame
+ * @param endGain Gain which would be applied to the frame after the last one,
+ * so that consecutive ramps line up with each other
+ */
+void sampleBufferApplyGainRamp(SampleBuffer self, const Sample startGain,
+                               const Sample endGain);
+
+/**
+ * Add the samples of another buffer to this one. If the other buffer has
+ * fewer channels, they are mapped in the same way as
+ * sampleBufferCopyAndMapChannels().
+ * @param self
+ * @param buffer Buffer to mix into this one, with the same blocksize
+ * @param gain Gain applied to the other buffer's samples before adding them
+ * @return True on success, false if the buffers have different blocksizes
+ */
+boolByte sampleBufferMix(SampleBuffer self, const SampleBuffer buffer,
+                         const Sample gain);
+
+/**
+ * Limit all samples to the range [-limit, limit].
+ * @param self
+ * @param limit Maximum absolute sample value
+ */
+void sampleBufferClip(SampleBuffer self, const Sample limit);
+
+/**
+ * @param self
+ * @return The maximum absolute sample value on any channel
+ */
+Sample sampleBufferGetPeak(const SampleBuffer self);
+
+/**
+ * @param self
+ * @param channel Channel index
+ * @return The maximum absolute sample value on a single channel
+ */
+Sample sampleBufferGetChannelPeak(const SampleBuffer self,
+                                  const ChannelCount channel);
+
+/**
+ * Check if a buffer is silent. This is faster than comparing the peak with a
+ * level, because it stops at the first sample above the level.
+ * @param self
+ * @param level Maximum absolute sample value which is considered silent, use
+ * 0 to only accept digital silence
+ * @return True if no sample on any channel is louder than the level
+ */
+boolByte sampleBufferIsSilent(const SampleBuffer self, const Sample level);
+
+/**
+ * @param self
+ * @return The root mean square of all samples on all channels
+ */
+Sample sampleBufferGetRms(const SampleBuffer self);
+
+/**
+ * Average all channels of a buffer into the first channel of another buffer.
+ * @param self Destination buffer, only the first channel is written
+ * @param buffer Source buffer, with the same blocksize
+ * @return True on success, false if the buffers have different blocksizes
+ */
+boolByte sampleBufferSumToMono(SampleBuffer self, const SampleBuffer buffer);
+
+/**
+ * Copy a single channel from another buffer to a channel in this one.
+ * @param self Destination buffer
+ * @param channel Destination channel
+ * @param buffer Source buffer, with the same blocksize
+ * @param bufferChannel Source channel
+ * @return True on success, false if the channels or blocksizes do not match
+ */
+boolByte sampleBufferCopyChannel(SampleBuffer self, const ChannelCount channel,
+                                 const SampleBuffer buffer,
+                                 const ChannelCount bufferChannel);
+
+#endif
@@ -26,6 +26,7 @@
 
 #include "CharString.h"
 
+#include "base/MemoryTracker.h"
 #include "logging/EventLogger.h"
 
 #include <stdio.h>
@@ -37,9 +38,11 @@ CharString newCharString(void) {
 }
 
 CharString newCharStringWithCapacity(size_t length) {
-  CharString charString = (CharString)malloc(sizeof(CharStringMembers));
+  CharString charString = (CharString)trackedMalloc(
+      MEMORY_TAG_STRING, sizeof(CharStringMembers));
   charString->capacity = length;
-  charString->data = (char *)malloc(sizeof(char) * length);
+  charString->data =
+      (char *)trackedMalloc(MEMORY_TAG_STRING, sizeof(char) * length);
   charStringClear(charString);
   return charString;
 }
@@ -73,7 +76,8 @@ void charStringAppendCString(CharString self, const char *string) {
 
   if (stringLength + selfLength >= self->capacity) {
     self->capacity = stringLength + selfLength + 1; // don't forget the null!
-    self->data = (char *)realloc(self->data, self->capacity);
+    self->data = (char *)trackedRealloc(self->data, MEMORY_TAG_STRING,
+                                        self->capacity);
     strcat(self->data, string);
   } else {
     strcat(self->data, string);
@@ -287,7 +291,7 @@ CharString charStringWrap(const CharString srcString, unsigned int indentSize) {
 
 void freeCharString(CharString self) {
   if (self != NULL) {
-    free(self->data);
-    free(self);
+    trackedFree(self->data);
+    trackedFree(self);
   }
 }
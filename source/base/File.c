@@ -636,6 +636,40 @@ size_t fileGetSize(File self) {
   return result;
 }
 
+unsigned long fileGetModifiedTime(File self) {
+  unsigned long result = 0;
+
+  if (self->absolutePath == NULL) {
+    return 0;
+  }
+
+#if UNIX
+  struct stat fileStat;
+
+  if (stat(self->absolutePath->data, &fileStat) == 0) {
+    result = (unsigned long)fileStat.st_mtime;
+  }
+
+#elif WINDOWS
+  WIN32_FILE_ATTRIBUTE_DATA fileAttributes;
+
+  if (GetFileAttributesExA(self->absolutePath->data, GetFileExInfoStandard,
+                           &fileAttributes)) {
+    ULARGE_INTEGER writeTime;
+    writeTime.LowPart = fileAttributes.ftLastWriteTime.dwLowDateTime;
+    writeTime.HighPart = fileAttributes.ftLastWriteTime.dwHighDateTime;
+    // FILETIME counts 100ns intervals since 1601, convert to the Unix epoch
+    result = (unsigned long)((writeTime.QuadPart - 116444736000000000ULL) /
+                             10000000ULL);
+  }
+
+#else
+  logUnsupportedFeature("Get file modification time");
+#endif
+
+  return result;
+}
+
 CharString fileReadContents(File self) {
   CharString result = NULL;
   size_t fileSize = 0;
@@ -150,6 +150,14 @@ LinkedList fileListDirectory(File self);
  */
 size_t fileGetSize(File self);
 
+/**
+ * Return the time at which a file was last modified.
+ * @param self
+ * @return Modification time in seconds since the epoch, or 0 if this object
+ * does not exist.
+ */
+unsigned long fileGetModifiedTime(File self);
+
 /**
  * Read the contents of an entire file into a string. If the file had previously
  * been opened for writing, then it will be flushed, closed, and reopened for
@@ -37,13 +37,12 @@ LinkedList newLinkedList(void) {
   list->item = NULL;
   list->nextItem = NULL;
   list->_numItems = 0;
+  list->_lastNode = NULL;
 
   return list;
 }
 
 void linkedListAppend(LinkedList self, void *item) {
-  LinkedListIterator iterator = self;
-  LinkedListIterator headNode;
   LinkedList nextItem;
 
   if (self == NULL || item == NULL) {
@@ -51,25 +50,20 @@ void linkedListAppend(LinkedList self, void *item) {
   }
 
   // First item in the list
-  if (iterator->item == NULL) {
-    iterator->item = item;
-    iterator->_numItems = 1;
+  if (self->item == NULL) {
+    self->item = item;
+    self->_numItems = 1;
+    self->_lastNode = self;
     return;
   }
 
-  headNode = self;
-
-  while (true) {
-    if (iterator->nextItem == NULL) {
-      nextItem = newLinkedList();
-      nextItem->item = item;
-      iterator->nextItem = nextItem;
-      headNode->_numItems++;
-      break;
-    } else {
-      iterator = (LinkedListIterator)(iterator->nextItem);
-    }
-  }
+  // The head node remembers the last node, so that appending does not have to
+  // walk the entire list
+  nextItem = newLinkedList();
+  nextItem->item = item;
+  ((LinkedList)self->_lastNode)->nextItem = nextItem;
+  self->_lastNode = nextItem;
+  self->_numItems++;
 }
 
 int linkedListLength(LinkedList self) {
@@ -31,9 +31,10 @@ typedef struct {
   void *item;
   void *nextItem;
 
-  // This field should be considered private, and is only valid for the head
+  // These fields should be considered private, and are only valid for the head
   // node
   int _numItems;
+  void *_lastNode;
 } LinkedListMembers;
 
 typedef LinkedListMembers *LinkedList;
@@ -0,0 +1,262 @@
+//
+// MemoryTracker.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "MemoryTracker.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if LINUX
+#include <unistd.h>
+#elif MACOSX
+#include <mach/mach.h>
+#elif WINDOWS
+#include <windows.h>
+// Use the version of GetProcessMemoryInfo() from kernel32, so that there is
+// no need to link against psapi
+#define PSAPI_VERSION 2
+#include <psapi.h>
+#endif
+
+#if WINDOWS
+#define _atomicAdd(pointer, value)                                             \
+  InterlockedExchangeAdd64((volatile LONG64 *)(pointer), (LONG64)(value))
+#define _atomicCompareAndSwap(pointer, oldValue, newValue)                     \
+  InterlockedCompareExchange64((volatile LONG64 *)(pointer),                   \
+                               (LONG64)(newValue), (LONG64)(oldValue))
+#else
+#define _atomicAdd(pointer, value) __sync_fetch_and_add(pointer, value)
+#define _atomicCompareAndSwap(pointer, oldValue, newValue)                     \
+  __sync_val_compare_and_swap(pointer, oldValue, newValue)
+#endif
+
+// Size of the header in front of each tracked block. This is larger than the
+// header itself, so that blocks keep the alignment which malloc() guarantees.
+#define MEMORY_TRACKER_HEADER_SIZE 16
+
+typedef struct {
+  size_t size;
+  size_t tag;
+} MemoryTrackerHeaderMembers;
+typedef MemoryTrackerHeaderMembers *MemoryTrackerHeader;
+
+typedef struct {
+  volatile int64_t currentBytes;
+  volatile int64_t peakBytes;
+  volatile int64_t numAllocations;
+} MemoryTrackerCountersMembers;
+
+static MemoryTrackerCountersMembers _counters[NUM_MEMORY_TAGS];
+// Only set once at startup, before anything has been allocated
+static boolByte _enabled = false;
+
+static const char *kMemoryTagNames[NUM_MEMORY_TAGS] = {
+    "Audio buffers", "MIDI", "Strings", "I/O", "Plugin host"};
+
+static void _memoryTrackerAdd(const size_t tag, const int64_t size) {
+  MemoryTrackerCountersMembers *counters = &_counters[tag];
+  const int64_t currentBytes = _atomicAdd(&counters->currentBytes, size) + size;
+  int64_t peakBytes = _atomicAdd(&counters->peakBytes, 0);
+  int64_t previousPeakBytes;
+
+  if (size > 0) {
+    _atomicAdd(&counters->numAllocations, 1);
+  }
+
+  // Another thread may raise the peak at the same time, so retry until either
+  // this thread has set it, or it is already higher
+  while (currentBytes > peakBytes) {
+    previousPeakBytes =
+        _atomicCompareAndSwap(&counters->peakBytes, peakBytes, currentBytes);
+
+    if (previousPeakBytes == peakBytes) {
+      break;
+    }
+
+    peakBytes = previousPeakBytes;
+  }
+}
+
+static void *_memoryTrackerFinishBlock(void *block, const MemoryTag tag,
+                                       const size_t size) {
+  MemoryTrackerHeader header = (MemoryTrackerHeader)block;
+
+  if (block == NULL) {
+    return NULL;
+  }
+
+  header->size = size;
+  header->tag = (size_t)tag;
+  _memoryTrackerAdd(header->tag, (int64_t)size);
+  return (char *)block + MEMORY_TRACKER_HEADER_SIZE;
+}
+
+void memoryTrackerEnable(void) { _enabled = true; }
+
+boolByte memoryTrackerIsEnabled(void) { return _enabled; }
+
+void *trackedMalloc(const MemoryTag tag, const size_t size) {
+  if (!_enabled) {
+    return malloc(size);
+  }
+
+  return _memoryTrackerFinishBlock(malloc(MEMORY_TRACKER_HEADER_SIZE + size),
+                                   tag, size);
+}
+
+void *trackedCalloc(const MemoryTag tag, const size_t count,
+                    const size_t size) {
+  void *result;
+
+  if (!_enabled) {
+    return calloc(count, size);
+  }
+
+  result = trackedMalloc(tag, count * size);
+
+  if (result != NULL) {
+    memset(result, 0, count * size);
+  }
+
+  return result;
+}
+
+void *trackedRealloc(void *pointer, const MemoryTag tag, const size_t size) {
+  MemoryTrackerHeader header;
+  size_t oldSize;
+  void *block;
+
+  if (!_enabled) {
+    return realloc(pointer, size);
+  } else if (pointer == NULL) {
+    return trackedMalloc(tag, size);
+  }
+
+  header = (MemoryTrackerHeader)((char *)pointer - MEMORY_TRACKER_HEADER_SIZE);
+  oldSize = header->size;
+  block = realloc(header, MEMORY_TRACKER_HEADER_SIZE + size);
+
+  if (block == NULL) {
+    return NULL;
+  }
+
+  header = (MemoryTrackerHeader)block;
+  header->size = size;
+  _memoryTrackerAdd(header->tag, (int64_t)size - (int64_t)oldSize);
+  return (char *)block + MEMORY_TRACKER_HEADER_SIZE;
+}
+
+void trackedFree(void *pointer) {
+  MemoryTrackerHeader header;
+
+  if (!_enabled) {
+    free(pointer);
+  } else if (pointer != NULL) {
+    header =
+        (MemoryTrackerHeader)((char *)pointer - MEMORY_TRACKER_HEADER_SIZE);
+    _memoryTrackerAdd(header->tag, -(int64_t)header->size);
+    free(header);
+  }
+}
+
+void memoryTrackerAddBytes(const MemoryTag tag, const size_t size) {
+  if (_enabled) {
+    _memoryTrackerAdd((size_t)tag, (int64_t)size);
+  }
+}
+
+void memoryTrackerRemoveBytes(const MemoryTag tag, const size_t size) {
+  if (_enabled) {
+    _memoryTrackerAdd((size_t)tag, -(int64_t)size);
+  }
+}
+
+void memoryTrackerGetUsage(const MemoryTag tag, MemoryUsage usage) {
+  MemoryTrackerCountersMembers *counters = &_counters[tag];
+  const int64_t currentBytes = _atomicAdd(&counters->currentBytes, 0);
+
+  usage->currentBytes = currentBytes > 0 ? (size_t)currentBytes : 0;
+  usage->peakBytes = (size_t)_atomicAdd(&counters->peakBytes, 0);
+  usage->numAllocations =
+      (unsigned long)_atomicAdd(&counters->numAllocations, 0);
+}
+
+size_t memoryTrackerGetTotalBytes(void) {
+  int64_t totalBytes = 0;
+  unsigned int i;
+
+  for (i = 0; i < NUM_MEMORY_TAGS; i++) {
+    totalBytes += _atomicAdd(&_counters[i].currentBytes, 0);
+  }
+
+  return totalBytes > 0 ? (size_t)totalBytes : 0;
+}
+
+const char *memoryTagGetName(const MemoryTag tag) {
+  return tag < NUM_MEMORY_TAGS ? kMemoryTagNames[tag] : NULL;
+}
+
+size_t memoryTrackerGetResidentBytes(void) {
+#if LINUX
+  FILE *statm = fopen("/proc/self/statm", "r");
+  unsigned long totalPages = 0;
+  unsigned long residentPages = 0;
+
+  if (statm == NULL) {
+    return 0;
+  }
+
+  if (fscanf(statm, "%lu %lu", &totalPages, &residentPages) != 2) {
+    residentPages = 0;
+  }
+
+  fclose(statm);
+  return (size_t)residentPages * (size_t)sysconf(_SC_PAGESIZE);
+#elif MACOSX
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info,
+                &count) != KERN_SUCCESS) {
+    return 0;
+  }
+
+  return (size_t)info.resident_size;
+#elif WINDOWS
+  PROCESS_MEMORY_COUNTERS counters;
+
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                            sizeof(counters))) {
+    return 0;
+  }
+
+  return (size_t)counters.WorkingSetSize;
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,149 @@
+//
+// MemoryTracker.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_MemoryTracker_h
+#define MrsWatson_MemoryTracker_h
+
+#include "base/Types.h"
+
+#include <stddef.h>
+
+/**
+ * The host's own allocations are tagged by the subsystem which made them, so
+ * that the memory usage of each one can be reported. Memory which is allocated
+ * by plugins cannot be tracked, but it shows up in the process's resident set
+ * size (RSS), see memoryTrackerGetResidentBytes().
+ *
+ * Tracking is off by default, in which case the tracked functions call the
+ * standard allocator directly. When it is enabled, blocks which are allocated
+ * with the tracked functions carry a small header with their size and tag, so
+ * they must only be resized with trackedRealloc() and released with
+ * trackedFree(). All functions are thread-safe.
+ */
+typedef enum {
+  MEMORY_TAG_AUDIO,
+  MEMORY_TAG_MIDI,
+  MEMORY_TAG_STRING,
+  MEMORY_TAG_IO,
+  MEMORY_TAG_PLUGIN,
+  NUM_MEMORY_TAGS
+} MemoryTag;
+
+typedef struct {
+  size_t currentBytes;
+  size_t peakBytes;
+  unsigned long numAllocations;
+} MemoryUsageMembers;
+typedef MemoryUsageMembers *MemoryUsage;
+
+/**
+ * Start counting allocations. Since this changes the layout of tracked blocks,
+ * it must be called before the first tracked allocation, and tracking cannot
+ * be turned off again afterwards.
+ */
+void memoryTrackerEnable(void);
+
+/**
+ * @return True if memoryTrackerEnable() has been called. Otherwise, the usage
+ * of all subsystems is reported as zero.
+ */
+boolByte memoryTrackerIsEnabled(void);
+
+/**
+ * Allocate a tracked block of memory
+ * @param tag Subsystem which owns the memory
+ * @param size Size of the block in bytes
+ * @return Pointer to the block, or NULL if it could not be allocated
+ */
+void *trackedMalloc(const MemoryTag tag, const size_t size);
+
+/**
+ * Allocate a tracked block of memory which is set to zero
+ * @param tag Subsystem which owns the memory
+ * @param count Number of items
+ * @param size Size of each item in bytes
+ * @return Pointer to the block, or NULL if it could not be allocated
+ */
+void *trackedCalloc(const MemoryTag tag, const size_t count, const size_t size);
+
+/**
+ * Resize a tracked block of memory, which keeps its tag
+ * @param pointer Block allocated with one of the tracked functions, or NULL
+ * @param tag Subsystem which owns the memory, only used if pointer is NULL
+ * @param size New size of the block in bytes
+ * @return Pointer to the resized block, or NULL if it could not be resized.
+ * In that case the original block is left untouched.
+ */
+void *trackedRealloc(void *pointer, const MemoryTag tag, const size_t size);
+
+/**
+ * Release a tracked block of memory. This has the same signature as free(),
+ * so it can also be passed to freeLinkedListAndItems().
+ * @param pointer Block allocated with one of the tracked functions, or NULL
+ */
+void trackedFree(void *pointer);
+
+/**
+ * Record memory which cannot be allocated with the tracked functions, such as
+ * aligned or memory-mapped blocks
+ * @param tag Subsystem which owns the memory
+ * @param size Size of the block in bytes
+ */
+void memoryTrackerAddBytes(const MemoryTag tag, const size_t size);
+
+/**
+ * Record the release of memory which was added with memoryTrackerAddBytes()
+ * @param tag Subsystem which owns the memory
+ * @param size Size of the block in bytes
+ */
+void memoryTrackerRemoveBytes(const MemoryTag tag, const size_t size);
+
+/**
+ * Get the memory usage of a subsystem
+ * @param tag Subsystem
+ * @param usage Structure to fill in
+ */
+void memoryTrackerGetUsage(const MemoryTag tag, MemoryUsage usage);
+
+/**
+ * @return Number of bytes currently allocated by all subsystems
+ */
+size_t memoryTrackerGetTotalBytes(void);
+
+/**
+ * @param tag Subsystem
+ * @return Human-readable name of the subsystem
+ */
+const char *memoryTagGetName(const MemoryTag tag);
+
+/**
+ * Get the resident set size of the process, which includes the memory used
+ * by plugins
+ * @return Resident memory in bytes, or 0 if it is not available
+ */
+size_t memoryTrackerGetResidentBytes(void);
+
+#endif
@@ -42,6 +42,10 @@
 #include <ntverp.h>
 #endif
 
+#if UNIX
+#include <unistd.h>
+#endif
+
 static PlatformType _getPlatformType() {
 #if MACOSX
   return PLATFORM_MACOSX;
@@ -225,6 +229,31 @@ boolByte platformInfoIsHost64Bit(void) {
   return result;
 }
 
+unsigned int platformInfoGetNumProcessors(void) {
+  unsigned int result = 1;
+
+#if UNIX
+  long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (numProcessors > 0) {
+    result = (unsigned int)numProcessors;
+  }
+
+#elif WINDOWS
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+
+  if (systemInfo.dwNumberOfProcessors > 0) {
+    result = (unsigned int)systemInfo.dwNumberOfProcessors;
+  }
+
+#else
+  logUnsupportedFeature("Get number of processors");
+#endif
+
+  return result;
+}
+
 boolByte platformInfoIsLittleEndian(void) {
   int num = 1;
   return (boolByte)(*(char *)&num == 1);
@@ -63,6 +63,12 @@ boolByte platformInfoIsHost64Bit(void);
  */
 boolByte platformInfoIsRuntime64Bit(void);
 
+/**
+ * @brief Number of processors which are currently online
+ * @return Processor count, which is always at least 1
+ */
+unsigned int platformInfoGetNumProcessors(void);
+
 void freePlatformInfo(PlatformInfo self);
 
 #endif
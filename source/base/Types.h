@@ -77,6 +77,13 @@ typedef unsigned char byte;
 
 #endif
 
+// Storage class for variables which have a separate value in each thread
+#if WINDOWS
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
 // LibraryHandle definition
 #if MACOSX
 #include <CoreFoundation/CFBundle.h>
@@ -27,12 +27,14 @@
 #include "RiffFile.h"
 
 #include "base/Endian.h"
+#include "base/MemoryTracker.h"
 
 #include <stdlib.h>
 #include <string.h>
 
 RiffChunk newRiffChunk(void) {
-  RiffChunk chunk = (RiffChunk)malloc(sizeof(RiffChunkMembers));
+  RiffChunk chunk =
+      (RiffChunk)trackedMalloc(MEMORY_TAG_IO, sizeof(RiffChunkMembers));
   memset(chunk->id, 0, 5);
   chunk->size = 0;
   chunk->data = NULL;
@@ -64,7 +66,7 @@ boolByte riffChunkReadNext(RiffChunk self, FILE *fileHandle,
     free(chunkSize);
 
     if (self->size > 0 && readData) {
-      self->data = (byte *)malloc(self->size);
+      self->data = (byte *)trackedMalloc(MEMORY_TAG_IO, self->size);
       itemsRead = fread(self->data, 1, self->size, fileHandle);
 
       if (itemsRead != self->size) {
@@ -82,8 +84,8 @@ boolByte riffChunkIsIdEqualTo(const RiffChunk self, const char *id) {
 
 void freeRiffChunk(RiffChunk self) {
   if (self->data) {
-    free(self->data);
+    trackedFree(self->data);
   }
 
-  free(self);
+  trackedFree(self);
 }
@@ -27,6 +27,7 @@
 #include "SampleSource.h"
 
 #include "base/File.h"
+#include "io/SampleSourceFloat.h"
 #include "logging/EventLogger.h"
 
 #include <stdio.h>
@@ -49,6 +50,7 @@ void sampleSourcePrintSupportedTypes(void) {
 
   // Always supported
   logInfo("- PCM");
+  logInfo("- Raw float (f32, f64, f32p, f64p)");
 
 #if USE_AUDIOFILE
   logInfo("- WAV (via libaudiofile)");
@@ -64,6 +66,9 @@ static SampleSourceType _sampleSourceGuess(const CharString sampleSourceName) {
 
   if (sampleSourceName == NULL || charStringIsEmpty(sampleSourceName)) {
     result = SAMPLE_SOURCE_TYPE_SILENCE;
+  } else if (sampleSourceFloatIsFloatName(sampleSourceName)) {
+    // This also covers stdin/stdout ("-.f32") and file descriptors ("&3.f32")
+    result = SAMPLE_SOURCE_TYPE_FLOAT;
   } else {
     // Look for stdin/stdout
     if (strlen(sampleSourceName->data) == 1 &&
@@ -119,6 +124,7 @@ static SampleSourceType _sampleSourceGuess(const CharString sampleSourceName) {
 extern SampleSource
 _newSampleSourceAudiofile(const CharString sampleSourceName,
                           const SampleSourceType sampleSourceType);
+extern SampleSource _newSampleSourceFloat(const CharString sampleSourceName);
 extern SampleSource _newSampleSourcePcm(const CharString sampleSourceName);
 extern SampleSource _newSampleSourceSilence();
 extern SampleSource _newSampleSourceWave(const CharString sampleSourceName);
@@ -133,6 +139,9 @@ SampleSource sampleSourceFactory(const CharString sampleSourceName) {
   case SAMPLE_SOURCE_TYPE_PCM:
     return _newSampleSourcePcm(sampleSourceName);
 
+  case SAMPLE_SOURCE_TYPE_FLOAT:
+    return _newSampleSourceFloat(sampleSourceName);
+
 #if USE_AUDIOFILE
 
   case SAMPLE_SOURCE_TYPE_AIFF:
@@ -160,8 +169,71 @@ SampleSource sampleSourceFactory(const CharString sampleSourceName) {
   }
 }
 
+boolByte sampleSourceSeek(SampleSource self, const SampleCount frame) {
+  if (self == NULL) {
+    return false;
+  }
+
+  if (self->openedAs == SAMPLE_SOURCE_OPEN_WRITE) {
+    logError("Sample source '%s' is opened for writing and cannot be seeked",
+             self->sourceName->data);
+    return false;
+  }
+
+  if (self->seekSampleSource == NULL) {
+    logUnsupportedFeature("Seeking in this sample source type");
+    return false;
+  }
+
+  logDebug("Seeking to frame %lu in '%s'", frame, self->sourceName->data);
+  return self->seekSampleSource(self, frame);
+}
+
+SampleCount sampleSourceGetLength(SampleSource self) {
+  if (self == NULL || self->getSampleSourceLength == NULL ||
+      self->openedAs == SAMPLE_SOURCE_OPEN_NOT_OPENED) {
+    return 0;
+  }
+
+  return self->getSampleSourceLength(self);
+}
+
+static boolByte _sampleSourceSetView(SampleSource self, SampleBuffer buffer,
+                                     const SampleCount offset,
+                                     const SampleCount numFrames) {
+  if (self->_view == NULL) {
+    self->_view = newSampleBufferView(buffer, offset, numFrames);
+    return (boolByte)(self->_view != NULL);
+  }
+
+  return sampleBufferViewSetRange(self->_view, buffer, offset, numFrames);
+}
+
+SampleCount sampleSourceReadFrames(SampleSource self, SampleBuffer buffer,
+                                   const SampleCount offset,
+                                   const SampleCount numFrames) {
+  if (!_sampleSourceSetView(self, buffer, offset, numFrames)) {
+    return 0;
+  }
+
+  // Sources set the blocksize to the number of frames actually read
+  self->readSampleBlock(self, self->_view);
+  return self->_view->blocksize;
+}
+
+boolByte sampleSourceWriteFrames(SampleSource self, const SampleBuffer buffer,
+                                 const SampleCount offset,
+                                 const SampleCount numFrames) {
+  if (!_sampleSourceSetView(self, buffer, offset, numFrames)) {
+    return false;
+  }
+
+  return self->writeSampleBlock(self, self->_view);
+}
+
 void freeSampleSource(SampleSource self) {
   if (self != NULL) {
+    freeSampleBuffer(self->_view);
     self->freeSampleSourceData(self->extraData);
     freeCharString(self->sourceName);
     free(self);
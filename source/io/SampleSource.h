@@ -40,6 +40,9 @@ typedef enum {
   SAMPLE_SOURCE_TYPE_MP3,
   SAMPLE_SOURCE_TYPE_OGG,
   SAMPLE_SOURCE_TYPE_WAVE,
+  SAMPLE_SOURCE_TYPE_FLOAT,
+  // Wraps another source, see newSampleSourceBuffered()
+  SAMPLE_SOURCE_TYPE_BUFFERED,
   NUM_SAMPLE_SOURCES
 } SampleSourceType;
 
@@ -53,6 +56,8 @@ typedef enum {
 typedef boolByte (*OpenSampleSourceFunc)(void *, const SampleSourceOpenAs);
 typedef boolByte (*ReadSampleBlockFunc)(void *, SampleBuffer);
 typedef boolByte (*WriteSampleBlockFunc)(void *, const SampleBuffer);
+typedef boolByte (*SeekSampleSourceFunc)(void *, const SampleCount);
+typedef SampleCount (*GetSampleSourceLengthFunc)(void *);
 typedef void (*CloseSampleSourceFunc)(void *);
 typedef void (*FreeSampleSourceDataFunc)(void *);
 
@@ -65,10 +70,16 @@ typedef struct {
   OpenSampleSourceFunc openSampleSource;
   ReadSampleBlockFunc readSampleBlock;
   WriteSampleBlockFunc writeSampleBlock;
+  SeekSampleSourceFunc seekSampleSource;
+  GetSampleSourceLengthFunc getSampleSourceLength;
   CloseSampleSourceFunc closeSampleSource;
   FreeSampleSourceDataFunc freeSampleSourceData;
 
   void *extraData;
+
+  // Private fields
+  // View used to read and write parts of a buffer, created on first use
+  SampleBuffer _view;
 } SampleSourceMembers;
 typedef SampleSourceMembers *SampleSource;
 
@@ -80,6 +91,51 @@ typedef SampleSourceMembers *SampleSource;
  */
 SampleSource sampleSourceFactory(const CharString sampleSourceName);
 
+/**
+ * Move the read position of a sample source to a given frame. Sources which
+ * are backed by a regular file seek directly to the requested position, while
+ * streams (such as stdin) must read and discard all preceding frames. Seeking
+ * does not change the numSamplesProcessed counter.
+ * @param self
+ * @param frame Sample frame to seek to, relative to the start of the source
+ * @return True if the source is now positioned at the requested frame
+ */
+boolByte sampleSourceSeek(SampleSource self, const SampleCount frame);
+
+/**
+ * Get the total length of an opened sample source. Streams and generated
+ * sources have no known length.
+ * @param self
+ * @return Length in sample frames, or 0 if the length is not known
+ */
+SampleCount sampleSourceGetLength(SampleSource self);
+
+/**
+ * Read frames into part of a buffer, without copying them through an
+ * intermediate buffer.
+ * @param self
+ * @param buffer Buffer to read into
+ * @param offset First frame of the buffer to read into
+ * @param numFrames Maximum number of frames to read
+ * @return Number of frames which were actually read, which is less than
+ * numFrames at the end of the source
+ */
+SampleCount sampleSourceReadFrames(SampleSource self, SampleBuffer buffer,
+                                   const SampleCount offset,
+                                   const SampleCount numFrames);
+
+/**
+ * Write part of a buffer, without copying it to an intermediate buffer.
+ * @param self
+ * @param buffer Buffer to write from
+ * @param offset First frame of the buffer to write
+ * @param numFrames Number of frames to write
+ * @return True on success, false on failure
+ */
+boolByte sampleSourceWriteFrames(SampleSource self, const SampleBuffer buffer,
+                                 const SampleCount offset,
+                                 const SampleCount numFrames);
+
 /**
  * Print a list of all supported sample source pipes to the log
  */
@@ -170,7 +170,8 @@ boolByte _readBlockFromAudiofile(void *selfPtr, SampleBuffer sampleBuffer) {
 
   numFramesRead =
       afReadFrames(extraData->fileHandle, AF_DEFAULT_TRACK,
-                   extraData->pcmSampleBuffer->pcmSamples, (int)getBlocksize());
+                   extraData->pcmSampleBuffer->pcmSamples,
+                   (int)sampleBuffer->blocksize);
   extraData->pcmSampleBuffer->setSamples(extraData->pcmSampleBuffer);
 
   sampleBufferCopyAndMapChannels(
@@ -197,15 +198,29 @@ boolByte _writeBlockToAudiofile(void *selfPtr,
   SampleSource self = (SampleSource)selfPtr;
   SampleSourceAudiofileData extraData =
       (SampleSourceAudiofileData)(self->extraData);
+  const SampleBuffer superSampleBuffer =
+      extraData->pcmSampleBuffer->getSampleBuffer(extraData->pcmSampleBuffer);
   const AFframecount numSamplesToWrite = sampleBuffer->blocksize;
   AFframecount numFramesWritten = 0;
+  boolByte littleEndian;
+
+  // Smaller blocks fit in the PCM buffer, but larger ones would overflow it
+  if (superSampleBuffer->blocksize < sampleBuffer->blocksize ||
+      superSampleBuffer->numChannels != sampleBuffer->numChannels) {
+    littleEndian = extraData->pcmSampleBuffer->littleEndian;
+    freePcmSampleBuffer(extraData->pcmSampleBuffer);
+    extraData->pcmSampleBuffer = newPcmSampleBuffer(
+        sampleBuffer->numChannels, sampleBuffer->blocksize, getBitDepth());
+    extraData->pcmSampleBuffer->littleEndian = littleEndian;
+  }
 
   extraData->pcmSampleBuffer->setSampleBuffer(extraData->pcmSampleBuffer,
                                               sampleBuffer);
   numFramesWritten = afWriteFrames(extraData->fileHandle, AF_DEFAULT_TRACK,
                                    extraData->pcmSampleBuffer->pcmSamples,
-                                   (int)getBlocksize());
-  self->numSamplesProcessed += getBlocksize() * getNumChannels();
+                                   (int)sampleBuffer->blocksize);
+  self->numSamplesProcessed +=
+      sampleBuffer->blocksize * sampleBuffer->numChannels;
 
   if (numFramesWritten == -1) {
     logWarn("audiofile encountered an error when writing to file");
@@ -218,6 +233,42 @@ boolByte _writeBlockToAudiofile(void *selfPtr,
   }
 }
 
+static boolByte _seekAudiofile(void *selfPtr, const SampleCount frame) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceAudiofileData extraData =
+      (SampleSourceAudiofileData)(self->extraData);
+  AFframecount position;
+
+  if (extraData->fileHandle == NULL) {
+    logError("Audio file '%s' is not open", self->sourceName->data);
+    return false;
+  }
+
+  position = afSeekFrame(extraData->fileHandle, AF_DEFAULT_TRACK,
+                         (AFframecount)frame);
+
+  if (position != (AFframecount)frame) {
+    logError("Could not seek to frame %lu in audio file", frame);
+    return false;
+  }
+
+  return true;
+}
+
+static SampleCount _getAudiofileLength(void *selfPtr) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceAudiofileData extraData =
+      (SampleSourceAudiofileData)self->extraData;
+  AFframecount frameCount;
+
+  if (extraData->fileHandle == NULL) {
+    return 0;
+  }
+
+  frameCount = afGetFrameCount(extraData->fileHandle, AF_DEFAULT_TRACK);
+  return frameCount > 0 ? (SampleCount)frameCount : 0;
+}
+
 void _closeSampleSourceAudiofile(void *selfPtr) {
   SampleSource self = (SampleSource)selfPtr;
   SampleSourceAudiofileData extraData =
@@ -250,10 +301,13 @@ _newSampleSourceAudiofile(const CharString sampleSourceName,
   sampleSource->sourceName = newCharString();
   charStringCopy(sampleSource->sourceName, sampleSourceName);
   sampleSource->numSamplesProcessed = 0;
+  sampleSource->_view = NULL;
 
   sampleSource->openSampleSource = _openSampleSourceAudiofile;
   sampleSource->readSampleBlock = _readBlockFromAudiofile;
   sampleSource->writeSampleBlock = _writeBlockToAudiofile;
+  sampleSource->seekSampleSource = _seekAudiofile;
+  sampleSource->getSampleSourceLength = _getAudiofileLength;
   sampleSource->closeSampleSource = _closeSampleSourceAudiofile;
   sampleSource->freeSampleSourceData = _freeSampleSourceDataAudiofile;
 
@@ -0,0 +1,242 @@
+//
+// SampleSourceBuffered.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "SampleSourceBuffered.h"
+
+#include "audio/AudioSettings.h"
+#include "base/MemoryTracker.h"
+#include "logging/EventLogger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static boolByte _openSampleSourceBuffered(void *selfPtr,
+                                          const SampleSourceOpenAs openAs) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceBufferedData extraData =
+      (SampleSourceBufferedData)self->extraData;
+
+  if (!extraData->source->openSampleSource(extraData->source, openAs)) {
+    return false;
+  }
+
+  self->openedAs = openAs;
+  return true;
+}
+
+// Copy frames between a caller's buffer and the chunk, clearing any channels
+// which are missing from the source buffer
+static void _copyFrames(SampleBuffer destination,
+                        const SampleCount destinationOffset,
+                        const SampleBuffer source,
+                        const SampleCount sourceOffset,
+                        const SampleCount numFrames) {
+  ChannelCount channel;
+
+  for (channel = 0; channel < destination->numChannels; channel++) {
+    if (channel < source->numChannels) {
+      memcpy(destination->samples[channel] + destinationOffset,
+             source->samples[channel] + sourceOffset,
+             sizeof(Sample) * numFrames);
+    } else {
+      memset(destination->samples[channel] + destinationOffset, 0,
+             sizeof(Sample) * numFrames);
+    }
+  }
+}
+
+static boolByte _readBlockFromBuffered(void *selfPtr,
+                                       SampleBuffer sampleBuffer) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceBufferedData extraData =
+      (SampleSourceBufferedData)self->extraData;
+  const SampleCount originalBlocksize = sampleBuffer->blocksize;
+  SampleCount framesRead = 0;
+  SampleCount numFrames;
+
+  while (framesRead < originalBlocksize) {
+    if (extraData->_chunkPosition >= extraData->_chunkFrames) {
+      if (extraData->_isEndOfSource) {
+        break;
+      }
+
+      // Sources shorten the blocksize of the buffer at the end of the input,
+      // so restore it before each read
+      extraData->chunk->blocksize = extraData->ioBlocksize;
+      extraData->_isEndOfSource = (boolByte)!extraData->source->readSampleBlock(
+          extraData->source, extraData->chunk);
+      extraData->_chunkFrames = extraData->chunk->blocksize;
+      extraData->_chunkPosition = 0;
+      continue;
+    }
+
+    numFrames = extraData->_chunkFrames - extraData->_chunkPosition;
+
+    if (numFrames > originalBlocksize - framesRead) {
+      numFrames = originalBlocksize - framesRead;
+    }
+
+    _copyFrames(sampleBuffer, framesRead, extraData->chunk,
+                extraData->_chunkPosition, numFrames);
+    extraData->_chunkPosition += numFrames;
+    framesRead += numFrames;
+  }
+
+  sampleBuffer->blocksize = framesRead;
+  self->numSamplesProcessed += framesRead * sampleBuffer->numChannels;
+  return (boolByte)(framesRead == originalBlocksize);
+}
+
+static boolByte _writeChunk(SampleSourceBufferedData extraData) {
+  boolByte result;
+
+  if (extraData->_chunkPosition == 0) {
+    return true;
+  }
+
+  extraData->chunk->blocksize = extraData->_chunkPosition;
+  result = extraData->source->writeSampleBlock(extraData->source,
+                                               extraData->chunk);
+  extraData->chunk->blocksize = extraData->ioBlocksize;
+  extraData->_chunkPosition = 0;
+  return result;
+}
+
+static boolByte _writeBlockToBuffered(void *selfPtr,
+                                      const SampleBuffer sampleBuffer) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceBufferedData extraData =
+      (SampleSourceBufferedData)self->extraData;
+  SampleCount framesWritten = 0;
+  SampleCount numFrames;
+  boolByte result = true;
+
+  while (framesWritten < sampleBuffer->blocksize) {
+    numFrames = extraData->ioBlocksize - extraData->_chunkPosition;
+
+    if (numFrames > sampleBuffer->blocksize - framesWritten) {
+      numFrames = sampleBuffer->blocksize - framesWritten;
+    }
+
+    _copyFrames(extraData->chunk, extraData->_chunkPosition, sampleBuffer,
+                framesWritten, numFrames);
+    extraData->_chunkPosition += numFrames;
+    framesWritten += numFrames;
+
+    if (extraData->_chunkPosition == extraData->ioBlocksize) {
+      result = (boolByte)(_writeChunk(extraData) && result);
+    }
+  }
+
+  self->numSamplesProcessed +=
+      sampleBuffer->blocksize * sampleBuffer->numChannels;
+  return result;
+}
+
+static boolByte _seekBuffered(void *selfPtr, const SampleCount frame) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceBufferedData extraData =
+      (SampleSourceBufferedData)self->extraData;
+
+  // Anything which was read ahead is no longer valid after seeking
+  extraData->_chunkPosition = 0;
+  extraData->_chunkFrames = 0;
+  extraData->_isEndOfSource = false;
+  return sampleSourceSeek(extraData->source, frame);
+}
+
+static SampleCount _getBufferedLength(void *selfPtr) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceBufferedData extraData =
+      (SampleSourceBufferedData)self->extraData;
+  return sampleSourceGetLength(extraData->source);
+}
+
+static void _closeSampleSourceBuffered(void *selfPtr) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceBufferedData extraData =
+      (SampleSourceBufferedData)self->extraData;
+
+  if (self->openedAs == SAMPLE_SOURCE_OPEN_WRITE &&
+      !_writeChunk(extraData)) {
+    logWarn("Could not write last block to '%s'", self->sourceName->data);
+  }
+
+  extraData->source->closeSampleSource(extraData->source);
+}
+
+SampleSource sampleSourceBufferedGetSource(SampleSource self) {
+  if (self != NULL && self->sampleSourceType == SAMPLE_SOURCE_TYPE_BUFFERED) {
+    return ((SampleSourceBufferedData)self->extraData)->source;
+  }
+
+  return self;
+}
+
+void freeSampleSourceDataBuffered(void *extraDataPtr) {
+  SampleSourceBufferedData extraData = (SampleSourceBufferedData)extraDataPtr;
+
+  if (extraData != NULL) {
+    freeSampleSource(extraData->source);
+    freeSampleBuffer(extraData->chunk);
+    trackedFree(extraData);
+  }
+}
+
+SampleSource newSampleSourceBuffered(SampleSource source,
+                                     const SampleCount ioBlocksize) {
+  SampleSource sampleSource = (SampleSource)malloc(sizeof(SampleSourceMembers));
+  SampleSourceBufferedData extraData = (SampleSourceBufferedData)trackedMalloc(
+      MEMORY_TAG_IO, sizeof(SampleSourceBufferedDataMembers));
+
+  // The extra data is not that of the wrapped source's type, so type-specific
+  // functions must not be called with the buffered source
+  sampleSource->sampleSourceType = SAMPLE_SOURCE_TYPE_BUFFERED;
+  sampleSource->openedAs = source->openedAs;
+  sampleSource->sourceName = newCharString();
+  charStringCopy(sampleSource->sourceName, source->sourceName);
+  sampleSource->numSamplesProcessed = 0;
+  sampleSource->_view = NULL;
+
+  sampleSource->openSampleSource = _openSampleSourceBuffered;
+  sampleSource->readSampleBlock = _readBlockFromBuffered;
+  sampleSource->writeSampleBlock = _writeBlockToBuffered;
+  sampleSource->seekSampleSource =
+      source->seekSampleSource != NULL ? _seekBuffered : NULL;
+  sampleSource->getSampleSourceLength = _getBufferedLength;
+  sampleSource->closeSampleSource = _closeSampleSourceBuffered;
+  sampleSource->freeSampleSourceData = freeSampleSourceDataBuffered;
+
+  extraData->source = source;
+  extraData->ioBlocksize = ioBlocksize;
+  extraData->chunk = newSampleBuffer(getNumChannels(), ioBlocksize);
+  extraData->_chunkPosition = 0;
+  extraData->_chunkFrames = 0;
+  extraData->_isEndOfSource = false;
+  sampleSource->extraData = extraData;
+
+  return sampleSource;
+}
@@ -0,0 +1,78 @@
+//
+// SampleSourceBuffered.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_SampleSourceBuffered_h
+#define MrsWatson_SampleSourceBuffered_h
+
+#include "io/SampleSource.h"
+
+typedef struct {
+  // Wrapped source, which is owned by the buffered source
+  SampleSource source;
+  // Number of frames read from or written to the wrapped source at once
+  SampleCount ioBlocksize;
+  SampleBuffer chunk;
+
+  // Private fields
+  SampleCount _chunkPosition;
+  SampleCount _chunkFrames;
+  boolByte _isEndOfSource;
+} SampleSourceBufferedDataMembers;
+typedef SampleSourceBufferedDataMembers *SampleSourceBufferedData;
+
+/**
+ * Wrap a sample source so that it is read and written in large chunks, while
+ * the caller may still use any (smaller) blocksize. This decouples the I/O
+ * blocksize from the blocksize which plugins are processed with, so that small
+ * plugin blocks do not also mean many small reads and writes.
+ *
+ * The buffered source takes over the wrapped source's name, and frees it when
+ * it is freed itself. Any partial chunk is written when the buffered source is
+ * closed. Its type is SAMPLE_SOURCE_TYPE_BUFFERED, so callers which need to
+ * know the type of the underlying source must use
+ * sampleSourceBufferedGetSource() first.
+ *
+ * @param source Sample source to wrap, which may already be open
+ * @param ioBlocksize Number of frames to read or write at once
+ * @return Buffered sample source
+ */
+SampleSource newSampleSourceBuffered(SampleSource source,
+                                     const SampleCount ioBlocksize);
+
+/**
+ * Get the source which does the actual reading or writing
+ * @param self Any sample source
+ * @return The wrapped source if self is a buffered source, otherwise self
+ */
+SampleSource sampleSourceBufferedGetSource(SampleSource self);
+
+/**
+ * Free a buffered sample source's data, including the wrapped source
+ * @param extraDataPtr Pointer to sample source data
+ */
+void freeSampleSourceDataBuffered(void *extraDataPtr);
+
+#endif
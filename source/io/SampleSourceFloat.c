@@ -0,0 +1,785 @@
+//
+// SampleSourceFloat.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "SampleSourceFloat.h"
+
+#include "audio/AudioSettings.h"
+#include "base/MemoryTracker.h"
+#include "logging/EventLogger.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if UNIX
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#elif WINDOWS
+#include <io.h>
+#include <sys/stat.h>
+#endif
+
+#if WINDOWS
+#define open _open
+#define read _read
+#define write _write
+#define close _close
+#define lseek _lseek
+#define fstat _fstat
+#define stat _stat
+#define STDIN_FILENO 0
+#define STDOUT_FILENO 1
+#else
+#define O_BINARY 0
+#endif
+
+static const char *kSampleSourceFloatExtensions[] = {"f32", "f64", "f32p",
+                                                     "f64p", NULL};
+
+// Find the extension of a source name, and the index of its format in the
+// list above
+static int _getFloatFormatIndex(const char *sourceName) {
+  const char *extension;
+  int i;
+
+  if (sourceName == NULL || (extension = strrchr(sourceName, '.')) == NULL) {
+    return -1;
+  }
+
+  for (i = 0; kSampleSourceFloatExtensions[i] != NULL; i++) {
+    if (!strcmp(extension + 1, kSampleSourceFloatExtensions[i])) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+boolByte sampleSourceFloatIsFloatName(const CharString sampleSourceName) {
+  return (boolByte)(sampleSourceName != NULL &&
+                    _getFloatFormatIndex(sampleSourceName->data) >= 0);
+}
+
+void sampleSourceFloatSetWriteHeader(void *selfPtr, boolByte writeHeader) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceFloatData extraData = (SampleSourceFloatData)self->extraData;
+  extraData->writeHeader = writeHeader;
+}
+
+static size_t _getFrameSize(const SampleSourceFloatData extraData) {
+  return extraData->sampleSize * extraData->numChannels;
+}
+
+static void _reserveBuffer(SampleSourceFloatData extraData,
+                           const size_t numBytes) {
+  // Move unused data to the front before making the buffer any bigger
+  if (extraData->_bufferStart > 0) {
+    memmove(extraData->_buffer, extraData->_buffer + extraData->_bufferStart,
+            extraData->_bufferEnd - extraData->_bufferStart);
+    extraData->_bufferEnd -= extraData->_bufferStart;
+    extraData->_bufferStart = 0;
+  }
+
+  if (extraData->_bufferEnd + numBytes > extraData->_bufferSize) {
+    extraData->_bufferSize = extraData->_bufferEnd + numBytes;
+    extraData->_buffer = (byte *)trackedRealloc(
+        extraData->_buffer, MEMORY_TAG_IO, extraData->_bufferSize);
+  }
+}
+
+// Read until the given number of bytes are buffered, or the stream ends.
+// Pipes may return less than was asked for, so read() is called in a loop.
+static size_t _fillBuffer(SampleSourceFloatData extraData,
+                          const size_t numBytes) {
+  size_t available = extraData->_bufferEnd - extraData->_bufferStart;
+  long bytesRead;
+
+  if (available >= numBytes) {
+    return numBytes;
+  }
+
+  _reserveBuffer(extraData, numBytes - available);
+
+  while (available < numBytes && !extraData->_isEndOfStream) {
+    bytesRead = (long)read(extraData->fileDescriptor,
+                           extraData->_buffer + extraData->_bufferEnd,
+                           (unsigned int)(numBytes - available));
+
+    if (bytesRead < 0 && errno == EINTR) {
+      continue;
+    } else if (bytesRead < 0) {
+      logError("Could not read float samples, %s", stringForLastError(errno));
+      extraData->_isEndOfStream = true;
+    } else if (bytesRead == 0) {
+      extraData->_isEndOfStream = true;
+    } else {
+      extraData->_bufferEnd += (size_t)bytesRead;
+      available += (size_t)bytesRead;
+    }
+  }
+
+  return available;
+}
+
+static boolByte _writeAll(int fileDescriptor, const byte *data,
+                          size_t numBytes) {
+  long bytesWritten;
+
+  while (numBytes > 0) {
+    bytesWritten =
+        (long)write(fileDescriptor, data, (unsigned int)numBytes);
+
+    if (bytesWritten < 0 && errno == EINTR) {
+      continue;
+    } else if (bytesWritten <= 0) {
+      return false;
+    }
+
+    data += bytesWritten;
+    numBytes -= (size_t)bytesWritten;
+  }
+
+  return true;
+}
+
+// Write all buffered output, preceded by the header if it is still pending
+static boolByte _flushBuffer(SampleSourceFloatData extraData) {
+  const byte *header = extraData->_header;
+  size_t headerSize = extraData->_headerBytesPending;
+  const byte *data = extraData->_buffer + extraData->_bufferStart;
+  size_t dataSize = extraData->_bufferEnd - extraData->_bufferStart;
+  boolByte result = true;
+#if UNIX
+  struct iovec iov[2];
+  int iovStart = 0;
+  long bytesWritten;
+
+  iov[0].iov_base = (void *)header;
+  iov[0].iov_len = headerSize;
+  iov[1].iov_base = (void *)data;
+  iov[1].iov_len = dataSize;
+
+  if (headerSize == 0) {
+    iovStart = 1;
+  }
+
+  // The kernel may accept only part of a large batch, so finish the rest
+  // with plain writes
+  do {
+    bytesWritten =
+        (long)writev(extraData->fileDescriptor, iov + iovStart, 2 - iovStart);
+  } while (bytesWritten < 0 && errno == EINTR);
+
+  if (bytesWritten < 0) {
+    result = false;
+  } else if ((size_t)bytesWritten < headerSize) {
+    result = _writeAll(extraData->fileDescriptor,
+                       header + bytesWritten, headerSize - bytesWritten) &&
+             _writeAll(extraData->fileDescriptor, data, dataSize);
+  } else if ((size_t)bytesWritten < headerSize + dataSize) {
+    bytesWritten -= (long)headerSize;
+    result = _writeAll(extraData->fileDescriptor, data + bytesWritten,
+                       dataSize - (size_t)bytesWritten);
+  }
+#else
+  result = _writeAll(extraData->fileDescriptor, header, headerSize) &&
+           _writeAll(extraData->fileDescriptor, data, dataSize);
+#endif
+
+  if (!result) {
+    logError("Could not write float samples, %s", stringForLastError(errno));
+  }
+
+  extraData->_headerBytesPending = 0;
+  extraData->_bufferStart = 0;
+  extraData->_bufferEnd = 0;
+  return result;
+}
+
+static boolByte _readHeader(SampleSource self) {
+  SampleSourceFloatData extraData = (SampleSourceFloatData)self->extraData;
+  const byte *header;
+  unsigned int sampleRate;
+  unsigned short numChannels;
+  unsigned int planarBlockFrames;
+
+  if (_fillBuffer(extraData, SAMPLE_SOURCE_FLOAT_HEADER_SIZE) <
+      SAMPLE_SOURCE_FLOAT_HEADER_SIZE) {
+    // Too short for a header, so whatever is there must be sample data
+    return true;
+  }
+
+  header = extraData->_buffer + extraData->_bufferStart;
+
+  if (memcmp(header, SAMPLE_SOURCE_FLOAT_HEADER_MAGIC, 4)) {
+    return true;
+  }
+
+  memcpy(&sampleRate, header + 8, sizeof(sampleRate));
+  memcpy(&numChannels, header + 12, sizeof(numChannels));
+  memcpy(&planarBlockFrames, header + 16, sizeof(planarBlockFrames));
+
+  if (header[4] != SAMPLE_SOURCE_FLOAT_HEADER_VERSION ||
+      (header[5] != 4 && header[5] != 8) ||
+      header[6] >= NUM_SAMPLE_SOURCE_FLOAT_LAYOUTS || sampleRate == 0 ||
+      numChannels == 0 ||
+      (header[6] == SAMPLE_SOURCE_FLOAT_LAYOUT_PLANAR &&
+       planarBlockFrames == 0)) {
+    logError("Float sample source '%s' has an invalid header",
+             self->sourceName->data);
+    return false;
+  }
+
+  extraData->sampleSize = header[5];
+  extraData->layout = (SampleSourceFloatLayout)header[6];
+  extraData->sampleRate = (SampleRate)sampleRate;
+  extraData->numChannels = numChannels;
+  extraData->planarBlockFrames = planarBlockFrames;
+  extraData->_bufferStart += SAMPLE_SOURCE_FLOAT_HEADER_SIZE;
+  extraData->_dataOffset = SAMPLE_SOURCE_FLOAT_HEADER_SIZE;
+
+  logDebug("Float source has %d channels at %gHz", numChannels,
+           extraData->sampleRate);
+  setSampleRate(extraData->sampleRate);
+  setNumChannels(extraData->numChannels);
+  return true;
+}
+
+static void _encodeHeader(SampleSourceFloatData extraData) {
+  byte *header = extraData->_header;
+  unsigned int sampleRate = (unsigned int)extraData->sampleRate;
+  unsigned short numChannels = (unsigned short)extraData->numChannels;
+  unsigned int planarBlockFrames =
+      extraData->layout == SAMPLE_SOURCE_FLOAT_LAYOUT_PLANAR
+          ? (unsigned int)extraData->planarBlockFrames
+          : 0;
+
+  memset(header, 0, SAMPLE_SOURCE_FLOAT_HEADER_SIZE);
+  memcpy(header, SAMPLE_SOURCE_FLOAT_HEADER_MAGIC, 4);
+  header[4] = SAMPLE_SOURCE_FLOAT_HEADER_VERSION;
+  header[5] = (byte)extraData->sampleSize;
+  header[6] = (byte)extraData->layout;
+  memcpy(header + 8, &sampleRate, sizeof(sampleRate));
+  memcpy(header + 12, &numChannels, sizeof(numChannels));
+  memcpy(header + 16, &planarBlockFrames, sizeof(planarBlockFrames));
+  extraData->_headerBytesPending = SAMPLE_SOURCE_FLOAT_HEADER_SIZE;
+}
+
+static boolByte _openSampleSourceFloat(void *selfPtr,
+                                       const SampleSourceOpenAs openAs) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceFloatData extraData = (SampleSourceFloatData)self->extraData;
+  const char *name = self->sourceName->data;
+  char *end;
+  struct stat fileStat;
+
+  if (openAs != SAMPLE_SOURCE_OPEN_READ && openAs != SAMPLE_SOURCE_OPEN_WRITE) {
+    logInternalError("Invalid type for openAs in float file");
+    return false;
+  }
+
+  if (name[0] == '-' && name[1] == '.') {
+    extraData->fileDescriptor =
+        openAs == SAMPLE_SOURCE_OPEN_READ ? STDIN_FILENO : STDOUT_FILENO;
+    charStringCopyCString(self->sourceName,
+                          openAs == SAMPLE_SOURCE_OPEN_READ ? "stdin"
+                                                            : "stdout");
+  } else if (name[0] == '&') {
+    extraData->fileDescriptor = (int)strtol(name + 1, &end, 10);
+
+    if (end == name + 1 || *end != '.') {
+      logError("Invalid file descriptor in '%s'", name);
+      return false;
+    }
+
+    extraData->_shouldCloseDescriptor = true;
+  } else {
+    extraData->fileDescriptor =
+        openAs == SAMPLE_SOURCE_OPEN_READ
+            ? open(name, O_RDONLY | O_BINARY)
+            : open(name, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
+    extraData->_shouldCloseDescriptor = true;
+  }
+
+  if (extraData->fileDescriptor < 0 ||
+      fstat(extraData->fileDescriptor, &fileStat) != 0) {
+    logError("Float file '%s' could not be opened for %s",
+             self->sourceName->data,
+             openAs == SAMPLE_SOURCE_OPEN_READ ? "reading" : "writing");
+    return false;
+  }
+
+  // Pipes, FIFOs and terminals cannot be seeked
+  extraData->isStream = (boolByte)!S_ISREG(fileStat.st_mode);
+  self->openedAs = openAs;
+  extraData->sampleRate = getSampleRate();
+  extraData->numChannels = getNumChannels();
+  extraData->planarBlockFrames = getBlocksize();
+
+  if (openAs == SAMPLE_SOURCE_OPEN_READ) {
+    if (!_readHeader(self)) {
+      return false;
+    }
+  } else {
+    _reserveBuffer(extraData, SAMPLE_SOURCE_FLOAT_BATCH_SIZE);
+
+    if (extraData->writeHeader) {
+      _encodeHeader(extraData);
+    }
+  }
+
+  if (extraData->layout == SAMPLE_SOURCE_FLOAT_LAYOUT_PLANAR) {
+    extraData->_planarBlock = newSampleBuffer(extraData->numChannels,
+                                              extraData->planarBlockFrames);
+    // When reading, the first block has not been read yet
+    extraData->_planarBlockPosition =
+        openAs == SAMPLE_SOURCE_OPEN_READ ? extraData->planarBlockFrames : 0;
+  }
+
+  return true;
+}
+
+static void _decodeSamples(const byte *data, const size_t sampleSize,
+                           const size_t stride, Samples samples,
+                           const SampleCount numFrames) {
+  SampleCount i;
+  float floatValue;
+  double doubleValue;
+
+  if (sampleSize == sizeof(float) && stride == sizeof(float)) {
+    memcpy(samples, data, sizeof(float) * numFrames);
+  } else if (sampleSize == sizeof(float)) {
+    for (i = 0; i < numFrames; i++) {
+      memcpy(&floatValue, data + i * stride, sizeof(float));
+      samples[i] = floatValue;
+    }
+  } else {
+    for (i = 0; i < numFrames; i++) {
+      memcpy(&doubleValue, data + i * stride, sizeof(double));
+      samples[i] = (Sample)doubleValue;
+    }
+  }
+}
+
+static void _encodeSamples(byte *data, const size_t sampleSize,
+                           const size_t stride, const Samples samples,
+                           const SampleCount numFrames) {
+  SampleCount i;
+  float floatValue;
+  double doubleValue;
+
+  if (sampleSize == sizeof(float) && stride == sizeof(float)) {
+    memcpy(data, samples, sizeof(float) * numFrames);
+  } else if (sampleSize == sizeof(float)) {
+    for (i = 0; i < numFrames; i++) {
+      floatValue = samples[i];
+      memcpy(data + i * stride, &floatValue, sizeof(float));
+    }
+  } else {
+    for (i = 0; i < numFrames; i++) {
+      doubleValue = samples[i];
+      memcpy(data + i * stride, &doubleValue, sizeof(double));
+    }
+  }
+}
+
+// Decode frames from the read buffer, where channels which are not in the
+// stream are left silent
+static void _decodeFrames(SampleSourceFloatData extraData,
+                          SampleBuffer sampleBuffer, const SampleCount offset,
+                          const SampleCount numFrames) {
+  const byte *data = extraData->_buffer + extraData->_bufferStart;
+  const size_t frameSize = _getFrameSize(extraData);
+  const boolByte isPlanar =
+      (boolByte)(extraData->layout == SAMPLE_SOURCE_FLOAT_LAYOUT_PLANAR);
+  ChannelCount channel;
+
+  for (channel = 0; channel < sampleBuffer->numChannels; channel++) {
+    if (channel >= extraData->numChannels) {
+      memset(sampleBuffer->samples[channel] + offset, 0,
+             sizeof(Sample) * numFrames);
+    } else if (isPlanar) {
+      _decodeSamples(data + channel * numFrames * extraData->sampleSize,
+                     extraData->sampleSize, extraData->sampleSize,
+                     sampleBuffer->samples[channel] + offset, numFrames);
+    } else {
+      _decodeSamples(data + channel * extraData->sampleSize,
+                     extraData->sampleSize, frameSize,
+                     sampleBuffer->samples[channel] + offset, numFrames);
+    }
+  }
+
+  extraData->_bufferStart += numFrames * frameSize;
+}
+
+static void _encodeFrames(SampleSourceFloatData extraData,
+                          const SampleBuffer sampleBuffer,
+                          const SampleCount numFrames) {
+  const size_t frameSize = _getFrameSize(extraData);
+  const boolByte isPlanar =
+      (boolByte)(extraData->layout == SAMPLE_SOURCE_FLOAT_LAYOUT_PLANAR);
+  byte *data;
+  ChannelCount channel;
+
+  _reserveBuffer(extraData, numFrames * frameSize);
+  data = extraData->_buffer + extraData->_bufferEnd;
+
+  // Channels which are missing from the buffer are written as silence
+  if (sampleBuffer->numChannels < extraData->numChannels) {
+    memset(data, 0, numFrames * frameSize);
+  }
+
+  for (channel = 0; channel < extraData->numChannels &&
+                    channel < sampleBuffer->numChannels;
+       channel++) {
+    if (isPlanar) {
+      _encodeSamples(data + channel * numFrames * extraData->sampleSize,
+                     extraData->sampleSize, extraData->sampleSize,
+                     sampleBuffer->samples[channel], numFrames);
+    } else {
+      _encodeSamples(data + channel * extraData->sampleSize,
+                     extraData->sampleSize, frameSize,
+                     sampleBuffer->samples[channel], numFrames);
+    }
+  }
+
+  extraData->_bufferEnd += numFrames * frameSize;
+}
+
+// Read the next planar block, which is shorter than planarBlockFrames only at
+// the end of the stream
+static boolByte _readPlanarBlock(SampleSourceFloatData extraData) {
+  const size_t frameSize = _getFrameSize(extraData);
+  const size_t available =
+      _fillBuffer(extraData, extraData->planarBlockFrames * frameSize);
+  const SampleCount numFrames = (SampleCount)(available / frameSize);
+
+  if (numFrames == 0) {
+    return false;
+  }
+
+  _decodeFrames(extraData, extraData->_planarBlock, 0, numFrames);
+  extraData->_planarBlock->blocksize = numFrames;
+  extraData->_planarBlockPosition = 0;
+  return true;
+}
+
+static SampleCount _readPlanarFrames(SampleSourceFloatData extraData,
+                                     SampleBuffer sampleBuffer) {
+  const SampleBuffer planarBlock = extraData->_planarBlock;
+  SampleCount framesRead = 0;
+  SampleCount numFrames;
+  ChannelCount channel;
+
+  while (framesRead < sampleBuffer->blocksize) {
+    if (extraData->_planarBlockPosition >= planarBlock->blocksize &&
+        !_readPlanarBlock(extraData)) {
+      break;
+    }
+
+    numFrames = planarBlock->blocksize - extraData->_planarBlockPosition;
+
+    if (numFrames > sampleBuffer->blocksize - framesRead) {
+      numFrames = sampleBuffer->blocksize - framesRead;
+    }
+
+    for (channel = 0; channel < sampleBuffer->numChannels; channel++) {
+      if (channel < planarBlock->numChannels) {
+        memcpy(sampleBuffer->samples[channel] + framesRead,
+               planarBlock->samples[channel] +
+                   extraData->_planarBlockPosition,
+               sizeof(Sample) * numFrames);
+      } else {
+        memset(sampleBuffer->samples[channel] + framesRead, 0,
+               sizeof(Sample) * numFrames);
+      }
+    }
+
+    extraData->_planarBlockPosition += numFrames;
+    framesRead += numFrames;
+  }
+
+  return framesRead;
+}
+
+static boolByte _readBlockFromFloatFile(void *selfPtr,
+                                        SampleBuffer sampleBuffer) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceFloatData extraData = (SampleSourceFloatData)self->extraData;
+  const SampleCount originalBlocksize = sampleBuffer->blocksize;
+  const size_t frameSize = _getFrameSize(extraData);
+  SampleCount framesRead;
+
+  if (extraData->fileDescriptor < 0) {
+    logCritical("Corrupt float sample source data structure");
+    return false;
+  }
+
+  if (extraData->layout == SAMPLE_SOURCE_FLOAT_LAYOUT_PLANAR) {
+    framesRead = _readPlanarFrames(extraData, sampleBuffer);
+  } else {
+    framesRead = (SampleCount)(
+        _fillBuffer(extraData, sampleBuffer->blocksize * frameSize) /
+        frameSize);
+    _decodeFrames(extraData, sampleBuffer, 0, framesRead);
+  }
+
+  if (framesRead < originalBlocksize) {
+    logDebug("End of float file reached");
+    sampleBuffer->blocksize = framesRead;
+  }
+
+  self->numSamplesProcessed += framesRead * sampleBuffer->numChannels;
+  return (boolByte)(framesRead == originalBlocksize);
+}
+
+static boolByte _writePlanarFrames(SampleSourceFloatData extraData,
+                                   const SampleBuffer sampleBuffer) {
+  const SampleBuffer planarBlock = extraData->_planarBlock;
+  SampleCount framesWritten = 0;
+  SampleCount numFrames;
+  ChannelCount channel;
+
+  while (framesWritten < sampleBuffer->blocksize) {
+    numFrames = planarBlock->blocksize - extraData->_planarBlockPosition;
+
+    if (numFrames > sampleBuffer->blocksize - framesWritten) {
+      numFrames = sampleBuffer->blocksize - framesWritten;
+    }
+
+    for (channel = 0; channel < planarBlock->numChannels; channel++) {
+      if (channel < sampleBuffer->numChannels) {
+        memcpy(planarBlock->samples[channel] + extraData->_planarBlockPosition,
+               sampleBuffer->samples[channel] + framesWritten,
+               sizeof(Sample) * numFrames);
+      } else {
+        memset(planarBlock->samples[channel] + extraData->_planarBlockPosition,
+               0, sizeof(Sample) * numFrames);
+      }
+    }
+
+    extraData->_planarBlockPosition += numFrames;
+    framesWritten += numFrames;
+
+    if (extraData->_planarBlockPosition == planarBlock->blocksize) {
+      _encodeFrames(extraData, planarBlock, planarBlock->blocksize);
+      extraData->_planarBlockPosition = 0;
+
+      if (extraData->_bufferEnd >= SAMPLE_SOURCE_FLOAT_BATCH_SIZE &&
+          !_flushBuffer(extraData)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static boolByte _writeBlockToFloatFile(void *selfPtr,
+                                       const SampleBuffer sampleBuffer) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceFloatData extraData = (SampleSourceFloatData)self->extraData;
+
+  if (extraData->fileDescriptor < 0) {
+    logCritical("Corrupt float sample source data structure");
+    return false;
+  }
+
+  if (extraData->layout == SAMPLE_SOURCE_FLOAT_LAYOUT_PLANAR) {
+    if (!_writePlanarFrames(extraData, sampleBuffer)) {
+      return false;
+    }
+  } else {
+    _encodeFrames(extraData, sampleBuffer, sampleBuffer->blocksize);
+
+    if (extraData->_bufferEnd >= SAMPLE_SOURCE_FLOAT_BATCH_SIZE &&
+        !_flushBuffer(extraData)) {
+      return false;
+    }
+  }
+
+  self->numSamplesProcessed +=
+      sampleBuffer->blocksize * sampleBuffer->numChannels;
+  return true;
+}
+
+static boolByte _seekFloatFile(void *selfPtr, const SampleCount frame) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceFloatData extraData = (SampleSourceFloatData)self->extraData;
+  SampleBuffer discardBuffer;
+  SampleCount framesRemaining = frame;
+  boolByte result = true;
+
+  if (extraData->fileDescriptor < 0) {
+    logCritical("Corrupt float sample source data structure");
+    return false;
+  }
+
+  if (!extraData->isStream &&
+      extraData->layout == SAMPLE_SOURCE_FLOAT_LAYOUT_INTERLEAVED) {
+    if (lseek(extraData->fileDescriptor,
+              extraData->_dataOffset +
+                  (long)(frame * _getFrameSize(extraData)),
+              SEEK_SET) < 0) {
+      logError("Could not seek to frame %lu in float file", frame);
+      return false;
+    }
+
+    extraData->_bufferStart = 0;
+    extraData->_bufferEnd = 0;
+    extraData->_isEndOfStream = false;
+    return true;
+  }
+
+  // Streams and planar blocks can only be read forwards, so just consume the
+  // data before the requested position.
+  discardBuffer = newSampleBuffer(extraData->numChannels, getBlocksize());
+
+  while (framesRemaining > 0 && result) {
+    if (discardBuffer->blocksize > framesRemaining) {
+      discardBuffer->blocksize = framesRemaining;
+    }
+
+    result = _readBlockFromFloatFile(self, discardBuffer);
+    framesRemaining -= discardBuffer->blocksize;
+  }
+
+  self->numSamplesProcessed -=
+      (frame - framesRemaining) * extraData->numChannels;
+  freeSampleBuffer(discardBuffer);
+
+  if (!result) {
+    logError("Float stream ended before reaching frame %lu", frame);
+  }
+
+  return result;
+}
+
+static SampleCount _getFloatFileLength(void *selfPtr) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceFloatData extraData = (SampleSourceFloatData)self->extraData;
+  struct stat fileStat;
+
+  if (extraData->fileDescriptor < 0 || extraData->isStream ||
+      _getFrameSize(extraData) == 0 ||
+      fstat(extraData->fileDescriptor, &fileStat) != 0 ||
+      (long)fileStat.st_size <= extraData->_dataOffset) {
+    return 0;
+  }
+
+  // Planar blocks hold the same number of frames as interleaved data, they
+  // are just ordered differently
+  return (SampleCount)((long)fileStat.st_size - extraData->_dataOffset) /
+         _getFrameSize(extraData);
+}
+
+static void _closeSampleSourceFloat(void *selfPtr) {
+  SampleSource self = (SampleSource)selfPtr;
+  SampleSourceFloatData extraData = (SampleSourceFloatData)self->extraData;
+
+  if (extraData->fileDescriptor < 0) {
+    return;
+  }
+
+  if (self->openedAs == SAMPLE_SOURCE_OPEN_WRITE) {
+    // Write out any partial planar block, followed by everything which has
+    // not yet been written
+    if (extraData->layout == SAMPLE_SOURCE_FLOAT_LAYOUT_PLANAR &&
+        extraData->_planarBlockPosition > 0) {
+      _encodeFrames(extraData, extraData->_planarBlock,
+                    extraData->_planarBlockPosition);
+      extraData->_planarBlockPosition = 0;
+    }
+
+    _flushBuffer(extraData);
+  }
+
+  if (extraData->_shouldCloseDescriptor) {
+    close(extraData->fileDescriptor);
+  }
+
+  extraData->fileDescriptor = -1;
+}
+
+void freeSampleSourceDataFloat(void *extraDataPtr) {
+  SampleSourceFloatData extraData = (SampleSourceFloatData)extraDataPtr;
+
+  if (extraData != NULL) {
+    trackedFree(extraData->_buffer);
+    freeSampleBuffer(extraData->_planarBlock);
+    trackedFree(extraData);
+  }
+}
+
+SampleSource _newSampleSourceFloat(const CharString sampleSourceName) {
+  SampleSource sampleSource = (SampleSource)malloc(sizeof(SampleSourceMembers));
+  SampleSourceFloatData extraData = (SampleSourceFloatData)trackedMalloc(
+      MEMORY_TAG_IO, sizeof(SampleSourceFloatDataMembers));
+  const int formatIndex = _getFloatFormatIndex(sampleSourceName->data);
+
+  sampleSource->sampleSourceType = SAMPLE_SOURCE_TYPE_FLOAT;
+  sampleSource->openedAs = SAMPLE_SOURCE_OPEN_NOT_OPENED;
+  sampleSource->sourceName = newCharString();
+  charStringCopy(sampleSource->sourceName, sampleSourceName);
+  sampleSource->numSamplesProcessed = 0;
+  sampleSource->_view = NULL;
+
+  sampleSource->openSampleSource = _openSampleSourceFloat;
+  sampleSource->readSampleBlock = _readBlockFromFloatFile;
+  sampleSource->writeSampleBlock = _writeBlockToFloatFile;
+  sampleSource->seekSampleSource = _seekFloatFile;
+  sampleSource->getSampleSourceLength = _getFloatFileLength;
+  sampleSource->closeSampleSource = _closeSampleSourceFloat;
+  sampleSource->freeSampleSourceData = freeSampleSourceDataFloat;
+
+  extraData->fileDescriptor = -1;
+  extraData->isStream = false;
+  extraData->writeHeader = false;
+  // Extensions are listed with 32-bit formats first, and planar ones last
+  extraData->sampleSize =
+      (formatIndex % 2 == 0) ? sizeof(float) : sizeof(double);
+  extraData->layout = formatIndex >= 2 ? SAMPLE_SOURCE_FLOAT_LAYOUT_PLANAR
+                                       : SAMPLE_SOURCE_FLOAT_LAYOUT_INTERLEAVED;
+  extraData->numChannels = getNumChannels();
+  extraData->sampleRate = getSampleRate();
+  extraData->planarBlockFrames = getBlocksize();
+
+  extraData->_buffer = NULL;
+  extraData->_bufferSize = 0;
+  extraData->_bufferStart = 0;
+  extraData->_bufferEnd = 0;
+  extraData->_planarBlock = NULL;
+  extraData->_planarBlockPosition = 0;
+  extraData->_headerBytesPending = 0;
+  extraData->_isEndOfStream = false;
+  extraData->_shouldCloseDescriptor = false;
+  extraData->_dataOffset = 0;
+  sampleSource->extraData = extraData;
+
+  return sampleSource;
+}
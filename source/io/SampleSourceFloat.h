@@ -0,0 +1,120 @@
+//
+// SampleSourceFloat.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_SampleSourceFloat_h
+#define MrsWatson_SampleSourceFloat_h
+
+#include "io/SampleSource.h"
+
+#include <stddef.h>
+
+/**
+ * Raw floating-point samples, which are meant for passing audio between
+ * MrsWatson processes (or other programs) without converting to integers and
+ * back. The format is chosen by the extension of the source name:
+ *
+ *   .f32   32-bit floats, interleaved
+ *   .f64   64-bit floats, interleaved
+ *   .f32p  32-bit floats, planar
+ *   .f64p  64-bit floats, planar
+ *
+ * Planar data is written one block at a time, with all frames of the first
+ * channel followed by those of the next channel. Besides regular files and
+ * named pipes, the names "-.f32" (stdin or stdout) and "&3.f32" (the already
+ * open file descriptor 3) may be used, with any of the above extensions.
+ *
+ * Samples are stored in the host's byte order. Output may start with a small
+ * header which gives the sample rate, channel count and layout. It is detected
+ * when reading, in which case the header's settings override the defaults and
+ * the extension.
+ */
+
+#define SAMPLE_SOURCE_FLOAT_HEADER_MAGIC "MWSF"
+#define SAMPLE_SOURCE_FLOAT_HEADER_VERSION 1
+#define SAMPLE_SOURCE_FLOAT_HEADER_SIZE 20
+// Output is collected until at least this many bytes can be written at once
+#define SAMPLE_SOURCE_FLOAT_BATCH_SIZE (64 * 1024)
+
+typedef enum {
+  SAMPLE_SOURCE_FLOAT_LAYOUT_INTERLEAVED,
+  SAMPLE_SOURCE_FLOAT_LAYOUT_PLANAR,
+  NUM_SAMPLE_SOURCE_FLOAT_LAYOUTS
+} SampleSourceFloatLayout;
+
+typedef struct {
+  int fileDescriptor;
+  boolByte isStream;
+  boolByte writeHeader;
+  // Size of one sample, either 4 or 8 bytes
+  size_t sampleSize;
+  SampleSourceFloatLayout layout;
+  ChannelCount numChannels;
+  SampleRate sampleRate;
+  // Number of frames in each planar block
+  SampleCount planarBlockFrames;
+
+  // Private fields
+  // Raw bytes of the stream, either read but not yet decoded, or encoded but
+  // not yet written
+  byte *_buffer;
+  size_t _bufferSize;
+  size_t _bufferStart;
+  size_t _bufferEnd;
+  // Planar blocks are decoded completely, and then handed out frame by frame
+  SampleBuffer _planarBlock;
+  SampleCount _planarBlockPosition;
+  // Header which has not been written yet, it is sent along with the first
+  // batch of samples
+  byte _header[SAMPLE_SOURCE_FLOAT_HEADER_SIZE];
+  size_t _headerBytesPending;
+  boolByte _isEndOfStream;
+  boolByte _shouldCloseDescriptor;
+  long _dataOffset;
+} SampleSourceFloatDataMembers;
+typedef SampleSourceFloatDataMembers *SampleSourceFloatData;
+
+/**
+ * Check if a source name refers to raw float samples.
+ * @param sampleSourceName Source name
+ * @return True if the name has one of the float extensions
+ */
+boolByte sampleSourceFloatIsFloatName(const CharString sampleSourceName);
+
+/**
+ * Write the header at the start of the output. This must be called before the
+ * source is opened for writing.
+ * @param selfPtr Sample source
+ * @param writeHeader True to write a header
+ */
+void sampleSourceFloatSetWriteHeader(void *selfPtr, boolByte writeHeader);
+
+/**
+ * Free a float sample source's data
+ * @param extraDataPtr Pointer to sample source data
+ */
+void freeSampleSourceDataFloat(void *extraDataPtr);
+
+#endif
@@ -69,15 +69,10 @@ static boolByte openSampleSourcePcm(void *selfPtr,
   return true;
 }
 
-SampleCount sampleSourcePcmRead(SampleSourcePcmData extraData,
-                                SampleBuffer sampleBuffer) {
-  if (extraData == NULL || extraData->fileHandle == NULL) {
-    logCritical("Corrupt PCM data structure");
-    return 0;
-  }
-
-  // If the blocksize has changed, then regenerate our PCM sample buffer to
-  // make room for it.
+// If the blocksize has changed, then regenerate our PCM sample buffer to make
+// room for it.
+static void _resizePcmSampleBuffer(SampleSourcePcmData extraData,
+                                   const SampleBuffer sampleBuffer) {
   const SampleBuffer internalSampleBuffer =
       extraData->pcmSampleBuffer->getSampleBuffer(extraData->pcmSampleBuffer);
 
@@ -89,6 +84,16 @@ SampleCount sampleSourcePcmRead(SampleSourcePcmData extraData,
     extraData->dataBufferNumItems =
         sampleBuffer->numChannels * sampleBuffer->blocksize;
   }
+}
+
+SampleCount sampleSourcePcmRead(SampleSourcePcmData extraData,
+                                SampleBuffer sampleBuffer) {
+  if (extraData == NULL || extraData->fileHandle == NULL) {
+    logCritical("Corrupt PCM data structure");
+    return 0;
+  }
+
+  _resizePcmSampleBuffer(extraData, sampleBuffer);
 
   // Read data into our temporary holding buffer, and then set it to the
   // PcmSampleBuffer, which will convert it to floating point for us.
@@ -120,17 +125,115 @@ static boolByte readBlockFromPcmFile(void *selfPtr, SampleBuffer sampleBuffer) {
   return (boolByte)(originalBlocksize == sampleBuffer->blocksize);
 }
 
+boolByte sampleSourcePcmSeek(SampleSourcePcmData extraData,
+                             const SampleCount frame) {
+  byte *discardBuffer;
+  size_t bytesPerFrame;
+  size_t bytesRemaining;
+  size_t bytesToRead;
+
+  if (extraData == NULL || extraData->fileHandle == NULL) {
+    logCritical("Corrupt PCM data structure");
+    return false;
+  }
+
+  bytesPerFrame =
+      extraData->numChannels * extraData->pcmSampleBuffer->bytesPerSample;
+
+  if (!extraData->isStream) {
+    if (fseek(extraData->fileHandle,
+              extraData->dataOffset + (long)(frame * bytesPerFrame),
+              SEEK_SET) != 0) {
+      logError("Could not seek to frame %lu in PCM file", frame);
+      return false;
+    }
+
+    return true;
+  }
+
+  // Streams can only move forwards, so just consume the data before the
+  // requested position.
+  bytesRemaining = frame * bytesPerFrame;
+  discardBuffer = (byte *)malloc(kCharStringLengthLong);
+
+  while (bytesRemaining > 0) {
+    bytesToRead = bytesRemaining < kCharStringLengthLong
+                      ? bytesRemaining
+                      : kCharStringLengthLong;
+
+    if (fread(discardBuffer, 1, bytesToRead, extraData->fileHandle) !=
+        bytesToRead) {
+      logError("PCM stream ended before reaching frame %lu", frame);
+      free(discardBuffer);
+      return false;
+    }
+
+    bytesRemaining -= bytesToRead;
+  }
+
+  free(discardBuffer);
+  return true;
+}
+
+static boolByte _seekPcmFile(void *selfPtr, const SampleCount frame) {
+  SampleSource self = (SampleSource)selfPtr;
+  return sampleSourcePcmSeek((SampleSourcePcmData)self->extraData, frame);
+}
+
+SampleCount sampleSourcePcmGetLength(SampleSourcePcmData extraData) {
+  long currentPosition;
+  long dataSize = extraData->dataSize;
+  size_t bytesPerFrame;
+
+  if (extraData->fileHandle == NULL || extraData->isStream) {
+    return 0;
+  }
+
+  bytesPerFrame = extraData->numChannels * extraData->bitDepth / 8;
+  if (bytesPerFrame == 0) {
+    return 0;
+  }
+
+  if (dataSize <= 0) {
+    currentPosition = ftell(extraData->fileHandle);
+    if (currentPosition < 0 ||
+        fseek(extraData->fileHandle, 0, SEEK_END) != 0) {
+      return 0;
+    }
+
+    dataSize = ftell(extraData->fileHandle) - extraData->dataOffset;
+    fseek(extraData->fileHandle, currentPosition, SEEK_SET);
+  }
+
+  return dataSize > 0 ? (SampleCount)dataSize / bytesPerFrame : 0;
+}
+
+static SampleCount _getPcmFileLength(void *selfPtr) {
+  SampleSource self = (SampleSource)selfPtr;
+  return sampleSourcePcmGetLength((SampleSourcePcmData)self->extraData);
+}
+
 SampleCount sampleSourcePcmWrite(SampleSourcePcmData extraData,
                                  const SampleBuffer sampleBuffer) {
   SampleCount pcmSamplesWritten = 0;
   SampleCount numSamplesToWrite =
       sampleBuffer->numChannels * sampleBuffer->blocksize;
+  SampleBuffer internalSampleBuffer;
 
   if (extraData == NULL || extraData->fileHandle == NULL) {
     logCritical("Corrupt PCM data structure");
     return false;
   }
 
+  // Smaller blocks fit in the PCM buffer, but larger ones would overflow it
+  internalSampleBuffer =
+      extraData->pcmSampleBuffer->getSampleBuffer(extraData->pcmSampleBuffer);
+
+  if (numSamplesToWrite >
+      internalSampleBuffer->numChannels * internalSampleBuffer->blocksize) {
+    _resizePcmSampleBuffer(extraData, sampleBuffer);
+  }
+
   extraData->pcmSampleBuffer->setSampleBuffer(extraData->pcmSampleBuffer,
                                               sampleBuffer);
   pcmSamplesWritten =
@@ -194,16 +297,21 @@ SampleSource _newSampleSourcePcm(const CharString sampleSourceName) {
   sampleSource->sourceName = newCharString();
   charStringCopy(sampleSource->sourceName, sampleSourceName);
   sampleSource->numSamplesProcessed = 0;
+  sampleSource->_view = NULL;
 
   sampleSource->openSampleSource = openSampleSourcePcm;
   sampleSource->readSampleBlock = readBlockFromPcmFile;
   sampleSource->writeSampleBlock = writeBlockToPcmFile;
+  sampleSource->seekSampleSource = _seekPcmFile;
+  sampleSource->getSampleSourceLength = _getPcmFileLength;
   sampleSource->closeSampleSource = _closeSampleSourcePcm;
   sampleSource->freeSampleSourceData = freeSampleSourceDataPcm;
 
   extraData->isStream = false;
   extraData->isLittleEndian = true;
   extraData->fileHandle = NULL;
+  extraData->dataOffset = 0;
+  extraData->dataSize = 0;
   // Assume default values for these items. However, if an incoming SampleBuffer
   // has different values for the channel count or blocksize, then we will
   // reassign
@@ -36,6 +36,10 @@ typedef struct {
   boolByte isStream;
   boolByte isLittleEndian;
   FILE *fileHandle;
+  // Byte offset of the first sample frame in the file, used for seeking
+  long dataOffset;
+  // Size of the sample data in bytes, or 0 if it runs to the end of the file
+  long dataSize;
   size_t dataBufferNumItems;
   PcmSampleBuffer pcmSampleBuffer;
 
@@ -63,6 +67,23 @@ SampleCount sampleSourcePcmRead(SampleSourcePcmData extraData,
 SampleCount sampleSourcePcmWrite(SampleSourcePcmData extraData,
                                  const SampleBuffer sampleBuffer);
 
+/**
+ * Move the read position of a PCM data stream to the given frame. If the data
+ * is coming from a stream, then the preceding frames are read and discarded.
+ * @param extraData
+ * @param frame Sample frame to seek to, relative to the start of the data
+ * @return True if the position could be set
+ */
+boolByte sampleSourcePcmSeek(SampleSourcePcmData extraData,
+                             const SampleCount frame);
+
+/**
+ * Find the number of frames in a PCM file by its size on disk
+ * @param extraData
+ * @return Number of frames, or 0 if the data is coming from a stream
+ */
+SampleCount sampleSourcePcmGetLength(SampleSourcePcmData extraData);
+
 /**
  * Set the sample rate to be used for raw PCM file operations. This is most
  * relevant when writing a WAVE or a AIFF file, as the sample rate must be given
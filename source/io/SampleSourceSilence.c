@@ -62,6 +62,11 @@ static boolByte _writeBlockToSilence(void *sampleSourcePtr,
   return true;
 }
 
+static boolByte _seekSilence(void *sampleSourcePtr, const SampleCount frame) {
+  // Silence sounds the same everywhere
+  return true;
+}
+
 static void _freeInputSourceDataSilence(void *sampleSourceDataPtr) {}
 
 SampleSource _newSampleSourceSilence(void) {
@@ -72,11 +77,14 @@ SampleSource _newSampleSourceSilence(void) {
   sampleSource->sourceName = newCharString();
   charStringCopyCString(sampleSource->sourceName, "(silence)");
   sampleSource->numSamplesProcessed = 0;
+  sampleSource->_view = NULL;
 
   sampleSource->openSampleSource = _openSampleSourceSilence;
   sampleSource->closeSampleSource = _closeSampleSourceSilence;
   sampleSource->readSampleBlock = _readBlockFromSilence;
   sampleSource->writeSampleBlock = _writeBlockToSilence;
+  sampleSource->seekSampleSource = _seekSilence;
+  sampleSource->getSampleSourceLength = NULL;
   sampleSource->freeSampleSourceData = _freeInputSourceDataSilence;
 
   return sampleSource;
@@ -152,6 +152,8 @@ static boolByte _readWaveFileInfo(const char *filename,
     if (riffChunkReadNext(chunk, extraData->fileHandle, false)) {
       if (riffChunkIsIdEqualTo(chunk, "data")) {
         logDebug("WAVE file has %d bytes", chunk->size);
+        extraData->dataOffset = ftell(extraData->fileHandle);
+        extraData->dataSize = (long)chunk->size;
         dataChunkFound = true;
       } else {
         fseek(extraData->fileHandle, (long)chunk->size, SEEK_CUR);
@@ -363,6 +365,18 @@ static boolByte _writeBlockToWaveFile(void *sampleSourcePtr,
   return (boolByte)(samplesWritten == sampleBuffer->blocksize);
 }
 
+static boolByte _seekWaveFile(void *sampleSourcePtr, const SampleCount frame) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourcePcmData extraData = (SampleSourcePcmData)sampleSource->extraData;
+  return sampleSourcePcmSeek(extraData, frame);
+}
+
+static SampleCount _getWaveFileLength(void *sampleSourcePtr) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourcePcmData extraData = (SampleSourcePcmData)sampleSource->extraData;
+  return sampleSourcePcmGetLength(extraData);
+}
+
 void _closeSampleSourceWave(void *sampleSourceDataPtr) {
   SampleSource sampleSource = (SampleSource)sampleSourceDataPtr;
   SampleSourcePcmData extraData = (SampleSourcePcmData)sampleSource->extraData;
@@ -458,16 +472,21 @@ SampleSource _newSampleSourceWave(const CharString sampleSourceName) {
   sampleSource->sourceName = newCharString();
   charStringCopy(sampleSource->sourceName, sampleSourceName);
   sampleSource->numSamplesProcessed = 0;
+  sampleSource->_view = NULL;
 
   sampleSource->openSampleSource = _openSampleSourceWave;
   sampleSource->readSampleBlock = _readBlockFromWaveFile;
   sampleSource->writeSampleBlock = _writeBlockToWaveFile;
+  sampleSource->seekSampleSource = _seekWaveFile;
+  sampleSource->getSampleSourceLength = _getWaveFileLength;
   sampleSource->closeSampleSource = _closeSampleSourceWave;
   sampleSource->freeSampleSourceData = freeSampleSourceDataPcm;
 
   extraData->isStream = false;
   extraData->isLittleEndian = true;
   extraData->fileHandle = NULL;
+  extraData->dataOffset = 0;
+  extraData->dataSize = 0;
   // Assume default values for these items. However, if an incoming SampleBuffer
   // has different values for the channel count or blocksize, then we will
   // reassign
@@ -164,6 +164,15 @@ void errorReporterCreateLauncher(ErrorReporter self, int argc, char *argv[]) {
   fclose(scriptFilePointer);
 }
 
+void errorReporterAddFlightRecorder(ErrorReporter self,
+                                    FlightRecorder flightRecorder) {
+  CharString dumpFileName = newCharStringWithCString("flight-recorder.txt");
+
+  errorReporterRemapPath(self, dumpFileName);
+  flightRecorderSetDumpFile(flightRecorder, dumpFileName);
+  freeCharString(dumpFileName);
+}
+
 void errorReporterRemapPath(ErrorReporter self, CharString path) {
   File pathAsFile = newFileWithPath(path);
   CharString basename = fileGetBasename(pathAsFile);
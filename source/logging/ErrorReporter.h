@@ -28,6 +28,7 @@
 #define MrsWatson_ErrorReporter_h
 
 #include "base/CharString.h"
+#include "logging/FlightRecorder.h"
 #include "plugin/PluginChain.h"
 
 typedef struct {
@@ -62,6 +63,15 @@ void errorReporterInitialize(ErrorReporter self);
  */
 void errorReporterCreateLauncher(ErrorReporter self, int argc, char *argv[]);
 
+/**
+ * Have the flight recorder write its blocks to the report directory, next to
+ * the launcher script, if the program crashes
+ * @param self
+ * @param flightRecorder Flight recorder
+ */
+void errorReporterAddFlightRecorder(ErrorReporter self,
+                                    FlightRecorder flightRecorder);
+
 /**
  * Remap a resource to point to the ErrorReporter's directory. This ensures all
  * resources are contained within the same folder, and can be easily compressed
@@ -28,6 +28,7 @@
 
 #include "app/BuildInfo.h"
 #include "audio/AudioSettings.h"
+#include "logging/FlightRecorder.h"
 #include "logging/LogPrinter.h"
 #include "time/AudioClock.h"
 
@@ -244,28 +245,49 @@ static void _logMessage(const LogLevel logLevel, const char *message,
                         va_list arguments) {
   long elapsedTimeInMs;
   EventLogger eventLogger = _getEventLoggerInstance();
+  FlightRecorder flightRecorder = getFlightRecorder();
+  boolByte isPrinted;
+  boolByte isRecorded;
 #if WINDOWS
   ULONGLONG currentTime;
 #else
   struct timeval currentTime;
 #endif
 
-  if (eventLogger != NULL && logLevel >= eventLogger->logLevel) {
+  if (eventLogger == NULL) {
+    return;
+  }
+
+  // Warnings are recorded even when they are not printed, since the flight
+  // recorder is most useful for renders which run with --quiet
+  isPrinted = (boolByte)(logLevel >= eventLogger->logLevel);
+  isRecorded = (boolByte)(flightRecorder != NULL && logLevel >= LOG_WARN);
+
+  if (isPrinted || isRecorded) {
     CharString formattedMessage =
         newCharStringWithCapacity(kCharStringLengthDefault * 2);
     vsnprintf(formattedMessage->data, formattedMessage->capacity, message,
               arguments);
+
+    if (isRecorded) {
+      flightRecorderAddWarning(flightRecorder, formattedMessage->data);
+    }
+
+    if (isPrinted) {
 #if WINDOWS
-    currentTime = GetTickCount();
-    elapsedTimeInMs = (unsigned long)(currentTime - eventLogger->startTimeInMs);
+      currentTime = GetTickCount();
+      elapsedTimeInMs =
+          (unsigned long)(currentTime - eventLogger->startTimeInMs);
 #else
-    gettimeofday(&currentTime, NULL);
-    elapsedTimeInMs =
-        ((currentTime.tv_sec - (eventLogger->startTimeInSec + 1)) * 1000) +
-        (currentTime.tv_usec / 1000) + (1000 - eventLogger->startTimeInMs);
+      gettimeofday(&currentTime, NULL);
+      elapsedTimeInMs =
+          ((currentTime.tv_sec - (eventLogger->startTimeInSec + 1)) * 1000) +
+          (currentTime.tv_usec / 1000) + (1000 - eventLogger->startTimeInMs);
 #endif
-    _printMessage(logLevel, elapsedTimeInMs, getAudioClock()->currentFrame,
-                  formattedMessage->data, eventLogger);
+      _printMessage(logLevel, elapsedTimeInMs, getAudioClock()->currentFrame,
+                    formattedMessage->data, eventLogger);
+    }
+
     freeCharString(formattedMessage);
   }
 }
@@ -0,0 +1,467 @@
+//
+// FlightRecorder.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "FlightRecorder.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#elif WINDOWS
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#define STDERR_FILENO 2
+#define open _open
+#define write _write
+#define close _close
+#endif
+
+#define FLIGHT_RECORDER_LINE_LENGTH 256
+#define FLIGHT_RECORDER_DUMP_FILE_MODE 0644
+
+static FlightRecorder flightRecorderInstance = NULL;
+
+FlightRecorder newFlightRecorder(void) {
+  FlightRecorder self = (FlightRecorder)malloc(sizeof(FlightRecorderMembers));
+
+  memset(self, 0, sizeof(FlightRecorderMembers));
+  self->currentPlugin = FLIGHT_RECORDER_NO_PLUGIN;
+  self->currentActivity = NULL;
+
+  return self;
+}
+
+void initFlightRecorder(void) { flightRecorderInstance = newFlightRecorder(); }
+
+FlightRecorder getFlightRecorder(void) { return flightRecorderInstance; }
+
+void flightRecorderSetPluginChain(FlightRecorder self,
+                                  PluginChain pluginChain) {
+  unsigned int i;
+
+  if (self == NULL) {
+    return;
+  }
+
+  for (i = 0; i < pluginChain->numPlugins; i++) {
+    strncpy(self->pluginNames[i], pluginChain->plugins[i]->pluginName->data,
+            FLIGHT_RECORDER_NAME_LENGTH - 1);
+    self->pluginNames[i][FLIGHT_RECORDER_NAME_LENGTH - 1] = '\0';
+  }
+
+  self->numPlugins = pluginChain->numPlugins;
+}
+
+void flightRecorderSetDumpFile(FlightRecorder self, const CharString filename) {
+  if (self != NULL) {
+    strncpy(self->_dumpFile, filename->data, FLIGHT_RECORDER_PATH_LENGTH - 1);
+    self->_dumpFile[FLIGHT_RECORDER_PATH_LENGTH - 1] = '\0';
+  }
+}
+
+static FlightRecorderBlock *_getCurrentBlock(const FlightRecorder self) {
+  if (self == NULL || self->numBlocks == 0) {
+    return NULL;
+  }
+
+  return &self->blocks[(self->numBlocks - 1) % FLIGHT_RECORDER_NUM_BLOCKS];
+}
+
+void flightRecorderBeginBlock(FlightRecorder self, const unsigned long frame) {
+  FlightRecorderBlock *block;
+
+  if (self == NULL) {
+    return;
+  }
+
+  block = &self->blocks[self->numBlocks % FLIGHT_RECORDER_NUM_BLOCKS];
+  memset(block, 0, sizeof(FlightRecorderBlock));
+  block->blockNumber = self->numBlocks;
+  block->frame = frame;
+  self->numBlocks++;
+}
+
+void flightRecorderEnterPlugin(FlightRecorder self, const int pluginIndex,
+                               const char *activity) {
+  if (self != NULL) {
+    self->currentActivity = activity;
+    self->currentPlugin = pluginIndex;
+  }
+}
+
+void flightRecorderAddPluginTime(FlightRecorder self,
+                                 const unsigned int pluginIndex,
+                                 const double timeInMs) {
+  FlightRecorderBlock *block = _getCurrentBlock(self);
+
+  if (block != NULL && pluginIndex < MAX_PLUGINS) {
+    block->processingTimeInMs[pluginIndex] += timeInMs;
+  }
+}
+
+void flightRecorderAddMidiEvent(FlightRecorder self,
+                                const MidiEvent midiEvent) {
+  FlightRecorderBlock *block = _getCurrentBlock(self);
+  FlightRecorderMidiEvent *recordedEvent;
+
+  if (block == NULL) {
+    return;
+  }
+
+  if (block->numMidiEvents < FLIGHT_RECORDER_MAX_MIDI_EVENTS) {
+    recordedEvent = &block->midiEvents[block->numMidiEvents];
+    recordedEvent->deltaFrames = (unsigned long)midiEvent->deltaFrames;
+    recordedEvent->status = midiEvent->status;
+    recordedEvent->data1 = midiEvent->data1;
+    recordedEvent->data2 = midiEvent->data2;
+  }
+
+  block->numMidiEvents++;
+}
+
+void flightRecorderAddParameterChange(FlightRecorder self,
+                                      const unsigned int pluginIndex,
+                                      const unsigned int index,
+                                      const float value,
+                                      const boolByte isProgramChange) {
+  FlightRecorderBlock *block = _getCurrentBlock(self);
+  FlightRecorderParameterChange *change;
+
+  if (block == NULL) {
+    return;
+  }
+
+  if (block->numParameterChanges < FLIGHT_RECORDER_MAX_PARAMETER_CHANGES) {
+    change = &block->parameterChanges[block->numParameterChanges];
+    change->pluginIndex = pluginIndex;
+    change->index = index;
+    change->value = value;
+    change->isProgramChange = isProgramChange;
+  }
+
+  block->numParameterChanges++;
+}
+
+void flightRecorderAddWarning(FlightRecorder self, const char *message) {
+  FlightRecorderBlock *block = _getCurrentBlock(self);
+
+  if (block == NULL) {
+    return;
+  }
+
+  if (block->numWarnings < FLIGHT_RECORDER_MAX_WARNINGS) {
+    strncpy(block->warnings[block->numWarnings], message,
+            FLIGHT_RECORDER_WARNING_LENGTH - 1);
+    block->warnings[block->numWarnings][FLIGHT_RECORDER_WARNING_LENGTH - 1] =
+        '\0';
+  }
+
+  block->numWarnings++;
+}
+
+// The functions below may run inside of a signal handler, so they must not
+// call printf(), malloc() or anything else which is not async-signal-safe.
+// Each line is formatted into a buffer on the stack and sent with write().
+
+typedef struct {
+  char data[FLIGHT_RECORDER_LINE_LENGTH];
+  size_t length;
+} _FlightRecorderLineMembers;
+typedef _FlightRecorderLineMembers *_FlightRecorderLine;
+
+static void _appendString(_FlightRecorderLine line, const char *string) {
+  while (*string != '\0' && line->length < FLIGHT_RECORDER_LINE_LENGTH - 1) {
+    line->data[line->length++] = *string++;
+  }
+}
+
+static void _appendUnsigned(_FlightRecorderLine line, unsigned long value) {
+  char digits[24];
+  int numDigits = 0;
+
+  do {
+    digits[numDigits++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+
+  while (numDigits > 0 && line->length < FLIGHT_RECORDER_LINE_LENGTH - 1) {
+    line->data[line->length++] = digits[--numDigits];
+  }
+}
+
+static void _appendHex(_FlightRecorderLine line, const byte value) {
+  static const char *kHexDigits = "0123456789abcdef";
+  char hex[3];
+
+  hex[0] = kHexDigits[value >> 4];
+  hex[1] = kHexDigits[value & 0x0f];
+  hex[2] = '\0';
+  _appendString(line, hex);
+}
+
+// Append a value with three decimal places
+static void _appendDecimal(_FlightRecorderLine line, const double value) {
+  unsigned long thousandths;
+  unsigned long fraction;
+
+  if (value < 0.0) {
+    _appendString(line, "-");
+  }
+
+  thousandths = (unsigned long)((value < 0.0 ? -value : value) * 1000.0 + 0.5);
+  _appendUnsigned(line, thousandths / 1000);
+  _appendString(line, ".");
+  fraction = thousandths % 1000;
+  _appendString(line, fraction < 100 ? (fraction < 10 ? "00" : "0") : "");
+  _appendUnsigned(line, fraction);
+}
+
+static void _writeLine(_FlightRecorderLine line, const int fileDescriptor) {
+  size_t offset = 0;
+  long numWritten;
+
+  line->data[line->length++] = '\n';
+
+  while (offset < line->length) {
+    numWritten = (long)write(fileDescriptor, line->data + offset,
+                             (unsigned int)(line->length - offset));
+
+    if (numWritten <= 0) {
+      break;
+    }
+
+    offset += (size_t)numWritten;
+  }
+
+  line->length = 0;
+}
+
+static void _appendPluginName(_FlightRecorderLine line,
+                              const FlightRecorder self,
+                              const unsigned int pluginIndex) {
+  _appendString(line, "plugin '");
+  _appendString(line, pluginIndex < self->numPlugins
+                          ? self->pluginNames[pluginIndex]
+                          : "(unknown)");
+  _appendString(line, "'");
+}
+
+static const char *_getSignalName(const int signalNumber) {
+  switch (signalNumber) {
+#ifdef SIGSEGV
+  case SIGSEGV:
+    return "SIGSEGV";
+#endif
+#ifdef SIGABRT
+  case SIGABRT:
+    return "SIGABRT";
+#endif
+#ifdef SIGBUS
+  case SIGBUS:
+    return "SIGBUS";
+#endif
+  default:
+    return "signal";
+  }
+}
+
+static void _writeBlock(const FlightRecorder self,
+                        const FlightRecorderBlock *block,
+                        _FlightRecorderLine line, const int fileDescriptor) {
+  const FlightRecorderMidiEvent *midiEvent;
+  const FlightRecorderParameterChange *change;
+  unsigned int i;
+
+  _appendString(line, "Block ");
+  _appendUnsigned(line, block->blockNumber);
+  _appendString(line, " at frame ");
+  _appendUnsigned(line, block->frame);
+  _writeLine(line, fileDescriptor);
+
+  for (i = 0; i < self->numPlugins; i++) {
+    _appendString(line, "  Time in ");
+    _appendPluginName(line, self, i);
+    _appendString(line, ": ");
+    _appendDecimal(line, block->processingTimeInMs[i]);
+    _appendString(line, "ms");
+    _writeLine(line, fileDescriptor);
+  }
+
+  for (i = 0; i < block->numMidiEvents; i++) {
+    if (i == FLIGHT_RECORDER_MAX_MIDI_EVENTS) {
+      _appendString(line, "  ... ");
+      _appendUnsigned(line, block->numMidiEvents - i);
+      _appendString(line, " more MIDI events");
+      _writeLine(line, fileDescriptor);
+      break;
+    }
+
+    midiEvent = &block->midiEvents[i];
+    _appendString(line, "  MIDI +");
+    _appendUnsigned(line, midiEvent->deltaFrames);
+    _appendString(line, ": ");
+    _appendHex(line, midiEvent->status);
+    _appendString(line, " ");
+    _appendHex(line, midiEvent->data1);
+    _appendString(line, " ");
+    _appendHex(line, midiEvent->data2);
+    _writeLine(line, fileDescriptor);
+  }
+
+  for (i = 0; i < block->numParameterChanges; i++) {
+    if (i == FLIGHT_RECORDER_MAX_PARAMETER_CHANGES) {
+      _appendString(line, "  ... ");
+      _appendUnsigned(line, block->numParameterChanges - i);
+      _appendString(line, " more parameter changes");
+      _writeLine(line, fileDescriptor);
+      break;
+    }
+
+    change = &block->parameterChanges[i];
+
+    if (change->isProgramChange) {
+      _appendString(line, "  Program of ");
+      _appendPluginName(line, self, change->pluginIndex);
+      _appendString(line, " set to ");
+      _appendUnsigned(line, change->index);
+    } else {
+      _appendString(line, "  Parameter ");
+      _appendUnsigned(line, change->index);
+      _appendString(line, " of ");
+      _appendPluginName(line, self, change->pluginIndex);
+      _appendString(line, " set to ");
+      _appendDecimal(line, change->value);
+    }
+
+    _writeLine(line, fileDescriptor);
+  }
+
+  for (i = 0; i < block->numWarnings; i++) {
+    if (i == FLIGHT_RECORDER_MAX_WARNINGS) {
+      _appendString(line, "  ... ");
+      _appendUnsigned(line, block->numWarnings - i);
+      _appendString(line, " more warnings");
+      _writeLine(line, fileDescriptor);
+      break;
+    }
+
+    _appendString(line, "  Warning: ");
+    _appendString(line, block->warnings[i]);
+    _writeLine(line, fileDescriptor);
+  }
+}
+
+void flightRecorderWrite(const FlightRecorder self, const int fileDescriptor,
+                         const int signalNumber) {
+  _FlightRecorderLineMembers line;
+  const unsigned long numBlocks = self->numBlocks;
+  const int currentPlugin = self->currentPlugin;
+  const char *currentActivity = self->currentActivity;
+  unsigned long firstBlock;
+  unsigned long i;
+
+  line.length = 0;
+  _appendString(&line, "=== MrsWatson flight recorder ===");
+  _writeLine(&line, fileDescriptor);
+
+  if (signalNumber != 0) {
+    _appendString(&line, "Caught ");
+    _appendString(&line, _getSignalName(signalNumber));
+    _appendString(&line, " (");
+    _appendUnsigned(&line, (unsigned long)signalNumber);
+    _appendString(&line, ")");
+
+    if (currentPlugin != FLIGHT_RECORDER_NO_PLUGIN) {
+      _appendString(&line, " while ");
+      _appendString(&line, currentActivity != NULL ? currentActivity
+                                                   : "running");
+      _appendString(&line, " in ");
+      _appendPluginName(&line, self, (unsigned int)currentPlugin);
+    } else {
+      _appendString(&line, " outside of the plugin chain");
+    }
+
+    _writeLine(&line, fileDescriptor);
+  }
+
+  firstBlock = numBlocks > FLIGHT_RECORDER_NUM_BLOCKS
+                   ? numBlocks - FLIGHT_RECORDER_NUM_BLOCKS
+                   : 0;
+  _appendString(&line, "Last ");
+  _appendUnsigned(&line, numBlocks - firstBlock);
+  _appendString(&line, " of ");
+  _appendUnsigned(&line, numBlocks);
+  _appendString(&line, " blocks, oldest first:");
+  _writeLine(&line, fileDescriptor);
+
+  for (i = firstBlock; i < numBlocks; i++) {
+    _writeBlock(self, &self->blocks[i % FLIGHT_RECORDER_NUM_BLOCKS], &line,
+                fileDescriptor);
+  }
+}
+
+void flightRecorderHandleCrash(const int signalNumber) {
+  FlightRecorder self = flightRecorderInstance;
+  int fileDescriptor = STDERR_FILENO;
+
+  if (self == NULL) {
+    return;
+  }
+
+  if (self->_dumpFile[0] != '\0') {
+#if WINDOWS
+    fileDescriptor = open(self->_dumpFile, _O_WRONLY | _O_CREAT | _O_TRUNC,
+                          _S_IREAD | _S_IWRITE);
+#else
+    fileDescriptor = open(self->_dumpFile, O_WRONLY | O_CREAT | O_TRUNC,
+                          FLIGHT_RECORDER_DUMP_FILE_MODE);
+#endif
+
+    if (fileDescriptor < 0) {
+      fileDescriptor = STDERR_FILENO;
+    }
+  }
+
+  flightRecorderWrite(self, fileDescriptor, signalNumber);
+
+  if (fileDescriptor != STDERR_FILENO) {
+    close(fileDescriptor);
+  }
+}
+
+void freeFlightRecorder(FlightRecorder self) {
+  if (self != NULL) {
+    if (self == flightRecorderInstance) {
+      flightRecorderInstance = NULL;
+    }
+
+    free(self);
+  }
+}
@@ -0,0 +1,217 @@
+//
+// FlightRecorder.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_FlightRecorder_h
+#define MrsWatson_FlightRecorder_h
+
+#include "base/CharString.h"
+#include "base/Types.h"
+#include "midi/MidiEvent.h"
+#include "plugin/PluginChain.h"
+
+// Number of blocks which are kept, which should be a power of two
+#define FLIGHT_RECORDER_NUM_BLOCKS 64
+// Limits per block. Anything beyond these is only counted, not recorded.
+#define FLIGHT_RECORDER_MAX_MIDI_EVENTS 16
+#define FLIGHT_RECORDER_MAX_PARAMETER_CHANGES 8
+#define FLIGHT_RECORDER_MAX_WARNINGS 2
+#define FLIGHT_RECORDER_WARNING_LENGTH 160
+#define FLIGHT_RECORDER_NAME_LENGTH 64
+#define FLIGHT_RECORDER_PATH_LENGTH 1024
+#define FLIGHT_RECORDER_NO_PLUGIN -1
+
+typedef struct {
+  unsigned long deltaFrames;
+  byte status;
+  byte data1;
+  byte data2;
+} FlightRecorderMidiEvent;
+
+typedef struct {
+  unsigned int pluginIndex;
+  unsigned int index;
+  float value;
+  boolByte isProgramChange;
+} FlightRecorderParameterChange;
+
+typedef struct {
+  unsigned long blockNumber;
+  unsigned long frame;
+  double processingTimeInMs[MAX_PLUGINS];
+  unsigned int numMidiEvents;
+  FlightRecorderMidiEvent midiEvents[FLIGHT_RECORDER_MAX_MIDI_EVENTS];
+  unsigned int numParameterChanges;
+  FlightRecorderParameterChange
+      parameterChanges[FLIGHT_RECORDER_MAX_PARAMETER_CHANGES];
+  unsigned int numWarnings;
+  char warnings[FLIGHT_RECORDER_MAX_WARNINGS][FLIGHT_RECORDER_WARNING_LENGTH];
+} FlightRecorderBlock;
+
+/**
+ * Keeps a ring of the last blocks which were rendered, so that the events
+ * leading up to a crash can be included in the error report. For each block,
+ * the frame position, the processing time of each plugin, the MIDI events sent
+ * to the chain, parameter and program changes, and any logged warnings are
+ * recorded. All storage is allocated up front, so that recording is cheap
+ * enough to be left on for every render.
+ *
+ * The recorder is written from the render thread only. When the process
+ * crashes, flightRecorderHandleCrash() writes the ring out using only
+ * async-signal-safe functions.
+ */
+typedef struct {
+  unsigned long numBlocks;
+  unsigned int numPlugins;
+  char pluginNames[MAX_PLUGINS][FLIGHT_RECORDER_NAME_LENGTH];
+  FlightRecorderBlock blocks[FLIGHT_RECORDER_NUM_BLOCKS];
+
+  // Plugin and activity which are currently running, which point to the
+  // culprit when the process crashes
+  volatile int currentPlugin;
+  const char *volatile currentActivity;
+
+  // Private fields
+  char _dumpFile[FLIGHT_RECORDER_PATH_LENGTH];
+} FlightRecorderMembers;
+typedef FlightRecorderMembers *FlightRecorder;
+
+/**
+ * @return New flight recorder, which does not record anything until the first
+ * block is started
+ */
+FlightRecorder newFlightRecorder(void);
+
+/**
+ * Create the global flight recorder instance. Like the event logger, the
+ * recorder is a global singleton since it is fed from many places, and must be
+ * reachable from the crash handler.
+ */
+void initFlightRecorder(void);
+
+/**
+ * @return Global flight recorder instance, or NULL if it has not been created.
+ * All recording functions accept NULL and do nothing in that case.
+ */
+FlightRecorder getFlightRecorder(void);
+
+/**
+ * Copy the plugin names from the chain, so that the crash handler does not
+ * need to touch any of the chain's memory
+ * @param self
+ * @param pluginChain Initialized plugin chain
+ */
+void flightRecorderSetPluginChain(FlightRecorder self, PluginChain pluginChain);
+
+/**
+ * Set the file which the ring is written to when crashing. If no file is set,
+ * the ring is written to stderr instead.
+ * @param self
+ * @param filename Dump file name
+ */
+void flightRecorderSetDumpFile(FlightRecorder self, const CharString filename);
+
+/**
+ * Start recording a new block, which replaces the oldest block in the ring
+ * @param self
+ * @param frame Frame position of the block
+ */
+void flightRecorderBeginBlock(FlightRecorder self, const unsigned long frame);
+
+/**
+ * Set the plugin which is about to be called
+ * @param self
+ * @param pluginIndex Index of the plugin in the chain, or
+ * FLIGHT_RECORDER_NO_PLUGIN once the chain has returned
+ * @param activity Static string which describes the call
+ */
+void flightRecorderEnterPlugin(FlightRecorder self, const int pluginIndex,
+                               const char *activity);
+
+/**
+ * Add processing time of a plugin to the current block. A block which is
+ * split into sub-blocks adds up the time of each sub-block.
+ * @param self
+ * @param pluginIndex Index of the plugin in the chain
+ * @param timeInMs Processing time
+ */
+void flightRecorderAddPluginTime(FlightRecorder self,
+                                 const unsigned int pluginIndex,
+                                 const double timeInMs);
+
+/**
+ * Record a MIDI event which was sent to the chain
+ * @param self
+ * @param midiEvent MIDI event
+ */
+void flightRecorderAddMidiEvent(FlightRecorder self, const MidiEvent midiEvent);
+
+/**
+ * Record a parameter or program change
+ * @param self
+ * @param pluginIndex Index of the plugin in the chain
+ * @param index Parameter index or program number
+ * @param value Parameter value, ignored for program changes
+ * @param isProgramChange True for a program change
+ */
+void flightRecorderAddParameterChange(FlightRecorder self,
+                                      const unsigned int pluginIndex,
+                                      const unsigned int index,
+                                      const float value,
+                                      const boolByte isProgramChange);
+
+/**
+ * Record a warning or error message
+ * @param self
+ * @param message Formatted message, which is truncated if it is too long
+ */
+void flightRecorderAddWarning(FlightRecorder self, const char *message);
+
+/**
+ * Write the recorded blocks as text, oldest first. This only uses
+ * async-signal-safe functions, so it can be called from a signal handler.
+ * @param self
+ * @param fileDescriptor Open file descriptor to write to
+ * @param signalNumber Signal which was caught, or 0 if none
+ */
+void flightRecorderWrite(const FlightRecorder self, const int fileDescriptor,
+                         const int signalNumber);
+
+/**
+ * Write the global flight recorder to its dump file, or to stderr if no file
+ * was set. This is async-signal-safe, and should be called first thing from
+ * the handler of fatal signals such as SIGSEGV, SIGABRT and SIGBUS.
+ * @param signalNumber Signal which was caught
+ */
+void flightRecorderHandleCrash(const int signalNumber);
+
+/**
+ * Free a flight recorder. If this is the global instance, the crash handler
+ * will no longer write anything.
+ * @param self
+ */
+void freeFlightRecorder(FlightRecorder self);
+
+#endif
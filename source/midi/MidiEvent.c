@@ -39,6 +39,7 @@ MidiEvent newMidiEvent(void) {
   midiEvent->data1 = 0;
   midiEvent->data2 = 0;
   midiEvent->extraData = NULL;
+  midiEvent->extraDataSize = 0;
 
   return midiEvent;
 }
@@ -29,6 +29,8 @@
 
 #include "base/Types.h"
 
+#include <stdint.h>
+
 typedef enum {
   MIDI_TYPE_INVALID,
   MIDI_TYPE_REGULAR,
@@ -37,14 +39,21 @@ typedef enum {
   NUM_MIDI_TYPES
 } MidiEventType;
 
+// The fields are ordered largest first, so that the struct has no padding.
+// Frame positions are 64-bit on all platforms, since unsigned long wraps after
+// about a day of audio where it is only 32 bits wide.
 typedef struct {
-  MidiEventType eventType;
-  unsigned long deltaFrames;
-  unsigned long timestamp;
+  uint64_t timestamp;
+  uint64_t deltaFrames;
+  // Payload of meta and sysex events. For events which are owned by a
+  // MidiEventPool, this points into the pool's payload storage.
+  byte *extraData;
+  unsigned int extraDataSize;
+  // One of the MidiEventType values, stored as a byte to keep events small
+  byte eventType;
   byte status;
   byte data1;
   byte data2;
-  byte *extraData;
 } MidiEventMembers;
 typedef MidiEventMembers *MidiEvent;
 
@@ -71,7 +80,8 @@ typedef MidiEventMembers *MidiEvent;
 MidiEvent newMidiEvent(void);
 
 /**
- * Free a MIDI event object and its associated resources
+ * Free a MIDI event object and its associated resources. Events which were
+ * allocated from a MidiEventPool must not be freed with this function.
  * @param self
  */
 void freeMidiEvent(MidiEvent self);
@@ -0,0 +1,201 @@
+//
+// MidiEventPool.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "MidiEventPool.h"
+
+#include "base/MemoryTracker.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Both sizes should be a power of two
+#define MIDI_EVENT_POOL_BLOCK_SIZE 1024
+#define MIDI_EVENT_POOL_PAYLOAD_BLOCK_SIZE 4096
+
+MidiEventPool newMidiEventPool(void) {
+  MidiEventPool pool = (MidiEventPool)trackedMalloc(
+      MEMORY_TAG_MIDI, sizeof(MidiEventPoolMembers));
+
+  pool->numEvents = 0;
+  pool->_eventBlocks = NULL;
+  pool->_numEventBlocks = 0;
+  pool->_eventBlocksCapacity = 0;
+  pool->_releasedEvents = NULL;
+  pool->_payloadBlocks = newLinkedList();
+  pool->_payload = NULL;
+  pool->_payloadBytesLeft = 0;
+  memset(pool->_releasedPayloads, 0, sizeof(pool->_releasedPayloads));
+
+  return pool;
+}
+
+static MidiEvent _midiEventPoolNextSlot(MidiEventPool self) {
+  const size_t offset = self->numEvents % MIDI_EVENT_POOL_BLOCK_SIZE;
+
+  if (offset == 0) {
+    if (self->_numEventBlocks == self->_eventBlocksCapacity) {
+      self->_eventBlocksCapacity =
+          self->_eventBlocksCapacity > 0 ? self->_eventBlocksCapacity * 2 : 8;
+      self->_eventBlocks = (MidiEvent *)trackedRealloc(
+          self->_eventBlocks, MEMORY_TAG_MIDI,
+          sizeof(MidiEvent) * self->_eventBlocksCapacity);
+    }
+
+    self->_eventBlocks[self->_numEventBlocks++] = (MidiEvent)trackedMalloc(
+        MEMORY_TAG_MIDI, sizeof(MidiEventMembers) * MIDI_EVENT_POOL_BLOCK_SIZE);
+  }
+
+  self->numEvents++;
+  return &self->_eventBlocks[self->_numEventBlocks - 1][offset];
+}
+
+MidiEvent midiEventPoolNewEvent(MidiEventPool self) {
+  MidiEvent midiEvent;
+
+  if (self->_releasedEvents != NULL) {
+    // Released events are chained together through their extraData field
+    midiEvent = self->_releasedEvents;
+    self->_releasedEvents = (MidiEvent)midiEvent->extraData;
+  } else {
+    midiEvent = _midiEventPoolNextSlot(self);
+  }
+
+  memset(midiEvent, 0, sizeof(MidiEventMembers));
+  midiEvent->eventType = MIDI_TYPE_INVALID;
+  return midiEvent;
+}
+
+// Find the size class for a payload, which also rounds numBytes up to the
+// size which is actually allocated. Payloads which are too large for any class
+// return MIDI_EVENT_POOL_NUM_PAYLOAD_SIZES and are never reused.
+static size_t _midiEventPoolPayloadSizeClass(size_t *numBytes) {
+  size_t sizeClass = 0;
+  size_t classBytes = MIDI_EVENT_POOL_MIN_PAYLOAD_SIZE;
+
+  while (classBytes < *numBytes) {
+    if (++sizeClass == MIDI_EVENT_POOL_NUM_PAYLOAD_SIZES) {
+      return sizeClass;
+    }
+    classBytes *= 2;
+  }
+
+  *numBytes = classBytes;
+  return sizeClass;
+}
+
+static byte *_midiEventPoolNewPayload(MidiEventPool self, size_t numBytes) {
+  const size_t sizeClass = _midiEventPoolPayloadSizeClass(&numBytes);
+  byte *payload;
+
+  if (sizeClass < MIDI_EVENT_POOL_NUM_PAYLOAD_SIZES &&
+      self->_releasedPayloads[sizeClass] != NULL) {
+    // Released payloads are chained together through their first bytes, which
+    // is why the minimum payload size must fit a pointer
+    payload = self->_releasedPayloads[sizeClass];
+    memcpy(&self->_releasedPayloads[sizeClass], payload, sizeof(byte *));
+    return payload;
+  }
+
+  // Large payloads get a block of their own, so that the rest of the current
+  // block is not wasted
+  if (numBytes > MIDI_EVENT_POOL_PAYLOAD_BLOCK_SIZE / 4) {
+    payload = (byte *)trackedMalloc(MEMORY_TAG_MIDI, numBytes);
+    linkedListAppend(self->_payloadBlocks, payload);
+    return payload;
+  }
+
+  if (numBytes > self->_payloadBytesLeft) {
+    self->_payload = (byte *)trackedMalloc(MEMORY_TAG_MIDI,
+                                           MIDI_EVENT_POOL_PAYLOAD_BLOCK_SIZE);
+    self->_payloadBytesLeft = MIDI_EVENT_POOL_PAYLOAD_BLOCK_SIZE;
+    linkedListAppend(self->_payloadBlocks, self->_payload);
+  }
+
+  payload = self->_payload;
+  self->_payload += numBytes;
+  self->_payloadBytesLeft -= numBytes;
+  return payload;
+}
+
+static void _midiEventPoolReleasePayload(MidiEventPool self, byte *payload,
+                                         size_t numBytes) {
+  const size_t sizeClass = _midiEventPoolPayloadSizeClass(&numBytes);
+
+  if (sizeClass < MIDI_EVENT_POOL_NUM_PAYLOAD_SIZES) {
+    memcpy(payload, &self->_releasedPayloads[sizeClass], sizeof(byte *));
+    self->_releasedPayloads[sizeClass] = payload;
+  }
+}
+
+MidiEvent midiEventPoolCopyEvent(MidiEventPool self,
+                                 const MidiEvent midiEvent) {
+  MidiEvent copy = midiEventPoolNewEvent(self);
+
+  memcpy(copy, midiEvent, sizeof(MidiEventMembers));
+
+  if (midiEvent->extraData != NULL && midiEvent->extraDataSize > 0) {
+    copy->extraData = _midiEventPoolNewPayload(self, midiEvent->extraDataSize);
+    memcpy(copy->extraData, midiEvent->extraData, midiEvent->extraDataSize);
+  } else {
+    copy->extraData = NULL;
+    copy->extraDataSize = 0;
+  }
+
+  return copy;
+}
+
+MidiEvent midiEventPoolGetEvent(const MidiEventPool self,
+                                const unsigned long index) {
+  return &self->_eventBlocks[index / MIDI_EVENT_POOL_BLOCK_SIZE]
+                            [index % MIDI_EVENT_POOL_BLOCK_SIZE];
+}
+
+void midiEventPoolReleaseEvent(MidiEventPool self, MidiEvent midiEvent) {
+  if (self != NULL && midiEvent != NULL) {
+    if (midiEvent->extraData != NULL && midiEvent->extraDataSize > 0) {
+      _midiEventPoolReleasePayload(self, midiEvent->extraData,
+                                   midiEvent->extraDataSize);
+    }
+
+    midiEvent->eventType = MIDI_TYPE_INVALID;
+    midiEvent->extraData = (byte *)self->_releasedEvents;
+    self->_releasedEvents = midiEvent;
+  }
+}
+
+void freeMidiEventPool(MidiEventPool self) {
+  size_t i;
+
+  if (self != NULL) {
+    for (i = 0; i < self->_numEventBlocks; i++) {
+      trackedFree(self->_eventBlocks[i]);
+    }
+
+    trackedFree(self->_eventBlocks);
+    freeLinkedListAndItems(self->_payloadBlocks, trackedFree);
+    trackedFree(self);
+  }
+}
@@ -0,0 +1,117 @@
+//
+// MidiEventPool.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_MidiEventPool_h
+#define MrsWatson_MidiEventPool_h
+
+#include "base/LinkedList.h"
+#include "midi/MidiEvent.h"
+
+#include <stddef.h>
+
+// Payloads are rounded up to a power of two no smaller than the minimum size,
+// and released payloads are kept in one list for each of these sizes
+#define MIDI_EVENT_POOL_MIN_PAYLOAD_SIZE 16
+#define MIDI_EVENT_POOL_NUM_PAYLOAD_SIZES 24
+
+typedef struct {
+  // Number of event slots which have been handed out by the pool, including
+  // ones which were later released
+  unsigned long numEvents;
+
+  // Private fields
+  MidiEvent *_eventBlocks;
+  size_t _numEventBlocks;
+  size_t _eventBlocksCapacity;
+  MidiEvent _releasedEvents;
+  LinkedList _payloadBlocks;
+  byte *_payload;
+  size_t _payloadBytesLeft;
+  byte *_releasedPayloads[MIDI_EVENT_POOL_NUM_PAYLOAD_SIZES];
+} MidiEventPoolMembers;
+
+/**
+ * Allocates MIDI events in large contiguous blocks, along with an arena for
+ * their payload data. This avoids one or two calls to malloc() for each event,
+ * and keeps events which were allocated one after another next to each other
+ * in memory. Events are never moved once they have been allocated, and all
+ * memory is freed along with the pool. Released events and payloads are
+ * reused by later allocations of the same size.
+ */
+typedef MidiEventPoolMembers *MidiEventPool;
+
+/**
+ * Create a new event pool
+ * @return Event pool with no events
+ */
+MidiEventPool newMidiEventPool(void);
+
+/**
+ * Get a new event from the pool. Released events are reused before new slots
+ * are handed out.
+ * @param self
+ * @return Initialized event which is owned by the pool
+ */
+MidiEvent midiEventPoolNewEvent(MidiEventPool self);
+
+/**
+ * Copy an event and its payload into the pool. The original event is not
+ * modified.
+ * @param self
+ * @param midiEvent Event to copy. If it has extra data, extraDataSize must be
+ * set to its size.
+ * @return Copy of the event which is owned by the pool
+ */
+MidiEvent midiEventPoolCopyEvent(MidiEventPool self, const MidiEvent midiEvent);
+
+/**
+ * Get an event by the order in which it was allocated. This is only useful for
+ * pools from which events are never released, such as those used to store an
+ * entire sequence.
+ * @param self
+ * @param index Index of the event, which must be less than numEvents
+ * @return Event at the given position
+ */
+MidiEvent midiEventPoolGetEvent(const MidiEventPool self,
+                                const unsigned long index);
+
+/**
+ * Return an event to the pool, so that it can be reused by the next call to
+ * midiEventPoolNewEvent(). If the event has a payload, it is reused by the
+ * next copied event with a payload of a similar size.
+ * @param self
+ * @param midiEvent Event which was allocated from this pool. If its extraData
+ * is set, it must also have been allocated by midiEventPoolCopyEvent().
+ */
+void midiEventPoolReleaseEvent(MidiEventPool self, MidiEvent midiEvent);
+
+/**
+ * Free a pool along with all of its events
+ * @param self
+ */
+void freeMidiEventPool(MidiEventPool self);
+
+#endif
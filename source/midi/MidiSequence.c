@@ -26,42 +26,61 @@
 
 #include "MidiSequence.h"
 
+#include "base/MemoryTracker.h"
 #include "logging/EventLogger.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
 MidiSequence newMidiSequence(void) {
-  MidiSequence midiSequence = malloc(sizeof(MidiSequenceMembers));
+  MidiSequence midiSequence =
+      trackedMalloc(MEMORY_TAG_MIDI, sizeof(MidiSequenceMembers));
 
-  midiSequence->midiEvents = newLinkedList();
-  midiSequence->_lastEvent = midiSequence->midiEvents;
-  midiSequence->_lastTimestamp = 0;
+  midiSequence->midiEvents = newMidiEventPool();
+  midiSequence->tempoMap = NULL;
   midiSequence->numMidiEventsProcessed = 0;
+  midiSequence->_nextEvent = 0;
 
   return midiSequence;
 }
 
 void appendMidiEventToSequence(MidiSequence self, MidiEvent midiEvent) {
   if (self != NULL && midiEvent != NULL) {
-    linkedListAppend(self->midiEvents, midiEvent);
+    midiEventPoolCopyEvent(self->midiEvents, midiEvent);
+    freeMidiEvent(midiEvent);
   }
 }
 
+void midiSequenceAppendCopy(MidiSequence self, const MidiEvent midiEvent) {
+  if (self != NULL && midiEvent != NULL) {
+    midiEventPoolCopyEvent(self->midiEvents, midiEvent);
+  }
+}
+
+unsigned long midiSequenceGetNumEvents(const MidiSequence self) {
+  return self != NULL ? self->midiEvents->numEvents : 0;
+}
+
+MidiEvent midiSequenceGetEvent(const MidiSequence self,
+                               const unsigned long index) {
+  return midiEventPoolGetEvent(self->midiEvents, index);
+}
+
 boolByte fillMidiEventsFromRange(MidiSequence self,
-                                 const unsigned long startTimestamp,
+                                 const uint64_t startTimestamp,
                                  const unsigned long blocksize,
                                  LinkedList outMidiEvents) {
   MidiEvent midiEvent;
-  LinkedListIterator iterator = self->_lastEvent;
-  const unsigned long stopTimestamp = startTimestamp + blocksize;
+  unsigned long index = self->_nextEvent;
+  const unsigned long numEvents = midiSequenceGetNumEvents(self);
+  const uint64_t stopTimestamp = startTimestamp + blocksize;
 
   while (true) {
-    if ((iterator == NULL) || (iterator->item == NULL)) {
+    if (index >= numEvents) {
       return false;
     }
 
-    midiEvent = iterator->item;
+    midiEvent = midiSequenceGetEvent(self, index);
 
     if (stopTimestamp < midiEvent->timestamp) {
       // We have not yet reached this event, stop iterating
@@ -69,18 +88,18 @@ boolByte fillMidiEventsFromRange(MidiSequence self,
     } else if (startTimestamp <= midiEvent->timestamp &&
                stopTimestamp > midiEvent->timestamp) {
       midiEvent->deltaFrames = midiEvent->timestamp - startTimestamp;
-      logDebug("Scheduling MIDI event 0x%x (%x, %x) in %ld frames",
+      logDebug("Scheduling MIDI event 0x%x (%x, %x) in %lu frames",
                midiEvent->status, midiEvent->data1, midiEvent->data2,
-               midiEvent->deltaFrames);
+               (unsigned long)midiEvent->deltaFrames);
       linkedListAppend(outMidiEvents, midiEvent);
-      self->_lastEvent = iterator->nextItem;
+      self->_nextEvent = index + 1;
       self->numMidiEventsProcessed++;
     } else if (startTimestamp > midiEvent->timestamp) {
       logInternalError("Inconsistent MIDI sequence ordering");
     }
 
     // Last item in the list
-    if (iterator->nextItem == NULL) {
+    if (index + 1 == numEvents) {
       if (startTimestamp <= midiEvent->timestamp &&
           stopTimestamp > midiEvent->timestamp) {
         return false;
@@ -89,16 +108,48 @@ boolByte fillMidiEventsFromRange(MidiSequence self,
       break;
     }
 
-    iterator = iterator->nextItem;
+    index++;
   }
 
   return true;
 }
 
+boolByte midiSequenceSeek(MidiSequence self, const uint64_t timestamp,
+                          LinkedList outMetaEvents) {
+  MidiEvent midiEvent;
+  unsigned long index = self->_nextEvent;
+  const unsigned long numEvents = midiSequenceGetNumEvents(self);
+
+  while (index < numEvents) {
+    midiEvent = midiSequenceGetEvent(self, index);
+
+    if (midiEvent->timestamp >= timestamp) {
+      break;
+    }
+
+    if (midiEvent->eventType == MIDI_TYPE_META) {
+      linkedListAppend(outMetaEvents, midiEvent);
+    }
+
+    index++;
+  }
+
+  self->_nextEvent = index;
+  logDebug("Skipped MIDI sequence ahead to frame %.0f", (double)timestamp);
+  return (boolByte)(index < numEvents);
+}
+
+void midiSequenceRewind(MidiSequence self) {
+  if (self != NULL) {
+    self->_nextEvent = 0;
+    self->numMidiEventsProcessed = 0;
+  }
+}
+
 void freeMidiSequence(MidiSequence self) {
   if (self != NULL) {
-    freeLinkedListAndItems(self->midiEvents,
-                           (LinkedListFreeItemFunc)freeMidiEvent);
-    free(self);
+    freeMidiEventPool(self->midiEvents);
+    freeTempoMap(self->tempoMap);
+    trackedFree(self);
   }
 }
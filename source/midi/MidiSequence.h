@@ -29,12 +29,19 @@
 
 #include "base/LinkedList.h"
 #include "midi/MidiEvent.h"
+#include "midi/MidiEventPool.h"
+#include "time/TempoMap.h"
 
 typedef struct {
-  LinkedList midiEvents;
-  LinkedListIterator _lastEvent;
-  int _lastTimestamp;
+  // Events of the sequence in order, stored contiguously by the pool
+  MidiEventPool midiEvents;
+  // Tempo changes used to place the events, owned by the sequence. May be NULL
+  // if the source does not have any musical timing.
+  TempoMap tempoMap;
   int numMidiEventsProcessed;
+
+  // Private fields
+  unsigned long _nextEvent;
 } MidiSequenceMembers;
 
 /**
@@ -56,11 +63,39 @@ MidiSequence newMidiSequence(void);
  * properly set before making this call. Events added into the sequence in this
  * call are not sorted, it is the responsibility of the caller to add the events
  * sequentially in the order which they should be played back.
+ *
+ * The sequence takes ownership of the event, which is copied into the
+ * sequence's own storage and then freed, so it must not be used after this
+ * call. If the event has extra data, its extraDataSize must be set.
  * @param self
  * @param midiEvent MidiEvent to add
  */
 void appendMidiEventToSequence(MidiSequence self, MidiEvent midiEvent);
 
+/**
+ * Add a copy of an event to the end of the sequence, without taking ownership
+ * of the original event. Otherwise the same as appendMidiEventToSequence().
+ * @param self
+ * @param midiEvent MidiEvent to copy
+ */
+void midiSequenceAppendCopy(MidiSequence self, const MidiEvent midiEvent);
+
+/**
+ * @param self
+ * @return Number of events in the sequence
+ */
+unsigned long midiSequenceGetNumEvents(const MidiSequence self);
+
+/**
+ * Get an event from the sequence. The sequence keeps ownership of the event.
+ * @param self
+ * @param index Position of the event, which must be less than the number of
+ * events in the sequence
+ * @return Event at the given position
+ */
+MidiEvent midiSequenceGetEvent(const MidiSequence self,
+                               const unsigned long index);
+
 /**
  * Populate a linked list with MIDI events for a given block. This method does
  * not return a linked list in order to optimize for memory usage.
@@ -74,10 +109,31 @@ void appendMidiEventToSequence(MidiSequence self, MidiEvent midiEvent);
  * sequence has been reached.
  */
 boolByte fillMidiEventsFromRange(MidiSequence self,
-                                 const unsigned long startTimestamp,
+                                 const uint64_t startTimestamp,
                                  const unsigned long blocksize,
                                  LinkedList outMidiEvents);
 
+/**
+ * Skip over all events in the sequence which occur before a given timestamp,
+ * so that the next call to fillMidiEventsFromRange() will start from there.
+ * Skipped events are not sent to any plugin, but meta events (like tempo or
+ * time signature changes) are delivered to the caller so that global state can
+ * still be updated.
+ * @param self
+ * @param timestamp Sample frame to seek to
+ * @param outMetaEvents List to append skipped meta events to
+ * @return True if more events remain in the sequence after the seek position
+ */
+boolByte midiSequenceSeek(MidiSequence self, const uint64_t timestamp,
+                          LinkedList outMetaEvents);
+
+/**
+ * Move the sequence back to its first event, so that it can be played again
+ * from the start. The events themselves are not changed.
+ * @param self
+ */
+void midiSequenceRewind(MidiSequence self);
+
 /**
  * Free a MIDI sequence and its associated resources
  * @param self
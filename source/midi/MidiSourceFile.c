@@ -28,12 +28,56 @@
 
 #include "audio/AudioSettings.h"
 #include "base/Endian.h"
+#include "base/MemoryTracker.h"
+#include "base/PlatformInfo.h"
 #include "logging/EventLogger.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if UNIX
+#include <pthread.h>
+#elif WINDOWS
+#include <windows.h>
+#endif
+
+// Chunks start with a four byte ID followed by a four byte length
+#define MIDI_FILE_CHUNK_HEADER_SIZE 8
+#define MIDI_FILE_HEADER_CHUNK_SIZE 6
+// Decoding fewer tracks than this is not worth the cost of starting threads
+#define MIDI_FILE_MIN_TRACKS_PER_THREAD 2
+
+typedef struct {
+  int trackNumber;
+  const byte *data;
+  size_t numBytes;
+
+  // Decoded events with their timestamps in ticks, since the tempo changes
+  // which determine their position in sample frames may be in another track.
+  // The extra data of meta events points into the file contents, and is copied
+  // when the events are added to the sequence.
+  MidiEventMembers *events;
+  size_t numEvents;
+  size_t capacity;
+  // Index of the next event to be merged into the sequence
+  size_t nextEvent;
+
+  // Tracks may be decoded on other threads, so problems are recorded here and
+  // logged afterwards by the caller
+  const char *errorMessage;
+  unsigned long numSysexEvents;
+} MidiFileTrackMembers;
+typedef MidiFileTrackMembers *MidiFileTrack;
+
+typedef struct {
+  MidiFileTrack tracks;
+  int numTracks;
+  int firstTrack;
+  int trackStep;
+} MidiFileTrackDecoderMembers;
+typedef MidiFileTrackDecoderMembers *MidiFileTrackDecoder;
+
 static boolByte _openMidiSourceFile(void *midiSourcePtr) {
   MidiSource midiSource = midiSourcePtr;
   MidiSourceFileData extraData = midiSource->extraData;
@@ -49,264 +93,497 @@ static boolByte _openMidiSourceFile(void *midiSourcePtr) {
   return true;
 }
 
-static boolByte _readMidiFileChunkHeader(FILE *midiFile,
-                                         const char *expectedChunkId) {
-  byte chunkId[5];
-  size_t itemsRead;
+static byte *_readMidiFileContents(FILE *midiFile, size_t *outNumBytes) {
+  byte *contents;
+  long fileSize;
 
-  memset(chunkId, 0, 5);
-  itemsRead = fread(chunkId, sizeof(byte), 4, midiFile);
+  if (fseek(midiFile, 0, SEEK_END) != 0 ||
+      (fileSize = ftell(midiFile)) < 0 || fseek(midiFile, 0, SEEK_SET) != 0) {
+    logError("Could not determine size of MIDI file");
+    return NULL;
+  }
 
-  if (itemsRead < 4) {
-    logError("Short read of MIDI file (at chunk ID)");
-    return false;
-  } else if (strncmp((char *)chunkId, expectedChunkId, 4)) {
-    logError("MIDI file does not have valid chunk ID");
-    return false;
-  } else {
-    return true;
+  contents = (byte *)trackedMalloc(MEMORY_TAG_MIDI, (size_t)fileSize + 1);
+  *outNumBytes = fread(contents, 1, (size_t)fileSize, midiFile);
+
+  if (*outNumBytes != (size_t)fileSize) {
+    logError("Short read of MIDI file (read %lu of %ld bytes)",
+             (unsigned long)*outNumBytes, fileSize);
+    trackedFree(contents);
+    return NULL;
   }
+
+  return contents;
+}
+
+static unsigned int _readBigEndianInt(const byte *data) {
+  unsigned int value;
+  memcpy(&value, data, sizeof(unsigned int));
+  return convertBigEndianIntToPlatform(value);
+}
+
+static unsigned short _readBigEndianShort(const byte *data) {
+  unsigned short value;
+  memcpy(&value, data, sizeof(unsigned short));
+  return convertBigEndianShortToPlatform(value);
 }
 
-static boolByte _readMidiFileHeader(FILE *midiFile, unsigned short *formatType,
+static boolByte _readMidiFileHeader(const byte *contents, const size_t numBytes,
+                                    unsigned short *formatType,
                                     unsigned short *numTracks,
                                     unsigned short *timeDivision) {
-  unsigned int numBytesBuffer;
-  size_t itemsRead;
-  unsigned int numBytes;
-  unsigned short wordBuffer;
+  unsigned int chunkSize;
 
-  if (!_readMidiFileChunkHeader(midiFile, "MThd")) {
+  if (numBytes < MIDI_FILE_CHUNK_HEADER_SIZE + MIDI_FILE_HEADER_CHUNK_SIZE) {
+    logError("Short read of MIDI file (at header)");
     return false;
-  }
-
-  itemsRead = fread(&numBytesBuffer, sizeof(unsigned int), 1, midiFile);
-
-  if (itemsRead < 1) {
-    logError("Short read of MIDI file (at header, num items)");
+  } else if (strncmp((const char *)contents, "MThd", 4)) {
+    logError("MIDI file does not have valid chunk ID");
     return false;
   }
 
-  numBytes = convertBigEndianIntToPlatform(numBytesBuffer);
+  chunkSize = _readBigEndianInt(contents + 4);
 
-  if (numBytes != 6) {
-    logError("MIDI file has %d bytes in header chunk, expected 6", numBytes);
+  if (chunkSize != MIDI_FILE_HEADER_CHUNK_SIZE) {
+    logError("MIDI file has %d bytes in header chunk, expected 6", chunkSize);
     return false;
   }
 
-  itemsRead = fread(&wordBuffer, sizeof(unsigned short), 1, midiFile);
-
-  if (itemsRead != 1) {
-    logError("Short read of MIDI file (at header, format type)");
-    return false;
-  }
+  *formatType = _readBigEndianShort(contents + 8);
+  *numTracks = _readBigEndianShort(contents + 10);
+  *timeDivision = _readBigEndianShort(contents + 12);
+  logDebug("Time division is %d", *timeDivision);
 
-  *formatType = convertBigEndianShortToPlatform(wordBuffer);
+  return true;
+}
 
-  itemsRead = fread(&wordBuffer, sizeof(unsigned short), 1, midiFile);
+// Find the MTrk chunks in the file, skipping over any other chunk types, which
+// the standard says should be ignored.
+static boolByte _indexMidiFileTracks(const byte *contents,
+                                     const size_t numBytes,
+                                     MidiFileTrack tracks,
+                                     const int numTracks) {
+  size_t position = MIDI_FILE_CHUNK_HEADER_SIZE + MIDI_FILE_HEADER_CHUNK_SIZE;
+  size_t chunkSize;
+  int track = 0;
+
+  while (track < numTracks) {
+    if (numBytes - position < MIDI_FILE_CHUNK_HEADER_SIZE) {
+      logError("Short read of MIDI file (at track %d header)", track);
+      return false;
+    }
 
-  if (itemsRead != 1) {
-    logError("Short read of MIDI file (at header, num tracks)");
-    return false;
-  }
+    chunkSize = (size_t)_readBigEndianInt(contents + position + 4);
 
-  *numTracks = convertBigEndianShortToPlatform(wordBuffer);
+    if (chunkSize > numBytes - position - MIDI_FILE_CHUNK_HEADER_SIZE) {
+      logError("Short read of MIDI file (at track %d)", track);
+      return false;
+    }
 
-  itemsRead = fread(&wordBuffer, sizeof(unsigned short), 1, midiFile);
+    if (!strncmp((const char *)(contents + position), "MTrk", 4)) {
+      tracks[track].trackNumber = track;
+      tracks[track].data = contents + position + MIDI_FILE_CHUNK_HEADER_SIZE;
+      tracks[track].numBytes = chunkSize;
+      track++;
+    } else {
+      logDebug("Skipping unknown MIDI file chunk");
+    }
 
-  if (itemsRead != 1) {
-    logError("Short read of MIDI file (at header, time division)");
-    return false;
+    position += MIDI_FILE_CHUNK_HEADER_SIZE + chunkSize;
   }
 
-  *timeDivision = convertBigEndianShortToPlatform(wordBuffer);
-  logDebug("Time division is %d", *timeDivision);
-
   return true;
 }
 
-static boolByte _readMidiFileTrack(FILE *midiFile, const int trackNumber,
-                                   const int timeDivision,
-                                   const MidiFileTimeDivisionType divisionType,
-                                   MidiSequence midiSequence) {
-  unsigned int numBytesBuffer;
-  byte *trackData, *currentByte, *endByte;
-  size_t itemsRead, numBytes;
-  unsigned long currentTimeInSampleFrames = 0;
-  unsigned long unpackedVariableLength;
-  MidiEvent midiEvent = NULL;
-  unsigned int i;
-
-  if (!_readMidiFileChunkHeader(midiFile, "MTrk")) {
-    return false;
+static boolByte _readVariableLength(const byte **currentByte,
+                                    const byte *endByte,
+                                    unsigned long *outValue) {
+  unsigned long value = 0;
+  int i;
+
+  // Variable length quantities are at most four bytes long
+  for (i = 0; i < 4 && *currentByte < endByte; i++) {
+    value = (value << 7) | (**currentByte & 0x7f);
+
+    if (!(*((*currentByte)++) & 0x80)) {
+      *outValue = value;
+      return true;
+    }
   }
 
-  itemsRead = fread(&numBytesBuffer, sizeof(unsigned int), 1, midiFile);
+  return false;
+}
 
-  if (itemsRead < 1) {
-    logError("Short read of MIDI file (at track %d header, num items)",
-             trackNumber);
-    return false;
+static MidiEvent _newMidiFileTrackEvent(MidiFileTrack track,
+                                        const byte eventType,
+                                        const byte status,
+                                        const uint64_t timestamp) {
+  MidiEvent midiEvent;
+
+  if (track->numEvents == track->capacity) {
+    track->capacity = track->capacity > 0 ? track->capacity * 2 : 64;
+    track->events = (MidiEventMembers *)trackedRealloc(
+        track->events, MEMORY_TAG_MIDI,
+        sizeof(MidiEventMembers) * track->capacity);
   }
 
-  // Read in the entire track in one pass and parse the events from the buffer
-  // data. Much easier
-  // than having to call fread() for each event.
-  numBytes = (size_t)convertBigEndianIntToPlatform(numBytesBuffer);
-  trackData = (byte *)malloc(numBytes);
-  itemsRead = fread(trackData, 1, numBytes, midiFile);
+  midiEvent = &track->events[track->numEvents++];
+  memset(midiEvent, 0, sizeof(MidiEventMembers));
+  midiEvent->eventType = eventType;
+  midiEvent->status = status;
+  midiEvent->timestamp = timestamp;
+  return midiEvent;
+}
+
+// Meta events which are sent on to the host, all other types are ignored
+static boolByte _isMidiFileMetaEventUsed(const byte status) {
+  switch (status) {
+  case MIDI_META_TYPE_TEMPO:
+  case MIDI_META_TYPE_TIME_SIGNATURE:
+  case MIDI_META_TYPE_TRACK_END:
+    return true;
 
-  if (itemsRead != numBytes) {
-    logError("Short read of MIDI file (at track %d)", trackNumber);
-    free(trackData);
+  default:
     return false;
   }
+}
 
-  currentByte = trackData;
-  endByte = trackData + numBytes;
+// Decode all events of a track into its event array. This function does not
+// touch any shared state, so that tracks may be decoded concurrently.
+static boolByte _decodeMidiFileTrack(MidiFileTrack track) {
+  const byte *currentByte = track->data;
+  const byte *endByte = track->data + track->numBytes;
+  uint64_t currentTimeInTicks = 0;
+  unsigned long deltaTime, numBytes;
+  byte status, runningStatus = 0;
+  MidiEvent midiEvent;
 
   while (currentByte < endByte) {
-    // Unpack variable length timestamp
-    unpackedVariableLength = *currentByte;
+    if (!_readVariableLength(&currentByte, endByte, &deltaTime) ||
+        currentByte >= endByte) {
+      track->errorMessage = "Invalid event timestamp";
+      return false;
+    }
 
-    if (unpackedVariableLength & 0x80) {
-      unpackedVariableLength &= 0x7f;
+    currentTimeInTicks += deltaTime;
+    status = *currentByte;
 
-      do {
-        unpackedVariableLength =
-            (unpackedVariableLength << 7) + (*(++currentByte) & 0x7f);
-      } while (*currentByte & 0x80);
-    }
+    if (status == 0xff) {
+      // Meta events cancel running status
+      runningStatus = 0;
+      currentByte++;
 
-    currentByte++;
-    freeMidiEvent(midiEvent);
-    midiEvent = newMidiEvent();
+      if (currentByte >= endByte) {
+        track->errorMessage = "Truncated meta event";
+        return false;
+      }
+
+      status = *(currentByte++);
+
+      if (!_readVariableLength(&currentByte, endByte, &numBytes) ||
+          numBytes > (unsigned long)(endByte - currentByte)) {
+        track->errorMessage = "Invalid meta event length";
+        return false;
+      } else if (status == MIDI_META_TYPE_TEMPO && numBytes != 3) {
+        track->errorMessage = "Invalid tempo event";
+        return false;
+      }
 
-    switch (*currentByte) {
-    case 0xff:
-      midiEvent->eventType = MIDI_TYPE_META;
+      if (_isMidiFileMetaEventUsed(status)) {
+        midiEvent = _newMidiFileTrackEvent(track, MIDI_TYPE_META, status,
+                                           currentTimeInTicks);
+        midiEvent->extraData = (byte *)currentByte;
+        midiEvent->extraDataSize = (unsigned int)numBytes;
+      }
+
+      currentByte += numBytes;
+    } else if (status == 0xf0 || status == 0xf7) {
+      // Sysex events are skipped, but must still be parsed to find the
+      // following event
+      runningStatus = 0;
       currentByte++;
-      midiEvent->status = *(currentByte++);
-      numBytes = *(currentByte++);
-      midiEvent->extraData = (byte *)malloc(numBytes);
 
-      for (i = 0; i < numBytes; i++) {
-        midiEvent->extraData[i] = *(currentByte++);
+      if (!_readVariableLength(&currentByte, endByte, &numBytes) ||
+          numBytes > (unsigned long)(endByte - currentByte)) {
+        track->errorMessage = "Invalid sysex event length";
+        return false;
       }
 
-      break;
+      track->numSysexEvents++;
+      currentByte += numBytes;
+    } else {
+      // Events may leave out the status byte if it is the same as the previous
+      // event's, which is called running status
+      if (status & 0x80) {
+        runningStatus = status;
+        currentByte++;
+      } else if (runningStatus == 0) {
+        track->errorMessage = "Data byte without status byte";
+        return false;
+      }
 
-    case 0x7f:
-      logUnsupportedFeature("MIDI files containing sysex events");
-      free(trackData);
-      freeMidiEvent(midiEvent);
-      return false;
+      if (currentByte >= endByte) {
+        track->errorMessage = "Truncated event";
+        return false;
+      }
 
-    default:
-      midiEvent->eventType = MIDI_TYPE_REGULAR;
-      midiEvent->status = *currentByte++;
-      midiEvent->data1 = *currentByte++;
+      midiEvent = _newMidiFileTrackEvent(track, MIDI_TYPE_REGULAR,
+                                         runningStatus, currentTimeInTicks);
+      midiEvent->data1 = *(currentByte++);
 
       // All regular MIDI events have 3 bytes except for program change and
       // channel aftertouch
-      if (!((midiEvent->status & 0xf0) == 0xc0 ||
-            (midiEvent->status & 0xf0) == 0xd0)) {
-        midiEvent->data2 = *currentByte++;
+      if (!((runningStatus & 0xf0) == 0xc0 || (runningStatus & 0xf0) == 0xd0)) {
+        if (currentByte >= endByte) {
+          track->errorMessage = "Truncated event";
+          return false;
+        }
+
+        midiEvent->data2 = *(currentByte++);
       }
+    }
+  }
+
+  return true;
+}
+
+static void _decodeMidiFileTracks(MidiFileTrackDecoder decoder) {
+  int i;
+
+  for (i = decoder->firstTrack; i < decoder->numTracks;
+       i += decoder->trackStep) {
+    _decodeMidiFileTrack(&decoder->tracks[i]);
+  }
+}
+
+#if UNIX
+static void *_decodeMidiFileTracksThread(void *decoderPtr) {
+  _decodeMidiFileTracks((MidiFileTrackDecoder)decoderPtr);
+  return NULL;
+}
+#elif WINDOWS
+static DWORD WINAPI _decodeMidiFileTracksThread(LPVOID decoderPtr) {
+  _decodeMidiFileTracks((MidiFileTrackDecoder)decoderPtr);
+  return 0;
+}
+#endif
+
+// Decode all tracks, spreading them over one thread per processor. Each thread
+// takes every n-th track, and the calling thread does its share as well.
+static void _decodeAllMidiFileTracks(MidiFileTrack tracks,
+                                     const int numTracks) {
+  int numThreads = (int)platformInfoGetNumProcessors();
+  MidiFileTrackDecoder decoders;
+  boolByte *threadStarted;
+#if UNIX
+  pthread_t *threads;
+#elif WINDOWS
+  HANDLE *threads;
+#endif
+  int i;
+
+  if (numThreads > numTracks / MIDI_FILE_MIN_TRACKS_PER_THREAD) {
+    numThreads = numTracks / MIDI_FILE_MIN_TRACKS_PER_THREAD;
+  }
+
+  if (numThreads < 1) {
+    numThreads = 1;
+  }
+
+  logDebug("Decoding %d MIDI tracks with %d threads", numTracks, numThreads);
+  decoders = (MidiFileTrackDecoder)malloc(sizeof(MidiFileTrackDecoderMembers) *
+                                          numThreads);
+  threadStarted = (boolByte *)calloc((size_t)numThreads, sizeof(boolByte));
+#if UNIX
+  threads = (pthread_t *)malloc(sizeof(pthread_t) * numThreads);
+#elif WINDOWS
+  threads = (HANDLE *)malloc(sizeof(HANDLE) * numThreads);
+#endif
+
+  for (i = 0; i < numThreads; i++) {
+    decoders[i].tracks = tracks;
+    decoders[i].numTracks = numTracks;
+    decoders[i].firstTrack = i;
+    decoders[i].trackStep = numThreads;
+  }
+
+  for (i = 1; i < numThreads; i++) {
+#if UNIX
+    threadStarted[i] = (boolByte)(pthread_create(&threads[i], NULL,
+                                                 _decodeMidiFileTracksThread,
+                                                 &decoders[i]) == 0);
+#elif WINDOWS
+    threads[i] = CreateThread(NULL, 0, _decodeMidiFileTracksThread,
+                              &decoders[i], 0, NULL);
+    threadStarted[i] = (boolByte)(threads[i] != NULL);
+#endif
+  }
+
+  // Also decode the share of any threads which could not be started
+  for (i = 0; i < numThreads; i++) {
+    if (!threadStarted[i]) {
+      _decodeMidiFileTracks(&decoders[i]);
+    }
+  }
+
+  for (i = 1; i < numThreads; i++) {
+    if (threadStarted[i]) {
+#if UNIX
+      pthread_join(threads[i], NULL);
+#elif WINDOWS
+      WaitForSingleObject(threads[i], INFINITE);
+      CloseHandle(threads[i]);
+#endif
+    }
+  }
+
+#if UNIX || WINDOWS
+  free(threads);
+#endif
+  free(threadStarted);
+  free(decoders);
+}
+
+static boolByte _isMidiFileTrackEventBefore(const MidiFileTrack tracks,
+                                            const int a, const int b) {
+  const uint64_t timestampA = tracks[a].events[tracks[a].nextEvent].timestamp;
+  const uint64_t timestampB =
+      tracks[b].events[tracks[b].nextEvent].timestamp;
 
+  // Events at the same time keep the order of their tracks in the file, so
+  // that changes in the tempo track come before the notes on other tracks
+  return (boolByte)(timestampA < timestampB ||
+                    (timestampA == timestampB && a < b));
+}
+
+static void _siftDownMidiFileTrackHeap(const MidiFileTrack tracks, int *heap,
+                                       const int heapSize, int index) {
+  int child, swap;
+
+  while ((child = 2 * index + 1) < heapSize) {
+    if (child + 1 < heapSize &&
+        _isMidiFileTrackEventBefore(tracks, heap[child + 1], heap[child])) {
+      child++;
+    }
+
+    if (!_isMidiFileTrackEventBefore(tracks, heap[child], heap[index])) {
       break;
     }
 
-    switch (divisionType) {
-    case TIME_DIVISION_TYPE_TICKS_PER_BEAT: {
-      double ticksPerSecond = (double)timeDivision * getTempo() / 60.0;
-      double sampleFramesPerTick = getSampleRate() / ticksPerSecond;
-      currentTimeInSampleFrames +=
-          (long)(unpackedVariableLength * sampleFramesPerTick);
-    } break;
-
-    case TIME_DIVISION_TYPE_FRAMES_PER_SECOND:
-      // Actually, this should be caught when parsing the file type
-      logUnsupportedFeature("Time division frames/sec");
-      free(trackData);
-      freeMidiEvent(midiEvent);
-      return false;
+    swap = heap[index];
+    heap[index] = heap[child];
+    heap[child] = swap;
+    index = child;
+  }
+}
 
-    case TIME_DIVISION_TYPE_INVALID:
-    default:
-      logInternalError("Invalid time division type");
-      free(trackData);
-      freeMidiEvent(midiEvent);
-      return false;
+// Merge the decoded tracks into the sequence in order of their timestamps,
+// using a heap which holds the track with the earliest pending event on top.
+// Tempo changes are added to the tempo map as they are reached, so each event
+// can be converted to sample frames right away.
+static boolByte _mergeMidiFileTracks(MidiFileTrack tracks, const int numTracks,
+                                     const int timeDivision,
+                                     MidiSequence midiSequence) {
+  int *heap = (int *)malloc(sizeof(int) * (numTracks + 1));
+  int heapSize = 0;
+  MidiFileTrack track;
+  MidiEvent midiEvent;
+  double beat;
+  int i;
+
+  for (i = 0; i < numTracks; i++) {
+    if (tracks[i].numEvents > 0) {
+      heap[heapSize++] = i;
+    }
+  }
+
+  for (i = heapSize / 2 - 1; i >= 0; i--) {
+    _siftDownMidiFileTrackHeap(tracks, heap, heapSize, i);
+  }
+
+  while (heapSize > 0) {
+    track = &tracks[heap[0]];
+    midiEvent = &track->events[track->nextEvent++];
+
+    if (track->nextEvent == track->numEvents) {
+      heap[0] = heap[--heapSize];
     }
 
-    midiEvent->timestamp = currentTimeInSampleFrames;
+    _siftDownMidiFileTrackHeap(tracks, heap, heapSize, 0);
+    beat = (double)midiEvent->timestamp / (double)timeDivision;
+    midiEvent->timestamp = (uint64_t)tempoMapGetFrameForBeat(
+        midiSequence->tempoMap, beat);
 
     if (midiEvent->eventType == MIDI_TYPE_META) {
-      switch (midiEvent->status) {
-      case MIDI_META_TYPE_TEXT:
-      case MIDI_META_TYPE_COPYRIGHT:
-      case MIDI_META_TYPE_SEQUENCE_NAME:
-      case MIDI_META_TYPE_INSTRUMENT:
-      case MIDI_META_TYPE_LYRIC:
-      case MIDI_META_TYPE_MARKER:
-      case MIDI_META_TYPE_CUE_POINT:
-
-      // This event type could theoretically be supported, as long as the
-      // plugin supports it
-      case MIDI_META_TYPE_PROGRAM_NAME:
-      case MIDI_META_TYPE_DEVICE_NAME:
-      case MIDI_META_TYPE_KEY_SIGNATURE:
-      case MIDI_META_TYPE_PROPRIETARY:
-        logDebug("Ignoring MIDI meta event of type 0x%x at %ld",
-                 midiEvent->status, midiEvent->timestamp);
-        break;
-
-      case MIDI_META_TYPE_TEMPO:
-      case MIDI_META_TYPE_TIME_SIGNATURE:
-      case MIDI_META_TYPE_TRACK_END:
-        logDebug("Parsed MIDI meta event of type 0x%02x at %ld",
-                 midiEvent->status, midiEvent->timestamp);
-        appendMidiEventToSequence(midiSequence, midiEvent);
-        midiEvent = NULL;
-        break;
-
-      default:
-        logWarn("Ignoring MIDI meta event of type 0x%x at %ld",
-                midiEvent->status, midiEvent->timestamp);
-        break;
+      if (midiEvent->status == MIDI_META_TYPE_TRACK_END && heapSize > 0) {
+        // Only the end of the last track ends the sequence
+        continue;
+      } else if (midiEvent->status == MIDI_META_TYPE_TEMPO &&
+                 !tempoMapAddTempo(
+                     midiSequence->tempoMap, beat,
+                     getTempoFromMidiBytes(midiEvent->extraData))) {
+        free(heap);
+        return false;
       }
+
+      logDebug("Parsed MIDI meta event of type 0x%02x at %.0f",
+               midiEvent->status, (double)midiEvent->timestamp);
     } else {
-      logDebug("MIDI event of type 0x%02x parsed at %ld", midiEvent->status,
-               midiEvent->timestamp);
-      appendMidiEventToSequence(midiSequence, midiEvent);
-      midiEvent = NULL;
+      logDebug("MIDI event of type 0x%02x parsed at %.0f", midiEvent->status,
+               (double)midiEvent->timestamp);
     }
+
+    midiSequenceAppendCopy(midiSequence, midiEvent);
   }
 
-  free(trackData);
-  freeMidiEvent(midiEvent);
+  free(heap);
   return true;
 }
 
+static void _freeMidiFileTracks(MidiFileTrack tracks, const int numTracks) {
+  int track;
+
+  for (track = 0; track < numTracks; track++) {
+    trackedFree(tracks[track].events);
+  }
+
+  trackedFree(tracks);
+}
+
 static boolByte _readMidiEventsFile(void *midiSourcePtr,
                                     MidiSequence midiSequence) {
   MidiSource midiSource = (MidiSource)midiSourcePtr;
   MidiSourceFileData extraData = (MidiSourceFileData)(midiSource->extraData);
   unsigned short formatType, numTracks, timeDivision = 0;
+  MidiFileTrack tracks;
+  byte *contents;
+  size_t numBytes = 0;
+  boolByte result = true;
+  unsigned long numSysexEvents = 0;
   int track;
 
-  if (!_readMidiFileHeader(extraData->fileHandle, &formatType, &numTracks,
+  // Read in the entire file in one pass and parse the events from the buffer
+  // data, which is much faster than calling fread() for each event.
+  contents = _readMidiFileContents(extraData->fileHandle, &numBytes);
+
+  if (contents == NULL) {
+    return false;
+  }
+
+  if (!_readMidiFileHeader(contents, numBytes, &formatType, &numTracks,
                            &timeDivision)) {
+    trackedFree(contents);
     return false;
   }
 
-  if (formatType != 0) {
-    logUnsupportedFeature("MIDI file types other than 0");
+  if (formatType > 1) {
+    logUnsupportedFeature("MIDI file types other than 0 or 1");
+    trackedFree(contents);
     return false;
   } else if (formatType == 0 && numTracks != 1) {
     logError("MIDI file '%s' is of type 0, but contains %d tracks",
              midiSource->sourceName->data, numTracks);
+    trackedFree(contents);
     return false;
   }
 
@@ -316,6 +593,7 @@ static boolByte _readMidiEventsFile(void *midiSourcePtr,
   } else {
     extraData->divisionType = TIME_DIVISION_TYPE_FRAMES_PER_SECOND;
     logUnsupportedFeature("MIDI file with time division in frames/second");
+    trackedFree(contents);
     return false;
   }
 
@@ -323,14 +601,44 @@ static boolByte _readMidiEventsFile(void *midiSourcePtr,
       "MIDI file is type %d, has %d tracks, and time division %d (type %d)",
       formatType, numTracks, timeDivision, extraData->divisionType);
 
+  tracks = (MidiFileTrack)trackedCalloc(MEMORY_TAG_MIDI, numTracks,
+                                        sizeof(MidiFileTrackMembers));
+
+  if (!_indexMidiFileTracks(contents, numBytes, tracks, numTracks)) {
+    _freeMidiFileTracks(tracks, numTracks);
+    trackedFree(contents);
+    return false;
+  }
+
+  _decodeAllMidiFileTracks(tracks, numTracks);
+
   for (track = 0; track < numTracks; track++) {
-    if (!_readMidiFileTrack(extraData->fileHandle, track, timeDivision,
-                            extraData->divisionType, midiSequence)) {
-      return false;
+    if (tracks[track].errorMessage != NULL) {
+      logError("MIDI file track %d could not be read: %s", track,
+               tracks[track].errorMessage);
+      result = false;
     }
+
+    numSysexEvents += tracks[track].numSysexEvents;
   }
 
-  return true;
+  if (numSysexEvents > 0) {
+    logWarn("Skipped %lu sysex events in MIDI file (unsupported)",
+            numSysexEvents);
+  }
+
+  if (result) {
+    freeTempoMap(midiSequence->tempoMap);
+    midiSequence->tempoMap = newTempoMap(getTempo());
+    result = _mergeMidiFileTracks(tracks, numTracks, timeDivision & 0x7fff,
+                                  midiSequence);
+    logDebug("MIDI file has %lu tempo changes",
+             (unsigned long)(midiSequence->tempoMap->numEntries - 1));
+  }
+
+  _freeMidiFileTracks(tracks, numTracks);
+  trackedFree(contents);
+  return result;
 }
 
 static void _freeMidiEventsFile(void *midiSourceDataPtr) {
@@ -27,6 +27,7 @@
 #include "Plugin.h"
 
 #include "audio/AudioSettings.h"
+#include "base/MemoryTracker.h"
 #include "logging/EventLogger.h"
 #include "plugin/PluginGain.h"
 #include "plugin/PluginLimiter.h"
@@ -82,6 +83,12 @@ void listAvailablePlugins(const CharString pluginRoot) {
   _listAvailablePluginsInternal();
 }
 
+boolByte scanAvailablePlugins(const CharString pluginRoot,
+                              const unsigned int maxJobs,
+                              const unsigned long timeoutInMs) {
+  return scanAvailablePluginsVst2x(pluginRoot, maxJobs, timeoutInMs);
+}
+
 /**
  * Used to check if an internal plugin (ie, starting with "mrs_" matches an
  * internal plugin name. This function only compares to the length of the
@@ -97,6 +104,24 @@ static boolByte _internalPluginNameMatches(const CharString pluginName,
       strncmp(pluginName->data, internalName, strlen(internalName)) == 0);
 }
 
+static Plugin _newInternalPlugin(const CharString pluginName) {
+  if (_internalPluginNameMatches(pluginName, kInternalPluginGainName)) {
+    return newPluginGain(pluginName);
+  } else if (_internalPluginNameMatches(pluginName,
+                                        kInternalPluginLimiterName)) {
+    return newPluginLimiter(pluginName);
+  } else if (_internalPluginNameMatches(pluginName,
+                                        kInternalPluginPassthruName)) {
+    return newPluginPassthru(pluginName);
+  } else if (_internalPluginNameMatches(pluginName,
+                                        kInternalPluginSilenceName)) {
+    return newPluginSilence(pluginName);
+  } else {
+    logError("'%s' is not a recognized internal plugin", pluginName->data);
+    return NULL;
+  }
+}
+
 // Plugin newPlugin(PluginInterfaceType interfaceType, const CharString
 // pluginName, const CharString pluginLocation) {
 Plugin pluginFactory(const CharString pluginName, const CharString pluginRoot) {
@@ -112,21 +137,7 @@ Plugin pluginFactory(const CharString pluginName, const CharString pluginRoot) {
     return newPluginVst2x(pluginName, pluginRoot);
 
   case PLUGIN_TYPE_INTERNAL:
-    if (_internalPluginNameMatches(pluginName, kInternalPluginGainName)) {
-      return newPluginGain(pluginName);
-    } else if (_internalPluginNameMatches(pluginName,
-                                          kInternalPluginLimiterName)) {
-      return newPluginLimiter(pluginName);
-    } else if (_internalPluginNameMatches(pluginName,
-                                          kInternalPluginPassthruName)) {
-      return newPluginPassthru(pluginName);
-    } else if (_internalPluginNameMatches(pluginName,
-                                          kInternalPluginSilenceName)) {
-      return newPluginSilence(pluginName);
-    } else {
-      logError("'%s' is not a recognized internal plugin", pluginName->data);
-      return NULL;
-    }
+    return _newInternalPlugin(pluginName);
 
   default:
     logError("Could not find plugin type for '%s'", pluginName->data);
@@ -173,8 +184,53 @@ boolByte closePlugin(Plugin self) {
   return true;
 }
 
+Plugin pluginCloneWithState(const Plugin self, const PluginState state) {
+  Plugin clone = NULL;
+
+  if (self == NULL || state == NULL) {
+    logError("Cannot clone plugin without a plugin and state");
+    return NULL;
+  }
+
+  // Skip pluginFactory(), which would search for the plugin again
+  switch (self->interfaceType) {
+  case PLUGIN_TYPE_VST_2X:
+    clone = newPluginVst2xWithPlugin(self);
+    break;
+
+  case PLUGIN_TYPE_INTERNAL:
+    clone = _newInternalPlugin(self->pluginName);
+    break;
+
+  default:
+    logError("Plugin '%s' has an invalid type and cannot be cloned",
+             self->pluginName->data);
+    return NULL;
+  }
+
+  if (!openPlugin(clone)) {
+    freePlugin(clone);
+    return NULL;
+  }
+
+  if (!clone->setState(clone, state)) {
+    logError("Could not apply state to clone of plugin '%s'",
+             self->pluginName->data);
+    closePlugin(clone);
+    freePlugin(clone);
+    return NULL;
+  }
+
+  charStringClear(clone->pluginName);
+  charStringAppend(clone->pluginName, self->pluginName);
+  clone->audioSettings = self->audioSettings;
+  clone->audioClock = self->audioClock;
+  return clone;
+}
+
 Plugin _newPlugin(PluginInterfaceType interfaceType, PluginType pluginType) {
-  Plugin plugin = (Plugin)malloc(sizeof(PluginMembers));
+  Plugin plugin =
+      (Plugin)trackedMalloc(MEMORY_TAG_PLUGIN, sizeof(PluginMembers));
 
   plugin->interfaceType = interfaceType;
   plugin->pluginType = pluginType;
@@ -185,6 +241,8 @@ Plugin _newPlugin(PluginInterfaceType interfaceType, PluginType pluginType) {
   plugin->inputBuffer = NULL;
   plugin->outputBuffer = NULL;
   plugin->isOpen = false;
+  plugin->audioSettings = NULL;
+  plugin->audioClock = NULL;
 
   return plugin;
 }
@@ -207,6 +265,6 @@ void freePlugin(Plugin self) {
     freeCharString(self->pluginName);
     freeCharString(self->pluginLocation);
     freeCharString(self->pluginAbsolutePath);
-    free(self);
+    trackedFree(self);
   }
 }
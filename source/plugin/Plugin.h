@@ -27,9 +27,12 @@
 #ifndef MrsWatson_Plugin_h
 #define MrsWatson_Plugin_h
 
+#include "audio/AudioSettings.h"
 #include "audio/SampleBuffer.h"
 #include "base/CharString.h"
 #include "base/LinkedList.h"
+#include "plugin/PluginState.h"
+#include "time/AudioClock.h"
 
 // All internal plugins should start with this string
 #define INTERNAL_PLUGIN_PREFIX "mrs_"
@@ -57,6 +60,10 @@ typedef enum {
   NUM_PLUGIN_SETTINGS
 } PluginSetting;
 
+// Returned for PLUGIN_SETTING_TAIL_TIME_IN_MS by plugins which do not know how
+// long their tail is
+#define PLUGIN_TAIL_TIME_UNKNOWN -1
+
 typedef struct {
   unsigned int width;
   unsigned int height;
@@ -116,6 +123,33 @@ typedef void (*PluginProcessMidiEventsFunc)(void *pluginPtr,
 typedef boolByte (*PluginSetParameterFunc)(void *pluginPtr, unsigned int index,
                                            float value);
 
+/**
+ * Get the current value of a parameter within a plugin
+ * @param pluginPtr self
+ * @param index Parameter index
+ * @param outValue Receives the parameter's value
+ * @return True if the plugin has a parameter with this index
+ */
+typedef boolByte (*PluginGetParameterFunc)(void *pluginPtr, unsigned int index,
+                                           float *outValue);
+
+/**
+ * Capture the current configuration of an open plugin
+ * @param pluginPtr self
+ * @return New PluginState, which the caller must free, or NULL on failure
+ */
+typedef PluginState (*PluginGetStateFunc)(void *pluginPtr);
+
+/**
+ * Apply a configuration which was captured from another instance of the same
+ * plugin. The plugin must already be open.
+ * @param pluginPtr self
+ * @param state State to apply
+ * @return True on success, false on failure
+ */
+typedef boolByte (*PluginSetStateFunc)(void *pluginPtr,
+                                       const PluginState state);
+
 /**
  * Called once before audio processing begins. Some interfaces provide hooks for
  * a plugin to prepare itself before audio blocks are sent to it.
@@ -154,6 +188,9 @@ typedef struct {
   PluginProcessAudioFunc processAudio;
   PluginProcessMidiEventsFunc processMidiEvents;
   PluginSetParameterFunc setParameter;
+  PluginGetParameterFunc getParameter;
+  PluginGetStateFunc getState;
+  PluginSetStateFunc setState;
   PluginPrepareForProcessingFunc prepareForProcessing;
   PluginShowEditorFunc showEditor;
   PluginCloseFunc closePlugin;
@@ -161,6 +198,11 @@ typedef struct {
   SampleBuffer inputBuffer;
   SampleBuffer outputBuffer;
   boolByte isOpen;
+  // Settings and timeline of the host which runs the plugin. The plugin may
+  // call the host from threads of its own, which must then use these instead
+  // of the global instances. NULL when the global instances should be used.
+  AudioSettings audioSettings;
+  AudioClock audioClock;
 
   void *extraData;
 } PluginMembers;
@@ -187,6 +229,19 @@ Plugin pluginFactory(const CharString pluginName, const CharString pluginRoot);
  */
 void listAvailablePlugins(const CharString pluginRoot);
 
+/**
+ * Scan all plugins on the system and rebuild the plugin index. Internal plugins
+ * are not indexed, since they are always available.
+ * @param pluginRoot User-provided search root path
+ * @param maxJobs Number of plugins to scan in parallel, or 0 for one per
+ * processor
+ * @param timeoutInMs Time limit for loading each plugin, or 0 for the default
+ * @return True if the index was rebuilt
+ */
+boolByte scanAvailablePlugins(const CharString pluginRoot,
+                              const unsigned int maxJobs,
+                              const unsigned long timeoutInMs);
+
 /**
  * Open a plugin.
  * @param self
@@ -199,6 +254,17 @@ boolByte openPlugin(Plugin self);
  */
 boolByte closePlugin(Plugin self);
 
+/**
+ * Create and open a new instance of a plugin, and configure it with a state
+ * which was captured with the plugin's getState() function. This is much
+ * faster than creating the plugin with pluginFactory(), since the plugin does
+ * not need to be searched for, and presets do not need to be read again.
+ * @param self Open plugin to copy
+ * @param state State to apply to the new instance
+ * @return New open plugin, or NULL if the plugin could not be cloned
+ */
+Plugin pluginCloneWithState(const Plugin self, const PluginState state);
+
 /**
 * Create a new plugin. Considered "protected", only subclasses of Plugin should
 * directly call this.
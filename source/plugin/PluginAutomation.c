@@ -0,0 +1,387 @@
+//
+// PluginAutomation.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PluginAutomation.h"
+
+#include "base/File.h"
+#include "logging/EventLogger.h"
+#include "logging/FlightRecorder.h"
+#include "midi/MidiEvent.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PLUGIN_AUTOMATION_DEFAULT_CAPACITY 16
+
+PluginAutomation newPluginAutomation(void) {
+  PluginAutomation automation =
+      (PluginAutomation)malloc(sizeof(PluginAutomationMembers));
+
+  automation->points = NULL;
+  automation->numPoints = 0;
+  automation->_capacity = 0;
+  automation->_nextPoint = 0;
+  automation->_inputBuffer = NULL;
+  automation->_outputBuffer = NULL;
+
+  return automation;
+}
+
+// Insert a new point for the given frame and return it, so that the caller
+// can fill in the remaining fields.
+static PluginAutomationPoint _pluginAutomationInsertPoint(PluginAutomation self,
+                                                          unsigned long frame) {
+  unsigned int i = self->numPoints;
+
+  if (self->numPoints == self->_capacity) {
+    self->_capacity = self->_capacity > 0
+                          ? self->_capacity * 2
+                          : PLUGIN_AUTOMATION_DEFAULT_CAPACITY;
+    self->points = (PluginAutomationPoint)realloc(
+        self->points, sizeof(PluginAutomationPointMembers) * self->_capacity);
+  }
+
+  // Automation files are usually written in order, so search from the end
+  while (i > 0 && self->points[i - 1].frame > frame) {
+    i--;
+  }
+
+  memmove(self->points + i + 1, self->points + i,
+          sizeof(PluginAutomationPointMembers) * (self->numPoints - i));
+  self->points[i].frame = frame;
+  self->numPoints++;
+  return &self->points[i];
+}
+
+void pluginAutomationAddPoint(PluginAutomation self, unsigned long frame,
+                              unsigned int pluginIndex,
+                              unsigned int parameterIndex, float value) {
+  PluginAutomationPoint point = _pluginAutomationInsertPoint(self, frame);
+
+  point->type = PLUGIN_AUTOMATION_TYPE_PARAMETER;
+  point->pluginIndex = pluginIndex;
+  point->parameterIndex = parameterIndex;
+  point->value = value;
+  point->programNumber = 0;
+}
+
+void pluginAutomationAddProgramChange(PluginAutomation self,
+                                      unsigned long frame,
+                                      unsigned int pluginIndex,
+                                      unsigned int programNumber) {
+  PluginAutomationPoint point = _pluginAutomationInsertPoint(self, frame);
+
+  point->type = PLUGIN_AUTOMATION_TYPE_PROGRAM;
+  point->pluginIndex = pluginIndex;
+  point->parameterIndex = 0;
+  point->value = 0.0f;
+  point->programNumber = programNumber;
+}
+
+static char *_skipPluginAutomationWhitespace(char *c) {
+  while (*c != '\0' && isspace((unsigned char)*c)) {
+    c++;
+  }
+
+  return c;
+}
+
+// Parse a number followed by a separator (or the end of the line, for the last
+// field), returning a pointer to the next field or NULL if malformed.
+static char *_parsePluginAutomationField(char *c, double *outValue,
+                                         boolByte isLastField) {
+  char *end;
+
+  *outValue = strtod(c, &end);
+  if (end == c) {
+    return NULL;
+  }
+
+  end = _skipPluginAutomationWhitespace(end);
+  if (isLastField) {
+    return *end == '\0' ? end : NULL;
+  } else if (*end != PLUGIN_AUTOMATION_SEPARATOR) {
+    return NULL;
+  }
+
+  return _skipPluginAutomationWhitespace(end + 1);
+}
+
+boolByte pluginAutomationAddPointFromString(PluginAutomation self,
+                                            const CharString line) {
+  char *c = _skipPluginAutomationWhitespace(line->data);
+  const size_t programLength = strlen(PLUGIN_AUTOMATION_PROGRAM);
+  double frame, pluginIndex, parameterIndex, value;
+  boolByte isProgramChange = false;
+
+  if (*c == '\0' || *c == PLUGIN_AUTOMATION_COMMENT) {
+    return true;
+  }
+
+  if ((c = _parsePluginAutomationField(c, &frame, false)) == NULL ||
+      (c = _parsePluginAutomationField(c, &pluginIndex, false)) == NULL) {
+    logError("Malformed automation point '%s'", line->data);
+    return false;
+  }
+
+  if (!strncmp(c, PLUGIN_AUTOMATION_PROGRAM, programLength)) {
+    c = _skipPluginAutomationWhitespace(c + programLength);
+    if (*c == PLUGIN_AUTOMATION_SEPARATOR) {
+      isProgramChange = true;
+      parameterIndex = 0.0;
+      c = _skipPluginAutomationWhitespace(c + 1);
+    } else {
+      c = NULL;
+    }
+  } else {
+    c = _parsePluginAutomationField(c, &parameterIndex, false);
+  }
+
+  if (c == NULL || (c = _parsePluginAutomationField(c, &value, true)) == NULL) {
+    logError("Malformed automation point '%s'", line->data);
+    return false;
+  }
+
+  if (isProgramChange) {
+    if (frame < 0.0 || pluginIndex < 0.0 || value < 0.0) {
+      logError("Automation point '%s' has a negative frame or index",
+               line->data);
+      return false;
+    }
+
+    pluginAutomationAddProgramChange(self, (unsigned long)frame,
+                                     (unsigned int)pluginIndex,
+                                     (unsigned int)value);
+    return true;
+  }
+
+  if (frame < 0.0 || pluginIndex < 0.0 || parameterIndex < 0.0) {
+    logError("Automation point '%s' has a negative frame or index",
+             line->data);
+    return false;
+  }
+
+  pluginAutomationAddPoint(self, (unsigned long)frame,
+                           (unsigned int)pluginIndex,
+                           (unsigned int)parameterIndex, (float)value);
+  return true;
+}
+
+boolByte pluginAutomationReadFile(PluginAutomation self,
+                                  const CharString filename) {
+  File automationFile = newFileWithPath(filename);
+  LinkedList lines = NULL;
+  LinkedListIterator iterator;
+  boolByte result = true;
+
+  if (automationFile == NULL || !fileExists(automationFile)) {
+    logError("Automation file '%s' does not exist", filename->data);
+    freeFile(automationFile);
+    return false;
+  }
+
+  lines = fileReadLines(automationFile);
+  freeFile(automationFile);
+  if (lines == NULL) {
+    logError("Automation file '%s' could not be read", filename->data);
+    return false;
+  }
+
+  for (iterator = lines; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    if (!pluginAutomationAddPointFromString(self,
+                                            (CharString)iterator->item)) {
+      result = false;
+      break;
+    }
+  }
+
+  freeLinkedListAndItems(lines, (LinkedListFreeItemFunc)freeCharString);
+  logDebug("Read %d automation points from '%s'", self->numPoints,
+           filename->data);
+  return result;
+}
+
+boolByte pluginAutomationIsValidForChain(PluginAutomation self,
+                                         PluginChain pluginChain) {
+  unsigned int i;
+
+  for (i = 0; i < self->numPoints; i++) {
+    if (self->points[i].pluginIndex >= pluginChain->numPlugins) {
+      logError("Automation at frame %lu is for plugin %d, but the chain only "
+               "has %d plugins",
+               self->points[i].frame, self->points[i].pluginIndex,
+               pluginChain->numPlugins);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Apply all points up to and including the given frame
+static void _pluginAutomationApplyPoints(PluginAutomation self,
+                                         PluginChain pluginChain,
+                                         unsigned long frame) {
+  PluginAutomationPoint point;
+  Plugin plugin;
+
+  while (self->_nextPoint < self->numPoints &&
+         self->points[self->_nextPoint].frame <= frame) {
+    point = &self->points[self->_nextPoint];
+    self->_nextPoint++;
+
+    if (point->pluginIndex >= pluginChain->numPlugins) {
+      continue;
+    }
+
+    plugin = pluginChain->plugins[point->pluginIndex];
+
+    if (point->type == PLUGIN_AUTOMATION_TYPE_PROGRAM) {
+      logDebug("Set program %d on plugin '%s' at frame %lu",
+               point->programNumber, plugin->pluginName->data, point->frame);
+      flightRecorderAddParameterChange(getFlightRecorder(), point->pluginIndex,
+                                       point->programNumber, 0.0f, true);
+
+      if (!pluginChainSetProgram(pluginChain, point->pluginIndex,
+                                 point->programNumber)) {
+        logWarn("Could not set program %d on plugin '%s'",
+                point->programNumber, plugin->pluginName->data);
+      }
+
+      continue;
+    }
+
+    logDebug("Set parameter %d on plugin '%s' to %f at frame %lu",
+             point->parameterIndex, plugin->pluginName->data, point->value,
+             point->frame);
+    flightRecorderAddParameterChange(getFlightRecorder(), point->pluginIndex,
+                                     point->parameterIndex, point->value,
+                                     false);
+
+    if (!plugin->setParameter(plugin, point->parameterIndex, point->value)) {
+      logWarn("Could not set parameter %d on plugin '%s'",
+              point->parameterIndex, plugin->pluginName->data);
+    }
+  }
+}
+
+static void _pluginAutomationPrepareBuffers(PluginAutomation self,
+                                            SampleBuffer inBuffer,
+                                            SampleBuffer outBuffer) {
+  // These views are pointed at each sub-block in turn, so that sub-blocks are
+  // processed without copying any samples
+  if (self->_inputBuffer == NULL) {
+    self->_inputBuffer = newSampleBufferView(inBuffer, 0, inBuffer->blocksize);
+  }
+
+  if (self->_outputBuffer == NULL) {
+    self->_outputBuffer =
+        newSampleBufferView(outBuffer, 0, outBuffer->blocksize);
+  }
+}
+
+static void _pluginAutomationProcessSubBlock(
+    PluginAutomation self, PluginChain pluginChain, LinkedList midiEvents,
+    SampleBuffer inBuffer, SampleBuffer outBuffer, SampleCount offset,
+    SampleCount numFrames) {
+  LinkedList subBlockMidiEvents = newLinkedList();
+  LinkedListIterator iterator;
+  MidiEvent midiEvent;
+
+  for (iterator = midiEvents; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    midiEvent = (MidiEvent)iterator->item;
+
+    if (midiEvent->deltaFrames >= offset &&
+        midiEvent->deltaFrames < offset + numFrames) {
+      midiEvent->deltaFrames -= offset;
+      linkedListAppend(subBlockMidiEvents, midiEvent);
+    }
+  }
+
+  pluginChainProcessMidi(pluginChain, subBlockMidiEvents);
+  freeLinkedList(subBlockMidiEvents);
+
+  sampleBufferViewSetRange(self->_inputBuffer, inBuffer, offset, numFrames);
+  sampleBufferViewSetRange(self->_outputBuffer, outBuffer, offset, numFrames);
+  pluginChainProcessAudio(pluginChain, self->_inputBuffer,
+                          self->_outputBuffer);
+}
+
+void pluginAutomationProcessAudio(PluginAutomation self,
+                                  PluginChain pluginChain,
+                                  unsigned long blockStartFrame,
+                                  LinkedList midiEvents, SampleBuffer inBuffer,
+                                  SampleBuffer outBuffer) {
+  const SampleCount blocksize = inBuffer->blocksize;
+  const unsigned long blockStopFrame = blockStartFrame + blocksize;
+  SampleCount offset = 0;
+  SampleCount numFrames;
+
+  _pluginAutomationApplyPoints(self, pluginChain, blockStartFrame);
+
+  if (self->_nextPoint >= self->numPoints ||
+      self->points[self->_nextPoint].frame >= blockStopFrame) {
+    pluginChainProcessMidi(pluginChain, midiEvents);
+    pluginChainProcessAudio(pluginChain, inBuffer, outBuffer);
+    return;
+  }
+
+  outBuffer->blocksize = blocksize;
+  _pluginAutomationPrepareBuffers(self, inBuffer, outBuffer);
+
+  while (offset < blocksize) {
+    numFrames = blocksize - offset;
+
+    if (self->_nextPoint < self->numPoints &&
+        self->points[self->_nextPoint].frame < blockStopFrame) {
+      numFrames = (SampleCount)(self->points[self->_nextPoint].frame -
+                                blockStartFrame - offset);
+    }
+
+    logDebug("Processing sub-block of %lu frames at offset %lu", numFrames,
+             offset);
+    _pluginAutomationProcessSubBlock(self, pluginChain, midiEvents, inBuffer,
+                                     outBuffer, offset, numFrames);
+    offset += numFrames;
+
+    if (offset < blocksize) {
+      _pluginAutomationApplyPoints(self, pluginChain,
+                                   blockStartFrame + offset);
+    }
+  }
+}
+
+void freePluginAutomation(PluginAutomation self) {
+  if (self != NULL) {
+    free(self->points);
+    freeSampleBuffer(self->_inputBuffer);
+    freeSampleBuffer(self->_outputBuffer);
+    free(self);
+  }
+}
@@ -0,0 +1,183 @@
+//
+// PluginAutomation.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginAutomation_h
+#define MrsWatson_PluginAutomation_h
+
+#include "audio/SampleBuffer.h"
+#include "base/CharString.h"
+#include "base/LinkedList.h"
+#include "plugin/PluginChain.h"
+
+#define PLUGIN_AUTOMATION_SEPARATOR ','
+#define PLUGIN_AUTOMATION_COMMENT '#'
+#define PLUGIN_AUTOMATION_PROGRAM "program"
+
+typedef enum {
+  PLUGIN_AUTOMATION_TYPE_PARAMETER,
+  PLUGIN_AUTOMATION_TYPE_PROGRAM
+} PluginAutomationPointType;
+
+typedef struct {
+  PluginAutomationPointType type;
+  unsigned long frame;
+  unsigned int pluginIndex;
+  // Only used for parameter changes
+  unsigned int parameterIndex;
+  float value;
+  // Only used for program changes
+  unsigned int programNumber;
+} PluginAutomationPointMembers;
+
+/**
+ * A single parameter or program change, which is applied to a plugin in the
+ * chain at an exact sample frame.
+ */
+typedef PluginAutomationPointMembers *PluginAutomationPoint;
+
+typedef struct {
+  PluginAutomationPoint points;
+  unsigned int numPoints;
+
+  // Private fields
+  unsigned int _capacity;
+  unsigned int _nextPoint;
+  SampleBuffer _inputBuffer;
+  SampleBuffer _outputBuffer;
+} PluginAutomationMembers;
+
+/**
+ * Holds timestamped parameter and program changes for the plugins in a chain.
+ * Blocks of audio are processed at the regular blocksize, and are only split
+ * into smaller blocks at the frames where a change happens.
+ *
+ * Automation files contain one point per line in the form:
+ *
+ *   frame,plugin,parameter,value
+ *
+ * Where frame is the sample frame (counted from the start of the input) at
+ * which the change happens, plugin is the zero-based position of the plugin in
+ * the chain, and parameter and value are the same as for --parameter. To
+ * switch the plugin to another program, the word "program" is used in place
+ * of the parameter index:
+ *
+ *   frame,plugin,program,number
+ *
+ * Empty lines and lines starting with '#' are ignored. Points do not need to
+ * be in order.
+ */
+typedef PluginAutomationMembers *PluginAutomation;
+
+/**
+ * Create a new automation object with no points
+ * @return PluginAutomation object
+ */
+PluginAutomation newPluginAutomation(void);
+
+/**
+ * Add a parameter change. Points are kept sorted by frame, and points which
+ * share the same frame are applied in the order that they were added.
+ * @param self
+ * @param frame Sample frame where the parameter change happens
+ * @param pluginIndex Position of the plugin in the chain
+ * @param parameterIndex Parameter index
+ * @param value New parameter value
+ */
+void pluginAutomationAddPoint(PluginAutomation self, unsigned long frame,
+                              unsigned int pluginIndex,
+                              unsigned int parameterIndex, float value);
+
+/**
+ * Add a program change. Programs are switched with pluginChainSetProgram(), so
+ * for plugins loaded with an FXB bank the program is taken from memory.
+ * Points are kept sorted in the same way as for pluginAutomationAddPoint().
+ * @param self
+ * @param frame Sample frame where the program change happens
+ * @param pluginIndex Position of the plugin in the chain
+ * @param programNumber Program to switch to
+ */
+void pluginAutomationAddProgramChange(PluginAutomation self,
+                                      unsigned long frame,
+                                      unsigned int pluginIndex,
+                                      unsigned int programNumber);
+
+/**
+ * Parse a line in automation file format and add the resulting point.
+ * @param self
+ * @param line Line of text, see the PluginAutomation documentation for format
+ * @return True if the point was added or the line was empty or a comment, false
+ * if the line could not be parsed
+ */
+boolByte pluginAutomationAddPointFromString(PluginAutomation self,
+                                            const CharString line);
+
+/**
+ * Read all points from an automation file.
+ * @param self
+ * @param filename Automation file to read
+ * @return True if the file was read, false if it could not be opened or
+ * contains malformed lines
+ */
+boolByte pluginAutomationReadFile(PluginAutomation self,
+                                  const CharString filename);
+
+/**
+ * Check that each point refers to a plugin in the given chain.
+ * @param self
+ * @param pluginChain Initialized plugin chain
+ * @return True if all points can be applied to the chain
+ */
+boolByte pluginAutomationIsValidForChain(PluginAutomation self,
+                                         PluginChain pluginChain);
+
+/**
+ * Process a block of audio through the chain, applying all parameter and
+ * program changes which occur within the block. Changes which happened before
+ * the start of the block (for instance, when processing starts after a seek)
+ * are applied before any audio is processed. If no change falls inside the
+ * block, this is equivalent to calling pluginChainProcessMidi() and
+ * pluginChainProcessAudio() for the entire block.
+ * @param self
+ * @param pluginChain Chain to process audio with
+ * @param blockStartFrame Sample frame of the first frame in inBuffer
+ * @param midiEvents MIDI events for the block, with deltaFrames relative to
+ * the start of the block. These are also split among the sub-blocks.
+ * @param inBuffer Input sample block
+ * @param outBuffer Output sample block
+ */
+void pluginAutomationProcessAudio(PluginAutomation self,
+                                  PluginChain pluginChain,
+                                  unsigned long blockStartFrame,
+                                  LinkedList midiEvents, SampleBuffer inBuffer,
+                                  SampleBuffer outBuffer);
+
+/**
+ * Free an automation object and all of its points
+ * @param self
+ */
+void freePluginAutomation(PluginAutomation self);
+
+#endif
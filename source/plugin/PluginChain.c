@@ -27,31 +27,76 @@
 #include "PluginChain.h"
 
 #include "audio/AudioSettings.h"
+#include "audio/Denormals.h"
+#include "audio/SampleBufferMath.h"
+#include "base/MemoryTracker.h"
+#include "base/PlatformInfo.h"
 #include "logging/EventLogger.h"
+#include "logging/FlightRecorder.h"
+#include "midi/MidiEvent.h"
+#include "plugin/PluginPresetFxb.h"
+#include "plugin/PluginVst2x.h"
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if UNIX
+#include <pthread.h>
+#elif WINDOWS
+#include <windows.h>
+#endif
+
 PluginChain pluginChainInstance = NULL;
 
-PluginChain getPluginChain(void) { return pluginChainInstance; }
+#define MIDI_STATUS_CONTROL_CHANGE 0xb0
+#define MIDI_NUM_CHANNELS 16
+#define MIDI_CONTROLLER_SUSTAIN 64
+#define MIDI_CONTROLLER_ALL_NOTES_OFF 123
 
-void initPluginChain(void) {
-  pluginChainInstance = (PluginChain)malloc(sizeof(PluginChainMembers));
+// Creates every n-th clone of a chain, see pluginChainClone()
+typedef struct {
+  PluginChain chain;
+  PluginState *states;
+  PluginChain *outClones;
+  unsigned int numClones;
+  unsigned int firstClone;
+  unsigned int cloneStep;
+} _PluginChainClonerMembers;
+typedef _PluginChainClonerMembers *_PluginChainCloner;
+
+PluginChain newPluginChain(void) {
+  PluginChain pluginChain = (PluginChain)trackedMalloc(
+      MEMORY_TAG_PLUGIN, sizeof(PluginChainMembers));
+
+  pluginChain->numPlugins = 0;
+  pluginChain->plugins = (Plugin *)trackedMalloc(
+      MEMORY_TAG_PLUGIN, sizeof(Plugin) * MAX_PLUGINS);
+  pluginChain->presets = (PluginPreset *)trackedMalloc(
+      MEMORY_TAG_PLUGIN, sizeof(PluginPreset) * MAX_PLUGINS);
+  pluginChain->audioTimers = (TaskTimer *)trackedMalloc(
+      MEMORY_TAG_PLUGIN, sizeof(TaskTimer) * MAX_PLUGINS);
+  pluginChain->midiTimers = (TaskTimer *)trackedMalloc(
+      MEMORY_TAG_PLUGIN, sizeof(TaskTimer) * MAX_PLUGINS);
+  pluginChain->numDeadlineMisses = (unsigned long *)trackedCalloc(
+      MEMORY_TAG_PLUGIN, MAX_PLUGINS, sizeof(unsigned long));
+
+  pluginChain->_realtime = false;
+  pluginChain->_realtimeTimer = NULL;
+  pluginChain->_savedStates = NULL;
+  pluginChain->_denormalStats = NULL;
+  pluginChain->_cpuStats = NULL;
+  pluginChain->_cpuCounters = NULL;
+  pluginChain->_silenceStates = NULL;
+  pluginChain->_silenceThreshold = 0.0f;
+
+  return pluginChain;
+}
 
-  pluginChainInstance->numPlugins = 0;
-  pluginChainInstance->plugins = (Plugin *)malloc(sizeof(Plugin) * MAX_PLUGINS);
-  pluginChainInstance->presets =
-      (PluginPreset *)malloc(sizeof(PluginPreset) * MAX_PLUGINS);
-  pluginChainInstance->audioTimers =
-      (TaskTimer *)malloc(sizeof(TaskTimer) * MAX_PLUGINS);
-  pluginChainInstance->midiTimers =
-      (TaskTimer *)malloc(sizeof(TaskTimer) * MAX_PLUGINS);
+PluginChain getPluginChain(void) { return pluginChainInstance; }
 
-  pluginChainInstance->_realtime = false;
-  pluginChainInstance->_realtimeTimer = NULL;
-}
+void initPluginChain(void) { pluginChainInstance = newPluginChain(); }
 
 boolByte pluginChainAppend(PluginChain self, Plugin plugin,
                            PluginPreset preset) {
@@ -234,11 +279,29 @@ void pluginChainInspect(PluginChain pluginChain) {
 
 void pluginChainPrepareForProcessing(PluginChain self) {
   Plugin plugin;
+  int tailTimeInMs;
   unsigned int i;
 
   for (i = 0; i < self->numPlugins; i++) {
     plugin = self->plugins[i];
     plugin->prepareForProcessing(plugin);
+
+    if (self->_silenceStates != NULL) {
+      // A plugin with an unknown tail is only bypassed once its output is
+      // silent, which is also required for all other plugins
+      tailTimeInMs =
+          plugin->getSetting(plugin, PLUGIN_SETTING_TAIL_TIME_IN_MS);
+
+      if (tailTimeInMs < 0) {
+        tailTimeInMs = 0;
+      }
+
+      memset(&self->_silenceStates[i], 0,
+             sizeof(PluginChainSilenceStateMembers));
+      self->_silenceStates[i].tailFrames =
+          (unsigned long)(tailTimeInMs * getSampleRate() / 1000.0) +
+          (unsigned long)plugin->getSetting(plugin, PLUGIN_INITIAL_DELAY);
+    }
   }
 }
 
@@ -252,7 +315,10 @@ int pluginChainGetMaximumTailTimeInMs(PluginChain pluginChain) {
     plugin = pluginChain->plugins[i];
     tailTime = plugin->getSetting(plugin, PLUGIN_SETTING_TAIL_TIME_IN_MS);
 
-    if (tailTime > maxTailTime) {
+    // The tail of the chain can't be known if the tail of any plugin isn't
+    if (tailTime < 0) {
+      return PLUGIN_TAIL_TIME_UNKNOWN;
+    } else if (tailTime > maxTailTime) {
       maxTailTime = tailTime;
     }
   }
@@ -320,6 +386,335 @@ boolByte pluginChainSetParameters(PluginChain self,
   return passData.success;
 }
 
+boolByte pluginChainSetProgram(PluginChain self, const unsigned int pluginIndex,
+                               const unsigned int programNumber) {
+  PluginPreset preset;
+  Plugin plugin;
+
+  if (pluginIndex >= self->numPlugins) {
+    logError("Cannot set program on plugin %d, chain only has %d plugins",
+             pluginIndex, self->numPlugins);
+    return false;
+  }
+
+  plugin = self->plugins[pluginIndex];
+  preset = self->presets[pluginIndex];
+  logDebug("Setting program %d on plugin '%s'", programNumber,
+           plugin->pluginName->data);
+
+  if (preset != NULL && preset->presetType == PRESET_TYPE_FXB) {
+    return pluginPresetFxbLoadProgram(preset, plugin, programNumber);
+  } else if (plugin->interfaceType == PLUGIN_TYPE_VST_2X) {
+    return pluginVst2xSetProgram(plugin, (int)programNumber);
+  } else {
+    logError("Plugin '%s' does not support programs", plugin->pluginName->data);
+    return false;
+  }
+}
+
+// Many instruments keep their voices across a suspend, so notes which were
+// still held at the end of the last render would sound in the next one. Release
+// the sustain pedal and all notes on every channel, and process one block of
+// silence so that the instrument actually receives the events.
+static void _pluginChainReleaseNotes(Plugin plugin) {
+  MidiEventMembers events[MIDI_NUM_CHANNELS * 2];
+  LinkedList midiEvents = newLinkedList();
+  SampleBuffer inputs = newSampleBuffer(getNumChannels(), getBlocksize());
+  SampleBuffer outputs = newSampleBuffer(getNumChannels(), getBlocksize());
+  unsigned int i;
+
+  memset(events, 0, sizeof(events));
+
+  for (i = 0; i < MIDI_NUM_CHANNELS * 2; i++) {
+    events[i].eventType = MIDI_TYPE_REGULAR;
+    events[i].status = (byte)(MIDI_STATUS_CONTROL_CHANGE | (i / 2));
+    events[i].data1 = (byte)(i % 2 == 0 ? MIDI_CONTROLLER_SUSTAIN
+                                        : MIDI_CONTROLLER_ALL_NOTES_OFF);
+    linkedListAppend(midiEvents, &events[i]);
+  }
+
+  logDebug("Releasing held notes in plugin '%s'", plugin->pluginName->data);
+  plugin->prepareForProcessing(plugin);
+  plugin->processMidiEvents(plugin, midiEvents);
+  plugin->processAudio(plugin, inputs, outputs);
+  plugin->closePlugin(plugin);
+
+  freeSampleBuffer(inputs);
+  freeSampleBuffer(outputs);
+  freeLinkedList(midiEvents);
+}
+
+static void _pluginChainFreeSavedStates(PluginChain self) {
+  unsigned int i;
+
+  if (self->_savedStates != NULL) {
+    for (i = 0; i < self->numPlugins; i++) {
+      freePluginState(self->_savedStates[i]);
+    }
+
+    trackedFree(self->_savedStates);
+    self->_savedStates = NULL;
+  }
+}
+
+boolByte pluginChainSaveState(PluginChain self) {
+  Plugin plugin;
+  boolByte result = true;
+  unsigned int i;
+
+  _pluginChainFreeSavedStates(self);
+  self->_savedStates = (PluginState *)trackedCalloc(
+      MEMORY_TAG_PLUGIN, self->numPlugins, sizeof(PluginState));
+
+  for (i = 0; i < self->numPlugins; i++) {
+    plugin = self->plugins[i];
+    self->_savedStates[i] = plugin->getState(plugin);
+
+    if (self->_savedStates[i] == NULL) {
+      logWarn("Could not save the state of plugin '%s'",
+              plugin->pluginName->data);
+      result = false;
+    }
+  }
+
+  return result;
+}
+
+boolByte pluginChainReset(PluginChain self) {
+  Plugin plugin;
+  boolByte result = true;
+  unsigned int i;
+
+  for (i = 0; i < self->numPlugins; i++) {
+    plugin = self->plugins[i];
+    logDebug("Resetting plugin '%s'", plugin->pluginName->data);
+    plugin->closePlugin(plugin);
+  }
+
+  // Only the head plugin receives MIDI, see pluginChainProcessMidi()
+  if (self->numPlugins > 0 &&
+      self->plugins[0]->pluginType == PLUGIN_TYPE_INSTRUMENT) {
+    _pluginChainReleaseNotes(self->plugins[0]);
+  }
+
+  // A saved state undoes every parameter and program change, including ones
+  // made by automation or MIDI program changes. Plugins without one can only
+  // have their preset loaded again.
+  for (i = 0; i < self->numPlugins; i++) {
+    plugin = self->plugins[i];
+
+    if (self->_savedStates != NULL && self->_savedStates[i] != NULL) {
+      if (!plugin->setState(plugin, self->_savedStates[i])) {
+        logError("Could not restore the state of plugin '%s'",
+                 plugin->pluginName->data);
+        result = false;
+      }
+    } else if (self->presets[i] != NULL &&
+               !_loadPresetForPlugin(plugin, self->presets[i])) {
+      result = false;
+    }
+  }
+
+  return result;
+}
+
+static PluginChain _newPluginChainWithStates(PluginChain self,
+                                             PluginState *states) {
+  PluginChain clone = newPluginChain();
+  Plugin plugin;
+  unsigned int i;
+
+  for (i = 0; i < self->numPlugins; i++) {
+    plugin = pluginCloneWithState(self->plugins[i], states[i]);
+
+    if (plugin == NULL || !pluginChainAppend(clone, plugin, NULL)) {
+      freePlugin(plugin);
+      pluginChainShutdown(clone);
+      freePluginChain(clone);
+      return NULL;
+    }
+  }
+
+  return clone;
+}
+
+static void _clonePluginChains(_PluginChainCloner cloner) {
+  unsigned int i;
+
+  for (i = cloner->firstClone; i < cloner->numClones; i += cloner->cloneStep) {
+    cloner->outClones[i] =
+        _newPluginChainWithStates(cloner->chain, cloner->states);
+  }
+}
+
+#if UNIX || WINDOWS
+// Worker threads must see the same settings and clock as the calling thread,
+// in case the chain belongs to a session
+static void _clonePluginChainsOnThread(_PluginChainCloner cloner) {
+  Plugin headPlugin;
+
+  if (cloner->chain->numPlugins > 0) {
+    headPlugin = cloner->chain->plugins[0];
+
+    if (headPlugin->audioSettings != NULL) {
+      setThreadAudioSettings(headPlugin->audioSettings);
+    }
+
+    if (headPlugin->audioClock != NULL) {
+      setThreadAudioClock(headPlugin->audioClock);
+    }
+  }
+
+  _clonePluginChains(cloner);
+}
+#endif
+
+#if UNIX
+static void *_clonePluginChainsThread(void *clonerPtr) {
+  _clonePluginChainsOnThread((_PluginChainCloner)clonerPtr);
+  return NULL;
+}
+#elif WINDOWS
+static DWORD WINAPI _clonePluginChainsThread(LPVOID clonerPtr) {
+  _clonePluginChainsOnThread((_PluginChainCloner)clonerPtr);
+  return 0;
+}
+#endif
+
+// Create the clones spread over one thread per processor. Opening plugins and
+// applying their state is mostly spent inside the plugins, so this scales as
+// long as the plugins allow several instances to be set up at once. Each
+// thread takes every n-th clone, and the calling thread does its share too.
+static void _cloneAllPluginChains(PluginChain self, PluginState *states,
+                                  const unsigned int numClones,
+                                  PluginChain *outClones) {
+  unsigned int numThreads = platformInfoGetNumProcessors();
+  _PluginChainCloner cloners;
+  boolByte *threadStarted;
+#if UNIX
+  pthread_t *threads;
+#elif WINDOWS
+  HANDLE *threads;
+#endif
+  unsigned int i;
+
+  if (numThreads > numClones) {
+    numThreads = numClones;
+  }
+
+  if (numThreads < 1) {
+    numThreads = 1;
+  }
+
+  logDebug("Cloning plugin chain %u times with %u threads", numClones,
+           numThreads);
+  cloners = (_PluginChainCloner)trackedMalloc(
+      MEMORY_TAG_PLUGIN, sizeof(_PluginChainClonerMembers) * numThreads);
+  threadStarted = (boolByte *)trackedCalloc(MEMORY_TAG_PLUGIN, numThreads,
+                                            sizeof(boolByte));
+#if UNIX
+  threads = (pthread_t *)trackedMalloc(MEMORY_TAG_PLUGIN,
+                                       sizeof(pthread_t) * numThreads);
+#elif WINDOWS
+  threads =
+      (HANDLE *)trackedMalloc(MEMORY_TAG_PLUGIN, sizeof(HANDLE) * numThreads);
+#endif
+
+  for (i = 0; i < numThreads; i++) {
+    cloners[i].chain = self;
+    cloners[i].states = states;
+    cloners[i].outClones = outClones;
+    cloners[i].numClones = numClones;
+    cloners[i].firstClone = i;
+    cloners[i].cloneStep = numThreads;
+  }
+
+  for (i = 1; i < numThreads; i++) {
+#if UNIX
+    threadStarted[i] = (boolByte)(pthread_create(&threads[i], NULL,
+                                                 _clonePluginChainsThread,
+                                                 &cloners[i]) == 0);
+#elif WINDOWS
+    threads[i] = CreateThread(NULL, 0, _clonePluginChainsThread, &cloners[i],
+                              0, NULL);
+    threadStarted[i] = (boolByte)(threads[i] != NULL);
+#endif
+  }
+
+  // Also create the share of any threads which could not be started
+  for (i = 0; i < numThreads; i++) {
+    if (!threadStarted[i]) {
+      _clonePluginChains(&cloners[i]);
+    }
+  }
+
+  for (i = 1; i < numThreads; i++) {
+    if (threadStarted[i]) {
+#if UNIX
+      pthread_join(threads[i], NULL);
+#elif WINDOWS
+      WaitForSingleObject(threads[i], INFINITE);
+      CloseHandle(threads[i]);
+#endif
+    }
+  }
+
+#if UNIX || WINDOWS
+  trackedFree(threads);
+#endif
+  trackedFree(threadStarted);
+  trackedFree(cloners);
+}
+
+boolByte pluginChainClone(PluginChain self, const unsigned int numClones,
+                          PluginChain *outClones) {
+  PluginState *states = (PluginState *)trackedMalloc(
+      MEMORY_TAG_PLUGIN, sizeof(PluginState) * self->numPlugins);
+  boolByte result = true;
+  unsigned int i;
+
+  for (i = 0; i < numClones; i++) {
+    outClones[i] = NULL;
+  }
+
+  for (i = 0; i < self->numPlugins; i++) {
+    states[i] = self->plugins[i]->getState(self->plugins[i]);
+
+    if (states[i] == NULL) {
+      logError("Could not capture state of plugin '%s'",
+               self->plugins[i]->pluginName->data);
+      result = false;
+    }
+  }
+
+  if (result) {
+    _cloneAllPluginChains(self, states, numClones, outClones);
+  }
+
+  for (i = 0; i < numClones; i++) {
+    if (outClones[i] == NULL) {
+      result = false;
+    }
+  }
+
+  if (!result) {
+    for (i = 0; i < numClones; i++) {
+      if (outClones[i] != NULL) {
+        pluginChainShutdown(outClones[i]);
+        freePluginChain(outClones[i]);
+        outClones[i] = NULL;
+      }
+    }
+  }
+
+  for (i = 0; i < self->numPlugins; i++) {
+    freePluginState(states[i]);
+  }
+
+  trackedFree(states);
+  return result;
+}
+
 void pluginChainSetRealtime(PluginChain self, boolByte realtime) {
   self->_realtime = realtime;
 
@@ -330,12 +725,294 @@ void pluginChainSetRealtime(PluginChain self, boolByte realtime) {
   }
 }
 
+void pluginChainSetDenormalCheck(PluginChain self, boolByte enabled) {
+  trackedFree(self->_denormalStats);
+  self->_denormalStats = NULL;
+
+  if (enabled) {
+    self->_denormalStats = (PluginChainDenormalStats)trackedCalloc(
+        MEMORY_TAG_PLUGIN, MAX_PLUGINS,
+        sizeof(PluginChainDenormalStatsMembers));
+  }
+}
+
+void pluginChainSetCpuStats(PluginChain self, boolByte enabled) {
+  trackedFree(self->_cpuStats);
+  self->_cpuStats = NULL;
+  freeCpuCounters(self->_cpuCounters);
+  self->_cpuCounters = NULL;
+
+  if (enabled) {
+    self->_cpuStats = (PluginChainCpuStats)trackedCalloc(
+        MEMORY_TAG_PLUGIN, MAX_PLUGINS, sizeof(PluginChainCpuStatsMembers));
+    self->_cpuCounters = newCpuCounters(true);
+  }
+}
+
+static double _getCountPerInstructions(const PluginChainCpuStats stats,
+                                       const CpuCounterType counter) {
+  const uint64_t instructions =
+      stats->totals.counters[CPU_COUNTER_INSTRUCTIONS];
+  return instructions > 0
+             ? (double)stats->totals.counters[counter] * 1000.0 / instructions
+             : 0.0;
+}
+
+static double _getInstructionsPerCycle(const PluginChainCpuStats stats) {
+  const uint64_t cycles = stats->totals.counters[CPU_COUNTER_CYCLES];
+  return cycles > 0
+             ? (double)stats->totals.counters[CPU_COUNTER_INSTRUCTIONS] / cycles
+             : 0.0;
+}
+
+PluginChainCpuProfile pluginChainGetCpuProfile(PluginChain self,
+                                               const unsigned int index) {
+  PluginChainCpuStats stats;
+
+  if (self->_cpuStats == NULL || index >= self->numPlugins) {
+    return PLUGIN_CHAIN_CPU_PROFILE_UNKNOWN;
+  }
+
+  stats = &self->_cpuStats[index];
+
+  if (stats->totals.numMeasurements == 0 ||
+      stats->wallTimeInMs / stats->totals.numMeasurements <
+          PLUGIN_CHAIN_CPU_MIN_TIME_PER_BLOCK_MS) {
+    return PLUGIN_CHAIN_CPU_PROFILE_UNKNOWN;
+  }
+
+  if (stats->totals.cpuTimeInMs <
+      stats->wallTimeInMs * PLUGIN_CHAIN_CPU_STALL_RATIO) {
+    return PLUGIN_CHAIN_CPU_PROFILE_STALLING;
+  }
+
+  // Without hardware counters, all that is known is that the plugin is busy
+  if (stats->totals.counters[CPU_COUNTER_INSTRUCTIONS] > 0 &&
+      stats->totals.counters[CPU_COUNTER_CYCLES] > 0 &&
+      _getCountPerInstructions(stats, CPU_COUNTER_CACHE_MISSES) >
+          PLUGIN_CHAIN_CPU_MEMORY_BOUND_MISSES_PER_1000 &&
+      _getInstructionsPerCycle(stats) < PLUGIN_CHAIN_CPU_MEMORY_BOUND_IPC) {
+    return PLUGIN_CHAIN_CPU_PROFILE_MEMORY_BOUND;
+  }
+
+  return PLUGIN_CHAIN_CPU_PROFILE_COMPUTE_BOUND;
+}
+
+void pluginChainReportCpuStats(PluginChain self) {
+  PluginChainCpuStats stats;
+  Plugin plugin;
+  double numBlocks;
+  unsigned int i;
+
+  if (self->_cpuStats == NULL) {
+    return;
+  }
+
+  logInfo("CPU usage results:");
+
+  for (i = 0; i < self->numPlugins; i++) {
+    plugin = self->plugins[i];
+    stats = &self->_cpuStats[i];
+
+    if (stats->totals.numMeasurements == 0) {
+      logInfo("  Plugin '%s' did not process any blocks",
+              plugin->pluginName->data);
+      continue;
+    }
+
+    numBlocks = (double)stats->totals.numMeasurements;
+    logInfo("  Plugin '%s': %.4fms CPU time of %.4fms wall time per block "
+            "(%.0f%%)",
+            plugin->pluginName->data, stats->totals.cpuTimeInMs / numBlocks,
+            stats->wallTimeInMs / numBlocks,
+            stats->wallTimeInMs > 0.0
+                ? 100.0 * stats->totals.cpuTimeInMs / stats->wallTimeInMs
+                : 0.0);
+
+    if (cpuCountersHasHardwareCounters(self->_cpuCounters)) {
+      logInfo("    %.0f cycles per block, %.2f instructions per cycle",
+              (double)stats->totals.counters[CPU_COUNTER_CYCLES] / numBlocks,
+              _getInstructionsPerCycle(stats));
+      logInfo("    %.2f LLC misses and %.2f branch misses per 1000 "
+              "instructions",
+              _getCountPerInstructions(stats, CPU_COUNTER_CACHE_MISSES),
+              _getCountPerInstructions(stats, CPU_COUNTER_BRANCH_MISSES));
+    }
+
+    switch (pluginChainGetCpuProfile(self, i)) {
+    case PLUGIN_CHAIN_CPU_PROFILE_COMPUTE_BOUND:
+      logInfo("    Plugin is compute-bound");
+      break;
+
+    case PLUGIN_CHAIN_CPU_PROFILE_MEMORY_BOUND:
+      logInfo("    Plugin is memory-bound");
+      break;
+
+    case PLUGIN_CHAIN_CPU_PROFILE_STALLING:
+      logWarn("    Plugin '%s' spends much of its time off the CPU, waiting "
+              "for page faults, locks or I/O",
+              plugin->pluginName->data);
+      break;
+
+    default:
+      logInfo("    Not enough processing time to profile the plugin");
+      break;
+    }
+  }
+}
+
+void pluginChainSetSilenceBypass(PluginChain self, boolByte enabled,
+                                 double thresholdInDb) {
+  trackedFree(self->_silenceStates);
+  self->_silenceStates = NULL;
+
+  if (enabled) {
+    self->_silenceStates = (PluginChainSilenceState)trackedCalloc(
+        MEMORY_TAG_PLUGIN, MAX_PLUGINS, sizeof(PluginChainSilenceStateMembers));
+    self->_silenceThreshold = (Sample)pow(10.0, thresholdInDb / 20.0);
+  }
+}
+
+void pluginChainReportSilenceBypass(PluginChain self) {
+  PluginChainSilenceState state;
+  unsigned int i;
+
+  if (self->_silenceStates == NULL) {
+    return;
+  }
+
+  logInfo("Silence bypass results:");
+
+  for (i = 0; i < self->numPlugins; i++) {
+    state = &self->_silenceStates[i];
+
+    if (self->plugins[i]->pluginType != PLUGIN_TYPE_INSTRUMENT) {
+      logInfo("  Plugin '%s' was bypassed for %lu of %lu blocks",
+              self->plugins[i]->pluginName->data, state->numBypassedBlocks,
+              state->numBlocks);
+    }
+  }
+}
+
+boolByte pluginChainReportDenormals(PluginChain self) {
+  PluginChainDenormalStats stats;
+  Plugin plugin;
+  double quietTimeInMs, normalTimeInMs;
+  boolByte result = false;
+  unsigned int i;
+
+  if (self->_denormalStats == NULL) {
+    return false;
+  }
+
+  logInfo("Denormal check results:");
+
+  for (i = 0; i < self->numPlugins; i++) {
+    plugin = self->plugins[i];
+    stats = &self->_denormalStats[i];
+
+    if (stats->numDenormalSamples > 0) {
+      logWarn("  Plugin '%s' produced %lu denormal samples",
+              plugin->pluginName->data, stats->numDenormalSamples);
+    }
+
+    if (stats->numQuietBlocks < PLUGIN_CHAIN_DENORMAL_MIN_BLOCKS ||
+        stats->numNormalBlocks < PLUGIN_CHAIN_DENORMAL_MIN_BLOCKS) {
+      logInfo("  Plugin '%s': not enough quiet and normal blocks to compare "
+              "(%lu quiet, %lu normal)",
+              plugin->pluginName->data, stats->numQuietBlocks,
+              stats->numNormalBlocks);
+      continue;
+    }
+
+    quietTimeInMs = stats->quietTimeInMs / stats->numQuietBlocks;
+    normalTimeInMs = stats->normalTimeInMs / stats->numNormalBlocks;
+
+    // Very fast plugins are ignored, since the timer resolution is too low to
+    // compare them reliably
+    if (quietTimeInMs > normalTimeInMs * PLUGIN_CHAIN_DENORMAL_SLOWDOWN_RATIO &&
+        quietTimeInMs - normalTimeInMs >
+            PLUGIN_CHAIN_DENORMAL_MIN_SLOWDOWN_MS) {
+      logWarn("  Plugin '%s' is slower on quiet input (%.3fms vs. %.3fms per "
+              "block), possibly due to denormals",
+              plugin->pluginName->data, quietTimeInMs, normalTimeInMs);
+      result = true;
+    } else {
+      logInfo("  Plugin '%s': %.3fms per quiet block, %.3fms per normal block",
+              plugin->pluginName->data, quietTimeInMs, normalTimeInMs);
+    }
+  }
+
+  return result;
+}
+
+static void _pluginChainUpdateDenormalStats(PluginChainDenormalStats stats,
+                                            const Plugin plugin,
+                                            const Sample inputPeak,
+                                            const double processingTimeInMs) {
+  if (inputPeak < PLUGIN_CHAIN_DENORMAL_QUIET_PEAK) {
+    stats->quietTimeInMs += processingTimeInMs;
+    stats->numQuietBlocks++;
+  } else {
+    stats->normalTimeInMs += processingTimeInMs;
+    stats->numNormalBlocks++;
+  }
+
+  stats->numDenormalSamples +=
+      denormalsCountInSampleBuffer(plugin->outputBuffer);
+}
+
+// Decide whether to skip a plugin for this block, before it is processed
+static boolByte _pluginChainShouldBypass(PluginChainSilenceState state,
+                                         const Plugin plugin,
+                                         const Sample threshold) {
+  boolByte isBypassed;
+
+  if (plugin->pluginType == PLUGIN_TYPE_INSTRUMENT) {
+    return false;
+  }
+
+  state->numBlocks++;
+
+  if (!sampleBufferIsSilent(plugin->inputBuffer, threshold)) {
+    if (state->isBypassed) {
+      logDebug("Input is no longer silent, resuming plugin '%s'",
+               plugin->pluginName->data);
+    }
+
+    state->silentInputFrames = 0;
+    state->isOutputSilent = false;
+    state->isBypassed = false;
+    return false;
+  }
+
+  // The tail is counted from the end of the last block with any signal
+  isBypassed = (boolByte)(state->silentInputFrames >= state->tailFrames &&
+                          state->isOutputSilent);
+  state->silentInputFrames += plugin->inputBuffer->blocksize;
+
+  if (isBypassed) {
+    if (!state->isBypassed) {
+      logDebug("Input is silent, bypassing plugin '%s'",
+               plugin->pluginName->data);
+    }
+
+    state->numBypassedBlocks++;
+  }
+
+  state->isBypassed = isBypassed;
+  return isBypassed;
+}
+
 void pluginChainProcessAudio(PluginChain pluginChain, SampleBuffer inBuffer,
                              SampleBuffer outBuffer) {
+  FlightRecorder flightRecorder = getFlightRecorder();
   Plugin plugin;
+  PluginChainSilenceState state = NULL;
   unsigned int i;
   double processingTimeInMs;
   double totalProcessingTimeInMs;
+  Sample inputPeak = 0.0f;
   const double maxProcessingTimeInMs =
       inBuffer->blocksize * 1000.0 / getSampleRate();
 
@@ -353,9 +1030,55 @@ void pluginChainProcessAudio(PluginChain pluginChain, SampleBuffer inBuffer,
     nextInputBuffer->blocksize = formerOutputBuffer->blocksize;
     sampleBufferCopyAndMapChannels(nextInputBuffer, formerOutputBuffer);
     plugin->outputBuffer->blocksize = plugin->inputBuffer->blocksize;
+
+    if (pluginChain->_silenceStates != NULL) {
+      state = &pluginChain->_silenceStates[i];
+
+      if (_pluginChainShouldBypass(state, plugin,
+                                   pluginChain->_silenceThreshold)) {
+        sampleBufferClear(plugin->outputBuffer);
+        formerOutputBuffer = plugin->outputBuffer;
+        continue;
+      }
+    }
+
+    if (pluginChain->_denormalStats != NULL) {
+      inputPeak = sampleBufferGetPeak(plugin->inputBuffer);
+    }
+
+    // The counters are read outside of the timer, so that the timer does not
+    // include the cost of reading them
+    if (pluginChain->_cpuStats != NULL) {
+      cpuCountersStart(pluginChain->_cpuCounters);
+    }
+
+    flightRecorderEnterPlugin(flightRecorder, (int)i, "processing audio");
     taskTimerStart(pluginChain->audioTimers[i]);
     plugin->processAudio(plugin, plugin->inputBuffer, plugin->outputBuffer);
     processingTimeInMs = taskTimerStop(pluginChain->audioTimers[i]);
+    flightRecorderAddPluginTime(flightRecorder, i, processingTimeInMs);
+
+    if (pluginChain->_cpuStats != NULL) {
+      cpuCountersStop(pluginChain->_cpuCounters,
+                      &pluginChain->_cpuStats[i].totals);
+      pluginChain->_cpuStats[i].wallTimeInMs += processingTimeInMs;
+    }
+
+    // Only the output after silent input matters for the bypass, which may
+    // happen once the output has decayed as well
+    if (state != NULL && state->silentInputFrames > 0) {
+      state->isOutputSilent = sampleBufferIsSilent(
+          plugin->outputBuffer, pluginChain->_silenceThreshold);
+    }
+
+    if (pluginChain->_denormalStats != NULL) {
+      _pluginChainUpdateDenormalStats(&pluginChain->_denormalStats[i], plugin,
+                                      inputPeak, processingTimeInMs);
+    }
+
+    if (processingTimeInMs > maxProcessingTimeInMs) {
+      pluginChain->numDeadlineMisses[i]++;
+    }
 
     if (processingTimeInMs > maxProcessingTimeInMs && pluginChain->_realtime) {
       logWarn(
@@ -371,6 +1094,7 @@ void pluginChainProcessAudio(PluginChain pluginChain, SampleBuffer inBuffer,
     formerOutputBuffer = plugin->outputBuffer;
   }
 
+  flightRecorderEnterPlugin(flightRecorder, FLIGHT_RECORDER_NO_PLUGIN, NULL);
   nextInputBuffer = outBuffer;
   nextInputBuffer->blocksize = formerOutputBuffer->blocksize;
   sampleBufferCopyAndMapChannels(nextInputBuffer, formerOutputBuffer);
@@ -384,17 +1108,64 @@ void pluginChainProcessAudio(PluginChain pluginChain, SampleBuffer inBuffer,
   }
 }
 
+static void _pluginChainProcessMidiWithBank(PluginChain self,
+                                            LinkedList midiEvents) {
+  Plugin plugin = self->plugins[0];
+  LinkedList forwardedEvents = newLinkedList();
+  LinkedListIterator iterator;
+  MidiEvent midiEvent;
+
+  // Program changes are handled here by loading the program from the bank in
+  // memory, which is much faster than having the plugin read it from disk.
+  // Since the plugin is not running while MIDI is being processed, the switch
+  // effectively happens at the start of the block.
+  for (iterator = midiEvents; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    midiEvent = (MidiEvent)iterator->item;
+
+    if (midiEvent->eventType == MIDI_TYPE_REGULAR &&
+        (midiEvent->status & 0xf0) == 0xc0) {
+      pluginChainSetProgram(self, 0, midiEvent->data1);
+    } else {
+      linkedListAppend(forwardedEvents, midiEvent);
+    }
+  }
+
+  if (forwardedEvents->item != NULL) {
+    plugin->processMidiEvents(plugin, forwardedEvents);
+  }
+
+  freeLinkedList(forwardedEvents);
+}
+
 void pluginChainProcessMidi(PluginChain pluginChain, LinkedList midiEvents) {
+  FlightRecorder flightRecorder = getFlightRecorder();
+  LinkedListIterator iterator;
   Plugin plugin;
 
   if (midiEvents->item != NULL) {
     logDebug("Processing plugin chain MIDI events");
+
+    for (iterator = midiEvents; iterator != NULL && iterator->item != NULL;
+         iterator = (LinkedListIterator)iterator->nextItem) {
+      flightRecorderAddMidiEvent(flightRecorder, (MidiEvent)iterator->item);
+    }
+
     // Right now, we only process MIDI in the first plugin in the chain
     // TODO: Is this really the correct behavior? How do other sequencers do it?
     plugin = pluginChain->plugins[0];
+    flightRecorderEnterPlugin(flightRecorder, 0, "processing MIDI");
     taskTimerStart(pluginChain->midiTimers[0]);
-    plugin->processMidiEvents(plugin, midiEvents);
+
+    if (pluginChain->presets[0] != NULL &&
+        pluginChain->presets[0]->presetType == PRESET_TYPE_FXB) {
+      _pluginChainProcessMidiWithBank(pluginChain, midiEvents);
+    } else {
+      plugin->processMidiEvents(plugin, midiEvents);
+    }
+
     taskTimerStop(pluginChain->midiTimers[0]);
+    flightRecorderEnterPlugin(flightRecorder, FLIGHT_RECORDER_NO_PLUGIN, NULL);
   }
 }
 
@@ -420,15 +1191,21 @@ void freePluginChain(PluginChain pluginChain) {
       freeTaskTimer(pluginChain->midiTimers[i]);
     }
 
-    free(pluginChain->presets);
-    free(pluginChain->plugins);
-    free(pluginChain->audioTimers);
-    free(pluginChain->midiTimers);
+    trackedFree(pluginChain->presets);
+    trackedFree(pluginChain->plugins);
+    trackedFree(pluginChain->audioTimers);
+    trackedFree(pluginChain->midiTimers);
+    trackedFree(pluginChain->numDeadlineMisses);
 
     if (pluginChain->_realtime) {
       freeTaskTimer(pluginChain->_realtimeTimer);
     }
 
-    free(pluginChain);
+    _pluginChainFreeSavedStates(pluginChain);
+    trackedFree(pluginChain->_denormalStats);
+    trackedFree(pluginChain->_cpuStats);
+    freeCpuCounters(pluginChain->_cpuCounters);
+    trackedFree(pluginChain->_silenceStates);
+    trackedFree(pluginChain);
   }
 }
@@ -31,22 +31,111 @@
 #include "base/LinkedList.h"
 #include "plugin/Plugin.h"
 #include "plugin/PluginPreset.h"
+#include "time/CpuCounters.h"
 #include "time/TaskTimer.h"
 
 #define MAX_PLUGINS 8
 #define CHAIN_STRING_PLUGIN_SEPARATOR ';'
 #define CHAIN_STRING_PROGRAM_SEPARATOR ','
 
+// Input blocks with a peak below this level (-60dBFS) are considered quiet
+#define PLUGIN_CHAIN_DENORMAL_QUIET_PEAK 0.001f
+// Number of quiet and normal blocks needed before comparing their cost
+#define PLUGIN_CHAIN_DENORMAL_MIN_BLOCKS 8
+// Quiet blocks which are this much slower than normal ones are suspicious
+#define PLUGIN_CHAIN_DENORMAL_SLOWDOWN_RATIO 2.0
+// Minimum difference in cost per block, below which the timer is not precise
+#define PLUGIN_CHAIN_DENORMAL_MIN_SLOWDOWN_MS 0.01
+
+typedef struct {
+  double quietTimeInMs;
+  unsigned long numQuietBlocks;
+  double normalTimeInMs;
+  unsigned long numNormalBlocks;
+  unsigned long numDenormalSamples;
+} PluginChainDenormalStatsMembers;
+
+/**
+ * Processing cost of a single plugin, split by whether its input was quiet or
+ * not. Plugins which slow down considerably on quiet input are likely to be
+ * processing denormal numbers.
+ */
+typedef PluginChainDenormalStatsMembers *PluginChainDenormalStats;
+
+// Plugins which use less CPU time than this fraction of their wall time are
+// waiting on something other than the CPU
+#define PLUGIN_CHAIN_CPU_STALL_RATIO 0.8
+// Plugins which miss the last level cache more often than this, and retire
+// fewer instructions per cycle, are limited by memory access
+#define PLUGIN_CHAIN_CPU_MEMORY_BOUND_MISSES_PER_1000 1.0
+#define PLUGIN_CHAIN_CPU_MEMORY_BOUND_IPC 1.0
+// Below this wall time per block, the measurements are not precise enough
+#define PLUGIN_CHAIN_CPU_MIN_TIME_PER_BLOCK_MS 0.001
+
+typedef enum {
+  PLUGIN_CHAIN_CPU_PROFILE_UNKNOWN,
+  PLUGIN_CHAIN_CPU_PROFILE_COMPUTE_BOUND,
+  PLUGIN_CHAIN_CPU_PROFILE_MEMORY_BOUND,
+  PLUGIN_CHAIN_CPU_PROFILE_STALLING,
+  NUM_PLUGIN_CHAIN_CPU_PROFILES
+} PluginChainCpuProfile;
+
+typedef struct {
+  double wallTimeInMs;
+  CpuCounterTotalsMembers totals;
+} PluginChainCpuStatsMembers;
+
+/**
+ * Wall time, CPU time and hardware counters spent by a single plugin in its
+ * processAudio() function
+ */
+typedef PluginChainCpuStatsMembers *PluginChainCpuStats;
+
+// Input blocks with a peak below this level are considered silent when
+// bypassing plugins on silent input
+#define PLUGIN_CHAIN_SILENCE_BYPASS_DEFAULT_THRESHOLD_IN_DB -90.0
+
+typedef struct {
+  // Frames which must pass after the input becomes silent before the plugin's
+  // tail has been rendered, including its processing delay
+  unsigned long tailFrames;
+  // Frames since the input of the plugin was last above the threshold
+  unsigned long silentInputFrames;
+  boolByte isOutputSilent;
+  boolByte isBypassed;
+  unsigned long numBlocks;
+  unsigned long numBypassedBlocks;
+} PluginChainSilenceStateMembers;
+/**
+ * Tracks whether a plugin's input is silent, and whether the plugin has
+ * finished rendering its tail so that it does not need to be processed.
+ */
+typedef PluginChainSilenceStateMembers *PluginChainSilenceState;
+
 typedef struct {
   unsigned int numPlugins;
   Plugin *plugins;
   PluginPreset *presets;
   TaskTimer *audioTimers;
   TaskTimer *midiTimers;
+  // Number of blocks where each plugin took longer to process than the
+  // duration of the audio in the block
+  unsigned long *numDeadlineMisses;
 
   // Private fields
   boolByte _realtime;
   TaskTimer _realtimeTimer;
+  // Array with one entry per plugin, NULL unless pluginChainSaveState() has
+  // been called
+  PluginState *_savedStates;
+  // Array with one entry per plugin, NULL unless denormal checking is enabled
+  PluginChainDenormalStats _denormalStats;
+  // Array with one entry per plugin, NULL unless CPU stats are enabled
+  PluginChainCpuStats _cpuStats;
+  CpuCounters _cpuCounters;
+  // Array with one entry per plugin, NULL unless silence bypass is enabled
+  PluginChainSilenceState _silenceStates;
+  Sample _silenceThreshold;
 } PluginChainMembers;
 
 /**
@@ -55,6 +144,14 @@ typedef struct {
  */
 typedef PluginChainMembers *PluginChain;
 
+/**
+ * Create a new plugin chain. Most code should use the global instance instead,
+ * but some components (such as the render daemon) need to keep several chains
+ * open at once.
+ * @return Initialized, empty plugin chain
+ */
+PluginChain newPluginChain(void);
+
 /**
  * Get a reference to the global plugin chain instance.
  * @return Reference to global plugin chain, or NULL if the global instance has
@@ -102,7 +199,8 @@ void pluginChainInspect(PluginChain self);
  * needed for the chain. This is essentially the largest tail time value for any
  * plug-in in the chain.
  * @param self
- * @return Maximum tail time, in milliseconds
+ * @return Maximum tail time, in milliseconds, or PLUGIN_TAIL_TIME_UNKNOWN if
+ * any plugin in the chain does not know the length of its tail
  */
 int pluginChainGetMaximumTailTimeInMs(PluginChain self);
 
@@ -114,7 +212,7 @@ int pluginChainGetMaximumTailTimeInMs(PluginChain self);
 unsigned long pluginChainGetProcessingDelay(PluginChain self);
 
 /**
- * Set parameters on the first plugin in a chain.
+ * Set parameters on the first plugin in a chain
  * @param self
  * @param parameters List of parameters to be applied
  * @return True if all parameters were set, false otherwise
@@ -122,6 +220,59 @@ unsigned long pluginChainGetProcessingDelay(PluginChain self);
 boolByte pluginChainSetParameters(PluginChain self,
                                   const LinkedList parameters);
 
+/**
+ * Switch a plugin in the chain to another program. If the plugin was loaded
+ * with an FXB bank, the program is taken from the bank which is already in
+ * memory. Otherwise, VST plugins are asked to change to one of their own
+ * programs.
+ * @param self
+ * @param pluginIndex Index of the plugin in the chain
+ * @param programNumber Program to switch to
+ * @return True if the program could be changed
+ */
+boolByte pluginChainSetProgram(PluginChain self, const unsigned int pluginIndex,
+                               const unsigned int programNumber);
+
+/**
+ * Capture the state of every plugin in an initialized chain, so that
+ * pluginChainReset() can return the chain to it later. Any state which was
+ * saved before is replaced.
+ * @param self
+ * @return True if the state of all plugins could be captured
+ */
+boolByte pluginChainSaveState(PluginChain self);
+
+/**
+ * Return a chain to the state which was captured by pluginChainSaveState(),
+ * so that it can be used to process another audio stream without reopening
+ * the plugins. Each plugin is stopped (which for VST plugins clears internal
+ * state such as delay lines), held notes are released with all notes off on
+ * every channel, and the saved state of each plugin is applied again. This
+ * undoes all parameter and program changes, including those made by
+ * automation or MIDI program changes. Plugins without a saved state only have
+ * their preset loaded again. pluginChainPrepareForProcessing() must be called
+ * before the chain is used again.
+ * @param self
+ * @return True if all plugins could be reset
+ */
+boolByte pluginChainReset(PluginChain self);
+
+/**
+ * Create copies of an initialized chain. The state of each plugin is captured
+ * once and then applied to the new plugin instances, so presets are not read
+ * again and parameters do not need to be set again. This is the fastest way to
+ * set up several identical chains, for instance for parallel rendering. The
+ * clones are created on one thread per processor, so the plugins must allow
+ * several instances to be opened at the same time.
+ * @param self Initialized plugin chain
+ * @param numClones Number of chains to create
+ * @param outClones Array of at least numClones entries which receives the new
+ * chains. The caller is responsible for shutting down and freeing them.
+ * @return True if all clones were created. On failure, no chains are returned.
+ */
+boolByte pluginChainClone(PluginChain self, const unsigned int numClones,
+                          PluginChain *outClones);
+
 /**
  * Set realtime mode for the plugin chain. When set, calls to
  * pluginChainProcessAudio()
@@ -131,6 +282,71 @@ boolByte pluginChainSetParameters(PluginChain self,
  */
 void pluginChainSetRealtime(PluginChain self, boolByte realtime);
 
+/**
+ * Enable or disable measuring the cost of quiet input blocks for each plugin,
+ * and counting the denormal samples in each plugin's output. This adds some
+ * overhead to each block, so it should only be used for diagnostics.
+ * @param self
+ * @param enabled True to enable, false to disable (default)
+ */
+void pluginChainSetDenormalCheck(PluginChain self, boolByte enabled);
+
+/**
+ * Log the results of the denormal check for each plugin, warning about
+ * plugins which produced denormal output or whose processing time increased
+ * considerably with quiet input.
+ * @param self
+ * @return True if any plugin is suspected of slowing down due to denormals
+ */
+boolByte pluginChainReportDenormals(PluginChain self);
+
+/**
+ * Enable or disable measuring the CPU time spent by each plugin, along with
+ * hardware counters for cycles, instructions, cache misses and branch misses
+ * where the OS allows it. The counters are tied to the calling thread, so
+ * this must be called from the thread which processes audio.
+ * @param self
+ * @param enabled True to enable, false to disable (default)
+ */
+void pluginChainSetCpuStats(PluginChain self, boolByte enabled);
+
+/**
+ * Guess what limits the processing speed of a plugin, based on its CPU stats
+ * @param self
+ * @param index Index of the plugin in the chain
+ * @return Profile of the plugin, or PLUGIN_CHAIN_CPU_PROFILE_UNKNOWN if there
+ * are not enough measurements
+ */
+PluginChainCpuProfile pluginChainGetCpuProfile(PluginChain self,
+                                               const unsigned int index);
+
+/**
+ * Log the CPU time, hardware counters and profile of each plugin
+ * @param self
+ */
+void pluginChainReportCpuStats(PluginChain self);
+
+/**
+ * Skip processing effects while their input is silent. An effect is only
+ * bypassed once its input has been silent for longer than its tail time and
+ * processing delay, and its own output has also become silent. This way,
+ * plugins which report a too short tail time are still processed until their
+ * tail has actually decayed. Bypassed effects output silence, and are processed
+ * again as soon as their input is no longer silent. Instruments are never
+ * bypassed.
+ * @param self
+ * @param enabled True to enable, false to disable (default)
+ * @param thresholdInDb Level in dBFS below which blocks are considered silent
+ */
+void pluginChainSetSilenceBypass(PluginChain self, boolByte enabled,
+                                 double thresholdInDb);
+
+/**
+ * Log how many blocks each plugin was bypassed for due to silent input.
+ * @param self
+ */
+void pluginChainReportSilenceBypass(PluginChain self);
+
 /**
  * Prepare each plugin in the chain for processing. This should be called before
  * the first block of audio is sent to the chain.
@@ -149,7 +365,10 @@ void pluginChainProcessAudio(PluginChain self, SampleBuffer inBuffer,
 
 /**
  * Send a list of MIDI events to be processed by the chain. Currently, only the
- * first plugin in the chain will receive these events.
+ * first plugin in the chain will receive these events. If that plugin was
+ * loaded with an FXB bank, program change events are not sent to the plugin,
+ * but instead switch it to the corresponding program from the bank at the
+ * start of the block.
  * @param self
  * @param midiEvents List of events to process
  */
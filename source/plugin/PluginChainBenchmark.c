@@ -0,0 +1,300 @@
+//
+// PluginChainBenchmark.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PluginChainBenchmark.h"
+
+#include "audio/AudioSettings.h"
+#include "logging/EventLogger.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+// Seed for the synthesized noise, which must be the same for every run
+#define PLUGIN_CHAIN_BENCHMARK_NOISE_SEED 0x4d725761u
+
+PluginChainBenchmark newPluginChainBenchmark(void) {
+  PluginChainBenchmark benchmark =
+      (PluginChainBenchmark)malloc(sizeof(PluginChainBenchmarkMembers));
+
+  benchmark->numFrames = 0;
+  benchmark->numIterations = 0;
+  benchmark->framesPerSecond = 0.0;
+  benchmark->realtimeFactor = 0.0;
+  benchmark->iterationTimeInMs = 0.0;
+  benchmark->iterationTimeDeviationInMs = 0.0;
+  benchmark->numPlugins = 0;
+  benchmark->pluginNsPerFrame = NULL;
+  benchmark->pluginNsPerFrameDeviation = NULL;
+
+  benchmark->_blocks = NULL;
+  benchmark->_numBlocks = 0;
+  benchmark->_blocksCapacity = 0;
+
+  return benchmark;
+}
+
+static SampleBuffer _pluginChainBenchmarkAddBlock(PluginChainBenchmark self) {
+  SampleBuffer block;
+
+  if (self->_numBlocks == self->_blocksCapacity) {
+    self->_blocksCapacity =
+        self->_blocksCapacity > 0 ? self->_blocksCapacity * 2 : 64;
+    self->_blocks = (SampleBuffer *)realloc(
+        self->_blocks, sizeof(SampleBuffer) * self->_blocksCapacity);
+  }
+
+  block = newSampleBuffer(getNumChannels(), getBlocksize());
+  self->_blocks[self->_numBlocks++] = block;
+  self->numFrames += block->blocksize;
+  return block;
+}
+
+boolByte pluginChainBenchmarkReadInput(PluginChainBenchmark self,
+                                       SampleSource inputSource,
+                                       const SampleCount maxFrames) {
+  SampleBuffer block;
+  SampleCount framesRead;
+  SampleCount totalFramesRead = 0;
+
+  while (maxFrames == 0 || totalFramesRead < maxFrames) {
+    block = _pluginChainBenchmarkAddBlock(self);
+    framesRead = sampleSourceReadFrames(inputSource, block, 0, getBlocksize());
+
+    if (framesRead == 0) {
+      // Nothing was read into the last block, so it is not needed
+      self->numFrames -= block->blocksize;
+      freeSampleBuffer(block);
+      self->_numBlocks--;
+      break;
+    }
+
+    totalFramesRead += framesRead;
+
+    if (framesRead < getBlocksize()) {
+      sampleBufferClearFrames(block, framesRead, getBlocksize() - framesRead);
+      break;
+    }
+  }
+
+  if (self->_numBlocks == 0) {
+    logError("No audio could be read from '%s'",
+             inputSource->sourceName->data);
+    return false;
+  }
+
+  logDebug("Read %lu frames into %lu blocks", totalFramesRead,
+           self->_numBlocks);
+  return true;
+}
+
+void pluginChainBenchmarkSynthesize(PluginChainBenchmark self,
+                                    const SampleCount numFrames) {
+  unsigned int seed = PLUGIN_CHAIN_BENCHMARK_NOISE_SEED;
+  SampleBuffer block;
+  SampleCount totalFrames;
+  ChannelCount channel;
+  SampleCount frame;
+
+  for (totalFrames = 0; totalFrames < numFrames;
+       totalFrames += block->blocksize) {
+    block = _pluginChainBenchmarkAddBlock(self);
+
+    for (channel = 0; channel < block->numChannels; channel++) {
+      for (frame = 0; frame < block->blocksize; frame++) {
+        // Simple linear congruential generator, scaled to +/- 0.5
+        seed = seed * 1664525u + 1013904223u;
+        block->samples[channel][frame] =
+            (Sample)((double)(seed >> 8) / (double)(1 << 24) - 0.5);
+      }
+    }
+  }
+}
+
+static void _pluginChainBenchmarkProcess(PluginChainBenchmark self,
+                                         PluginChain pluginChain,
+                                         SampleBuffer outBuffer) {
+  unsigned long i;
+
+  for (i = 0; i < self->_numBlocks; i++) {
+    pluginChainProcessAudio(pluginChain, self->_blocks[i], outBuffer);
+  }
+}
+
+static double _getDeviation(const double *values, const unsigned long count,
+                            const double mean) {
+  double sum = 0.0;
+  unsigned long i;
+
+  if (count < 2) {
+    return 0.0;
+  }
+
+  for (i = 0; i < count; i++) {
+    sum += (values[i] - mean) * (values[i] - mean);
+  }
+
+  return sqrt(sum / (double)(count - 1));
+}
+
+boolByte pluginChainBenchmarkRun(PluginChainBenchmark self,
+                                 PluginChain pluginChain,
+                                 const unsigned long numIterations) {
+  SampleBuffer outBuffer;
+  TaskTimer iterationTimer;
+  double *iterationTimes;
+  // Per-plugin times of each iteration, indexed by [plugin][iteration]
+  double *pluginTimes;
+  double *lastPluginTimes;
+  double audioTimeInMs;
+  unsigned long iteration;
+  unsigned int i;
+
+  if (self->_numBlocks == 0) {
+    logError("No signal to benchmark the plugin chain with");
+    return false;
+  } else if (numIterations == 0) {
+    logError("Benchmark needs at least one iteration");
+    return false;
+  } else if (pluginChain->numPlugins == 0) {
+    logError("No plugins to benchmark");
+    return false;
+  }
+
+  // Output is written to the same buffer for every block and then discarded
+  outBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+
+  for (iteration = 0; iteration < PLUGIN_CHAIN_BENCHMARK_WARMUP_ITERATIONS;
+       iteration++) {
+    logDebug("Benchmark warm-up iteration %lu", iteration + 1);
+    _pluginChainBenchmarkProcess(self, pluginChain, outBuffer);
+  }
+
+  free(self->pluginNsPerFrame);
+  free(self->pluginNsPerFrameDeviation);
+  self->numIterations = numIterations;
+  self->numPlugins = pluginChain->numPlugins;
+  self->pluginNsPerFrame = (double *)calloc(self->numPlugins, sizeof(double));
+  self->pluginNsPerFrameDeviation =
+      (double *)calloc(self->numPlugins, sizeof(double));
+
+  iterationTimer = newTaskTimerWithCString("Benchmark", "Iteration");
+  iterationTimes = (double *)calloc(numIterations, sizeof(double));
+  pluginTimes =
+      (double *)calloc(self->numPlugins * numIterations, sizeof(double));
+  lastPluginTimes = (double *)calloc(self->numPlugins, sizeof(double));
+
+  for (iteration = 0; iteration < numIterations; iteration++) {
+    logDebug("Benchmark iteration %lu of %lu", iteration + 1, numIterations);
+
+    for (i = 0; i < self->numPlugins; i++) {
+      lastPluginTimes[i] = pluginChain->audioTimers[i]->totalTaskTime;
+    }
+
+    taskTimerStart(iterationTimer);
+    _pluginChainBenchmarkProcess(self, pluginChain, outBuffer);
+    iterationTimes[iteration] = taskTimerStop(iterationTimer);
+
+    for (i = 0; i < self->numPlugins; i++) {
+      // Convert milliseconds to nanoseconds per frame
+      pluginTimes[i * numIterations + iteration] =
+          (pluginChain->audioTimers[i]->totalTaskTime - lastPluginTimes[i]) *
+          1000000.0 / (double)self->numFrames;
+    }
+  }
+
+  self->iterationTimeInMs = 0.0;
+
+  for (iteration = 0; iteration < numIterations; iteration++) {
+    self->iterationTimeInMs += iterationTimes[iteration];
+  }
+
+  self->iterationTimeInMs /= (double)numIterations;
+  self->iterationTimeDeviationInMs =
+      _getDeviation(iterationTimes, numIterations, self->iterationTimeInMs);
+
+  for (i = 0; i < self->numPlugins; i++) {
+    for (iteration = 0; iteration < numIterations; iteration++) {
+      self->pluginNsPerFrame[i] += pluginTimes[i * numIterations + iteration];
+    }
+
+    self->pluginNsPerFrame[i] /= (double)numIterations;
+    self->pluginNsPerFrameDeviation[i] =
+        _getDeviation(&pluginTimes[i * numIterations], numIterations,
+                      self->pluginNsPerFrame[i]);
+  }
+
+  // The timer has microsecond resolution, so very short runs may measure 0
+  if (self->iterationTimeInMs > 0.0) {
+    audioTimeInMs = (double)self->numFrames * 1000.0 / getSampleRate();
+    self->framesPerSecond =
+        (double)self->numFrames * 1000.0 / self->iterationTimeInMs;
+    self->realtimeFactor = audioTimeInMs / self->iterationTimeInMs;
+  } else {
+    self->framesPerSecond = 0.0;
+    self->realtimeFactor = 0.0;
+  }
+
+  free(lastPluginTimes);
+  free(pluginTimes);
+  free(iterationTimes);
+  freeTaskTimer(iterationTimer);
+  freeSampleBuffer(outBuffer);
+  return true;
+}
+
+void pluginChainBenchmarkPrintResults(PluginChainBenchmark self,
+                                      PluginChain pluginChain) {
+  unsigned int i;
+
+  logInfo("Benchmarked %lu iterations of %lu frames (%.2f seconds of audio)",
+          self->numIterations, self->numFrames,
+          (double)self->numFrames / getSampleRate());
+  logInfo("Time per iteration: %.3fms (+/- %.3fms)", self->iterationTimeInMs,
+          self->iterationTimeDeviationInMs);
+  logInfo("Throughput: %.0f frames/sec, %.2fx realtime", self->framesPerSecond,
+          self->realtimeFactor);
+
+  for (i = 0; i < self->numPlugins && i < pluginChain->numPlugins; i++) {
+    logInfo("Plugin '%s': %.2f ns/frame (+/- %.2f)",
+            pluginChain->plugins[i]->pluginName->data,
+            self->pluginNsPerFrame[i], self->pluginNsPerFrameDeviation[i]);
+  }
+}
+
+void freePluginChainBenchmark(PluginChainBenchmark self) {
+  unsigned long i;
+
+  if (self != NULL) {
+    for (i = 0; i < self->_numBlocks; i++) {
+      freeSampleBuffer(self->_blocks[i]);
+    }
+
+    free(self->_blocks);
+    free(self->pluginNsPerFrame);
+    free(self->pluginNsPerFrameDeviation);
+    free(self);
+  }
+}
@@ -0,0 +1,124 @@
+//
+// PluginChainBenchmark.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginChainBenchmark_h
+#define MrsWatson_PluginChainBenchmark_h
+
+#include "io/SampleSource.h"
+#include "plugin/PluginChain.h"
+
+// Length of the signal which is synthesized when there is no input source
+#define PLUGIN_CHAIN_BENCHMARK_DEFAULT_SYNTH_TIME_IN_MS 10000
+// Number of untimed passes made before measuring
+#define PLUGIN_CHAIN_BENCHMARK_WARMUP_ITERATIONS 1
+
+typedef struct {
+  // Total number of frames in the signal, including padding in the last block
+  SampleCount numFrames;
+  unsigned long numIterations;
+
+  // Results, which are filled in by pluginChainBenchmarkRun()
+  double framesPerSecond;
+  double realtimeFactor;
+  double iterationTimeInMs;
+  double iterationTimeDeviationInMs;
+  // Arrays with one entry per plugin in the chain
+  unsigned int numPlugins;
+  double *pluginNsPerFrame;
+  double *pluginNsPerFrameDeviation;
+
+  // Private fields
+  SampleBuffer *_blocks;
+  unsigned long _numBlocks;
+  unsigned long _blocksCapacity;
+} PluginChainBenchmarkMembers;
+
+/**
+ * Measures the throughput of a plugin chain without any disk I/O. The signal
+ * is either read completely into memory or synthesized, and then processed
+ * by the chain several times. Output is discarded. Times for each plugin are
+ * taken from the chain's audio timers, so they measure the same thing as the
+ * breakdown which is printed after a normal render.
+ */
+typedef PluginChainBenchmarkMembers *PluginChainBenchmark;
+
+/**
+ * Create a new, empty benchmark. The current global blocksize and channel
+ * count are used for the signal.
+ * @return PluginChainBenchmark object
+ */
+PluginChainBenchmark newPluginChainBenchmark(void);
+
+/**
+ * Read an input source into memory. The source must already be open, and is
+ * read until it ends or until the maximum number of frames is reached. The
+ * last block is padded with silence.
+ * @param self
+ * @param inputSource Source to read from
+ * @param maxFrames Maximum number of frames to read, or 0 to read everything
+ * @return True if any audio could be read
+ */
+boolByte pluginChainBenchmarkReadInput(PluginChainBenchmark self,
+                                       SampleSource inputSource,
+                                       const SampleCount maxFrames);
+
+/**
+ * Synthesize a signal to use instead of an input source. The signal is
+ * deterministic noise at -6dBFS, so that every run processes the same audio.
+ * @param self
+ * @param numFrames Length of the signal, in frames
+ */
+void pluginChainBenchmarkSynthesize(PluginChainBenchmark self,
+                                    const SampleCount numFrames);
+
+/**
+ * Process the signal with a plugin chain, first for the warm-up iterations and
+ * then for the given number of measured iterations. The chain must be
+ * initialized and prepared for processing.
+ * @param self
+ * @param pluginChain Chain to measure
+ * @param numIterations Number of measured iterations, must be at least 1
+ * @return True if the benchmark was run
+ */
+boolByte pluginChainBenchmarkRun(PluginChainBenchmark self,
+                                 PluginChain pluginChain,
+                                 const unsigned long numIterations);
+
+/**
+ * Log the results of the last run.
+ * @param self
+ * @param pluginChain Chain which was measured, used for the plugin names
+ */
+void pluginChainBenchmarkPrintResults(PluginChainBenchmark self,
+                                      PluginChain pluginChain);
+
+/**
+ * Free a benchmark and the signal stored in memory.
+ * @param self
+ */
+void freePluginChainBenchmark(PluginChainBenchmark self);
+
+#endif
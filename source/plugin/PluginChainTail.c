@@ -0,0 +1,103 @@
+//
+// PluginChainTail.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PluginChainTail.h"
+
+#include "audio/AudioSettings.h"
+#include "audio/SampleBufferMath.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+PluginChainTail newPluginChainTail(const unsigned long latencyFrames,
+                                   const long tailTimeInMs,
+                                   const double thresholdInDb,
+                                   const unsigned long windowInMs) {
+  PluginChainTail tail =
+      (PluginChainTail)malloc(sizeof(PluginChainTailMembers));
+
+  tail->latencyFrames = latencyFrames;
+  tail->isTailTimeKnown = (boolByte)(tailTimeInMs >= 0);
+  tail->maxTailFrames = (unsigned long)(
+      (tail->isTailTimeKnown ? (double)tailTimeInMs
+                             : (double)PLUGIN_CHAIN_TAIL_MAX_UNKNOWN_IN_MS) *
+      getSampleRate() / 1000.0);
+  tail->threshold = (Sample)pow(10.0, thresholdInDb / 20.0);
+  tail->windowFrames =
+      (unsigned long)((double)windowInMs * getSampleRate() / 1000.0);
+  tail->_framesRendered = 0;
+  tail->_silentFrames = 0;
+
+  return tail;
+}
+
+boolByte pluginChainTailIsNeeded(PluginChainTail self) {
+  return (boolByte)(self->latencyFrames > 0 || self->maxTailFrames > 0);
+}
+
+void pluginChainTailProcess(PluginChainTail self,
+                            const SampleBuffer outputBuffer) {
+  SampleCount numSilentFrames = outputBuffer->blocksize;
+  ChannelCount channel;
+  SampleCount frame;
+
+  self->_framesRendered += outputBuffer->blocksize;
+
+  if (sampleBufferGetPeak(outputBuffer) <= self->threshold) {
+    self->_silentFrames += outputBuffer->blocksize;
+    return;
+  }
+
+  // Only the silence at the end of the output matters, so find the last frame
+  // in the block which is above the threshold on any channel
+  for (channel = 0; channel < outputBuffer->numChannels; channel++) {
+    for (frame = outputBuffer->blocksize; frame > 0; frame--) {
+      if (fabsf(outputBuffer->samples[channel][frame - 1]) > self->threshold) {
+        break;
+      }
+    }
+
+    if (outputBuffer->blocksize - frame < numSilentFrames) {
+      numSilentFrames = outputBuffer->blocksize - frame;
+    }
+  }
+
+  self->_silentFrames = numSilentFrames;
+}
+
+boolByte pluginChainTailIsFinished(PluginChainTail self) {
+  if (self->_framesRendered < self->latencyFrames) {
+    return false;
+  } else if (self->_framesRendered - self->latencyFrames >=
+             self->maxTailFrames) {
+    return true;
+  }
+
+  return (boolByte)(self->windowFrames > 0 &&
+                    self->_silentFrames >= self->windowFrames);
+}
+
+void freePluginChainTail(PluginChainTail self) { free(self); }
@@ -0,0 +1,106 @@
+//
+// PluginChainTail.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginChainTail_h
+#define MrsWatson_PluginChainTail_h
+
+#include "audio/SampleBuffer.h"
+#include "base/Types.h"
+
+#define PLUGIN_CHAIN_TAIL_DEFAULT_THRESHOLD_IN_DB -90.0
+#define PLUGIN_CHAIN_TAIL_DEFAULT_WINDOW_IN_MS 100
+// Safety limit for chains which do not know how long their tail is, in which
+// case processing normally stops once the output has become silent
+#define PLUGIN_CHAIN_TAIL_MAX_UNKNOWN_IN_MS 30000
+
+typedef struct {
+  unsigned long latencyFrames;
+  unsigned long maxTailFrames;
+  Sample threshold;
+  unsigned long windowFrames;
+  // False if the chain does not know how long its tail is
+  boolByte isTailTimeKnown;
+
+  // Private fields
+  unsigned long _framesRendered;
+  unsigned long _silentFrames;
+} PluginChainTailMembers;
+
+/**
+ * Decides how long a plugin chain should keep processing silent input after
+ * the input source has ended. The chain's processing delay is always flushed,
+ * so that the last input frames reach the output. After that, processing stops
+ * once the output has stayed below the silence threshold for the given window,
+ * or when the maximum tail time has passed, whichever happens first. If the
+ * tail time is unknown, the silence window is what normally ends processing,
+ * and PLUGIN_CHAIN_TAIL_MAX_UNKNOWN_IN_MS is used as the maximum tail time.
+ */
+typedef PluginChainTailMembers *PluginChainTail;
+
+/**
+ * Create a new tail object. Times are converted to frames using the current
+ * sample rate.
+ * @param latencyFrames Processing delay of the chain, in frames
+ * @param tailTimeInMs Maximum time to render after the latency is flushed, or
+ * PLUGIN_TAIL_TIME_UNKNOWN (or any other negative value) if it is not known
+ * @param thresholdInDb Level in dBFS below which output is considered silent
+ * @param windowInMs Time which the output must stay silent before stopping.
+ * If zero, only the maximum tail time is used.
+ * @return PluginChainTail object
+ */
+PluginChainTail newPluginChainTail(const unsigned long latencyFrames,
+                                   const long tailTimeInMs,
+                                   const double thresholdInDb,
+                                   const unsigned long windowInMs);
+
+/**
+ * @param self
+ * @return True if the chain has any latency or tail which needs to be
+ * rendered after the input has ended
+ */
+boolByte pluginChainTailIsNeeded(PluginChainTail self);
+
+/**
+ * Account for a block of output which was rendered from silent input.
+ * @param self
+ * @param outputBuffer Output of the plugin chain
+ */
+void pluginChainTailProcess(PluginChainTail self,
+                            const SampleBuffer outputBuffer);
+
+/**
+ * @param self
+ * @return True if no more blocks need to be rendered
+ */
+boolByte pluginChainTailIsFinished(PluginChainTail self);
+
+/**
+ * Free a tail object
+ * @param self
+ */
+void freePluginChainTail(PluginChainTail self);
+
+#endif
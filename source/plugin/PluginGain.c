@@ -27,6 +27,7 @@
 #include "PluginGain.h"
 
 #include "audio/SampleBuffer.h"
+#include "audio/SampleBufferMath.h"
 #include "logging/EventLogger.h"
 
 const char *kInternalPluginGainName = INTERNAL_PLUGIN_PREFIX "gain";
@@ -63,15 +64,9 @@ static void _pluginGainProcessAudio(void *pluginPtr, SampleBuffer inputs,
                                     SampleBuffer outputs) {
   Plugin plugin = (Plugin)pluginPtr;
   PluginGainSettings settings = (PluginGainSettings)plugin->extraData;
-  unsigned long channel, sample;
 
   sampleBufferCopyAndMapChannels(outputs, inputs);
-
-  for (channel = 0; channel < outputs->numChannels; ++channel) {
-    for (sample = 0; sample < outputs->blocksize; ++sample) {
-      outputs->samples[channel][sample] *= settings->gain;
-    }
-  }
+  sampleBufferApplyGain(outputs, settings->gain);
 }
 
 static void _pluginGainProcessMidiEvents(void *pluginPtr,
@@ -95,6 +90,42 @@ static boolByte _pluginGainSetParameter(void *pluginPtr, unsigned int i,
   }
 }
 
+static boolByte _pluginGainGetParameter(void *pluginPtr, unsigned int i,
+                                        float *outValue) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginGainSettings settings = (PluginGainSettings)plugin->extraData;
+
+  switch (i) {
+  case PLUGIN_GAIN_SETTINGS_GAIN:
+    *outValue = settings->gain;
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+static PluginState _pluginGainGetState(void *pluginPtr) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginGainSettings settings = (PluginGainSettings)plugin->extraData;
+  PluginState state = newPluginState();
+
+  pluginStateSetNumParameters(state, PLUGIN_GAIN_NUM_SETTINGS);
+  state->parameters[PLUGIN_GAIN_SETTINGS_GAIN] = settings->gain;
+  return state;
+}
+
+static boolByte _pluginGainSetState(void *pluginPtr, const PluginState state) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginGainSettings settings = (PluginGainSettings)plugin->extraData;
+
+  if (state->numParameters > PLUGIN_GAIN_SETTINGS_GAIN) {
+    settings->gain = state->parameters[PLUGIN_GAIN_SETTINGS_GAIN];
+  }
+
+  return true;
+}
+
 Plugin newPluginGain(const CharString pluginName) {
   Plugin plugin = _newPlugin(PLUGIN_TYPE_INTERNAL, PLUGIN_TYPE_EFFECT);
   PluginGainSettings settings =
@@ -111,6 +142,9 @@ Plugin newPluginGain(const CharString pluginName) {
   plugin->processAudio = _pluginGainProcessAudio;
   plugin->processMidiEvents = _pluginGainProcessMidiEvents;
   plugin->setParameter = _pluginGainSetParameter;
+  plugin->getParameter = _pluginGainGetParameter;
+  plugin->getState = _pluginGainGetState;
+  plugin->setState = _pluginGainSetState;
   plugin->closePlugin = _pluginGainEmpty;
   plugin->freePluginData = _pluginGainEmpty;
 
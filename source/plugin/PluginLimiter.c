@@ -27,6 +27,7 @@
 #include "PluginLimiter.h"
 
 #include "audio/SampleBuffer.h"
+#include "audio/SampleBufferMath.h"
 #include "logging/EventLogger.h"
 
 const char *kInternalPluginLimiterName = INTERNAL_PLUGIN_PREFIX "limiter";
@@ -62,19 +63,8 @@ static int _pluginLimiterGetSetting(void *pluginPtr,
 
 static void _pluginLimiterProcessAudio(void *pluginPtr, SampleBuffer inputs,
                                        SampleBuffer outputs) {
-  unsigned long channel, sample;
-
   sampleBufferCopyAndMapChannels(outputs, inputs);
-
-  for (channel = 0; channel < outputs->numChannels; ++channel) {
-    for (sample = 0; sample < outputs->blocksize; ++sample) {
-      if (outputs->samples[channel][sample] > 1.0f) {
-        outputs->samples[channel][sample] = 1.0f;
-      } else if (outputs->samples[channel][sample] < -1.0f) {
-        outputs->samples[channel][sample] = -1.0f;
-      }
-    }
-  }
+  sampleBufferClip(outputs, 1.0f);
 }
 
 static void _pluginLimiterProcessMidiEvents(void *pluginPtr,
@@ -87,6 +77,21 @@ static boolByte _pluginLimiterSetParameter(void *pluginPtr, unsigned int i,
   return false;
 }
 
+static boolByte _pluginLimiterGetParameter(void *pluginPtr, unsigned int i,
+                                           float *outValue) {
+  return false;
+}
+
+// There are no settings to copy
+static PluginState _pluginLimiterGetState(void *pluginPtr) {
+  return newPluginState();
+}
+
+static boolByte _pluginLimiterSetState(void *pluginPtr,
+                                       const PluginState state) {
+  return true;
+}
+
 Plugin newPluginLimiter(const CharString pluginName) {
   Plugin plugin = _newPlugin(PLUGIN_TYPE_INTERNAL, PLUGIN_TYPE_EFFECT);
   charStringCopy(plugin->pluginName, pluginName);
@@ -100,6 +105,9 @@ Plugin newPluginLimiter(const CharString pluginName) {
   plugin->processAudio = _pluginLimiterProcessAudio;
   plugin->processMidiEvents = _pluginLimiterProcessMidiEvents;
   plugin->setParameter = _pluginLimiterSetParameter;
+  plugin->getParameter = _pluginLimiterGetParameter;
+  plugin->getState = _pluginLimiterGetState;
+  plugin->setState = _pluginLimiterSetState;
   plugin->closePlugin = _pluginLimiterEmpty;
   plugin->freePluginData = _pluginLimiterEmpty;
 
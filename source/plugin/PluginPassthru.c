@@ -80,6 +80,21 @@ static boolByte _pluginPassthruSetParameter(void *pluginPtr, unsigned int i,
   return false;
 }
 
+static boolByte _pluginPassthruGetParameter(void *pluginPtr, unsigned int i,
+                                            float *outValue) {
+  return false;
+}
+
+// There are no settings to copy
+static PluginState _pluginPassthruGetState(void *pluginPtr) {
+  return newPluginState();
+}
+
+static boolByte _pluginPassthruSetState(void *pluginPtr,
+                                        const PluginState state) {
+  return true;
+}
+
 Plugin newPluginPassthru(const CharString pluginName) {
   Plugin plugin = _newPlugin(PLUGIN_TYPE_INTERNAL, PLUGIN_TYPE_EFFECT);
   charStringCopy(plugin->pluginName, pluginName);
@@ -93,6 +108,9 @@ Plugin newPluginPassthru(const CharString pluginName) {
   plugin->processAudio = _pluginPassthruProcessAudio;
   plugin->processMidiEvents = _pluginPassthruProcessMidiEvents;
   plugin->setParameter = _pluginPassthruSetParameter;
+  plugin->getParameter = _pluginPassthruGetParameter;
+  plugin->getState = _pluginPassthruGetState;
+  plugin->setState = _pluginPassthruSetState;
   plugin->closePlugin = _pluginPassthruEmpty;
   plugin->freePluginData = _pluginPassthruEmpty;
 
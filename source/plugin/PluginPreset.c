@@ -28,6 +28,7 @@
 
 #include "base/File.h"
 #include "logging/EventLogger.h"
+#include "plugin/PluginPresetFxb.h"
 #include "plugin/PluginPresetFxp.h"
 #include "plugin/PluginPresetInternalProgram.h"
 
@@ -56,6 +57,9 @@ static PluginPresetType _pluginPresetGuessType(const CharString presetName) {
   } else if (charStringIsEqualToCString(fileExtension, "fxp", true)) {
     freeCharString(fileExtension);
     return PRESET_TYPE_FXP;
+  } else if (charStringIsEqualToCString(fileExtension, "fxb", true)) {
+    freeCharString(fileExtension);
+    return PRESET_TYPE_FXB;
   } else {
     logCritical("Preset '%s' does not match any supported type",
                 presetName->data);
@@ -71,6 +75,9 @@ PluginPreset pluginPresetFactory(const CharString presetName) {
   case PRESET_TYPE_FXP:
     return newPluginPresetFxp(presetName);
 
+  case PRESET_TYPE_FXB:
+    return newPluginPresetFxb(presetName);
+
   case PRESET_TYPE_INTERNAL_PROGRAM:
     return newPluginPresetInternalProgram(presetName);
 
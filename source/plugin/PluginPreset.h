@@ -33,6 +33,7 @@
 typedef enum {
   PRESET_TYPE_INVALID,
   PRESET_TYPE_FXP,
+  PRESET_TYPE_FXB,
   PRESET_TYPE_INTERNAL_PROGRAM,
   NUM_PRESET_TYPES
 } PluginPresetType;
@@ -0,0 +1,424 @@
+//
+// PluginPresetFxb.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PluginPresetFxb.h"
+
+#include "base/File.h"
+#include "logging/EventLogger.h"
+#include "plugin/PluginVst2x.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define FXB_CHUNK_MAGIC 0x43636E4B          // 'CcnK'
+#define FXB_REGULAR_BANK 0x4678426B         // 'FxBk'
+#define FXB_OPAQUE_CHUNK_BANK 0x46424368    // 'FBCh'
+#define FXB_REGULAR_PROGRAM 0x4678436B      // 'FxCk'
+#define FXB_OPAQUE_CHUNK_PROGRAM 0x46504368 // 'FPCh'
+#define FXB_PROGRAM_NAME_LENGTH 28
+#define FXB_BANK_HEADER_FUTURE_LENGTH 128
+// Smallest possible program in a regular bank, which has no parameters
+#define FXB_PROGRAM_HEADER_LENGTH (7 * 4 + FXB_PROGRAM_NAME_LENGTH)
+
+// All values in FXB files are stored as big endian
+static boolByte _readFxbUnsignedInt(const byte *data, const size_t dataSize,
+                                    size_t *offset, unsigned int *outValue) {
+  const byte *value = data + *offset;
+
+  if (*offset + 4 > dataSize) {
+    return false;
+  }
+
+  *outValue = ((unsigned int)value[0] << 24) | ((unsigned int)value[1] << 16) |
+              ((unsigned int)value[2] << 8) | (unsigned int)value[3];
+  *offset += 4;
+  return true;
+}
+
+static const byte *_readFxbBytes(const byte *data, const size_t dataSize,
+                                 size_t *offset, const size_t numBytes) {
+  const byte *result = data + *offset;
+
+  if (numBytes > dataSize || *offset > dataSize - numBytes) {
+    return NULL;
+  }
+
+  *offset += numBytes;
+  return result;
+}
+
+static void _freePluginPresetFxbProgram(PluginPresetFxbProgram self) {
+  if (self != NULL) {
+    freeCharString(self->name);
+    free(self->parameters);
+    free(self->chunk);
+    free(self);
+  }
+}
+
+static PluginPresetFxbProgram _parseFxbProgram(const byte *data,
+                                               const size_t dataSize,
+                                               size_t *offset) {
+  PluginPresetFxbProgram program = NULL;
+  unsigned int chunkMagic, byteSize, fxMagic, version, fxID, fxVersion;
+  unsigned int numParams, valueBuffer, i;
+  const byte *bytes;
+
+  if (!_readFxbUnsignedInt(data, dataSize, offset, &chunkMagic) ||
+      !_readFxbUnsignedInt(data, dataSize, offset, &byteSize) ||
+      !_readFxbUnsignedInt(data, dataSize, offset, &fxMagic) ||
+      !_readFxbUnsignedInt(data, dataSize, offset, &version) ||
+      !_readFxbUnsignedInt(data, dataSize, offset, &fxID) ||
+      !_readFxbUnsignedInt(data, dataSize, offset, &fxVersion) ||
+      !_readFxbUnsignedInt(data, dataSize, offset, &numParams) ||
+      (bytes = _readFxbBytes(data, dataSize, offset,
+                             FXB_PROGRAM_NAME_LENGTH)) == NULL) {
+    logError("Short read of FXB bank at program header");
+    return NULL;
+  }
+
+  if (chunkMagic != FXB_CHUNK_MAGIC) {
+    logError("FXB bank has program with bad chunk magic");
+    return NULL;
+  }
+
+  program =
+      (PluginPresetFxbProgram)malloc(sizeof(PluginPresetFxbProgramMembers));
+  if (program == NULL) {
+    logError("Could not allocate FXB program");
+    return NULL;
+  }
+
+  program->name = newCharStringWithCapacity(FXB_PROGRAM_NAME_LENGTH + 1);
+  memcpy(program->name->data, bytes, FXB_PROGRAM_NAME_LENGTH);
+  program->parameters = NULL;
+  program->numParameters = 0;
+  program->chunk = NULL;
+  program->chunkSize = 0;
+
+  if (fxMagic == FXB_REGULAR_PROGRAM) {
+    // The count comes from the file, so make sure that the data is really
+    // there before allocating anything for it
+    if (numParams > (dataSize - *offset) / 4) {
+      logError("FXB bank has program with %u parameters, but only %lu bytes "
+               "of data are left",
+               numParams, (unsigned long)(dataSize - *offset));
+      _freePluginPresetFxbProgram(program);
+      return NULL;
+    }
+
+    program->parameters = (float *)malloc(sizeof(float) * numParams);
+    if (program->parameters == NULL && numParams > 0) {
+      logError("Could not allocate %u FXB program parameters", numParams);
+      _freePluginPresetFxbProgram(program);
+      return NULL;
+    }
+
+    program->numParameters = numParams;
+
+    for (i = 0; i < numParams; i++) {
+      if (!_readFxbUnsignedInt(data, dataSize, offset, &valueBuffer)) {
+        logError("Short read of FXB bank at parameter data");
+        _freePluginPresetFxbProgram(program);
+        return NULL;
+      }
+
+      memcpy(&program->parameters[i], &valueBuffer, sizeof(float));
+    }
+  } else if (fxMagic == FXB_OPAQUE_CHUNK_PROGRAM) {
+    if (!_readFxbUnsignedInt(data, dataSize, offset, &valueBuffer) ||
+        (bytes = _readFxbBytes(data, dataSize, offset, valueBuffer)) == NULL) {
+      logError("Short read of FXB bank at program chunk");
+      _freePluginPresetFxbProgram(program);
+      return NULL;
+    }
+
+    program->chunkSize = valueBuffer;
+    program->chunk = (byte *)malloc(program->chunkSize);
+    if (program->chunk == NULL) {
+      logError("Could not allocate FXB program chunk of %u bytes",
+               valueBuffer);
+      _freePluginPresetFxbProgram(program);
+      return NULL;
+    }
+
+    memcpy(program->chunk, bytes, program->chunkSize);
+  } else {
+    logError("FXB bank has program with invalid fxMagic type");
+    _freePluginPresetFxbProgram(program);
+    return NULL;
+  }
+
+  return program;
+}
+
+boolByte pluginPresetFxbParse(PluginPreset self, const byte *data,
+                              const size_t dataSize) {
+  PluginPresetFxbData extraData = (PluginPresetFxbData)(self->extraData);
+  unsigned int chunkMagic, byteSize, fxMagic, version, valueBuffer, i;
+  size_t offset = 0;
+  const byte *bytes;
+
+  if (!_readFxbUnsignedInt(data, dataSize, &offset, &chunkMagic) ||
+      !_readFxbUnsignedInt(data, dataSize, &offset, &byteSize) ||
+      !_readFxbUnsignedInt(data, dataSize, &offset, &fxMagic) ||
+      !_readFxbUnsignedInt(data, dataSize, &offset, &version) ||
+      !_readFxbUnsignedInt(data, dataSize, &offset, &extraData->fxID) ||
+      !_readFxbUnsignedInt(data, dataSize, &offset, &extraData->fxVersion) ||
+      !_readFxbUnsignedInt(data, dataSize, &offset,
+                           &extraData->numPrograms)) {
+    logError("Short read of FXB bank '%s' at header", self->presetName->data);
+    return false;
+  }
+
+  if (chunkMagic != FXB_CHUNK_MAGIC) {
+    logError("FXB bank '%s' has bad chunk magic", self->presetName->data);
+    return false;
+  }
+
+  // Version 2 banks store the current program at the start of the reserved
+  // space, older banks always start with the first program.
+  extraData->currentProgram = 0;
+  if (version >= 2 && !_readFxbUnsignedInt(data, dataSize, &offset,
+                                           &extraData->currentProgram)) {
+    logError("Short read of FXB bank '%s' at current program",
+             self->presetName->data);
+    return false;
+  }
+
+  offset = 7 * 4 + FXB_BANK_HEADER_FUTURE_LENGTH;
+  logDebug("FXB bank has %d programs, current program is %d",
+           extraData->numPrograms, extraData->currentProgram);
+
+  if (fxMagic == FXB_REGULAR_BANK) {
+    // Each program takes up at least a header in the file, so a larger count
+    // than that can't be right and must not be used to allocate memory
+    if (offset > dataSize ||
+        extraData->numPrograms >
+            (dataSize - offset) / FXB_PROGRAM_HEADER_LENGTH) {
+      logError("FXB bank '%s' has %u programs, which do not fit in the file",
+               self->presetName->data, extraData->numPrograms);
+      extraData->numPrograms = 0;
+      return false;
+    }
+
+    extraData->programs = (PluginPresetFxbProgram *)calloc(
+        extraData->numPrograms, sizeof(PluginPresetFxbProgram));
+    if (extraData->programs == NULL && extraData->numPrograms > 0) {
+      logError("Could not allocate programs of FXB bank '%s'",
+               self->presetName->data);
+      extraData->numPrograms = 0;
+      return false;
+    }
+
+    for (i = 0; i < extraData->numPrograms; i++) {
+      extraData->programs[i] = _parseFxbProgram(data, dataSize, &offset);
+
+      if (extraData->programs[i] == NULL) {
+        logError("Could not read program %d from FXB bank '%s'", i,
+                 self->presetName->data);
+        return false;
+      }
+    }
+  } else if (fxMagic == FXB_OPAQUE_CHUNK_BANK) {
+    if (!_readFxbUnsignedInt(data, dataSize, &offset, &valueBuffer) ||
+        (bytes = _readFxbBytes(data, dataSize, &offset, valueBuffer)) == NULL) {
+      logError("Short read of FXB bank '%s' at chunk", self->presetName->data);
+      return false;
+    }
+
+    extraData->bankChunkSize = valueBuffer;
+    extraData->bankChunk = (byte *)malloc(extraData->bankChunkSize);
+    if (extraData->bankChunk == NULL) {
+      logError("Could not allocate chunk of FXB bank '%s'",
+               self->presetName->data);
+      extraData->bankChunkSize = 0;
+      return false;
+    }
+
+    memcpy(extraData->bankChunk, bytes, extraData->bankChunkSize);
+    logDebug("FXB bank has chunk of %lu bytes",
+             (unsigned long)extraData->bankChunkSize);
+  } else {
+    logError("FXB bank '%s' has invalid fxMagic type", self->presetName->data);
+    return false;
+  }
+
+  extraData->isParsed = true;
+  return true;
+}
+
+static boolByte _openPluginPresetFxb(void *pluginPresetPtr) {
+  PluginPreset pluginPreset = (PluginPreset)pluginPresetPtr;
+  PluginPresetFxbData extraData =
+      (PluginPresetFxbData)(pluginPreset->extraData);
+  File bankFile = NULL;
+  byte *data = NULL;
+  size_t dataSize;
+  boolByte result;
+
+  // Presets are opened again when a plugin chain is reset, but the bank only
+  // needs to be read once
+  if (extraData->isParsed) {
+    return true;
+  }
+
+  bankFile = newFileWithPath(pluginPreset->presetName);
+  if (bankFile == NULL || !fileExists(bankFile)) {
+    logError("Preset '%s' could not be opened for reading",
+             pluginPreset->presetName->data);
+    freeFile(bankFile);
+    return false;
+  }
+
+  dataSize = fileGetSize(bankFile);
+  data = (byte *)fileReadBytes(bankFile, dataSize);
+  freeFile(bankFile);
+
+  if (data == NULL) {
+    logError("Preset '%s' could not be read", pluginPreset->presetName->data);
+    return false;
+  }
+
+  result = pluginPresetFxbParse(pluginPreset, data, dataSize);
+  free(data);
+  return result;
+}
+
+boolByte pluginPresetFxbLoadProgram(PluginPreset self, Plugin plugin,
+                                    const unsigned int programNumber) {
+  PluginPresetFxbData extraData = (PluginPresetFxbData)(self->extraData);
+  PluginPresetFxbProgram program;
+  unsigned int i;
+
+  if (!extraData->isParsed) {
+    logInternalError("FXB bank '%s' has not been opened",
+                     self->presetName->data);
+    return false;
+  } else if (programNumber >= extraData->numPrograms) {
+    logError("Cannot load program %d, FXB bank '%s' only has %d programs",
+             programNumber, self->presetName->data, extraData->numPrograms);
+    return false;
+  }
+
+  if (extraData->bankChunk != NULL) {
+    // All programs were loaded into the plugin along with the bank chunk
+    return pluginVst2xSetProgram(plugin, (int)programNumber);
+  }
+
+  program = extraData->programs[programNumber];
+  logDebug("Loading program %d ('%s') from FXB bank into plugin '%s'",
+           programNumber, program->name->data, plugin->pluginName->data);
+
+  if (program->chunk != NULL) {
+    if (plugin->interfaceType != PLUGIN_TYPE_VST_2X) {
+      logInternalError("Load FXB program chunk to wrong plugin type");
+      return false;
+    }
+
+    pluginVst2xSetProgramChunk(plugin, (char *)program->chunk,
+                               program->chunkSize);
+  } else {
+    for (i = 0; i < program->numParameters; i++) {
+      plugin->setParameter(plugin, i, program->parameters[i]);
+    }
+  }
+
+  return true;
+}
+
+static boolByte _loadPluginPresetFxb(void *pluginPresetPtr, Plugin plugin) {
+  PluginPreset pluginPreset = (PluginPreset)pluginPresetPtr;
+  PluginPresetFxbData extraData =
+      (PluginPresetFxbData)(pluginPreset->extraData);
+
+  if (extraData->fxID != pluginVst2xGetUniqueId(plugin)) {
+    logError("Preset '%s' is not compatible with plugin '%s'",
+             pluginPreset->presetName->data, plugin->pluginName->data);
+    return false;
+  }
+
+  if (extraData->fxVersion != pluginVst2xGetVersion(plugin)) {
+    logWarn("Plugin has version %ld, but bank has version %d. Loading this "
+            "bank may result in unexpected behavior!",
+            pluginVst2xGetVersion(plugin), extraData->fxVersion);
+  }
+
+  if (extraData->bankChunk != NULL) {
+    pluginVst2xSetBankChunk(plugin, (char *)extraData->bankChunk,
+                            extraData->bankChunkSize);
+  }
+
+  if (extraData->numPrograms == 0) {
+    return true;
+  }
+
+  return pluginPresetFxbLoadProgram(pluginPreset, plugin,
+                                    extraData->currentProgram);
+}
+
+static void _freePluginPresetDataFxb(void *extraDataPtr) {
+  PluginPresetFxbData extraData = extraDataPtr;
+  unsigned int i;
+
+  if (extraData->programs != NULL) {
+    for (i = 0; i < extraData->numPrograms; i++) {
+      _freePluginPresetFxbProgram(extraData->programs[i]);
+    }
+
+    free(extraData->programs);
+  }
+
+  free(extraData->bankChunk);
+}
+
+PluginPreset newPluginPresetFxb(const CharString presetName) {
+  PluginPreset pluginPreset = (PluginPreset)malloc(sizeof(PluginPresetMembers));
+  PluginPresetFxbData extraData =
+      (PluginPresetFxbData)malloc(sizeof(PluginPresetFxbDataMembers));
+
+  pluginPreset->presetType = PRESET_TYPE_FXB;
+  pluginPreset->presetName = newCharString();
+  charStringCopy(pluginPreset->presetName, presetName);
+  pluginPreset->compatiblePluginTypes = 0;
+  pluginPresetSetCompatibleWith(pluginPreset, PLUGIN_TYPE_VST_2X);
+
+  pluginPreset->openPreset = _openPluginPresetFxb;
+  pluginPreset->loadPreset = _loadPluginPresetFxb;
+  pluginPreset->freePresetData = _freePluginPresetDataFxb;
+
+  extraData->fxID = 0;
+  extraData->fxVersion = 0;
+  extraData->currentProgram = 0;
+  extraData->numPrograms = 0;
+  extraData->programs = NULL;
+  extraData->bankChunk = NULL;
+  extraData->bankChunkSize = 0;
+  extraData->isParsed = false;
+  pluginPreset->extraData = extraData;
+
+  return pluginPreset;
+}
@@ -0,0 +1,94 @@
+//
+// PluginPresetFxb.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginPresetFxb_h
+#define MrsWatson_PluginPresetFxb_h
+
+#include "plugin/PluginPreset.h"
+
+#include <stddef.h>
+
+typedef struct {
+  CharString name;
+  float *parameters;
+  unsigned int numParameters;
+  byte *chunk;
+  size_t chunkSize;
+} PluginPresetFxbProgramMembers;
+
+/**
+ * A single program from an FXB bank, which holds either parameter values or an
+ * opaque chunk of program data.
+ */
+typedef PluginPresetFxbProgramMembers *PluginPresetFxbProgram;
+
+typedef struct {
+  unsigned int fxID;
+  unsigned int fxVersion;
+  unsigned int currentProgram;
+  unsigned int numPrograms;
+  // Set for regular banks, which store each program separately
+  PluginPresetFxbProgram *programs;
+  // Set for opaque chunk banks, which store all programs in a single chunk
+  byte *bankChunk;
+  size_t bankChunkSize;
+  boolByte isParsed;
+} PluginPresetFxbDataMembers;
+typedef PluginPresetFxbDataMembers *PluginPresetFxbData;
+
+/**
+ * Create a new preset for an FXB bank file. When the preset is opened, the
+ * entire bank is read and parsed into memory, so that switching programs with
+ * pluginPresetFxbLoadProgram() does not need to access the disk.
+ * @param presetName Path to FXB file
+ * @return PluginPreset object
+ */
+PluginPreset newPluginPresetFxb(const CharString presetName);
+
+/**
+ * Parse FXB bank data which has already been read into memory. This is called
+ * when the preset is opened, and normally does not need to be called directly.
+ * @param self FXB preset
+ * @param data Bank file contents
+ * @param dataSize Size of data, in bytes
+ * @return True if the bank could be parsed
+ */
+boolByte pluginPresetFxbParse(PluginPreset self, const byte *data,
+                              const size_t dataSize);
+
+/**
+ * Switch the plugin to another program in the bank. Programs from regular
+ * banks are applied directly from memory, while for opaque chunk banks the
+ * plugin is asked to change its current program.
+ * @param self FXB preset, which must already have been loaded into the plugin
+ * @param plugin Plugin to switch
+ * @param programNumber Index of the program in the bank
+ * @return True if the program could be loaded
+ */
+boolByte pluginPresetFxbLoadProgram(PluginPreset self, Plugin plugin,
+                                    const unsigned int programNumber);
+
+#endif
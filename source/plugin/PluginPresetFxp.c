@@ -38,6 +38,14 @@ static boolByte _openPluginPresetFxp(void *pluginPresetPtr) {
   PluginPreset pluginPreset = (PluginPreset)pluginPresetPtr;
   PluginPresetFxpData extraData =
       (PluginPresetFxpData)(pluginPreset->extraData);
+
+  // Presets are loaded again when a plugin chain is reset, by which time the
+  // preset name has been replaced with the program name from the file
+  if (extraData->fileHandle != NULL) {
+    rewind(extraData->fileHandle);
+    return true;
+  }
+
   extraData->fileHandle = fopen(pluginPreset->presetName->data, "rb");
 
   if (extraData->fileHandle == NULL) {
@@ -79,6 +79,21 @@ static boolByte _pluginSilenceSetParameter(void *pluginPtr, unsigned int i,
   return false;
 }
 
+static boolByte _pluginSilenceGetParameter(void *pluginPtr, unsigned int i,
+                                           float *outValue) {
+  return false;
+}
+
+// There are no settings to copy
+static PluginState _pluginSilenceGetState(void *pluginPtr) {
+  return newPluginState();
+}
+
+static boolByte _pluginSilenceSetState(void *pluginPtr,
+                                       const PluginState state) {
+  return true;
+}
+
 Plugin newPluginSilence(const CharString pluginName) {
   Plugin plugin = _newPlugin(PLUGIN_TYPE_INTERNAL, PLUGIN_TYPE_INSTRUMENT);
   charStringCopy(plugin->pluginName, pluginName);
@@ -92,6 +107,9 @@ Plugin newPluginSilence(const CharString pluginName) {
   plugin->processAudio = _pluginSilenceProcessAudio;
   plugin->processMidiEvents = _pluginSilenceProcessMidiEvents;
   plugin->setParameter = _pluginSilenceSetParameter;
+  plugin->getParameter = _pluginSilenceGetParameter;
+  plugin->getState = _pluginSilenceGetState;
+  plugin->setState = _pluginSilenceSetState;
   plugin->closePlugin = _pluginSilenceEmpty;
   plugin->freePluginData = _pluginSilenceEmpty;
 
@@ -0,0 +1,65 @@
+//
+// PluginState.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PluginState.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+PluginState newPluginState(void) {
+  PluginState state = (PluginState)malloc(sizeof(PluginStateMembers));
+
+  state->program = PLUGIN_STATE_NO_PROGRAM;
+  state->chunk = NULL;
+  state->chunkSize = 0;
+  state->parameters = NULL;
+  state->numParameters = 0;
+
+  return state;
+}
+
+void pluginStateSetChunk(PluginState self, const void *chunk,
+                         const size_t chunkSize) {
+  free(self->chunk);
+  self->chunk = malloc(chunkSize);
+  memcpy(self->chunk, chunk, chunkSize);
+  self->chunkSize = chunkSize;
+}
+
+void pluginStateSetNumParameters(PluginState self,
+                                 const unsigned int numParameters) {
+  free(self->parameters);
+  self->parameters = (float *)calloc(numParameters, sizeof(float));
+  self->numParameters = numParameters;
+}
+
+void freePluginState(PluginState self) {
+  if (self != NULL) {
+    free(self->chunk);
+    free(self->parameters);
+    free(self);
+  }
+}
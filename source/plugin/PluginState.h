@@ -0,0 +1,82 @@
+//
+// PluginState.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginState_h
+#define MrsWatson_PluginState_h
+
+#include "base/Types.h"
+
+#include <stddef.h>
+
+#define PLUGIN_STATE_NO_PROGRAM -1
+
+typedef struct {
+  int program;
+  void *chunk;
+  size_t chunkSize;
+  float *parameters;
+  unsigned int numParameters;
+} PluginStateMembers;
+
+/**
+ * In-memory snapshot of a plugin's configuration. Depending on what the plugin
+ * supports, this holds either an opaque chunk of plugin data or the value of
+ * each parameter, plus the current program. Applying a snapshot to another
+ * instance of the same plugin gives it the same configuration, without having
+ * to load presets or set parameters again.
+ */
+typedef PluginStateMembers *PluginState;
+
+/**
+ * Create an empty plugin state with no program, chunk or parameters
+ * @return PluginState object
+ */
+PluginState newPluginState(void);
+
+/**
+ * Copy opaque plugin data into the state
+ * @param self
+ * @param chunk Data to copy
+ * @param chunkSize Size of data, in bytes
+ */
+void pluginStateSetChunk(PluginState self, const void *chunk,
+                         const size_t chunkSize);
+
+/**
+ * Allocate storage for parameter values. All values are initialized to 0.
+ * @param self
+ * @param numParameters Number of parameters
+ */
+void pluginStateSetNumParameters(PluginState self,
+                                 const unsigned int numParameters);
+
+/**
+ * Free a plugin state and all of its data
+ * @param self
+ */
+void freePluginState(PluginState self);
+
+#endif
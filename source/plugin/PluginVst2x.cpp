@@ -30,6 +30,12 @@
 #define VST_FORCE_DEPRECATED 0
 #include "aeffectx.h"
 
+#if UNIX
+#include <pthread.h>
+#elif WINDOWS
+#include <windows.h>
+#endif
+
 // C includes
 extern "C" {
 #include "PluginVst2x.h"
@@ -42,6 +48,8 @@ extern "C" {
 #include "midi/MidiEvent.h"
 #include "plugin/Plugin.h"
 #include "plugin/PluginVst2xId.h"
+#include "plugin/PluginVst2xIndex.h"
+#include "plugin/PluginVst2xScanner.h"
 
 extern LinkedList getVst2xPluginLocations(CharString currentDirectory);
 extern LibraryHandle
@@ -81,11 +89,35 @@ extern "C" {
 // host (in fact, calling the plugin's main() *returns* the AEffect* which we
 // save in our extraData struct). Therefore it is not possible to have the
 // plugin reach our host callback with some custom data, and we must keep a
-// global variable to the current effect ID.  That said, this prevents
-// initializing plugins in multiple threads in the future, as as we must set
-// this to the correct ID before calling the plugin's main() function when
-// setting up the effect chain.
-VstInt32 currentPluginUniqueId;
+// variable with the current effect ID, which must be set to the correct ID
+// before calling the plugin's main() function. The plugin asks for the ID
+// from the thread which is loading it, so each thread has its own copy and
+// plugins may be opened from several threads at once.
+THREAD_LOCAL VstInt32 currentPluginUniqueId;
+
+// Guards the plugin index, which is looked up and updated while opening
+// plugins
+#if UNIX
+static pthread_mutex_t gPluginVst2xIndexLock = PTHREAD_MUTEX_INITIALIZER;
+#elif WINDOWS
+static SRWLOCK gPluginVst2xIndexLock = SRWLOCK_INIT;
+#endif
+
+static void _lockPluginVst2xIndex(void) {
+#if UNIX
+  pthread_mutex_lock(&gPluginVst2xIndexLock);
+#elif WINDOWS
+  AcquireSRWLockExclusive(&gPluginVst2xIndexLock);
+#endif
+}
+
+static void _unlockPluginVst2xIndex(void) {
+#if UNIX
+  pthread_mutex_unlock(&gPluginVst2xIndexLock);
+#elif WINDOWS
+  ReleaseSRWLockExclusive(&gPluginVst2xIndexLock);
+#endif
+}
 
 const char *_getVst2xPlatformExtension(void);
 const char *_getVst2xPlatformExtension(void) {
@@ -161,7 +193,73 @@ static void _listPluginsVst2xInLocation(void *item, void *userData) {
   freeLinkedListAndItems(locationItems, (LinkedListFreeItemFunc)freeFile);
 }
 
+static void _logPluginVst2xIndexEntry(void *item, void *userData) {
+  PluginVst2xIndexEntry entry = (PluginVst2xIndexEntry)item;
+  CharString lastLocation = (CharString)userData;
+  CharString location = newCharStringWithCString(entry->absolutePath->data);
+  char *pluginName = strrchr(location->data, PATH_DELIMITER);
+  char *dot;
+
+  if (pluginName != NULL) {
+    *pluginName = '\0';
+    pluginName++;
+  } else {
+    pluginName = location->data;
+  }
+
+  if (!charStringIsEqualTo(location, lastLocation, false)) {
+    _logPluginLocation(location);
+    charStringCopy(lastLocation, location);
+  }
+
+  dot = strrchr(pluginName, '.');
+  if (dot != NULL) {
+    *dot = '\0';
+  }
+
+  if (entry->status != PLUGIN_VST2X_INDEX_STATUS_OK) {
+    logInfo("  %s (scan %s)", pluginName,
+            pluginVst2xIndexStatusToString(entry->status));
+    freeCharString(location);
+    return;
+  }
+
+  PluginVst2xId pluginId = newPluginVst2xIdWithId(entry->uniqueId);
+  logInfo("  %s ('%s', %s, I/O %d/%d)", pluginName, pluginId->idString->data,
+          entry->pluginType == PLUGIN_TYPE_INSTRUMENT ? "instrument" : "effect",
+          entry->numInputs, entry->numOutputs);
+  freePluginVst2xId(pluginId);
+
+  for (LinkedListIterator iterator = entry->shellPluginIds;
+       iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    PluginVst2xId shellPluginId = (PluginVst2xId)iterator->item;
+    logInfo("    %s%c%s", pluginName, kPluginVst2xSubpluginSeparator,
+            shellPluginId->idString->data);
+  }
+
+  freeCharString(location);
+}
+
 void listAvailablePluginsVst2x(const CharString pluginRoot) {
+  PluginVst2xIndex index = getPluginVst2xIndex();
+
+  // Listing from the index is much faster than searching all plugin locations,
+  // but only an index built by --scan-plugins lists every plugin. Plugins which
+  // were opened since then are also indexed, but a plugin which was changed
+  // must be scanned again.
+  if (index != NULL && index->isComplete &&
+      pluginVst2xIndexRemoveStaleEntries(index) &&
+      linkedListLength(index->entries) > 0) {
+    CharString lastLocation = newCharString();
+    logInfo("Listing plugins from index '%s', run with --scan-plugins to "
+            "refresh it",
+            index->indexPath->data);
+    linkedListForeach(index->entries, _logPluginVst2xIndexEntry, lastLocation);
+    freeCharString(lastLocation);
+    return;
+  }
+
   if (!charStringIsEmpty(pluginRoot)) {
     _listPluginsVst2xInLocation(pluginRoot, NULL);
   }
@@ -236,6 +334,23 @@ static boolByte _doesVst2xPluginExistAtLocation(const CharString pluginName,
 
 static CharString _getVst2xPluginLocation(const CharString pluginName,
                                           const CharString pluginRoot) {
+  // Try the plugin index first, which avoids searching all plugin locations
+  PluginVst2xIndexEntry indexEntry =
+      pluginVst2xIndexFind(getPluginVst2xIndex(), pluginName, pluginRoot);
+
+  if (indexEntry != NULL) {
+    CharString result =
+        newCharStringWithCString(indexEntry->absolutePath->data);
+    char *delimiter = strrchr(result->data, PATH_DELIMITER);
+
+    if (delimiter != NULL) {
+      *delimiter = '\0';
+    }
+
+    logDebug("Found plugin '%s' in index", pluginName->data);
+    return result;
+  }
+
   File pluginAbsolutePath = newFileWithPath(pluginName);
 
   if (fileExists(pluginAbsolutePath)) {
@@ -460,6 +575,106 @@ void pluginVst2xAudioMasterIOChanged(const Plugin self,
   }
 }
 
+static LinkedList _getCommonCanDos(void) {
+  LinkedList result = newLinkedList();
+  linkedListAppend(result, (char *)"sendVstEvents");
+  linkedListAppend(result, (char *)"sendVstMidiEvent");
+  linkedListAppend(result, (char *)"receiveVstEvents");
+  linkedListAppend(result, (char *)"receiveVstMidiEvent");
+  linkedListAppend(result, (char *)"receiveVstTimeInfo");
+  linkedListAppend(result, (char *)"offline");
+  linkedListAppend(result, (char *)"midiProgramNames");
+  linkedListAppend(result, (char *)"bypass");
+  return result;
+}
+
+static PluginVst2xIndexEntry _newVst2xPluginIndexEntry(Plugin plugin) {
+  PluginVst2xData data = (PluginVst2xData)plugin->extraData;
+  PluginVst2xIndexEntry entry = newPluginVst2xIndexEntry();
+  CharString nameBuffer = newCharStringWithCapacity(kCharStringLengthShort);
+
+  charStringCopy(entry->absolutePath, plugin->pluginAbsolutePath);
+  File pluginFile = newFileWithPath(plugin->pluginAbsolutePath);
+  if (pluginFile != NULL) {
+    entry->modifiedTime = fileGetModifiedTime(pluginFile);
+    freeFile(pluginFile);
+  }
+
+  entry->uniqueId = (unsigned long)data->pluginHandle->uniqueID;
+  entry->version = (unsigned long)data->pluginHandle->version;
+  entry->pluginType = plugin->pluginType;
+  entry->numInputs = data->pluginHandle->numInputs;
+  entry->numOutputs = data->pluginHandle->numOutputs;
+
+  if (data->isPluginShell) {
+    while (true) {
+      charStringClear(nameBuffer);
+      VstInt32 shellPluginId =
+          (VstInt32)data->dispatcher(data->pluginHandle, effShellGetNextPlugin,
+                                     0, 0, nameBuffer->data, 0.0f);
+
+      if (shellPluginId == 0 || charStringIsEmpty(nameBuffer)) {
+        break;
+      }
+
+      linkedListAppend(entry->shellPluginIds,
+                       newPluginVst2xIdWithId((unsigned long)shellPluginId));
+    }
+  } else {
+    for (VstInt32 i = 0; i < data->pluginHandle->numParams; i++) {
+      charStringClear(nameBuffer);
+      data->dispatcher(data->pluginHandle, effGetParamName, i, 0,
+                       nameBuffer->data, 0.0f);
+      linkedListAppend(entry->parameterNames,
+                       newCharStringWithCString(nameBuffer->data));
+    }
+
+    LinkedList commonCanDos = _getCommonCanDos();
+    for (LinkedListIterator iterator = commonCanDos;
+         iterator != NULL && iterator->item != NULL;
+         iterator = (LinkedListIterator)iterator->nextItem) {
+      char *canDoString = (char *)iterator->item;
+
+      if (_canPluginDo(plugin, canDoString) == 1) {
+        linkedListAppend(entry->canDos, newCharStringWithCString(canDoString));
+      }
+    }
+
+    freeLinkedList(commonCanDos);
+  }
+
+  freeCharString(nameBuffer);
+  return entry;
+}
+
+/**
+ * Add an opened plugin to the plugin index, if the index is being used and the
+ * plugin is not already indexed. Shell plugins are skipped, since enumerating
+ * their sub-plugins changes the state of the shell. Those are only indexed by
+ * scanning, where the plugin is thrown away afterwards.
+ * @param plugin Plugin, which must be opened
+ * @return True if the index was changed
+ */
+static boolByte _updateVst2xPluginIndex(Plugin plugin) {
+  PluginVst2xData data = (PluginVst2xData)plugin->extraData;
+  PluginVst2xIndex index = getPluginVst2xIndex();
+  PluginVst2xIndexEntry entry = NULL;
+
+  if (index == NULL || data->isPluginShell) {
+    return false;
+  }
+
+  entry = pluginVst2xIndexFindPath(index, plugin->pluginAbsolutePath);
+  if (entry != NULL && entry->status == PLUGIN_VST2X_INDEX_STATUS_OK &&
+      pluginVst2xIndexEntryIsValid(entry)) {
+    return false;
+  }
+
+  logDebug("Adding plugin '%s' to index", plugin->pluginAbsolutePath->data);
+  pluginVst2xIndexAdd(index, _newVst2xPluginIndexEntry(plugin));
+  return true;
+}
+
 static boolByte _openVst2xPlugin(void *pluginPtr) {
   boolByte result = false;
   AEffect *pluginHandle;
@@ -481,7 +696,6 @@ static boolByte _openVst2xPlugin(void *pluginPtr) {
     strncpy(subpluginIdString->data, subpluginSeparator + 1, 4);
     PluginVst2xId subpluginId = newPluginVst2xIdWithStringId(subpluginIdString);
     data->shellPluginId = (VstInt32)subpluginId->id;
-    currentPluginUniqueId = data->shellPluginId;
     freePluginVst2xId(subpluginId);
   }
 
@@ -489,7 +703,21 @@ static boolByte _openVst2xPlugin(void *pluginPtr) {
   CharString pluginBasename = fileGetBasename(pluginPath);
   logInfo("Opening VST2.x plugin '%s'", plugin->pluginName->data);
 
-  if (fileExists(pluginPath)) {
+  _lockPluginVst2xIndex();
+  PluginVst2xIndexEntry indexEntry = pluginVst2xIndexFind(
+      getPluginVst2xIndex(), plugin->pluginName, plugin->pluginLocation);
+  boolByte isIndexed = (boolByte)(indexEntry != NULL);
+
+  if (isIndexed) {
+    charStringCopy(plugin->pluginAbsolutePath, indexEntry->absolutePath);
+  }
+
+  _unlockPluginVst2xIndex();
+
+  if (isIndexed) {
+    freeFile(pluginPath);
+    pluginPath = newFileWithPath(plugin->pluginAbsolutePath);
+  } else if (fileExists(pluginPath)) {
     charStringCopy(plugin->pluginAbsolutePath, pluginPath->absolutePath);
   } else {
     File pluginLocationPath = newFileWithPath(plugin->pluginLocation);
@@ -521,6 +749,9 @@ static boolByte _openVst2xPlugin(void *pluginPtr) {
     return false;
   }
 
+  // Make sure that shell plugins don't get the sub-plugin ID of a plugin which
+  // was previously opened on this thread
+  currentPluginUniqueId = data->shellPluginId;
   pluginHandle = loadVst2xPlugin(data->libraryHandle);
   if (pluginHandle == NULL) {
     logError("Could not load VST2.x plugin '%s'",
@@ -550,11 +781,17 @@ static boolByte _openVst2xPlugin(void *pluginPtr) {
   } else {
     data->dispatcher = (Vst2xPluginDispatcherFunc)(pluginHandle->dispatcher);
     data->pluginHandle = pluginHandle;
+    // This field is reserved for the host, and lets the host callback find
+    // the plugin which is calling it
+    pluginHandle->resvd1 = (VstIntPtr)plugin;
     result = _initVst2xPlugin(plugin);
 
     if (result) {
       data->pluginId =
           newPluginVst2xIdWithId((unsigned long)data->pluginHandle->uniqueID);
+      _lockPluginVst2xIndex();
+      _updateVst2xPluginIndex(plugin);
+      _unlockPluginVst2xIndex();
     }
   }
 
@@ -562,19 +799,6 @@ static boolByte _openVst2xPlugin(void *pluginPtr) {
   return result;
 }
 
-static LinkedList _getCommonCanDos(void) {
-  LinkedList result = newLinkedList();
-  linkedListAppend(result, (char *)"sendVstEvents");
-  linkedListAppend(result, (char *)"sendVstMidiEvent");
-  linkedListAppend(result, (char *)"receiveVstEvents");
-  linkedListAppend(result, (char *)"receiveVstMidiEvent");
-  linkedListAppend(result, (char *)"receiveVstTimeInfo");
-  linkedListAppend(result, (char *)"offline");
-  linkedListAppend(result, (char *)"midiProgramNames");
-  linkedListAppend(result, (char *)"bypass");
-  return result;
-}
-
 static const char *_prettyTextForCanDoResult(int result) {
   if (result == -1) {
     return "No";
@@ -716,12 +940,14 @@ static int _getVst2xPluginSetting(void *pluginPtr,
         data->pluginHandle, effGetTailSize, 0, 0, NULL, 0.0f);
 
     // For some reason, the VST SDK says that plugins return a 1 here for no
-    // tail.
-    if (tailSize == 1 || tailSize == 0) {
+    // tail. 0 is the default, and means that the tail size is unknown.
+    if (tailSize == 1) {
       return 0;
+    } else if (tailSize == 0) {
+      return PLUGIN_TAIL_TIME_UNKNOWN;
     } else {
       // If tailSize is not 0 or 1, then it is assumed to be in samples
-      return (int)((double)tailSize * getSampleRate() / 1000.0f);
+      return (int)((double)tailSize * 1000.0 / getSampleRate());
     }
   }
 
@@ -746,6 +972,12 @@ void pluginVst2xSetProgramChunk(Plugin plugin, char *chunk, size_t chunkSize) {
                    chunk, 0.0f);
 }
 
+void pluginVst2xSetBankChunk(Plugin plugin, char *chunk, size_t chunkSize) {
+  PluginVst2xData data = (PluginVst2xData)plugin->extraData;
+  data->dispatcher(data->pluginHandle, effSetChunk, 0, (VstIntPtr)chunkSize,
+                   chunk, 0.0f);
+}
+
 static void _processAudioVst2xPlugin(void *pluginPtr, SampleBuffer inputs,
                                      SampleBuffer outputs) {
   Plugin plugin = (Plugin)pluginPtr;
@@ -901,6 +1133,86 @@ static boolByte _setParameterVst2xPlugin(void *pluginPtr, unsigned int index,
   }
 }
 
+static boolByte _getParameterVst2xPlugin(void *pluginPtr, unsigned int index,
+                                         float *outValue) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginVst2xData data = (PluginVst2xData)(plugin->extraData);
+
+  if (index < (unsigned int)data->pluginHandle->numParams) {
+    *outValue = data->pluginHandle->getParameter(data->pluginHandle, index);
+    return true;
+  } else {
+    return false;
+  }
+}
+
+static PluginState _getStateVst2xPlugin(void *pluginPtr) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginVst2xData data = (PluginVst2xData)(plugin->extraData);
+  PluginState state = newPluginState();
+  void *chunk = NULL;
+
+  if (data->pluginHandle->numPrograms > 0) {
+    state->program = (int)data->dispatcher(data->pluginHandle, effGetProgram, 0,
+                                           0, NULL, 0.0f);
+  }
+
+  // Plugins which store their state in chunks may have internal settings
+  // which are not exposed as parameters, so prefer the chunk when possible.
+  if (data->pluginHandle->flags & effFlagsProgramChunks) {
+    VstIntPtr chunkSize = data->dispatcher(data->pluginHandle, effGetChunk, 0,
+                                           0, &chunk, 0.0f);
+
+    if (chunkSize > 0 && chunk != NULL) {
+      pluginStateSetChunk(state, chunk, (size_t)chunkSize);
+      logDebug("Captured %ld byte chunk from plugin '%s'", (long)chunkSize,
+               plugin->pluginName->data);
+      return state;
+    }
+  }
+
+  pluginStateSetNumParameters(state,
+                              (unsigned int)data->pluginHandle->numParams);
+  for (unsigned int i = 0; i < state->numParameters; i++) {
+    state->parameters[i] =
+        data->pluginHandle->getParameter(data->pluginHandle, (VstInt32)i);
+  }
+
+  logDebug("Captured %d parameters from plugin '%s'", state->numParameters,
+           plugin->pluginName->data);
+  return state;
+}
+
+static boolByte _setStateVst2xPlugin(void *pluginPtr, const PluginState state) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginVst2xData data = (PluginVst2xData)(plugin->extraData);
+
+  if (state->numParameters > (unsigned int)data->pluginHandle->numParams) {
+    logError("State has %d parameters, but plugin '%s' only has %d",
+             state->numParameters, plugin->pluginName->data,
+             data->pluginHandle->numParams);
+    return false;
+  }
+
+  // The bank chunk also contains the current program, so set that afterwards
+  if (state->chunk != NULL) {
+    data->dispatcher(data->pluginHandle, effSetChunk, 0,
+                     (VstIntPtr)state->chunkSize, state->chunk, 0.0f);
+  }
+
+  if (state->program != PLUGIN_STATE_NO_PROGRAM &&
+      !pluginVst2xSetProgram(plugin, state->program)) {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < state->numParameters; i++) {
+    data->pluginHandle->setParameter(data->pluginHandle, (VstInt32)i,
+                                     state->parameters[i]);
+  }
+
+  return true;
+}
+
 static void _prepareForProcessingVst2xPlugin(void *pluginPtr) {
   Plugin plugin = (Plugin)pluginPtr;
   _resumePlugin(plugin);
@@ -953,11 +1265,18 @@ static void _closeVst2xPlugin(void *pluginPtr) {
 static void _freeVst2xPluginData(void *pluginDataPtr) {
   PluginVst2xData data = (PluginVst2xData)(pluginDataPtr);
 
-  data->dispatcher(data->pluginHandle, effClose, 0, 0, NULL, 0.0f);
+  // Plugins which could not be opened may not have a dispatcher or library
+  if (data->dispatcher != NULL) {
+    data->dispatcher(data->pluginHandle, effClose, 0, 0, NULL, 0.0f);
+  }
+
   data->dispatcher = NULL;
   data->pluginHandle = NULL;
   freePluginVst2xId(data->pluginId);
-  closeLibraryHandle(data->libraryHandle);
+
+  if (data->libraryHandle != NULL) {
+    closeLibraryHandle(data->libraryHandle);
+  }
 
   if (data->vstEvents != NULL) {
     for (int i = 0; i < data->vstEvents->numEvents; i++) {
@@ -968,12 +1287,12 @@ static void _freeVst2xPluginData(void *pluginDataPtr) {
   }
 }
 
-Plugin newPluginVst2x(const CharString pluginName,
-                      const CharString pluginRoot) {
+static Plugin _newPluginVst2xAtLocation(const CharString pluginName,
+                                        CharString pluginLocation) {
   Plugin plugin = _newPlugin(PLUGIN_TYPE_VST_2X, PLUGIN_TYPE_UNKNOWN);
   charStringCopy(plugin->pluginName, pluginName);
   freeCharString(plugin->pluginLocation);
-  plugin->pluginLocation = _getVst2xPluginLocation(pluginName, pluginRoot);
+  plugin->pluginLocation = pluginLocation;
 
   plugin->openPlugin = _openVst2xPlugin;
   plugin->displayInfo = _displayVst2xPluginInfo;
@@ -981,6 +1300,9 @@ Plugin newPluginVst2x(const CharString pluginName,
   plugin->processAudio = _processAudioVst2xPlugin;
   plugin->processMidiEvents = _processMidiEventsVst2xPlugin;
   plugin->setParameter = _setParameterVst2xPlugin;
+  plugin->getParameter = _getParameterVst2xPlugin;
+  plugin->getState = _getStateVst2xPlugin;
+  plugin->setState = _setStateVst2xPlugin;
   plugin->prepareForProcessing = _prepareForProcessingVst2xPlugin;
   plugin->showEditor = _showVst2xEditor;
   plugin->closePlugin = _closeVst2xPlugin;
@@ -1001,4 +1323,134 @@ Plugin newPluginVst2x(const CharString pluginName,
 
   return plugin;
 }
+
+Plugin newPluginVst2x(const CharString pluginName,
+                      const CharString pluginRoot) {
+  return _newPluginVst2xAtLocation(
+      pluginName, _getVst2xPluginLocation(pluginName, pluginRoot));
+}
+
+Plugin newPluginVst2xWithPlugin(const Plugin other) {
+  PluginVst2xData otherData = (PluginVst2xData)other->extraData;
+  CharString pluginName =
+      newCharStringWithCString(other->pluginAbsolutePath->data);
+  const char separator[2] = {kPluginVst2xSubpluginSeparator, '\0'};
+  Plugin plugin;
+
+  // Open the clone directly from the library which was already found, and for
+  // shell plugins, select the same sub-plugin.
+  if (otherData->shellPluginId) {
+    PluginVst2xId shellPluginId =
+        newPluginVst2xIdWithId((unsigned long)otherData->shellPluginId);
+    charStringAppendCString(pluginName, separator);
+    charStringAppend(pluginName, shellPluginId->idString);
+    freePluginVst2xId(shellPluginId);
+  }
+
+  plugin = _newPluginVst2xAtLocation(
+      pluginName, other->pluginLocation != NULL
+                      ? newCharStringWithCString(other->pluginLocation->data)
+                      : NULL);
+  freeCharString(pluginName);
+  return plugin;
+}
+
+static PluginVst2xIndexEntry _probeVst2xPlugin(const CharString pluginPath) {
+  PluginVst2xIndexEntry entry = NULL;
+  Plugin plugin = newPluginVst2x(pluginPath, NULL);
+
+  if (plugin->openPlugin(plugin)) {
+    entry = _newVst2xPluginIndexEntry(plugin);
+  }
+
+  freePlugin(plugin);
+  return entry;
+}
+
+static void _findPluginsVst2xInLocation(void *item, void *userData) {
+  CharString locationString = (CharString)item;
+  LinkedList pluginPaths = (LinkedList)userData;
+  File location = newFileWithPath(locationString);
+  const char *platformExtension = _getVst2xPlatformExtension();
+
+  if (location == NULL || !fileExists(location) ||
+      location->fileType != kFileTypeDirectory ||
+      strlen(platformExtension) == 0) {
+    freeFile(location);
+    return;
+  }
+
+  LinkedList locationItems = fileListDirectory(location);
+  for (LinkedListIterator iterator = locationItems;
+       iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    File itemFile = (File)iterator->item;
+    CharString extension = fileGetExtension(itemFile);
+    boolByte alreadyFound = false;
+
+    // The extension returned by fileGetExtension() does not include the dot
+    if (extension == NULL ||
+        !charStringIsEqualToCString(extension, platformExtension + 1, true)) {
+      freeCharString(extension);
+      continue;
+    }
+
+    freeCharString(extension);
+
+    // The same directory may appear more than once in the plugin locations
+    for (LinkedListIterator pathIterator = pluginPaths;
+         pathIterator != NULL && pathIterator->item != NULL;
+         pathIterator = (LinkedListIterator)pathIterator->nextItem) {
+      if (charStringIsEqualTo((CharString)pathIterator->item,
+                              itemFile->absolutePath, false)) {
+        alreadyFound = true;
+        break;
+      }
+    }
+
+    if (!alreadyFound) {
+      linkedListAppend(pluginPaths, newCharStringWithCString(
+                                        itemFile->absolutePath->data));
+    }
+  }
+
+  freeLinkedListAndItems(locationItems, (LinkedListFreeItemFunc)freeFile);
+  freeFile(location);
+}
+
+boolByte scanAvailablePluginsVst2x(const CharString pluginRoot,
+                                   const unsigned int maxJobs,
+                                   const unsigned long timeoutInMs) {
+  PluginVst2xIndex index = getPluginVst2xIndex();
+  LinkedList pluginPaths = newLinkedList();
+
+  if (index == NULL) {
+    logError("Plugin index has not been initialized");
+    freeLinkedList(pluginPaths);
+    return false;
+  }
+
+  if (!charStringIsEmpty(pluginRoot)) {
+    _findPluginsVst2xInLocation(pluginRoot, pluginPaths);
+  }
+
+  LinkedList pluginLocations =
+      getVst2xPluginLocations(fileGetCurrentDirectory());
+  linkedListForeach(pluginLocations, _findPluginsVst2xInLocation, pluginPaths);
+  freeLinkedListAndItems(pluginLocations,
+                         (LinkedListFreeItemFunc)freeCharString);
+
+  PluginVst2xScanner scanner =
+      newPluginVst2xScanner(_probeVst2xPlugin, maxJobs, timeoutInMs);
+  pluginVst2xIndexClear(index);
+  unsigned int numScanned =
+      pluginVst2xScannerRun(scanner, pluginPaths, index);
+  index->isComplete = true;
+  logInfo("Scanned %u of %d VST2.x plugins", numScanned,
+          linkedListLength(pluginPaths));
+
+  freePluginVst2xScanner(scanner);
+  freeLinkedListAndItems(pluginPaths, (LinkedListFreeItemFunc)freeCharString);
+  return pluginVst2xIndexSave(index);
+}
 }
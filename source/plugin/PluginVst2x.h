@@ -39,6 +39,22 @@ static const char kPluginVst2xSubpluginSeparator = ':';
  */
 void listAvailablePluginsVst2x(const CharString pluginRoot);
 
+/**
+ * Load all VST2.x plugins found in the plugin root and common system locations
+ * and rebuild the plugin index from their metadata. Plugins are loaded in
+ * separate processes, so plugins which crash or hang are recorded in the index
+ * as such rather than aborting the scan. The plugin index must have been
+ * initialized before calling this function.
+ * @param pluginRoot User-provided plugin root path to search
+ * @param maxJobs Number of plugins to scan in parallel, or 0 to use one per
+ * processor
+ * @param timeoutInMs Time limit for loading each plugin, or 0 for the default
+ * @return True if the index was rebuilt and saved
+ */
+boolByte scanAvailablePluginsVst2x(const CharString pluginRoot,
+                                   const unsigned int maxJobs,
+                                   const unsigned long timeoutInMs);
+
 /**
  * Create a new instance of a VST 2.x plugin
  * @param pluginName Plugin name
@@ -47,6 +63,15 @@ void listAvailablePluginsVst2x(const CharString pluginRoot);
  */
 Plugin newPluginVst2x(const CharString pluginName, const CharString pluginRoot);
 
+/**
+ * Create a new instance of a VST 2.x plugin which has already been opened.
+ * This avoids searching for the plugin again, and should be used together with
+ * the plugin's getState() and setState() functions to clone plugins.
+ * @param other Open VST 2.x plugin
+ * @return Initialized Plugin object, which must still be opened
+ */
+Plugin newPluginVst2xWithPlugin(const Plugin other);
+
 /**
  * Get the VST2.x unique ID
  * @param self
@@ -90,4 +115,13 @@ boolByte pluginVst2xSetProgram(Plugin self, const int programNumber);
  */
 void pluginVst2xSetProgramChunk(Plugin self, char *chunk, size_t chunkSize);
 
+/**
+ * Set chunk data for an entire bank, as found in FXB bank files, to a VST2.x
+ * plugin.
+ * @param self
+ * @param chunk Chunk data to set
+ * @param chunkSize Chunk size
+ */
+void pluginVst2xSetBankChunk(Plugin self, char *chunk, size_t chunkSize);
+
 #endif
@@ -56,15 +56,16 @@ void pluginVst2xAudioMasterIOChanged(const Plugin self,
 // were the case, a huge number of plugins would probably fail to do this and
 // leak memory all over the place. Anyways, since we cannot scope this variable
 // intelligently, we instead keep one instance of it as a static variable, so it
-// is always available to plugins when they ask for the time.
-static VstTimeInfo vstTimeInfo;
+// is always available to plugins when they ask for the time. Each thread has
+// its own instance, as plugins of different sessions may ask at the same time.
+static THREAD_LOCAL VstTimeInfo vstTimeInfo;
 
 extern "C" {
 
 // Current plugin ID, which is mostly used by shell plugins during
 // initialization. See PluginVst2x.cpp for more details, including why this
-// must be global.
-extern VstInt32 currentPluginUniqueId;
+// cannot be stored with the plugin.
+extern THREAD_LOCAL VstInt32 currentPluginUniqueId;
 
 static int _canHostDo(const char *pluginName, const char *canDoString) {
   boolByte supported = false;
@@ -111,9 +112,9 @@ static int _canHostDo(const char *pluginName, const char *canDoString) {
   return supported;
 }
 
-VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
-                                              VstInt32 index, VstIntPtr value,
-                                              void *dataPtr, float opt) {
+static VstIntPtr _dispatchHostOpcode(AEffect *effect, VstInt32 opcode,
+                                     VstInt32 index, VstIntPtr value,
+                                     void *dataPtr, float opt) {
   // This string is used in a bunch of logging calls below
   PluginVst2xId pluginId;
 
@@ -191,16 +192,14 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
     }
 
     if (value & kVstPpqPosValid) {
-      // TODO: Move calculations to AudioClock
-      double samplesPerBeat = (60.0 / getTempo()) * getSampleRate();
       // Musical time starts with 1, not 0
-      vstTimeInfo.ppqPos = (vstTimeInfo.samplePos / samplesPerBeat) + 1.0;
+      vstTimeInfo.ppqPos = audioClockGetBeatPosition(audioClock) + 1.0;
       logDebug("Current PPQ position is %g", vstTimeInfo.ppqPos);
       vstTimeInfo.flags |= kVstPpqPosValid;
     }
 
     if (value & kVstTempoValid) {
-      vstTimeInfo.tempo = getTempo();
+      vstTimeInfo.tempo = audioClockGetTempo(audioClock);
       vstTimeInfo.flags |= kVstTempoValid;
     }
 
@@ -209,9 +208,9 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
         logError("Plugin requested position in bars, but not PPQ");
       }
 
-      // TODO: Move calculations to AudioClock
       double currentBarPos =
-          floor(vstTimeInfo.ppqPos / (double)getTimeSignatureBeatsPerMeasure());
+          floor(audioClockGetBeatPosition(audioClock) /
+                (double)getTimeSignatureBeatsPerMeasure());
       vstTimeInfo.barStartPos =
           currentBarPos * (double)getTimeSignatureBeatsPerMeasure() + 1.0;
       logDebug("Current bar is %g", vstTimeInfo.barStartPos);
@@ -459,4 +458,32 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
   freePluginVst2xId(pluginId);
   return result;
 }
+
+VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
+                                              VstInt32 index, VstIntPtr value,
+                                              void *dataPtr, float opt) {
+  // Set while the plugin is being opened, see _openVst2xPlugin()
+  Plugin plugin = effect != NULL ? (Plugin)effect->resvd1 : NULL;
+  AudioSettings previousSettings = NULL;
+  AudioClock previousClock = NULL;
+  boolByte hasOwnSettings = false;
+
+  // The plugin may call from a thread of its own, which does not know the
+  // settings and timeline of the host which runs the plugin
+  if (plugin != NULL && plugin->audioSettings != NULL) {
+    previousSettings = setThreadAudioSettings(plugin->audioSettings);
+    previousClock = setThreadAudioClock(plugin->audioClock);
+    hasOwnSettings = true;
+  }
+
+  VstIntPtr result =
+      _dispatchHostOpcode(effect, opcode, index, value, dataPtr, opt);
+
+  if (hasOwnSettings) {
+    setThreadAudioSettings(previousSettings);
+    setThreadAudioClock(previousClock);
+  }
+
+  return result;
+}
 } // extern "C"
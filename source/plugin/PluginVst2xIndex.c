@@ -0,0 +1,740 @@
+//
+// PluginVst2xIndex.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PluginVst2xIndex.h"
+
+#include "base/File.h"
+#include "logging/EventLogger.h"
+#include "plugin/PluginVst2x.h"
+#include "plugin/PluginVst2xId.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if UNIX
+#include <sys/stat.h>
+#include <unistd.h>
+#elif WINDOWS
+#include <process.h>
+#define getpid _getpid
+#endif
+
+#if WINDOWS
+#define PLUGIN_VST2X_INDEX_HOME_VARIABLE "APPDATA"
+#define PLUGIN_VST2X_INDEX_DIRECTORY "MrsWatson"
+#else
+#define PLUGIN_VST2X_INDEX_HOME_VARIABLE "HOME"
+#define PLUGIN_VST2X_INDEX_DIRECTORY ".mrswatson"
+#endif
+
+static const char *kPluginVst2xIndexKeyIndex = "index";
+static const char *kPluginVst2xIndexKeyComplete = "complete";
+static const char *kPluginVst2xIndexKeyPlugin = "plugin";
+static const char *kPluginVst2xIndexKeyModifiedTime = "mtime";
+static const char *kPluginVst2xIndexKeyStatus = "status";
+static const char *kPluginVst2xIndexKeyUniqueId = "id";
+static const char *kPluginVst2xIndexKeyVersion = "version";
+static const char *kPluginVst2xIndexKeyType = "type";
+static const char *kPluginVst2xIndexKeyInputs = "inputs";
+static const char *kPluginVst2xIndexKeyOutputs = "outputs";
+static const char *kPluginVst2xIndexKeyShellPlugin = "shell";
+static const char *kPluginVst2xIndexKeyParameter = "param";
+static const char *kPluginVst2xIndexKeyCanDo = "cando";
+
+PluginVst2xIndex pluginVst2xIndexInstance = NULL;
+
+PluginVst2xIndexEntry newPluginVst2xIndexEntry(void) {
+  PluginVst2xIndexEntry entry =
+      (PluginVst2xIndexEntry)malloc(sizeof(PluginVst2xIndexEntryMembers));
+
+  entry->absolutePath = newCharString();
+  entry->modifiedTime = 0;
+  entry->status = PLUGIN_VST2X_INDEX_STATUS_OK;
+  entry->uniqueId = 0;
+  entry->version = 0;
+  entry->pluginType = PLUGIN_TYPE_UNKNOWN;
+  entry->numInputs = 0;
+  entry->numOutputs = 0;
+  entry->shellPluginIds = newLinkedList();
+  entry->parameterNames = newLinkedList();
+  entry->canDos = newLinkedList();
+
+  return entry;
+}
+
+const char *
+pluginVst2xIndexStatusToString(const PluginVst2xIndexStatus status) {
+  switch (status) {
+  case PLUGIN_VST2X_INDEX_STATUS_OK:
+    return "ok";
+
+  case PLUGIN_VST2X_INDEX_STATUS_FAILED:
+    return "failed";
+
+  case PLUGIN_VST2X_INDEX_STATUS_TIMED_OUT:
+    return "timeout";
+
+  case PLUGIN_VST2X_INDEX_STATUS_CRASHED:
+    return "crashed";
+
+  default:
+    return "unknown";
+  }
+}
+
+static PluginVst2xIndexStatus
+_getPluginVst2xIndexStatusFromName(const char *name) {
+  int i;
+
+  for (i = 0; i < NUM_PLUGIN_VST2X_INDEX_STATUSES; i++) {
+    if (!strcmp(name,
+                pluginVst2xIndexStatusToString((PluginVst2xIndexStatus)i))) {
+      return (PluginVst2xIndexStatus)i;
+    }
+  }
+
+  return PLUGIN_VST2X_INDEX_STATUS_FAILED;
+}
+
+boolByte pluginVst2xIndexEntryIsValid(const PluginVst2xIndexEntry self) {
+  File pluginFile = NULL;
+  unsigned long modifiedTime;
+
+  if (self == NULL || charStringIsEmpty(self->absolutePath)) {
+    return false;
+  }
+
+  pluginFile = newFileWithPath(self->absolutePath);
+  if (pluginFile == NULL) {
+    return false;
+  }
+
+  modifiedTime = fileGetModifiedTime(pluginFile);
+  freeFile(pluginFile);
+  return (boolByte)(modifiedTime != 0 && modifiedTime == self->modifiedTime);
+}
+
+void freePluginVst2xIndexEntry(PluginVst2xIndexEntry self) {
+  if (self != NULL) {
+    freeCharString(self->absolutePath);
+    freeLinkedListAndItems(self->shellPluginIds,
+                           (LinkedListFreeItemFunc)freePluginVst2xId);
+    freeLinkedListAndItems(self->parameterNames,
+                           (LinkedListFreeItemFunc)freeCharString);
+    freeLinkedListAndItems(self->canDos,
+                           (LinkedListFreeItemFunc)freeCharString);
+    free(self);
+  }
+}
+
+static CharString _getDefaultPluginVst2xIndexPath(void) {
+  CharString result = newCharString();
+  const char *homeDirectory = getenv(PLUGIN_VST2X_INDEX_HOME_VARIABLE);
+
+  if (homeDirectory == NULL || strlen(homeDirectory) == 0) {
+    CharString currentDirectory = fileGetCurrentDirectory();
+    snprintf(result->data, result->capacity, "%s%c%s", currentDirectory->data,
+             PATH_DELIMITER, PLUGIN_VST2X_INDEX_DEFAULT_FILENAME);
+    freeCharString(currentDirectory);
+  } else {
+    snprintf(result->data, result->capacity, "%s%c%s%c%s", homeDirectory,
+             PATH_DELIMITER, PLUGIN_VST2X_INDEX_DIRECTORY, PATH_DELIMITER,
+             PLUGIN_VST2X_INDEX_DEFAULT_FILENAME);
+  }
+
+  return result;
+}
+
+PluginVst2xIndex newPluginVst2xIndex(const CharString indexPath) {
+  PluginVst2xIndex index =
+      (PluginVst2xIndex)malloc(sizeof(PluginVst2xIndexMembers));
+
+  if (indexPath == NULL || charStringIsEmpty(indexPath)) {
+    index->indexPath = _getDefaultPluginVst2xIndexPath();
+  } else {
+    index->indexPath = newCharStringWithCString(indexPath->data);
+  }
+
+  index->entries = newLinkedList();
+  index->isDirty = false;
+  index->isComplete = false;
+  return index;
+}
+
+void initPluginVst2xIndex(const CharString indexPath) {
+  if (pluginVst2xIndexInstance != NULL) {
+    freePluginVst2xIndex(pluginVst2xIndexInstance);
+  }
+
+  pluginVst2xIndexInstance = newPluginVst2xIndex(indexPath);
+  logDebug("Using plugin index '%s'",
+           pluginVst2xIndexInstance->indexPath->data);
+
+  if (pluginVst2xIndexLoad(pluginVst2xIndexInstance)) {
+    logDebug("Loaded %d plugins from index",
+             linkedListLength(pluginVst2xIndexInstance->entries));
+  }
+}
+
+PluginVst2xIndex getPluginVst2xIndex(void) { return pluginVst2xIndexInstance; }
+
+static const char *_getPluginTypeName(const PluginType pluginType) {
+  switch (pluginType) {
+  case PLUGIN_TYPE_EFFECT:
+    return "effect";
+
+  case PLUGIN_TYPE_INSTRUMENT:
+    return "instrument";
+
+  default:
+    return "unknown";
+  }
+}
+
+static PluginType _getPluginTypeFromName(const char *typeName) {
+  if (!strcmp(typeName, _getPluginTypeName(PLUGIN_TYPE_EFFECT))) {
+    return PLUGIN_TYPE_EFFECT;
+  } else if (!strcmp(typeName, _getPluginTypeName(PLUGIN_TYPE_INSTRUMENT))) {
+    return PLUGIN_TYPE_INSTRUMENT;
+  } else {
+    return PLUGIN_TYPE_UNKNOWN;
+  }
+}
+
+/**
+ * Parse a key/value line which belongs to a plugin entry.
+ * @param entry Entry to update
+ * @param key Key, which may not be the plugin key
+ * @param value Value for key
+ */
+static void _parsePluginVst2xIndexEntryLine(PluginVst2xIndexEntry entry,
+                                            const char *key,
+                                            const char *value) {
+  if (!strcmp(key, kPluginVst2xIndexKeyModifiedTime)) {
+    entry->modifiedTime = strtoul(value, NULL, 10);
+  } else if (!strcmp(key, kPluginVst2xIndexKeyStatus)) {
+    entry->status = _getPluginVst2xIndexStatusFromName(value);
+  } else if (!strcmp(key, kPluginVst2xIndexKeyUniqueId)) {
+    entry->uniqueId = strtoul(value, NULL, 10);
+  } else if (!strcmp(key, kPluginVst2xIndexKeyVersion)) {
+    entry->version = strtoul(value, NULL, 10);
+  } else if (!strcmp(key, kPluginVst2xIndexKeyType)) {
+    entry->pluginType = _getPluginTypeFromName(value);
+  } else if (!strcmp(key, kPluginVst2xIndexKeyInputs)) {
+    entry->numInputs = (int)strtol(value, NULL, 10);
+  } else if (!strcmp(key, kPluginVst2xIndexKeyOutputs)) {
+    entry->numOutputs = (int)strtol(value, NULL, 10);
+  } else if (!strcmp(key, kPluginVst2xIndexKeyShellPlugin)) {
+    linkedListAppend(entry->shellPluginIds,
+                     newPluginVst2xIdWithId(strtoul(value, NULL, 10)));
+  } else if (!strcmp(key, kPluginVst2xIndexKeyParameter)) {
+    linkedListAppend(entry->parameterNames, newCharStringWithCString(value));
+  } else if (!strcmp(key, kPluginVst2xIndexKeyCanDo)) {
+    linkedListAppend(entry->canDos, newCharStringWithCString(value));
+  } else {
+    logDebug("Ignoring unknown key '%s' in plugin index", key);
+  }
+}
+
+/**
+ * Split an index line into its key and value. The line is modified in place.
+ * @param line Line to split
+ * @return Pointer to the value, or NULL if this line should be ignored
+ */
+static char *_splitPluginVst2xIndexLine(CharString line) {
+  char *value = strchr(line->data, '\t');
+
+  if (charStringIsEmpty(line) || line->data[0] == '#') {
+    return NULL;
+  } else if (value == NULL) {
+    logWarn("Ignoring malformed line '%s' in plugin index", line->data);
+    return NULL;
+  }
+
+  *value = '\0';
+  return value + 1;
+}
+
+PluginVst2xIndexEntry
+newPluginVst2xIndexEntryWithString(const CharString text) {
+  PluginVst2xIndexEntry entry = NULL;
+  LinkedList lines;
+  LinkedListIterator iterator;
+
+  if (text == NULL || charStringIsEmpty(text)) {
+    return NULL;
+  }
+
+  lines = charStringSplit(text, '\n');
+  if (lines == NULL) {
+    return NULL;
+  }
+
+  for (iterator = lines; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    CharString line = (CharString)iterator->item;
+    char *value = _splitPluginVst2xIndexLine(line);
+
+    if (value == NULL) {
+      continue;
+    } else if (!strcmp(line->data, kPluginVst2xIndexKeyPlugin)) {
+      if (entry != NULL) {
+        logWarn("Ignoring extra plugin '%s' in index entry", value);
+        break;
+      }
+
+      entry = newPluginVst2xIndexEntry();
+      charStringCopyCString(entry->absolutePath, value);
+    } else if (entry != NULL) {
+      _parsePluginVst2xIndexEntryLine(entry, line->data, value);
+    }
+  }
+
+  freeLinkedListAndItems(lines, (LinkedListFreeItemFunc)freeCharString);
+  return entry;
+}
+
+boolByte pluginVst2xIndexLoad(PluginVst2xIndex self) {
+  File indexFile = NULL;
+  LinkedList lines = NULL;
+  LinkedListIterator iterator;
+  PluginVst2xIndexEntry entry = NULL;
+  boolByte result = true;
+
+  indexFile = newFileWithPath(self->indexPath);
+  if (indexFile == NULL || !fileExists(indexFile)) {
+    logDebug("Plugin index '%s' does not exist", self->indexPath->data);
+    freeFile(indexFile);
+    return false;
+  }
+
+  lines = fileReadLines(indexFile);
+  freeFile(indexFile);
+  if (lines == NULL) {
+    return false;
+  }
+
+  pluginVst2xIndexClear(self);
+
+  for (iterator = lines; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    CharString line = (CharString)iterator->item;
+    char *key = line->data;
+    char *value = _splitPluginVst2xIndexLine(line);
+
+    if (value == NULL) {
+      continue;
+    } else if (!strcmp(key, kPluginVst2xIndexKeyIndex)) {
+      if (strtoul(value, NULL, 10) != PLUGIN_VST2X_INDEX_VERSION) {
+        logInfo("Plugin index '%s' has a different version, ignoring it",
+                self->indexPath->data);
+        result = false;
+        break;
+      }
+    } else if (!strcmp(key, kPluginVst2xIndexKeyComplete)) {
+      self->isComplete = (boolByte)(strtoul(value, NULL, 10) != 0);
+    } else if (!strcmp(key, kPluginVst2xIndexKeyPlugin)) {
+      entry = newPluginVst2xIndexEntry();
+      charStringCopyCString(entry->absolutePath, value);
+      linkedListAppend(self->entries, entry);
+    } else if (entry == NULL) {
+      logWarn("Ignoring '%s' in plugin index, no plugin was given", key);
+    } else {
+      _parsePluginVst2xIndexEntryLine(entry, key, value);
+    }
+  }
+
+  if (!result) {
+    pluginVst2xIndexClear(self);
+  }
+
+  self->isDirty = false;
+  freeLinkedListAndItems(lines, (LinkedListFreeItemFunc)freeCharString);
+  return result;
+}
+
+static void _writePluginVst2xIndexString(FILE *fp, const char *key,
+                                         const CharString value) {
+  char *c;
+
+  // Tabs and newlines would break the line-based format, and plugins are
+  // free to put just about anything in their parameter names.
+  for (c = value->data; *c != '\0'; c++) {
+    if (*c == '\t' || *c == '\n' || *c == '\r') {
+      *c = ' ';
+    }
+  }
+
+  fprintf(fp, "%s\t%s\n", key, value->data);
+}
+
+static void _writePluginVst2xIndexShellPlugin(void *item, void *userData) {
+  PluginVst2xId shellPluginId = (PluginVst2xId)item;
+  fprintf((FILE *)userData, "%s\t%lu\n", kPluginVst2xIndexKeyShellPlugin,
+          shellPluginId->id);
+}
+
+static void _writePluginVst2xIndexParameter(void *item, void *userData) {
+  _writePluginVst2xIndexString((FILE *)userData, kPluginVst2xIndexKeyParameter,
+                               (CharString)item);
+}
+
+static void _writePluginVst2xIndexCanDo(void *item, void *userData) {
+  _writePluginVst2xIndexString((FILE *)userData, kPluginVst2xIndexKeyCanDo,
+                               (CharString)item);
+}
+
+void pluginVst2xIndexEntryWrite(const PluginVst2xIndexEntry self, FILE *fp) {
+  _writePluginVst2xIndexString(fp, kPluginVst2xIndexKeyPlugin,
+                               self->absolutePath);
+  fprintf(fp, "%s\t%lu\n", kPluginVst2xIndexKeyModifiedTime,
+          self->modifiedTime);
+  fprintf(fp, "%s\t%s\n", kPluginVst2xIndexKeyStatus,
+          pluginVst2xIndexStatusToString(self->status));
+  fprintf(fp, "%s\t%lu\n", kPluginVst2xIndexKeyUniqueId, self->uniqueId);
+  fprintf(fp, "%s\t%lu\n", kPluginVst2xIndexKeyVersion, self->version);
+  fprintf(fp, "%s\t%s\n", kPluginVst2xIndexKeyType,
+          _getPluginTypeName(self->pluginType));
+  fprintf(fp, "%s\t%d\n", kPluginVst2xIndexKeyInputs, self->numInputs);
+  fprintf(fp, "%s\t%d\n", kPluginVst2xIndexKeyOutputs, self->numOutputs);
+  linkedListForeach(self->shellPluginIds, _writePluginVst2xIndexShellPlugin,
+                    fp);
+  linkedListForeach(self->parameterNames, _writePluginVst2xIndexParameter, fp);
+  linkedListForeach(self->canDos, _writePluginVst2xIndexCanDo, fp);
+}
+
+static void _writePluginVst2xIndexEntry(void *item, void *userData) {
+  pluginVst2xIndexEntryWrite((PluginVst2xIndexEntry)item, (FILE *)userData);
+}
+
+static boolByte _createPluginVst2xIndexDirectory(const CharString indexPath) {
+  boolByte result = true;
+  CharString parentPath = newCharStringWithCString(indexPath->data);
+  char *delimiter = strrchr(parentPath->data, PATH_DELIMITER);
+  File parentDir = NULL;
+
+  if (delimiter != NULL && delimiter != parentPath->data) {
+    *delimiter = '\0';
+    parentDir = newFileWithPath(parentPath);
+
+    if (parentDir == NULL) {
+      result = false;
+    } else if (!fileExists(parentDir)) {
+      result = fileCreate(parentDir, kFileTypeDirectory);
+    }
+  }
+
+  freeFile(parentDir);
+  freeCharString(parentPath);
+  return result;
+}
+
+// Create a temporary file next to the index, which is unique so that several
+// processes can save the index at the same time without overwriting each
+// other's temporary file before it is moved into place.
+static FILE *_openPluginVst2xIndexTempFile(const CharString indexPath,
+                                           CharString *outTempPath) {
+  CharString tempPath = newCharStringWithCapacity(indexPath->capacity + 32);
+  FILE *fp = NULL;
+#if UNIX
+  int fd;
+
+  snprintf(tempPath->data, tempPath->capacity, "%s.XXXXXX", indexPath->data);
+  fd = mkstemp(tempPath->data);
+
+  if (fd >= 0) {
+    // mkstemp() only gives the owner access, but the index is not private
+    fchmod(fd, 0644);
+    fp = fdopen(fd, "w");
+
+    if (fp == NULL) {
+      close(fd);
+      remove(tempPath->data);
+    }
+  }
+#else
+  snprintf(tempPath->data, tempPath->capacity, "%s.%d.tmp", indexPath->data,
+           (int)getpid());
+  fp = fopen(tempPath->data, "w");
+#endif
+
+  *outTempPath = tempPath;
+  return fp;
+}
+
+boolByte pluginVst2xIndexSave(PluginVst2xIndex self) {
+  CharString tempPath = NULL;
+  FILE *fp = NULL;
+
+  if (!_createPluginVst2xIndexDirectory(self->indexPath)) {
+    logError("Could not create directory for plugin index '%s'",
+             self->indexPath->data);
+    return false;
+  }
+
+  fp = _openPluginVst2xIndexTempFile(self->indexPath, &tempPath);
+
+  if (fp == NULL) {
+    logError("Could not open '%s' for writing", tempPath->data);
+    freeCharString(tempPath);
+    return false;
+  }
+
+  fprintf(fp, "# Generated by MrsWatson, do not edit\n");
+  fprintf(fp, "%s\t%d\n", kPluginVst2xIndexKeyIndex,
+          PLUGIN_VST2X_INDEX_VERSION);
+  fprintf(fp, "%s\t%d\n", kPluginVst2xIndexKeyComplete, self->isComplete);
+  linkedListForeach(self->entries, _writePluginVst2xIndexEntry, fp);
+
+  if (fclose(fp) != 0) {
+    logError("Could not write plugin index '%s'", tempPath->data);
+    remove(tempPath->data);
+    freeCharString(tempPath);
+    return false;
+  }
+
+#if WINDOWS
+  // rename() will not replace an existing file on Windows
+  remove(self->indexPath->data);
+#endif
+
+  if (rename(tempPath->data, self->indexPath->data) != 0) {
+    logError("Could not move plugin index to '%s'", self->indexPath->data);
+    remove(tempPath->data);
+    freeCharString(tempPath);
+    return false;
+  }
+
+  self->isDirty = false;
+  logDebug("Saved %d plugins to index '%s'", linkedListLength(self->entries),
+           self->indexPath->data);
+  freeCharString(tempPath);
+  return true;
+}
+
+static const char *_getPluginVst2xIndexBasename(const CharString path) {
+  const char *delimiter = strrchr(path->data, PATH_DELIMITER);
+  return delimiter != NULL ? delimiter + 1 : path->data;
+}
+
+static boolByte _pluginVst2xIndexNameMatches(const PluginVst2xIndexEntry entry,
+                                             const char *pluginName) {
+  const char *basename = _getPluginVst2xIndexBasename(entry->absolutePath);
+  const char *extension = strrchr(basename, '.');
+
+  if (!strcmp(pluginName, entry->absolutePath->data) ||
+      !strcmp(pluginName, basename)) {
+    return true;
+  }
+
+  return (boolByte)(extension != NULL &&
+                    strlen(pluginName) == (size_t)(extension - basename) &&
+                    !strncmp(pluginName, basename, strlen(pluginName)));
+}
+
+static boolByte _pluginVst2xIndexLocationMatches(
+    const PluginVst2xIndexEntry entry, const CharString location) {
+  const char *basename = _getPluginVst2xIndexBasename(entry->absolutePath);
+  size_t locationLength = strlen(location->data);
+
+  // Ignore a trailing delimiter on the location, if any
+  if (locationLength > 1 &&
+      location->data[locationLength - 1] == PATH_DELIMITER) {
+    locationLength--;
+  }
+
+  return (boolByte)(basename > entry->absolutePath->data &&
+                    (size_t)(basename - entry->absolutePath->data - 1) ==
+                        locationLength &&
+                    !strncmp(entry->absolutePath->data, location->data,
+                             locationLength));
+}
+
+PluginVst2xIndexEntry pluginVst2xIndexFind(PluginVst2xIndex self,
+                                           const CharString pluginName,
+                                           const CharString pluginRoot) {
+  PluginVst2xIndexEntry result = NULL;
+  CharString searchName = NULL;
+  LinkedListIterator iterator;
+  char *subpluginSeparator;
+  int pass;
+
+  if (self == NULL || pluginName == NULL || charStringIsEmpty(pluginName)) {
+    return NULL;
+  }
+
+  // Sub-plugin ID's refer to the shell plugin file, so strip them off. See
+  // _openVst2xPlugin() for why the position of the separator matters.
+  searchName = newCharStringWithCString(pluginName->data);
+  subpluginSeparator =
+      strrchr(searchName->data, kPluginVst2xSubpluginSeparator);
+  if (subpluginSeparator != NULL && subpluginSeparator - searchName->data > 1) {
+    *subpluginSeparator = '\0';
+  }
+
+  // Entries in the user's plugin root take precedence, as they would when
+  // searching the filesystem.
+  for (pass = 0; pass < 2 && result == NULL; pass++) {
+    if (pass == 0 && (pluginRoot == NULL || charStringIsEmpty(pluginRoot))) {
+      continue;
+    }
+
+    for (iterator = self->entries; iterator != NULL && iterator->item != NULL;
+         iterator = (LinkedListIterator)iterator->nextItem) {
+      PluginVst2xIndexEntry entry = (PluginVst2xIndexEntry)iterator->item;
+
+      if (!_pluginVst2xIndexNameMatches(entry, searchName->data)) {
+        continue;
+      } else if (pass == 0 &&
+                 !_pluginVst2xIndexLocationMatches(entry, pluginRoot)) {
+        continue;
+      } else if (entry->status != PLUGIN_VST2X_INDEX_STATUS_OK) {
+        logDebug("Plugin '%s' could not be scanned (%s)",
+                 entry->absolutePath->data,
+                 pluginVst2xIndexStatusToString(entry->status));
+        continue;
+      } else if (!pluginVst2xIndexEntryIsValid(entry)) {
+        logDebug("Index entry for '%s' is stale", entry->absolutePath->data);
+        continue;
+      }
+
+      result = entry;
+      break;
+    }
+  }
+
+  freeCharString(searchName);
+  return result;
+}
+
+PluginVst2xIndexEntry pluginVst2xIndexFindPath(PluginVst2xIndex self,
+                                               const CharString absolutePath) {
+  LinkedListIterator iterator;
+
+  if (self == NULL || absolutePath == NULL) {
+    return NULL;
+  }
+
+  for (iterator = self->entries; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    PluginVst2xIndexEntry entry = (PluginVst2xIndexEntry)iterator->item;
+
+    if (charStringIsEqualTo(entry->absolutePath, absolutePath, false)) {
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+void pluginVst2xIndexAdd(PluginVst2xIndex self, PluginVst2xIndexEntry entry) {
+  LinkedListIterator iterator;
+
+  if (self == NULL || entry == NULL) {
+    return;
+  }
+
+  for (iterator = self->entries; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    PluginVst2xIndexEntry existing = (PluginVst2xIndexEntry)iterator->item;
+
+    if (charStringIsEqualTo(existing->absolutePath, entry->absolutePath,
+                            false)) {
+      freePluginVst2xIndexEntry(existing);
+      iterator->item = entry;
+      self->isDirty = true;
+      return;
+    }
+  }
+
+  linkedListAppend(self->entries, entry);
+  self->isDirty = true;
+}
+
+boolByte pluginVst2xIndexRemoveStaleEntries(PluginVst2xIndex self) {
+  LinkedList remainingEntries = newLinkedList();
+  LinkedListIterator iterator;
+  PluginVst2xIndexEntry entry;
+  File pluginFile;
+  boolByte result = true;
+
+  for (iterator = self->entries; iterator != NULL && iterator->item != NULL;
+       iterator = (LinkedListIterator)iterator->nextItem) {
+    entry = (PluginVst2xIndexEntry)iterator->item;
+
+    if (pluginVst2xIndexEntryIsValid(entry)) {
+      linkedListAppend(remainingEntries, entry);
+      continue;
+    }
+
+    pluginFile = newFileWithPath(entry->absolutePath);
+
+    if (pluginFile != NULL && fileExists(pluginFile)) {
+      // The entry describes an older version of the plugin, which must be
+      // scanned again to be indexed
+      logDebug("Plugin '%s' has changed since it was indexed",
+               entry->absolutePath->data);
+      linkedListAppend(remainingEntries, entry);
+      result = false;
+    } else {
+      logDebug("Removing plugin '%s' from index, it no longer exists",
+               entry->absolutePath->data);
+      freePluginVst2xIndexEntry(entry);
+      self->isDirty = true;
+    }
+
+    freeFile(pluginFile);
+  }
+
+  freeLinkedList(self->entries);
+  self->entries = remainingEntries;
+  return result;
+}
+
+void pluginVst2xIndexClear(PluginVst2xIndex self) {
+  if (self != NULL) {
+    freeLinkedListAndItems(self->entries,
+                           (LinkedListFreeItemFunc)freePluginVst2xIndexEntry);
+    self->entries = newLinkedList();
+    self->isDirty = true;
+    self->isComplete = false;
+  }
+}
+
+void freePluginVst2xIndex(PluginVst2xIndex self) {
+  if (self != NULL) {
+    freeLinkedListAndItems(self->entries,
+                           (LinkedListFreeItemFunc)freePluginVst2xIndexEntry);
+    freeCharString(self->indexPath);
+
+    if (self == pluginVst2xIndexInstance) {
+      pluginVst2xIndexInstance = NULL;
+    }
+
+    free(self);
+  }
+}
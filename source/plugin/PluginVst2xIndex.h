@@ -0,0 +1,228 @@
+//
+// PluginVst2xIndex.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginVst2xIndex_h
+#define MrsWatson_PluginVst2xIndex_h
+
+#include "base/CharString.h"
+#include "base/LinkedList.h"
+#include "plugin/Plugin.h"
+
+#include <stdio.h>
+
+/**
+ * The plugin index is an on-disk cache of VST2.x plugin metadata. Lookups and
+ * listings are answered from the index so that plugins need not be searched
+ * for on the filesystem or loaded with dlopen() just to find out what they are.
+ * Each entry is keyed by the plugin's absolute path and is considered stale
+ * once the file's modification time no longer matches the indexed one.
+ *
+ * Like the AudioClock, the index is kept in a singleton instance, since plugin
+ * lookups are made from the plugin factory where there is no other state to
+ * pass it through. If the index has not been initialized, then all lookups go
+ * directly to the filesystem as before.
+ */
+
+#define PLUGIN_VST2X_INDEX_VERSION 1
+#define PLUGIN_VST2X_INDEX_DEFAULT_FILENAME "plugin-index.txt"
+
+typedef enum {
+  PLUGIN_VST2X_INDEX_STATUS_OK,
+  // The plugin could not be loaded or initialized
+  PLUGIN_VST2X_INDEX_STATUS_FAILED,
+  // The plugin did not finish loading within the scan timeout
+  PLUGIN_VST2X_INDEX_STATUS_TIMED_OUT,
+  // The plugin crashed the process which was scanning it
+  PLUGIN_VST2X_INDEX_STATUS_CRASHED,
+  NUM_PLUGIN_VST2X_INDEX_STATUSES
+} PluginVst2xIndexStatus;
+
+typedef struct {
+  CharString absolutePath;
+  unsigned long modifiedTime;
+  PluginVst2xIndexStatus status;
+  unsigned long uniqueId;
+  unsigned long version;
+  PluginType pluginType;
+  int numInputs;
+  int numOutputs;
+  // List of PluginVst2xId, only populated for shell plugins
+  LinkedList shellPluginIds;
+  // List of CharString, in parameter index order
+  LinkedList parameterNames;
+  // List of CharString, only canDo's which the plugin answered "yes" to
+  LinkedList canDos;
+} PluginVst2xIndexEntryMembers;
+typedef PluginVst2xIndexEntryMembers *PluginVst2xIndexEntry;
+
+typedef struct {
+  CharString indexPath;
+  LinkedList entries;
+  // Set when entries have been added since the index was last loaded or saved
+  boolByte isDirty;
+  // Set when the entries come from a scan of all plugin locations, rather than
+  // only from plugins which were indexed when they were opened
+  boolByte isComplete;
+} PluginVst2xIndexMembers;
+typedef PluginVst2xIndexMembers *PluginVst2xIndex;
+extern PluginVst2xIndex pluginVst2xIndexInstance;
+
+/**
+ * Create a new, empty index entry.
+ * @return Entry with no metadata
+ */
+PluginVst2xIndexEntry newPluginVst2xIndexEntry(void);
+
+/**
+ * Create an index entry from text in the index file format, as written by
+ * pluginVst2xIndexEntryWrite().
+ * @param text Serialized entry
+ * @return New entry, or NULL if the text does not contain a plugin entry
+ */
+PluginVst2xIndexEntry newPluginVst2xIndexEntryWithString(const CharString text);
+
+/**
+ * Write an entry in the index file format.
+ * @param self
+ * @param fp Open file to write to
+ */
+void pluginVst2xIndexEntryWrite(const PluginVst2xIndexEntry self, FILE *fp);
+
+/**
+ * Get a human-readable name for an index entry status.
+ * @param status Entry status
+ * @return Name of the status, which is also used in the index file
+ */
+const char *pluginVst2xIndexStatusToString(const PluginVst2xIndexStatus status);
+
+/**
+ * Check that the plugin file for an entry still exists and has not been
+ * modified since it was indexed.
+ * @param self
+ * @return True if the entry may be used in place of the plugin file
+ */
+boolByte pluginVst2xIndexEntryIsValid(const PluginVst2xIndexEntry self);
+
+/**
+ * Free an index entry and all of its metadata.
+ * @param self
+ */
+void freePluginVst2xIndexEntry(PluginVst2xIndexEntry self);
+
+/**
+ * Create a new index which will be stored at the given path. Nothing is read
+ * from disk until pluginVst2xIndexLoad() is called.
+ * @param indexPath Index file path. If NULL or empty, then the index will be
+ * kept in the user's home directory.
+ * @return Empty index
+ */
+PluginVst2xIndex newPluginVst2xIndex(const CharString indexPath);
+
+/**
+ * Initialize the global index instance and load it from disk. A missing index
+ * file is not an error, the index will then start out empty.
+ * @param indexPath Index file path, or NULL to use the default location
+ */
+void initPluginVst2xIndex(const CharString indexPath);
+
+/**
+ * Get a reference to the global index instance.
+ * @return Reference to global index, or NULL if the index has not been
+ * initialized.
+ */
+PluginVst2xIndex getPluginVst2xIndex(void);
+
+/**
+ * Read index entries from disk, replacing any entries already in the index.
+ * @param self
+ * @return True if the index file was read, false if it does not exist or
+ * could not be parsed.
+ */
+boolByte pluginVst2xIndexLoad(PluginVst2xIndex self);
+
+/**
+ * Write the index to disk. The index is first written to a uniquely named
+ * temporary file and then moved into place, so that other processes never see
+ * a partial index, even when several of them save at the same time.
+ * @param self
+ * @return True on success
+ */
+boolByte pluginVst2xIndexSave(PluginVst2xIndex self);
+
+/**
+ * Find an indexed plugin by name. The name is matched in the same forms which
+ * are accepted by --plugin, namely an absolute path, or a short name with or
+ * without the platform extension, and optionally with a sub-plugin ID. Stale
+ * entries and entries for plugins which failed to scan are never returned.
+ * @param self
+ * @param pluginName Plugin name to search for
+ * @param pluginRoot User-provided plugin root, entries in this location are
+ * preferred over those in other locations.
+ * @return Matching entry, or NULL if no valid entry was found
+ */
+PluginVst2xIndexEntry pluginVst2xIndexFind(PluginVst2xIndex self,
+                                           const CharString pluginName,
+                                           const CharString pluginRoot);
+
+/**
+ * Find an indexed plugin by its absolute path. Unlike pluginVst2xIndexFind(),
+ * this function does not check if the entry is stale.
+ * @param self
+ * @param absolutePath Absolute path to the plugin file
+ * @return Matching entry, or NULL if there is no entry for this path
+ */
+PluginVst2xIndexEntry pluginVst2xIndexFindPath(PluginVst2xIndex self,
+                                               const CharString absolutePath);
+
+/**
+ * Add an entry to the index, replacing any existing entry for the same path.
+ * @param self
+ * @param entry Entry to add. The index takes ownership of this object.
+ */
+void pluginVst2xIndexAdd(PluginVst2xIndex self, PluginVst2xIndexEntry entry);
+
+/**
+ * Remove entries for plugin files which no longer exist.
+ * @param self
+ * @return True if all remaining entries are valid, false if any plugin file
+ * has been modified since it was indexed
+ */
+boolByte pluginVst2xIndexRemoveStaleEntries(PluginVst2xIndex self);
+
+/**
+ * Remove all entries from the index, for instance before a rescan. The index
+ * is no longer complete afterwards.
+ * @param self
+ */
+void pluginVst2xIndexClear(PluginVst2xIndex self);
+
+/**
+ * Free an index and all of its entries. This does not save the index.
+ * @param self
+ */
+void freePluginVst2xIndex(PluginVst2xIndex self);
+
+#endif
@@ -0,0 +1,375 @@
+//
+// PluginVst2xScanner.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "PluginVst2xScanner.h"
+
+#include "base/File.h"
+#include "base/PlatformInfo.h"
+#include "logging/EventLogger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if UNIX
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// How often to check running scan jobs for timeouts
+static const int kPluginVst2xScannerPollIntervalInMs = 100;
+// Exit code used by child processes when the plugin could not be loaded
+static const int kPluginVst2xScannerChildFailed = 1;
+
+PluginVst2xScanner newPluginVst2xScanner(PluginVst2xScannerProbeFunc probe,
+                                         unsigned int maxJobs,
+                                         unsigned long timeoutInMs) {
+  PluginVst2xScanner scanner =
+      (PluginVst2xScanner)malloc(sizeof(PluginVst2xScannerMembers));
+
+  scanner->probe = probe;
+  scanner->maxJobs = maxJobs > 0 ? maxJobs : platformInfoGetNumProcessors();
+  scanner->timeoutInMs = timeoutInMs > 0
+                             ? timeoutInMs
+                             : PLUGIN_VST2X_SCANNER_DEFAULT_TIMEOUT_IN_MS;
+
+  return scanner;
+}
+
+static PluginVst2xIndexEntry
+_newFailedPluginVst2xIndexEntry(const CharString pluginPath,
+                                const PluginVst2xIndexStatus status) {
+  PluginVst2xIndexEntry entry = newPluginVst2xIndexEntry();
+  File pluginFile = newFileWithPath(pluginPath);
+
+  charStringCopy(entry->absolutePath, pluginPath);
+  entry->status = status;
+
+  // Failed entries also record the modification time, so that it is possible
+  // to tell when a broken plugin has been updated.
+  if (pluginFile != NULL) {
+    entry->modifiedTime = fileGetModifiedTime(pluginFile);
+    freeFile(pluginFile);
+  }
+
+  logWarn("Could not scan plugin '%s': %s", pluginPath->data,
+          pluginVst2xIndexStatusToString(status));
+  return entry;
+}
+
+#if UNIX
+typedef struct {
+  // Position of the plugin in the list of plugins to scan
+  unsigned int index;
+  CharString pluginPath;
+  pid_t pid;
+  int outputFd;
+  CharString output;
+  struct timeval startTime;
+} PluginVst2xScanJobMembers;
+typedef PluginVst2xScanJobMembers *PluginVst2xScanJob;
+
+static unsigned long _getElapsedTimeInMs(const struct timeval *startTime) {
+  struct timeval currentTime;
+  gettimeofday(&currentTime, NULL);
+  return (unsigned long)((currentTime.tv_sec - startTime->tv_sec) * 1000 +
+                         (currentTime.tv_usec - startTime->tv_usec) / 1000);
+}
+
+static void _runPluginVst2xScanChild(PluginVst2xScanner self,
+                                     const CharString pluginPath,
+                                     const int outputFd) {
+  FILE *output = fdopen(outputFd, "w");
+  PluginVst2xIndexEntry entry = self->probe(pluginPath);
+
+  if (output == NULL || entry == NULL) {
+    _exit(kPluginVst2xScannerChildFailed);
+  }
+
+  pluginVst2xIndexEntryWrite(entry, output);
+
+  if (fclose(output) != 0) {
+    _exit(kPluginVst2xScannerChildFailed);
+  }
+
+  // Don't run any atexit() handlers or flush stdio buffers which were
+  // inherited from the parent, and don't bother freeing anything either.
+  _exit(0);
+}
+
+static PluginVst2xScanJob _startPluginVst2xScanJob(PluginVst2xScanner self,
+                                                   const CharString pluginPath,
+                                                   const unsigned int index) {
+  PluginVst2xScanJob job = NULL;
+  int fds[2];
+  pid_t pid;
+
+  if (pipe(fds) != 0) {
+    logError("Could not create pipe for scanning '%s', %s", pluginPath->data,
+             stringForLastError(errno));
+    return NULL;
+  }
+
+  // Otherwise any buffered output would be written by both processes
+  fflush(NULL);
+  pid = fork();
+
+  if (pid < 0) {
+    logError("Could not fork process for scanning '%s', %s", pluginPath->data,
+             stringForLastError(errno));
+    close(fds[0]);
+    close(fds[1]);
+    return NULL;
+  } else if (pid == 0) {
+    close(fds[0]);
+    _runPluginVst2xScanChild(self, pluginPath, fds[1]);
+  }
+
+  close(fds[1]);
+  logDebug("Scanning '%s' in process %d", pluginPath->data, pid);
+
+  job = (PluginVst2xScanJob)malloc(sizeof(PluginVst2xScanJobMembers));
+  job->index = index;
+  job->pluginPath = pluginPath;
+  job->pid = pid;
+  job->outputFd = fds[0];
+  job->output = newCharStringWithCapacity(kCharStringLengthLong);
+  gettimeofday(&job->startTime, NULL);
+  return job;
+}
+
+static PluginVst2xIndexEntry
+_finishPluginVst2xScanJob(PluginVst2xScanJob job, boolByte timedOut) {
+  PluginVst2xIndexEntry entry = NULL;
+  int status = 0;
+
+  close(job->outputFd);
+
+  if (timedOut) {
+    kill(job->pid, SIGKILL);
+  }
+
+  while (waitpid(job->pid, &status, 0) < 0) {
+    if (errno != EINTR) {
+      logError("Could not wait for process %d, %s", job->pid,
+               stringForLastError(errno));
+      break;
+    }
+  }
+
+  if (timedOut) {
+    entry = _newFailedPluginVst2xIndexEntry(
+        job->pluginPath, PLUGIN_VST2X_INDEX_STATUS_TIMED_OUT);
+  } else if (WIFSIGNALED(status)) {
+    logDebug("Process %d was killed by signal %d", job->pid, WTERMSIG(status));
+    entry = _newFailedPluginVst2xIndexEntry(job->pluginPath,
+                                            PLUGIN_VST2X_INDEX_STATUS_CRASHED);
+  } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    entry = _newFailedPluginVst2xIndexEntry(job->pluginPath,
+                                            PLUGIN_VST2X_INDEX_STATUS_FAILED);
+  } else {
+    entry = newPluginVst2xIndexEntryWithString(job->output);
+
+    if (entry == NULL) {
+      logError("Process %d did not return any information", job->pid);
+      entry = _newFailedPluginVst2xIndexEntry(job->pluginPath,
+                                              PLUGIN_VST2X_INDEX_STATUS_FAILED);
+    } else {
+      logInfo("Scanned '%s' in %lu ms", job->pluginPath->data,
+              _getElapsedTimeInMs(&job->startTime));
+    }
+  }
+
+  freeCharString(job->output);
+  free(job);
+  return entry;
+}
+
+/**
+ * Read any available output from a scan job.
+ * @param job Job to read from
+ * @return False once the job has closed its end of the pipe
+ */
+static boolByte _readPluginVst2xScanJobOutput(PluginVst2xScanJob job) {
+  char buffer[kCharStringLengthDefault];
+  ssize_t bytesRead = read(job->outputFd, buffer, sizeof(buffer) - 1);
+
+  if (bytesRead > 0) {
+    buffer[bytesRead] = '\0';
+    charStringAppendCString(job->output, buffer);
+    return true;
+  }
+
+  return (boolByte)(bytesRead < 0 && (errno == EINTR || errno == EAGAIN));
+}
+
+static void _runPluginVst2xScanJobs(PluginVst2xScanner self,
+                                    CharString *pluginPaths,
+                                    const unsigned int numPlugins,
+                                    PluginVst2xIndexEntry *results) {
+  PluginVst2xScanJob *jobs = (PluginVst2xScanJob *)malloc(
+      sizeof(PluginVst2xScanJob) * self->maxJobs);
+  struct pollfd *pollFds =
+      (struct pollfd *)malloc(sizeof(struct pollfd) * self->maxJobs);
+  unsigned int numJobs = 0;
+  unsigned int nextPlugin = 0;
+  unsigned int i;
+  int pollResult;
+
+  while (nextPlugin < numPlugins || numJobs > 0) {
+    while (numJobs < self->maxJobs && nextPlugin < numPlugins) {
+      PluginVst2xScanJob job =
+          _startPluginVst2xScanJob(self, pluginPaths[nextPlugin], nextPlugin);
+
+      if (job == NULL) {
+        results[nextPlugin] = _newFailedPluginVst2xIndexEntry(
+            pluginPaths[nextPlugin], PLUGIN_VST2X_INDEX_STATUS_FAILED);
+      } else {
+        jobs[numJobs++] = job;
+      }
+
+      nextPlugin++;
+    }
+
+    if (numJobs == 0) {
+      continue;
+    }
+
+    for (i = 0; i < numJobs; i++) {
+      pollFds[i].fd = jobs[i]->outputFd;
+      pollFds[i].events = POLLIN;
+      pollFds[i].revents = 0;
+    }
+
+    pollResult =
+        poll(pollFds, (nfds_t)numJobs, kPluginVst2xScannerPollIntervalInMs);
+
+    if (pollResult < 0 && errno != EINTR) {
+      logError("Could not poll scan processes, %s", stringForLastError(errno));
+      break;
+    }
+
+    // Iterate backwards so that finished jobs can be replaced by the last one
+    for (i = numJobs; i > 0; i--) {
+      PluginVst2xScanJob job = jobs[i - 1];
+      boolByte finished = false;
+      boolByte timedOut = false;
+
+      if (pollFds[i - 1].revents != 0) {
+        finished = (boolByte)!_readPluginVst2xScanJobOutput(job);
+      }
+
+      if (!finished &&
+          _getElapsedTimeInMs(&job->startTime) > self->timeoutInMs) {
+        finished = true;
+        timedOut = true;
+      }
+
+      if (finished) {
+        results[job->index] = _finishPluginVst2xScanJob(job, timedOut);
+        jobs[i - 1] = jobs[numJobs - 1];
+        pollFds[i - 1] = pollFds[numJobs - 1];
+        numJobs--;
+      }
+    }
+  }
+
+  // Only reached if polling failed, in which case the remaining jobs are
+  // treated as if they timed out
+  for (i = 0; i < numJobs; i++) {
+    results[jobs[i]->index] = _finishPluginVst2xScanJob(jobs[i], true);
+  }
+
+  // Plugins which were never started due to an error
+  for (i = nextPlugin; i < numPlugins; i++) {
+    results[i] = _newFailedPluginVst2xIndexEntry(
+        pluginPaths[i], PLUGIN_VST2X_INDEX_STATUS_FAILED);
+  }
+
+  free(pollFds);
+  free(jobs);
+}
+#else
+static void _runPluginVst2xScanJobs(PluginVst2xScanner self,
+                                    CharString *pluginPaths,
+                                    const unsigned int numPlugins,
+                                    PluginVst2xIndexEntry *results) {
+  unsigned int i;
+
+  logWarn("Plugins will be scanned in-process, a crashing plugin will abort "
+          "the scan");
+
+  for (i = 0; i < numPlugins; i++) {
+    results[i] = self->probe(pluginPaths[i]);
+
+    if (results[i] == NULL) {
+      results[i] = _newFailedPluginVst2xIndexEntry(
+          pluginPaths[i], PLUGIN_VST2X_INDEX_STATUS_FAILED);
+    }
+  }
+}
+#endif
+
+unsigned int pluginVst2xScannerRun(PluginVst2xScanner self,
+                                   LinkedList pluginPaths,
+                                   PluginVst2xIndex index) {
+  CharString *pluginPathsArray = (CharString *)linkedListToArray(pluginPaths);
+  unsigned int numPlugins = (unsigned int)linkedListLength(pluginPaths);
+  unsigned int numScanned = 0;
+  PluginVst2xIndexEntry *results;
+  unsigned int i;
+
+  if (numPlugins == 0) {
+    free(pluginPathsArray);
+    return 0;
+  }
+
+  logInfo("Scanning %u plugins with %u jobs", numPlugins, self->maxJobs);
+  results = (PluginVst2xIndexEntry *)calloc(numPlugins,
+                                            sizeof(PluginVst2xIndexEntry));
+  _runPluginVst2xScanJobs(self, pluginPathsArray, numPlugins, results);
+
+  // Results are added in order so that plugins in the same location stay
+  // together, regardless of which order the scans finished in.
+  for (i = 0; i < numPlugins; i++) {
+    if (results[i]->status == PLUGIN_VST2X_INDEX_STATUS_OK) {
+      numScanned++;
+    }
+
+    pluginVst2xIndexAdd(index, results[i]);
+  }
+
+  free(results);
+  free(pluginPathsArray);
+  return numScanned;
+}
+
+void freePluginVst2xScanner(PluginVst2xScanner self) { free(self); }
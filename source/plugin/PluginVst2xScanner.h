@@ -0,0 +1,91 @@
+//
+// PluginVst2xScanner.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginVst2xScanner_h
+#define MrsWatson_PluginVst2xScanner_h
+
+#include "base/CharString.h"
+#include "base/LinkedList.h"
+#include "plugin/PluginVst2xIndex.h"
+
+#define PLUGIN_VST2X_SCANNER_DEFAULT_TIMEOUT_IN_MS 30000
+
+/**
+ * The scanner loads plugins in a pool of child processes, so that plugins can
+ * be scanned in parallel and a plugin which crashes or hangs only takes down
+ * its own process. Each child reports the plugin's metadata back to the parent
+ * through a pipe, using the same format as the index file. On platforms which
+ * do not support fork(), plugins are scanned serially in-process instead.
+ */
+
+/**
+ * Called in the scanning process to load a plugin and gather its metadata.
+ * @param pluginPath Absolute path to the plugin
+ * @return New index entry, or NULL if the plugin could not be loaded
+ */
+typedef PluginVst2xIndexEntry (*PluginVst2xScannerProbeFunc)(
+    const CharString pluginPath);
+
+typedef struct {
+  PluginVst2xScannerProbeFunc probe;
+  unsigned int maxJobs;
+  unsigned long timeoutInMs;
+} PluginVst2xScannerMembers;
+typedef PluginVst2xScannerMembers *PluginVst2xScanner;
+
+/**
+ * Create a new plugin scanner.
+ * @param probe Function used to load each plugin
+ * @param maxJobs Maximum number of plugins to scan at once. If 0, then the
+ * number of processors on this machine is used.
+ * @param timeoutInMs Time which each plugin may take to load before its scan
+ * is aborted. If 0, then PLUGIN_VST2X_SCANNER_DEFAULT_TIMEOUT_IN_MS is used.
+ * @return Initialized scanner
+ */
+PluginVst2xScanner newPluginVst2xScanner(PluginVst2xScannerProbeFunc probe,
+                                         unsigned int maxJobs,
+                                         unsigned long timeoutInMs);
+
+/**
+ * Scan a list of plugins and add the results to an index. Plugins which fail,
+ * crash, or time out are also added to the index with the respective status,
+ * in the same order as the list of plugin paths.
+ * @param self
+ * @param pluginPaths List of CharString with absolute paths to plugins
+ * @param index Index to add results to
+ * @return Number of plugins which were scanned successfully
+ */
+unsigned int pluginVst2xScannerRun(PluginVst2xScanner self,
+                                   LinkedList pluginPaths,
+                                   PluginVst2xIndex index);
+
+/**
+ * Free a plugin scanner.
+ * @param self
+ */
+void freePluginVst2xScanner(PluginVst2xScanner self);
+
+#endif
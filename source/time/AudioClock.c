@@ -26,19 +26,32 @@
 
 #include "AudioClock.h"
 
+#include "audio/AudioSettings.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 
 AudioClock audioClockInstance = NULL;
+// Clock used instead of the global instance on this thread, if any
+static THREAD_LOCAL AudioClock threadAudioClock = NULL;
 
 void initAudioClock(void) {
   audioClockInstance = (AudioClock)malloc(sizeof(AudioClockMembers));
   audioClockInstance->currentFrame = 0;
   audioClockInstance->transportChanged = false;
   audioClockInstance->isPlaying = false;
+  audioClockInstance->tempoMap = NULL;
+}
+
+AudioClock getAudioClock(void) {
+  return threadAudioClock != NULL ? threadAudioClock : audioClockInstance;
 }
 
-AudioClock getAudioClock(void) { return audioClockInstance; }
+AudioClock setThreadAudioClock(AudioClock audioClock) {
+  AudioClock previousClock = threadAudioClock;
+  threadAudioClock = audioClock;
+  return previousClock;
+}
 
 void advanceAudioClock(AudioClock self, const unsigned long blocksize) {
   if (self->currentFrame == 0 || !self->isPlaying) {
@@ -51,11 +64,32 @@ void advanceAudioClock(AudioClock self, const unsigned long blocksize) {
   self->currentFrame += blocksize;
 }
 
+void audioClockSeek(AudioClock self, const unsigned long frame) {
+  self->currentFrame = frame;
+  self->transportChanged = true;
+}
+
 void audioClockStop(AudioClock self) {
   self->isPlaying = false;
   self->transportChanged = true;
 }
 
+double audioClockGetBeatPosition(const AudioClock self) {
+  if (self->tempoMap != NULL) {
+    return tempoMapGetBeatForFrame(self->tempoMap, (double)self->currentFrame);
+  }
+
+  return (double)self->currentFrame * getTempo() / (getSampleRate() * 60.0);
+}
+
+double audioClockGetTempo(const AudioClock self) {
+  if (self->tempoMap != NULL) {
+    return tempoMapGetTempoAtFrame(self->tempoMap, (double)self->currentFrame);
+  }
+
+  return getTempo();
+}
+
 void freeAudioClock(AudioClock self) {
   if (self != NULL) {
     free(self);
@@ -28,6 +28,7 @@
 #define MrsWatson_AudioClock_h
 
 #include "base/Types.h"
+#include "time/TempoMap.h"
 
 /**
  * The AudioClock class keeps track of the sequence time and delivers the
@@ -40,6 +41,9 @@ typedef struct {
   boolByte transportChanged;
   boolByte isPlaying;
   unsigned long currentFrame;
+  // Tempo changes of the current sequence, or NULL to use the global tempo.
+  // The clock does not own the tempo map.
+  TempoMap tempoMap;
 } AudioClockMembers;
 typedef AudioClockMembers *AudioClock;
 extern AudioClock audioClockInstance;
@@ -53,11 +57,22 @@ void initAudioClock(void);
 
 /**
  * Get a reference to the global audio clock instance.
- * @return Reference to global audio clock, or NULL if the global instance has
- * not yet been initialized.
+ * @return Reference to the clock set for this thread with
+ * setThreadAudioClock(), otherwise the global audio clock, or NULL if the
+ * global instance has not yet been initialized.
  */
 AudioClock getAudioClock(void);
 
+/**
+ * Make getAudioClock() return another clock instead of the global one, but
+ * only for calls which are made from the current thread. This works in the
+ * same way as setThreadAudioSettings().
+ * @param audioClock Clock to use on this thread, or NULL to use the global
+ * instance again
+ * @return Clock which was used on this thread before this call, or NULL
+ */
+AudioClock setThreadAudioClock(AudioClock audioClock);
+
 /**
  * Advanced the global audio clock by a given number of samples. This should be
  * called after processing each block.
@@ -66,12 +81,35 @@ AudioClock getAudioClock(void);
  */
 void advanceAudioClock(AudioClock self, const unsigned long blocksize);
 
+/**
+ * Move the global audio clock to a given position, for example when rendering
+ * starts somewhere other than the beginning of the input. This is considered
+ * to be a transport change.
+ * @param self
+ * @param frame Position in sample frames
+ */
+void audioClockSeek(AudioClock self, const unsigned long frame);
+
 /**
  * Indicate that playback is stopped.
  * @param self
  */
 void audioClockStop(AudioClock self);
 
+/**
+ * Get the musical position of the clock, taking tempo changes into account
+ * when a tempo map is set.
+ * @param self
+ * @return Position in quarter notes, counted from 0
+ */
+double audioClockGetBeatPosition(const AudioClock self);
+
+/**
+ * @param self
+ * @return Tempo in beats per minute at the current position
+ */
+double audioClockGetTempo(const AudioClock self);
+
 /**
  * Free an audio clock instance and its associated resources.
  * @param self
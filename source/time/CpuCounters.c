@@ -0,0 +1,228 @@
+//
+// CpuCounters.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#if LINUX
+// Needed for syscall(), which is the only way to call perf_event_open()
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE 1
+#endif
+#endif
+
+#include "CpuCounters.h"
+
+#include "logging/EventLogger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if LINUX
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if UNIX
+#include <time.h>
+#elif WINDOWS
+#include <windows.h>
+#endif
+
+static const char *kCpuCounterNames[NUM_CPU_COUNTERS] = {
+    "cycles", "instructions", "LLC misses", "branch misses"};
+
+#if LINUX
+static const uint64_t kCpuCounterPerfEvents[NUM_CPU_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+static int _openPerfEvent(const uint64_t event, const int groupDescriptor) {
+  struct perf_event_attr attributes;
+
+  memset(&attributes, 0, sizeof(attributes));
+  attributes.size = sizeof(attributes);
+  attributes.type = PERF_TYPE_HARDWARE;
+  attributes.config = event;
+  // All counters are read at once from the group leader
+  attributes.read_format = PERF_FORMAT_GROUP;
+  attributes.exclude_kernel = 1;
+  attributes.exclude_hv = 1;
+
+  // Counting starts when the event is opened, for this thread on any CPU
+  return (int)syscall(__NR_perf_event_open, &attributes, 0, -1,
+                      groupDescriptor, 0);
+}
+#endif
+
+CpuCounters newCpuCounters(boolByte useHardwareCounters) {
+  CpuCounters self = (CpuCounters)malloc(sizeof(CpuCountersMembers));
+  unsigned int i;
+
+  for (i = 0; i < NUM_CPU_COUNTERS; i++) {
+    self->hasCounter[i] = false;
+    self->_fileDescriptors[i] = -1;
+    self->_startCounters[i] = 0;
+  }
+
+  self->_numOpenCounters = 0;
+  self->_startCpuTime = 0.0;
+
+#if LINUX
+  if (useHardwareCounters) {
+    int groupDescriptor = -1;
+
+    // Counters which the CPU does not support are left out of the group
+    for (i = 0; i < NUM_CPU_COUNTERS; i++) {
+      self->_fileDescriptors[i] =
+          _openPerfEvent(kCpuCounterPerfEvents[i], groupDescriptor);
+
+      if (self->_fileDescriptors[i] >= 0) {
+        self->hasCounter[i] = true;
+        self->_numOpenCounters++;
+
+        if (groupDescriptor < 0) {
+          groupDescriptor = self->_fileDescriptors[i];
+        }
+      }
+    }
+
+    if (self->_numOpenCounters == 0) {
+      logDebug("Hardware counters are not available, check the value of "
+               "/proc/sys/kernel/perf_event_paranoid");
+    }
+  }
+#else
+  if (useHardwareCounters) {
+    logUnsupportedFeature("Hardware counters on this platform");
+  }
+#endif
+
+  return self;
+}
+
+boolByte cpuCountersHasHardwareCounters(const CpuCounters self) {
+  return (boolByte)(self->_numOpenCounters > 0);
+}
+
+static double _getThreadCpuTime(void) {
+#if UNIX && defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec cpuTime;
+
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime) == 0) {
+    return (double)cpuTime.tv_sec * 1000.0 + (double)cpuTime.tv_nsec / 1.0e6;
+  }
+#elif WINDOWS
+  FILETIME creationTime, exitTime, kernelTime, userTime;
+  ULARGE_INTEGER kernel, user;
+
+  if (GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime,
+                     &kernelTime, &userTime)) {
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+    // Thread times are given in 100ns units
+    return (double)(kernel.QuadPart + user.QuadPart) / 10000.0;
+  }
+#endif
+
+  return 0.0;
+}
+
+// Read all open counters into an array indexed by counter type
+static boolByte _readCounters(CpuCounters self,
+                              uint64_t values[NUM_CPU_COUNTERS]) {
+#if LINUX
+  // The group is read as the number of counters, followed by their values in
+  // the order that they were opened
+  uint64_t groupValues[NUM_CPU_COUNTERS + 1];
+  const size_t readSize = (self->_numOpenCounters + 1) * sizeof(uint64_t);
+  unsigned int groupIndex = 0;
+  unsigned int i;
+
+  for (i = 0; i < NUM_CPU_COUNTERS; i++) {
+    if (self->hasCounter[i]) {
+      break;
+    }
+  }
+
+  if (i == NUM_CPU_COUNTERS ||
+      read(self->_fileDescriptors[i], groupValues, readSize) !=
+          (ssize_t)readSize) {
+    return false;
+  }
+
+  for (i = 0; i < NUM_CPU_COUNTERS; i++) {
+    values[i] = self->hasCounter[i] ? groupValues[1 + groupIndex++] : 0;
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+void cpuCountersStart(CpuCounters self) {
+  if (self->_numOpenCounters > 0) {
+    _readCounters(self, self->_startCounters);
+  }
+
+  self->_startCpuTime = _getThreadCpuTime();
+}
+
+void cpuCountersStop(CpuCounters self, CpuCounterTotals totals) {
+  const double stopCpuTime = _getThreadCpuTime();
+  uint64_t stopCounters[NUM_CPU_COUNTERS];
+  unsigned int i;
+
+  totals->cpuTimeInMs += stopCpuTime - self->_startCpuTime;
+  totals->numMeasurements++;
+
+  if (self->_numOpenCounters > 0 && _readCounters(self, stopCounters)) {
+    for (i = 0; i < NUM_CPU_COUNTERS; i++) {
+      totals->counters[i] += stopCounters[i] - self->_startCounters[i];
+    }
+  }
+}
+
+const char *cpuCounterGetName(const CpuCounterType counter) {
+  return counter < NUM_CPU_COUNTERS ? kCpuCounterNames[counter] : NULL;
+}
+
+void freeCpuCounters(CpuCounters self) {
+  if (self != NULL) {
+#if LINUX
+    unsigned int i;
+
+    for (i = 0; i < NUM_CPU_COUNTERS; i++) {
+      if (self->_fileDescriptors[i] >= 0) {
+        close(self->_fileDescriptors[i]);
+      }
+    }
+#endif
+
+    free(self);
+  }
+}
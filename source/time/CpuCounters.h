@@ -0,0 +1,117 @@
+//
+// CpuCounters.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_CpuCounters_h
+#define MrsWatson_CpuCounters_h
+
+#include "base/Types.h"
+
+#include <stdint.h>
+
+typedef enum {
+  CPU_COUNTER_CYCLES,
+  CPU_COUNTER_INSTRUCTIONS,
+  // Misses in the last level cache, which usually means a trip to main memory
+  CPU_COUNTER_CACHE_MISSES,
+  CPU_COUNTER_BRANCH_MISSES,
+  NUM_CPU_COUNTERS
+} CpuCounterType;
+
+typedef struct {
+  double cpuTimeInMs;
+  uint64_t counters[NUM_CPU_COUNTERS];
+  unsigned long numMeasurements;
+} CpuCounterTotalsMembers;
+
+/**
+ * Sums of the measurements taken with cpuCountersStop()
+ */
+typedef CpuCounterTotalsMembers *CpuCounterTotals;
+
+typedef struct {
+  // True for each hardware counter which could be opened
+  boolByte hasCounter[NUM_CPU_COUNTERS];
+
+  // Private fields
+  int _fileDescriptors[NUM_CPU_COUNTERS];
+  unsigned int _numOpenCounters;
+  double _startCpuTime;
+  uint64_t _startCounters[NUM_CPU_COUNTERS];
+} CpuCountersMembers;
+
+/**
+ * Measures the CPU time used by the calling thread, as opposed to the wall
+ * time measured by TaskTimer. A thread which is waiting on page faults, locks
+ * or I/O uses less CPU time than wall time.
+ *
+ * On Linux, hardware performance counters are also read when the kernel
+ * allows it, which depends on /proc/sys/kernel/perf_event_paranoid. Only
+ * events in user space are counted. The counters belong to the thread which
+ * created this object, so it must not be used from any other thread.
+ */
+typedef CpuCountersMembers *CpuCounters;
+
+/**
+ * Create a new set of counters for the calling thread
+ * @param useHardwareCounters True to try to open the hardware counters. If
+ * this fails, then only the CPU time is measured.
+ * @return CpuCounters instance
+ */
+CpuCounters newCpuCounters(boolByte useHardwareCounters);
+
+/**
+ * @param self
+ * @return True if any hardware counter is available
+ */
+boolByte cpuCountersHasHardwareCounters(const CpuCounters self);
+
+/**
+ * Start a measurement
+ * @param self
+ */
+void cpuCountersStart(CpuCounters self);
+
+/**
+ * Finish a measurement started with cpuCountersStart(), and add the results to
+ * a set of totals
+ * @param self
+ * @param totals Totals to add to
+ */
+void cpuCountersStop(CpuCounters self, CpuCounterTotals totals);
+
+/**
+ * @param counter Counter type
+ * @return Short human-readable name of the counter
+ */
+const char *cpuCounterGetName(const CpuCounterType counter);
+
+/**
+ * Free a set of counters and close any hardware counters
+ * @param self
+ */
+void freeCpuCounters(CpuCounters self);
+
+#endif
@@ -0,0 +1,135 @@
+//
+// TempoMap.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "TempoMap.h"
+
+#include "audio/AudioSettings.h"
+#include "base/MemoryTracker.h"
+#include "logging/EventLogger.h"
+
+#include <stdlib.h>
+
+#define TEMPO_MAP_INITIAL_CAPACITY 8
+
+static double _getFramesPerBeat(const TempoMap self, const double tempo) {
+  return self->sampleRate * 60.0 / tempo;
+}
+
+TempoMap newTempoMap(const double initialTempo) {
+  TempoMap tempoMap =
+      (TempoMap)trackedMalloc(MEMORY_TAG_MIDI, sizeof(TempoMapMembers));
+
+  tempoMap->sampleRate = getSampleRate();
+  tempoMap->numEntries = 1;
+  tempoMap->_capacity = TEMPO_MAP_INITIAL_CAPACITY;
+  tempoMap->entries = (TempoMapEntry)trackedMalloc(
+      MEMORY_TAG_MIDI, sizeof(TempoMapEntryMembers) * tempoMap->_capacity);
+
+  tempoMap->entries[0].beat = 0.0;
+  tempoMap->entries[0].frame = 0.0;
+  tempoMap->entries[0].tempo = initialTempo;
+  tempoMap->entries[0].framesPerBeat =
+      _getFramesPerBeat(tempoMap, initialTempo);
+
+  return tempoMap;
+}
+
+boolByte tempoMapAddTempo(TempoMap self, const double beat,
+                          const double tempo) {
+  TempoMapEntry last = &self->entries[self->numEntries - 1];
+
+  if (tempo <= 0.0) {
+    logError("Invalid tempo %g at beat %g", tempo, beat);
+    return false;
+  } else if (beat < last->beat) {
+    logError("Tempo change at beat %g comes before the previous one", beat);
+    return false;
+  }
+
+  // A later change at the same position replaces the earlier one
+  if (beat > last->beat) {
+    if (self->numEntries == self->_capacity) {
+      self->_capacity *= 2;
+      self->entries = (TempoMapEntry)trackedRealloc(
+          self->entries, MEMORY_TAG_MIDI,
+          sizeof(TempoMapEntryMembers) * self->_capacity);
+    }
+
+    self->entries[self->numEntries].beat = beat;
+    self->entries[self->numEntries].frame =
+        tempoMapGetFrameForBeat(self, beat);
+    self->numEntries++;
+    last = &self->entries[self->numEntries - 1];
+  }
+
+  last->tempo = tempo;
+  last->framesPerBeat = _getFramesPerBeat(self, tempo);
+  return true;
+}
+
+// Find the last entry which starts at or before the given position. Since the
+// entries are sorted by both beat and frame, either can be searched for.
+static TempoMapEntry _findEntry(const TempoMap self, const double position,
+                                const boolByte isFrame) {
+  size_t low = 0;
+  size_t high = self->numEntries;
+  size_t middle;
+  double start;
+
+  while (high - low > 1) {
+    middle = low + (high - low) / 2;
+    start = isFrame ? self->entries[middle].frame : self->entries[middle].beat;
+
+    if (start <= position) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+
+  return &self->entries[low];
+}
+
+double tempoMapGetFrameForBeat(const TempoMap self, const double beat) {
+  const TempoMapEntry entry = _findEntry(self, beat, false);
+  return entry->frame + (beat - entry->beat) * entry->framesPerBeat;
+}
+
+double tempoMapGetBeatForFrame(const TempoMap self, const double frame) {
+  const TempoMapEntry entry = _findEntry(self, frame, true);
+  return entry->beat + (frame - entry->frame) / entry->framesPerBeat;
+}
+
+double tempoMapGetTempoAtFrame(const TempoMap self, const double frame) {
+  return _findEntry(self, frame, true)->tempo;
+}
+
+void freeTempoMap(TempoMap self) {
+  if (self != NULL) {
+    trackedFree(self->entries);
+    trackedFree(self);
+  }
+}
@@ -0,0 +1,106 @@
+//
+// TempoMap.h - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_TempoMap_h
+#define MrsWatson_TempoMap_h
+
+#include "base/Types.h"
+
+#include <stddef.h>
+
+typedef struct {
+  // Musical position where this tempo starts, in quarter notes
+  double beat;
+  // Position of the same point in sample frames
+  double frame;
+  double tempo;
+  double framesPerBeat;
+} TempoMapEntryMembers;
+typedef TempoMapEntryMembers *TempoMapEntry;
+
+typedef struct {
+  SampleRate sampleRate;
+  size_t numEntries;
+  TempoMapEntry entries;
+
+  // Private fields
+  size_t _capacity;
+} TempoMapMembers;
+
+/**
+ * Holds every tempo change of a sequence, so that musical positions can be
+ * converted to sample frames and back. Each tempo change stores the frame it
+ * starts at, so a conversion only needs a binary search for the surrounding
+ * tempo change and a multiplication.
+ */
+typedef TempoMapMembers *TempoMap;
+
+/**
+ * Create a new tempo map. The sample rate is taken from the global audio
+ * settings.
+ * @param initialTempo Tempo at the start of the sequence, in beats per minute
+ * @return Initialized tempo map
+ */
+TempoMap newTempoMap(const double initialTempo);
+
+/**
+ * Add a tempo change. Changes must be added in order of their position.
+ * @param self
+ * @param beat Position of the change in quarter notes
+ * @param tempo New tempo in beats per minute
+ * @return True on success, false if the tempo or position is invalid
+ */
+boolByte tempoMapAddTempo(TempoMap self, const double beat,
+                          const double tempo);
+
+/**
+ * @param self
+ * @param beat Position in quarter notes
+ * @return Position in sample frames
+ */
+double tempoMapGetFrameForBeat(const TempoMap self, const double beat);
+
+/**
+ * @param self
+ * @param frame Position in sample frames
+ * @return Position in quarter notes, counted from 0
+ */
+double tempoMapGetBeatForFrame(const TempoMap self, const double frame);
+
+/**
+ * @param self
+ * @param frame Position in sample frames
+ * @return Tempo in beats per minute at the given position
+ */
+double tempoMapGetTempoAtFrame(const TempoMap self, const double frame);
+
+/**
+ * Free a tempo map and its associated resources
+ * @param self
+ */
+void freeTempoMap(TempoMap self);
+
+#endif
@@ -28,6 +28,7 @@
 
 #include "app/ProgramOption.h"
 #include "base/File.h"
+#include "base/MemoryTracker.h"
 #include "base/PlatformInfo.h"
 #include "unit/ApplicationRunner.h"
 
@@ -226,6 +227,8 @@ int main(int argc, char *argv[]) {
   char *colon;
   char *testCaseName;
 
+  // Must come before the first allocation, see memoryTrackerEnable()
+  memoryTrackerEnable();
   timer = newTaskTimer(NULL, NULL);
   taskTimerStart(timer);
 
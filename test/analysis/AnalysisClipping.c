@@ -26,10 +26,27 @@
 
 #include "AnalysisClipping.h"
 
+#include "audio/SampleBufferMath.h"
+
 #include <math.h>
 
 boolByte analysisClipping(const SampleBuffer sampleBuffer,
                           AnalysisFunctionData data) {
+  const SampleCount numSamples =
+      sampleBuffer->numChannels * sampleBuffer->blocksize;
+
+  // Most blocks do not clip at all, in which case the counter is just
+  // decremented once for each sample
+  if (sampleBufferGetPeak(sampleBuffer) < 1.0f) {
+    if ((SampleCount)data->consecutiveFailCounter > numSamples) {
+      data->consecutiveFailCounter -= (int)numSamples;
+    } else {
+      data->consecutiveFailCounter = 0;
+    }
+
+    return true;
+  }
+
   for (ChannelCount i = 0; i < sampleBuffer->numChannels; i++) {
     for (SampleCount j = 0; j < sampleBuffer->blocksize; j++) {
       if (fabs(sampleBuffer->samples[i][j]) >= 1.0f) {
@@ -26,9 +26,29 @@
 
 #include "AnalysisSilence.h"
 
+#include "audio/SampleBufferMath.h"
+
 boolByte analysisSilence(const SampleBuffer sampleBuffer,
                          AnalysisFunctionData data) {
   for (ChannelCount i = 0; i < sampleBuffer->numChannels; ++i) {
+    // If the entire channel is silent, the counter can be advanced at once
+    if (sampleBufferGetChannelPeak(sampleBuffer, i) == 0.0f) {
+      if (data->consecutiveFailCounter + (int)sampleBuffer->blocksize >
+          data->failTolerance) {
+        data->failedChannel = i;
+        data->failedSample =
+            data->failTolerance >= data->consecutiveFailCounter
+                ? (SampleCount)(data->failTolerance -
+                                data->consecutiveFailCounter)
+                : 0;
+        data->consecutiveFailCounter = data->failTolerance + 1;
+        return false;
+      }
+
+      data->consecutiveFailCounter += (int)sampleBuffer->blocksize;
+      continue;
+    }
+
     for (SampleCount j = 0; j < sampleBuffer->blocksize; ++j) {
       if (sampleBuffer->samples[i][j] == 0.0f) {
         data->consecutiveFailCounter++;
@@ -0,0 +1,168 @@
+//
+// MemoryMonitorTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "app/MemoryMonitor.h"
+
+#include "unit/TestRunner.h"
+
+#define TEST_MEGABYTE (1024 * 1024)
+#define TEST_NUM_SAMPLES                                                       \
+  (MEMORY_MONITOR_WARMUP_SAMPLES + MEMORY_MONITOR_MIN_TREND_SAMPLES)
+
+static int _testNewMemoryMonitor(void) {
+  MemoryMonitor monitor = newMemoryMonitor();
+  double growth = 0.0;
+
+  assertUnsignedLongEquals((unsigned long)MEMORY_MONITOR_DEFAULT_INTERVAL_IN_MS,
+                           monitor->intervalInMs);
+  assertUnsignedLongEquals(0ul, monitor->numSamples);
+  assertFalse(memoryMonitorGetResidentGrowth(monitor, &growth));
+  assertFalse(memoryMonitorGetHostGrowth(monitor, &growth));
+
+  freeMemoryMonitor(monitor);
+  return 0;
+}
+
+static int _testGrowthNeedsEnoughSamples(void) {
+  MemoryMonitor monitor = newMemoryMonitor();
+  double growth = 0.0;
+  int i;
+
+  for (i = 0; i < TEST_NUM_SAMPLES - 1; i++) {
+    memoryMonitorAddSample(monitor, (double)i, (size_t)(i + 1) * TEST_MEGABYTE,
+                           TEST_MEGABYTE);
+  }
+
+  assertFalse(memoryMonitorGetResidentGrowth(monitor, &growth));
+  memoryMonitorAddSample(monitor, (double)i, (size_t)(i + 1) * TEST_MEGABYTE,
+                         TEST_MEGABYTE);
+  assert(memoryMonitorGetResidentGrowth(monitor, &growth));
+
+  freeMemoryMonitor(monitor);
+  return 0;
+}
+
+static int _testResidentGrowth(void) {
+  MemoryMonitor monitor = newMemoryMonitor();
+  double residentGrowth = 0.0;
+  double hostGrowth = 0.0;
+  int i;
+
+  // One megabyte per minute of resident memory, and a flat host total
+  for (i = 0; i < TEST_NUM_SAMPLES * 2; i++) {
+    memoryMonitorAddSample(monitor, (double)i * 60.0,
+                           (size_t)(i + 10) * TEST_MEGABYTE, TEST_MEGABYTE);
+  }
+
+  assert(memoryMonitorGetResidentGrowth(monitor, &residentGrowth));
+  assertDoubleEquals(60.0, residentGrowth, TEST_DEFAULT_TOLERANCE);
+  assert(memoryMonitorGetHostGrowth(monitor, &hostGrowth));
+  assertDoubleEquals(0.0, hostGrowth, TEST_DEFAULT_TOLERANCE);
+
+  freeMemoryMonitor(monitor);
+  return 0;
+}
+
+static int _testWarmupSamplesAreIgnored(void) {
+  MemoryMonitor monitor = newMemoryMonitor();
+  double growth = 0.0;
+  int i;
+
+  // Memory grows quickly while warming up, and then stays flat
+  for (i = 0; i < TEST_NUM_SAMPLES * 2; i++) {
+    memoryMonitorAddSample(
+        monitor, (double)i,
+        (size_t)(i < MEMORY_MONITOR_WARMUP_SAMPLES ? i : 100) * TEST_MEGABYTE,
+        TEST_MEGABYTE);
+  }
+
+  assert(memoryMonitorGetResidentGrowth(monitor, &growth));
+  assertDoubleEquals(0.0, growth, TEST_DEFAULT_TOLERANCE);
+  assertSizeEquals((size_t)0, monitor->startResidentBytes);
+  assertSizeEquals((size_t)100 * TEST_MEGABYTE, monitor->peakResidentBytes);
+
+  freeMemoryMonitor(monitor);
+  return 0;
+}
+
+static int _testPeakResidentBytes(void) {
+  MemoryMonitor monitor = newMemoryMonitor();
+
+  memoryMonitorAddSample(monitor, 0.0, 10 * TEST_MEGABYTE, 0);
+  memoryMonitorAddSample(monitor, 1.0, 30 * TEST_MEGABYTE, 0);
+  memoryMonitorAddSample(monitor, 2.0, 20 * TEST_MEGABYTE, 0);
+
+  assertSizeEquals((size_t)10 * TEST_MEGABYTE, monitor->startResidentBytes);
+  assertSizeEquals((size_t)30 * TEST_MEGABYTE, monitor->peakResidentBytes);
+  assertSizeEquals((size_t)20 * TEST_MEGABYTE, monitor->currentResidentBytes);
+  assertUnsignedLongEquals(3ul, monitor->numSamples);
+
+  freeMemoryMonitor(monitor);
+  return 0;
+}
+
+static int _testUpdateWithinInterval(void) {
+  MemoryMonitor monitor = newMemoryMonitor();
+
+  monitor->intervalInMs = 1000000;
+  memoryMonitorStart(monitor);
+  memoryMonitorUpdate(monitor);
+  assertUnsignedLongEquals(1ul, monitor->numSamples);
+
+  // The report always takes a final sample
+  memoryMonitorReport(monitor);
+  assertUnsignedLongEquals(2ul, monitor->numSamples);
+
+  freeMemoryMonitor(monitor);
+  return 0;
+}
+
+static int _testUpdateAfterInterval(void) {
+  MemoryMonitor monitor = newMemoryMonitor();
+
+  monitor->intervalInMs = 1;
+  memoryMonitorStart(monitor);
+  taskTimerSleep(5);
+  memoryMonitorUpdate(monitor);
+  assertUnsignedLongEquals(2ul, monitor->numSamples);
+
+  freeMemoryMonitor(monitor);
+  return 0;
+}
+
+TestSuite addMemoryMonitorTests(void);
+TestSuite addMemoryMonitorTests(void) {
+  TestSuite testSuite = newTestSuite("MemoryMonitor", NULL, NULL);
+  addTest(testSuite, "NewMemoryMonitor", _testNewMemoryMonitor);
+  addTest(testSuite, "GrowthNeedsEnoughSamples",
+          _testGrowthNeedsEnoughSamples);
+  addTest(testSuite, "ResidentGrowth", _testResidentGrowth);
+  addTest(testSuite, "WarmupSamplesAreIgnored", _testWarmupSamplesAreIgnored);
+  addTest(testSuite, "PeakResidentBytes", _testPeakResidentBytes);
+  addTest(testSuite, "UpdateWithinInterval", _testUpdateWithinInterval);
+  addTest(testSuite, "UpdateAfterInterval", _testUpdateAfterInterval);
+  return testSuite;
+}
@@ -0,0 +1,329 @@
+//
+// MrsWatsonSessionTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "MrsWatsonSession.h"
+
+#include "audio/AudioSettings.h"
+#include "time/AudioClock.h"
+#include "unit/TestRunner.h"
+
+#if UNIX
+#include <pthread.h>
+#endif
+
+#define TEST_SESSION_NUM_FRAMES 100
+#define TEST_SESSION_NUM_BUFFERS 200
+
+static void _mrsWatsonSessionTestSetup(void) {
+  initAudioSettings();
+  initAudioClock();
+}
+
+static void _mrsWatsonSessionTestTeardown(void) {
+  freeAudioClock(getAudioClock());
+  freeAudioSettings();
+}
+
+static void _fillTestBuffers(float *left, float *right, float value) {
+  unsigned long i;
+
+  for (i = 0; i < TEST_SESSION_NUM_FRAMES; i++) {
+    left[i] = value;
+    right[i] = -value;
+  }
+}
+
+static int _testNewSession(void) {
+  MrsWatsonSession s = newMrsWatsonSession(48000.0, 2, 64);
+
+  assertNotNull(s);
+  assertIntEquals(0, mrsWatsonSessionGetNumPlugins(s));
+
+  freeMrsWatsonSession(s);
+  return 0;
+}
+
+static int _testNewSessionWithInvalidSettings(void) {
+  assertIsNull(newMrsWatsonSession(0.0, 2, 64));
+  assertIsNull(newMrsWatsonSession(44100.0, 0, 64));
+  assertIsNull(newMrsWatsonSession(44100.0, 2, 0));
+  return 0;
+}
+
+static int _testLoadPluginChain(void) {
+  MrsWatsonSession s = newMrsWatsonSession(44100.0, 2, 64);
+
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionLoadPluginChain(s, "mrs_gain;mrs_passthru",
+                                                  NULL));
+  assertIntEquals(2, mrsWatsonSessionGetNumPlugins(s));
+  assertUnsignedLongEquals(0ul, mrsWatsonSessionGetProcessingDelay(s));
+
+  // Only one chain can be loaded
+  assertIntEquals(RETURN_CODE_INVALID_PLUGIN_CHAIN,
+                  mrsWatsonSessionLoadPluginChain(s, "mrs_gain", NULL));
+
+  freeMrsWatsonSession(s);
+  return 0;
+}
+
+static int _testLoadInvalidPluginChain(void) {
+  MrsWatsonSession s = newMrsWatsonSession(44100.0, 2, 64);
+
+  assertIntEquals(RETURN_CODE_INVALID_PLUGIN_CHAIN,
+                  mrsWatsonSessionLoadPluginChain(s, "mrs_invalid", NULL));
+  assertIntEquals(0, mrsWatsonSessionGetNumPlugins(s));
+
+  freeMrsWatsonSession(s);
+  return 0;
+}
+
+static int _testProcessWithoutPluginChain(void) {
+  MrsWatsonSession s = newMrsWatsonSession(44100.0, 2, 64);
+  float left[TEST_SESSION_NUM_FRAMES];
+  float right[TEST_SESSION_NUM_FRAMES];
+  float *outputs[2];
+
+  outputs[0] = left;
+  outputs[1] = right;
+  assertIntEquals(RETURN_CODE_INVALID_PLUGIN_CHAIN,
+                  mrsWatsonSessionProcess(s, NULL, outputs, 10));
+
+  freeMrsWatsonSession(s);
+  return 0;
+}
+
+static int _testProcess(void) {
+  MrsWatsonSession s = newMrsWatsonSession(44100.0, 2, 64);
+  float inLeft[TEST_SESSION_NUM_FRAMES];
+  float inRight[TEST_SESSION_NUM_FRAMES];
+  float outLeft[TEST_SESSION_NUM_FRAMES];
+  float outRight[TEST_SESSION_NUM_FRAMES];
+  const float *inputs[2];
+  float *outputs[2];
+
+  inputs[0] = inLeft;
+  inputs[1] = inRight;
+  outputs[0] = outLeft;
+  outputs[1] = outRight;
+  _fillTestBuffers(inLeft, inRight, 0.5f);
+  _fillTestBuffers(outLeft, outRight, 0.0f);
+
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionLoadPluginChain(s, "mrs_gain", NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionSetParameter(s, 0, 0, 0.5f));
+  assertIntEquals(RETURN_CODE_INVALID_ARGUMENT,
+                  mrsWatsonSessionSetParameter(s, 1, 0, 0.5f));
+
+  // The buffer is longer than the blocksize, and not a multiple of it
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionProcess(s, inputs, outputs,
+                                          TEST_SESSION_NUM_FRAMES));
+  assertDoubleEquals(0.25, outLeft[0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(-0.25, outRight[63], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.25, outLeft[64], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(-0.25, outRight[TEST_SESSION_NUM_FRAMES - 1],
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeMrsWatsonSession(s);
+  return 0;
+}
+
+static int _testProcessSilence(void) {
+  MrsWatsonSession s = newMrsWatsonSession(44100.0, 2, 64);
+  float outLeft[TEST_SESSION_NUM_FRAMES];
+  float outRight[TEST_SESSION_NUM_FRAMES];
+  float *outputs[2];
+
+  outputs[0] = outLeft;
+  outputs[1] = outRight;
+  _fillTestBuffers(outLeft, outRight, 1.0f);
+
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionLoadPluginChain(s, "mrs_passthru", NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionProcess(s, NULL, outputs, 10));
+  assertDoubleEquals(0.0, outLeft[9], TEST_EXACT_TOLERANCE);
+  assertDoubleEquals(1.0, outLeft[10], TEST_EXACT_TOLERANCE);
+
+  freeMrsWatsonSession(s);
+  return 0;
+}
+
+static int _testMultipleSessions(void) {
+  MrsWatsonSession s1 = newMrsWatsonSession(44100.0, 2, 64);
+  MrsWatsonSession s2 = newMrsWatsonSession(96000.0, 1, 16);
+  float inLeft[TEST_SESSION_NUM_FRAMES];
+  float inRight[TEST_SESSION_NUM_FRAMES];
+  float outLeft[TEST_SESSION_NUM_FRAMES];
+  float outRight[TEST_SESSION_NUM_FRAMES];
+  const float *inputs[2];
+  float *outputs[2];
+
+  inputs[0] = inLeft;
+  inputs[1] = inRight;
+  outputs[0] = outLeft;
+  outputs[1] = outRight;
+  _fillTestBuffers(inLeft, inRight, 0.5f);
+
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionLoadPluginChain(s1, "mrs_gain", NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionLoadPluginChain(s2, "mrs_gain", NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionSetParameter(s2, 0, 0, 0.5f));
+  assertIntEquals(RETURN_CODE_SUCCESS, mrsWatsonSessionSetTempo(s2, 90.0));
+
+  // Each session keeps its own settings and position on the timeline
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionProcess(s2, inputs, outputs, 40));
+  assertDoubleEquals(0.25, outLeft[39], TEST_DEFAULT_TOLERANCE);
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionProcess(s1, inputs, outputs, 70));
+  assertDoubleEquals(0.5, outLeft[69], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(-0.5, outRight[69], TEST_DEFAULT_TOLERANCE);
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionProcess(s2, inputs, outputs, 10));
+  assertDoubleEquals(0.25, outLeft[9], TEST_DEFAULT_TOLERANCE);
+
+  // The process-wide settings and clock are not changed by any session
+  assertDoubleEquals(DEFAULT_SAMPLE_RATE, getSampleRate(),
+                     TEST_EXACT_TOLERANCE);
+  assertIntEquals(DEFAULT_NUM_CHANNELS, getNumChannels());
+  assertUnsignedLongEquals((unsigned long)DEFAULT_BLOCKSIZE, getBlocksize());
+  assertDoubleEquals(DEFAULT_TEMPO, getTempo(), TEST_EXACT_TOLERANCE);
+  assertUnsignedLongEquals(0ul, getAudioClock()->currentFrame);
+
+  freeMrsWatsonSession(s1);
+  freeMrsWatsonSession(s2);
+  return 0;
+}
+
+#if UNIX
+typedef struct {
+  MrsWatsonSession session;
+  float gain;
+  boolByte result;
+} SessionThreadArgs;
+
+static void *_processSessionThread(void *argsPtr) {
+  SessionThreadArgs *args = (SessionThreadArgs *)argsPtr;
+  float inLeft[TEST_SESSION_NUM_FRAMES];
+  float inRight[TEST_SESSION_NUM_FRAMES];
+  float outLeft[TEST_SESSION_NUM_FRAMES];
+  float outRight[TEST_SESSION_NUM_FRAMES];
+  const float *inputs[2];
+  float *outputs[2];
+  unsigned long i;
+
+  inputs[0] = inLeft;
+  inputs[1] = inRight;
+  outputs[0] = outLeft;
+  outputs[1] = outRight;
+  _fillTestBuffers(inLeft, inRight, 1.0f);
+  args->result = true;
+
+  for (i = 0; i < TEST_SESSION_NUM_BUFFERS; i++) {
+    if (mrsWatsonSessionProcess(args->session, inputs, outputs,
+                                TEST_SESSION_NUM_FRAMES) !=
+            RETURN_CODE_SUCCESS ||
+        outLeft[TEST_SESSION_NUM_FRAMES - 1] != args->gain) {
+      args->result = false;
+    }
+  }
+
+  return NULL;
+}
+
+static int _testProcessInParallel(void) {
+  SessionThreadArgs args[2];
+  pthread_t threads[2];
+  int i;
+
+  args[0].session = newMrsWatsonSession(44100.0, 2, 64);
+  args[0].gain = 1.0f;
+  args[1].session = newMrsWatsonSession(48000.0, 2, 32);
+  args[1].gain = 0.5f;
+
+  for (i = 0; i < 2; i++) {
+    assertIntEquals(RETURN_CODE_SUCCESS,
+                    mrsWatsonSessionLoadPluginChain(args[i].session,
+                                                    "mrs_gain", NULL));
+    assertIntEquals(RETURN_CODE_SUCCESS,
+                    mrsWatsonSessionSetParameter(args[i].session, 0, 0,
+                                                 args[i].gain));
+  }
+
+  for (i = 0; i < 2; i++) {
+    assertIntEquals(0, pthread_create(&threads[i], NULL,
+                                      _processSessionThread, &args[i]));
+  }
+
+  for (i = 0; i < 2; i++) {
+    pthread_join(threads[i], NULL);
+    assert(args[i].result);
+    freeMrsWatsonSession(args[i].session);
+  }
+
+  return 0;
+}
+#endif
+
+static int _testSendMidi(void) {
+  MrsWatsonSession s = newMrsWatsonSession(44100.0, 2, 64);
+
+  assertIntEquals(RETURN_CODE_SUCCESS,
+                  mrsWatsonSessionSendMidi(s, 100, 0x90, 60, 127));
+  assertIntEquals(RETURN_CODE_INVALID_ARGUMENT,
+                  mrsWatsonSessionSendMidi(s, 100, 0x10, 60, 127));
+  assertIntEquals(RETURN_CODE_SUCCESS, mrsWatsonSessionReset(s));
+
+  freeMrsWatsonSession(s);
+  return 0;
+}
+
+TestSuite addMrsWatsonSessionTests(void);
+TestSuite addMrsWatsonSessionTests(void) {
+  TestSuite testSuite =
+      newTestSuite("MrsWatsonSession", _mrsWatsonSessionTestSetup,
+                   _mrsWatsonSessionTestTeardown);
+  addTest(testSuite, "NewSession", _testNewSession);
+  addTest(testSuite, "NewSessionWithInvalidSettings",
+          _testNewSessionWithInvalidSettings);
+  addTest(testSuite, "LoadPluginChain", _testLoadPluginChain);
+  addTest(testSuite, "LoadInvalidPluginChain", _testLoadInvalidPluginChain);
+  addTest(testSuite, "ProcessWithoutPluginChain",
+          _testProcessWithoutPluginChain);
+  addTest(testSuite, "Process", _testProcess);
+  addTest(testSuite, "ProcessSilence", _testProcessSilence);
+  addTest(testSuite, "MultipleSessions", _testMultipleSessions);
+#if UNIX
+  addTest(testSuite, "ProcessInParallel", _testProcessInParallel);
+#endif
+  addTest(testSuite, "SendMidi", _testSendMidi);
+  return testSuite;
+}
@@ -0,0 +1,390 @@
+//
+// RenderDaemonTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "app/RenderDaemon.h"
+#include "audio/AudioSettings.h"
+#include "plugin/PluginPassthru.h"
+#include "plugin/PluginSilence.h"
+
+#include "unit/TestRunner.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_DAEMON_SOCKET "test_render_daemon.sock"
+#define TEST_DAEMON_OUTPUT "test_render_daemon.pcm"
+#define TEST_DAEMON_INPUT "test_render_daemon_input.pcm"
+#define TEST_DAEMON_COLD_OUTPUT "test_render_daemon_cold.pcm"
+#define TEST_DAEMON_AUTOMATION "test_render_daemon_automation.txt"
+#define TEST_DAEMON_INPUT_SIZE 32768
+
+static void _renderDaemonTestSetup(void) { initAudioSettings(); }
+
+static void _renderDaemonTestTeardown(void) {
+  unlink(TEST_DAEMON_OUTPUT);
+  unlink(TEST_DAEMON_INPUT);
+  unlink(TEST_DAEMON_COLD_OUTPUT);
+  unlink(TEST_DAEMON_AUTOMATION);
+  freeAudioSettings();
+}
+
+static RenderDaemon _newTestRenderDaemon(const unsigned int maxChains) {
+  CharString socketPath = newCharStringWithCString(TEST_DAEMON_SOCKET);
+  RenderDaemon daemon = newRenderDaemon(socketPath, NULL, maxChains);
+  freeCharString(socketPath);
+  return daemon;
+}
+
+static RenderDaemonJob _newTestRenderDaemonJob(const char *request) {
+  CharString text = newCharStringWithCString(request);
+  RenderDaemonJob job = newRenderDaemonJobWithString(text);
+  freeCharString(text);
+  return job;
+}
+
+static int _testNewJobWithString(void) {
+  RenderDaemonJob job = _newTestRenderDaemonJob("plugin\tmrs_gain,test.fxp\n"
+                                                "input\tin.wav\n"
+                                                "output\tout.wav\n"
+                                                "midi\tin.mid\n"
+                                                "parameter\t0,0.5\n"
+                                                "parameter\t1,0.25\n"
+                                                "max-time\t1500\n"
+                                                "automation\tauto.txt\n"
+                                                "io-blocksize\t4096\n"
+                                                "silence-bypass\t-80\n");
+  CharString parameter;
+
+  assertIntEquals(RENDER_DAEMON_COMMAND_RENDER, job->command);
+  assertCharStringEquals("mrs_gain,test.fxp", job->pluginChain);
+  assertCharStringEquals("in.wav", job->inputSource);
+  assertCharStringEquals("out.wav", job->outputSource);
+  assertCharStringEquals("in.mid", job->midiSource);
+  assertIntEquals(2, linkedListLength(job->parameters));
+  parameter = (CharString)job->parameters->item;
+  assertCharStringEquals("0,0.5", parameter);
+  assertUnsignedLongEquals(1500ul, job->maxTimeInMs);
+  assertCharStringEquals("auto.txt", job->automationFile);
+  assertUnsignedLongEquals(4096ul, (unsigned long)job->ioBlocksize);
+  assert(job->silenceBypass);
+  assertDoubleEquals(-80.0, job->silenceBypassThresholdInDb,
+                     TEST_DEFAULT_TOLERANCE);
+  assert(charStringIsEmpty(job->statusFile));
+
+  freeRenderDaemonJob(job);
+  return 0;
+}
+
+static int _testNewJobWithShutdownCommand(void) {
+  RenderDaemonJob job = _newTestRenderDaemonJob("command\tshutdown\n");
+  assertIntEquals(RENDER_DAEMON_COMMAND_SHUTDOWN, job->command);
+  freeRenderDaemonJob(job);
+  return 0;
+}
+
+static int _testNewJobWithInvalidKey(void) {
+  RenderDaemonJob job = _newTestRenderDaemonJob("plugin\tmrs_gain\n"
+                                                "invalid\tvalue\n");
+  assertIntEquals(RENDER_DAEMON_COMMAND_INVALID, job->command);
+  assertFalse(charStringIsEmpty(job->errorMessage));
+  freeRenderDaemonJob(job);
+  return 0;
+}
+
+static int _testNewJobWithMalformedLine(void) {
+  RenderDaemonJob job = _newTestRenderDaemonJob("plugin mrs_gain\n");
+  assertIntEquals(RENDER_DAEMON_COMMAND_INVALID, job->command);
+  freeRenderDaemonJob(job);
+  return 0;
+}
+
+static int _testGetJobResponse(void) {
+  RenderDaemonJob job = _newTestRenderDaemonJob("plugin\tmrs_gain\n");
+  CharString response;
+
+  job->result = RETURN_CODE_SUCCESS;
+  job->usedWarmChain = true;
+  job->framesWritten = 1234;
+  response = renderDaemonJobGetResponse(job);
+  assertNotNull(strstr(response->data, "status\tok\n"));
+  assertNotNull(strstr(response->data, "warm\t1\n"));
+  assertNotNull(strstr(response->data, "frames\t1234\n"));
+  assertIsNull(strstr(response->data, "error\t"));
+  freeCharString(response);
+
+  job->result = RETURN_CODE_IO_ERROR;
+  charStringCopyCString(job->errorMessage, "Bad\nthings");
+  response = renderDaemonJobGetResponse(job);
+  assertNotNull(strstr(response->data, "status\terror\n"));
+  assertNotNull(strstr(response->data, "error\tBad things\n"));
+  freeCharString(response);
+
+  freeRenderDaemonJob(job);
+  return 0;
+}
+
+static int _testGetChainIsWarm(void) {
+  RenderDaemon daemon = _newTestRenderDaemon(0);
+  CharString passthru = newCharStringWithCString(kInternalPluginPassthruName);
+  CharString silence = newCharStringWithCString(kInternalPluginSilenceName);
+  PluginChain pluginChain;
+  boolByte isWarm = true;
+
+  assertIntEquals(RENDER_DAEMON_DEFAULT_MAX_CHAINS, daemon->maxChains);
+  pluginChain = renderDaemonGetChain(daemon, passthru, &isWarm);
+  assertNotNull(pluginChain);
+  assertFalse(isWarm);
+  assert(pluginChain == renderDaemonGetChain(daemon, passthru, &isWarm));
+  assert(isWarm);
+  assert(pluginChain != renderDaemonGetChain(daemon, silence, &isWarm));
+  assertFalse(isWarm);
+  assertIntEquals(2, daemon->numChains);
+
+  freeCharString(passthru);
+  freeCharString(silence);
+  freeRenderDaemon(daemon);
+  return 0;
+}
+
+static int _testGetChainEvictsLeastRecentlyUsed(void) {
+  RenderDaemon daemon = _newTestRenderDaemon(2);
+  CharString passthru = newCharStringWithCString(kInternalPluginPassthruName);
+  CharString silence = newCharStringWithCString(kInternalPluginSilenceName);
+  CharString gain = newCharStringWithCString("mrs_gain");
+  boolByte isWarm;
+
+  assertNotNull(renderDaemonGetChain(daemon, passthru, &isWarm));
+  assertNotNull(renderDaemonGetChain(daemon, silence, &isWarm));
+  assertNotNull(renderDaemonGetChain(daemon, passthru, &isWarm));
+  assert(isWarm);
+  // The silence chain was used least recently, so it should be closed
+  assertNotNull(renderDaemonGetChain(daemon, gain, &isWarm));
+  assertIntEquals(2, daemon->numChains);
+  assertNotNull(renderDaemonGetChain(daemon, passthru, &isWarm));
+  assert(isWarm);
+  assertNotNull(renderDaemonGetChain(daemon, silence, &isWarm));
+  assertFalse(isWarm);
+
+  freeCharString(passthru);
+  freeCharString(silence);
+  freeCharString(gain);
+  freeRenderDaemon(daemon);
+  return 0;
+}
+
+static int _testGetInvalidChain(void) {
+  RenderDaemon daemon = _newTestRenderDaemon(0);
+  CharString invalid = newCharStringWithCString("mrs_invalid");
+  boolByte isWarm;
+
+  assertIsNull(renderDaemonGetChain(daemon, invalid, &isWarm));
+  assertIntEquals(0, daemon->numChains);
+
+  freeCharString(invalid);
+  freeRenderDaemon(daemon);
+  return 0;
+}
+
+static int _testRenderJob(void) {
+  RenderDaemon daemon = _newTestRenderDaemon(0);
+  RenderDaemonJob job = _newTestRenderDaemonJob(
+      "plugin\tmrs_silence\noutput\t" TEST_DAEMON_OUTPUT "\nmax-time\t100\n");
+  RenderDaemonJob secondJob = _newTestRenderDaemonJob(
+      "plugin\tmrs_silence\noutput\t" TEST_DAEMON_OUTPUT "\nmax-time\t100\n");
+
+  assert(renderDaemonRenderJob(daemon, job));
+  assertIntEquals(RETURN_CODE_SUCCESS, job->result);
+  assertFalse(job->usedWarmChain);
+  assert(job->framesWritten > 0);
+
+  assert(renderDaemonRenderJob(daemon, secondJob));
+  assert(secondJob->usedWarmChain);
+  assertUnsignedLongEquals(job->framesWritten, secondJob->framesWritten);
+
+  freeRenderDaemonJob(job);
+  freeRenderDaemonJob(secondJob);
+  freeRenderDaemon(daemon);
+  return 0;
+}
+
+static int _testRenderJobWithIoBlocksize(void) {
+  RenderDaemon daemon = _newTestRenderDaemon(0);
+  RenderDaemonJob job = _newTestRenderDaemonJob(
+      "plugin\tmrs_silence\noutput\t" TEST_DAEMON_OUTPUT "\nmax-time\t100\n");
+  RenderDaemonJob bufferedJob =
+      _newTestRenderDaemonJob("plugin\tmrs_silence\noutput\t" TEST_DAEMON_OUTPUT
+                              "\nmax-time\t100\nio-blocksize\t4096\n");
+
+  assert(renderDaemonRenderJob(daemon, job));
+  assert(renderDaemonRenderJob(daemon, bufferedJob));
+  assertUnsignedLongEquals(job->framesWritten, bufferedJob->framesWritten);
+
+  freeRenderDaemonJob(job);
+  freeRenderDaemonJob(bufferedJob);
+  freeRenderDaemon(daemon);
+  return 0;
+}
+
+static int _testRenderJobWithInvalidAutomation(void) {
+  RenderDaemon daemon = _newTestRenderDaemon(0);
+  RenderDaemonJob job = _newTestRenderDaemonJob(
+      "plugin\tmrs_silence\noutput\t" TEST_DAEMON_OUTPUT
+      "\nmax-time\t100\nautomation\tinvalid.txt\n");
+
+  assertFalse(renderDaemonRenderJob(daemon, job));
+  assertIntEquals(RETURN_CODE_IO_ERROR, job->result);
+  assertFalse(charStringIsEmpty(job->errorMessage));
+
+  freeRenderDaemonJob(job);
+  freeRenderDaemon(daemon);
+  return 0;
+}
+
+static void _writeTestFile(const char *path, const void *data,
+                           const size_t size) {
+  FILE *file = fopen(path, "wb");
+
+  if (file != NULL) {
+    fwrite(data, 1, size, file);
+    fclose(file);
+  }
+}
+
+static boolByte _testFilesAreEqual(const char *path, const char *otherPath) {
+  FILE *file = fopen(path, "rb");
+  FILE *otherFile = fopen(otherPath, "rb");
+  boolByte result = (boolByte)(file != NULL && otherFile != NULL);
+  int c;
+
+  while (result && (c = fgetc(file)) != EOF) {
+    result = (boolByte)(c == fgetc(otherFile));
+  }
+
+  if (result) {
+    result = (boolByte)(fgetc(otherFile) == EOF);
+  }
+
+  if (file != NULL) {
+    fclose(file);
+  }
+
+  if (otherFile != NULL) {
+    fclose(otherFile);
+  }
+
+  return result;
+}
+
+static int _testRenderJobAfterAutomationOnWarmChain(void) {
+  RenderDaemon daemon = _newTestRenderDaemon(0);
+  RenderDaemon coldDaemon = _newTestRenderDaemon(0);
+  RenderDaemonJob automatedJob = _newTestRenderDaemonJob(
+      "plugin\tmrs_passthru;mrs_gain\ninput\t" TEST_DAEMON_INPUT
+      "\noutput\t" TEST_DAEMON_OUTPUT "\nautomation\t" TEST_DAEMON_AUTOMATION
+      "\n");
+  RenderDaemonJob warmJob = _newTestRenderDaemonJob(
+      "plugin\tmrs_passthru;mrs_gain\ninput\t" TEST_DAEMON_INPUT
+      "\noutput\t" TEST_DAEMON_OUTPUT "\n");
+  RenderDaemonJob coldJob = _newTestRenderDaemonJob(
+      "plugin\tmrs_passthru;mrs_gain\ninput\t" TEST_DAEMON_INPUT
+      "\noutput\t" TEST_DAEMON_COLD_OUTPUT "\n");
+  const char automation[] = "0,1,0,0.25\n";
+  unsigned char input[TEST_DAEMON_INPUT_SIZE];
+
+  memset(input, 0x20, sizeof(input));
+  _writeTestFile(TEST_DAEMON_INPUT, input, sizeof(input));
+  _writeTestFile(TEST_DAEMON_AUTOMATION, automation, strlen(automation));
+
+  // The automation turns down the gain of the second plugin, which the warm
+  // chain must forget before the next job
+  assert(renderDaemonRenderJob(daemon, automatedJob));
+  assert(renderDaemonRenderJob(daemon, warmJob));
+  assert(warmJob->usedWarmChain);
+  assert(renderDaemonRenderJob(coldDaemon, coldJob));
+  assertFalse(coldJob->usedWarmChain);
+  assert(_testFilesAreEqual(TEST_DAEMON_OUTPUT, TEST_DAEMON_COLD_OUTPUT));
+
+  freeRenderDaemonJob(automatedJob);
+  freeRenderDaemonJob(warmJob);
+  freeRenderDaemonJob(coldJob);
+  freeRenderDaemon(daemon);
+  freeRenderDaemon(coldDaemon);
+  return 0;
+}
+
+static int _testRenderJobWithoutOutput(void) {
+  RenderDaemon daemon = _newTestRenderDaemon(0);
+  RenderDaemonJob job =
+      _newTestRenderDaemonJob("plugin\tmrs_silence\nmax-time\t100\n");
+
+  assertFalse(renderDaemonRenderJob(daemon, job));
+  assertIntEquals(RETURN_CODE_IO_ERROR, job->result);
+  assertFalse(charStringIsEmpty(job->errorMessage));
+
+  freeRenderDaemonJob(job);
+  freeRenderDaemon(daemon);
+  return 0;
+}
+
+static int _testRenderJobWithoutInput(void) {
+  RenderDaemon daemon = _newTestRenderDaemon(0);
+  RenderDaemonJob job = _newTestRenderDaemonJob(
+      "plugin\tmrs_passthru\noutput\t" TEST_DAEMON_OUTPUT "\n");
+
+  assertFalse(renderDaemonRenderJob(daemon, job));
+  assertIntEquals(RETURN_CODE_IO_ERROR, job->result);
+
+  freeRenderDaemonJob(job);
+  freeRenderDaemon(daemon);
+  return 0;
+}
+
+TestSuite addRenderDaemonTests(void);
+TestSuite addRenderDaemonTests(void) {
+  TestSuite testSuite = newTestSuite("RenderDaemon", _renderDaemonTestSetup,
+                                     _renderDaemonTestTeardown);
+
+  addTest(testSuite, "NewJobWithString", _testNewJobWithString);
+  addTest(testSuite, "NewJobWithShutdownCommand",
+          _testNewJobWithShutdownCommand);
+  addTest(testSuite, "NewJobWithInvalidKey", _testNewJobWithInvalidKey);
+  addTest(testSuite, "NewJobWithMalformedLine", _testNewJobWithMalformedLine);
+  addTest(testSuite, "GetJobResponse", _testGetJobResponse);
+  addTest(testSuite, "GetChainIsWarm", _testGetChainIsWarm);
+  addTest(testSuite, "GetChainEvictsLeastRecentlyUsed",
+          _testGetChainEvictsLeastRecentlyUsed);
+  addTest(testSuite, "GetInvalidChain", _testGetInvalidChain);
+  addTest(testSuite, "RenderJob", _testRenderJob);
+  addTest(testSuite, "RenderJobWithIoBlocksize", _testRenderJobWithIoBlocksize);
+  addTest(testSuite, "RenderJobWithInvalidAutomation",
+          _testRenderJobWithInvalidAutomation);
+  addTest(testSuite, "RenderJobAfterAutomationOnWarmChain",
+          _testRenderJobAfterAutomationOnWarmChain);
+  addTest(testSuite, "RenderJobWithoutOutput", _testRenderJobWithoutOutput);
+  addTest(testSuite, "RenderJobWithoutInput", _testRenderJobWithoutInput);
+
+  return testSuite;
+}
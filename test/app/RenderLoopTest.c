@@ -0,0 +1,176 @@
+//
+// RenderLoopTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "app/RenderLoop.h"
+#include "audio/AudioSettings.h"
+#include "plugin/PluginPassthru.h"
+#include "time/AudioClock.h"
+
+#include "unit/TestRunner.h"
+
+#define TEST_RENDER_LOOP_OUTPUT "test_render_loop.pcm"
+
+static void _renderLoopTestSetup(void) {
+  initAudioSettings();
+  // The clock is shared by all tests in the suite
+  audioClockSeek(getAudioClock(), 0);
+}
+
+static void _renderLoopTestTeardown(void) {
+  unlink(TEST_RENDER_LOOP_OUTPUT);
+  freeAudioSettings();
+}
+
+static PluginChain _newTestPluginChain(void) {
+  CharString pluginName = newCharStringWithCString(kInternalPluginPassthruName);
+  PluginChain pluginChain = newPluginChain();
+
+  pluginChainAppend(pluginChain, newPluginPassthru(pluginName), NULL);
+  pluginChainInitialize(pluginChain);
+  freeCharString(pluginName);
+  return pluginChain;
+}
+
+static RenderLoop _newTestRenderLoop(PluginChain pluginChain) {
+  CharString outputName = newCharStringWithCString(TEST_RENDER_LOOP_OUTPUT);
+  SampleSource inputSource = sampleSourceFactory(NULL);
+  SampleSource outputSource = sampleSourceFactory(outputName);
+
+  inputSource->openSampleSource(inputSource, SAMPLE_SOURCE_OPEN_READ);
+  outputSource->openSampleSource(outputSource, SAMPLE_SOURCE_OPEN_WRITE);
+  freeCharString(outputName);
+  return newRenderLoop(pluginChain, inputSource, outputSource, "Test");
+}
+
+// Close and free the sources along with the loop. Returns the number of
+// frames which were written to the output source.
+static unsigned long _freeTestRenderLoop(RenderLoop renderLoop) {
+  unsigned long framesWritten =
+      renderLoop->outputSource->numSamplesProcessed / getNumChannels();
+
+  renderLoop->inputSource->closeSampleSource(renderLoop->inputSource);
+  renderLoop->outputSource->closeSampleSource(renderLoop->outputSource);
+  freeSampleSource(renderLoop->inputSource);
+  freeSampleSource(renderLoop->outputSource);
+  freeRenderLoop(renderLoop);
+  return framesWritten;
+}
+
+static int _testNewObject(void) {
+  PluginChain pluginChain = _newTestPluginChain();
+  RenderLoop renderLoop = _newTestRenderLoop(pluginChain);
+
+  assertIsNull(renderLoop->midiSequence);
+  assertIsNull(renderLoop->automation);
+  assertIsNull(renderLoop->tail);
+  assertUnsignedLongEquals(0ul, renderLoop->maxTimeInFrames);
+  assertUnsignedLongEquals(0ul, renderLoop->endFrame);
+  assertNotNull(renderLoop->inputTimer);
+  assertNotNull(renderLoop->outputTimer);
+
+  renderLoopPrepare(renderLoop);
+  assertNotNull(renderLoop->tail);
+
+  _freeTestRenderLoop(renderLoop);
+  freePluginChain(pluginChain);
+  return 0;
+}
+
+static int _testProcessWithMaxTime(void) {
+  PluginChain pluginChain = _newTestPluginChain();
+  RenderLoop renderLoop = _newTestRenderLoop(pluginChain);
+
+  renderLoop->maxTimeInFrames = 1000;
+  renderLoopPrepare(renderLoop);
+  renderLoopProcess(renderLoop);
+  assertFalse(getAudioClock()->isPlaying);
+  assert(_freeTestRenderLoop(renderLoop) >= 1000ul);
+
+  freePluginChain(pluginChain);
+  return 0;
+}
+
+static int _testProcessWithMaxTimeAfterPreRoll(void) {
+  PluginChain pluginChain = _newTestPluginChain();
+  RenderLoop renderLoop = _newTestRenderLoop(pluginChain);
+
+  renderLoop->startFrame = 2000;
+  renderLoop->seekFrame = 0;
+  renderLoop->maxTimeInFrames = 1000;
+  renderLoopPrepare(renderLoop);
+  renderLoopProcess(renderLoop);
+  assert(getAudioClock()->currentFrame >= 3000ul);
+  assert(_freeTestRenderLoop(renderLoop) >= 1000ul);
+
+  freePluginChain(pluginChain);
+  return 0;
+}
+
+static int _testProcessWithEndFrame(void) {
+  PluginChain pluginChain = _newTestPluginChain();
+  RenderLoop renderLoop = _newTestRenderLoop(pluginChain);
+
+  renderLoop->endFrame = 1000;
+  renderLoopPrepare(renderLoop);
+  renderLoopProcess(renderLoop);
+  assertUnsignedLongEquals(1000ul, getAudioClock()->currentFrame);
+  assertUnsignedLongEquals(1000ul, _freeTestRenderLoop(renderLoop));
+
+  freePluginChain(pluginChain);
+  return 0;
+}
+
+static int _testProcessWithIoBlocksize(void) {
+  PluginChain pluginChain = _newTestPluginChain();
+  RenderLoop renderLoop = _newTestRenderLoop(pluginChain);
+  SampleSource outputSource = renderLoop->outputSource;
+
+  renderLoop->endFrame = 1000;
+  renderLoop->ioBlocksize = getBlocksize() * 4;
+  renderLoopPrepare(renderLoop);
+  // The output is wrapped, but the silent input is not
+  assert(renderLoop->outputSource != outputSource);
+  renderLoopProcess(renderLoop);
+  assertUnsignedLongEquals(1000ul, _freeTestRenderLoop(renderLoop));
+
+  freePluginChain(pluginChain);
+  return 0;
+}
+
+TestSuite addRenderLoopTests(void);
+TestSuite addRenderLoopTests(void) {
+  TestSuite testSuite = newTestSuite("RenderLoop", _renderLoopTestSetup,
+                                     _renderLoopTestTeardown);
+
+  addTest(testSuite, "NewObject", _testNewObject);
+  addTest(testSuite, "ProcessWithMaxTime", _testProcessWithMaxTime);
+  addTest(testSuite, "ProcessWithMaxTimeAfterPreRoll",
+          _testProcessWithMaxTimeAfterPreRoll);
+  addTest(testSuite, "ProcessWithEndFrame", _testProcessWithEndFrame);
+  addTest(testSuite, "ProcessWithIoBlocksize", _testProcessWithIoBlocksize);
+
+  return testSuite;
+}
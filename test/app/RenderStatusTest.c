@@ -0,0 +1,238 @@
+//
+// RenderStatusTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "app/RenderStatus.h"
+
+#include "audio/AudioSettings.h"
+#include "base/File.h"
+#include "unit/TestRunner.h"
+
+#include "plugin/PluginMock.h"
+
+#define TEST_STATUS_JSON_FILE "test_render_status.json"
+#define TEST_STATUS_PROMETHEUS_FILE "test_render_status.prom"
+#define TEST_STATUS_SHM_NAME "mrswatson_test_render_status"
+
+static void _renderStatusTestSetup(void) {
+  initAudioSettings();
+  initPluginChain();
+  pluginChainAppend(getPluginChain(), newPluginMock(), NULL);
+}
+
+static void _renderStatusTestTeardown(void) {
+  unlink(TEST_STATUS_JSON_FILE);
+  unlink(TEST_STATUS_PROMETHEUS_FILE);
+  freePluginChain(getPluginChain());
+  freeAudioSettings();
+}
+
+static CharString _readStatusFile(const char *filename) {
+  File file = newFileWithPathCString(filename);
+  CharString contents = fileReadContents(file);
+  freeFile(file);
+  return contents;
+}
+
+static RenderStatus _newTestRenderStatus(const char *filename) {
+  RenderStatus status = newRenderStatus();
+  CharString statusFile = newCharStringWithCString(filename);
+  renderStatusSetFile(status, statusFile);
+  freeCharString(statusFile);
+  return status;
+}
+
+static int _testNewRenderStatus(void) {
+  RenderStatus status = newRenderStatus();
+
+  assertIntEquals(RENDER_STATUS_STATE_STARTING, status->state);
+  assertUnsignedLongEquals((unsigned long)RENDER_STATUS_DEFAULT_INTERVAL_IN_MS,
+                           status->intervalInMs);
+  assertIntEquals(0, status->numPlugins);
+  assertDoubleEquals(-1.0, status->etaSeconds, TEST_DEFAULT_TOLERANCE);
+
+  freeRenderStatus(status);
+  return 0;
+}
+
+static int _testWriteJsonFile(void) {
+  RenderStatus status = _newTestRenderStatus(TEST_STATUS_JSON_FILE);
+  CharString contents;
+
+  renderStatusStart(status, getPluginChain(), 100, 1100);
+  contents = _readStatusFile(TEST_STATUS_JSON_FILE);
+  assertNotNull(contents);
+  assertCharStringContains("\"state\": \"running\"", contents);
+  assertCharStringContains("\"total_frames\": 1100", contents);
+  freeCharString(contents);
+
+  renderStatusFinish(status, getPluginChain(), 600);
+  contents = _readStatusFile(TEST_STATUS_JSON_FILE);
+  assertNotNull(contents);
+  assertCharStringContains("\"state\": \"finished\"", contents);
+  assertCharStringContains("\"frames_processed\": 500", contents);
+  assertCharStringContains("\"position\": 600", contents);
+  assertCharStringContains("\"name\": \"Mock\"", contents);
+  assertCharStringContains("\"deadline_misses\": 0", contents);
+  freeCharString(contents);
+
+  freeRenderStatus(status);
+  return 0;
+}
+
+static int _testWritePrometheusFile(void) {
+  RenderStatus status = _newTestRenderStatus(TEST_STATUS_PROMETHEUS_FILE);
+  CharString contents;
+
+  renderStatusStart(status, getPluginChain(), 0, 0);
+  renderStatusFinish(status, getPluginChain(), 500);
+  contents = _readStatusFile(TEST_STATUS_PROMETHEUS_FILE);
+  assertNotNull(contents);
+  assertCharStringContains("mrswatson_state{state=\"finished\"} 1", contents);
+  assertCharStringContains("mrswatson_state{state=\"running\"} 0", contents);
+  assertCharStringContains("mrswatson_frames_processed_total 500", contents);
+  assertCharStringContains("mrswatson_total_frames 0", contents);
+  assertCharStringContains(
+      "mrswatson_plugin_deadline_misses_total{index=\"0\",plugin=\"Mock\"} 0",
+      contents);
+  freeCharString(contents);
+
+  freeRenderStatus(status);
+  return 0;
+}
+
+static int _testStatusFileIsReplaced(void) {
+  RenderStatus status = _newTestRenderStatus(TEST_STATUS_JSON_FILE);
+  File tempFile = newFileWithPathCString(TEST_STATUS_JSON_FILE ".tmp");
+
+  renderStatusStart(status, getPluginChain(), 0, 1000);
+  renderStatusFinish(status, getPluginChain(), 1000);
+  assertFalse(fileExists(tempFile));
+
+  freeFile(tempFile);
+  freeRenderStatus(status);
+  return 0;
+}
+
+static int _testUpdateWithinInterval(void) {
+  RenderStatus status = _newTestRenderStatus(TEST_STATUS_JSON_FILE);
+
+  status->intervalInMs = 60 * 1000;
+  renderStatusStart(status, getPluginChain(), 0, 1000);
+  renderStatusUpdate(status, getPluginChain(), 500);
+  assertUnsignedLongEquals(0ul, status->updateCount);
+  assertUnsignedLongEquals(0ul, status->position);
+
+  freeRenderStatus(status);
+  return 0;
+}
+
+static int _testUpdateCountsDeadlineMisses(void) {
+  RenderStatus status = _newTestRenderStatus(TEST_STATUS_JSON_FILE);
+  PluginChain pluginChain = getPluginChain();
+
+  status->intervalInMs = 0;
+  renderStatusStart(status, pluginChain, 0, 1000);
+  pluginChain->numDeadlineMisses[0] = 3;
+  renderStatusUpdate(status, pluginChain, 500);
+  assertUnsignedLongEquals(1ul, status->updateCount);
+  assertUnsignedLongEquals(500ul, status->framesProcessed);
+  assertUnsignedLongEquals(3ul, status->deadlineMisses[0]);
+
+  freeRenderStatus(status);
+  return 0;
+}
+
+static int _testFinishWithoutTotalLength(void) {
+  RenderStatus status = _newTestRenderStatus(TEST_STATUS_JSON_FILE);
+
+  status->intervalInMs = 0;
+  renderStatusStart(status, getPluginChain(), 0, 0);
+  renderStatusUpdate(status, getPluginChain(), 500);
+  assertDoubleEquals(-1.0, status->etaSeconds, TEST_DEFAULT_TOLERANCE);
+  renderStatusFinish(status, getPluginChain(), 1000);
+  assertIntEquals(RENDER_STATUS_STATE_FINISHED, status->state);
+  assertDoubleEquals(0.0, status->etaSeconds, TEST_DEFAULT_TOLERANCE);
+
+  freeRenderStatus(status);
+  return 0;
+}
+
+static int _testSharedMemorySegment(void) {
+  RenderStatus status = newRenderStatus();
+  CharString name = newCharStringWithCString(TEST_STATUS_SHM_NAME);
+  RenderStatusSegment *segment;
+
+  assert(renderStatusOpenSharedMemory(status, name));
+  segment = status->_segment;
+  assertNotNull(segment);
+  assertUnsignedLongEquals((unsigned long)RENDER_STATUS_SEGMENT_MAGIC,
+                           segment->magic);
+  assertUnsignedLongEquals((unsigned long)RENDER_STATUS_SEGMENT_VERSION,
+                           segment->version);
+
+  renderStatusStart(status, getPluginChain(), 0, 1000);
+  renderStatusFinish(status, getPluginChain(), 1000);
+  assertIntEquals(RENDER_STATUS_STATE_FINISHED, segment->state);
+  assertUnsignedLongEquals(0ul, segment->sequence % 2);
+  assertUnsignedLongEquals(1000ul, segment->framesProcessed);
+  assertUnsignedLongEquals(1ul, segment->numPlugins);
+  assertIntEquals(0, strcmp("Mock", segment->plugins[0].name));
+
+  freeCharString(name);
+  freeRenderStatus(status);
+  return 0;
+}
+
+static int _testOpenSharedMemoryWithoutName(void) {
+  RenderStatus status = newRenderStatus();
+  CharString name = newCharString();
+
+  assertFalse(renderStatusOpenSharedMemory(status, name));
+  assertIsNull(status->_segment);
+
+  freeCharString(name);
+  freeRenderStatus(status);
+  return 0;
+}
+
+TestSuite addRenderStatusTests(void);
+TestSuite addRenderStatusTests(void) {
+  TestSuite testSuite = newTestSuite("RenderStatus", _renderStatusTestSetup,
+                                     _renderStatusTestTeardown);
+  addTest(testSuite, "NewRenderStatus", _testNewRenderStatus);
+  addTest(testSuite, "WriteJsonFile", _testWriteJsonFile);
+  addTest(testSuite, "WritePrometheusFile", _testWritePrometheusFile);
+  addTest(testSuite, "StatusFileIsReplaced", _testStatusFileIsReplaced);
+  addTest(testSuite, "UpdateWithinInterval", _testUpdateWithinInterval);
+  addTest(testSuite, "UpdateCountsDeadlineMisses",
+          _testUpdateCountsDeadlineMisses);
+  addTest(testSuite, "FinishWithoutTotalLength",
+          _testFinishWithoutTotalLength);
+  addTest(testSuite, "SharedMemorySegment", _testSharedMemorySegment);
+  addTest(testSuite, "OpenSharedMemoryWithoutName",
+          _testOpenSharedMemoryWithoutName);
+  return testSuite;
+}
@@ -0,0 +1,79 @@
+//
+// DenormalsTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/Denormals.h"
+
+#include "unit/TestRunner.h"
+
+static int _testCountDenormals(void) {
+  SampleBuffer s = newSampleBuffer(2, 8);
+
+  s->samples[0][1] = 1.0e-40f;
+  s->samples[0][2] = 0.5f;
+  s->samples[1][3] = -1.0e-42f;
+  s->samples[1][4] = 1.0e-37f;
+  assertUnsignedLongEquals(2ul, denormalsCountInSampleBuffer(s));
+
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testCountDenormalsInSilence(void) {
+  SampleBuffer s = newSampleBuffer(2, 8);
+  assertUnsignedLongEquals(0ul, denormalsCountInSampleBuffer(s));
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testSetFlushToZero(void) {
+  volatile float small = 1.0e-30f;
+  volatile float result;
+
+  if (!denormalsSetFlushToZero(true)) {
+    // Not supported on this platform, so there is nothing else to test
+    return 0;
+  }
+
+  assert(denormalsIsFlushToZeroEnabled());
+  result = small * 1.0e-10f;
+  assertDoubleEquals(0.0, result, 0.0);
+
+  assert(denormalsSetFlushToZero(false));
+  assertFalse(denormalsIsFlushToZeroEnabled());
+  result = small * 1.0e-10f;
+  assert(result > 0.0f);
+
+  return 0;
+}
+
+TestSuite addDenormalsTests(void);
+TestSuite addDenormalsTests(void) {
+  TestSuite testSuite = newTestSuite("Denormals", NULL, NULL);
+  addTest(testSuite, "CountDenormals", _testCountDenormals);
+  addTest(testSuite, "CountDenormalsInSilence", _testCountDenormalsInSilence);
+  addTest(testSuite, "SetFlushToZero", _testSetFlushToZero);
+  return testSuite;
+}
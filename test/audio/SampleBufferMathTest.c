@@ -0,0 +1,220 @@
+//
+// SampleBufferMathTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/SampleBufferMath.h"
+
+#include "unit/TestRunner.h"
+
+// Use a blocksize which is not a multiple of the SIMD width, so that the
+// scalar code which handles the remaining samples is also tested
+#define TEST_BLOCKSIZE 11
+
+static SampleBuffer _newTestSampleBuffer(ChannelCount numChannels) {
+  SampleBuffer s = newSampleBuffer(numChannels, TEST_BLOCKSIZE);
+  ChannelCount channel;
+  SampleCount i;
+
+  for (channel = 0; channel < s->numChannels; channel++) {
+    for (i = 0; i < s->blocksize; i++) {
+      s->samples[channel][i] = 0.1f * (Sample)(i + 1) * (i % 2 ? -1.0f : 1.0f);
+    }
+  }
+
+  return s;
+}
+
+static int _testApplyGain(void) {
+  SampleBuffer s = _newTestSampleBuffer(2);
+  SampleCount i;
+
+  sampleBufferApplyGain(s, 0.5f);
+  for (i = 0; i < s->blocksize; i++) {
+    assertDoubleEquals(0.05 * (i + 1) * (i % 2 ? -1.0 : 1.0),
+                       s->samples[1][i], TEST_DEFAULT_TOLERANCE);
+  }
+
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testApplyGainRamp(void) {
+  SampleBuffer s = newSampleBuffer(1, TEST_BLOCKSIZE);
+  SampleCount i;
+
+  for (i = 0; i < s->blocksize; i++) {
+    s->samples[0][i] = 1.0f;
+  }
+
+  sampleBufferApplyGainRamp(s, 0.0f, 1.0f);
+  for (i = 0; i < s->blocksize; i++) {
+    assertDoubleEquals((double)i / TEST_BLOCKSIZE, s->samples[0][i],
+                       TEST_DEFAULT_TOLERANCE);
+  }
+
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testMix(void) {
+  SampleBuffer s = _newTestSampleBuffer(2);
+  SampleBuffer other = _newTestSampleBuffer(1);
+
+  s->samples[1][1] = 0.25f;
+  other->samples[0][1] = -0.375f;
+  s->samples[1][10] = 0.5f;
+  other->samples[0][10] = 0.25f;
+  assert(sampleBufferMix(s, other, 2.0f));
+  assertDoubleEquals(0.3, s->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(-0.5, s->samples[1][1], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, s->samples[1][10], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(s);
+  freeSampleBuffer(other);
+  return 0;
+}
+
+static int _testMixDifferentSizes(void) {
+  SampleBuffer s = _newTestSampleBuffer(2);
+  SampleBuffer other = newSampleBuffer(2, TEST_BLOCKSIZE + 1);
+
+  assertFalse(sampleBufferMix(s, other, 1.0f));
+
+  freeSampleBuffer(s);
+  freeSampleBuffer(other);
+  return 0;
+}
+
+static int _testClip(void) {
+  SampleBuffer s = _newTestSampleBuffer(2);
+
+  sampleBufferClip(s, 0.5f);
+  assertDoubleEquals(0.1, s->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(-0.4, s->samples[0][3], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(-0.5, s->samples[0][5], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.5, s->samples[1][10], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testGetPeak(void) {
+  SampleBuffer s = _newTestSampleBuffer(2);
+
+  assertDoubleEquals(1.1, sampleBufferGetPeak(s), TEST_DEFAULT_TOLERANCE);
+  s->samples[1][9] = -2.0f;
+  assertDoubleEquals(2.0, sampleBufferGetPeak(s), TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.1, sampleBufferGetChannelPeak(s, 0),
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testGetPeakOfSilence(void) {
+  SampleBuffer s = newSampleBuffer(2, TEST_BLOCKSIZE);
+  assertDoubleEquals(0.0, sampleBufferGetPeak(s), TEST_DEFAULT_TOLERANCE);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testIsSilent(void) {
+  // Long enough for the vectorized check to be used
+  SampleBuffer s = newSampleBuffer(2, 37);
+
+  assert(sampleBufferIsSilent(s, 0.0f));
+  // Check both the vectorized part and the remaining samples at the end
+  s->samples[1][1] = -0.25f;
+  assertFalse(sampleBufferIsSilent(s, 0.0f));
+  assert(sampleBufferIsSilent(s, 0.25f));
+  s->samples[1][1] = 0.0f;
+  s->samples[1][36] = 0.001f;
+  assertFalse(sampleBufferIsSilent(s, 0.0f));
+  assert(sampleBufferIsSilent(s, 0.01f));
+
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testGetRms(void) {
+  SampleBuffer s = newSampleBuffer(2, TEST_BLOCKSIZE);
+  SampleCount i;
+
+  for (i = 0; i < s->blocksize; i++) {
+    s->samples[0][i] = 0.5f;
+    s->samples[1][i] = -0.5f;
+  }
+
+  assertDoubleEquals(0.5, sampleBufferGetRms(s), TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testSumToMono(void) {
+  SampleBuffer s = _newTestSampleBuffer(2);
+  SampleBuffer mono = newSampleBuffer(1, TEST_BLOCKSIZE);
+
+  s->samples[1][2] = 0.1f;
+  assert(sampleBufferSumToMono(mono, s));
+  assertDoubleEquals(0.1, mono->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.2, mono->samples[0][2], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(s);
+  freeSampleBuffer(mono);
+  return 0;
+}
+
+static int _testCopyChannel(void) {
+  SampleBuffer s = _newTestSampleBuffer(1);
+  SampleBuffer other = newSampleBuffer(2, TEST_BLOCKSIZE);
+
+  assert(sampleBufferCopyChannel(other, 1, s, 0));
+  assertDoubleEquals(0.0, other->samples[0][10], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.1, other->samples[1][10], TEST_DEFAULT_TOLERANCE);
+  assertFalse(sampleBufferCopyChannel(other, 2, s, 0));
+  assertFalse(sampleBufferCopyChannel(other, 0, s, 1));
+
+  freeSampleBuffer(s);
+  freeSampleBuffer(other);
+  return 0;
+}
+
+TestSuite addSampleBufferMathTests(void);
+TestSuite addSampleBufferMathTests(void) {
+  TestSuite testSuite = newTestSuite("SampleBufferMath", NULL, NULL);
+  addTest(testSuite, "ApplyGain", _testApplyGain);
+  addTest(testSuite, "ApplyGainRamp", _testApplyGainRamp);
+  addTest(testSuite, "Mix", _testMix);
+  addTest(testSuite, "MixDifferentSizes", _testMixDifferentSizes);
+  addTest(testSuite, "Clip", _testClip);
+  addTest(testSuite, "GetPeak", _testGetPeak);
+  addTest(testSuite, "GetPeakOfSilence", _testGetPeakOfSilence);
+  addTest(testSuite, "IsSilent", _testIsSilent);
+  addTest(testSuite, "GetRms", _testGetRms);
+  addTest(testSuite, "SumToMono", _testSumToMono);
+  addTest(testSuite, "CopyChannel", _testCopyChannel);
+  return testSuite;
+}
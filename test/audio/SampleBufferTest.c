@@ -56,6 +56,118 @@ static int _testNewSampleBufferMultichannel(void) {
   return 0;
 }
 
+static int _testNewSampleBufferIsAligned(void) {
+  SampleBuffer s = newSampleBuffer(3, 100);
+  ChannelCount i;
+
+  for (i = 0; i < s->numChannels; ++i) {
+    assertUnsignedLongEquals(0l,
+                             (unsigned long)s->samples[i] %
+                                 SAMPLE_BUFFER_ALIGNMENT);
+  }
+
+  assert(sampleBufferGetChannelStride(s) >= s->blocksize);
+  assertUnsignedLongEquals((unsigned long)(s->samples[1] - s->samples[0]),
+                           sampleBufferGetChannelStride(s));
+
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testNewSampleBufferPadsPageSizedChannels(void) {
+  SampleBuffer s = newSampleBuffer(2, 1024);
+  // Channels exactly 4kb apart would compete for the same cache sets
+  assert(sampleBufferGetChannelStride(s) > 1024);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testNewSampleBufferWithHugePages(void) {
+  SampleBuffer s;
+  SampleCount blocksize = SAMPLE_BUFFER_HUGE_PAGE_SIZE / sizeof(Sample);
+  SampleCount i;
+
+  sampleBufferSetUseHugePages(true);
+  s = newSampleBuffer(2, blocksize);
+  sampleBufferSetUseHugePages(false);
+
+  assertNotNull(s);
+  assertUnsignedLongEquals(0l, (unsigned long)s->samples[1] %
+                                   SAMPLE_BUFFER_ALIGNMENT);
+  for (i = 0; i < s->blocksize; ++i) {
+    assertDoubleEquals(0.0, s->samples[1][i], TEST_DEFAULT_TOLERANCE);
+    s->samples[0][i] = 0.5f;
+  }
+  assertDoubleEquals(0.0, s->samples[1][0], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testNewSampleBufferView(void) {
+  SampleBuffer s = newSampleBuffer(2, 8);
+  SampleBuffer v = newSampleBufferView(s, 3, 4);
+
+  assertNotNull(v);
+  assertIntEquals(2, v->numChannels);
+  assertUnsignedLongEquals(4l, v->blocksize);
+  v->samples[1][0] = 0.5f;
+  assertDoubleEquals(0.5, s->samples[1][3], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(v);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testNewSampleBufferViewOutOfRange(void) {
+  SampleBuffer s = newSampleBuffer(2, 8);
+  assertIsNull(newSampleBufferView(s, 3, 6));
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testSampleBufferViewSetRange(void) {
+  SampleBuffer s = newSampleBuffer(2, 8);
+  SampleBuffer other = newSampleBuffer(4, 8);
+  SampleBuffer v = newSampleBufferView(s, 0, 8);
+
+  assert(sampleBufferViewSetRange(v, s, 6, 2));
+  assertUnsignedLongEquals(2l, v->blocksize);
+  v->samples[0][1] = 0.5f;
+  assertDoubleEquals(0.5, s->samples[0][7], TEST_DEFAULT_TOLERANCE);
+
+  assert(sampleBufferViewSetRange(v, other, 1, 1));
+  assertIntEquals(4, v->numChannels);
+  v->samples[3][0] = 0.5f;
+  assertDoubleEquals(0.5, other->samples[3][1], TEST_DEFAULT_TOLERANCE);
+
+  assertFalse(sampleBufferViewSetRange(v, s, 8, 1));
+  assertFalse(sampleBufferViewSetRange(s, other, 0, 1));
+
+  freeSampleBuffer(v);
+  freeSampleBuffer(other);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testClearSampleBufferFrames(void) {
+  SampleBuffer s = newSampleBuffer(1, 4);
+  unsigned int i;
+
+  for (i = 0; i < s->blocksize; ++i) {
+    s->samples[0][i] = 0.5f;
+  }
+
+  sampleBufferClearFrames(s, 1, 2);
+  assertDoubleEquals(0.5, s->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, s->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, s->samples[0][2], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.5, s->samples[0][3], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(s);
+  return 0;
+}
+
 static int _testClearSampleBuffer(void) {
   SampleBuffer s = _newMockSampleBuffer();
   s->samples[0][0] = 123;
@@ -140,7 +252,19 @@ TestSuite addSampleBufferTests(void) {
   addTest(testSuite, "NewObject", _testNewSampleBuffer);
   addTest(testSuite, "NewSampleBufferMultichannel",
           _testNewSampleBufferMultichannel);
+  addTest(testSuite, "NewSampleBufferIsAligned",
+          _testNewSampleBufferIsAligned);
+  addTest(testSuite, "NewSampleBufferPadsPageSizedChannels",
+          _testNewSampleBufferPadsPageSizedChannels);
+  addTest(testSuite, "NewSampleBufferWithHugePages",
+          _testNewSampleBufferWithHugePages);
+  addTest(testSuite, "NewSampleBufferView", _testNewSampleBufferView);
+  addTest(testSuite, "NewSampleBufferViewOutOfRange",
+          _testNewSampleBufferViewOutOfRange);
+  addTest(testSuite, "SampleBufferViewSetRange",
+          _testSampleBufferViewSetRange);
   addTest(testSuite, "ClearSampleBuffer", _testClearSampleBuffer);
+  addTest(testSuite, "ClearSampleBufferFrames", _testClearSampleBufferFrames);
   addTest(testSuite, "CopyAndMapChannelsSampleBuffers",
           _testCopyAndMapChannelsSampleBuffers);
   addTest(testSuite, "CopyAndMapChannelsSampleBuffersDifferentSizes",
@@ -867,6 +867,33 @@ static int _testFileGetSizeNotExists(void) {
   return 0;
 }
 
+static int _testFileGetModifiedTime(void) {
+  CharString p = newCharStringWithCString(TEST_FILENAME);
+  File f = newFileWithPath(p);
+
+  assertFalse(fileExists(f));
+  assert(fileCreate(f, kFileTypeFile));
+  assert(fileWrite(f, p));
+  fileClose(f);
+  assert(fileGetModifiedTime(f) > 0);
+
+  freeCharString(p);
+  freeFile(f);
+  return 0;
+}
+
+static int _testFileGetModifiedTimeNotExists(void) {
+  CharString p = newCharStringWithCString(TEST_FILENAME);
+  File f = newFileWithPath(p);
+
+  assertFalse(fileExists(f));
+  assertUnsignedLongEquals(0ul, fileGetModifiedTime(f));
+
+  freeCharString(p);
+  freeFile(f);
+  return 0;
+}
+
 static int _testFileGetSizeDirectory(void) {
   CharString p = newCharStringWithCString(TEST_DIRNAME);
   File d = newFileWithPath(p);
@@ -1453,6 +1480,9 @@ TestSuite addFileTests(void) {
   addTest(testSuite, "FileGetSize", _testFileGetSize);
   addTest(testSuite, "FileGetSizeNotExists", _testFileGetSizeNotExists);
   addTest(testSuite, "FileGetSizeDirectory", _testFileGetSizeDirectory);
+  addTest(testSuite, "FileGetModifiedTime", _testFileGetModifiedTime);
+  addTest(testSuite, "FileGetModifiedTimeNotExists",
+          _testFileGetModifiedTimeNotExists);
 
   addTest(testSuite, "FileReadContents", _testFileReadContents);
   addTest(testSuite, "FileReadContentsNotExists",
@@ -0,0 +1,167 @@
+//
+// MemoryTrackerTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "base/MemoryTracker.h"
+
+#include "unit/TestRunner.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define TEST_BLOCK_SIZE 100
+
+static int _testMallocAddsToUsage(void) {
+  MemoryUsageMembers before, after;
+  void *block;
+
+  memoryTrackerGetUsage(MEMORY_TAG_IO, &before);
+  block = trackedMalloc(MEMORY_TAG_IO, TEST_BLOCK_SIZE);
+  assertNotNull(block);
+  memoryTrackerGetUsage(MEMORY_TAG_IO, &after);
+  assertSizeEquals(before.currentBytes + TEST_BLOCK_SIZE, after.currentBytes);
+  assertUnsignedLongEquals(before.numAllocations + 1, after.numAllocations);
+
+  trackedFree(block);
+  memoryTrackerGetUsage(MEMORY_TAG_IO, &after);
+  assertSizeEquals(before.currentBytes, after.currentBytes);
+  return 0;
+}
+
+static int _testMallocIsAligned(void) {
+  void *block = trackedMalloc(MEMORY_TAG_IO, sizeof(double));
+  assertIntEquals(0, (int)((uintptr_t)block % 16));
+  trackedFree(block);
+  return 0;
+}
+
+static int _testCallocIsZeroed(void) {
+  unsigned char *block =
+      (unsigned char *)trackedCalloc(MEMORY_TAG_IO, TEST_BLOCK_SIZE, 1);
+  unsigned int i;
+
+  assertNotNull(block);
+
+  for (i = 0; i < TEST_BLOCK_SIZE; i++) {
+    assertIntEquals(0, block[i]);
+  }
+
+  trackedFree(block);
+  return 0;
+}
+
+static int _testReallocKeepsContentsAndTag(void) {
+  MemoryUsageMembers ioBefore, ioAfter, midiBefore, midiAfter;
+  char *block = (char *)trackedMalloc(MEMORY_TAG_IO, 4);
+
+  memoryTrackerGetUsage(MEMORY_TAG_IO, &ioBefore);
+  memoryTrackerGetUsage(MEMORY_TAG_MIDI, &midiBefore);
+  memcpy(block, "abc", 4);
+  // The tag argument is only used for new blocks
+  block = (char *)trackedRealloc(block, MEMORY_TAG_MIDI, TEST_BLOCK_SIZE);
+  assertNotNull(block);
+  assertIntEquals(0, strcmp(block, "abc"));
+
+  memoryTrackerGetUsage(MEMORY_TAG_IO, &ioAfter);
+  memoryTrackerGetUsage(MEMORY_TAG_MIDI, &midiAfter);
+  assertSizeEquals(ioBefore.currentBytes + TEST_BLOCK_SIZE - 4,
+                   ioAfter.currentBytes);
+  assertSizeEquals(midiBefore.currentBytes, midiAfter.currentBytes);
+
+  trackedFree(block);
+  return 0;
+}
+
+static int _testReallocNull(void) {
+  MemoryUsageMembers before, after;
+  void *block;
+
+  memoryTrackerGetUsage(MEMORY_TAG_MIDI, &before);
+  block = trackedRealloc(NULL, MEMORY_TAG_MIDI, TEST_BLOCK_SIZE);
+  assertNotNull(block);
+  memoryTrackerGetUsage(MEMORY_TAG_MIDI, &after);
+  assertSizeEquals(before.currentBytes + TEST_BLOCK_SIZE, after.currentBytes);
+
+  trackedFree(block);
+  return 0;
+}
+
+static int _testFreeNull(void) {
+  trackedFree(NULL);
+  return 0;
+}
+
+static int _testAddAndRemoveBytes(void) {
+  MemoryUsageMembers before, after;
+  const size_t numBytes = 1024 * 1024;
+
+  memoryTrackerGetUsage(MEMORY_TAG_AUDIO, &before);
+  memoryTrackerAddBytes(MEMORY_TAG_AUDIO, numBytes);
+  memoryTrackerRemoveBytes(MEMORY_TAG_AUDIO, numBytes);
+  memoryTrackerGetUsage(MEMORY_TAG_AUDIO, &after);
+
+  assertSizeEquals(before.currentBytes, after.currentBytes);
+  assert(after.peakBytes >= before.currentBytes + numBytes);
+  return 0;
+}
+
+static int _testGetTotalBytes(void) {
+  const size_t before = memoryTrackerGetTotalBytes();
+  void *block = trackedMalloc(MEMORY_TAG_PLUGIN, TEST_BLOCK_SIZE);
+
+  assertSizeEquals(before + TEST_BLOCK_SIZE, memoryTrackerGetTotalBytes());
+  trackedFree(block);
+  return 0;
+}
+
+static int _testGetTagName(void) {
+  assertIntEquals(0, strcmp("Strings", memoryTagGetName(MEMORY_TAG_STRING)));
+  assertIsNull(memoryTagGetName(NUM_MEMORY_TAGS));
+  return 0;
+}
+
+static int _testGetResidentBytes(void) {
+#if LINUX || MACOSX || WINDOWS
+  assert(memoryTrackerGetResidentBytes() > 0);
+#endif
+  return 0;
+}
+
+TestSuite addMemoryTrackerTests(void);
+TestSuite addMemoryTrackerTests(void) {
+  TestSuite testSuite = newTestSuite("MemoryTracker", NULL, NULL);
+  addTest(testSuite, "MallocAddsToUsage", _testMallocAddsToUsage);
+  addTest(testSuite, "MallocIsAligned", _testMallocIsAligned);
+  addTest(testSuite, "CallocIsZeroed", _testCallocIsZeroed);
+  addTest(testSuite, "ReallocKeepsContentsAndTag",
+          _testReallocKeepsContentsAndTag);
+  addTest(testSuite, "ReallocNull", _testReallocNull);
+  addTest(testSuite, "FreeNull", _testFreeNull);
+  addTest(testSuite, "AddAndRemoveBytes", _testAddAndRemoveBytes);
+  addTest(testSuite, "GetTotalBytes", _testGetTotalBytes);
+  addTest(testSuite, "GetTagName", _testGetTagName);
+  addTest(testSuite, "GetResidentBytes", _testGetResidentBytes);
+  return testSuite;
+}
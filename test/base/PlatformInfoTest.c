@@ -82,6 +82,11 @@ static int _testIsHostLittleEndian(void) {
   return 0;
 }
 
+static int _testGetNumProcessors(void) {
+  assert(platformInfoGetNumProcessors() >= 1);
+  return 0;
+}
+
 TestSuite addPlatformInfoTests(void);
 TestSuite addPlatformInfoTests(void) {
   TestSuite testSuite = newTestSuite("PlatformInfo", NULL, NULL);
@@ -91,6 +96,7 @@ TestSuite addPlatformInfoTests(void) {
   addTest(testSuite, "GetShortPlatformName", _testGetShortPlatformName);
 
   addTest(testSuite, "IsHostLittleEndian", _testIsHostLittleEndian);
+  addTest(testSuite, "GetNumProcessors", _testGetNumProcessors);
 
   return testSuite;
 }
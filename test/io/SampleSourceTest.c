@@ -27,9 +27,14 @@
 #include "io/SampleSource.h"
 
 #include "audio/AudioSettings.h"
+#include "io/SampleSourceBuffered.h"
+#include "io/SampleSourceFloat.h"
+#include "io/SampleSourcePcm.h"
 #include "unit/TestRunner.h"
 
 const char *TEST_SAMPLESOURCE_FILENAME = "test.pcm";
+const char *TEST_SAMPLESOURCE_FLOAT_FILENAME = "test.f64";
+const char *TEST_SAMPLESOURCE_PLANAR_FILENAME = "test.f32p";
 
 static void _sampleSourceSetup(void) { initAudioSettings(); }
 
@@ -62,6 +67,283 @@ static int _testGuessSampleSourceTypeWrongCase(void) {
   return 0;
 }
 
+static int _testSeekPcmFile(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FILENAME);
+  SampleSource s = sampleSourceFactory(c);
+  SampleBuffer b = newSampleBuffer(1, 8);
+  unsigned int i;
+
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  for (i = 0; i < b->blocksize; i++) {
+    b->samples[0][i] = (Sample)i / 16.0f;
+  }
+  sampleSourcePcmSetNumChannels(s, 1);
+  assert(s->writeSampleBlock(s, b));
+  s->closeSampleSource(s);
+  freeSampleSource(s);
+
+  s = sampleSourceFactory(c);
+  sampleSourcePcmSetNumChannels(s, 1);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+  assert(sampleSourceSeek(s, 5));
+  b->blocksize = 2;
+  assert(s->readSampleBlock(s, b));
+  assertDoubleEquals(0.3125, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.375, b->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  s->closeSampleSource(s);
+
+  unlink(TEST_SAMPLESOURCE_FILENAME);
+  freeSampleBuffer(b);
+  freeSampleSource(s);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testSeekSilence(void) {
+  SampleSource s = sampleSourceFactory(NULL);
+  assert(sampleSourceSeek(s, 12345));
+  freeSampleSource(s);
+  return 0;
+}
+
+static int _testSeekSourceOpenedForWriting(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FILENAME);
+  SampleSource s = sampleSourceFactory(c);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  assertFalse(sampleSourceSeek(s, 0));
+  s->closeSampleSource(s);
+  unlink(TEST_SAMPLESOURCE_FILENAME);
+  freeSampleSource(s);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testReadAndWriteFrames(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FILENAME);
+  SampleSource s = sampleSourceFactory(c);
+  SampleBuffer b = newSampleBuffer(1, 8);
+  unsigned int i;
+
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  for (i = 0; i < b->blocksize; i++) {
+    b->samples[0][i] = (Sample)i / 16.0f;
+  }
+  sampleSourcePcmSetNumChannels(s, 1);
+  assert(sampleSourceWriteFrames(s, b, 5, 3));
+  assertUnsignedLongEquals(8l, b->blocksize);
+  s->closeSampleSource(s);
+  freeSampleSource(s);
+
+  s = sampleSourceFactory(c);
+  sampleSourcePcmSetNumChannels(s, 1);
+  sampleBufferClear(b);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+  // Only 3 frames were written, so this will be a partial read
+  assertUnsignedLongEquals(3l, sampleSourceReadFrames(s, b, 2, 6));
+  assertUnsignedLongEquals(8l, b->blocksize);
+  assertDoubleEquals(0.0, b->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.3125, b->samples[0][2], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.4375, b->samples[0][4], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, b->samples[0][5], TEST_DEFAULT_TOLERANCE);
+  s->closeSampleSource(s);
+
+  unlink(TEST_SAMPLESOURCE_FILENAME);
+  freeSampleBuffer(b);
+  freeSampleSource(s);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testReadFramesOutOfRange(void) {
+  SampleSource s = sampleSourceFactory(NULL);
+  SampleBuffer b = newSampleBuffer(1, 8);
+  assertUnsignedLongEquals(0l, sampleSourceReadFrames(s, b, 4, 5));
+  freeSampleBuffer(b);
+  freeSampleSource(s);
+  return 0;
+}
+
+static int _testGuessSampleSourceTypeFloat(void) {
+  const char *names[] = {"test.f32", "test.f64p", "-.f32", "&3.f64", NULL};
+  CharString c;
+  SampleSource s;
+  int i;
+
+  for (i = 0; names[i] != NULL; i++) {
+    c = newCharStringWithCString(names[i]);
+    s = sampleSourceFactory(c);
+    assertIntEquals(SAMPLE_SOURCE_TYPE_FLOAT, s->sampleSourceType);
+    freeSampleSource(s);
+    freeCharString(c);
+  }
+
+  return 0;
+}
+
+static int _testReadAndWriteFloatFile(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FLOAT_FILENAME);
+  SampleSource s = sampleSourceFactory(c);
+  SampleBuffer b = newSampleBuffer(2, 5);
+  const Sample expected = 0.123456789f;
+  unsigned int i;
+
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  for (i = 0; i < b->blocksize; i++) {
+    b->samples[0][i] = expected * (Sample)i;
+    b->samples[1][i] = -expected * (Sample)i;
+  }
+  assert(s->writeSampleBlock(s, b));
+  assertUnsignedLongEquals(10l, s->numSamplesProcessed);
+  s->closeSampleSource(s);
+  freeSampleSource(s);
+  freeSampleBuffer(b);
+
+  // Read more than was written, which should give a short block
+  s = sampleSourceFactory(c);
+  b = newSampleBuffer(2, 8);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+  assertFalse(s->readSampleBlock(s, b));
+  assertUnsignedLongEquals(5l, b->blocksize);
+  // Unlike PCM, there should be no quantization error at all
+  for (i = 0; i < b->blocksize; i++) {
+    assert(b->samples[0][i] == expected * (Sample)i);
+    assert(b->samples[1][i] == -expected * (Sample)i);
+  }
+  s->closeSampleSource(s);
+
+  unlink(TEST_SAMPLESOURCE_FLOAT_FILENAME);
+  freeSampleBuffer(b);
+  freeSampleSource(s);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testReadAndWritePlanarFloatFileWithHeader(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_PLANAR_FILENAME);
+  SampleSource s;
+  SampleBuffer b = newSampleBuffer(2, 3);
+  unsigned int i, j;
+
+  setBlocksize(4);
+  setNumChannels(2);
+  setSampleRate(48000.0);
+  s = sampleSourceFactory(c);
+  sampleSourceFloatSetWriteHeader(s, true);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  // Write 9 frames in blocks of 3, which do not line up with the planar blocks
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < b->blocksize; j++) {
+      b->samples[0][j] = (Sample)(i * b->blocksize + j) / 16.0f;
+      b->samples[1][j] = -b->samples[0][j];
+    }
+    assert(s->writeSampleBlock(s, b));
+  }
+  s->closeSampleSource(s);
+  freeSampleSource(s);
+  freeSampleBuffer(b);
+
+  // The header should override these settings when reading
+  setNumChannels(1);
+  setSampleRate(22050.0);
+  s = sampleSourceFactory(c);
+  b = newSampleBuffer(2, 16);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+  assertIntEquals(2, getNumChannels());
+  assertDoubleEquals(48000.0, getSampleRate(), TEST_DEFAULT_TOLERANCE);
+  assertFalse(s->readSampleBlock(s, b));
+  assertUnsignedLongEquals(9l, b->blocksize);
+  for (i = 0; i < b->blocksize; i++) {
+    assertDoubleEquals((Sample)i / 16.0f, b->samples[0][i],
+                       TEST_DEFAULT_TOLERANCE);
+    assertDoubleEquals(-(Sample)i / 16.0f, b->samples[1][i],
+                       TEST_DEFAULT_TOLERANCE);
+  }
+  s->closeSampleSource(s);
+
+  unlink(TEST_SAMPLESOURCE_PLANAR_FILENAME);
+  freeSampleBuffer(b);
+  freeSampleSource(s);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testSeekFloatFile(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FLOAT_FILENAME);
+  SampleSource s;
+  SampleBuffer b = newSampleBuffer(1, 8);
+  unsigned int i;
+
+  setNumChannels(1);
+  s = sampleSourceFactory(c);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  for (i = 0; i < b->blocksize; i++) {
+    b->samples[0][i] = (Sample)i / 16.0f;
+  }
+  assert(s->writeSampleBlock(s, b));
+  s->closeSampleSource(s);
+  freeSampleSource(s);
+
+  s = sampleSourceFactory(c);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+  assert(sampleSourceSeek(s, 5));
+  assertUnsignedLongEquals(0l, s->numSamplesProcessed);
+  b->blocksize = 2;
+  assert(s->readSampleBlock(s, b));
+  assertDoubleEquals(0.3125, b->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.375, b->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  s->closeSampleSource(s);
+
+  unlink(TEST_SAMPLESOURCE_FLOAT_FILENAME);
+  freeSampleBuffer(b);
+  freeSampleSource(s);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testReadAndWriteBufferedSource(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FLOAT_FILENAME);
+  SampleSource s;
+  SampleBuffer b = newSampleBuffer(1, 3);
+  unsigned int i, j;
+
+  setNumChannels(1);
+  s = newSampleSourceBuffered(sampleSourceFactory(c), 4);
+  assertIntEquals(SAMPLE_SOURCE_TYPE_BUFFERED, s->sampleSourceType);
+  assertIntEquals(SAMPLE_SOURCE_TYPE_FLOAT,
+                  sampleSourceBufferedGetSource(s)->sampleSourceType);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < b->blocksize; j++) {
+      b->samples[0][j] = (Sample)(i * b->blocksize + j) / 16.0f;
+    }
+    assert(s->writeSampleBlock(s, b));
+  }
+  assertUnsignedLongEquals(9l, s->numSamplesProcessed);
+  // The last frame is still in the chunk until the source is closed
+  s->closeSampleSource(s);
+  freeSampleSource(s);
+
+  s = newSampleSourceBuffered(sampleSourceFactory(c), 4);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+  for (i = 0; i < 3; i++) {
+    assert(s->readSampleBlock(s, b));
+    for (j = 0; j < b->blocksize; j++) {
+      assertDoubleEquals((Sample)(i * b->blocksize + j) / 16.0f,
+                         b->samples[0][j], TEST_DEFAULT_TOLERANCE);
+    }
+  }
+  assertFalse(s->readSampleBlock(s, b));
+  assertUnsignedLongEquals(0l, b->blocksize);
+  assertUnsignedLongEquals(9l, s->numSamplesProcessed);
+  s->closeSampleSource(s);
+
+  unlink(TEST_SAMPLESOURCE_FLOAT_FILENAME);
+  freeSampleBuffer(b);
+  freeSampleSource(s);
+  freeCharString(c);
+  return 0;
+}
+
 TestSuite addSampleSourceTests(void);
 TestSuite addSampleSourceTests(void) {
   TestSuite testSuite =
@@ -71,5 +353,19 @@ TestSuite addSampleSourceTests(void) {
           _testGuessSampleSourceTypeEmpty);
   addTest(testSuite, "GuessSampleSourceTypeWrongCase",
           _testGuessSampleSourceTypeWrongCase);
+  addTest(testSuite, "SeekPcmFile", _testSeekPcmFile);
+  addTest(testSuite, "SeekSilence", _testSeekSilence);
+  addTest(testSuite, "SeekSourceOpenedForWriting",
+          _testSeekSourceOpenedForWriting);
+  addTest(testSuite, "ReadAndWriteFrames", _testReadAndWriteFrames);
+  addTest(testSuite, "ReadFramesOutOfRange", _testReadFramesOutOfRange);
+  addTest(testSuite, "GuessSampleSourceTypeFloat",
+          _testGuessSampleSourceTypeFloat);
+  addTest(testSuite, "ReadAndWriteFloatFile", _testReadAndWriteFloatFile);
+  addTest(testSuite, "ReadAndWritePlanarFloatFileWithHeader",
+          _testReadAndWritePlanarFloatFileWithHeader);
+  addTest(testSuite, "SeekFloatFile", _testSeekFloatFile);
+  addTest(testSuite, "ReadAndWriteBufferedSource",
+          _testReadAndWriteBufferedSource);
   return testSuite;
 }
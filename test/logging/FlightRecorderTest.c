@@ -0,0 +1,259 @@
+//
+// FlightRecorderTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "logging/FlightRecorder.h"
+
+#include "audio/AudioSettings.h"
+#include "base/File.h"
+#include "unit/TestRunner.h"
+
+#include "plugin/PluginMock.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+
+#if UNIX
+#include <unistd.h>
+#elif WINDOWS
+#include <io.h>
+#define open _open
+#define close _close
+#define unlink _unlink
+#endif
+
+#define TEST_DUMP_FILE "test_flight_recorder.txt"
+
+static void _flightRecorderTestSetup(void) {
+  initAudioSettings();
+  initPluginChain();
+  pluginChainAppend(getPluginChain(), newPluginMock(), NULL);
+}
+
+static void _flightRecorderTestTeardown(void) {
+  unlink(TEST_DUMP_FILE);
+  freeFlightRecorder(getFlightRecorder());
+  freePluginChain(getPluginChain());
+  freeAudioSettings();
+}
+
+static CharString _readDumpFile(void) {
+  File file = newFileWithPathCString(TEST_DUMP_FILE);
+  CharString contents = fileReadContents(file);
+  freeFile(file);
+  return contents;
+}
+
+static int _testNewFlightRecorder(void) {
+  FlightRecorder flightRecorder = newFlightRecorder();
+
+  assertUnsignedLongEquals(0ul, flightRecorder->numBlocks);
+  assertIntEquals(FLIGHT_RECORDER_NO_PLUGIN, flightRecorder->currentPlugin);
+  assertIsNull(flightRecorder->currentActivity);
+
+  freeFlightRecorder(flightRecorder);
+  return 0;
+}
+
+static int _testRecordWithoutBlock(void) {
+  FlightRecorder flightRecorder = newFlightRecorder();
+  MidiEvent midiEvent = newMidiEvent();
+
+  // Nothing is recorded before the first block, and NULL is always accepted
+  flightRecorderAddPluginTime(flightRecorder, 0, 1.0);
+  flightRecorderAddMidiEvent(flightRecorder, midiEvent);
+  flightRecorderAddWarning(flightRecorder, "test");
+  flightRecorderBeginBlock(NULL, 0);
+  flightRecorderAddWarning(NULL, "test");
+  assertUnsignedLongEquals(0ul, flightRecorder->numBlocks);
+  assertIntEquals(0, (int)flightRecorder->blocks[0].numWarnings);
+
+  freeMidiEvent(midiEvent);
+  freeFlightRecorder(flightRecorder);
+  return 0;
+}
+
+static int _testBeginBlockWrapsAround(void) {
+  FlightRecorder flightRecorder = newFlightRecorder();
+  const unsigned long numBlocks = FLIGHT_RECORDER_NUM_BLOCKS + 3;
+  FlightRecorderBlock *block;
+  unsigned long i;
+
+  for (i = 0; i < numBlocks; i++) {
+    flightRecorderBeginBlock(flightRecorder, i * 512);
+    flightRecorderAddWarning(flightRecorder, "test");
+  }
+
+  assertUnsignedLongEquals(numBlocks, flightRecorder->numBlocks);
+  block = &flightRecorder->blocks[(numBlocks - 1) % FLIGHT_RECORDER_NUM_BLOCKS];
+  assertUnsignedLongEquals(numBlocks - 1, block->blockNumber);
+  assertUnsignedLongEquals((numBlocks - 1) * 512, block->frame);
+  // Reused blocks are cleared before recording
+  assertIntEquals(1, (int)block->numWarnings);
+
+  freeFlightRecorder(flightRecorder);
+  return 0;
+}
+
+static int _testAddPluginTime(void) {
+  FlightRecorder flightRecorder = newFlightRecorder();
+
+  flightRecorderBeginBlock(flightRecorder, 0);
+  flightRecorderAddPluginTime(flightRecorder, 1, 0.25);
+  flightRecorderAddPluginTime(flightRecorder, 1, 0.5);
+  flightRecorderAddPluginTime(flightRecorder, MAX_PLUGINS, 1.0);
+  assertDoubleEquals(0.75, flightRecorder->blocks[0].processingTimeInMs[1],
+                     TEST_EXACT_TOLERANCE);
+
+  freeFlightRecorder(flightRecorder);
+  return 0;
+}
+
+static int _testAddMidiEventsBeyondLimit(void) {
+  FlightRecorder flightRecorder = newFlightRecorder();
+  MidiEvent midiEvent = newMidiEvent();
+  unsigned int i;
+
+  flightRecorderBeginBlock(flightRecorder, 0);
+
+  for (i = 0; i < FLIGHT_RECORDER_MAX_MIDI_EVENTS + 2; i++) {
+    midiEvent->data1 = (byte)i;
+    flightRecorderAddMidiEvent(flightRecorder, midiEvent);
+  }
+
+  assertIntEquals(FLIGHT_RECORDER_MAX_MIDI_EVENTS + 2,
+                  (int)flightRecorder->blocks[0].numMidiEvents);
+  assertIntEquals(FLIGHT_RECORDER_MAX_MIDI_EVENTS - 1,
+                  flightRecorder->blocks[0]
+                      .midiEvents[FLIGHT_RECORDER_MAX_MIDI_EVENTS - 1]
+                      .data1);
+
+  freeMidiEvent(midiEvent);
+  freeFlightRecorder(flightRecorder);
+  return 0;
+}
+
+static int _testAddWarningTruncates(void) {
+  FlightRecorder flightRecorder = newFlightRecorder();
+  char message[FLIGHT_RECORDER_WARNING_LENGTH * 2];
+
+  memset(message, 'a', sizeof(message) - 1);
+  message[sizeof(message) - 1] = '\0';
+  flightRecorderBeginBlock(flightRecorder, 0);
+  flightRecorderAddWarning(flightRecorder, message);
+  assertIntEquals(FLIGHT_RECORDER_WARNING_LENGTH - 1,
+                  (int)strlen(flightRecorder->blocks[0].warnings[0]));
+
+  freeFlightRecorder(flightRecorder);
+  return 0;
+}
+
+static int _testWrite(void) {
+  FlightRecorder flightRecorder = newFlightRecorder();
+  MidiEvent midiEvent = newMidiEvent();
+  CharString contents;
+  int fileDescriptor;
+
+  midiEvent->deltaFrames = 5;
+  midiEvent->status = 0x90;
+  midiEvent->data1 = 0x3c;
+  midiEvent->data2 = 0x64;
+
+  flightRecorderSetPluginChain(flightRecorder, getPluginChain());
+  flightRecorderBeginBlock(flightRecorder, 0);
+  flightRecorderBeginBlock(flightRecorder, 512);
+  flightRecorderAddPluginTime(flightRecorder, 0, 1.5);
+  flightRecorderAddMidiEvent(flightRecorder, midiEvent);
+  flightRecorderAddParameterChange(flightRecorder, 0, 3, 0.25f, false);
+  flightRecorderAddParameterChange(flightRecorder, 0, 7, 0.0f, true);
+  flightRecorderAddWarning(flightRecorder, "test warning");
+
+  fileDescriptor = open(TEST_DUMP_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  assert(fileDescriptor >= 0);
+  flightRecorderWrite(flightRecorder, fileDescriptor, 0);
+  close(fileDescriptor);
+
+  contents = _readDumpFile();
+  assertCharStringContains("Last 2 of 2 blocks", contents);
+  assertCharStringContains("Block 1 at frame 512", contents);
+  assertCharStringContains("Time in plugin 'Mock': 1.500ms", contents);
+  assertCharStringContains("MIDI +5: 90 3c 64", contents);
+  assertCharStringContains("Parameter 3 of plugin 'Mock' set to 0.250",
+                           contents);
+  assertCharStringContains("Program of plugin 'Mock' set to 7", contents);
+  assertCharStringContains("Warning: test warning", contents);
+
+  freeCharString(contents);
+  freeMidiEvent(midiEvent);
+  freeFlightRecorder(flightRecorder);
+  return 0;
+}
+
+static int _testHandleCrash(void) {
+  CharString dumpFile = newCharStringWithCString(TEST_DUMP_FILE);
+  CharString contents;
+
+  initFlightRecorder();
+  flightRecorderSetPluginChain(getFlightRecorder(), getPluginChain());
+  flightRecorderSetDumpFile(getFlightRecorder(), dumpFile);
+  flightRecorderBeginBlock(getFlightRecorder(), 1024);
+  flightRecorderEnterPlugin(getFlightRecorder(), 0, "processing audio");
+  flightRecorderHandleCrash(SIGSEGV);
+
+  contents = _readDumpFile();
+  assertCharStringContains("Caught SIGSEGV", contents);
+  assertCharStringContains("while processing audio in plugin 'Mock'",
+                           contents);
+  assertCharStringContains("Block 0 at frame 1024", contents);
+
+  freeCharString(contents);
+  freeCharString(dumpFile);
+  return 0;
+}
+
+static int _testHandleCrashWithoutRecorder(void) {
+  assertIsNull(getFlightRecorder());
+  flightRecorderHandleCrash(SIGSEGV);
+  return 0;
+}
+
+TestSuite addFlightRecorderTests(void);
+TestSuite addFlightRecorderTests(void) {
+  TestSuite testSuite = newTestSuite("FlightRecorder", _flightRecorderTestSetup,
+                                     _flightRecorderTestTeardown);
+  addTest(testSuite, "NewFlightRecorder", _testNewFlightRecorder);
+  addTest(testSuite, "RecordWithoutBlock", _testRecordWithoutBlock);
+  addTest(testSuite, "BeginBlockWrapsAround", _testBeginBlockWrapsAround);
+  addTest(testSuite, "AddPluginTime", _testAddPluginTime);
+  addTest(testSuite, "AddMidiEventsBeyondLimit",
+          _testAddMidiEventsBeyondLimit);
+  addTest(testSuite, "AddWarningTruncates", _testAddWarningTruncates);
+  addTest(testSuite, "Write", _testWrite);
+  addTest(testSuite, "HandleCrash", _testHandleCrash);
+  addTest(testSuite, "HandleCrashWithoutRecorder",
+          _testHandleCrashWithoutRecorder);
+  return testSuite;
+}
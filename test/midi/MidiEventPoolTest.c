@@ -0,0 +1,171 @@
+//
+// MidiEventPoolTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "midi/MidiEventPool.h"
+
+#include "unit/TestRunner.h"
+
+#include <string.h>
+
+static int _testNewMidiEventPool(void) {
+  MidiEventPool p = newMidiEventPool();
+  assertNotNull(p);
+  assertUnsignedLongEquals(ZERO_UNSIGNED_LONG, p->numEvents);
+  freeMidiEventPool(p);
+  return 0;
+}
+
+static int _testNewEventsAreContiguous(void) {
+  MidiEventPool p = newMidiEventPool();
+  MidiEvent e = midiEventPoolNewEvent(p);
+  MidiEvent e2 = midiEventPoolNewEvent(p);
+
+  assertIntEquals(MIDI_TYPE_INVALID, e->eventType);
+  assertIsNull(e->extraData);
+  assert(e2 == e + 1);
+  assertUnsignedLongEquals(2ul, p->numEvents);
+  assert(midiEventPoolGetEvent(p, 1) == e2);
+
+  freeMidiEventPool(p);
+  return 0;
+}
+
+static int _testGetEventFromManyBlocks(void) {
+  MidiEventPool p = newMidiEventPool();
+  MidiEvent e;
+  unsigned long i;
+
+  for (i = 0; i < 5000; i++) {
+    e = midiEventPoolNewEvent(p);
+    e->timestamp = i;
+  }
+
+  assertUnsignedLongEquals(5000ul, p->numEvents);
+  for (i = 0; i < 5000; i += 7) {
+    assertUnsignedLongEquals(i, midiEventPoolGetEvent(p, i)->timestamp);
+  }
+
+  freeMidiEventPool(p);
+  return 0;
+}
+
+static int _testCopyEventWithExtraData(void) {
+  MidiEventPool p = newMidiEventPool();
+  MidiEvent e = newMidiEvent();
+  MidiEvent copy;
+  byte tempo[3] = {0x07, 0xa1, 0x20};
+
+  e->eventType = MIDI_TYPE_META;
+  e->status = MIDI_META_TYPE_TEMPO;
+  e->timestamp = 123;
+  e->extraData = tempo;
+  e->extraDataSize = 3;
+  copy = midiEventPoolCopyEvent(p, e);
+  tempo[0] = 0;
+
+  assertIntEquals(MIDI_TYPE_META, copy->eventType);
+  assertIntEquals(MIDI_META_TYPE_TEMPO, copy->status);
+  assertUnsignedLongEquals(123ul, copy->timestamp);
+  assertUnsignedLongEquals(3ul, (unsigned long)copy->extraDataSize);
+  assert(copy->extraData != tempo);
+  assertIntEquals(0x07, copy->extraData[0]);
+  assertIntEquals(0x20, copy->extraData[2]);
+
+  e->extraData = NULL;
+  freeMidiEvent(e);
+  freeMidiEventPool(p);
+  return 0;
+}
+
+static int _testReleasedEventIsReused(void) {
+  MidiEventPool p = newMidiEventPool();
+  MidiEvent e = midiEventPoolNewEvent(p);
+  MidiEvent e2;
+
+  e->status = 0x90;
+  midiEventPoolReleaseEvent(p, e);
+  e2 = midiEventPoolNewEvent(p);
+  assert(e2 == e);
+  assertIntEquals(0, e2->status);
+  assertIsNull(e2->extraData);
+  assertUnsignedLongEquals(1ul, p->numEvents);
+
+  freeMidiEventPool(p);
+  return 0;
+}
+
+static int _testReleasedPayloadIsReused(void) {
+  MidiEventPool p = newMidiEventPool();
+  MidiEvent e = newMidiEvent();
+  MidiEvent copy;
+  byte *payload;
+  byte data[2048];
+
+  memset(data, 0x55, sizeof(data));
+  e->eventType = MIDI_TYPE_SYSEX;
+  e->extraData = data;
+  e->extraDataSize = 3;
+  copy = midiEventPoolCopyEvent(p, e);
+  payload = copy->extraData;
+  midiEventPoolReleaseEvent(p, copy);
+
+  // A payload of a different size class gets new memory
+  e->extraDataSize = 100;
+  copy = midiEventPoolCopyEvent(p, e);
+  assert(copy->extraData != payload);
+
+  e->extraDataSize = 10;
+  copy = midiEventPoolCopyEvent(p, e);
+  assert(copy->extraData == payload);
+  assertIntEquals(0x55, copy->extraData[9]);
+
+  // Large payloads which have their own block are reused as well
+  e->extraDataSize = 2000;
+  copy = midiEventPoolCopyEvent(p, e);
+  payload = copy->extraData;
+  midiEventPoolReleaseEvent(p, copy);
+  e->extraDataSize = 1500;
+  copy = midiEventPoolCopyEvent(p, e);
+  assert(copy->extraData == payload);
+  assertIntEquals(0x55, copy->extraData[1499]);
+
+  e->extraData = NULL;
+  freeMidiEvent(e);
+  freeMidiEventPool(p);
+  return 0;
+}
+
+TestSuite addMidiEventPoolTests(void);
+TestSuite addMidiEventPoolTests(void) {
+  TestSuite testSuite = newTestSuite("MidiEventPool", NULL, NULL);
+  addTest(testSuite, "Initialization", _testNewMidiEventPool);
+  addTest(testSuite, "NewEventsAreContiguous", _testNewEventsAreContiguous);
+  addTest(testSuite, "GetEventFromManyBlocks", _testGetEventFromManyBlocks);
+  addTest(testSuite, "CopyEventWithExtraData", _testCopyEventWithExtraData);
+  addTest(testSuite, "ReleasedEventIsReused", _testReleasedEventIsReused);
+  addTest(testSuite, "ReleasedPayloadIsReused", _testReleasedPayloadIsReused);
+  return testSuite;
+}
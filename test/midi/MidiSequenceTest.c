@@ -31,7 +31,7 @@
 static int _testNewMidiSequence(void) {
   MidiSequence m = newMidiSequence();
   assertNotNull(m);
-  assertIntEquals(0, linkedListLength(m->midiEvents));
+  assertUnsignedLongEquals(0ul, midiSequenceGetNumEvents(m));
   freeMidiSequence(m);
   return 0;
 }
@@ -40,7 +40,7 @@ static int _testAppendMidiEventToSequence(void) {
   MidiSequence m = newMidiSequence();
   MidiEvent e = newMidiEvent();
   appendMidiEventToSequence(m, e);
-  assertIntEquals(1, linkedListLength(m->midiEvents));
+  assertUnsignedLongEquals(1ul, midiSequenceGetNumEvents(m));
   freeMidiSequence(m);
   return 0;
 }
@@ -48,7 +48,7 @@ static int _testAppendMidiEventToSequence(void) {
 static int _testAppendNullMidiEventToSequence(void) {
   MidiSequence m = newMidiSequence();
   appendMidiEventToSequence(m, NULL);
-  assertIntEquals(0, linkedListLength(m->midiEvents));
+  assertUnsignedLongEquals(0ul, midiSequenceGetNumEvents(m));
   freeMidiSequence(m);
   return 0;
 }
@@ -139,6 +139,100 @@ static int _testFillEventsFromRangePastSequence(void) {
   return 0;
 }
 
+static int _testFillEventsPast32BitFrames(void) {
+  MidiSequence m = newMidiSequence();
+  MidiEvent e = newMidiEvent();
+  LinkedList l = newLinkedList();
+  // Just over a day of audio at 48kHz, which would wrap around to frame 100
+  // if timestamps were only 32 bits wide
+  const uint64_t blockStart = UINT64_C(0x100000000);
+
+  e->status = 0xf7;
+  e->timestamp = blockStart + 100;
+  appendMidiEventToSequence(m, e);
+  assert(fillMidiEventsFromRange(m, 0, 256, l));
+  assertIntEquals(0, linkedListLength(l));
+  assertFalse(fillMidiEventsFromRange(m, blockStart, 256, l));
+  assertIntEquals(1, linkedListLength(l));
+  assertUnsignedLongEquals(100ul,
+                           (unsigned long)((MidiEvent)l->item)->deltaFrames);
+
+  freeMidiSequence(m);
+  freeLinkedList(l);
+  return 0;
+}
+
+static int _testSeekMidiSequence(void) {
+  MidiSequence m = newMidiSequence();
+  MidiEvent e = newMidiEvent();
+  MidiEvent e2 = newMidiEvent();
+  MidiEvent e3 = newMidiEvent();
+  LinkedList skipped = newLinkedList();
+  LinkedList l = newLinkedList();
+
+  e->eventType = MIDI_TYPE_REGULAR;
+  e->timestamp = 100;
+  e2->eventType = MIDI_TYPE_META;
+  e2->status = MIDI_META_TYPE_TEMPO;
+  e2->timestamp = 200;
+  e3->eventType = MIDI_TYPE_REGULAR;
+  e3->timestamp = 600;
+  appendMidiEventToSequence(m, e);
+  appendMidiEventToSequence(m, e2);
+  appendMidiEventToSequence(m, e3);
+
+  assert(midiSequenceSeek(m, 512, skipped));
+  assertIntEquals(1, linkedListLength(skipped));
+  assertIntEquals(MIDI_META_TYPE_TEMPO, ((MidiEvent)skipped->item)->status);
+  assertFalse(fillMidiEventsFromRange(m, 512, 256, l));
+  assertIntEquals(1, linkedListLength(l));
+  assertUnsignedLongEquals(88ul, ((MidiEvent)l->item)->deltaFrames);
+
+  freeMidiSequence(m);
+  freeLinkedList(skipped);
+  freeLinkedList(l);
+  return 0;
+}
+
+static int _testSeekMidiSequencePastEnd(void) {
+  MidiSequence m = newMidiSequence();
+  MidiEvent e = newMidiEvent();
+  LinkedList skipped = newLinkedList();
+
+  e->eventType = MIDI_TYPE_REGULAR;
+  e->timestamp = 100;
+  appendMidiEventToSequence(m, e);
+  assertFalse(midiSequenceSeek(m, 1000, skipped));
+  assertIntEquals(0, linkedListLength(skipped));
+
+  freeMidiSequence(m);
+  freeLinkedList(skipped);
+  return 0;
+}
+
+static int _testRewindMidiSequence(void) {
+  MidiSequence m = newMidiSequence();
+  MidiEvent e = newMidiEvent();
+  LinkedList l = newLinkedList();
+  LinkedList l2 = newLinkedList();
+
+  e->eventType = MIDI_TYPE_REGULAR;
+  e->timestamp = 100;
+  appendMidiEventToSequence(m, e);
+
+  assertFalse(fillMidiEventsFromRange(m, 0, 256, l));
+  assertIntEquals(1, linkedListLength(l));
+  midiSequenceRewind(m);
+  assertIntEquals(0, m->numMidiEventsProcessed);
+  assertFalse(fillMidiEventsFromRange(m, 0, 256, l2));
+  assertIntEquals(1, linkedListLength(l2));
+
+  freeMidiSequence(m);
+  freeLinkedList(l);
+  freeLinkedList(l2);
+  return 0;
+}
+
 TestSuite addMidiSequenceTests(void);
 TestSuite addMidiSequenceTests(void) {
   TestSuite testSuite = newTestSuite("MidiSequence", NULL, NULL);
@@ -154,6 +248,11 @@ TestSuite addMidiSequenceTests(void) {
   addTest(testSuite, "FillEventsSequentially", _testFillEventsSequentially);
   addTest(testSuite, "FillEventsFromRangePastSequenceEnd",
           _testFillEventsFromRangePastSequence);
+  addTest(testSuite, "FillEventsPast32BitFrames",
+          _testFillEventsPast32BitFrames);
+  addTest(testSuite, "Seek", _testSeekMidiSequence);
+  addTest(testSuite, "SeekPastSequenceEnd", _testSeekMidiSequencePastEnd);
+  addTest(testSuite, "Rewind", _testRewindMidiSequence);
 
   return testSuite;
 }
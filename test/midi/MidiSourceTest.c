@@ -26,8 +26,13 @@
 
 #include "midi/MidiSource.h"
 
+#include "audio/AudioSettings.h"
+#include "midi/MidiSequence.h"
 #include "unit/TestRunner.h"
 
+#include <stdio.h>
+#include <unistd.h>
+
 const char *TEST_MIDI_FILENAME = "test.mid";
 
 static int _testGuessMidiSourceType(void) {
@@ -54,12 +59,118 @@ static int _testNewMidiSource(void) {
   return 0;
 }
 
+// Type 0 file with 480 ticks per beat, a note spanning a tempo change from
+// 120 to 60 BPM
+static const byte kTestMidiFileWithTempoChange[] = {
+    'M',  'T',  'h',  'd',  0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
+    0x01, 0x01, 0xe0, 'M',  'T',  'r',  'k',  0x00, 0x00, 0x00, 0x1c,
+    0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20, 0x87, 0x40, 0x90, 0x3c,
+    0x64, 0x00, 0xff, 0x51, 0x03, 0x0f, 0x42, 0x40, 0x83, 0x60, 0x80,
+    0x3c, 0x00, 0x00, 0xff, 0x2f, 0x00};
+
+// Type 1 file with a tempo track and two note tracks, one of them containing a
+// sysex event and using running status
+static const byte kTestMidiFileWithMultipleTracks[] = {
+    'M',  'T',  'h',  'd',  0x00, 0x00, 0x00, 0x06, 0x00, 0x01, 0x00, 0x03,
+    0x01, 0xe0, 'M',  'T',  'r',  'k',  0x00, 0x00, 0x00, 0x13, 0x00, 0xff,
+    0x51, 0x03, 0x07, 0xa1, 0x20, 0x87, 0x40, 0xff, 0x51, 0x03, 0x0f, 0x42,
+    0x40, 0x00, 0xff, 0x2f, 0x00, 'M',  'T',  'r',  'k',  0x00, 0x00, 0x00,
+    0x13, 0x00, 0xf0, 0x03, 0x7e, 0x7f, 0xf7, 0x87, 0x40, 0x90, 0x3c, 0x64,
+    0x83, 0x60, 0x3c, 0x00, 0x00, 0xff, 0x2f, 0x00, 'M',  'T',  'r',  'k',
+    0x00, 0x00, 0x00, 0x0e, 0x83, 0x60, 0x91, 0x40, 0x50, 0x87, 0x40, 0x81,
+    0x40, 0x00, 0x00, 0xff, 0x2f, 0x00};
+
+static MidiSequence _readTestMidiFile(const byte *data, const size_t numBytes) {
+  CharString c = newCharStringWithCString(TEST_MIDI_FILENAME);
+  MidiSource m = NULL;
+  MidiSequence midiSequence = newMidiSequence();
+  FILE *fp = fopen(TEST_MIDI_FILENAME, "wb");
+
+  if (fp != NULL) {
+    fwrite(data, 1, numBytes, fp);
+    fclose(fp);
+  }
+
+  m = newMidiSource(MIDI_SOURCE_TYPE_FILE, c);
+
+  if (!m->openMidiSource(m) || !m->readMidiEvents(m, midiSequence)) {
+    freeMidiSequence(midiSequence);
+    midiSequence = NULL;
+  }
+
+  freeMidiSource(m);
+  freeCharString(c);
+  unlink(TEST_MIDI_FILENAME);
+  return midiSequence;
+}
+
+static void _midiSourceTestSetup(void) {
+  initAudioSettings();
+  setSampleRate(48000.0);
+}
+
+static void _midiSourceTestTeardown(void) { freeAudioSettings(); }
+
+static int _testReadMidiFileWithTempoChange(void) {
+  MidiSequence midiSequence = _readTestMidiFile(
+      kTestMidiFileWithTempoChange, sizeof(kTestMidiFileWithTempoChange));
+  const unsigned long expectedTimestamps[] = {0, 48000, 48000, 96000, 96000};
+  unsigned long i;
+
+  assertNotNull(midiSequence);
+  assertUnsignedLongEquals(5ul, midiSequenceGetNumEvents(midiSequence));
+  for (i = 0; i < midiSequenceGetNumEvents(midiSequence); i++) {
+    assertUnsignedLongEquals(expectedTimestamps[i],
+                             midiSequenceGetEvent(midiSequence, i)->timestamp);
+  }
+
+  assertNotNull(midiSequence->tempoMap);
+  assertDoubleEquals(60.0,
+                     tempoMapGetTempoAtFrame(midiSequence->tempoMap, 48000.0),
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeMidiSequence(midiSequence);
+  return 0;
+}
+
+static int _testReadMidiFileWithMultipleTracks(void) {
+  MidiSequence midiSequence = _readTestMidiFile(
+      kTestMidiFileWithMultipleTracks, sizeof(kTestMidiFileWithMultipleTracks));
+  MidiEvent midiEvent;
+  const unsigned long expectedTimestamps[] = {0,     24000, 48000, 48000,
+                                              96000, 96000, 96000};
+  const byte expectedStatus[] = {MIDI_META_TYPE_TEMPO,
+                                 0x91,
+                                 MIDI_META_TYPE_TEMPO,
+                                 0x90,
+                                 0x90,
+                                 0x81,
+                                 MIDI_META_TYPE_TRACK_END};
+  unsigned long i;
+
+  assertNotNull(midiSequence);
+  assertUnsignedLongEquals(7ul, midiSequenceGetNumEvents(midiSequence));
+  for (i = 0; i < midiSequenceGetNumEvents(midiSequence); i++) {
+    midiEvent = midiSequenceGetEvent(midiSequence, i);
+    assertUnsignedLongEquals(expectedTimestamps[i], midiEvent->timestamp);
+    assertIntEquals(expectedStatus[i], midiEvent->status);
+  }
+
+  freeMidiSequence(midiSequence);
+  return 0;
+}
+
 TestSuite addMidiSourceTests(void);
 TestSuite addMidiSourceTests(void) {
-  TestSuite testSuite = newTestSuite("MidiSource", NULL, NULL);
+  TestSuite testSuite = newTestSuite("MidiSource", _midiSourceTestSetup,
+                                     _midiSourceTestTeardown);
   addTest(testSuite, "GuessMidiSourceType", _testGuessMidiSourceType);
   addTest(testSuite, "GuessMidiSourceTypeInvalid",
           _testGuessMidiSourceTypeInvalid);
   addTest(testSuite, "NewObject", _testNewMidiSource);
+  addTest(testSuite, "ReadMidiFileWithTempoChange",
+          _testReadMidiFileWithTempoChange);
+  addTest(testSuite, "ReadMidiFileWithMultipleTracks",
+          _testReadMidiFileWithMultipleTracks);
   return testSuite;
 }
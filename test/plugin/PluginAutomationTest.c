@@ -0,0 +1,361 @@
+//
+// PluginAutomationTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "plugin/PluginAutomation.h"
+
+#include "audio/AudioSettings.h"
+#include "midi/MidiEvent.h"
+#include "plugin/PluginGain.h"
+#include "unit/TestRunner.h"
+
+static void _pluginAutomationTestSetup(void) { initAudioSettings(); }
+
+static void _pluginAutomationTestTeardown(void) { freeAudioSettings(); }
+
+static PluginChain _newTestGainChain(void) {
+  CharString pluginName = newCharStringWithCString(kInternalPluginGainName);
+  PluginChain pluginChain = newPluginChain();
+
+  pluginChainAppend(pluginChain, newPluginGain(pluginName), NULL);
+  pluginChainInitialize(pluginChain);
+  freeCharString(pluginName);
+  return pluginChain;
+}
+
+static SampleBuffer _newTestInputBuffer(void) {
+  SampleBuffer buffer = newSampleBuffer(getNumChannels(), getBlocksize());
+  ChannelCount channel;
+  SampleCount sample;
+
+  for (channel = 0; channel < buffer->numChannels; channel++) {
+    for (sample = 0; sample < buffer->blocksize; sample++) {
+      buffer->samples[channel][sample] = 1.0f;
+    }
+  }
+
+  return buffer;
+}
+
+static void _freeTestGainChain(PluginChain pluginChain) {
+  pluginChainShutdown(pluginChain);
+  freePluginChain(pluginChain);
+}
+
+static int _testNewObject(void) {
+  PluginAutomation a = newPluginAutomation();
+  assertNotNull(a);
+  assertIntEquals(0, a->numPoints);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testAddPointsAreSorted(void) {
+  PluginAutomation a = newPluginAutomation();
+
+  pluginAutomationAddPoint(a, 100, 0, 0, 0.1f);
+  pluginAutomationAddPoint(a, 10, 0, 0, 0.2f);
+  pluginAutomationAddPoint(a, 100, 0, 0, 0.3f);
+  pluginAutomationAddPoint(a, 50, 0, 0, 0.4f);
+
+  assertIntEquals(4, a->numPoints);
+  assertUnsignedLongEquals(10ul, a->points[0].frame);
+  assertUnsignedLongEquals(50ul, a->points[1].frame);
+  assertUnsignedLongEquals(100ul, a->points[2].frame);
+  assertDoubleEquals(0.1, a->points[2].value, TEST_DEFAULT_TOLERANCE);
+  assertUnsignedLongEquals(100ul, a->points[3].frame);
+  assertDoubleEquals(0.3, a->points[3].value, TEST_DEFAULT_TOLERANCE);
+
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testAddManyPoints(void) {
+  PluginAutomation a = newPluginAutomation();
+  unsigned long i;
+
+  for (i = 0; i < 1000; i++) {
+    pluginAutomationAddPoint(a, 1000 - i, 0, 0, 0.0f);
+  }
+
+  assertIntEquals(1000, a->numPoints);
+  assertUnsignedLongEquals(1ul, a->points[0].frame);
+  assertUnsignedLongEquals(1000ul, a->points[999].frame);
+
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testAddPointFromString(void) {
+  PluginAutomation a = newPluginAutomation();
+  CharString line = newCharStringWithCString(" 44100, 1,2 ,0.8\r");
+
+  assert(pluginAutomationAddPointFromString(a, line));
+  assertIntEquals(1, a->numPoints);
+  assertUnsignedLongEquals(44100ul, a->points[0].frame);
+  assertIntEquals(1, a->points[0].pluginIndex);
+  assertIntEquals(2, a->points[0].parameterIndex);
+  assertDoubleEquals(0.8, a->points[0].value, TEST_DEFAULT_TOLERANCE);
+
+  freeCharString(line);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testAddProgramChangeFromString(void) {
+  PluginAutomation a = newPluginAutomation();
+  CharString line = newCharStringWithCString("512,0, program ,3");
+
+  assert(pluginAutomationAddPointFromString(a, line));
+  assertIntEquals(1, a->numPoints);
+  assertIntEquals(PLUGIN_AUTOMATION_TYPE_PROGRAM, a->points[0].type);
+  assertUnsignedLongEquals(512ul, a->points[0].frame);
+  assertIntEquals(0, a->points[0].pluginIndex);
+  assertIntEquals(3, a->points[0].programNumber);
+
+  freeCharString(line);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testAddProgramChangeFromInvalidString(void) {
+  PluginAutomation a = newPluginAutomation();
+  CharString missingProgram = newCharStringWithCString("1,0,program");
+  CharString badKeyword = newCharStringWithCString("1,0,programs,2");
+  CharString negative = newCharStringWithCString("1,0,program,-2");
+
+  assertFalse(pluginAutomationAddPointFromString(a, missingProgram));
+  assertFalse(pluginAutomationAddPointFromString(a, badKeyword));
+  assertFalse(pluginAutomationAddPointFromString(a, negative));
+  assertIntEquals(0, a->numPoints);
+
+  freeCharString(missingProgram);
+  freeCharString(badKeyword);
+  freeCharString(negative);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testAddPointFromEmptyString(void) {
+  PluginAutomation a = newPluginAutomation();
+  CharString line = newCharStringWithCString("   ");
+  CharString comment = newCharStringWithCString("# frame,plugin,param,value");
+
+  assert(pluginAutomationAddPointFromString(a, line));
+  assert(pluginAutomationAddPointFromString(a, comment));
+  assertIntEquals(0, a->numPoints);
+
+  freeCharString(line);
+  freeCharString(comment);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testAddPointFromInvalidString(void) {
+  PluginAutomation a = newPluginAutomation();
+  CharString missingField = newCharStringWithCString("1,0,0");
+  CharString extraField = newCharStringWithCString("1,0,0,0.5,1");
+  CharString notANumber = newCharStringWithCString("1,zero,0,0.5");
+  CharString negative = newCharStringWithCString("-1,0,0,0.5");
+
+  assertFalse(pluginAutomationAddPointFromString(a, missingField));
+  assertFalse(pluginAutomationAddPointFromString(a, extraField));
+  assertFalse(pluginAutomationAddPointFromString(a, notANumber));
+  assertFalse(pluginAutomationAddPointFromString(a, negative));
+  assertIntEquals(0, a->numPoints);
+
+  freeCharString(missingField);
+  freeCharString(extraField);
+  freeCharString(notANumber);
+  freeCharString(negative);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testReadInvalidFile(void) {
+  PluginAutomation a = newPluginAutomation();
+  CharString filename = newCharStringWithCString("invalid");
+
+  assertFalse(pluginAutomationReadFile(a, filename));
+
+  freeCharString(filename);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testIsValidForChain(void) {
+  PluginAutomation a = newPluginAutomation();
+  PluginChain pluginChain = _newTestGainChain();
+
+  pluginAutomationAddPoint(a, 0, 0, PLUGIN_GAIN_SETTINGS_GAIN, 0.5f);
+  assert(pluginAutomationIsValidForChain(a, pluginChain));
+  pluginAutomationAddPoint(a, 0, 1, PLUGIN_GAIN_SETTINGS_GAIN, 0.5f);
+  assertFalse(pluginAutomationIsValidForChain(a, pluginChain));
+
+  _freeTestGainChain(pluginChain);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testProcessAudioWithoutPoints(void) {
+  PluginAutomation a = newPluginAutomation();
+  PluginChain pluginChain = _newTestGainChain();
+  SampleBuffer inBuffer = _newTestInputBuffer();
+  SampleBuffer outBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+  LinkedList midiEvents = newLinkedList();
+
+  pluginAutomationProcessAudio(a, pluginChain, 0, midiEvents, inBuffer,
+                               outBuffer);
+  assertUnsignedLongEquals(getBlocksize(), outBuffer->blocksize);
+  assertDoubleEquals(1.0, outBuffer->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(1.0, outBuffer->samples[0][getBlocksize() - 1],
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeLinkedList(midiEvents);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  _freeTestGainChain(pluginChain);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testProcessAudioSplitsBlock(void) {
+  PluginAutomation a = newPluginAutomation();
+  PluginChain pluginChain = _newTestGainChain();
+  SampleBuffer inBuffer = _newTestInputBuffer();
+  SampleBuffer outBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+  LinkedList midiEvents = newLinkedList();
+  const unsigned long blockStart = getBlocksize() * 2;
+  ChannelCount channel;
+
+  pluginAutomationAddPoint(a, blockStart + 10, 0, PLUGIN_GAIN_SETTINGS_GAIN,
+                           0.5f);
+  pluginAutomationAddPoint(a, blockStart + 20, 0, PLUGIN_GAIN_SETTINGS_GAIN,
+                           0.25f);
+  pluginAutomationProcessAudio(a, pluginChain, blockStart, midiEvents,
+                               inBuffer, outBuffer);
+
+  assertUnsignedLongEquals(getBlocksize(), outBuffer->blocksize);
+  for (channel = 0; channel < outBuffer->numChannels; channel++) {
+    assertDoubleEquals(1.0, outBuffer->samples[channel][9],
+                       TEST_DEFAULT_TOLERANCE);
+    assertDoubleEquals(0.5, outBuffer->samples[channel][10],
+                       TEST_DEFAULT_TOLERANCE);
+    assertDoubleEquals(0.5, outBuffer->samples[channel][19],
+                       TEST_DEFAULT_TOLERANCE);
+    assertDoubleEquals(0.25, outBuffer->samples[channel][20],
+                       TEST_DEFAULT_TOLERANCE);
+    assertDoubleEquals(0.25, outBuffer->samples[channel][getBlocksize() - 1],
+                       TEST_DEFAULT_TOLERANCE);
+  }
+
+  freeLinkedList(midiEvents);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  _freeTestGainChain(pluginChain);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testProcessAudioAppliesPastPoints(void) {
+  PluginAutomation a = newPluginAutomation();
+  PluginChain pluginChain = _newTestGainChain();
+  SampleBuffer inBuffer = _newTestInputBuffer();
+  SampleBuffer outBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+  LinkedList midiEvents = newLinkedList();
+
+  pluginAutomationAddPoint(a, 5, 0, PLUGIN_GAIN_SETTINGS_GAIN, 0.5f);
+  pluginAutomationProcessAudio(a, pluginChain, 1000, midiEvents, inBuffer,
+                               outBuffer);
+  assertDoubleEquals(0.5, outBuffer->samples[0][0], TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.5, outBuffer->samples[0][getBlocksize() - 1],
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeLinkedList(midiEvents);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  _freeTestGainChain(pluginChain);
+  freePluginAutomation(a);
+  return 0;
+}
+
+static int _testProcessAudioSplitsMidiEvents(void) {
+  PluginAutomation a = newPluginAutomation();
+  PluginChain pluginChain = _newTestGainChain();
+  SampleBuffer inBuffer = _newTestInputBuffer();
+  SampleBuffer outBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+  LinkedList midiEvents = newLinkedList();
+  MidiEvent firstEvent = newMidiEvent();
+  MidiEvent secondEvent = newMidiEvent();
+
+  firstEvent->deltaFrames = 5;
+  secondEvent->deltaFrames = 25;
+  linkedListAppend(midiEvents, firstEvent);
+  linkedListAppend(midiEvents, secondEvent);
+  pluginAutomationAddPoint(a, 10, 0, PLUGIN_GAIN_SETTINGS_GAIN, 0.5f);
+  pluginAutomationProcessAudio(a, pluginChain, 0, midiEvents, inBuffer,
+                               outBuffer);
+
+  // Events are rescheduled relative to the start of their sub-block
+  assertUnsignedLongEquals(5ul, firstEvent->deltaFrames);
+  assertUnsignedLongEquals(15ul, secondEvent->deltaFrames);
+
+  freeLinkedListAndItems(midiEvents, (LinkedListFreeItemFunc)freeMidiEvent);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  _freeTestGainChain(pluginChain);
+  freePluginAutomation(a);
+  return 0;
+}
+
+TestSuite addPluginAutomationTests(void);
+TestSuite addPluginAutomationTests(void) {
+  TestSuite testSuite =
+      newTestSuite("PluginAutomation", _pluginAutomationTestSetup,
+                   _pluginAutomationTestTeardown);
+
+  addTest(testSuite, "NewObject", _testNewObject);
+  addTest(testSuite, "AddPointsAreSorted", _testAddPointsAreSorted);
+  addTest(testSuite, "AddManyPoints", _testAddManyPoints);
+  addTest(testSuite, "AddPointFromString", _testAddPointFromString);
+  addTest(testSuite, "AddProgramChangeFromString",
+          _testAddProgramChangeFromString);
+  addTest(testSuite, "AddProgramChangeFromInvalidString",
+          _testAddProgramChangeFromInvalidString);
+  addTest(testSuite, "AddPointFromEmptyString", _testAddPointFromEmptyString);
+  addTest(testSuite, "AddPointFromInvalidString",
+          _testAddPointFromInvalidString);
+  addTest(testSuite, "ReadInvalidFile", _testReadInvalidFile);
+  addTest(testSuite, "IsValidForChain", _testIsValidForChain);
+  addTest(testSuite, "ProcessAudioWithoutPoints",
+          _testProcessAudioWithoutPoints);
+  addTest(testSuite, "ProcessAudioSplitsBlock", _testProcessAudioSplitsBlock);
+  addTest(testSuite, "ProcessAudioAppliesPastPoints",
+          _testProcessAudioAppliesPastPoints);
+  addTest(testSuite, "ProcessAudioSplitsMidiEvents",
+          _testProcessAudioSplitsMidiEvents);
+
+  return testSuite;
+}
@@ -0,0 +1,182 @@
+//
+// PluginChainBenchmarkTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "plugin/PluginChainBenchmark.h"
+
+#include "audio/AudioSettings.h"
+#include "plugin/PluginPassthru.h"
+#include "unit/TestRunner.h"
+
+#include <unistd.h>
+
+static const char *TEST_BENCHMARK_FILENAME = "benchmark.pcm";
+
+static void _pluginChainBenchmarkTestSetup(void) {
+  initAudioSettings();
+  setBlocksize(8);
+  initPluginChain();
+}
+
+static void _pluginChainBenchmarkTestTeardown(void) {
+  freePluginChain(getPluginChain());
+  freeAudioSettings();
+}
+
+static PluginChain _newTestPluginChain(void) {
+  PluginChain p = getPluginChain();
+  CharString name = newCharStringWithCString(kInternalPluginPassthruName);
+
+  pluginChainAppend(p, newPluginPassthru(name), NULL);
+  pluginChainInitialize(p);
+  pluginChainPrepareForProcessing(p);
+
+  freeCharString(name);
+  return p;
+}
+
+static int _testNewObject(void) {
+  PluginChainBenchmark b = newPluginChainBenchmark();
+
+  assertNotNull(b);
+  assertUnsignedLongEquals(0ul, b->numFrames);
+  assertUnsignedLongEquals(0ul, b->numIterations);
+  assertIntEquals(0, b->numPlugins);
+  assertIsNull(b->pluginNsPerFrame);
+
+  freePluginChainBenchmark(b);
+  return 0;
+}
+
+static int _testSynthesize(void) {
+  PluginChainBenchmark b = newPluginChainBenchmark();
+  PluginChainBenchmark b2 = newPluginChainBenchmark();
+
+  // The signal is always made up of whole blocks
+  pluginChainBenchmarkSynthesize(b, 20);
+  pluginChainBenchmarkSynthesize(b2, 20);
+  assertUnsignedLongEquals(24ul, b->numFrames);
+  assertUnsignedLongEquals(3ul, b->_numBlocks);
+  assert(b->_blocks[2]->samples[1][7] <= 0.5f);
+  assert(b->_blocks[2]->samples[1][7] >= -0.5f);
+  assertDoubleEquals(b->_blocks[2]->samples[1][7],
+                     b2->_blocks[2]->samples[1][7], TEST_EXACT_TOLERANCE);
+
+  freePluginChainBenchmark(b);
+  freePluginChainBenchmark(b2);
+  return 0;
+}
+
+static int _testReadInput(void) {
+  CharString c = newCharStringWithCString(TEST_BENCHMARK_FILENAME);
+  SampleSource s;
+  SampleBuffer buffer;
+  PluginChainBenchmark b = newPluginChainBenchmark();
+  SampleCount i;
+
+  setNumChannels(1);
+  s = sampleSourceFactory(c);
+  buffer = newSampleBuffer(1, 12);
+
+  for (i = 0; i < buffer->blocksize; i++) {
+    buffer->samples[0][i] = 0.3125f;
+  }
+
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  assert(s->writeSampleBlock(s, buffer));
+  s->closeSampleSource(s);
+  freeSampleSource(s);
+
+  s = sampleSourceFactory(c);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+  assert(pluginChainBenchmarkReadInput(b, s, 0));
+  s->closeSampleSource(s);
+
+  // The last block is padded with silence
+  assertUnsignedLongEquals(16ul, b->numFrames);
+  assertUnsignedLongEquals(2ul, b->_numBlocks);
+  assertDoubleEquals(0.3125, b->_blocks[1]->samples[0][3],
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(0.0, b->_blocks[1]->samples[0][4], TEST_EXACT_TOLERANCE);
+
+  unlink(TEST_BENCHMARK_FILENAME);
+  freePluginChainBenchmark(b);
+  freeSampleBuffer(buffer);
+  freeSampleSource(s);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testRun(void) {
+  PluginChain p = _newTestPluginChain();
+  PluginChainBenchmark b = newPluginChainBenchmark();
+
+  pluginChainBenchmarkSynthesize(b, 64);
+  assert(pluginChainBenchmarkRun(b, p, 3));
+  assertUnsignedLongEquals(3ul, b->numIterations);
+  assertIntEquals(1, b->numPlugins);
+  assertNotNull(b->pluginNsPerFrame);
+  assertNotNull(b->pluginNsPerFrameDeviation);
+  assert(b->pluginNsPerFrame[0] >= 0.0);
+  assert(b->framesPerSecond >= 0.0);
+
+  freePluginChainBenchmark(b);
+  return 0;
+}
+
+static int _testRunWithoutSignal(void) {
+  PluginChain p = _newTestPluginChain();
+  PluginChainBenchmark b = newPluginChainBenchmark();
+
+  assertFalse(pluginChainBenchmarkRun(b, p, 3));
+
+  freePluginChainBenchmark(b);
+  return 0;
+}
+
+static int _testRunWithoutIterations(void) {
+  PluginChain p = _newTestPluginChain();
+  PluginChainBenchmark b = newPluginChainBenchmark();
+
+  pluginChainBenchmarkSynthesize(b, 64);
+  assertFalse(pluginChainBenchmarkRun(b, p, 0));
+
+  freePluginChainBenchmark(b);
+  return 0;
+}
+
+TestSuite addPluginChainBenchmarkTests(void);
+TestSuite addPluginChainBenchmarkTests(void) {
+  TestSuite testSuite =
+      newTestSuite("PluginChainBenchmark", _pluginChainBenchmarkTestSetup,
+                   _pluginChainBenchmarkTestTeardown);
+  addTest(testSuite, "NewObject", _testNewObject);
+  addTest(testSuite, "Synthesize", _testSynthesize);
+  addTest(testSuite, "ReadInput", _testReadInput);
+  addTest(testSuite, "Run", _testRun);
+  addTest(testSuite, "RunWithoutSignal", _testRunWithoutSignal);
+  addTest(testSuite, "RunWithoutIterations", _testRunWithoutIterations);
+  return testSuite;
+}
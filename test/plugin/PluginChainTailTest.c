@@ -0,0 +1,227 @@
+//
+// PluginChainTailTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "plugin/PluginChainTail.h"
+
+#include "audio/AudioSettings.h"
+#include "plugin/Plugin.h"
+#include "unit/TestRunner.h"
+
+static void _pluginChainTailTestSetup(void) { initAudioSettings(); }
+
+static void _pluginChainTailTestTeardown(void) { freeAudioSettings(); }
+
+static SampleBuffer _newTestBuffer(Sample value) {
+  SampleBuffer buffer = newSampleBuffer(2, 512);
+  SampleCount i;
+
+  for (i = 0; i < buffer->blocksize; i++) {
+    buffer->samples[0][i] = value;
+    buffer->samples[1][i] = value;
+  }
+
+  return buffer;
+}
+
+static int _testNewObject(void) {
+  PluginChainTail t = newPluginChainTail(10, 100, -20.0, 10);
+
+  assertNotNull(t);
+  assertUnsignedLongEquals(10ul, t->latencyFrames);
+  assertUnsignedLongEquals(4410ul, t->maxTailFrames);
+  assertDoubleEquals(0.1, t->threshold, TEST_DEFAULT_TOLERANCE);
+  assertUnsignedLongEquals(441ul, t->windowFrames);
+  assert(t->isTailTimeKnown);
+
+  freePluginChainTail(t);
+  return 0;
+}
+
+static int _testIsNeeded(void) {
+  PluginChainTail none = newPluginChainTail(0, 0, -90.0, 100);
+  PluginChainTail latency = newPluginChainTail(64, 0, -90.0, 100);
+  PluginChainTail tailTime = newPluginChainTail(0, 100, -90.0, 100);
+
+  assertFalse(pluginChainTailIsNeeded(none));
+  assert(pluginChainTailIsNeeded(latency));
+  assert(pluginChainTailIsNeeded(tailTime));
+
+  freePluginChainTail(none);
+  freePluginChainTail(latency);
+  freePluginChainTail(tailTime);
+  return 0;
+}
+
+static int _testLatencyIsFlushed(void) {
+  PluginChainTail t = newPluginChainTail(1000, 0, -90.0, 0);
+  SampleBuffer b = _newTestBuffer(0.0f);
+
+  pluginChainTailProcess(t, b);
+  assertFalse(pluginChainTailIsFinished(t));
+  pluginChainTailProcess(t, b);
+  assert(pluginChainTailIsFinished(t));
+
+  freeSampleBuffer(b);
+  freePluginChainTail(t);
+  return 0;
+}
+
+static int _testLatencyIsFlushedBeforeSilence(void) {
+  PluginChainTail t = newPluginChainTail(1000, 10000, -90.0, 1);
+  SampleBuffer b = _newTestBuffer(0.0f);
+
+  pluginChainTailProcess(t, b);
+  assertFalse(pluginChainTailIsFinished(t));
+  pluginChainTailProcess(t, b);
+  assert(pluginChainTailIsFinished(t));
+
+  freeSampleBuffer(b);
+  freePluginChainTail(t);
+  return 0;
+}
+
+static int _testStopsAfterSilenceWindow(void) {
+  PluginChainTail t = newPluginChainTail(0, 10000, -20.0, 10);
+  SampleBuffer loud = _newTestBuffer(0.5f);
+  SampleBuffer quiet = _newTestBuffer(0.01f);
+
+  pluginChainTailProcess(t, loud);
+  assertFalse(pluginChainTailIsFinished(t));
+  pluginChainTailProcess(t, quiet);
+  assert(pluginChainTailIsFinished(t));
+
+  freeSampleBuffer(loud);
+  freeSampleBuffer(quiet);
+  freePluginChainTail(t);
+  return 0;
+}
+
+static int _testSilenceWindowSpansBlocks(void) {
+  PluginChainTail t = newPluginChainTail(0, 10000, -20.0, 20);
+  SampleBuffer b = _newTestBuffer(0.0f);
+
+  // Only the last 100 frames of the first block are silent
+  b->samples[1][411] = -0.5f;
+  pluginChainTailProcess(t, b);
+  assertUnsignedLongEquals(100ul, t->_silentFrames);
+  assertFalse(pluginChainTailIsFinished(t));
+
+  b->samples[1][411] = 0.0f;
+  pluginChainTailProcess(t, b);
+  assertUnsignedLongEquals(612ul, t->_silentFrames);
+  assertFalse(pluginChainTailIsFinished(t));
+  pluginChainTailProcess(t, b);
+  assert(pluginChainTailIsFinished(t));
+
+  freeSampleBuffer(b);
+  freePluginChainTail(t);
+  return 0;
+}
+
+static int _testStopsAfterTailTime(void) {
+  PluginChainTail t = newPluginChainTail(0, 20, -90.0, 100);
+  SampleBuffer b = _newTestBuffer(1.0f);
+
+  pluginChainTailProcess(t, b);
+  assertFalse(pluginChainTailIsFinished(t));
+  pluginChainTailProcess(t, b);
+  assert(pluginChainTailIsFinished(t));
+
+  freeSampleBuffer(b);
+  freePluginChainTail(t);
+  return 0;
+}
+
+static int _testUnknownTailStopsAfterSilence(void) {
+  PluginChainTail t =
+      newPluginChainTail(512, PLUGIN_TAIL_TIME_UNKNOWN, -20.0, 10);
+  SampleBuffer b = _newTestBuffer(0.5f);
+  const Sample decay[] = {0.5f, 0.3f, 0.2f, 0.15f};
+  size_t i;
+
+  assertFalse(t->isTailTimeKnown);
+  assert(pluginChainTailIsNeeded(t));
+
+  // The first block only flushes the latency, the tail keeps decaying after
+  for (i = 0; i < sizeof(decay) / sizeof(Sample); i++) {
+    sampleBufferClear(b);
+    b->samples[0][b->blocksize - 1] = decay[i];
+    pluginChainTailProcess(t, b);
+    assertFalse(pluginChainTailIsFinished(t));
+  }
+
+  sampleBufferClear(b);
+  b->samples[1][0] = 0.05f;
+  pluginChainTailProcess(t, b);
+  assert(pluginChainTailIsFinished(t));
+
+  freeSampleBuffer(b);
+  freePluginChainTail(t);
+  return 0;
+}
+
+static int _testUnknownTailStopsAfterLimit(void) {
+  PluginChainTail t =
+      newPluginChainTail(0, PLUGIN_TAIL_TIME_UNKNOWN, -90.0, 100);
+  SampleBuffer b = _newTestBuffer(1.0f);
+  unsigned long framesRendered = 0;
+
+  while (!pluginChainTailIsFinished(t)) {
+    pluginChainTailProcess(t, b);
+    framesRendered += b->blocksize;
+  }
+
+  assert(framesRendered >= (unsigned long)(PLUGIN_CHAIN_TAIL_MAX_UNKNOWN_IN_MS *
+                                           DEFAULT_SAMPLE_RATE / 1000.0));
+  assert(framesRendered <= (unsigned long)(PLUGIN_CHAIN_TAIL_MAX_UNKNOWN_IN_MS *
+                                           DEFAULT_SAMPLE_RATE / 1000.0) +
+                               b->blocksize);
+
+  freeSampleBuffer(b);
+  freePluginChainTail(t);
+  return 0;
+}
+
+TestSuite addPluginChainTailTests(void);
+TestSuite addPluginChainTailTests(void) {
+  TestSuite testSuite =
+      newTestSuite("PluginChainTail", _pluginChainTailTestSetup,
+                   _pluginChainTailTestTeardown);
+  addTest(testSuite, "NewObject", _testNewObject);
+  addTest(testSuite, "IsNeeded", _testIsNeeded);
+  addTest(testSuite, "LatencyIsFlushed", _testLatencyIsFlushed);
+  addTest(testSuite, "LatencyIsFlushedBeforeSilence",
+          _testLatencyIsFlushedBeforeSilence);
+  addTest(testSuite, "StopsAfterSilenceWindow", _testStopsAfterSilenceWindow);
+  addTest(testSuite, "SilenceWindowSpansBlocks",
+          _testSilenceWindowSpansBlocks);
+  addTest(testSuite, "StopsAfterTailTime", _testStopsAfterTailTime);
+  addTest(testSuite, "UnknownTailStopsAfterSilence",
+          _testUnknownTailStopsAfterSilence);
+  addTest(testSuite, "UnknownTailStopsAfterLimit",
+          _testUnknownTailStopsAfterLimit);
+  return testSuite;
+}
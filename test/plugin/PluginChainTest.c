@@ -27,7 +27,9 @@
 #include "plugin/PluginChain.h"
 
 #include "audio/AudioSettings.h"
+#include "base/PlatformInfo.h"
 #include "midi/MidiEvent.h"
+#include "plugin/PluginGain.h"
 #include "plugin/PluginPassthru.h"
 #include "unit/TestRunner.h"
 
@@ -240,6 +242,147 @@ static int _testProcessPluginChainAudio(void) {
   return 0;
 }
 
+static int _testProcessPluginChainAudioDenormalCheck(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+
+  assert(pluginChainAppend(p, mock, NULL));
+  pluginChainSetDenormalCheck(p, true);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  inBuffer->samples[0][0] = 0.5f;
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertUnsignedLongEquals(1ul, p->_denormalStats[0].numQuietBlocks);
+  assertUnsignedLongEquals(2ul, p->_denormalStats[0].numNormalBlocks);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testReportDenormals(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+
+  assert(pluginChainAppend(p, mock, NULL));
+  assertFalse(pluginChainReportDenormals(p));
+
+  pluginChainSetDenormalCheck(p, true);
+  p->_denormalStats[0].numQuietBlocks = PLUGIN_CHAIN_DENORMAL_MIN_BLOCKS;
+  p->_denormalStats[0].quietTimeInMs = PLUGIN_CHAIN_DENORMAL_MIN_BLOCKS * 1.0;
+  p->_denormalStats[0].numNormalBlocks = PLUGIN_CHAIN_DENORMAL_MIN_BLOCKS;
+  p->_denormalStats[0].normalTimeInMs = PLUGIN_CHAIN_DENORMAL_MIN_BLOCKS * 0.9;
+  assertFalse(pluginChainReportDenormals(p));
+
+  p->_denormalStats[0].normalTimeInMs = PLUGIN_CHAIN_DENORMAL_MIN_BLOCKS * 0.1;
+  assert(pluginChainReportDenormals(p));
+
+  return 0;
+}
+
+static int _testProcessPluginChainAudioCpuStats(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+
+  assert(pluginChainAppend(p, mock, NULL));
+  assertIntEquals(PLUGIN_CHAIN_CPU_PROFILE_UNKNOWN,
+                  pluginChainGetCpuProfile(p, 0));
+  pluginChainSetCpuStats(p, true);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertUnsignedLongEquals(2ul, p->_cpuStats[0].totals.numMeasurements);
+  pluginChainReportCpuStats(p);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+static int _testGetCpuProfile(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  PluginChainCpuStats stats;
+
+  assert(pluginChainAppend(p, mock, NULL));
+  pluginChainSetCpuStats(p, true);
+  stats = &p->_cpuStats[0];
+  stats->totals.numMeasurements = 10;
+  stats->wallTimeInMs = 10.0;
+  stats->totals.cpuTimeInMs = 2.0;
+  assertIntEquals(PLUGIN_CHAIN_CPU_PROFILE_STALLING,
+                  pluginChainGetCpuProfile(p, 0));
+
+  stats->totals.cpuTimeInMs = 9.9;
+  assertIntEquals(PLUGIN_CHAIN_CPU_PROFILE_COMPUTE_BOUND,
+                  pluginChainGetCpuProfile(p, 0));
+
+  stats->totals.counters[CPU_COUNTER_CYCLES] = 4000000;
+  stats->totals.counters[CPU_COUNTER_INSTRUCTIONS] = 1000000;
+  stats->totals.counters[CPU_COUNTER_CACHE_MISSES] = 20000;
+  assertIntEquals(PLUGIN_CHAIN_CPU_PROFILE_MEMORY_BOUND,
+                  pluginChainGetCpuProfile(p, 0));
+
+  stats->totals.counters[CPU_COUNTER_CYCLES] = 500000;
+  assertIntEquals(PLUGIN_CHAIN_CPU_PROFILE_COMPUTE_BOUND,
+                  pluginChainGetCpuProfile(p, 0));
+
+  assertIntEquals(PLUGIN_CHAIN_CPU_PROFILE_UNKNOWN,
+                  pluginChainGetCpuProfile(p, 1));
+  return 0;
+}
+
+static int _testProcessPluginChainAudioSilenceBypass(void) {
+  CharString pluginName = newCharStringWithCString(kInternalPluginGainName);
+  Plugin gain = newPluginGain(pluginName);
+  PluginChain p = getPluginChain();
+  SampleBuffer inBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+  SampleBuffer outBuffer =
+      newSampleBuffer(DEFAULT_NUM_CHANNELS, DEFAULT_BLOCKSIZE);
+
+  assert(pluginChainAppend(p, gain, NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS, pluginChainInitialize(p));
+  pluginChainSetSilenceBypass(
+      p, true, PLUGIN_CHAIN_SILENCE_BYPASS_DEFAULT_THRESHOLD_IN_DB);
+  pluginChainPrepareForProcessing(p);
+
+  // The output of the first silent block must be checked before bypassing
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertUnsignedLongEquals(0ul, p->_silenceStates[0].numBypassedBlocks);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertUnsignedLongEquals(1ul, p->_silenceStates[0].numBypassedBlocks);
+
+  // Signal resumes processing at once
+  inBuffer->samples[0][1] = 0.5f;
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertDoubleEquals(0.5, outBuffer->samples[0][1], TEST_DEFAULT_TOLERANCE);
+  assertUnsignedLongEquals(1ul, p->_silenceStates[0].numBypassedBlocks);
+
+  // Plugins are not bypassed until their tail time has passed
+  inBuffer->samples[0][1] = 0.0f;
+  p->_silenceStates[0].tailFrames = DEFAULT_BLOCKSIZE * 2;
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertUnsignedLongEquals(1ul, p->_silenceStates[0].numBypassedBlocks);
+  pluginChainProcessAudio(p, inBuffer, outBuffer);
+  assertUnsignedLongEquals(2ul, p->_silenceStates[0].numBypassedBlocks);
+  assertUnsignedLongEquals(6ul, p->_silenceStates[0].numBlocks);
+  assertDoubleEquals(0.0, outBuffer->samples[0][1], TEST_DEFAULT_TOLERANCE);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  freeCharString(pluginName);
+  return 0;
+}
+
 static int _testProcessPluginChainAudioRealtime(void) {
   Plugin mock = newPluginMock();
   PluginChain p = getPluginChain();
@@ -296,6 +439,151 @@ static int _testShutdown(void) {
   return 0;
 }
 
+static int _testResetRestoresParameters(void) {
+  CharString pluginName = newCharStringWithCString(kInternalPluginGainName);
+  Plugin gain = newPluginGain(pluginName);
+  PluginChain p = getPluginChain();
+  LinkedList parameters = newLinkedList();
+  char parameter[] = "0,0.5";
+  char secondParameter[] = "0,0.25";
+  float value = 0.0f;
+
+  assert(pluginChainAppend(p, gain, NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS, pluginChainInitialize(p));
+  assert(pluginChainSaveState(p));
+  linkedListAppend(parameters, parameter);
+  linkedListAppend(parameters, secondParameter);
+  assert(pluginChainSetParameters(p, parameters));
+  assert(gain->getParameter(gain, PLUGIN_GAIN_SETTINGS_GAIN, &value));
+  assertDoubleEquals(0.25, value, TEST_DEFAULT_TOLERANCE);
+
+  assert(pluginChainReset(p));
+  assert(gain->getParameter(gain, PLUGIN_GAIN_SETTINGS_GAIN, &value));
+  assertDoubleEquals(1.0, value, TEST_DEFAULT_TOLERANCE);
+
+  freeLinkedList(parameters);
+  freeCharString(pluginName);
+  return 0;
+}
+
+static int _testResetReleasesHeldNotes(void) {
+  Plugin mock = newPluginMock();
+  PluginMockData mockData = (PluginMockData)mock->extraData;
+  PluginChain p = getPluginChain();
+
+  assert(pluginChainAppend(p, mock, NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS, pluginChainInitialize(p));
+  assertFalse(mockData->processMidiCalled);
+
+  assert(pluginChainReset(p));
+  assert(mockData->processMidiCalled);
+  assert(mockData->processAudioCalled);
+  // The plugin must be stopped again afterwards
+  assertFalse(mockData->isOpen);
+
+  return 0;
+}
+
+static int _testClone(void) {
+  CharString gainName = newCharStringWithCString(kInternalPluginGainName);
+  CharString passthruName =
+      newCharStringWithCString(kInternalPluginPassthruName);
+  PluginChain p = getPluginChain();
+  PluginChain clones[2];
+  Plugin gain;
+  float value = 0.0f;
+  unsigned int i;
+
+  assert(pluginChainAppend(p, newPluginGain(gainName), NULL));
+  assert(pluginChainAppend(p, newPluginPassthru(passthruName), NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS, pluginChainInitialize(p));
+  assert(p->plugins[0]->setParameter(p->plugins[0], PLUGIN_GAIN_SETTINGS_GAIN,
+                                     0.5f));
+
+  assert(pluginChainClone(p, 2, clones));
+
+  for (i = 0; i < 2; i++) {
+    assertNotNull(clones[i]);
+    assertIntEquals(2, clones[i]->numPlugins);
+    gain = clones[i]->plugins[0];
+    assert(gain != p->plugins[0]);
+    assert(gain->getParameter(gain, PLUGIN_GAIN_SETTINGS_GAIN, &value));
+    assertDoubleEquals(0.5, value, TEST_DEFAULT_TOLERANCE);
+    assertCharStringEquals(kInternalPluginPassthruName,
+                           clones[i]->plugins[1]->pluginName);
+    pluginChainShutdown(clones[i]);
+    freePluginChain(clones[i]);
+  }
+
+  freeCharString(gainName);
+  freeCharString(passthruName);
+  return 0;
+}
+
+static int _testCloneMoreThanNumProcessors(void) {
+  CharString gainName = newCharStringWithCString(kInternalPluginGainName);
+  PluginChain p = getPluginChain();
+  unsigned int numClones = platformInfoGetNumProcessors() * 2 + 1;
+  PluginChain *clones =
+      (PluginChain *)malloc(sizeof(PluginChain) * numClones);
+  Plugin gain;
+  float value = 0.0f;
+  unsigned int i;
+
+  assert(pluginChainAppend(p, newPluginGain(gainName), NULL));
+  assertIntEquals(RETURN_CODE_SUCCESS, pluginChainInitialize(p));
+  assert(p->plugins[0]->setParameter(p->plugins[0], PLUGIN_GAIN_SETTINGS_GAIN,
+                                     0.25f));
+
+  // The clones are created on several threads, so some threads create more
+  // than one clone
+  assert(pluginChainClone(p, numClones, clones));
+
+  for (i = 0; i < numClones; i++) {
+    assertNotNull(clones[i]);
+    gain = clones[i]->plugins[0];
+    assert(gain != p->plugins[0]);
+    assert(gain->getParameter(gain, PLUGIN_GAIN_SETTINGS_GAIN, &value));
+    assertDoubleEquals(0.25, value, TEST_DEFAULT_TOLERANCE);
+  }
+
+  for (i = 0; i < numClones; i++) {
+    pluginChainShutdown(clones[i]);
+    freePluginChain(clones[i]);
+  }
+
+  free(clones);
+  freeCharString(gainName);
+  return 0;
+}
+
+static int _testCloneEmptyChain(void) {
+  PluginChain p = getPluginChain();
+  PluginChain clone = NULL;
+
+  assert(pluginChainClone(p, 1, &clone));
+  assertNotNull(clone);
+  assertIntEquals(0, clone->numPlugins);
+
+  freePluginChain(clone);
+  return 0;
+}
+
+static int _testResetReloadsPreset(void) {
+  Plugin mock = newPluginMock();
+  PluginChain p = getPluginChain();
+  PluginPreset mockPreset = newPluginPresetMock();
+  PluginPresetMockData presetData = (PluginPresetMockData)mockPreset->extraData;
+
+  assert(pluginChainAppend(p, mock, mockPreset));
+  assertIntEquals(RETURN_CODE_SUCCESS, pluginChainInitialize(p));
+  presetData->isLoaded = false;
+  assert(pluginChainReset(p));
+  assert(presetData->isLoaded);
+
+  return 0;
+}
+
 TestSuite addPluginChainTests(void);
 TestSuite addPluginChainTests(void) {
   TestSuite testSuite = newTestSuite("PluginChain", _pluginChainTestSetup,
@@ -325,11 +613,26 @@ TestSuite addPluginChainTests(void) {
 
   addTest(testSuite, "PrepareForProcessing", _testPrepareForProcessing);
   addTest(testSuite, "ProcessPluginChainAudio", _testProcessPluginChainAudio);
+  addTest(testSuite, "ProcessPluginChainAudioDenormalCheck",
+          _testProcessPluginChainAudioDenormalCheck);
+  addTest(testSuite, "ReportDenormals", _testReportDenormals);
+  addTest(testSuite, "ProcessPluginChainAudioCpuStats",
+          _testProcessPluginChainAudioCpuStats);
+  addTest(testSuite, "GetCpuProfile", _testGetCpuProfile);
+  addTest(testSuite, "ProcessPluginChainAudioSilenceBypass",
+          _testProcessPluginChainAudioSilenceBypass);
   addTest(testSuite, "ProcessPluginChainAudioRealtime",
           _testProcessPluginChainAudioRealtime);
   addTest(testSuite, "ProcessPluginChainMidiEvents",
           _testProcessPluginChainMidiEvents);
 
+  addTest(testSuite, "ResetRestoresParameters", _testResetRestoresParameters);
+  addTest(testSuite, "ResetReleasesHeldNotes", _testResetReleasesHeldNotes);
+  addTest(testSuite, "Clone", _testClone);
+  addTest(testSuite, "CloneMoreThanNumProcessors",
+          _testCloneMoreThanNumProcessors);
+  addTest(testSuite, "CloneEmptyChain", _testCloneEmptyChain);
+  addTest(testSuite, "ResetReloadsPreset", _testResetReloadsPreset);
   addTest(testSuite, "Shutdown", _testShutdown);
 
   return testSuite;
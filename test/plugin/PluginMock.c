@@ -82,6 +82,20 @@ static boolByte _pluginMockSetParameter(void *pluginPtr, unsigned int i,
   return false;
 }
 
+static boolByte _pluginMockGetParameter(void *pluginPtr, unsigned int i,
+                                        float *outValue) {
+  return false;
+}
+
+// There are no settings to copy
+static PluginState _pluginMockGetState(void *pluginPtr) {
+  return newPluginState();
+}
+
+static boolByte _pluginMockSetState(void *pluginPtr, const PluginState state) {
+  return true;
+}
+
 static void _pluginMockClose(void *pluginPtr) {
   Plugin self = (Plugin)pluginPtr;
   PluginMockData extraData = (PluginMockData)self->extraData;
@@ -100,6 +114,9 @@ Plugin newPluginMock(void) {
   plugin->processAudio = _pluginMockProcessAudio;
   plugin->processMidiEvents = _pluginMockProcessMidiEvents;
   plugin->setParameter = _pluginMockSetParameter;
+  plugin->getParameter = _pluginMockGetParameter;
+  plugin->getState = _pluginMockGetState;
+  plugin->setState = _pluginMockSetState;
   plugin->closePlugin = _pluginMockClose;
   plugin->freePluginData = _pluginMockEmpty;
 
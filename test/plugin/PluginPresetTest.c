@@ -27,10 +27,61 @@
 #include "plugin/PluginPreset.h"
 
 #include "PluginMock.h"
+#include "plugin/PluginGain.h"
+#include "plugin/PluginPresetFxb.h"
+
+#include <string.h>
 
 #include "unit/TestRunner.h"
 
 const char *TEST_PRESET_FILENAME = "test.fxp";
+const char *TEST_BANK_FILENAME = "test.fxb";
+
+#define TEST_BANK_SIZE 276
+
+static void _writeTestBankUnsignedInt(byte *data, size_t *offset,
+                                      unsigned int value) {
+  data[(*offset)++] = (byte)((value >> 24) & 0xff);
+  data[(*offset)++] = (byte)((value >> 16) & 0xff);
+  data[(*offset)++] = (byte)((value >> 8) & 0xff);
+  data[(*offset)++] = (byte)(value & 0xff);
+}
+
+static void _writeTestBankProgram(byte *data, size_t *offset, const char *name,
+                                  float value) {
+  unsigned int valueBuffer;
+
+  _writeTestBankUnsignedInt(data, offset, 0x43636E4B); // 'CcnK'
+  _writeTestBankUnsignedInt(data, offset, 52);
+  _writeTestBankUnsignedInt(data, offset, 0x4678436B); // 'FxCk'
+  _writeTestBankUnsignedInt(data, offset, 1);
+  _writeTestBankUnsignedInt(data, offset, 0x74657374); // 'test'
+  _writeTestBankUnsignedInt(data, offset, 1);
+  _writeTestBankUnsignedInt(data, offset, 1);
+  memset(data + *offset, 0, 28);
+  memcpy(data + *offset, name, strlen(name));
+  *offset += 28;
+  memcpy(&valueBuffer, &value, sizeof(float));
+  _writeTestBankUnsignedInt(data, offset, valueBuffer);
+}
+
+// Fill data with a regular bank of two programs, each with one parameter
+static void _fillTestBank(byte *data) {
+  size_t offset = 0;
+
+  memset(data, 0, TEST_BANK_SIZE);
+  _writeTestBankUnsignedInt(data, &offset, 0x43636E4B); // 'CcnK'
+  _writeTestBankUnsignedInt(data, &offset, TEST_BANK_SIZE - 8);
+  _writeTestBankUnsignedInt(data, &offset, 0x4678426B); // 'FxBk'
+  _writeTestBankUnsignedInt(data, &offset, 2);
+  _writeTestBankUnsignedInt(data, &offset, 0x74657374); // 'test'
+  _writeTestBankUnsignedInt(data, &offset, 1);
+  _writeTestBankUnsignedInt(data, &offset, 2);
+  _writeTestBankUnsignedInt(data, &offset, 1);
+  offset += 124;
+  _writeTestBankProgram(data, &offset, "First", 0.5f);
+  _writeTestBankProgram(data, &offset, "Second", 0.25f);
+}
 
 static int _testGuessPluginPresetType(void) {
   CharString c = newCharStringWithCString(TEST_PRESET_FILENAME);
@@ -41,6 +92,15 @@ static int _testGuessPluginPresetType(void) {
   return 0;
 }
 
+static int _testGuessPluginPresetTypeFxb(void) {
+  CharString c = newCharStringWithCString(TEST_BANK_FILENAME);
+  PluginPreset p = pluginPresetFactory(c);
+  assertIntEquals(PRESET_TYPE_FXB, p->presetType);
+  freePluginPreset(p);
+  freeCharString(c);
+  return 0;
+}
+
 static int _testGuessPluginPresetTypeInvalid(void) {
   CharString c = newCharStringWithCString("invalid");
   PluginPreset p = pluginPresetFactory(c);
@@ -88,10 +148,120 @@ static int _testIsPresetNotCompatibleWithPlugin(void) {
   return 0;
 }
 
+static int _testParseFxbBank(void) {
+  CharString c = newCharStringWithCString(TEST_BANK_FILENAME);
+  PluginPreset p = newPluginPresetFxb(c);
+  PluginPresetFxbData d = (PluginPresetFxbData)p->extraData;
+  byte data[TEST_BANK_SIZE];
+
+  _fillTestBank(data);
+  assert(pluginPresetFxbParse(p, data, TEST_BANK_SIZE));
+  assert(d->isParsed);
+  assertUnsignedLongEquals(0x74657374ul, (unsigned long)d->fxID);
+  assertIntEquals(2, d->numPrograms);
+  assertIntEquals(1, d->currentProgram);
+  assertIsNull(d->bankChunk);
+  assertCharStringEquals("First", d->programs[0]->name);
+  assertCharStringEquals("Second", d->programs[1]->name);
+  assertIntEquals(1, d->programs[1]->numParameters);
+  assertDoubleEquals(0.25, d->programs[1]->parameters[0],
+                     TEST_DEFAULT_TOLERANCE);
+
+  freePluginPreset(p);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testParseFxbBankWithBadMagic(void) {
+  CharString c = newCharStringWithCString(TEST_BANK_FILENAME);
+  PluginPreset p = newPluginPresetFxb(c);
+  byte data[TEST_BANK_SIZE];
+
+  _fillTestBank(data);
+  data[0] = 'X';
+  assertFalse(pluginPresetFxbParse(p, data, TEST_BANK_SIZE));
+
+  freePluginPreset(p);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testParseTruncatedFxbBank(void) {
+  CharString c = newCharStringWithCString(TEST_BANK_FILENAME);
+  PluginPreset p = newPluginPresetFxb(c);
+  byte data[TEST_BANK_SIZE];
+
+  _fillTestBank(data);
+  assertFalse(pluginPresetFxbParse(p, data, TEST_BANK_SIZE - 2));
+
+  freePluginPreset(p);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testParseFxbBankWithTooManyPrograms(void) {
+  CharString c = newCharStringWithCString(TEST_BANK_FILENAME);
+  PluginPreset p = newPluginPresetFxb(c);
+  byte data[TEST_BANK_SIZE];
+  size_t offset = 6 * 4;
+
+  _fillTestBank(data);
+  _writeTestBankUnsignedInt(data, &offset, 0x7fffffff);
+  assertFalse(pluginPresetFxbParse(p, data, TEST_BANK_SIZE));
+  assertIntEquals(0, ((PluginPresetFxbData)p->extraData)->numPrograms);
+
+  freePluginPreset(p);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testParseFxbBankWithTooManyParameters(void) {
+  CharString c = newCharStringWithCString(TEST_BANK_FILENAME);
+  PluginPreset p = newPluginPresetFxb(c);
+  byte data[TEST_BANK_SIZE];
+  // Parameter count of the second program
+  size_t offset = 7 * 4 + 128 + 60 + 6 * 4;
+
+  _fillTestBank(data);
+  _writeTestBankUnsignedInt(data, &offset, 0x40000000);
+  assertFalse(pluginPresetFxbParse(p, data, TEST_BANK_SIZE));
+
+  freePluginPreset(p);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testLoadFxbProgram(void) {
+  CharString c = newCharStringWithCString(TEST_BANK_FILENAME);
+  CharString pluginName = newCharStringWithCString(kInternalPluginGainName);
+  PluginPreset p = newPluginPresetFxb(c);
+  Plugin gain = newPluginGain(pluginName);
+  byte data[TEST_BANK_SIZE];
+  float value = 0.0f;
+
+  _fillTestBank(data);
+  assert(pluginPresetFxbParse(p, data, TEST_BANK_SIZE));
+  assert(pluginPresetFxbLoadProgram(p, gain, 1));
+  assert(gain->getParameter(gain, 0, &value));
+  assertDoubleEquals(0.25, value, TEST_DEFAULT_TOLERANCE);
+  assert(pluginPresetFxbLoadProgram(p, gain, 0));
+  assert(gain->getParameter(gain, 0, &value));
+  assertDoubleEquals(0.5, value, TEST_DEFAULT_TOLERANCE);
+  assertFalse(pluginPresetFxbLoadProgram(p, gain, 2));
+
+  freePlugin(gain);
+  freePluginPreset(p);
+  freeCharString(pluginName);
+  freeCharString(c);
+  return 0;
+}
+
 TestSuite addPluginPresetTests(void);
 TestSuite addPluginPresetTests(void) {
   TestSuite testSuite = newTestSuite("PluginPreset", NULL, NULL);
   addTest(testSuite, "GuessPluginPresetType", _testGuessPluginPresetType);
+  addTest(testSuite, "GuessPluginPresetTypeFxb",
+          _testGuessPluginPresetTypeFxb);
   addTest(testSuite, "GuessPluginPresetTypeInvalid",
           _testGuessPluginPresetTypeInvalid);
   addTest(testSuite, "NewObject", _testNewObject);
@@ -99,5 +269,13 @@ TestSuite addPluginPresetTests(void) {
           _testIsPresetCompatibleWithPlugin);
   addTest(testSuite, "IsPresetNotCompatibleWithPlugin",
           _testIsPresetNotCompatibleWithPlugin);
+  addTest(testSuite, "ParseFxbBank", _testParseFxbBank);
+  addTest(testSuite, "ParseFxbBankWithBadMagic", _testParseFxbBankWithBadMagic);
+  addTest(testSuite, "ParseTruncatedFxbBank", _testParseTruncatedFxbBank);
+  addTest(testSuite, "ParseFxbBankWithTooManyPrograms",
+          _testParseFxbBankWithTooManyPrograms);
+  addTest(testSuite, "ParseFxbBankWithTooManyParameters",
+          _testParseFxbBankWithTooManyParameters);
+  addTest(testSuite, "LoadFxbProgram", _testLoadFxbProgram);
   return testSuite;
 }
@@ -26,6 +26,7 @@
 
 #include "plugin/Plugin.h"
 
+#include "plugin/PluginGain.h"
 #include "unit/TestRunner.h"
 
 static int _testPluginFactory(void) {
@@ -98,6 +99,73 @@ static int _testFreeNullPlugin(void) {
   return 0;
 }
 
+static int _testCloneWithState(void) {
+  CharString gainName = newCharStringWithCString(kInternalPluginGainName);
+  Plugin p = pluginFactory(gainName, NULL);
+  Plugin clone;
+  PluginState state;
+  float value = 0.0f;
+
+  assert(openPlugin(p));
+  assert(p->setParameter(p, PLUGIN_GAIN_SETTINGS_GAIN, 0.5f));
+  state = p->getState(p);
+  assertNotNull(state);
+  assertIntEquals(PLUGIN_GAIN_NUM_SETTINGS, state->numParameters);
+
+  clone = pluginCloneWithState(p, state);
+  assertNotNull(clone);
+  assert(clone != p);
+  assert(clone->isOpen);
+  assertCharStringEquals(kInternalPluginGainName, clone->pluginName);
+  assert(clone->getParameter(clone, PLUGIN_GAIN_SETTINGS_GAIN, &value));
+  assertDoubleEquals(0.5, value, TEST_DEFAULT_TOLERANCE);
+
+  // Changing the original after the state was taken should not affect clones
+  assert(p->setParameter(p, PLUGIN_GAIN_SETTINGS_GAIN, 0.25f));
+  assert(clone->getParameter(clone, PLUGIN_GAIN_SETTINGS_GAIN, &value));
+  assertDoubleEquals(0.5, value, TEST_DEFAULT_TOLERANCE);
+
+  freePluginState(state);
+  closePlugin(clone);
+  freePlugin(clone);
+  closePlugin(p);
+  freePlugin(p);
+  freeCharString(gainName);
+  return 0;
+}
+
+static int _testCloneWithNullState(void) {
+  CharString silence = newCharStringWithCString("mrs_silence");
+  Plugin p = pluginFactory(silence, NULL);
+
+  assertIsNull(pluginCloneWithState(p, NULL));
+
+  freeCharString(silence);
+  freePlugin(p);
+  return 0;
+}
+
+static int _testPluginStateSetChunk(void) {
+  PluginState state = newPluginState();
+  const char chunk[] = "chunk";
+
+  assertIntEquals(PLUGIN_STATE_NO_PROGRAM, state->program);
+  assertIsNull(state->chunk);
+  pluginStateSetChunk(state, chunk, sizeof(chunk));
+  assertNotNull(state->chunk);
+  assert(state->chunk != chunk);
+  assertUnsignedLongEquals(sizeof(chunk), state->chunkSize);
+  assertIntEquals(0, memcmp(chunk, state->chunk, sizeof(chunk)));
+
+  freePluginState(state);
+  return 0;
+}
+
+static int _testFreeNullPluginState(void) {
+  freePluginState(NULL);
+  return 0;
+}
+
 TestSuite addPluginTests(void);
 TestSuite addPluginTests(void) {
   TestSuite testSuite = newTestSuite("Plugin", NULL, NULL);
@@ -110,5 +178,9 @@ TestSuite addPluginTests(void) {
           _testPluginFactoryEmptyPluginName);
   addTest(testSuite, "PluginFactoryNullRoot", _testPluginFactoryNullRoot);
   addTest(testSuite, "FreeNullPlugin", _testFreeNullPlugin);
+  addTest(testSuite, "CloneWithState", _testCloneWithState);
+  addTest(testSuite, "CloneWithNullState", _testCloneWithNullState);
+  addTest(testSuite, "PluginStateSetChunk", _testPluginStateSetChunk);
+  addTest(testSuite, "FreeNullPluginState", _testFreeNullPluginState);
   return testSuite;
 }
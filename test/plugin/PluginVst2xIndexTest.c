@@ -0,0 +1,418 @@
+//
+// PluginVst2xIndexTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "base/File.h"
+#include "plugin/PluginVst2xId.h"
+#include "plugin/PluginVst2xIndex.h"
+
+#include "unit/TestRunner.h"
+
+#define TEST_INDEX_FILENAME "test_plugin_index.txt"
+#define TEST_PLUGIN_NAME "test_plugin"
+#define TEST_PLUGIN_FILENAME "test_plugin.so"
+#define TEST_PLUGIN_UNIQUE_ID 0x41424344ul
+
+static void _pluginVst2xIndexTestTeardown(void) {
+  unlink(TEST_INDEX_FILENAME);
+  unlink(TEST_PLUGIN_FILENAME);
+}
+
+static CharString _newTestPluginPath(void) {
+  CharString filename = newCharStringWithCString(TEST_PLUGIN_FILENAME);
+  File pluginFile = newFileWithPath(filename);
+  CharString result = newCharStringWithCString(pluginFile->absolutePath->data);
+
+  if (!fileExists(pluginFile)) {
+    fileCreate(pluginFile, kFileTypeFile);
+    fileWrite(pluginFile, filename);
+  }
+
+  freeFile(pluginFile);
+  freeCharString(filename);
+  return result;
+}
+
+static PluginVst2xIndexEntry _newTestIndexEntry(void) {
+  PluginVst2xIndexEntry entry = newPluginVst2xIndexEntry();
+  CharString pluginPath = _newTestPluginPath();
+  File pluginFile = newFileWithPath(pluginPath);
+
+  charStringCopy(entry->absolutePath, pluginPath);
+  entry->modifiedTime = fileGetModifiedTime(pluginFile);
+  entry->uniqueId = TEST_PLUGIN_UNIQUE_ID;
+  entry->version = 1200;
+  entry->pluginType = PLUGIN_TYPE_INSTRUMENT;
+  entry->numInputs = 0;
+  entry->numOutputs = 2;
+  linkedListAppend(entry->parameterNames, newCharStringWithCString("Cutoff"));
+  linkedListAppend(entry->parameterNames, newCharStringWithCString("Res\tQ"));
+  linkedListAppend(entry->canDos, newCharStringWithCString("receiveVstEvents"));
+
+  freeFile(pluginFile);
+  freeCharString(pluginPath);
+  return entry;
+}
+
+static PluginVst2xIndex _newTestIndex(void) {
+  CharString indexPath = newCharStringWithCString(TEST_INDEX_FILENAME);
+  PluginVst2xIndex index = newPluginVst2xIndex(indexPath);
+  freeCharString(indexPath);
+  return index;
+}
+
+static int _testNewPluginVst2xIndex(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  assertCharStringEquals(TEST_INDEX_FILENAME, index->indexPath);
+  assertIntEquals(0, linkedListLength(index->entries));
+  assertFalse(index->isDirty);
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testNewPluginVst2xIndexDefaultPath(void) {
+  PluginVst2xIndex index = newPluginVst2xIndex(NULL);
+  assertFalse(charStringIsEmpty(index->indexPath));
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testLoadMissingIndex(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  assertFalse(pluginVst2xIndexLoad(index));
+  assertIntEquals(0, linkedListLength(index->entries));
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testSaveAndLoadIndex(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xIndexEntry entry;
+  CharString parameterName;
+  CharString canDo;
+
+  pluginVst2xIndexAdd(index, _newTestIndexEntry());
+  assert(index->isDirty);
+  assert(pluginVst2xIndexSave(index));
+  assertFalse(index->isDirty);
+  freePluginVst2xIndex(index);
+
+  index = _newTestIndex();
+  assert(pluginVst2xIndexLoad(index));
+  assertIntEquals(1, linkedListLength(index->entries));
+  entry = (PluginVst2xIndexEntry)index->entries->item;
+  assert(pluginVst2xIndexEntryIsValid(entry));
+  assertUnsignedLongEquals(TEST_PLUGIN_UNIQUE_ID, entry->uniqueId);
+  assertUnsignedLongEquals(1200ul, entry->version);
+  assertIntEquals(PLUGIN_TYPE_INSTRUMENT, entry->pluginType);
+  assertIntEquals(0, entry->numInputs);
+  assertIntEquals(2, entry->numOutputs);
+  assertIntEquals(0, linkedListLength(entry->shellPluginIds));
+  assertIntEquals(2, linkedListLength(entry->parameterNames));
+  parameterName = (CharString)entry->parameterNames->item;
+  assertCharStringEquals("Cutoff", parameterName);
+  // Tabs must not end up in the index file
+  parameterName =
+      (CharString)((LinkedList)entry->parameterNames->nextItem)->item;
+  assertCharStringEquals("Res Q", parameterName);
+  assertIntEquals(1, linkedListLength(entry->canDos));
+  canDo = (CharString)entry->canDos->item;
+  assertCharStringEquals("receiveVstEvents", canDo);
+
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testSaveAndLoadShellPlugin(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xIndexEntry entry = _newTestIndexEntry();
+  PluginVst2xId shellPluginId;
+
+  linkedListAppend(entry->shellPluginIds,
+                   newPluginVst2xIdWithId(TEST_PLUGIN_UNIQUE_ID));
+  pluginVst2xIndexAdd(index, entry);
+  assert(pluginVst2xIndexSave(index));
+  assert(pluginVst2xIndexLoad(index));
+
+  assertIntEquals(1, linkedListLength(index->entries));
+  entry = (PluginVst2xIndexEntry)index->entries->item;
+  assertIntEquals(1, linkedListLength(entry->shellPluginIds));
+  shellPluginId = (PluginVst2xId)entry->shellPluginIds->item;
+  assertCharStringEquals("ABCD", shellPluginId->idString);
+
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testLoadIndexWithOtherVersion(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  CharString contents = newCharStringWithCString("index\t0\nplugin\t/a.so\n");
+  File indexFile = newFileWithPath(index->indexPath);
+
+  assert(fileCreate(indexFile, kFileTypeFile));
+  assert(fileWrite(indexFile, contents));
+  fileClose(indexFile);
+  assertFalse(pluginVst2xIndexLoad(index));
+  assertIntEquals(0, linkedListLength(index->entries));
+
+  freeFile(indexFile);
+  freeCharString(contents);
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testAddReplacesExistingEntry(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xIndexEntry entry = _newTestIndexEntry();
+
+  pluginVst2xIndexAdd(index, _newTestIndexEntry());
+  entry->version = 1300;
+  pluginVst2xIndexAdd(index, entry);
+  assertIntEquals(1, linkedListLength(index->entries));
+  entry = pluginVst2xIndexFindPath(index, entry->absolutePath);
+  assertNotNull(entry);
+  assertUnsignedLongEquals(1300ul, entry->version);
+
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testFindByName(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xIndexEntry entry = _newTestIndexEntry();
+  CharString pluginName = newCharString();
+
+  pluginVst2xIndexAdd(index, entry);
+  charStringCopyCString(pluginName, TEST_PLUGIN_NAME);
+  assert(pluginVst2xIndexFind(index, pluginName, NULL) == entry);
+  charStringCopyCString(pluginName, TEST_PLUGIN_FILENAME);
+  assert(pluginVst2xIndexFind(index, pluginName, NULL) == entry);
+  charStringCopyCString(pluginName, TEST_PLUGIN_NAME ":ABCD");
+  assert(pluginVst2xIndexFind(index, pluginName, NULL) == entry);
+  assert(pluginVst2xIndexFind(index, entry->absolutePath, NULL) == entry);
+  charStringCopyCString(pluginName, "test");
+  assert(pluginVst2xIndexFind(index, pluginName, NULL) == NULL);
+
+  freeCharString(pluginName);
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testFindInPluginRoot(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xIndexEntry entry = _newTestIndexEntry();
+  CharString pluginName = newCharStringWithCString(TEST_PLUGIN_NAME);
+  CharString otherRoot = newCharStringWithCString("/nonexistent");
+  CharString pluginRoot = fileGetCurrentDirectory();
+
+  pluginVst2xIndexAdd(index, entry);
+  assert(pluginVst2xIndexFind(index, pluginName, pluginRoot) == entry);
+  // Entries outside of the plugin root are still found as a fallback
+  assert(pluginVst2xIndexFind(index, pluginName, otherRoot) == entry);
+
+  freeCharString(pluginRoot);
+  freeCharString(otherRoot);
+  freeCharString(pluginName);
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testFindStaleEntry(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xIndexEntry entry = _newTestIndexEntry();
+  CharString pluginName = newCharStringWithCString(TEST_PLUGIN_NAME);
+
+  entry->modifiedTime--;
+  pluginVst2xIndexAdd(index, entry);
+  assertFalse(pluginVst2xIndexEntryIsValid(entry));
+  assertIsNull(pluginVst2xIndexFind(index, pluginName, NULL));
+
+  freeCharString(pluginName);
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testFindFailedEntry(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xIndexEntry entry = _newTestIndexEntry();
+  CharString pluginName = newCharStringWithCString(TEST_PLUGIN_NAME);
+
+  entry->status = PLUGIN_VST2X_INDEX_STATUS_CRASHED;
+  pluginVst2xIndexAdd(index, entry);
+  assert(pluginVst2xIndexEntryIsValid(entry));
+  assertIsNull(pluginVst2xIndexFind(index, pluginName, NULL));
+
+  freeCharString(pluginName);
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testSaveAndLoadEntryStatus(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xIndexEntry entry = _newTestIndexEntry();
+
+  entry->status = PLUGIN_VST2X_INDEX_STATUS_TIMED_OUT;
+  pluginVst2xIndexAdd(index, entry);
+  assert(pluginVst2xIndexSave(index));
+  assert(pluginVst2xIndexLoad(index));
+
+  assertIntEquals(1, linkedListLength(index->entries));
+  entry = (PluginVst2xIndexEntry)index->entries->item;
+  assertIntEquals(PLUGIN_VST2X_INDEX_STATUS_TIMED_OUT, entry->status);
+
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testNewEntryWithString(void) {
+  CharString text = newCharStringWithCString("plugin\t/tmp/a.so\n"
+                                             "status\tfailed\n"
+                                             "id\t1094861636\n"
+                                             "outputs\t2\n");
+  PluginVst2xIndexEntry entry = newPluginVst2xIndexEntryWithString(text);
+
+  assertNotNull(entry);
+  assertCharStringEquals("/tmp/a.so", entry->absolutePath);
+  assertIntEquals(PLUGIN_VST2X_INDEX_STATUS_FAILED, entry->status);
+  assertUnsignedLongEquals(TEST_PLUGIN_UNIQUE_ID, entry->uniqueId);
+  assertIntEquals(2, entry->numOutputs);
+
+  freePluginVst2xIndexEntry(entry);
+  freeCharString(text);
+  return 0;
+}
+
+static int _testNewEntryWithInvalidString(void) {
+  CharString text = newCharStringWithCString("status\tok\n");
+  assertIsNull(newPluginVst2xIndexEntryWithString(text));
+  freeCharString(text);
+  return 0;
+}
+
+static int _testFindRemovedPlugin(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xIndexEntry entry = _newTestIndexEntry();
+  CharString pluginName = newCharStringWithCString(TEST_PLUGIN_NAME);
+
+  pluginVst2xIndexAdd(index, entry);
+  unlink(TEST_PLUGIN_FILENAME);
+  assertIsNull(pluginVst2xIndexFind(index, pluginName, NULL));
+
+  freeCharString(pluginName);
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testSaveAndLoadCompleteIndex(void) {
+  PluginVst2xIndex index = _newTestIndex();
+
+  pluginVst2xIndexAdd(index, _newTestIndexEntry());
+  assert(pluginVst2xIndexSave(index));
+  freePluginVst2xIndex(index);
+
+  index = _newTestIndex();
+  assert(pluginVst2xIndexLoad(index));
+  assertFalse(index->isComplete);
+  index->isComplete = true;
+  assert(pluginVst2xIndexSave(index));
+  freePluginVst2xIndex(index);
+
+  index = _newTestIndex();
+  assert(pluginVst2xIndexLoad(index));
+  assert(index->isComplete);
+
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testRemoveStaleEntries(void) {
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xIndexEntry entry = _newTestIndexEntry();
+
+  pluginVst2xIndexAdd(index, entry);
+  index->isDirty = false;
+  assert(pluginVst2xIndexRemoveStaleEntries(index));
+  assertIntEquals(1, linkedListLength(index->entries));
+  assertFalse(index->isDirty);
+
+  // Changed plugins are kept, but the index no longer describes them
+  entry->modifiedTime--;
+  assertFalse(pluginVst2xIndexRemoveStaleEntries(index));
+  assertIntEquals(1, linkedListLength(index->entries));
+
+  unlink(TEST_PLUGIN_FILENAME);
+  assert(pluginVst2xIndexRemoveStaleEntries(index));
+  assertIntEquals(0, linkedListLength(index->entries));
+  assert(index->isDirty);
+
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+static int _testClearIndex(void) {
+  PluginVst2xIndex index = _newTestIndex();
+
+  pluginVst2xIndexAdd(index, _newTestIndexEntry());
+  index->isComplete = true;
+  pluginVst2xIndexClear(index);
+  assertIntEquals(0, linkedListLength(index->entries));
+  assert(index->isDirty);
+  assertFalse(index->isComplete);
+
+  freePluginVst2xIndex(index);
+  return 0;
+}
+
+TestSuite addPluginVst2xIndexTests(void);
+TestSuite addPluginVst2xIndexTests(void) {
+  TestSuite testSuite =
+      newTestSuite("PluginVst2xIndex", NULL, _pluginVst2xIndexTestTeardown);
+
+  addTest(testSuite, "NewPluginVst2xIndex", _testNewPluginVst2xIndex);
+  addTest(testSuite, "NewPluginVst2xIndexDefaultPath",
+          _testNewPluginVst2xIndexDefaultPath);
+  addTest(testSuite, "LoadMissingIndex", _testLoadMissingIndex);
+  addTest(testSuite, "SaveAndLoadIndex", _testSaveAndLoadIndex);
+  addTest(testSuite, "SaveAndLoadShellPlugin", _testSaveAndLoadShellPlugin);
+  addTest(testSuite, "LoadIndexWithOtherVersion",
+          _testLoadIndexWithOtherVersion);
+  addTest(testSuite, "AddReplacesExistingEntry",
+          _testAddReplacesExistingEntry);
+  addTest(testSuite, "FindByName", _testFindByName);
+  addTest(testSuite, "FindInPluginRoot", _testFindInPluginRoot);
+  addTest(testSuite, "FindStaleEntry", _testFindStaleEntry);
+  addTest(testSuite, "FindFailedEntry", _testFindFailedEntry);
+  addTest(testSuite, "FindRemovedPlugin", _testFindRemovedPlugin);
+  addTest(testSuite, "SaveAndLoadEntryStatus", _testSaveAndLoadEntryStatus);
+  addTest(testSuite, "NewEntryWithString", _testNewEntryWithString);
+  addTest(testSuite, "NewEntryWithInvalidString",
+          _testNewEntryWithInvalidString);
+  addTest(testSuite, "SaveAndLoadCompleteIndex",
+          _testSaveAndLoadCompleteIndex);
+  addTest(testSuite, "RemoveStaleEntries", _testRemoveStaleEntries);
+  addTest(testSuite, "ClearIndex", _testClearIndex);
+
+  return testSuite;
+}
@@ -0,0 +1,187 @@
+//
+// PluginVst2xScannerTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#if UNIX
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#include "plugin/PluginVst2xScanner.h"
+
+#include "unit/TestRunner.h"
+
+#define TEST_INDEX_FILENAME "test_plugin_index.txt"
+#define TEST_SCANNER_TIMEOUT_IN_MS 500
+
+static PluginVst2xIndexEntry _probeOk(const CharString pluginPath) {
+  PluginVst2xIndexEntry entry = newPluginVst2xIndexEntry();
+  charStringCopy(entry->absolutePath, pluginPath);
+  entry->uniqueId = 0x41424344ul;
+  entry->numOutputs = 2;
+  linkedListAppend(entry->parameterNames, newCharStringWithCString("Gain"));
+  return entry;
+}
+
+static PluginVst2xIndexEntry _probeFailed(const CharString pluginPath) {
+  return NULL;
+}
+
+#if UNIX
+static PluginVst2xIndexEntry _probeByName(const CharString pluginPath) {
+  if (strstr(pluginPath->data, "crash") != NULL) {
+    raise(SIGKILL);
+  } else if (strstr(pluginPath->data, "hang") != NULL) {
+    sleep(5);
+  } else if (strstr(pluginPath->data, "fail") != NULL) {
+    return NULL;
+  }
+
+  return _probeOk(pluginPath);
+}
+#endif
+
+static PluginVst2xIndex _newTestIndex(void) {
+  CharString indexPath = newCharStringWithCString(TEST_INDEX_FILENAME);
+  PluginVst2xIndex index = newPluginVst2xIndex(indexPath);
+  freeCharString(indexPath);
+  return index;
+}
+
+static LinkedList _newTestPluginPaths(const char *names[]) {
+  LinkedList result = newLinkedList();
+
+  for (int i = 0; names[i] != NULL; i++) {
+    linkedListAppend(result, newCharStringWithCString(names[i]));
+  }
+
+  return result;
+}
+
+static PluginVst2xIndexEntry _getEntry(PluginVst2xIndex index, int n) {
+  LinkedListIterator iterator = index->entries;
+
+  for (int i = 0; i < n && iterator != NULL; i++) {
+    iterator = (LinkedListIterator)iterator->nextItem;
+  }
+
+  return iterator != NULL ? (PluginVst2xIndexEntry)iterator->item : NULL;
+}
+
+static int _testNewPluginVst2xScanner(void) {
+  PluginVst2xScanner s = newPluginVst2xScanner(_probeOk, 0, 0);
+  assertNotNull(s);
+  assertIntEquals(PLUGIN_VST2X_SCANNER_DEFAULT_TIMEOUT_IN_MS, s->timeoutInMs);
+  assert(s->maxJobs >= 1);
+  freePluginVst2xScanner(s);
+  return 0;
+}
+
+static int _testScanPlugins(void) {
+  const char *names[] = {"/a.so", "/b.so", "/c.so", NULL};
+  LinkedList pluginPaths = _newTestPluginPaths(names);
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xScanner s = newPluginVst2xScanner(_probeOk, 2, 0);
+  PluginVst2xIndexEntry entry;
+
+  assertIntEquals(3, pluginVst2xScannerRun(s, pluginPaths, index));
+  assertIntEquals(3, linkedListLength(index->entries));
+
+  for (int i = 0; i < 3; i++) {
+    entry = _getEntry(index, i);
+    assertNotNull(entry);
+    assertCharStringEquals(names[i], entry->absolutePath);
+    assertIntEquals(PLUGIN_VST2X_INDEX_STATUS_OK, entry->status);
+    assertUnsignedLongEquals(0x41424344ul, entry->uniqueId);
+    assertIntEquals(2, entry->numOutputs);
+    assertIntEquals(1, linkedListLength(entry->parameterNames));
+  }
+
+  assert(index->isDirty);
+  freePluginVst2xScanner(s);
+  freePluginVst2xIndex(index);
+  freeLinkedListAndItems(pluginPaths, (LinkedListFreeItemFunc)freeCharString);
+  return 0;
+}
+
+static int _testScanFailedPlugin(void) {
+  const char *names[] = {"/fail.so", NULL};
+  LinkedList pluginPaths = _newTestPluginPaths(names);
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xScanner s = newPluginVst2xScanner(_probeFailed, 1, 0);
+  PluginVst2xIndexEntry entry;
+
+  assertIntEquals(0, pluginVst2xScannerRun(s, pluginPaths, index));
+  entry = _getEntry(index, 0);
+  assertNotNull(entry);
+  assertCharStringEquals(names[0], entry->absolutePath);
+  assertIntEquals(PLUGIN_VST2X_INDEX_STATUS_FAILED, entry->status);
+
+  freePluginVst2xScanner(s);
+  freePluginVst2xIndex(index);
+  freeLinkedListAndItems(pluginPaths, (LinkedListFreeItemFunc)freeCharString);
+  return 0;
+}
+
+#if UNIX
+static int _testScanIsolatesBadPlugins(void) {
+  const char *names[] = {"/ok1.so", "/crash.so", "/hang.so",
+                         "/fail.so", "/ok2.so", NULL};
+  LinkedList pluginPaths = _newTestPluginPaths(names);
+  PluginVst2xIndex index = _newTestIndex();
+  PluginVst2xScanner s =
+      newPluginVst2xScanner(_probeByName, 3, TEST_SCANNER_TIMEOUT_IN_MS);
+
+  assertIntEquals(2, pluginVst2xScannerRun(s, pluginPaths, index));
+  assertIntEquals(5, linkedListLength(index->entries));
+  assertIntEquals(PLUGIN_VST2X_INDEX_STATUS_OK, _getEntry(index, 0)->status);
+  assertIntEquals(PLUGIN_VST2X_INDEX_STATUS_CRASHED,
+                  _getEntry(index, 1)->status);
+  assertIntEquals(PLUGIN_VST2X_INDEX_STATUS_TIMED_OUT,
+                  _getEntry(index, 2)->status);
+  assertIntEquals(PLUGIN_VST2X_INDEX_STATUS_FAILED,
+                  _getEntry(index, 3)->status);
+  assertIntEquals(PLUGIN_VST2X_INDEX_STATUS_OK, _getEntry(index, 4)->status);
+  assertCharStringEquals(names[4], _getEntry(index, 4)->absolutePath);
+
+  freePluginVst2xScanner(s);
+  freePluginVst2xIndex(index);
+  freeLinkedListAndItems(pluginPaths, (LinkedListFreeItemFunc)freeCharString);
+  return 0;
+}
+#endif
+
+TestSuite addPluginVst2xScannerTests(void);
+TestSuite addPluginVst2xScannerTests(void) {
+  TestSuite testSuite = newTestSuite("PluginVst2xScanner", NULL, NULL);
+
+  addTest(testSuite, "NewPluginVst2xScanner", _testNewPluginVst2xScanner);
+  addTest(testSuite, "ScanPlugins", _testScanPlugins);
+  addTest(testSuite, "ScanFailedPlugin", _testScanFailedPlugin);
+#if UNIX
+  addTest(testSuite, "ScanIsolatesBadPlugins", _testScanIsolatesBadPlugins);
+#endif
+  return testSuite;
+}
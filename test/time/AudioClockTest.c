@@ -86,6 +86,19 @@ static int _testAdvanceClockMulitpleTimes(void) {
   return 0;
 }
 
+static int _testSeekAudioClock(void) {
+  AudioClock audioClock = getAudioClock();
+  audioClockSeek(audioClock, kAudioClockTestBlocksize * 10);
+  assertUnsignedLongEquals(kAudioClockTestBlocksize * 10,
+                           audioClock->currentFrame);
+  assert(audioClock->transportChanged);
+  advanceAudioClock(audioClock, kAudioClockTestBlocksize);
+  assert(audioClock->isPlaying);
+  assertUnsignedLongEquals(kAudioClockTestBlocksize * 11,
+                           audioClock->currentFrame);
+  return 0;
+}
+
 TestSuite addAudioClockTests(void);
 TestSuite addAudioClockTests(void) {
   TestSuite testSuite =
@@ -95,5 +108,6 @@ TestSuite addAudioClockTests(void) {
   addTest(testSuite, "StopClock", _testStopAudioClock);
   addTest(testSuite, "RestartClock", _testRestartAudioClock);
   addTest(testSuite, "MultipleAdvance", _testAdvanceClockMulitpleTimes);
+  addTest(testSuite, "SeekClock", _testSeekAudioClock);
   return testSuite;
 }
@@ -0,0 +1,128 @@
+//
+// CpuCountersTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "time/CpuCounters.h"
+
+#include "unit/TestRunner.h"
+
+// Enough work to register a bit of CPU time, which is not optimized away
+static double _spinForCpuTime(void) {
+  volatile double result = 0.0;
+  unsigned long i;
+
+  for (i = 0; i < 1000000; i++) {
+    result += (double)i * 0.5;
+  }
+
+  return result;
+}
+
+static int _testNewCpuCounters(void) {
+  CpuCounters c = newCpuCounters(false);
+
+  assertNotNull(c);
+  assertFalse(cpuCountersHasHardwareCounters(c));
+
+  freeCpuCounters(c);
+  return 0;
+}
+
+static int _testMeasureCpuTime(void) {
+  CpuCounters c = newCpuCounters(false);
+  CpuCounterTotalsMembers totals;
+
+  memset(&totals, 0, sizeof(totals));
+  cpuCountersStart(c);
+  _spinForCpuTime();
+  cpuCountersStop(c, &totals);
+
+  assertUnsignedLongEquals(1ul, totals.numMeasurements);
+  assert(totals.cpuTimeInMs > 0.0);
+  assertUnsignedLongEquals(0ul, totals.counters[CPU_COUNTER_INSTRUCTIONS]);
+
+  freeCpuCounters(c);
+  return 0;
+}
+
+static int _testMeasureAddsToTotals(void) {
+  CpuCounters c = newCpuCounters(false);
+  CpuCounterTotalsMembers totals;
+  double firstCpuTime;
+
+  memset(&totals, 0, sizeof(totals));
+  cpuCountersStart(c);
+  _spinForCpuTime();
+  cpuCountersStop(c, &totals);
+  firstCpuTime = totals.cpuTimeInMs;
+
+  cpuCountersStart(c);
+  _spinForCpuTime();
+  cpuCountersStop(c, &totals);
+
+  assertUnsignedLongEquals(2ul, totals.numMeasurements);
+  assert(totals.cpuTimeInMs > firstCpuTime);
+
+  freeCpuCounters(c);
+  return 0;
+}
+
+// Hardware counters depend on the kernel's settings, so they are only checked
+// when they could be opened
+static int _testMeasureHardwareCounters(void) {
+  CpuCounters c = newCpuCounters(true);
+  CpuCounterTotalsMembers totals;
+
+  memset(&totals, 0, sizeof(totals));
+  cpuCountersStart(c);
+  _spinForCpuTime();
+  cpuCountersStop(c, &totals);
+
+  if (c->hasCounter[CPU_COUNTER_INSTRUCTIONS]) {
+    assert(totals.counters[CPU_COUNTER_INSTRUCTIONS] > 1000000);
+  } else {
+    assertUnsignedLongEquals(0ul, totals.counters[CPU_COUNTER_INSTRUCTIONS]);
+  }
+
+  freeCpuCounters(c);
+  return 0;
+}
+
+static int _testGetCounterName(void) {
+  assertIntEquals(0, strcmp("cycles", cpuCounterGetName(CPU_COUNTER_CYCLES)));
+  assertIsNull(cpuCounterGetName(NUM_CPU_COUNTERS));
+  return 0;
+}
+
+TestSuite addCpuCountersTests(void);
+TestSuite addCpuCountersTests(void) {
+  TestSuite testSuite = newTestSuite("CpuCounters", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewCpuCounters);
+  addTest(testSuite, "MeasureCpuTime", _testMeasureCpuTime);
+  addTest(testSuite, "MeasureAddsToTotals", _testMeasureAddsToTotals);
+  addTest(testSuite, "MeasureHardwareCounters", _testMeasureHardwareCounters);
+  addTest(testSuite, "GetCounterName", _testGetCounterName);
+  return testSuite;
+}
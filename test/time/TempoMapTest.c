@@ -0,0 +1,174 @@
+//
+// TempoMapTest.c - MrsWatson
+// Copyright (c) 2016 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "audio/AudioSettings.h"
+#include "time/AudioClock.h"
+#include "time/TempoMap.h"
+
+#include "unit/TestRunner.h"
+
+static void _tempoMapTestSetup(void) {
+  initAudioSettings();
+  setSampleRate(48000.0);
+}
+
+static void _tempoMapTestTeardown(void) { freeAudioSettings(); }
+
+static TempoMap _newTempoMapWithChanges(void) {
+  TempoMap tempoMap = newTempoMap(120.0);
+  tempoMapAddTempo(tempoMap, 4.0, 60.0);
+  tempoMapAddTempo(tempoMap, 6.0, 240.0);
+  return tempoMap;
+}
+
+static int _testNewTempoMap(void) {
+  TempoMap tempoMap = newTempoMap(120.0);
+  assertNotNull(tempoMap);
+  assertUnsignedLongEquals(1ul, (unsigned long)tempoMap->numEntries);
+  assertDoubleEquals(24000.0, tempoMapGetFrameForBeat(tempoMap, 1.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(120.0, tempoMapGetTempoAtFrame(tempoMap, 0.0),
+                     TEST_DEFAULT_TOLERANCE);
+  freeTempoMap(tempoMap);
+  return 0;
+}
+
+static int _testGetFrameForBeat(void) {
+  TempoMap tempoMap = _newTempoMapWithChanges();
+  assertDoubleEquals(96000.0, tempoMapGetFrameForBeat(tempoMap, 4.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(144000.0, tempoMapGetFrameForBeat(tempoMap, 5.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(192000.0, tempoMapGetFrameForBeat(tempoMap, 6.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(204000.0, tempoMapGetFrameForBeat(tempoMap, 7.0),
+                     TEST_DEFAULT_TOLERANCE);
+  freeTempoMap(tempoMap);
+  return 0;
+}
+
+static int _testGetBeatForFrame(void) {
+  TempoMap tempoMap = _newTempoMapWithChanges();
+  assertDoubleEquals(2.0, tempoMapGetBeatForFrame(tempoMap, 48000.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(5.5, tempoMapGetBeatForFrame(tempoMap, 168000.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(7.0, tempoMapGetBeatForFrame(tempoMap, 204000.0),
+                     TEST_DEFAULT_TOLERANCE);
+  freeTempoMap(tempoMap);
+  return 0;
+}
+
+static int _testGetTempoAtFrame(void) {
+  TempoMap tempoMap = _newTempoMapWithChanges();
+  assertDoubleEquals(120.0, tempoMapGetTempoAtFrame(tempoMap, 95999.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(60.0, tempoMapGetTempoAtFrame(tempoMap, 96000.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(240.0, tempoMapGetTempoAtFrame(tempoMap, 500000.0),
+                     TEST_DEFAULT_TOLERANCE);
+  freeTempoMap(tempoMap);
+  return 0;
+}
+
+static int _testAddTempoAtSamePosition(void) {
+  TempoMap tempoMap = newTempoMap(120.0);
+  assert(tempoMapAddTempo(tempoMap, 0.0, 60.0));
+  assert(tempoMapAddTempo(tempoMap, 2.0, 90.0));
+  assert(tempoMapAddTempo(tempoMap, 2.0, 240.0));
+  assertUnsignedLongEquals(2ul, (unsigned long)tempoMap->numEntries);
+  assertDoubleEquals(96000.0, tempoMapGetFrameForBeat(tempoMap, 2.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(240.0, tempoMapGetTempoAtFrame(tempoMap, 96000.0),
+                     TEST_DEFAULT_TOLERANCE);
+  freeTempoMap(tempoMap);
+  return 0;
+}
+
+static int _testAddManyTempoChanges(void) {
+  TempoMap tempoMap = newTempoMap(120.0);
+  int i;
+
+  for (i = 1; i <= 100; i++) {
+    assert(tempoMapAddTempo(tempoMap, (double)i, i % 2 ? 60.0 : 120.0));
+  }
+
+  // 50 beats at 60 BPM and 50 beats at 120 BPM
+  assertUnsignedLongEquals(101ul, (unsigned long)tempoMap->numEntries);
+  assertDoubleEquals(3600000.0, tempoMapGetFrameForBeat(tempoMap, 100.0),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(100.0, tempoMapGetBeatForFrame(tempoMap, 3600000.0),
+                     TEST_DEFAULT_TOLERANCE);
+  freeTempoMap(tempoMap);
+  return 0;
+}
+
+static int _testAddInvalidTempo(void) {
+  TempoMap tempoMap = newTempoMap(120.0);
+  assertFalse(tempoMapAddTempo(tempoMap, 1.0, 0.0));
+  assert(tempoMapAddTempo(tempoMap, 2.0, 60.0));
+  assertFalse(tempoMapAddTempo(tempoMap, 1.0, 60.0));
+  assertUnsignedLongEquals(2ul, (unsigned long)tempoMap->numEntries);
+  freeTempoMap(tempoMap);
+  return 0;
+}
+
+static int _testAudioClockWithTempoMap(void) {
+  TempoMap tempoMap = _newTempoMapWithChanges();
+  AudioClock audioClock;
+
+  initAudioClock();
+  audioClock = getAudioClock();
+  audioClockSeek(audioClock, 48000);
+  assertDoubleEquals(2.0, audioClockGetBeatPosition(audioClock),
+                     TEST_DEFAULT_TOLERANCE);
+
+  audioClock->tempoMap = tempoMap;
+  audioClockSeek(audioClock, 168000);
+  assertDoubleEquals(5.5, audioClockGetBeatPosition(audioClock),
+                     TEST_DEFAULT_TOLERANCE);
+  assertDoubleEquals(60.0, audioClockGetTempo(audioClock),
+                     TEST_DEFAULT_TOLERANCE);
+
+  freeAudioClock(audioClock);
+  freeTempoMap(tempoMap);
+  return 0;
+}
+
+TestSuite addTempoMapTests(void);
+TestSuite addTempoMapTests(void) {
+  TestSuite testSuite =
+      newTestSuite("TempoMap", _tempoMapTestSetup, _tempoMapTestTeardown);
+  addTest(testSuite, "Initialization", _testNewTempoMap);
+  addTest(testSuite, "GetFrameForBeat", _testGetFrameForBeat);
+  addTest(testSuite, "GetBeatForFrame", _testGetBeatForFrame);
+  addTest(testSuite, "GetTempoAtFrame", _testGetTempoAtFrame);
+  addTest(testSuite, "AddTempoAtSamePosition", _testAddTempoAtSamePosition);
+  addTest(testSuite, "AddManyTempoChanges", _testAddManyTempoChanges);
+  addTest(testSuite, "AddInvalidTempo", _testAddInvalidTempo);
+  addTest(testSuite, "AudioClockWithTempoMap", _testAudioClockWithTempoMap);
+  return testSuite;
+}
@@ -33,21 +33,38 @@
 extern TestSuite addAudioClockTests(void);
 extern TestSuite addAudioSettingsTests(void);
 extern TestSuite addCharStringTests(void);
+extern TestSuite addCpuCountersTests(void);
+extern TestSuite addDenormalsTests(void);
 extern TestSuite addEndianTests(void);
 extern TestSuite addFileTests(void);
+extern TestSuite addFlightRecorderTests(void);
 extern TestSuite addLinkedListTests(void);
+extern TestSuite addMemoryMonitorTests(void);
+extern TestSuite addMemoryTrackerTests(void);
+extern TestSuite addMidiEventPoolTests(void);
 extern TestSuite addMidiSequenceTests(void);
 extern TestSuite addMidiSourceTests(void);
 extern TestSuite addPcmSampleBufferTests(void);
 extern TestSuite addPlatformInfoTests(void);
 extern TestSuite addPluginTests(void);
+extern TestSuite addPluginAutomationTests(void);
 extern TestSuite addPluginChainTests(void);
+extern TestSuite addPluginChainBenchmarkTests(void);
+extern TestSuite addPluginChainTailTests(void);
 extern TestSuite addPluginPresetTests(void);
 extern TestSuite addPluginVst2xIdTests(void);
+extern TestSuite addPluginVst2xIndexTests(void);
+extern TestSuite addPluginVst2xScannerTests(void);
+extern TestSuite addMrsWatsonSessionTests(void);
 extern TestSuite addProgramOptionTests(void);
+extern TestSuite addRenderDaemonTests(void);
+extern TestSuite addRenderLoopTests(void);
+extern TestSuite addRenderStatusTests(void);
 extern TestSuite addSampleBufferTests(void);
+extern TestSuite addSampleBufferMathTests(void);
 extern TestSuite addSampleSourceTests(void);
 extern TestSuite addTaskTimerTests(void);
+extern TestSuite addTempoMapTests(void);
 
 extern TestSuite addAnalysisClippingTests(void);
 extern TestSuite addAnalysisDistortionTests(void);
@@ -72,21 +89,38 @@ LinkedList getTestSuites(File mrsWatsonExePath, File resourcesPath) {
   linkedListAppend(unitTestSuites, addAudioClockTests());
   linkedListAppend(unitTestSuites, addAudioSettingsTests());
   linkedListAppend(unitTestSuites, addCharStringTests());
+  linkedListAppend(unitTestSuites, addCpuCountersTests());
+  linkedListAppend(unitTestSuites, addDenormalsTests());
   linkedListAppend(unitTestSuites, addEndianTests());
   linkedListAppend(unitTestSuites, addFileTests());
+  linkedListAppend(unitTestSuites, addFlightRecorderTests());
   linkedListAppend(unitTestSuites, addLinkedListTests());
+  linkedListAppend(unitTestSuites, addMemoryMonitorTests());
+  linkedListAppend(unitTestSuites, addMemoryTrackerTests());
+  linkedListAppend(unitTestSuites, addMidiEventPoolTests());
   linkedListAppend(unitTestSuites, addMidiSequenceTests());
   linkedListAppend(unitTestSuites, addMidiSourceTests());
   linkedListAppend(unitTestSuites, addPcmSampleBufferTests());
   linkedListAppend(unitTestSuites, addPlatformInfoTests());
   linkedListAppend(unitTestSuites, addPluginTests());
+  linkedListAppend(unitTestSuites, addPluginAutomationTests());
   linkedListAppend(unitTestSuites, addPluginChainTests());
+  linkedListAppend(unitTestSuites, addPluginChainBenchmarkTests());
+  linkedListAppend(unitTestSuites, addPluginChainTailTests());
   linkedListAppend(unitTestSuites, addPluginPresetTests());
   linkedListAppend(unitTestSuites, addPluginVst2xIdTests());
+  linkedListAppend(unitTestSuites, addPluginVst2xIndexTests());
+  linkedListAppend(unitTestSuites, addPluginVst2xScannerTests());
+  linkedListAppend(unitTestSuites, addMrsWatsonSessionTests());
   linkedListAppend(unitTestSuites, addProgramOptionTests());
+  linkedListAppend(unitTestSuites, addRenderDaemonTests());
+  linkedListAppend(unitTestSuites, addRenderLoopTests());
+  linkedListAppend(unitTestSuites, addRenderStatusTests());
   linkedListAppend(unitTestSuites, addSampleBufferTests());
+  linkedListAppend(unitTestSuites, addSampleBufferMathTests());
   linkedListAppend(unitTestSuites, addSampleSourceTests());
   linkedListAppend(unitTestSuites, addTaskTimerTests());
+  linkedListAppend(unitTestSuites, addTempoMapTests());
 
   linkedListAppend(unitTestSuites, addAnalysisClippingTests());
   linkedListAppend(unitTestSuites, addAnalysisDistortionTests());